@@ -135,9 +135,17 @@ FetchContent_Declare(
   GIT_SHALLOW TRUE
 )
 
+# Single-header decoders (dr_mp3 for the notification sounds); no CMake project, only headers.
+# dr_libs has no release tags: pinned to a commit, fetched in full since a shallow clone only reaches branch heads
+FetchContent_Declare(
+  dr_libs
+  GIT_REPOSITORY https://github.com/mackron/dr_libs.git
+  GIT_TAG da35f9d6c7374a95353fd1df1d394d44ab66cf01
+)
+
 # Removed FetchContent_Declare for imguicolortextedit since we're using local files
 
-FetchContent_MakeAvailable(imgui glaze)
+FetchContent_MakeAvailable(imgui glaze dr_libs)
 
 # Create ImGui library
 add_library(imgui STATIC
@@ -180,6 +188,9 @@ target_include_directories(imcolortextedit PUBLIC
   ${CMAKE_SOURCE_DIR}/external/imguicolortextedit
   ${CMAKE_SOURCE_DIR}/src/helpers
 )
+# Syntax colors are computed on a thread of the editor's own
+find_package(Threads REQUIRED)
+target_link_libraries(imcolortextedit PUBLIC Threads::Threads)
 
 # Disable sign comparison warnings only for the imcolortextedit library
 if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
@@ -45,26 +45,38 @@ TextEditor::TextEditor()
 	, mHandleMouseInputs(true)
 	, mIgnoreImGuiChild(false)
 	, mShowWhitespaces(true)
-	, mCheckComments(true)
+	, mTextGeneration(0)
+	, mColorizeInFlight(false)
+	, mStopColorizer(false)
 	, mStartTime(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count())
 	, mLastClick(-1.0f)
 {
 	SetPalette(GetDarkPalette());
 	SetLanguageDefinition(LanguageDefinition::HLSL());
 	mLines.push_back(Line());
+	mLineStates.push_back(0);
 }
 
 TextEditor::~TextEditor()
 {
+	{
+		std::lock_guard<std::mutex> lock(mColorizeMutex);
+		mStopColorizer = true;
+	}
+	mColorizeWake.notify_one();
+	if (mColorizer.joinable())
+		mColorizer.join();
 }
 
 void TextEditor::SetLanguageDefinition(const LanguageDefinition & aLanguageDef)
 {
 	mLanguageDefinition = aLanguageDef;
-	mRegexList.clear();
 
+	auto grammar = std::make_shared<Grammar>();
+	grammar->mLanguage = aLanguageDef;
 	for (auto& r : mLanguageDefinition.mTokenRegexStrings)
-		mRegexList.push_back(std::make_pair(std::regex(r.first, std::regex_constants::optimize), r.second));
+		grammar->mRegexList.push_back(std::make_pair(std::regex(r.first, std::regex_constants::optimize), r.second));
+	mGrammar = std::move(grammar);
 
 	Colorize();
 }
@@ -599,6 +611,9 @@ void TextEditor::RemoveLine(int aStart, int aEnd)
 
 	mLines.erase(mLines.begin() + aStart, mLines.begin() + aEnd);
 	assert(!mLines.empty());
+	if (mLineStates.size() >= (size_t)aEnd)
+		mLineStates.erase(mLineStates.begin() + aStart, mLineStates.begin() + aEnd);
+	++mTextGeneration;
 
 	mTextChanged = true;
 }
@@ -629,6 +644,9 @@ void TextEditor::RemoveLine(int aIndex)
 
 	mLines.erase(mLines.begin() + aIndex);
 	assert(!mLines.empty());
+	if (mLineStates.size() > (size_t)aIndex)
+		mLineStates.erase(mLineStates.begin() + aIndex);
+	++mTextGeneration;
 
 	mTextChanged = true;
 }
@@ -638,6 +656,9 @@ TextEditor::Line& TextEditor::InsertLine(int aIndex)
 	assert(!mReadOnly);
 
 	auto& result = *mLines.insert(mLines.begin() + aIndex, Line());
+	if (mLineStates.size() >= (size_t)aIndex)
+		mLineStates.insert(mLineStates.begin() + aIndex, aIndex < (int)mLineStates.size() ? mLineStates[aIndex] : uint8_t(0));
+	++mTextGeneration;
 
 	ErrorMarkers etmp;
 	for (auto& i : mErrorMarkers)
@@ -1175,6 +1196,7 @@ void TextEditor::SetText(const std::string & aText)
 	mUndoBuffer.clear();
 	mUndoIndex = 0;
 
+	mLineStates.assign(mLines.size(), 0);
 	Colorize();
 }
 
@@ -1206,6 +1228,7 @@ void TextEditor::SetTextLines(const std::vector<std::string> & aLines)
 	mUndoBuffer.clear();
 	mUndoIndex = 0;
 
+	mLineStates.assign(mLines.size(), 0);
 	Colorize();
 }
 
@@ -1390,6 +1413,8 @@ void TextEditor::SetReadOnly(bool aValue)
 void TextEditor::SetColorizerEnable(bool aValue)
 {
 	mColorizerEnabled = aValue;
+	if (aValue)
+		Colorize();
 }
 
 void TextEditor::SetCursorPosition(const Coordinates & aPosition)
@@ -2135,111 +2160,154 @@ void TextEditor::Colorize(int aFromLine, int aLines)
 	mColorRangeMax = std::max(mColorRangeMax, toLine);
 	mColorRangeMin = std::max(0, mColorRangeMin);
 	mColorRangeMax = std::max(mColorRangeMin, mColorRangeMax);
-	mCheckComments = true;
+	++mTextGeneration;
 }
 
-void TextEditor::ColorizeRange(int aFromLine, int aToLine)
+// Lines copied into one colorizer job at most; a longer dirty range goes over several frames
+static const int ColorizeChunk = 4096;
+
+void TextEditor::ColorizeLine(const Grammar& aGrammar, const std::string& aText, uint8_t& aState, std::vector<GlyphColor>& aColors)
 {
-	if (mLines.empty() || aFromLine >= aToLine)
-		return;
+	auto& language = aGrammar.mLanguage;
+	aColors.assign(aText.size(), GlyphColor{ PaletteIndex::Default, false, false, false });
 
-	std::string buffer;
-	std::cmatch results;
-	std::string id;
+	// Comments, strings and preprocessor lines, which may carry over from the line before
+	bool inBlockComment = (aState & InBlockComment) != 0;
+	bool inLineComment = (aState & InLineComment) != 0;
+	bool inPreprocessor = (aState & InPreprocessor) != 0;
+	char quote = (aState & InString) != 0 ? '"' : 0;
+	bool firstChar = aState == 0 || aState == InBlockComment;	// nothing but blanks so far on this line
 
-	int endLine = std::max(0, std::min((int)mLines.size(), aToLine));
-	for (int i = aFromLine; i < endLine; ++i)
-	{
-		auto& line = mLines[i];
+	auto startsWith = [&aText](size_t aAt, const std::string& aWhat) {
+		return !aWhat.empty() && aText.compare(aAt, aWhat.size(), aWhat) == 0;
+	};
 
-		if (line.empty())
-			continue;
+	const size_t size = aText.size();
+	for (size_t i = 0; i < size; )
+	{
+		const char c = aText[i];
+		size_t next = i + 1;
 
-		buffer.resize(line.size());
-		for (size_t j = 0; j < line.size(); ++j)
+		if (inBlockComment)
+		{
+			if (startsWith(i, language.mCommentEnd))
+			{
+				next = i + language.mCommentEnd.size();
+				inBlockComment = false;
+			}
+			for (size_t j = i; j < next; ++j)
+				aColors[j].mMultiLineComment = true;
+		}
+		else if (inLineComment)
 		{
-			auto& col = line[j];
-			buffer[j] = col.mChar;
-			col.mColorIndex = PaletteIndex::Default;
+			aColors[i].mComment = true;
 		}
+		else if (quote != 0)
+		{
+			if (c == '\\' && i + 1 < size)
+				next = i + 2;
+			else if (c == quote)
+				quote = 0;
+		}
+		else
+		{
+			if (firstChar && c == language.mPreprocChar)
+				inPreprocessor = true;
+			if (c != language.mPreprocChar && !isspace((unsigned char)c))
+				firstChar = false;
 
-		const char * bufferBegin = &buffer.front();
-		const char * bufferEnd = bufferBegin + buffer.size();
+			if (c == '"' || c == '\'')
+			{
+				quote = c;
+			}
+			else if (startsWith(i, language.mSingleLineComment))
+			{
+				inLineComment = true;
+				aColors[i].mComment = true;
+			}
+			else if (startsWith(i, language.mCommentStart))
+			{
+				inBlockComment = true;
+				next = i + language.mCommentStart.size();
+				for (size_t j = i; j < next; ++j)
+					aColors[j].mMultiLineComment = true;
+			}
+		}
 
-		auto last = bufferEnd;
+		next = std::max(next, i + (size_t)UTF8CharLength((TextEditor::Char)c));
+		next = std::min(next, size);
+		for (; i < next; ++i)
+			aColors[i].mPreprocessor = inPreprocessor;
+	}
 
-		for (auto first = bufferBegin; first != last; )
-		{
-			const char * token_begin = nullptr;
-			const char * token_end = nullptr;
-			PaletteIndex token_color = PaletteIndex::Default;
+	const bool continues = size > 0 && aText.back() == '\\';
+	aState = (inBlockComment ? InBlockComment : 0);
+	if (continues)
+		aState |= (quote == '"' ? InString : 0) | (inLineComment ? InLineComment : 0) | (inPreprocessor ? InPreprocessor : 0);
 
-			bool hasTokenizeResult = false;
+	// Tokens; comments take their colors over these when drawn
+	const char * bufferBegin = aText.data();
+	const char * last = bufferBegin + size;
+	std::cmatch results;
+	std::string id;
+	for (auto first = bufferBegin; first != last; )
+	{
+		const char * token_begin = nullptr;
+		const char * token_end = nullptr;
+		PaletteIndex token_color = PaletteIndex::Default;
 
-			if (mLanguageDefinition.mTokenize != nullptr)
-			{
-				if (mLanguageDefinition.mTokenize(first, last, token_begin, token_end, token_color))
-					hasTokenizeResult = true;
-			}
+		bool hasTokenizeResult = language.mTokenize != nullptr && language.mTokenize(first, last, token_begin, token_end, token_color);
 
-			if (hasTokenizeResult == false)
+		if (hasTokenizeResult == false)
+		{
+			for (auto& p : aGrammar.mRegexList)
 			{
-				// todo : remove
-				//printf("using regex for %.*s\n", first + 10 < last ? 10 : int(last - first), first);
-
-				for (auto& p : mRegexList)
+				if (std::regex_search(first, last, results, p.first, std::regex_constants::match_continuous))
 				{
-					if (std::regex_search(first, last, results, p.first, std::regex_constants::match_continuous))
-					{
-						hasTokenizeResult = true;
+					hasTokenizeResult = true;
 
-						auto& v = *results.begin();
-						token_begin = v.first;
-						token_end = v.second;
-						token_color = p.second;
-						break;
-					}
+					auto& v = *results.begin();
+					token_begin = v.first;
+					token_end = v.second;
+					token_color = p.second;
+					break;
 				}
 			}
+		}
+
+		if (hasTokenizeResult == false || token_end == first)
+		{
+			first++;
+			continue;
+		}
 
-			if (hasTokenizeResult == false)
+		if (token_color == PaletteIndex::Identifier)
+		{
+			id.assign(token_begin, token_end);
+
+			if (!language.mCaseSensitive)
+				std::transform(id.begin(), id.end(), id.begin(), ::toupper);
+
+			if (!aColors[first - bufferBegin].mPreprocessor)
 			{
-				first++;
+				if (language.mKeywords.count(id) != 0)
+					token_color = PaletteIndex::Keyword;
+				else if (language.mIdentifiers.count(id) != 0)
+					token_color = PaletteIndex::KnownIdentifier;
+				else if (language.mPreprocIdentifiers.count(id) != 0)
+					token_color = PaletteIndex::PreprocIdentifier;
 			}
 			else
 			{
-				const size_t token_length = token_end - token_begin;
-
-				if (token_color == PaletteIndex::Identifier)
-				{
-					id.assign(token_begin, token_end);
-
-					// todo : allmost all language definitions use lower case to specify keywords, so shouldn't this use ::tolower ?
-					if (!mLanguageDefinition.mCaseSensitive)
-						std::transform(id.begin(), id.end(), id.begin(), ::toupper);
-
-					if (!line[first - bufferBegin].mPreprocessor)
-					{
-						if (mLanguageDefinition.mKeywords.count(id) != 0)
-							token_color = PaletteIndex::Keyword;
-						else if (mLanguageDefinition.mIdentifiers.count(id) != 0)
-							token_color = PaletteIndex::KnownIdentifier;
-						else if (mLanguageDefinition.mPreprocIdentifiers.count(id) != 0)
-							token_color = PaletteIndex::PreprocIdentifier;
-					}
-					else
-					{
-						if (mLanguageDefinition.mPreprocIdentifiers.count(id) != 0)
-							token_color = PaletteIndex::PreprocIdentifier;
-					}
-				}
-
-				for (size_t j = 0; j < token_length; ++j)
-					line[(token_begin - bufferBegin) + j].mColorIndex = token_color;
-
-				first = token_end;
+				if (language.mPreprocIdentifiers.count(id) != 0)
+					token_color = PaletteIndex::PreprocIdentifier;
 			}
 		}
+
+		for (auto j = token_begin; j < token_end; ++j)
+			aColors[j - bufferBegin].mColorIndex = token_color;
+
+		first = token_end;
 	}
 }
 
@@ -2248,141 +2316,139 @@ void TextEditor::ColorizeInternal()
 	if (mLines.empty() || !mColorizerEnabled)
 		return;
 
-	if (mCheckComments)
+	std::unique_ptr<ColorizeJob> done;
 	{
-		auto endLine = mLines.size();
-		auto endIndex = 0;
-		auto commentStartLine = endLine;
-		auto commentStartIndex = endIndex;
-		auto withinString = false;
-		auto withinSingleLineComment = false;
-		auto withinPreproc = false;
-		auto firstChar = true;			// there is no other non-whitespace characters in the line before
-		auto concatenate = false;		// '\' on the very end of the line
-		auto currentLine = 0;
-		auto currentIndex = 0;
-		while (currentLine < endLine || currentIndex < endIndex)
-		{
-			auto& line = mLines[currentLine];
-
-			if (currentIndex == 0 && !concatenate)
-			{
-				withinSingleLineComment = false;
-				withinPreproc = false;
-				firstChar = true;
-			}
-
-			concatenate = false;
-
-			if (!line.empty())
-			{
-				auto& g = line[currentIndex];
-				auto c = g.mChar;
-
-				if (c != mLanguageDefinition.mPreprocChar && !isspace(c))
-					firstChar = false;
-
-				if (currentIndex == (int)line.size() - 1 && line[line.size() - 1].mChar == '\\')
-					concatenate = true;
-
-				bool inComment = (commentStartLine < currentLine || (commentStartLine == currentLine && commentStartIndex <= currentIndex));
+		std::lock_guard<std::mutex> lock(mColorizeMutex);
+		done = std::move(mDoneJob);
+	}
+	if (done)
+	{
+		mColorizeInFlight = false;
+		if (done->mGeneration == mTextGeneration)
+			ApplyColorizeJob(*done);
+	}
 
-				if (withinString)
-				{
-					line[currentIndex].mMultiLineComment = inComment;
+	if (!mColorizeInFlight && mColorRangeMin < mColorRangeMax)
+		SubmitColorizeJob();
+}
 
-					if (c == '\"')
-					{
-						if (currentIndex + 1 < (int)line.size() && line[currentIndex + 1].mChar == '\"')
-						{
-							currentIndex += 1;
-							if (currentIndex < (int)line.size())
-								line[currentIndex].mMultiLineComment = inComment;
-						}
-						else
-							withinString = false;
-					}
-					else if (c == '\\')
-					{
-						currentIndex += 1;
-						if (currentIndex < (int)line.size())
-							line[currentIndex].mMultiLineComment = inComment;
-					}
-				}
-				else
-				{
-					if (firstChar && c == mLanguageDefinition.mPreprocChar)
-						withinPreproc = true;
+void TextEditor::SubmitColorizeJob()
+{
+	const int lineCount = (int)mLines.size();
+	if (mLineStates.size() != mLines.size())
+	{
+		// Can't tell which states still hold; start over
+		mLineStates.assign(mLines.size(), 0);
+		mColorRangeMin = 0;
+		mColorRangeMax = lineCount;
+	}
 
-					if (c == '\"')
-					{
-						withinString = true;
-						line[currentIndex].mMultiLineComment = inComment;
-					}
-					else
-					{
-						auto pred = [](const char& a, const Glyph& b) { return a == b.mChar; };
-						auto from = line.begin() + currentIndex;
-						auto& startStr = mLanguageDefinition.mCommentStart;
-						auto& singleStartStr = mLanguageDefinition.mSingleLineComment;
-
-						if (singleStartStr.size() > 0 &&
-							currentIndex + singleStartStr.size() <= line.size() &&
-							equals(singleStartStr.begin(), singleStartStr.end(), from, from + singleStartStr.size(), pred))
-						{
-							withinSingleLineComment = true;
-						}
-						else if (!withinSingleLineComment && currentIndex + startStr.size() <= line.size() &&
-							equals(startStr.begin(), startStr.end(), from, from + startStr.size(), pred))
-						{
-							commentStartLine = currentLine;
-							commentStartIndex = currentIndex;
-						}
+	const int first = std::min(mColorRangeMin, lineCount - 1);
+	const int end = std::min(lineCount, first + std::clamp(mColorRangeMax - first + 64, 64, ColorizeChunk));
 
-						inComment = inComment = (commentStartLine < currentLine || (commentStartLine == currentLine && commentStartIndex <= currentIndex));
+	auto job = std::make_unique<ColorizeJob>();
+	job->mGeneration = mTextGeneration;
+	job->mFirstLine = first;
+	job->mDirtyEnd = mColorRangeMax;
+	job->mLastLines = end == lineCount;
+	job->mStartState = first == 0 ? 0 : mLineStates[first];
+	job->mGrammar = mGrammar;
+	job->mNotify = mColorizeCallback;
+	job->mText.resize(end - first);
+	for (int i = first; i < end; ++i)
+	{
+		auto& text = job->mText[i - first];
+		text.reserve(mLines[i].size());
+		for (auto& glyph : mLines[i])
+			text.push_back((char)glyph.mChar);
+	}
+	job->mOldStates.assign(mLineStates.begin() + first + 1, mLineStates.begin() + std::min(lineCount, end + 1));
 
-						line[currentIndex].mMultiLineComment = inComment;
-						line[currentIndex].mComment = withinSingleLineComment;
+	{
+		std::lock_guard<std::mutex> lock(mColorizeMutex);
+		mPendingJob = std::move(job);
+		if (!mColorizer.joinable())
+			mColorizer = std::thread([this] { ColorizerLoop(); });
+	}
+	mColorizeWake.notify_one();
+	mColorizeInFlight = true;
+}
 
-						auto& endStr = mLanguageDefinition.mCommentEnd;
-						if (currentIndex + 1 >= (int)endStr.size() &&
-							equals(endStr.begin(), endStr.end(), from + 1 - endStr.size(), from + 1, pred))
-						{
-							commentStartIndex = endIndex;
-							commentStartLine = endLine;
-						}
-					}
-				}
-				line[currentIndex].mPreprocessor = withinPreproc;
-				currentIndex += UTF8CharLength(c);
-				if (currentIndex >= (int)line.size())
-				{
-					currentIndex = 0;
-					++currentLine;
-				}
-			}
-			else
+void TextEditor::ApplyColorizeJob(const ColorizeJob& aJob)
+{
+	const int lineCount = (int)mLines.size();
+	const int first = aJob.mFirstLine;
+	const int end = first + (int)aJob.mColors.size();
+	for (int i = first; i < end && i < lineCount; ++i)
+	{
+		auto& line = mLines[i];
+		auto& colors = aJob.mColors[i - first];
+		if (line.size() == colors.size())
+		{
+			for (size_t j = 0; j < line.size(); ++j)
 			{
-				currentIndex = 0;
-				++currentLine;
+				line[j].mColorIndex = colors[j].mColorIndex;
+				line[j].mComment = colors[j].mComment;
+				line[j].mMultiLineComment = colors[j].mMultiLineComment;
+				line[j].mPreprocessor = colors[j].mPreprocessor;
 			}
 		}
-		mCheckComments = false;
+		if (i + 1 < (int)mLineStates.size())
+			mLineStates[i + 1] = aJob.mStates[i - first];
 	}
 
-	if (mColorRangeMin < mColorRangeMax)
+	if (aJob.mConverged && end >= mColorRangeMax)
+	{
+		mColorRangeMin = std::numeric_limits<int>::max();
+		mColorRangeMax = 0;
+	}
+	else
+	{
+		// The state coming out of the run differs from what the next lines were colored with
+		mColorRangeMin = end;
+		mColorRangeMax = std::min(lineCount, std::max(mColorRangeMax, end + ColorizeChunk));
+	}
+}
+
+void TextEditor::ColorizerLoop()
+{
+	for (;;)
 	{
-		const int increment = (mLanguageDefinition.mTokenize == nullptr) ? 10 : 10000;
-		const int to = std::min(mColorRangeMin + increment, mColorRangeMax);
-		ColorizeRange(mColorRangeMin, to);
-		mColorRangeMin = to;
+		std::unique_ptr<ColorizeJob> job;
+		{
+			std::unique_lock<std::mutex> lock(mColorizeMutex);
+			mColorizeWake.wait(lock, [this] { return mStopColorizer || mPendingJob != nullptr; });
+			if (mStopColorizer)
+				return;
+			job = std::move(mPendingJob);
+		}
 
-		if (mColorRangeMax == mColorRangeMin)
+		// Lexes until the state entering a line past the dirty ones matches the stored one;
+		// from there on the earlier colors still hold
+		auto state = job->mStartState;
+		job->mColors.reserve(job->mText.size());
+		for (size_t i = 0; i < job->mText.size(); ++i)
+		{
+			job->mColors.emplace_back();
+			ColorizeLine(*job->mGrammar, job->mText[i], state, job->mColors.back());
+			job->mStates.push_back(state);
+			const int nextLine = job->mFirstLine + (int)i + 1;
+			if (nextLine >= job->mDirtyEnd && i < job->mOldStates.size() && job->mOldStates[i] == state)
+			{
+				job->mConverged = true;
+				break;
+			}
+		}
+		if (job->mColors.size() == job->mText.size() && job->mLastLines)
+			job->mConverged = true;
+
+		auto notify = job->mNotify;
 		{
-			mColorRangeMin = std::numeric_limits<int>::max();
-			mColorRangeMax = 0;
+			std::lock_guard<std::mutex> lock(mColorizeMutex);
+			mDoneJob = std::move(job);
 		}
-		return;
+		if (notify)
+			notify();
 	}
 }
 
@@ -2732,6 +2798,87 @@ static bool TokenizeCStylePunctuation(const char * in_begin, const char * in_end
 	return false;
 }
 
+static bool TokenizeSingleQuotedString(const char * in_begin, const char * in_end, const char *& out_begin, const char *& out_end)
+{
+	const char * p = in_begin;
+
+	if (*p == '\'')
+	{
+		p++;
+
+		while (p < in_end)
+		{
+			if (*p == '\'')
+			{
+				out_begin = in_begin;
+				out_end = p + 1;
+				return true;
+			}
+
+			if (*p == '\\' && p + 1 < in_end)
+				p++;
+
+			p++;
+		}
+	}
+
+	return false;
+}
+
+// Hand-written tokenizer for the C family (HLSL, GLSL, AngelScript)
+static bool TokenizeCStyle(const char * in_begin, const char * in_end, const char *& out_begin, const char *& out_end, TextEditor::PaletteIndex & paletteIndex)
+{
+	paletteIndex = TextEditor::PaletteIndex::Max;
+
+	while (in_begin < in_end && isascii(*in_begin) && isblank(*in_begin))
+		in_begin++;
+
+	if (in_begin == in_end)
+	{
+		out_begin = in_end;
+		out_end = in_end;
+		paletteIndex = TextEditor::PaletteIndex::Default;
+	}
+	else if (TokenizeCStyleString(in_begin, in_end, out_begin, out_end))
+		paletteIndex = TextEditor::PaletteIndex::String;
+	else if (TokenizeCStyleCharacterLiteral(in_begin, in_end, out_begin, out_end))
+		paletteIndex = TextEditor::PaletteIndex::CharLiteral;
+	else if (TokenizeCStyleIdentifier(in_begin, in_end, out_begin, out_end))
+		paletteIndex = TextEditor::PaletteIndex::Identifier;
+	else if (TokenizeCStyleNumber(in_begin, in_end, out_begin, out_end))
+		paletteIndex = TextEditor::PaletteIndex::Number;
+	else if (TokenizeCStylePunctuation(in_begin, in_end, out_begin, out_end))
+		paletteIndex = TextEditor::PaletteIndex::Punctuation;
+
+	return paletteIndex != TextEditor::PaletteIndex::Max;
+}
+
+// Hand-written tokenizer for SQL and Lua, where single quotes delimit strings too
+static bool TokenizeScript(const char * in_begin, const char * in_end, const char *& out_begin, const char *& out_end, TextEditor::PaletteIndex & paletteIndex)
+{
+	paletteIndex = TextEditor::PaletteIndex::Max;
+
+	while (in_begin < in_end && isascii(*in_begin) && isblank(*in_begin))
+		in_begin++;
+
+	if (in_begin == in_end)
+	{
+		out_begin = in_end;
+		out_end = in_end;
+		paletteIndex = TextEditor::PaletteIndex::Default;
+	}
+	else if (TokenizeCStyleString(in_begin, in_end, out_begin, out_end) || TokenizeSingleQuotedString(in_begin, in_end, out_begin, out_end))
+		paletteIndex = TextEditor::PaletteIndex::String;
+	else if (TokenizeCStyleIdentifier(in_begin, in_end, out_begin, out_end))
+		paletteIndex = TextEditor::PaletteIndex::Identifier;
+	else if (TokenizeCStyleNumber(in_begin, in_end, out_begin, out_end))
+		paletteIndex = TextEditor::PaletteIndex::Number;
+	else if (TokenizeCStylePunctuation(in_begin, in_end, out_begin, out_end))
+		paletteIndex = TextEditor::PaletteIndex::Punctuation;
+
+	return paletteIndex != TextEditor::PaletteIndex::Max;
+}
+
 const TextEditor::LanguageDefinition& TextEditor::LanguageDefinition::CPlusPlus()
 {
 	static bool inited = false;
@@ -2866,6 +3013,8 @@ const TextEditor::LanguageDefinition& TextEditor::LanguageDefinition::HLSL()
 		langDef.mCaseSensitive = true;
 		langDef.mAutoIndentation = true;
 
+		langDef.mTokenize = TokenizeCStyle;
+
 		langDef.mName = "HLSL";
 
 		inited = true;
@@ -2915,6 +3064,8 @@ const TextEditor::LanguageDefinition& TextEditor::LanguageDefinition::GLSL()
 		langDef.mCaseSensitive = true;
 		langDef.mAutoIndentation = true;
 
+		langDef.mTokenize = TokenizeCStyle;
+
 		langDef.mName = "GLSL";
 
 		inited = true;
@@ -3045,6 +3196,8 @@ const TextEditor::LanguageDefinition& TextEditor::LanguageDefinition::SQL()
 		langDef.mCaseSensitive = false;
 		langDef.mAutoIndentation = false;
 
+		langDef.mTokenize = TokenizeScript;
+
 		langDef.mName = "SQL";
 
 		inited = true;
@@ -3095,6 +3248,8 @@ const TextEditor::LanguageDefinition& TextEditor::LanguageDefinition::AngelScrip
 		langDef.mCaseSensitive = true;
 		langDef.mAutoIndentation = true;
 
+		langDef.mTokenize = TokenizeCStyle;
+
 		langDef.mName = "AngelScript";
 
 		inited = true;
@@ -3149,6 +3304,8 @@ const TextEditor::LanguageDefinition& TextEditor::LanguageDefinition::Lua()
 		langDef.mCaseSensitive = true;
 		langDef.mAutoIndentation = false;
 
+		langDef.mTokenize = TokenizeScript;
+
 		langDef.mName = "Lua";
 
 		inited = true;
@@ -0,0 +1,157 @@
+// chess_perft: counts the move tree of standard test positions with the bitboard generator,
+// checks the counts against the published ones and reports them with nodes per second as JSON.
+//
+// Usage: chess_perft [--depth N] [--fen FEN] [--output file]
+//
+// Without --fen it runs the usual suite (the starting position, "Kiwipete" and positions 3 to
+// 6 of the Chess Programming Wiki's perft results); --depth caps each position's depth.
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <glaze/glaze.hpp>
+
+// 3. All other includes
+#include "../models/chess/bitboard.hpp"
+
+namespace {
+
+struct perft_case {
+    std::string fen;
+    int depth {0};
+    std::uint64_t expected {0};     // 0 = unknown
+};
+
+struct perft_result {
+    std::string fen;
+    int depth {0};
+    std::uint64_t nodes {0};
+    std::uint64_t expected {0};
+    bool correct {true};
+    double seconds {0.0};
+    double nodes_per_second {0.0};
+};
+
+struct perft_report {
+    double tables_ms {0.0};     // building the attack tables, magics included
+    bool all_correct {true};
+    std::uint64_t total_nodes {0};
+    double nodes_per_second {0.0};
+    std::vector<perft_result> positions;
+};
+
+struct perft_options {
+    int depth {0};              // 0 = each case's own
+    std::string fen;
+    std::string output;         // empty = stdout
+};
+
+// Known leaf counts at the depth given
+std::vector<perft_case> const standard_suite {
+    {std::string{rouen::models::chess::BitboardPosition::starting_fen}, 5, 4865609},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+};
+
+bool parse_options(int argc, char** argv, perft_options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view const arg {argv[i]};
+        auto next = [&]() -> char const* { return i + 1 < argc ? argv[++i] : nullptr; };
+        char const* value = nullptr;
+        if (arg == "--depth" && (value = next())) {
+            options.depth = std::max(1, std::atoi(value));
+        } else if (arg == "--fen" && (value = next())) {
+            options.fen = value;
+        } else if (arg == "--output" && (value = next())) {
+            options.output = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace rouen::models::chess;
+
+    perft_options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: chess_perft [--depth N] [--fen FEN] [--output file]\n";
+        return 2;
+    }
+
+    std::vector<perft_case> cases;
+    if (options.fen.empty()) {
+        for (auto c : standard_suite) {
+            if (options.depth > 0 && options.depth < c.depth) {
+                c.depth = options.depth;
+                c.expected = 0;
+            }
+            cases.push_back(std::move(c));
+        }
+    } else {
+        cases.push_back({options.fen, options.depth > 0 ? options.depth : 5, 0});
+    }
+
+    perft_report report;
+    auto const tables_start = std::chrono::steady_clock::now();
+    (void)detail::AttackTables::get();
+    report.tables_ms = seconds_since(tables_start) * 1000.0;
+
+    double total_seconds = 0.0;
+    for (auto const& c : cases) {
+        auto const position = BitboardPosition::from_fen(c.fen);
+        if (!position) {
+            std::cerr << "chess_perft: cannot parse FEN " << c.fen << "\n";
+            return 1;
+        }
+        perft_result result {c.fen, c.depth};
+        auto const start = std::chrono::steady_clock::now();
+        result.nodes = perft(*position, c.depth);
+        result.seconds = seconds_since(start);
+        result.expected = c.expected;
+        result.correct = c.expected == 0 || result.nodes == c.expected;
+        result.nodes_per_second = result.seconds > 0.0 ? static_cast<double>(result.nodes) / result.seconds : 0.0;
+
+        report.all_correct = report.all_correct && result.correct;
+        report.total_nodes += result.nodes;
+        total_seconds += result.seconds;
+        report.positions.push_back(std::move(result));
+    }
+    report.nodes_per_second = total_seconds > 0.0 ? static_cast<double>(report.total_nodes) / total_seconds : 0.0;
+
+    std::string json;
+    if (auto error = glz::write_json(report, json)) {
+        std::cerr << "chess_perft: failed to serialize the report: " << glz::format_error(error) << "\n";
+        return 1;
+    }
+    if (options.output.empty()) {
+        std::cout << json << std::endl;
+    } else {
+        std::ofstream out(options.output);
+        if (!out) {
+            std::cerr << "chess_perft: cannot write " << options.output << "\n";
+            return 1;
+        }
+        out << json << std::endl;
+    }
+    return report.all_correct ? 0 : 1;
+}
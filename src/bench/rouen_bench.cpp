@@ -0,0 +1,269 @@
+// rouen_bench: renders a fixed deck offscreen for N frames and reports timings as JSON.
+//
+// Usage: rouen_bench [--frames N] [--warmup N] [--cards uri;uri;...] [--size WxH] [--output file]
+//
+// The deck is created non-persistent, so workspace.db is neither read nor written. Per-card
+// figures come from the deck's frame profiler and cover its last window of frames.
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include "../helpers/imgui_include.hpp"
+#include <glaze/glaze.hpp>
+#include <SDL.h>
+#include <SDL_image.h>
+
+// 3. All other includes
+#include "../cards/interface/deck.hpp"
+#include "../fonts.hpp"
+#include "../helpers/debug.hpp"
+#include "../helpers/deferred_operations.hpp"
+#include "../helpers/frame_profiler.hpp"
+#include "../helpers/notify_service.hpp"
+#include "../helpers/task_scheduler.hpp"
+#include "../registrar.hpp"
+
+namespace {
+
+struct bench_options {
+    int frames {600};
+    int warmup {60};
+    int width {1920};
+    int height {1080};
+    std::string cards {"menu;sysinfo;pomodoro;alarm;envvars"};
+    std::string output;     // empty = stdout
+};
+
+struct card_report {
+    std::string uri;
+    double p50_ms {0.0};
+    double p99_ms {0.0};
+    double worst_ms {0.0};
+    size_t samples {0};
+};
+
+struct frame_report {
+    double mean_ms {0.0};
+    double p50_ms {0.0};
+    double p99_ms {0.0};
+    double worst_ms {0.0};
+};
+
+struct bench_report {
+    int frames {0};
+    int warmup {0};
+    int width {0};
+    int height {0};
+    std::string renderer;
+    size_t cards_created {0};   // fewer than requested means an unknown uri or a failing card
+    frame_report frame;
+    std::vector<double> frame_ms;
+    std::vector<card_report> cards;
+};
+
+bool parse_options(int argc, char** argv, bench_options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view const arg {argv[i]};
+        auto next = [&]() -> char const* { return i + 1 < argc ? argv[++i] : nullptr; };
+        char const* value = nullptr;
+        if (arg == "--frames" && (value = next())) {
+            options.frames = std::max(1, std::atoi(value));
+        } else if (arg == "--warmup" && (value = next())) {
+            options.warmup = std::max(0, std::atoi(value));
+        } else if (arg == "--cards" && (value = next())) {
+            options.cards = value;
+        } else if (arg == "--size" && (value = next())) {
+            if (std::sscanf(value, "%dx%d", &options.width, &options.height) != 2) {
+                return false;
+            }
+        } else if (arg == "--output" && (value = next())) {
+            options.output = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> split_uris(std::string const& uris) {
+    std::vector<std::string> result;
+    size_t pos = 0;
+    while (pos <= uris.size()) {
+        auto end = uris.find(';', pos);
+        if (end == std::string::npos) {
+            end = uris.size();
+        }
+        if (end > pos) {
+            result.emplace_back(uris.substr(pos, end - pos));
+        }
+        pos = end + 1;
+    }
+    return result;
+}
+
+double percentile(std::vector<double> sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    auto const index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void render_frame(deck& bench_deck, deferred_operations& deferred_ops, SDL_Renderer* renderer) {
+    ImGui_ImplSDLRenderer2_NewFrame();
+    ImGui_ImplSDL2_NewFrame();
+    ImGui::NewFrame();
+    (void)bench_deck.render();
+    ImGui::Render();
+    bench_deck.capture_cached_cards(ImGui::GetDrawData());
+    SDL_SetRenderDrawColor(renderer, 40, 40, 40, 255);
+    SDL_RenderClear(renderer);
+    ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData());
+    deferred_ops.process_queue(renderer);
+    SDL_RenderPresent(renderer);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench_options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: rouen_bench [--frames N] [--warmup N] [--cards uri;uri;...] [--size WxH] [--output file]\n";
+        return 2;
+    }
+
+    // No display needed: the offscreen driver gives a window backed by a software surface
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+        if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
+            SYS_ERROR_FMT("rouen_bench: SDL initialization error: {}", SDL_GetError());
+            return 1;
+        }
+    }
+    IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG);
+
+    SDL_Window* window = SDL_CreateWindow("rouen_bench", 0, 0, options.width, options.height, SDL_WINDOW_HIDDEN);
+    SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE | SDL_RENDERER_TARGETTEXTURE) : nullptr;
+    if (!renderer) {
+        SYS_ERROR_FMT("rouen_bench: could not create an offscreen renderer: {}", SDL_GetError());
+        if (window) {
+            SDL_DestroyWindow(window);
+        }
+        SDL_Quit();
+        return 1;
+    }
+
+    // The same services main() and main_wnd register, minus the interactive ones
+    notify_service notify;
+    auto scheduler = std::make_shared<rouen::helpers::task_scheduler>();
+    registrar::add<rouen::helpers::task_scheduler>("task_scheduler", scheduler);
+    auto deferred_ops = std::make_shared<deferred_operations>();
+    registrar::add<deferred_operations>("deferred_ops", deferred_ops);
+    registrar::add<SDL_Renderer*>("main_renderer", std::make_shared<SDL_Renderer*>(renderer));
+    registrar::add<std::function<std::string()>>("keystrokes",
+        std::make_shared<std::function<std::string()>>([]() { return std::string{}; }));
+    registrar::add<std::function<bool()>>("quitting",
+        std::make_shared<std::function<bool()>>([]() { return false; }));
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;  // keep window positions deterministic between runs
+    rouen::fonts::setup();
+    ImGui::StyleColorsDark();
+    ImGui_ImplSDL2_InitForSDLRenderer(window, renderer);
+    ImGui_ImplSDLRenderer2_Init(renderer);
+
+    SDL_RendererInfo renderer_info {};
+    SDL_GetRendererInfo(renderer, &renderer_info);
+
+    bench_report report;
+    report.frames = options.frames;
+    report.warmup = options.warmup;
+    report.width = options.width;
+    report.height = options.height;
+    report.renderer = renderer_info.name ? renderer_info.name : "";
+    report.frame_ms.reserve(static_cast<size_t>(options.frames));
+
+    {
+        deck bench_deck(renderer, false);
+        for (auto const& uri : split_uris(options.cards)) {
+            bench_deck.create_card(uri);
+        }
+
+        // Let the cards get created and settle their layout before measuring
+        for (int i = 0; i < options.warmup; ++i) {
+            render_frame(bench_deck, *deferred_ops, renderer);
+        }
+        report.cards_created = bench_deck.card_count();
+
+        using clock = std::chrono::steady_clock;
+        for (int i = 0; i < options.frames; ++i) {
+            auto const start = clock::now();
+            render_frame(bench_deck, *deferred_ops, renderer);
+            report.frame_ms.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+        }
+
+        if (auto profiler = registrar::get<rouen::helpers::frame_profiler>("frame_profiler")) {
+            for (auto const& [uri, s] : profiler->snapshot()) {
+                report.cards.push_back({uri, s.p50_ms, s.p99_ms, s.worst_ms, s.samples});
+            }
+            std::sort(report.cards.begin(), report.cards.end(), [](auto const& a, auto const& b) {
+                return a.p99_ms > b.p99_ms;
+            });
+        }
+    }
+
+    double total = 0.0;
+    for (auto ms : report.frame_ms) {
+        total += ms;
+    }
+    report.frame.mean_ms = total / static_cast<double>(report.frame_ms.size());
+    report.frame.p50_ms = percentile(report.frame_ms, 0.50);
+    report.frame.p99_ms = percentile(report.frame_ms, 0.99);
+    report.frame.worst_ms = *std::max_element(report.frame_ms.begin(), report.frame_ms.end());
+
+    ImGui_ImplSDLRenderer2_Shutdown();
+    ImGui_ImplSDL2_Shutdown();
+    ImGui::DestroyContext();
+
+    registrar::remove<std::function<bool()>>("quitting");
+    registrar::remove<std::function<std::string()>>("keystrokes");
+    registrar::remove<SDL_Renderer*>("main_renderer");
+    registrar::remove<deferred_operations>("deferred_ops");
+    registrar::remove<rouen::helpers::task_scheduler>("task_scheduler");
+    scheduler.reset();
+
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    IMG_Quit();
+    SDL_Quit();
+
+    std::string json;
+    if (auto error = glz::write_json(report, json)) {
+        SYS_ERROR_FMT("rouen_bench: failed to serialize the report: {}", glz::format_error(error));
+        return 1;
+    }
+    if (options.output.empty()) {
+        std::cout << json << std::endl;
+    } else {
+        std::ofstream out(options.output);
+        if (!out) {
+            SYS_ERROR_FMT("rouen_bench: cannot write {}", options.output);
+            return 1;
+        }
+        out << json << std::endl;
+    }
+    return 0;
+}
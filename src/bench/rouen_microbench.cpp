@@ -0,0 +1,511 @@
+// rouen_microbench: times the parsers and data paths the cards sit on, over the fixtures in
+// samples/ and payloads generated here (Jira, GitHub, IMAP), and reports them as JSON; given
+// an earlier report it flags the regressions.
+//
+// Usage: rouen_microbench [--filter text] [--min-time ms] [--samples N] [--root dir]
+//                         [--baseline file] [--tolerance percent] [--output file]
+//
+// Each benchmark is run in batches long enough to time (min-time split over the samples) and
+// reports the median time per operation. With --baseline every benchmark the baseline also
+// has is compared by that median; one slower by more than --tolerance (10%) is a regression,
+// and any regression makes the exit code 1. Save a run with --output to use it as one.
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <glaze/glaze.hpp>
+
+// 3. All other includes
+#include "../helpers/chess_com_api.hpp"
+#include "../helpers/logger.hpp"
+#include "../helpers/process_helper.hpp"
+#include "../helpers/sqlite.hpp"
+#include "../helpers/timestamp.hpp"
+#include "../models/calendar/calendar_fetcher.hpp"
+#include "../models/chess/chess.hpp"
+#include "../models/jira_model.hpp"
+#include "../models/mail/imap_host.hpp"
+#include "../models/rss/feed.hpp"
+
+#ifndef ROUEN_SOURCE_DIR
+#define ROUEN_SOURCE_DIR "."
+#endif
+
+namespace {
+
+struct bench_options {
+    std::string filter;
+    int min_time_ms {200};
+    int samples {9};
+    std::string root {ROUEN_SOURCE_DIR};  // the source tree, holding samples/
+    std::string baseline;
+    double tolerance {10.0};
+    std::string output;         // empty = stdout
+};
+
+struct bench_result {
+    std::string name;
+    std::uint64_t iterations {0};       // per sample
+    double ns_per_op {0.0};             // median of the samples
+    double min_ns_per_op {0.0};
+    double mb_per_second {0.0};         // at the median; 0 where input size means nothing
+    double baseline_ns_per_op {0.0};    // 0 = not in the baseline
+    double change_percent {0.0};        // positive = slower than the baseline
+    bool regressed {false};
+};
+
+struct bench_report {
+    std::string build;
+    double tolerance_percent {0.0};
+    bool regressed {false};
+    std::vector<bench_result> benchmarks;
+};
+
+// One operation to time; `bytes` is the input it goes through, for MB/s
+struct benchmark {
+    std::string name;
+    size_t bytes {0};
+    std::function<void()> run;
+};
+
+bool parse_options(int argc, char** argv, bench_options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view const arg {argv[i]};
+        auto next = [&]() -> char const* { return i + 1 < argc ? argv[++i] : nullptr; };
+        char const* value = nullptr;
+        if (arg == "--filter" && (value = next())) {
+            options.filter = value;
+        } else if (arg == "--min-time" && (value = next())) {
+            options.min_time_ms = std::max(1, std::atoi(value));
+        } else if (arg == "--samples" && (value = next())) {
+            options.samples = std::max(1, std::atoi(value));
+        } else if (arg == "--root" && (value = next())) {
+            options.root = value;
+        } else if (arg == "--baseline" && (value = next())) {
+            options.baseline = value;
+        } else if (arg == "--tolerance" && (value = next())) {
+            options.tolerance = std::max(0.0, std::atof(value));
+        } else if (arg == "--output" && (value = next())) {
+            options.output = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string read_file(std::filesystem::path const& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot read fixture " + path.string());
+    }
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+// Keeps the optimizer from dropping a result nobody reads
+template <typename T>
+void keep(T const& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+/**
+ * The answer to a UID FETCH of `count` headers, as an IMAP server sends it: each message an
+ * untagged FETCH with its flags and the header block as a literal.
+ */
+std::string imap_fetch_response(int count) {
+    std::string response;
+    for (int i = 1; i <= count; ++i) {
+        auto const header = std::format(
+            "Date: Thu, {:02} May 2025 09:{:02}:17 +0200\r\n"
+            "From: \"Sender {}\" <sender{}@example.com>\r\n"
+            "To: reader@example.com\r\n"
+            "Subject: Weekly report ({}) - build, cache and deck changes\r\n"
+            "Message-ID: <{}.{}@mail.example.com>\r\n"
+            "Content-Type: multipart/alternative; boundary=\"b{}\"\r\n"
+            "List-Unsubscribe: <https://lists.example.com/unsubscribe/{}>\r\n\r\n",
+            1 + i % 28, i % 60, i % 17, i % 17, i, i, 100 + i, i, i);
+        response += std::format("* {} FETCH (UID {} FLAGS ({}) RFC822.SIZE {} BODY[HEADER] {{{}}}\r\n{})\r\n",
+                                i, 40000 + i, i % 3 ? "\\Seen" : "\\Seen \\Flagged", 4000 + 37 * i, header.size(), header);
+    }
+    response += "A004 OK UID FETCH completed\r\n";
+    return response;
+}
+
+// Words for the generated titles and descriptions
+constexpr std::array<std::string_view, 24> filler_words {
+    "cache", "texture", "retry", "layout", "socket", "render", "flush", "memory", "deck", "timeout", "session", "thread",
+    "parser", "token", "queue", "index", "feed", "fetch", "stream", "image", "search", "sync", "build", "worker"};
+
+std::string filler(int seed, int words) {
+    std::string text;
+    for (int w = 0; w < words; ++w) {
+        text += w ? " " : "";
+        text += filler_words[static_cast<size_t>(seed * 7 + w * 5) % filler_words.size()];
+    }
+    text[0] = static_cast<char>(text[0] - 'a' + 'A');
+    return text;
+}
+
+/**
+ * A Jira search result of `count` issues, compact as the server sends it. Descriptions
+ * alternate between plain text (API v2) and Atlassian document format (v3), and some
+ * issues have no assignee.
+ */
+std::string jira_search_response(int count) {
+    constexpr std::array<std::string_view, 3> statuses {"To Do", "In Progress", "Done"};
+    constexpr std::array<std::string_view, 3> types {"Bug", "Task", "Sub-task"};
+    auto user = [](int id) {
+        return std::format(
+            R"({{"self":"https://example.atlassian.net/rest/api/3/user?accountId=5b10a2844c20165700ede{:03}",)"
+            R"("accountId":"5b10a2844c20165700ede{:03}","emailAddress":"user{}@example.com","avatarUrls":{{)"
+            R"("48x48":"https://avatar.example.com/{}/48x48.png","24x24":"https://avatar.example.com/{}/24x24.png",)"
+            R"("16x16":"https://avatar.example.com/{}/16x16.png","32x32":"https://avatar.example.com/{}/32x32.png"}},)"
+            R"("displayName":"User {}","active":true,"timeZone":"Europe/Madrid","accountType":"atlassian"}})",
+            id, id, id, id, id, id, id, id);
+    };
+    std::string response = std::format(R"({{"expand":"schema,names","startAt":0,"maxResults":{},"total":{},"issues":[)", count, count);
+    for (int i = 0; i < count; ++i) {
+        auto const description = i % 2 == 0
+            ? std::format(R"("{}")", filler(i, 30))
+            : std::format(R"({{"type":"doc","version":1,"content":[{{"type":"paragraph","content":[{{"type":"text","text":"{}"}}]}},)"
+                          R"({{"type":"bulletList","content":[)"
+                          R"({{"type":"listItem","content":[{{"type":"paragraph","content":[{{"type":"text","text":"{}"}}]}}]}},)"
+                          R"({{"type":"listItem","content":[{{"type":"paragraph","content":[{{"type":"text","text":"{}"}}]}}]}}]}}]}})",
+                          filler(i, 12), filler(i + 1, 6), filler(i + 2, 6));
+        std::string labels;
+        for (int l = 0; l < i % 4; ++l) {
+            labels += std::format(R"({}"{}")", l ? "," : "", filler_words[static_cast<size_t>(i + l * 3) % filler_words.size()]);
+        }
+        auto const status = static_cast<size_t>(i) % statuses.size();
+        auto const type = static_cast<size_t>(i / 3) % types.size();
+        response += std::format(
+            R"({}{{"expand":"operations,versionedRepresentations,editmeta,changelog,renderedFields","id":"{}",)"
+            R"("self":"https://example.atlassian.net/rest/api/3/issue/{}","key":"ROU-{}","fields":{{"summary":"{}","description":{},)"
+            R"("issuetype":{{"self":"https://example.atlassian.net/rest/api/3/issuetype/1000{}","id":"1000{}","description":"{} description",)"
+            R"("iconUrl":"https://example.atlassian.net/images/icons/issuetypes/{}.svg","name":"{}","subtask":{},"avatarId":10318,"hierarchyLevel":0}},)"
+            R"("status":{{"self":"https://example.atlassian.net/rest/api/3/status/{}","description":"","iconUrl":"https://example.atlassian.net/",)"
+            R"("name":"{}","id":"{}","statusCategory":{{"self":"https://example.atlassian.net/rest/api/3/statuscategory/{}","id":{},)"
+            R"("key":"new","colorName":"yellow","name":"{}"}}}},"assignee":{},"reporter":{},)"
+            R"("created":"2025-01-{:02}T09:00:12.345+0200","updated":"2025-05-{:02}T17:00:01.000+0200","labels":[{}],)"
+            R"("priority":{{"self":"https://example.atlassian.net/rest/api/3/priority/3","iconUrl":"https://example.atlassian.net/images/icons/priorities/medium.svg",)"
+            R"("name":"Medium","id":"3"}}}}}})",
+            i ? "," : "", 10000 + i, 10000 + i, i + 1, filler(i, 7), description,
+            type, type, types[type], types[type], types[type], type == 2 ? "true" : "false",
+            status + 1, statuses[status], status + 1, status + 1, status + 1, statuses[status],
+            i % 3 == 0 ? std::string{"null"} : user(i % 9), user(i % 5), 1 + i % 28, 1 + i % 28, labels);
+    }
+    response += "]}";
+    return response;
+}
+
+// The repositories of an account as GitHub's REST API lists them, `count` of them, compact
+std::string github_repos_response(int count) {
+    constexpr std::array<std::string_view, 36> urls {
+        "forks", "keys", "collaborators", "teams", "hooks", "issue_events", "events", "assignees", "branches", "tags",
+        "blobs", "git_tags", "git_refs", "trees", "statuses", "languages", "stargazers", "contributors", "subscribers",
+        "subscription", "commits", "git_commits", "comments", "issue_comment", "contents", "compare", "merges", "archive",
+        "downloads", "issues", "pulls", "milestones", "notifications", "labels", "releases", "deployments"};
+    constexpr std::array<std::string_view, 4> languages {"C++", "Go", "Python", "TypeScript"};
+    std::string response = "[";
+    for (int i = 0; i < count; ++i) {
+        auto const name = std::format("{}-{}", filler_words[static_cast<size_t>(i * 5) % filler_words.size()],
+                                      filler_words[static_cast<size_t>(i * 11 + 3) % filler_words.size()]);
+        auto const api = std::format("https://api.github.com/repos/example/{}", name);
+        std::string links;
+        for (auto const url : urls) {
+            links += std::format(R"("{}_url":"{}/{}",)", url, api, url);
+        }
+        response += std::format(
+            R"({}{{"id":{},"node_id":"R_kgDOH{:05}","name":"{}","full_name":"example/{}","private":{},)"
+            R"("owner":{{"login":"example","id":1000,"node_id":"MDQ6VXNlcjEwMDA=","avatar_url":"https://avatars.example.com/u/1000?v=4",)"
+            R"("url":"https://api.github.com/users/example","html_url":"https://github.com/example","type":"User","site_admin":false}},)"
+            R"("html_url":"https://github.com/example/{}","description":{},"fork":{},"url":"{}",{})"
+            R"("created_at":"2018-01-{:02}T10:00:00Z","updated_at":"2025-05-02T08:12:44Z","pushed_at":"2025-05-01T21:03:10Z",)"
+            R"("git_url":"git://github.com/example/{}.git","ssh_url":"git@github.com:example/{}.git","clone_url":"https://github.com/example/{}.git",)"
+            R"("homepage":null,"size":{},"stargazers_count":{},"watchers_count":{},"language":{},"has_issues":true,"has_projects":true,)"
+            R"("has_downloads":true,"has_wiki":true,"has_pages":false,"has_discussions":false,"forks_count":{},"archived":{},"disabled":false,)"
+            R"("open_issues_count":{},"license":{},"allow_forking":true,"is_template":false,"topics":[{}],"visibility":"{}",)"
+            R"("forks":0,"open_issues":0,"watchers":0,"default_branch":"main",)"
+            R"("permissions":{{"admin":true,"maintain":true,"push":true,"triage":true,"pull":true}}}})",
+            i ? "," : "", 200000 + i, i, name, name, i % 5 == 0 ? "true" : "false", name,
+            i % 4 == 0 ? std::string{"null"} : std::format(R"("{}")", filler(i, 9)), i % 6 == 0 ? "true" : "false", api, links,
+            1 + i % 28, name, name, name, 1000 + i * 517 % 60000, i * 37 % 500, i * 53 % 500,
+            i % 7 == 0 ? std::string{"null"} : std::format(R"("{}")", languages[static_cast<size_t>(i) % languages.size()]),
+            i * 13 % 40, i % 9 == 0 ? "true" : "false", i % 5,
+            i % 3 == 0 ? std::string{"null"}
+                       : std::string{R"({"key":"mit","name":"MIT License","spdx_id":"MIT","url":"https://api.github.com/licenses/mit","node_id":"MDc6TGljZW5zZTEz"})"},
+            i % 3 ? std::format(R"("{}")", filler_words[static_cast<size_t>(i) % filler_words.size()]) : std::string{},
+            i % 5 == 0 ? "private" : "public");
+    }
+    response += "]";
+    return response;
+}
+
+std::vector<benchmark> make_benchmarks(std::filesystem::path const& root) {
+    auto const samples = root / "samples";
+    std::vector<benchmark> all;
+
+    // RSS: the streaming parse a refresh runs as the feed downloads, in 16 KB chunks
+    auto const feed_xml = std::make_shared<std::string>(read_file(samples / "feed.xml"));
+    all.push_back({"rss/feed_stream", feed_xml->size(), [feed_xml] {
+        media::rss::feed parsed;
+        for (size_t at = 0; at < feed_xml->size(); at += 16384) {
+            parsed(std::string_view{*feed_xml}.substr(at, 16384));
+        }
+        keep(parsed.items.size());
+    }});
+
+    // Dates: the pubDates of the fixture, through the feed's memoized parse and without the memo
+    auto const dates = std::make_shared<std::vector<std::string>>();
+    for (size_t at = feed_xml->find("<pubDate>"); at != std::string::npos; at = feed_xml->find("<pubDate>", at + 1)) {
+        auto const start = at + 9;
+        dates->push_back(feed_xml->substr(start, feed_xml->find("</pubDate>", start) - start));
+    }
+    dates->insert(dates->end(), {"2025-05-01T10:29:46Z", "2025-05-01T10:29:46.123+02:00", "2025-05-01",
+                                 "Thu, 1 May 2025 10:29:46 GMT", "01 May 2025 10:29:46 -0300"});
+    all.push_back({"date/parse_date", 0, [dates] {
+        media::rss::feed parser;
+        for (auto const& date : *dates) {
+            keep(parser.parse_date(date.c_str()));
+        }
+    }});
+    all.push_back({"date/parse_uncached", 0, [dates] {
+        for (auto const& date : *dates) {
+            keep(timestamp::parse_uncached(date));
+        }
+    }});
+
+    // JSON: the payloads the cards decode, with the options and types they decode them with
+    static constexpr glz::opts lenient {.error_on_unknown_keys = false};
+    auto const jira = std::make_shared<std::string>(jira_search_response(100));
+    all.push_back({"json/jira_search", jira->size(), [jira] {
+        keep(rouen::models::jira_model::parse_search_result(*jira));
+    }});
+    auto const github = std::make_shared<std::string>(github_repos_response(100));
+    all.push_back({"json/github_repos", github->size(), [github] {
+        glz::json_t repos;
+        if (glz::read_json(repos, *github)) {
+            throw std::runtime_error("the generated GitHub repositories do not parse");
+        }
+        keep(repos);
+    }});
+    auto const chess_com = std::make_shared<std::string>(read_file(samples / "05.json"));
+    all.push_back({"json/chess_com_games", chess_com->size(), [chess_com] {
+        rouen::chess::ChessComGamesResponse games;
+        if (glz::read<lenient>(games, *chess_com)) {
+            throw std::runtime_error("05.json does not parse");
+        }
+        keep(games);
+    }});
+    auto const calendar_json = std::make_shared<std::string>(read_file(root / "src/models/calendar/sample.json"));
+    all.push_back({"json/calendar_events", calendar_json->size(), [calendar_json] {
+        calendar::CalendarResponse events;
+        glz::context ctx {};
+        if (glz::read<lenient>(events, *calendar_json, ctx)) {
+            throw std::runtime_error("calendar sample.json does not parse");
+        }
+        keep(events);
+    }});
+
+    // IMAP: a header sync's FETCH responses split into messages, in the chunks curl hands on
+    auto const imap = std::make_shared<std::string>(imap_fetch_response(500));
+    all.push_back({"imap/fetch_stream", imap->size(), [imap] {
+        size_t messages = 0;
+        mail::fetch_stream stream {[&messages](long long, std::string_view, std::string_view) { ++messages; }};
+        for (size_t at = 0; at < imap->size(); at += 16384) {
+            stream.feed(std::string_view{*imap}.substr(at, 16384));
+        }
+        keep(messages);
+    }});
+
+    // Processes: the cost of starting one and getting its output through the runner's pipes,
+    // collected and streamed. Starting `cat` dominates: these track spawn cost, not parsing
+    auto const output_file = std::filesystem::temp_directory_path() / "rouen_microbench_output.json";
+    {
+        std::ofstream out(output_file, std::ios::binary);
+        out << *github;
+        if (!out) {
+            throw std::runtime_error("cannot write " + output_file.string());
+        }
+    }
+    all.push_back({"process/spawn_collect", github->size(), [path = output_file.string()] {
+        auto result = ProcessHelper::run({"cat", path});
+        keep(result.out.size());
+    }});
+    all.push_back({"process/spawn_stream", github->size(), [path = output_file.string()] {
+        size_t bytes = 0;
+        ProcessHelper::ProcessOptions options;
+        options.on_stdout = [&bytes](std::string_view chunk) { bytes += chunk.size(); };
+        auto result = ProcessHelper::run({"cat", path}, std::move(options));
+        keep(bytes);
+    }});
+
+    // SQLite: statements with bound arguments through the prepared-statement cache
+    auto const db = std::make_shared<hosting::db::sqlite>(":memory:");
+    db->exec("CREATE TABLE item (id INTEGER PRIMARY KEY, title TEXT, score REAL)");
+    auto const next_id = std::make_shared<int64_t>(0);
+    all.push_back({"sqlite/insert_bound", 0, [db, next_id] {
+        auto const id = (*next_id)++ % 10000;
+        db->exec("INSERT OR REPLACE INTO item (id, title, score) VALUES (?, ?, ?)", {}, id,
+                 std::string{"Weekly report, build and deck changes"}, static_cast<double>(id) * 0.5);
+    }});
+    all.push_back({"sqlite/select_bound", 0, [db, next_id] {
+        double total = 0.0;
+        db->for_each<int64_t, std::string_view, double>("SELECT id, title, score FROM item WHERE id = ?",
+            [&total](int64_t, std::string_view, double score) { total += score; }, (*next_id)++ % 10000);
+        keep(total);
+    }});
+
+    // Chess: a chess.com game loaded from PGN, and the replay moving through it
+    rouen::chess::ChessComGamesResponse games;
+    (void)glz::read<lenient>(games, *chess_com);
+    auto const pgn = std::make_shared<std::string>(games.games.empty() ? std::string{} : games.games.front().pgn);
+    all.push_back({"chess/load_pgn", pgn->size(), [pgn] {
+        rouen::models::chess::Game game;
+        keep(game.load_from_pgn(*pgn));
+    }});
+    auto const game = std::make_shared<rouen::models::chess::Game>();
+    game->load_from_pgn(*pgn);
+    auto const step = std::make_shared<size_t>(0);
+    all.push_back({"chess/set_position", 0, [game, step] {
+        // Jumps around the game the way scrubbing the replay does
+        auto const moves = game->get_move_count();
+        *step = (*step + 7) % (moves + 1);
+        game->set_position(*step);
+        keep(game->get_current_position());
+    }});
+
+    return all;
+}
+
+double run_batch(benchmark const& b, std::uint64_t iterations) {
+    auto const start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i) {
+        b.run();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+bench_result measure(benchmark const& b, bench_options const& options) {
+    // Grow the batch until it fills its share of the time, then time that many per sample
+    double const sample_ns = options.min_time_ms * 1e6 / options.samples;
+    std::uint64_t iterations = 1;
+    for (auto elapsed = run_batch(b, iterations); elapsed < sample_ns && iterations < (std::uint64_t{1} << 32);) {
+        iterations = elapsed > 0.0 ? std::max(iterations * 2, static_cast<std::uint64_t>(static_cast<double>(iterations) * sample_ns / elapsed))
+                                   : iterations * 2;
+        elapsed = run_batch(b, iterations);
+    }
+
+    std::vector<double> per_op;
+    for (int s = 0; s < options.samples; ++s) {
+        per_op.push_back(run_batch(b, iterations) / static_cast<double>(iterations));
+    }
+    std::sort(per_op.begin(), per_op.end());
+
+    bench_result result {b.name, iterations};
+    result.ns_per_op = per_op[per_op.size() / 2];
+    result.min_ns_per_op = per_op.front();
+    if (b.bytes > 0 && result.ns_per_op > 0.0) {
+        result.mb_per_second = static_cast<double>(b.bytes) / result.ns_per_op * 1e9 / (1024.0 * 1024.0);
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bench_options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: rouen_microbench [--filter text] [--min-time ms] [--samples N] [--root dir]\n"
+                     "                        [--baseline file] [--tolerance percent] [--output file]\n";
+        return 2;
+    }
+
+    // What the parsers log is not what is being timed
+    if (!std::getenv("ROUEN_LOG")) {
+        rouen::helpers::logger::instance().set_level("*", rouen::helpers::logger::level_error);
+    }
+
+    bench_report baseline;
+    if (!options.baseline.empty()) {
+        try {
+            if (auto error = glz::read<glz::opts{.error_on_unknown_keys = false}>(baseline, read_file(options.baseline))) {
+                std::cerr << "rouen_microbench: cannot read the baseline: " << glz::format_error(error) << "\n";
+                return 1;
+            }
+        } catch (std::exception const& e) {
+            std::cerr << "rouen_microbench: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    bench_report report;
+#ifdef NDEBUG
+    report.build = "release";
+#else
+    report.build = "debug";
+#endif
+    report.tolerance_percent = options.tolerance;
+    if (!options.baseline.empty() && baseline.build != report.build) {
+        std::cerr << "rouen_microbench: comparing a " << report.build << " build with a " << baseline.build << " baseline\n";
+    }
+
+    try {
+        for (auto const& b : make_benchmarks(options.root)) {
+            if (!options.filter.empty() && b.name.find(options.filter) == std::string::npos) {
+                continue;
+            }
+            auto result = measure(b, options);
+            auto const before = std::find_if(baseline.benchmarks.begin(), baseline.benchmarks.end(),
+                                             [&b](bench_result const& r) { return r.name == b.name; });
+            if (before != baseline.benchmarks.end() && before->ns_per_op > 0.0) {
+                result.baseline_ns_per_op = before->ns_per_op;
+                result.change_percent = (result.ns_per_op / before->ns_per_op - 1.0) * 100.0;
+                result.regressed = result.change_percent > options.tolerance;
+                std::fprintf(stderr, "%-24s %12.1f ns %12.1f ns %+7.1f%%%s\n", result.name.c_str(), result.ns_per_op,
+                             result.baseline_ns_per_op, result.change_percent, result.regressed ? "  REGRESSED" : "");
+            } else {
+                std::fprintf(stderr, "%-24s %12.1f ns\n", result.name.c_str(), result.ns_per_op);
+            }
+            report.regressed = report.regressed || result.regressed;
+            report.benchmarks.push_back(std::move(result));
+        }
+    } catch (std::exception const& e) {
+        std::cerr << "rouen_microbench: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::string json;
+    if (auto error = glz::write_json(report, json)) {
+        std::cerr << "rouen_microbench: failed to serialize the report: " << glz::format_error(error) << "\n";
+        return 1;
+    }
+    if (options.output.empty()) {
+        std::cout << json << std::endl;
+    } else {
+        std::ofstream out(options.output);
+        if (!out) {
+            std::cerr << "rouen_microbench: cannot write " << options.output << "\n";
+            return 1;
+        }
+        out << json << std::endl;
+    }
+    return report.regressed ? 1 : 0;
+}
@@ -1,18 +1,28 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <format>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <chrono>
-#include <thread>
+#include <cstring>
 
 #include "../../helpers/imgui_include.hpp"
 
 #include "../interface/card.hpp"
 #include "../../registrar.hpp"
+#include "../../helpers/command_stream.hpp"
 #include "../../helpers/platform_utils.hpp"
+#include "../../helpers/redraw.hpp"
+#include "../../helpers/scrollback_buffer.hpp"
+#include "../../helpers/task_scheduler.hpp"
+#include "../../models/cmake_build.hpp"
 
 namespace rouen::cards
 {
@@ -36,8 +46,8 @@ namespace rouen::cards
             // Default to 'build' subdirectory
             build_dir_ = std::filesystem::path(path_).parent_path() / "build";
             
-            // Try to read the CMakeLists.txt file to extract project info
-            read_cmake_file();
+            // Whatever an earlier configure left in the build directory
+            load_project();
         }
 
         std::string get_uri() const override
@@ -45,73 +55,17 @@ namespace rouen::cards
             return std::format("cmake:{}", path_);
         }
 
-        void read_cmake_file()
+        // Project name, targets and sources, read again on a worker after each configure and build
+        void load_project()
         {
-            try {
-                std::ifstream file(path_);
-                if (!file.is_open()) {
-                    error_message_ = "Could not open CMakeLists.txt file";
-                    return;
-                }
-                
-                std::string line;
-                while (std::getline(file, line)) {
-                    // Extract project name
-                    if (line.find("project(") != std::string::npos) {
-                        size_t start = line.find("project(") + 8;
-                        size_t end = line.find(")", start);
-                        if (end != std::string::npos) {
-                            project_name_ = line.substr(start, end - start);
-                            // Clean up whitespace and quotes
-                            while (project_name_.front() == ' ' || project_name_.front() == '"') {
-                                project_name_.erase(0, 1);
-                            }
-                            while (project_name_.back() == ' ' || project_name_.back() == '"') {
-                                project_name_.pop_back();
-                            }
-                        }
-                    }
-                    
-                    // Extract version if available
-                    if (line.find("VERSION") != std::string::npos && project_version_.empty()) {
-                        size_t start = line.find("VERSION") + 7;
-                        size_t end = line.find(")", start);
-                        if (end == std::string::npos) {
-                            end = line.size();
-                        }
-                        project_version_ = line.substr(start, end - start);
-                        // Clean up whitespace
-                        while (!project_version_.empty() && (project_version_.front() == ' ' || project_version_.front() == '"')) {
-                            project_version_.erase(0, 1);
-                        }
-                        while (!project_version_.empty() && (project_version_.back() == ' ' || project_version_.back() == '"' || project_version_.back() == ')')) {
-                            project_version_.pop_back();
-                        }
-                    }
-                    
-                    // Add to list of targets
-                    if (line.find("add_executable(") != std::string::npos || 
-                        line.find("add_library(") != std::string::npos) {
-                        size_t start = line.find('(') + 1;
-                        size_t end = line.find(' ', start);
-                        if (end != std::string::npos) {
-                            std::string target = line.substr(start, end - start);
-                            // Clean up whitespace
-                            while (target.front() == ' ' || target.front() == '"') {
-                                target.erase(0, 1);
-                            }
-                            while (target.back() == ' ' || target.back() == '"') {
-                                target.pop_back();
-                            }
-                            targets_.push_back(target);
-                        }
-                    }
+            rouen::helpers::scheduler()->submit([slot = project_, build_dir = build_dir_](std::stop_token) {
+                auto loaded = std::make_shared<rouen::models::cmake::project const>(rouen::models::cmake::project::load(build_dir));
+                {
+                    std::lock_guard<std::mutex> lock(slot->mutex);
+                    slot->value = std::move(loaded);
                 }
-                
-                file.close();
-            } catch (const std::exception& e) {
-                error_message_ = std::format("Error reading CMakeLists.txt: {}", e.what());
-            }
+                rouen::helpers::request_redraw();
+            }, rouen::helpers::task_priority::high);
         }
 
         bool run_cmake_action(const std::string& action, const std::string& explanation) 
@@ -126,8 +80,10 @@ namespace rouen::cards
                 if (!std::filesystem::exists(build_dir_)) {
                     std::filesystem::create_directories(build_dir_);
                 }
+                // Asks for the code model and compile_commands.json this configure writes
+                rouen::models::cmake::project::request(build_dir_);
                 
-                cmd = std::format("cd {} && cmake -B . -S {}", 
+                cmd = std::format("cd {} && cmake -B . -S {} -DCMAKE_EXPORT_COMPILE_COMMANDS=ON", 
                     build_dir_.string(), 
                     std::filesystem::path(path_).parent_path().string());
             } else if (action == "build") {
@@ -146,123 +102,55 @@ namespace rouen::cards
                 return false;
             }
             
-            // Store process ID for potential cancellation
-            process_pid_ = 0;
-            
             // Clear previous output when starting a new command
-            last_output_.clear();
+            {
+                std::lock_guard<std::mutex> lock(output_mutex_);
+                output_.clear();
+                partial_line_.clear();
+                log_ = rouen::models::cmake::build_log{build_dir_};
+                reload_after_ = action == "configure" || action == "build" || action == "rebuild";
+            }
             
             // Set a timestamp for progress indication
             start_time_ = std::chrono::steady_clock::now();
             
-            auto output_func = std::make_shared<std::function<void(std::string)>>(
-                [this](std::string output) {
-                    // Check for the special completion marker we added to run_command
-                    if (output.find("<PROCESS_COMPLETED>") != std::string::npos) {
-                        // Remove the marker from the displayed output
-                        auto marker_pos = output.find("<PROCESS_COMPLETED>");
-                        if (marker_pos != std::string::npos) {
-                            output = output.substr(0, marker_pos);
-                        }
-                        
-                        // This is our definitive signal that the process is done
-                        this->last_output_ = output;
-                        this->cmd_running_ = false;
-                        this->process_pid_ = 0;
-                        return;
-                    }
-
-                    // We get incremental updates, store them as they arrive
-                    this->last_output_ = output;
-                    
-                    // We're still running unless we see the special marker
-                    this->cmd_running_ = true;
-                    
-                    // Extract process ID if available (only works on Linux)
-                    if (this->process_pid_ == 0) {
-                        // Try to get the PID of the first process from ps
-                        auto pid_pos = output.find("PID:");
-                        if (pid_pos != std::string::npos) {
-                            auto pid_end = output.find('\n', pid_pos);
-                            if (pid_end != std::string::npos) {
-                                auto pid_str = output.substr(pid_pos + 4, pid_end - (pid_pos + 4));
-                                try {
-                                    this->process_pid_ = std::stoi(pid_str);
-                                } catch (...) {
-                                    // Ignore conversion errors
-                                }
-                            }
-                        }
-                    }
-                    
-                    // As a fallback, also check for common completion indicators in the output
-                    // This helps with backward compatibility and cases where the process might
-                    // end without waiting for our marker to be appended
-                    if (output.find("Process exited with code:") != std::string::npos ||
-                        output.find("Process terminated by signal:") != std::string::npos ||
-                        output.find("Built target") != std::string::npos || 
-                        output.find("Build complete") != std::string::npos ||
-                        output.find("Configuring done") != std::string::npos ||
-                        output.find("Installing") != std::string::npos ||
-                        output.find("Error") != std::string::npos ||
-                        output.find("Failed") != std::string::npos) {
-                        
-                        // Wait a short moment to ensure all output is received
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                        this->cmd_running_ = false;
-                        this->process_pid_ = 0;
-                    }
-                });
-
-            // For process tracking, modify the command to output its PID first (Linux only)
-            if (action != "open_dir") {
-                cmd = std::format("echo PID:$$ && {}", cmd);
-            }
-            
-            "run_command"_sfn2(cmd, output_func);
+            // Before the run starts: one that can't start reports its exit right away
             cmd_running_ = true;
             last_cmd_ = cmd;
             last_action_ = explanation;
             
+            // Only new output arrives, on the command's own thread; the previous run has ended
+            run_ = (*registrar::cached<rouen::helpers::run_command_fn, "run_command">().get())(
+                cmd, [this](rouen::helpers::command_event const& event) { on_command_event(event); });
+            
             return true;
         }
 
         void cancel_running_action()
         {
-            if (!cmd_running_) {
-                return;
-            }
-            
-            // Only attempt to kill if we have a PID
-            if (process_pid_ > 0) {
-                std::string kill_cmd = std::format("kill -TERM -{}", process_pid_);
-                
-                // Execute the kill command
-                auto output_func = std::make_shared<std::function<void(std::string)>>(
-                    [this](std::string output) {
-                        this->last_output_ += "\n\n[ACTION CANCELLED BY USER]\n\n" + output;
-                    }
-                );
-                
-                "run_command"_sfn2(kill_cmd, output_func);
+            // The exit event, with cancelled set, ends the run
+            if (cmd_running_ && run_) {
+                run_->cancel();
             }
-            
-            // Mark as not running anymore
-            cmd_running_ = false;
-            process_pid_ = 0;
         }
 
         bool render() override
         {
             return render_window([this]()
             {
+                std::shared_ptr<rouen::models::cmake::project const> project;
+                {
+                    std::lock_guard<std::mutex> lock(project_->mutex);
+                    project = project_->value;
+                }
+                
                 // Project info section
                 ImGui::TextColored(colors[0], "CMake Project: %s", 
-                    project_name_.empty() ? "Unknown" : project_name_.c_str());
+                    !project || project->name.empty() ? "Unknown" : project->name.c_str());
                 
-                if (!project_version_.empty()) {
+                if (project && !project->version.empty()) {
                     ImGui::SameLine();
-                    ImGui::Text("v%s", project_version_.c_str());
+                    ImGui::Text("v%s", project->version.c_str());
                 }
                 
                 // Edit build directory
@@ -272,6 +160,7 @@ namespace rouen::cards
                 
                 if (ImGui::InputText("Build Dir", build_dir_buf, sizeof(build_dir_buf))) {
                     build_dir_ = build_dir_buf;
+                    load_project();
                 }
                 
                 ImGui::Separator();
@@ -363,33 +252,91 @@ namespace rouen::cards
                 } else if (!last_action_.empty()) {
                     ImGui::TextColored(colors[3], "Last action: %s", last_action_.c_str());
                     
-                    // Reset to default frame rate when idle
-                    requested_fps = 1;
+                    // Idle: output and the exit status invalidate the card themselves
+                    requested_fps = 0;
                 }
                 
                 ImGui::Separator();
                 
-                // Targets section if any were found
-                if (!targets_.empty()) {
-                    ImGui::TextColored(colors[0], "Targets");
-                    for (const auto& target : targets_) {
-                        ImGui::BulletText("%s", target.c_str());
+                // Targets section, from the file API reply of the last configure
+                if (project && project->has_codemodel) {
+                    if (ImGui::TreeNode("targets", "Targets (%zu)", project->targets.size())) {
+                        for (auto const& target : project->targets) {
+                            ImGui::BulletText("%s", target.name.c_str());
+                            ImGui::SameLine();
+                            ImGui::TextDisabled("%s", target.type.c_str());
+                        }
+                        ImGui::TreePop();
+                    }
+                    if (!project->sources.empty()) {
+                        ImGui::TextDisabled("%zu sources in compile_commands.json", project->sources.size());
                     }
                     ImGui::Separator();
+                } else if (project && project->configured) {
+                    ImGui::TextDisabled("Configure again to list the targets");
+                    ImGui::Separator();
+                } else if (project) {
+                    ImGui::TextDisabled("Not configured yet");
+                    ImGui::Separator();
                 }
                 
-                // Output section
-                ImGui::TextColored(colors[0], "Output");
+                std::lock_guard<std::mutex> lock(output_mutex_);
                 
-                if (!error_message_.empty()) {
-                    ImGui::TextColored(colors[2], "%s", error_message_.c_str());
+                // Progress of the build, as Ninja ([N/M]) or make ([ NN%]) reports it
+                if (cmd_running_ && log_.total() > 0) {
+                    auto const fraction = static_cast<float>(log_.done()) / static_cast<float>(log_.total());
+                    auto const label = log_.total() == 100 && log_.done() <= 100
+                        ? std::format("{}%", log_.done()) : std::format("{}/{}", log_.done(), log_.total());
+                    ImGui::ProgressBar(fraction, ImVec2(-1, 0), label.c_str());
                 }
                 
-                if (!last_output_.empty()) {
+                // Problems section: each one opens its file in the editor
+                if (!log_.diagnostics().empty()) {
+                    ImGui::TextColored(colors[0], "Problems");
+                    ImGui::SameLine();
+                    ImGui::TextDisabled("%zu errors, %zu warnings", log_.errors(), log_.warnings());
+                    ImGui::BeginChild("Problems", ImVec2(0, std::min(150.0f, ImGui::GetTextLineHeightWithSpacing() * static_cast<float>(log_.diagnostics().size() + 1))), true);
+                    ImGuiListClipper problems;
+                    problems.Begin(static_cast<int>(log_.diagnostics().size()));
+                    while (problems.Step()) {
+                        for (int i = problems.DisplayStart; i < problems.DisplayEnd; ++i) {
+                            auto const& d = log_.diagnostics()[static_cast<size_t>(i)];
+                            auto const error = d.level == rouen::models::cmake::diagnostic::severity::error;
+                            auto const text = std::format("{}:{}: {}##{}", std::filesystem::path{d.file}.filename().string(), d.line, d.message, i);
+                            ImGui::PushStyleColor(ImGuiCol_Text, colors[error ? line_error : line_warning]);
+                            if (ImGui::Selectable(text.c_str())) {
+                                "edit"_sfn(d.file);
+                            }
+                            ImGui::PopStyleColor();
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::SetTooltip("%s:%d:%d", d.file.c_str(), d.line, d.column);
+                            }
+                        }
+                    }
+                    ImGui::EndChild();
+                }
+                
+                // Output section
+                ImGui::TextColored(colors[0], "Output");
+                if (!output_.empty()) {
                     ImGui::BeginChild("ScrollingRegion", ImVec2(0, 200), true, 
                                      ImGuiWindowFlags_HorizontalScrollbar);
                     
-                    ImGui::TextWrapped("%s", last_output_.c_str());
+                    // Only the visible lines are submitted, however long the build log is
+                    ImGuiListClipper clipper;
+                    clipper.Begin(static_cast<int>(output_.size()));
+                    while (clipper.Step()) {
+                        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                            auto const [text, tag] = output_.line(static_cast<size_t>(i));
+                            if (tag != line_plain) {
+                                ImGui::PushStyleColor(ImGuiCol_Text, colors[tag]);
+                            }
+                            ImGui::TextUnformatted(text.data(), text.data() + text.size());
+                            if (tag != line_plain) {
+                                ImGui::PopStyleColor();
+                            }
+                        }
+                    }
                     
                     if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
                         ImGui::SetScrollHereY(1.0f);
@@ -401,17 +348,102 @@ namespace rouen::cards
         }
 
     private:
+        // Output line tags, which double as indexes into colors
+        static constexpr uint8_t line_plain = 0;
+        static constexpr uint8_t line_error = 2;
+        static constexpr uint8_t line_success = 3;
+        static constexpr uint8_t line_warning = 4;
+
+        // On the command's thread
+        void on_command_event(rouen::helpers::command_event const& event)
+        {
+            std::lock_guard<std::mutex> lock(output_mutex_);
+            if (event.type == rouen::helpers::command_event::kind::output) {
+                auto chunk = event.output;
+                while (auto const* newline = static_cast<char const*>(std::memchr(chunk.data(), '\n', chunk.size()))) {
+                    auto const length = static_cast<size_t>(newline - chunk.data());
+                    if (partial_line_.empty()) {
+                        append_line(chunk.substr(0, length));
+                    } else {
+                        partial_line_.append(chunk.data(), length);
+                        append_line(partial_line_);
+                        partial_line_.clear();
+                    }
+                    chunk.remove_prefix(length + 1);
+                }
+                partial_line_.append(chunk);
+            } else {
+                if (!partial_line_.empty()) {
+                    append_line(partial_line_);
+                    partial_line_.clear();
+                }
+                std::string status;
+                if (event.cancelled) {
+                    status = "[ACTION CANCELLED BY USER]";
+                } else if (event.exit_code >= 0) {
+                    status = std::format("Process exited with code: {}", event.exit_code);
+                } else {
+                    status = std::format("Process terminated by signal: {}", event.signal);
+                }
+                output_.append("", line_plain);
+                output_.append(status, event.exit_code == 0 && !event.cancelled ? line_success : line_error);
+                cmd_running_ = false;
+                if (reload_after_) {
+                    load_project();
+                }
+            }
+            invalidate();
+        }
+
+        // Under output_mutex_
+        void append_line(std::string_view line)
+        {
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            using kind = rouen::models::cmake::build_log::line_kind;
+            auto tag = line_plain;
+            switch (log_.feed(line)) {
+            case kind::error:
+                tag = line_error;
+                break;
+            case kind::warning:
+                tag = line_warning;
+                break;
+            case kind::plain:
+                // CMake's own messages, and linker errors, which carry no file:line
+                if (line.starts_with("CMake Error") || line.find(" error:") != std::string_view::npos
+                    || line.starts_with("FAILED:") || line.starts_with("ninja: build stopped")) {
+                    tag = line_error;
+                } else if (line.starts_with("CMake Warning")) {
+                    tag = line_warning;
+                }
+                break;
+            case kind::progress:
+                break;
+            }
+            output_.append(line, tag);
+        }
+
+        // Shared with the worker loading it
+        struct project_slot {
+            std::mutex mutex;
+            std::shared_ptr<rouen::models::cmake::project const> value;
+        };
+
         std::string path_;
         std::filesystem::path build_dir_;
-        std::string project_name_;
-        std::string project_version_;
-        std::vector<std::string> targets_;
-        std::string error_message_;
-        std::string last_output_;
+        std::shared_ptr<project_slot> project_ {std::make_shared<project_slot>()};
         std::string last_cmd_;
         std::string last_action_;
-        bool cmd_running_ = false;
+        std::atomic<bool> cmd_running_ {false};
         std::chrono::steady_clock::time_point start_time_;
-        pid_t process_pid_ = 0; // Process ID for tracking the running command
+        
+        std::mutex output_mutex_;                       // guards output_, partial_line_, log_ and reload_after_
+        rouen::helpers::scrollback_buffer output_ {20000, 8 << 20};
+        std::string partial_line_;                      // output after the last newline
+        rouen::models::cmake::build_log log_;           // progress and diagnostics of the current run
+        bool reload_after_ {false};                     // the run can change targets or sources
+        std::unique_ptr<rouen::helpers::command_run> run_;  // last, so it stops before the output goes
     };
 }
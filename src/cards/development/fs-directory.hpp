@@ -1,13 +1,28 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
 #include <filesystem>
 #include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <regex>
+#include <unordered_map>
+#include <vector>
 
 #include "../../helpers/imgui_include.hpp"
+#include "../../helpers/dir_size.hpp"
+#include "../../helpers/dir_watch.hpp"
+#include "../../helpers/file_index.hpp"
 #include "../../helpers/platform_utils.hpp"
+#include "../../helpers/redraw.hpp"
+#include "../../helpers/task_scheduler.hpp"
+#include "../../helpers/timer_wheel.hpp"
 
 #include "../interface/card.hpp"
 
@@ -62,7 +77,7 @@ namespace rouen::cards
                 path_ = std::filesystem::current_path();
             }
 
-            name(path_.string());
+            open(path_);
         }
 
         std::string get_uri() const override
@@ -107,9 +122,15 @@ namespace rouen::cards
                                  {
                 if (ImGui::IsWindowFocused()) {
                     receive_keystrokes();
+                    if (ImGui::IsKeyPressed(ImGuiKey_F5)) {
+                        listing_->stale = true;     // by hand, for when nothing watches
+                        rescan_sizes_ = true;       // and for files that grew in place
+                    }
                 }
+                refresh_if_stale();
                 
                 // List files in the directory
+                std::optional<std::filesystem::path> go_to;
                 ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[2])); // Parent directory color
                 if (ImGui::Selectable("..")) {
                     // Go up one directory
@@ -119,73 +140,402 @@ namespace rouen::cards
                         "create_card"_sfn(std::format("dir:{}", entry.string()));
                     } else {
                         // otherwise, open in the same card
-                        path_ = entry;
-                        name(path_.string());
+                        go_to = entry;
                     }
                 }
                 ImGui::PopStyleColor();
                 
-                for (const auto& entry : std::filesystem::directory_iterator(path_)) {
-                    if (filter_.empty() || entry.path().filename().string().starts_with(filter_)) {
-                    // Set color based on file type
-                        if (entry.is_directory()) {
-                            ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[3])); // Directories
-                        } else if (entry.is_regular_file()) {
-                            // Check file extension for common types
-                            std::string ext = entry.path().extension().string();
-                            if (ext == ".cpp" || ext == ".hpp" || ext == ".h" || ext == ".c" || ext == ".cc") {
-                                ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[4])); // Code files
-                            } else if (ext == ".txt" || ext == ".md" || ext == ".json" || ext == ".yaml" || ext == ".yml") {
-                                ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[5])); // Text files
-                            } else if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".gif" || ext == ".bmp") {
-                                ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[6])); // Image files
-                            } else if (ext == ".exe" || ext == "" || ext == ".bin" || ext == ".sh") {
-                                ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[7])); // Executable files
-                            } else {
-                                ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[8])); // Other files
-                            }
-                        } else if (entry.is_symlink()) {
-                            ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[9])); // Symlinks
-                        } else {
-                            ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[8])); // Other types
+                std::shared_ptr<std::vector<listed_entry> const> entries;
+                {
+                    std::lock_guard<std::mutex> lock(listing_->mutex);
+                    entries = listing_->entries;
+                    if (!listing_->error.empty()) {
+                        ImGui::TextDisabled("%s", listing_->error.c_str());
+                    }
+                }
+                if (!entries) {
+                    ImGui::TextDisabled("Listing...");
+                    return;
+                }
+                measure_sizes(entries);
+                
+                // The rows the filter lets through, worked out again only when it or the listing changes
+                if (entries != shown_entries_ || filter_ != shown_filter_) {
+                    shown_entries_ = entries;
+                    shown_filter_ = filter_;
+                    shown_.clear();
+                    if (filter_.empty()) {
+                        for (uint32_t i = 0; i < entries->size(); ++i) {
+                            shown_.push_back(i);
+                        }
+                    }
+                }
+                
+                // A filter searches everything below the directory instead
+                if (!filter_.empty()) {
+                    render_search(go_to);
+                    if (go_to) {
+                        open(*go_to);
+                    }
+                    return;
+                }
+                
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(shown_.size()), ImGui::GetTextLineHeightWithSpacing());
+                while (clipper.Step()) {
+                    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                        auto const& entry = (*entries)[shown_[static_cast<size_t>(row)]];
+                        ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[entry.color]));
+                        bool const clicked = ImGui::Selectable(entry.name.c_str());
+                        ImGui::PopStyleColor(); // Don't forget to pop the color after each item
+                        if (auto const details = row_details(entry); !details.empty()) {
+                            auto const details_width = ImGui::CalcTextSize(details.c_str()).x;
+                            ImGui::SameLine(std::max(ImGui::GetWindowContentRegionMax().x - details_width, 0.0f));
+                            ImGui::TextDisabled("%s", details.c_str());
                         }
-                        
-                        if (ImGui::Selectable(entry.path().filename().string().c_str())) {
-                            if (entry.is_directory()) {
-                                // if Ctrl is pressed, open on a different card
-                                if (ImGui::GetIO().KeyCtrl) {
-                                    if (ImGui::GetIO().KeyShift) {
-                                        // open as terminal
-                                        "create_card"_sfn(std::format("terminal:{}", entry.path().string()));
-                                    }
-                                    else {
-                                        // open in a new card
-                                        "create_card"_sfn(std::format("dir:{}", entry.path().string()));
-                                    }
-                                } else {
-                                    // open in the same card
-                                    path_ = entry.path();
-                                    name(path_.string());
-                                    filter_.clear();
+                        if (!clicked) {
+                            continue;
+                        }
+                        if (entry.is_directory) {
+                            // if Ctrl is pressed, open on a different card
+                            if (ImGui::GetIO().KeyCtrl) {
+                                if (ImGui::GetIO().KeyShift) {
+                                    // open as terminal
+                                    "create_card"_sfn(std::format("terminal:{}", entry.path.string()));
                                 }
-                            }
-                            else {
-                                // If Ctrl is pressed and it's a CMakeLists.txt file, open a cmake card
-                                if (ImGui::GetIO().KeyCtrl && entry.path().filename() == "CMakeLists.txt") {
-                                    "create_card"_sfn(std::format("cmake:{}", entry.path().string()));
-                                } else {
-                                    // For other files or normal clicking, use the default editor
-                                    "edit"_sfn(entry.path().string());
+                                else {
+                                    // open in a new card
+                                    "create_card"_sfn(std::format("dir:{}", entry.path.string()));
                                 }
+                            } else {
+                                // open in the same card
+                                go_to = entry.path;
                             }
                         }
-                        ImGui::PopStyleColor(); // Don't forget to pop the color after each item
+                        else {
+                            // If Ctrl is pressed and it's a CMakeLists.txt file, open a cmake card
+                            if (ImGui::GetIO().KeyCtrl && entry.name == "CMakeLists.txt") {
+                                "create_card"_sfn(std::format("cmake:{}", entry.path.string()));
+                            } else {
+                                // For other files or normal clicking, use the default editor
+                                "edit"_sfn(entry.path.string());
+                            }
+                        }
+                    }
                 }
-            } });
+                if (go_to) {
+                    open(*go_to);
+                } });
+        }
+
+        // The listing, sizes, file index and watch go; resume() lists the directory again, keeping the filter
+        void hibernate() override {
+            search_stop_.request_stop();
+            sizes_stop_.request_stop();
+            watch_.reset();
+            listing_ = std::make_shared<listing>();
+            shown_entries_.reset();
+            shown_.clear();
+            shown_.shrink_to_fit();
+            sizes_.clear();
+            sized_entries_.reset();
+            index_.reset();
+            shown_hits_.clear();
+            shown_hits_.shrink_to_fit();
+        }
+
+        void resume() override {
+            auto filter = std::move(filter_);
+            open(path_);
+            filter_ = std::move(filter);
+        }
+
+        size_t resident_bytes() const override {
+            size_t bytes = shown_.capacity() * sizeof(uint32_t) + shown_hits_.capacity() * sizeof(rouen::helpers::file_index::hit);
+            if (shown_entries_) {
+                bytes += shown_entries_->size() * (sizeof(listed_entry) + 64);
+            }
+            if (index_) {
+                bytes += index_->size() * 64;   // a path and its entry, give or take
+            }
+            return bytes;
         }
 
     private:
+        static constexpr auto min_refresh_interval = std::chrono::milliseconds{250};
+        static constexpr size_t max_search_hits = 500;
+
+        // A row, with everything it shows worked out when the directory was listed
+        struct listed_entry {
+            std::filesystem::path path;
+            std::string name;
+            std::string details;        // size and modification time
+            int color {8};              // index in colors
+            bool is_directory {false};
+        };
+
+        // One directory's listing, shared with the worker filling it and the watch marking it stale
+        struct listing {
+            std::mutex mutex;
+            std::shared_ptr<std::vector<listed_entry> const> entries;
+            std::string error;
+            bool loading {false};
+            std::atomic<bool> stale {true};
+            std::chrono::steady_clock::time_point loaded_at;
+        };
+
+        // The latest fuzzy search's hits, filled on a worker
+        struct search_results {
+            std::mutex mutex;
+            std::vector<rouen::helpers::file_index::hit> hits;
+            std::string query;      // what hits are for
+            size_t generation {0};
+        };
+
+        void open(std::filesystem::path const& path) {
+            path_ = path;
+            name(path_.string());
+            filter_.clear();
+            listing_ = std::make_shared<listing>();
+            shown_entries_.reset();
+            search_stop_.request_stop();
+            sizes_stop_.request_stop();
+            sizes_stop_ = std::stop_source{};
+            sizes_.clear();
+            sized_entries_.reset();
+            index_.reset();     // built again, under the new path, once something is typed
+            results_ = std::make_shared<search_results>();
+            searching_ = std::make_shared<std::atomic<bool>>(false);
+            searched_filter_.clear();
+            searched_size_ = 0;
+            shown_hits_.clear();
+            shown_generation_ = 0;
+            watch_ = rouen::helpers::dir_watch::instance().subscribe(path_.string(), [l = std::weak_ptr<listing>(listing_)]() {
+                if (auto const current = l.lock()) {
+                    current->stale = true;
+                    rouen::helpers::request_redraw();
+                }
+            });
+        }
+
+        // A change seen while a listing is under way lists again once it is in
+        void refresh_if_stale() {
+            auto const now = std::chrono::steady_clock::now();
+            {
+                std::lock_guard<std::mutex> lock(listing_->mutex);
+                if (listing_->loading || !listing_->stale) {
+                    return;
+                }
+                // Too soon after the last listing: come back when the interval is over
+                if (now - listing_->loaded_at < min_refresh_interval) {
+                    if (auto const timers = rouen::helpers::timers()) {
+                        refresh_timer_ = timers->at(listing_->loaded_at + min_refresh_interval, [this]() { invalidate(); });
+                    }
+                    return;
+                }
+                listing_->loading = true;
+                listing_->stale = false;
+            }
+            rouen::helpers::scheduler()->submit([l = listing_, path = path_](std::stop_token) {
+                std::error_code ec;
+                auto entries = std::make_shared<std::vector<listed_entry>>();
+                std::filesystem::directory_iterator pos(path, ec);
+                for (; !ec && pos != std::filesystem::directory_iterator(); pos.increment(ec)) {
+                    entries->push_back(describe(*pos));
+                }
+                std::sort(entries->begin(), entries->end(), [](auto const& a, auto const& b) { return a.name < b.name; });
+                std::lock_guard<std::mutex> lock(l->mutex);
+                l->entries = std::move(entries);
+                l->error = ec ? std::format("Cannot list {}: {}", path.string(), ec.message()) : std::string{};
+                l->loading = false;
+                l->loaded_at = std::chrono::steady_clock::now();
+                rouen::helpers::request_redraw();
+            }, rouen::helpers::task_priority::high);
+        }
+
+        // Directory sizes: a walk per subdirectory not measured yet, or all of them again after F5
+        void measure_sizes(std::shared_ptr<std::vector<listed_entry> const> const& entries) {
+            if (entries == sized_entries_ && !rescan_sizes_) {
+                return;
+            }
+            sized_entries_ = entries;
+            if (rescan_sizes_) {
+                sizes_stop_.request_stop();
+                sizes_stop_ = std::stop_source{};
+                sizes_.clear();
+            }
+            std::unordered_map<std::string, std::shared_ptr<rouen::helpers::dir_sizes::measurement>> kept;
+            for (auto const& entry : *entries) {
+                if (!entry.is_directory) {
+                    continue;
+                }
+                auto pos = sizes_.find(entry.name);
+                kept[entry.name] = pos != sizes_.end()
+                    ? pos->second
+                    : rouen::helpers::dir_sizes::instance().measure(entry.path.string(), sizes_stop_, rescan_sizes_);
+            }
+            sizes_ = std::move(kept);
+            rescan_sizes_ = false;
+        }
+
+        // Directories lead with their size: exact once measured, the last one known (~) or what
+        // is counted so far (...) until then
+        std::string row_details(listed_entry const& entry) const {
+            auto const pos = entry.is_directory ? sizes_.find(entry.name) : sizes_.end();
+            if (pos == sizes_.end()) {
+                return entry.details;
+            }
+            auto const& size = *pos->second;
+            auto const text = size.done ? rouen::helpers::dir_sizes::human(size.bytes)
+                : size.last_bytes >= 0 ? std::format("~{}", rouen::helpers::dir_sizes::human(static_cast<uint64_t>(size.last_bytes.load())))
+                : std::format("{}...", rouen::helpers::dir_sizes::human(size.bytes));
+            return entry.details.empty() ? text : std::format("{}  {}", text, entry.details);
+        }
+
+        // Searches the index again when the filter changed or the index grew, one search at a time
+        void search_if_needed() {
+            if (!index_) {
+                index_ = rouen::helpers::file_index::build(path_);
+            }
+            auto const size = index_->size();
+            if (filter_ == searched_filter_ && size == searched_size_) {
+                return;
+            }
+            if (filter_ == searched_filter_ && searching_->load(std::memory_order_acquire)) {
+                return;     // the index grew meanwhile; looked at again when this one is in
+            }
+            search_stop_.request_stop();
+            search_stop_ = std::stop_source{};
+            searched_filter_ = filter_;
+            searched_size_ = size;
+            searching_->store(true, std::memory_order_release);
+            index_->search(filter_, max_search_hits, search_stop_,
+                [r = results_, busy = searching_, query = filter_](std::vector<rouen::helpers::file_index::hit> hits) {
+                    {
+                        std::lock_guard<std::mutex> lock(r->mutex);
+                        r->hits = std::move(hits);
+                        r->query = query;
+                        ++r->generation;
+                    }
+                    busy->store(false, std::memory_order_release);
+                    rouen::helpers::request_redraw();
+                });
+        }
+
+        void render_search(std::optional<std::filesystem::path>& go_to) {
+            search_if_needed();
+            {
+                std::lock_guard<std::mutex> lock(results_->mutex);
+                if (results_->generation != shown_generation_) {
+                    shown_hits_ = results_->hits;
+                    shown_generation_ = results_->generation;
+                }
+            }
+            if (!index_->ready()) {
+                ImGui::TextDisabled("Indexing... %zu paths", index_->size());
+            }
+            ImGui::TextDisabled("%s", std::format("{} match{} for \"{}\"", shown_hits_.size(),
+                shown_hits_.size() == 1 ? "" : "es", filter_).c_str());
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(shown_hits_.size()), ImGui::GetTextLineHeightWithSpacing());
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                    auto const& hit = shown_hits_[static_cast<size_t>(row)];
+                    auto const full = path_ / hit.path;
+                    auto const color = hit.is_directory ? 3 : color_for(full.extension().string());
+                    ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[color]));
+                    bool const clicked = ImGui::Selectable(hit.path.c_str());
+                    ImGui::PopStyleColor();
+                    if (!clicked) {
+                        continue;
+                    }
+                    if (!hit.is_directory) {
+                        "edit"_sfn(full.string());
+                    } else if (ImGui::GetIO().KeyCtrl) {
+                        "create_card"_sfn(std::format("{}:{}", ImGui::GetIO().KeyShift ? "terminal" : "dir", full.string()));
+                    } else {
+                        go_to = full;
+                    }
+                }
+            }
+        }
+
+        static int color_for(std::string const& ext) {
+            if (ext == ".cpp" || ext == ".hpp" || ext == ".h" || ext == ".c" || ext == ".cc") {
+                return 4; // Code files
+            } else if (ext == ".txt" || ext == ".md" || ext == ".json" || ext == ".yaml" || ext == ".yml") {
+                return 5; // Text files
+            } else if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".gif" || ext == ".bmp") {
+                return 6; // Image files
+            } else if (ext == ".exe" || ext == "" || ext == ".bin" || ext == ".sh") {
+                return 7; // Executable files
+            }
+            return 8; // Other files
+        }
+
+        static listed_entry describe(std::filesystem::directory_entry const& entry) {
+            std::error_code ec;
+            listed_entry row;
+            row.path = entry.path();
+            row.name = entry.path().filename().string();
+            // Set color based on file type
+            if (entry.is_directory(ec)) {
+                row.is_directory = true;
+                row.color = 3; // Directories
+            } else if (entry.is_regular_file(ec)) {
+                // Check file extension for common types
+                row.color = color_for(entry.path().extension().string());
+                if (auto const size = entry.file_size(ec); !ec) {
+                    row.details = human_size(size);
+                }
+            } else if (entry.is_symlink(ec)) {
+                row.color = 9; // Symlinks
+            }
+            if (auto const mtime = entry.last_write_time(ec); !ec) {
+                auto const seconds = std::chrono::system_clock::to_time_t(
+                    std::chrono::time_point_cast<std::chrono::system_clock::duration>(std::chrono::file_clock::to_sys(mtime)));
+                std::tm local {};
+                localtime_r(&seconds, &local);
+                char stamp[32];
+                std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M", &local);
+                row.details += row.details.empty() ? stamp : std::format("  {}", stamp);
+            }
+            return row;
+        }
+
+        static std::string human_size(uintmax_t bytes) {
+            if (bytes < 1024) {
+                return std::format("{} B", bytes);
+            }
+            constexpr char const* units[] = {"KB", "MB", "GB", "TB"};
+            auto value = static_cast<double>(bytes) / 1024.0;
+            size_t unit = 0;
+            while (value >= 1024.0 && unit + 1 < std::size(units)) {
+                value /= 1024.0;
+                ++unit;
+            }
+            return std::format("{:.1f} {}", value, units[unit]);
+        }
+
         std::filesystem::path path_;
         std::string filter_;
+        std::shared_ptr<listing> listing_;
+        std::shared_ptr<std::vector<listed_entry> const> shown_entries_;   // what shown_ was worked out for
+        std::string shown_filter_;
+        std::vector<uint32_t> shown_;
+        std::unique_ptr<rouen::helpers::dir_watch::subscription> watch_;
+        rouen::helpers::timer_wheel::timer refresh_timer_;     // a change that came too soon after the last listing
+        std::unordered_map<std::string, std::shared_ptr<rouen::helpers::dir_sizes::measurement>> sizes_;    // by name
+        std::shared_ptr<std::vector<listed_entry> const> sized_entries_;   // what sizes_ was worked out for
+        std::stop_source sizes_stop_;
+        bool rescan_sizes_ {false};
+        std::shared_ptr<rouen::helpers::file_index> index_;
+        std::shared_ptr<search_results> results_;
+        std::shared_ptr<std::atomic<bool>> searching_ {std::make_shared<std::atomic<bool>>(false)};
+        std::stop_source search_stop_;
+        std::string searched_filter_;
+        size_t searched_size_ {0};
+        std::vector<rouen::helpers::file_index::hit> shown_hits_;
+        size_t shown_generation_ {0};
     };
 }
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <format>
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
 #include <string>
 #include <vector>
 
@@ -14,7 +19,6 @@
 #include "../../registrar.hpp"
 
 struct git: public card {
-    std::string repo_status; // Store the git status result
     std::unique_ptr<rouen::models::git> git_model; // Git model for handling git operations
     
     git() {
@@ -30,6 +34,39 @@ struct git: public card {
         return "git";
     }
     
+    ~git() override {
+        view_stop.request_stop();
+    }
+
+    // The selected repository's texts go; resume() loads them again for the same repository
+    void hibernate() override {
+        view_stop.request_stop();
+        view.reset();
+    }
+
+    void resume() override {
+        if (!selected_repo.empty() && !select(selected_repo)) {
+            selected_repo.clear();
+        }
+    }
+
+    size_t resident_bytes() const override {
+        if (!view) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(view->mutex);
+        size_t bytes = view->status.size() + view->push_result.size() +
+            view->commits.capacity() * sizeof(rouen::models::GitCommit) +
+            view->changes.capacity() * sizeof(rouen::models::GitFileChange);
+        for (auto const& commit : view->commits) {
+            bytes += commit.subject.size() + commit.author.size();
+        }
+        if (view->diff) {
+            bytes += view->diff->text.size() + view->diff->lines.capacity() * sizeof(view->diff->lines.front());
+        }
+        return bytes;
+    }
+    
     /**
      * Select a repository and get its current git status
      * 
@@ -37,11 +74,14 @@ struct git: public card {
      * @return true if successful, false if failed
      */
     bool select(const std::string& repo_path) {
-        if (repo_path.empty() || git_model->getRepos().find(repo_path) == git_model->getRepos().end()) {
+        if (repo_path.empty() || !git_model->hasRepo(repo_path)) {
             return false;
         }
 
         this->selected_repo = repo_path;
+        view_stop.request_stop();
+        view_stop = std::stop_source{};
+        view = std::make_shared<repo_view>();
         this->updateRepoStatus();
         
         return true;
@@ -52,21 +92,31 @@ struct git: public card {
      */
     void back_to_list() {
         selected_repo.clear();
+        view_stop.request_stop();
+        view.reset();
     }
     
     /**
-     * Update the repository status by using the git model
+     * Update the repository status by using the git model; the text arrives from a worker
      * 
-     * @return true if successful, false if failed
+     * @return true if a refresh was started
      */
     bool updateRepoStatus() {
-        if (selected_repo.empty()) {
+        if (selected_repo.empty() || !view) {
             return false;
         }
         
-        // Use the git model to get the status
-        repo_status = git_model->getGitStatus(selected_repo);
-        return !repo_status.empty();
+        {
+            std::lock_guard<std::mutex> lock(view->mutex);
+            view->status_loading = true;
+        }
+        git_model->loadStatusText(selected_repo, [v = view](std::string text) {
+            std::lock_guard<std::mutex> lock(v->mutex);
+            v->status = std::move(text);
+            v->status_loading = false;
+        }, view_stop);
+        reloadChanges();
+        return true;
     }
     
     // Helper function to scale and offset SVG coordinates
@@ -97,12 +147,43 @@ struct git: public card {
         }
         
         ImGui::Text("Repository: %s", selected_repo.c_str());
+        
+        // Exact counts from the machine-readable status, beside the human one below
+        auto const counts = git_model->getStatusCounts(selected_repo);
+        ImGui::TextDisabled("%s: %zu staged, %zu modified, %zu untracked, %zu conflicted",
+            counts.branch.empty() ? "?" : counts.branch.c_str(),
+            counts.staged, counts.modified, counts.untracked, counts.conflicted);
+        if (counts.has_upstream) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%d ahead, %d behind)", counts.ahead, counts.behind);
+        }
                     
-        // Display the git status
         ImGui::Separator();
-        ImGui::BeginChild("GitStatus", ImVec2(0, ImGui::GetWindowHeight() - 130.0f), true);
-        ImGui::TextWrapped("%s", repo_status.c_str());
-        ImGui::EndChild();
+        auto const body = ImVec2(0, -ImGui::GetFrameHeightWithSpacing());
+        if (ImGui::BeginTabBar("GitRepoTabs")) {
+            if (ImGui::BeginTabItem("Status")) {
+                // Display the git status
+                ImGui::BeginChild("GitStatus", body, true);
+                {
+                    std::lock_guard<std::mutex> lock(view->mutex);
+                    if (view->status.empty() && view->status_loading) {
+                        ImGui::TextDisabled("Loading...");
+                    }
+                    ImGui::TextWrapped("%s", view->status.c_str());
+                }
+                ImGui::EndChild();
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Commits")) {
+                render_commits(body);
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Changes")) {
+                render_changes(body);
+                ImGui::EndTabItem();
+            }
+            ImGui::EndTabBar();
+        }
 
         // Repository actions using SmallButton
         // Refresh Status button
@@ -117,20 +198,149 @@ struct git: public card {
         }
         
         // Add "Push" button only when the branch is ahead
-        bool is_ahead = git_model->isBranchAhead(selected_repo);
-        if (is_ahead) {
+        if (counts.ahead > 0) {
             ImGui::SameLine();
             if (ImGui::SmallButton("Push")) {
                 // Store push result
                 std::string push_result = git_model->gitPush(selected_repo);
-                // Refresh status after push
+                // Refresh status after push, keeping the push result on top of it
                 updateRepoStatus();
-                // Prepend push result to status display
                 if (!push_result.empty()) {
-                    repo_status = push_result + "\n\n" + repo_status;
+                    std::lock_guard<std::mutex> lock(view->mutex);
+                    view->push_result = std::move(push_result);
+                }
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(view->mutex);
+            if (!view->push_result.empty()) {
+                ImGui::TextWrapped("%s", view->push_result.c_str());
+            }
+        }
+    }
+    
+    // History a page at a time: the next one is asked for as the list nears its end
+    void render_commits(ImVec2 size) {
+        ImGui::BeginChild("GitCommits", size, true);
+        std::lock_guard<std::mutex> lock(view->mutex);
+        auto const line_height = ImGui::GetTextLineHeightWithSpacing();
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(view->commits.size()), line_height);
+        int last_shown = 0;
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                auto const& commit = view->commits[static_cast<size_t>(i)];
+                ImGui::TextColored(colors[0], "%s", commit.short_hash.c_str());
+                ImGui::SameLine();
+                ImGui::TextDisabled("%s %s", commit.date.c_str(), commit.author.c_str());
+                ImGui::SameLine();
+                ImGui::TextUnformatted(commit.subject.c_str());
+                last_shown = i + 1;
+            }
+        }
+        if (view->commits_loading) {
+            ImGui::TextDisabled("Loading...");
+        } else if (!view->commits_done && last_shown + static_cast<int>(commit_page / 4) >= static_cast<int>(view->commits.size())) {
+            view->commits_loading = true;
+            git_model->loadCommits(selected_repo, view->commits.size(), commit_page,
+                [v = view](std::vector<rouen::models::GitCommit> page) {
+                    std::lock_guard<std::mutex> lock(v->mutex);
+                    v->commits_done = page.size() < commit_page;
+                    v->commits.insert(v->commits.end(), std::make_move_iterator(page.begin()), std::make_move_iterator(page.end()));
+                    v->commits_loading = false;
+                }, view_stop);
+        }
+        ImGui::EndChild();
+    }
+    
+    void reloadChanges() {
+        git_model->loadChanges(selected_repo, [v = view](std::vector<rouen::models::GitFileChange> changes) {
+            std::lock_guard<std::mutex> lock(v->mutex);
+            v->changes = std::move(changes);
+            v->changes_loaded = true;
+            // A diff on screen may be stale now; it loads again on the next expand
+            v->diff.reset();
+            v->diff_path.clear();
+        }, view_stop);
+    }
+    
+    // Changed files; the one expanded shows its diff, loaded only then
+    void render_changes(ImVec2 size) {
+        ImGui::BeginChild("GitChanges", size, true);
+        std::unique_lock<std::mutex> lock(view->mutex);
+        if (!view->changes_loaded) {
+            ImGui::TextDisabled("Loading...");
+        } else if (view->changes.empty()) {
+            ImGui::TextDisabled("No changes.");
+        }
+        std::optional<rouen::models::GitFileChange> expand;
+        for (auto const& change : view->changes) {
+            auto const open = change.path == view->diff_path;
+            // The ### part keeps the id steady while the marker flips
+            auto const label = change.untracked ? std::format("{} ?? {}###{}", open ? "v" : ">", change.path, change.path)
+                                                : std::format("{} {}{} {}###{}", open ? "v" : ">", change.index, change.worktree, change.path, change.path);
+            ImGui::PushStyleColor(ImGuiCol_Text, change.conflicted ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : colors[1]);
+            bool const clicked = ImGui::Selectable(label.c_str(), open);
+            ImGui::PopStyleColor();
+            if (clicked) {
+                if (open) {
+                    view->diff_path.clear();
+                    view->diff.reset();
+                } else {
+                    expand = change;
+                }
+            }
+            if (open) {
+                if (view->diff) {
+                    render_diff(*view->diff);
+                } else {
+                    ImGui::TextDisabled("Loading diff...");
                 }
             }
         }
+        if (expand) {
+            view->diff_path = expand->path;
+            view->diff.reset();
+            lock.unlock();
+            git_model->loadDiff(selected_repo, *expand, [v = view, path = expand->path](std::shared_ptr<rouen::models::GitDiff const> diff) {
+                std::lock_guard<std::mutex> lock(v->mutex);
+                if (v->diff_path == path) {
+                    v->diff = std::move(diff);
+                }
+            }, view_stop);
+        }
+        ImGui::EndChild();
+    }
+    
+    // A diff of any length: only the visible lines are drawn, in their own scrolling region
+    void render_diff(rouen::models::GitDiff const& diff) {
+        auto const line_height = ImGui::GetTextLineHeightWithSpacing();
+        auto const height = std::min(static_cast<float>(diff.lines.size()) + 1.0f, 30.0f) * line_height;
+        ImGui::BeginChild("GitDiff", ImVec2(0, height), true, ImGuiWindowFlags_HorizontalScrollbar);
+        if (diff.lines.empty()) {
+            ImGui::TextDisabled("No textual differences.");
+        }
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(diff.lines.size()), line_height);
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                auto const text = diff.line_text(static_cast<size_t>(i));
+                ImGui::PushStyleColor(ImGuiCol_Text, diff_color(diff.lines[static_cast<size_t>(i)].kind));
+                ImGui::TextUnformatted(text.data(), text.data() + text.size());
+                ImGui::PopStyleColor();
+            }
+        }
+        ImGui::EndChild();
+    }
+    
+    static ImVec4 diff_color(rouen::models::GitDiffLineKind kind) {
+        switch (kind) {
+            case rouen::models::GitDiffLineKind::Added:   return {0.45f, 0.85f, 0.45f, 1.0f};
+            case rouen::models::GitDiffLineKind::Removed: return {0.9f, 0.45f, 0.45f, 1.0f};
+            case rouen::models::GitDiffLineKind::Hunk:    return {0.45f, 0.75f, 0.95f, 1.0f};
+            case rouen::models::GitDiffLineKind::Header:  return {0.85f, 0.85f, 0.5f, 1.0f};
+            default:                                      return {0.8f, 0.8f, 0.8f, 1.0f};
+        }
     }
 
     bool render() override {
@@ -146,52 +356,82 @@ struct git: public card {
     void render_index() {
         // Get repository data from the model
         // const auto& repos = git_model->getRepos(); // Commented out unused variable
-        const auto& repo_paths = git_model->getRepoPaths();
+        const auto repo_paths = git_model->getRepoPaths();
+        
+        // The list shown comes from the last scan's index until this one finishes
+        if (git_model->isScanning()) {
+            ImGui::TextDisabled("Scanning for repositories...");
+        }
 
-        // Display the list of repositories with their statuses as colored dots
-        for (const auto& repo_path : repo_paths) {
-            rouen::models::GitRepoStatus status = git_model->getRepoStatus(repo_path);
-            
-            // Get status color using the constexpr function
-            ImColor dotColor = getStatusColor(status);
-            
-            // Begin horizontal layout
-            ImGui::BeginGroup();
-            
-            // Draw status dot
-            float dotRadius = 4.0f;
-            ImVec2 cursorPos = ImGui::GetCursorPos();
-            ImVec2 dotPos(cursorPos.x + dotRadius + 4.0f, cursorPos.y + ImGui::GetTextLineHeight() / 2.0f);
-            ImVec2 windowPos = ImGui::GetWindowPos();
-            ImVec2 absoluteDotPos(windowPos.x + dotPos.x, windowPos.y + dotPos.y);
-            ImGui::GetWindowDrawList()->AddCircleFilled(
-                absoluteDotPos, 
-                dotRadius, 
-                dotColor, 
-                10);
-            
-            // Add padding after dot
-            ImGui::SetCursorPosX(cursorPos.x + 2 * dotRadius + 8.0f);
-            
-            // Display repository path
-            const char *repo_path_cstr = repo_path.c_str();
-            if (repo_path.size() > 38) {
-                repo_path_cstr += repo_path.size() - 38;
-            }
-            if (ImGui::Selectable(repo_path_cstr, false, 0, ImVec2(0, 0))) {
-                // if the ctrl key is pressed, open the repository as a file system card
-                if (ImGui::GetIO().KeyCtrl) {
-                    // Open the repository as a file system card
-                    "create_card"_sfn(std::format("dir:{}", repo_path));
-                } else {
-                    // If a repository is selected, set it as the selected_repo
-                    select(repo_path);
+        // Display the list of repositories with their statuses as colored dots; only the rows in view
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(repo_paths.size()), ImGui::GetTextLineHeightWithSpacing());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const auto& repo_path = repo_paths[static_cast<size_t>(row)];
+                rouen::models::GitRepoStatus status = git_model->getRepoStatus(repo_path);
+                
+                // Get status color using the constexpr function
+                ImColor dotColor = getStatusColor(status);
+                
+                // Begin horizontal layout
+                ImGui::BeginGroup();
+                
+                // Draw status dot
+                float dotRadius = 4.0f;
+                ImVec2 cursorPos = ImGui::GetCursorPos();
+                ImVec2 screenPos = ImGui::GetCursorScreenPos();     // follows the scroll
+                ImVec2 absoluteDotPos(screenPos.x + dotRadius + 4.0f, screenPos.y + ImGui::GetTextLineHeight() / 2.0f);
+                ImGui::GetWindowDrawList()->AddCircleFilled(
+                    absoluteDotPos, 
+                    dotRadius, 
+                    dotColor, 
+                    10);
+                
+                // Add padding after dot
+                ImGui::SetCursorPosX(cursorPos.x + 2 * dotRadius + 8.0f);
+                
+                // Display repository path
+                const char *repo_path_cstr = repo_path.c_str();
+                if (repo_path.size() > 38) {
+                    repo_path_cstr += repo_path.size() - 38;
                 }
+                if (ImGui::Selectable(repo_path_cstr, false, 0, ImVec2(0, 0))) {
+                    // if the ctrl key is pressed, open the repository as a file system card
+                    if (ImGui::GetIO().KeyCtrl) {
+                        // Open the repository as a file system card
+                        "create_card"_sfn(std::format("dir:{}", repo_path));
+                    } else {
+                        // If a repository is selected, set it as the selected_repo
+                        select(repo_path);
+                    }
+                }
+                
+                ImGui::EndGroup();
             }
-            
-            ImGui::EndGroup();
         }
     }
 
     std::string selected_repo; 
+    
+private:
+    static constexpr size_t commit_page = 200;
+    
+    // What the selected repository's tabs show, filled in by scheduler workers
+    struct repo_view {
+        std::mutex mutex;
+        std::string status;
+        std::string push_result;
+        bool status_loading = false;
+        std::vector<rouen::models::GitCommit> commits;
+        bool commits_loading = false;
+        bool commits_done = false;
+        std::vector<rouen::models::GitFileChange> changes;
+        bool changes_loaded = false;
+        std::string diff_path;      // the file expanded
+        std::shared_ptr<rouen::models::GitDiff const> diff;
+    };
+    
+    std::shared_ptr<repo_view> view;
+    std::stop_source view_stop;     // everything asked for the selected repository
 };
@@ -5,6 +5,8 @@
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <mutex>
+#include <vector>
 
 #include "../../../helpers/imgui_include.hpp"
 #include <glaze/json.hpp>
@@ -13,6 +15,8 @@
 #include "../../../models/github/host.hpp"
 #include "../../../models/github/login_host.hpp"
 #include "../../../registrar.hpp"
+#include "../../../helpers/redraw.hpp"
+#include "../../../helpers/task_scheduler.hpp"
 #include "../../../helpers/views/json_view.hpp"
 #include "../../../../external/IconsMaterialDesign.h"
 #include "login_screen.hpp"
@@ -236,6 +240,11 @@ namespace rouen::cards {
                                 ImGui::EndCombo();
                             }
                             
+                            // Overview of the listed repositories
+                            if (ImGui::CollapsingHeader("Overview")) {
+                                render_overview();
+                            }
+                            
                             // Repositories section
                             if (ImGui::CollapsingHeader("Repositories", ImGuiTreeNodeFlags_DefaultOpen)) {
                                 // Repository filter
@@ -311,10 +320,11 @@ namespace rouen::cards {
                             if (ImGui::CollapsingHeader("User Info")) {
                                 if (ImGui::Button("Fetch User Info")) {
                                     user_info_ = host_->user();
+                                    json_view_.set(user_info_);
                                 }
                                 
                                 if (!user_info_.empty()) {
-                                    json_view_.render(user_info_);
+                                    json_view_.render();
                                 }
                             }
                         } catch (std::exception const &e) {
@@ -333,6 +343,94 @@ namespace rouen::cards {
             }
             
         private:
+            // Filled on the scheduler; shared so a refresh can outlive the card
+            struct overview_state {
+                std::mutex mutex;
+                std::vector<models::github::repo_summary> summaries;
+                std::string error;
+                bool loading {false};
+            };
+            
+            void refresh_overview() {
+                std::vector<std::string> names;
+                names.reserve(repos_.size());
+                for (auto const &repo : repos_) {
+                    names.push_back(repo.full_name());
+                }
+                {
+                    std::lock_guard lock(overview_->mutex);
+                    if (overview_->loading) {
+                        return;
+                    }
+                    overview_->loading = true;
+                }
+                helpers::scheduler()->submit([state = overview_, host = host_, names = std::move(names)](std::stop_token) {
+                    std::vector<models::github::repo_summary> summaries;
+                    std::string error;
+                    try {
+                        summaries = host->repo_summaries(names);
+                    } catch (std::exception const &e) {
+                        error = e.what();
+                    }
+                    {
+                        std::lock_guard lock(state->mutex);
+                        state->summaries = std::move(summaries);
+                        state->error = std::move(error);
+                        state->loading = false;
+                    }
+                    helpers::request_redraw();
+                }, helpers::task_priority::normal);
+            }
+            
+            void render_overview() {
+                if (ImGui::Button(ICON_MD_REFRESH " Refresh") && !repos_.empty()) {
+                    refresh_overview();
+                }
+                std::lock_guard lock(overview_->mutex);
+                if (overview_->loading) {
+                    ImGui::SameLine();
+                    ImGui::Text("Loading %zu repositories...", repos_.size());
+                }
+                if (!overview_->error.empty()) {
+                    ImGui::TextColored(colors[3], "Error: %s", overview_->error.c_str());
+                }
+                if (overview_->summaries.empty()) {
+                    return;
+                }
+                if (ImGui::BeginTable("Overview", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 300))) {
+                    ImGui::TableSetupScrollFreeze(0, 1);
+                    ImGui::TableSetupColumn("Repository", ImGuiTableColumnFlags_WidthStretch);
+                    ImGui::TableSetupColumn("Stars", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+                    ImGui::TableSetupColumn("PRs", ImGuiTableColumnFlags_WidthFixed, 40.0f);
+                    ImGui::TableSetupColumn("Issues", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+                    ImGui::TableSetupColumn("Last commit", ImGuiTableColumnFlags_WidthStretch);
+                    ImGui::TableSetupColumn("CI", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+                    ImGui::TableHeadersRow();
+                    for (auto const &summary : overview_->summaries) {
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(summary.full_name.c_str());
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%d", summary.stars);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%d", summary.open_prs);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%d", summary.open_issues);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.10s %s", summary.last_commit_date.c_str(), summary.last_commit.c_str());
+                        ImGui::TableNextColumn();
+                        if (summary.ci_state == "SUCCESS") {
+                            ImGui::TextColored(colors[2], "%s", summary.ci_state.c_str());
+                        } else if (summary.ci_state == "FAILURE" || summary.ci_state == "ERROR") {
+                            ImGui::TextColored(colors[3], "%s", summary.ci_state.c_str());
+                        } else {
+                            ImGui::TextUnformatted(summary.ci_state.c_str());
+                        }
+                    }
+                    ImGui::EndTable();
+                }
+            }
+            
             std::string_view config_name_;
             std::shared_ptr<models::github::host> host_;
             std::shared_ptr<models::github::login_host> login_host_;
@@ -347,5 +445,6 @@ namespace rouen::cards {
             glz::json_t user_info_{};
             helpers::views::json_view json_view_;
             std::string debug_repos_json_;
+            std::shared_ptr<overview_state> overview_ {std::make_shared<overview_state>()};
     };
 }
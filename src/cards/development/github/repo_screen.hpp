@@ -50,6 +50,7 @@ namespace rouen::cards::github {
                 repo_ = std::move(repo);
             }
             host_ = host;
+            repo_view_.set(repo_);
         }
 
         std::string name() const {
@@ -86,7 +87,7 @@ namespace rouen::cards::github {
                 
                 // Show JSON details if requested
                 if (show_details_) {
-                    json_view_.render(repo_);
+                    repo_view_.render();
                 }
                 
                 ImGui::TableNextColumn();
@@ -94,12 +95,14 @@ namespace rouen::cards::github {
                 // Handle workflows
                 if (ImGui::Button("Fetch Workflows")) {
                     workflows_ = host_->repo_workflows(full_name());
+                    workflows_view_.set(workflows_);
                     workflow_runs_.clear();
+                    run_views_.clear();
                 }
                 
                 // Show JSON details if requested and workflows are loaded
                 if (show_details_ && !workflows_.empty()) {
-                    json_view_.render(workflows_);
+                    workflows_view_.render();
                 }
                 
                 // Render each workflow if workflows are loaded
@@ -114,6 +117,7 @@ namespace rouen::cards::github {
                         if (ImGui::SmallButton("Fetch Runs")) {
                             workflow_runs_[workflow_name] = 
                                 host_->workflow_runs(detail::safe_get_string(workflow, "url"));
+                            run_views_[workflow_name].set(workflow_runs_[workflow_name]);
                         }
                         
                         // Display workflow runs if available
@@ -122,7 +126,7 @@ namespace rouen::cards::github {
                             auto& runs = it->second;
                             
                             if (show_details_) {
-                                json_view_.render(runs);
+                                run_views_[workflow_name].render();
                             }
                             
                             if (runs.contains("workflow_runs") && runs["workflow_runs"].is_array() && ImGui::BeginTable("runs", 5, ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg)) {
@@ -197,6 +201,8 @@ namespace rouen::cards::github {
         bool show_details_{false};
         glz::json_t workflows_{};
         std::unordered_map<std::string, glz::json_t> workflow_runs_{};
-        helpers::views::json_view json_view_;
+        helpers::views::json_view repo_view_;
+        helpers::views::json_view workflows_view_;
+        std::unordered_map<std::string, helpers::views::json_view> run_views_{};
     };
 }
@@ -1,14 +1,16 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
 #include <format>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
-#include <thread>
 #include <vector>
 #include <map>
+#include <utility>
 #include <sstream>
 #include <iomanip>
 
@@ -20,9 +22,12 @@
 
 #include "../../../models/calendar/calendar_fetcher.hpp"
 #include "../../../models/calendar/event.hpp"
+#include "../../../models/calendar/event_index.hpp"
+#include "../../../models/calendar/event_store.hpp"
 #include "../../../registrar.hpp"
 #include "../../interface/card.hpp"
 #include "../../../helpers/platform_utils.hpp"
+#include "../../../helpers/timer_wheel.hpp"
 
 namespace rouen::cards
 {
@@ -37,6 +42,8 @@ namespace rouen::cards
             // Set card properties
             name("Calendar");
             width = 600.0f;
+            cache_texture = true;  // Events change rarely; reuse the last rendering between updates
+            requested_fps = 0;     // Syncs invalidate as they land; the status line ticks by the minute
             
             // Get URL from parameter or environment
             calendar_url = url;
@@ -50,19 +57,26 @@ namespace rouen::cards
             // Initialize the calendar fetcher
             fetcher_ = std::make_shared<::calendar::calendar_fetcher>(calendar_url);
             
-            // Initial load of events
+            // Draw what the last sync stored right away, then ask only for what changed since
+            events_ = fetcher_->stored_events();
+            index_.build(events_);
+            pending_->owner = this;
             refresh_events();
-            
-            // Start the refresh thread
-            start_refresh_thread();
+            if (auto const timers = rouen::helpers::timers()) {
+                status_timer_ = timers->every(std::chrono::minutes{1}, [this]() { invalidate(); });
+            }
         }
-        
-        ~calendar() override {
-            // The refresh_thread_ is a jthread, which will automatically join when destroyed
+
+        ~calendar() override
+        {
+            std::lock_guard<std::mutex> lock(pending_->mutex);
+            pending_->owner = nullptr;
         }
 
         bool render() override
         {
+            take_fetched_events();
+
             return render_window([this]()
             {
                 // Header area
@@ -77,12 +91,6 @@ namespace rouen::cards
                 
                 // Calendar events area
                 render_events();
-                
-                // Handle automatic refresh
-                if (auto now = std::chrono::steady_clock::now(); 
-                    std::chrono::duration_cast<std::chrono::seconds>(now - last_refresh_).count() >= refresh_interval_.count()) {
-                    refresh_events();
-                }
             });
         }
 
@@ -94,10 +102,20 @@ namespace rouen::cards
     private:
         std::shared_ptr<::calendar::calendar_fetcher> fetcher_;
         std::vector<::calendar::event> events_;
+        ::calendar::event_index index_;             // over events_, rebuilt when a sync changes it
         std::mutex events_mutex_;
+        // Filled by the fetcher's callback, in arrival order; shared so a late callback never
+        // outlives the card's state
+        struct pending_events {
+            std::mutex mutex;
+            std::vector<::calendar::event_changes> changes;
+            card const* owner {nullptr};   // invalidated on arrival; cleared when the card goes
+        };
+        std::shared_ptr<pending_events> pending_ = std::make_shared<pending_events>();
         std::chrono::steady_clock::time_point last_refresh_ = std::chrono::steady_clock::now();
         std::chrono::seconds refresh_interval_{300}; // Refresh every 5 minutes
-        std::jthread refresh_thread_;                // Thread for refreshing events in the background
+        rouen::helpers::timer_wheel::timer refresh_timer_;  // the next automatic refresh_events()
+        rouen::helpers::timer_wheel::timer status_timer_;   // "Last refresh" and the current hour move on
         bool show_event_details_ = false;
         ::calendar::event selected_event_;
         bool use_day_view_ {true};                  // Toggle between list view and day view
@@ -120,12 +138,11 @@ namespace rouen::cards
         
         void render_status_bar()
         {
-            auto elapsed_seconds = std::chrono::duration_cast<std::chrono::seconds>(
+            // By the minute: status_timer_ redraws the card once a minute
+            auto minutes = std::chrono::duration_cast<std::chrono::minutes>(
                 std::chrono::steady_clock::now() - last_refresh_).count();
-            auto minutes = elapsed_seconds / 60;
-            auto seconds = elapsed_seconds % 60;
             
-            ImGui::Text("Last refresh: %lld:%02lld ago", minutes, seconds);
+            ImGui::Text("Last refresh: %lld min ago", static_cast<long long>(minutes));
             ImGui::SameLine();
             
             if (ImGui::Button("Refresh Now")) {
@@ -292,38 +309,22 @@ namespace rouen::cards
             ImGui::PopStyleColor();
             ImGui::Separator();
             
-            // Group events by time (hourly slots)
+            // Group the day's events by hour; the index hands over only those starting on it
             std::map<int, std::vector<const ::calendar::event*>> hourly_events;
-            bool has_all_day_events = false;
-            
-            // First pass: organize events by hour
-            for (const auto& event : events_) {
-                if (event.start.substr(0, 10) == current_date_) {
-                    if (event.all_day) {
-                        has_all_day_events = true;
-                        continue;
-                    }
-                    
-                    // Extract hour from time (format: "YYYY-MM-DDTHH:MM:SS")
-                    int hour = 0;
-                    if (event.start.length() >= 13) {
-                        hour = std::stoi(event.start.substr(11, 2));
-                    }
-                    
-                    hourly_events[hour].push_back(&event);
-                }
+            auto const [day_begin, day_end] = local_day_bounds(current_date_);
+            for (auto position : index_.starting_in(day_begin, day_end)) {
+                const auto& event = events_[position];
+                hourly_events[event.local_start().tm_hour].push_back(&event);
             }
             
             // Render all-day events first if any
-            if (has_all_day_events) {
+            if (auto const all_day = index_.all_day(current_date_); !all_day.empty()) {
                 ImGui::PushStyleColor(ImGuiCol_Text, colors[4]); // Use highlight color
                 ImGui::Text("All-day Events:");
                 ImGui::PopStyleColor();
                 
-                for (const auto& event : events_) {
-                    if (event.start.substr(0, 10) == current_date_ && event.all_day) {
-                        render_day_view_event(event);
-                    }
+                for (auto position : all_day) {
+                    render_day_view_event(events_[position]);
                 }
                 
                 ImGui::Separator();
@@ -365,15 +366,29 @@ namespace rouen::cards
             }
         }
 
+        // Local midnight to local midnight for a YYYY-MM-DD date (23 or 25 hours across a DST change)
+        static std::pair<std::chrono::system_clock::time_point, std::chrono::system_clock::time_point> local_day_bounds(const std::string& date)
+        {
+            std::tm day_tm = {};
+            std::istringstream ss(date);
+            ss >> std::get_time(&day_tm, "%Y-%m-%d");
+            day_tm.tm_isdst = -1;
+            std::tm next_tm = day_tm;
+            next_tm.tm_mday += 1;
+            return {std::chrono::system_clock::from_time_t(std::mktime(&day_tm)),
+                    std::chrono::system_clock::from_time_t(std::mktime(&next_tm))};
+        }
+
         void render_day_view_event(const ::calendar::event& event)
         {
             // Calculate the event time display
             std::string time_display;
             if (event.all_day) {
                 time_display = "All day";
-            } else if (event.start.length() >= 16) {
-                // Extract hour:minute from the start time (format: "YYYY-MM-DDTHH:MM:SS")
-                time_display = event.start.substr(11, 5);
+            } else {
+                // Local hour:minute, whatever offset the start time was written with
+                auto const tm = event.local_start();
+                time_display = std::format("{:02d}:{:02d}", tm.tm_hour, tm.tm_min);
             }
             
             // Event card style
@@ -487,44 +502,67 @@ namespace rouen::cards
             }
         }
         
+        // Starts a non-blocking sync, render() applies what it brings; the next comes
+        // refresh_interval_ later, in view or not
         void refresh_events()
         {
-            try {
-                auto new_events = fetcher_->fetch_events();
-                
-                {
-                    std::lock_guard<std::mutex> lock(events_mutex_);
-                    events_ = std::move(new_events);
-                }
-                
-                last_refresh_ = std::chrono::steady_clock::now();
-            } catch (const std::exception& e) {
-                // Error will be shown in the UI via fetcher_->has_error()
+            last_refresh_ = std::chrono::steady_clock::now();
+            if (auto const timers = rouen::helpers::timers()) {
+                refresh_timer_ = timers->after(refresh_interval_, [this]() { refresh_events(); });
             }
+            fetcher_->sync_async([pending = pending_](::calendar::event_changes changes) {
+                std::lock_guard<std::mutex> lock(pending->mutex);
+                pending->changes.push_back(std::move(changes));
+                if (pending->owner) {
+                    pending->owner->invalidate();
+                }
+            });
         }
-        
-        void start_refresh_thread()
+
+        // Event by event: a full sync replaces the list, an incremental one edits it in place
+        void take_fetched_events()
         {
-            refresh_thread_ = std::jthread([this](std::stop_token stoken) {
-                while (!stoken.stop_requested()) {
-                    // Sleep for a minute before checking if refresh is needed
-                    for (int i = 0; i < 60 && !stoken.stop_requested(); ++i) {
-                        std::this_thread::sleep_for(std::chrono::seconds(1));
+            std::vector<::calendar::event_changes> fetched;
+            {
+                std::lock_guard<std::mutex> lock(pending_->mutex);
+                fetched.swap(pending_->changes);
+            }
+            if (fetched.empty()) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(events_mutex_);
+            bool changed = false;
+            for (auto& changes : fetched) {
+                if (changes.full) {
+                    events_ = std::move(changes.updated);
+                    changed = true;
+                    continue;
+                }
+                for (auto const& id : changes.removed) {
+                    changed |= std::erase_if(events_, [&id](const ::calendar::event& evt) { return evt.id == id; }) > 0;
+                }
+                for (auto& evt : changes.updated) {
+                    auto const existing = std::ranges::find(events_, evt.id, &::calendar::event::id);
+                    if (existing != events_.end()) {
+                        *existing = std::move(evt);
+                    } else {
+                        events_.push_back(std::move(evt));
                     }
-                    
-                    if (stoken.stop_requested()) break;
-                    
-                    auto now = std::chrono::steady_clock::now();
-                    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_refresh_).count();
-                    
-                    // If the refresh interval has passed, refresh the events
-                    if (elapsed >= refresh_interval_.count()) {
-                        refresh_events();
+                    changed = true;
+                }
+            }
+            if (changed) {
+                std::ranges::stable_sort(events_, {}, &::calendar::event::start_time);
+                index_.build(events_);
+                if (show_event_details_) {
+                    if (auto const current = std::ranges::find(events_, selected_event_.id, &::calendar::event::id); current != events_.end()) {
+                        selected_event_ = *current;
                     }
                 }
-            });
+                invalidate();
+            }
         }
-
+        
         // Add helper method to create alarm from event
         void create_alarm_from_event(const ::calendar::event& event) {
             if (event.all_day) {
@@ -532,14 +570,9 @@ namespace rouen::cards
                 return;
             }
             
-            // Extract the time from the event start time
-            // Format is typically "YYYY-MM-DDTHH:MM:SS"
-            if (event.start.length() >= 16) {
-                std::string time_str = event.start.substr(11, 5); // Extract HH:MM
-                
-                // Create alarm card with the event time
-                "create_card"_sfn(std::format("alarm:{}", time_str));
-            }
+            // The alarm card takes a local HH:MM
+            auto const tm = event.local_start();
+            "create_card"_sfn(std::format("alarm:{:02d}:{:02d}", tm.tm_hour, tm.tm_min));
         }
     };
 } // namespace rouen::cards
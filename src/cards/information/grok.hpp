@@ -3,13 +3,16 @@
 #include "../../helpers/imgui_include.hpp"
 #include <string>
 #include <deque>
-#include <future>
-#include <optional>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <array>
 
 #include "../../helpers/cppgpt.hpp"
 #include "../../helpers/fetch.hpp"
 #include "../../helpers/api_keys.hpp"
+#include "../../helpers/redraw.hpp"
+#include "../../helpers/task_scheduler.hpp"
 #include "../interface/card.hpp"
 
 namespace rouen::cards {
@@ -35,17 +38,23 @@ namespace rouen::cards {
             get_color(11, ImVec4(0.3f, 0.4f, 0.5f, 0.6f));    // Separator line color
             get_color(12, ImVec4(0.2f, 0.3f, 0.4f, 1.0f));   // Chat background
             
-            requested_fps = 1;
+            requested_fps = 0;  // The reply wakes the loop as it streams in
             
             // Read API key from centralized API key manager
             grok_api_key = helpers::ApiKeys::get_grok_api_key();
             if (!grok_api_key.empty()) {
-                gpt = std::make_unique<ignacionr::cppgpt>(grok_api_key, ignacionr::cppgpt::grok_base);
+                gpt = std::make_shared<ignacionr::cppgpt>(grok_api_key, ignacionr::cppgpt::grok_base);
                 gpt->add_instructions("You are Grok, an AI assistant created by xAI. You are helpful, harmless, and honest.");
             }
             width *= 2.0f;
         }
 
+        ~grok() override {
+            if (streaming_) {
+                cancel_reply(*streaming_).cancel();
+            }
+        }
+
         bool render() override {
             return render_window([this]() {
                 // Apply custom colors to various UI elements
@@ -71,8 +80,8 @@ namespace rouen::cards {
                 
                 // Begin child with fixed width to prevent horizontal shifting
                 if (ImGui::BeginChild("ScrollingRegion", ImVec2(width_for_content, -footer_height_to_reserve), true, ImGuiWindowFlags_HorizontalScrollbar)) {
-                    // Process any pending responses
-                    process_pending_response();
+                    // Take in what has arrived of the reply
+                    sync_reply();
                     
                     // Display chat history
                     for (const auto& message : chat_history) {
@@ -139,8 +148,12 @@ namespace rouen::cards {
                 if (waiting_for_response) {
                     ImGui::Spacing();
                     ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[6]));
-                    ImGui::TextWrapped("Grok is thinking...");
+                    ImGui::TextUnformatted(chat_history.back().second.empty() ? "Grok is thinking..." : "Grok is answering...");
                     ImGui::PopStyleColor();
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("Stop")) {
+                        stop_reply();
+                    }
                 }
                 
                 // API key input if not set
@@ -157,7 +170,7 @@ namespace rouen::cards {
                     if (ImGui::InputText("##apikey", api_key_buffer.data(), api_key_buffer.size(), ImGuiInputTextFlags_EnterReturnsTrue)) {
                         api_key_input = api_key_buffer.data();
                         grok_api_key = api_key_input;
-                        gpt = std::make_unique<ignacionr::cppgpt>(grok_api_key, ignacionr::cppgpt::grok_base);
+                        gpt = std::make_shared<ignacionr::cppgpt>(grok_api_key, ignacionr::cppgpt::grok_base);
                         gpt->add_instructions("You are Grok, an AI assistant created by xAI. You are helpful, harmless, and honest.");
                     }
                     ImGui::PopItemWidth();
@@ -222,18 +235,29 @@ namespace rouen::cards {
         }
 
     private:
-        std::unique_ptr<ignacionr::cppgpt> gpt;
+        static constexpr long reply_timeout = 300;    // seconds for a whole streamed reply
+
+        // The reply streaming in: appended to on the I/O thread, taken in by render()
+        struct reply_stream {
+            std::mutex mutex;
+            std::string text;
+            std::string error;
+            bool finished = false;
+            bool cancelled = false;     // nothing more is wanted; the transfer aborts at its next chunk
+            http::engine::transfer transfer;
+        };
+
+        std::shared_ptr<ignacionr::cppgpt> gpt;
         std::string grok_api_key;
         std::string api_key_input;
         std::string input_text;
         std::array<char, 1024> api_key_buffer{};
         std::array<char, 2048> input_buffer{};
         std::deque<std::pair<std::string, std::string>> chat_history;
-        std::optional<std::future<void>> pending_response;
+        std::shared_ptr<reply_stream> streaming_;
         bool waiting_for_response = false;
         bool scroll_to_bottom = false;
         bool reclaim_focus = false;
-        http::fetch fetcher;
 
         // Color fields
         std::array<ImVec4, 12> colors;
@@ -241,39 +265,117 @@ namespace rouen::cards {
         void send_message(const std::string& message) {
             if (message.empty() || waiting_for_response) return;
             
-            // Add user message to history
+            // The user's message, and Grok's that fills in as it streams
             chat_history.emplace_back("user", message);
+            chat_history.emplace_back("assistant", std::string{});
             scroll_to_bottom = true;
             waiting_for_response = true;
-            
-            // Start async request
-            pending_response = std::make_optional(std::async(std::launch::async, [this, message]() {
+            auto stream = std::make_shared<reply_stream>();
+            streaming_ = stream;
+
+            // Started on the scheduler, which may wait out cppgpt's request spacing; the transfer
+            // then runs on the fetch engine with no thread waiting on it
+            helpers::scheduler()->submit([gpt = gpt, stream, message](std::stop_token) {
                 try {
-                    auto response = gpt->sendMessage(message, 
-                        [this](const std::string& url, const std::string& data, auto header_client) {
-                            return fetcher.post(url, data, header_client);
+                    gpt->startMessageStream(message,
+                        [gpt, stream](const std::string& url, const std::string& data, auto header_client,
+                                      std::function<bool(std::string_view)> on_chunk,
+                                      std::function<void(std::string const&)> on_finished) {
+                            http::request req;
+                            req.url = url;
+                            req.body = data;
+                            req.timeout = reply_timeout;
+                            header_client([&req](const std::string& header) { req.headers.push_back(header); });
+                            auto sink = std::make_shared<http::callback_sink>(std::move(on_chunk));
+                            req.sink = sink.get();
+                            std::unique_lock<std::mutex> lock(stream->mutex);
+                            if (stream->cancelled) {
+                                lock.unlock();
+                                on_finished("cancelled");
+                                return;
+                            }
+                            // The completion keeps the sink and the conversation alive until the transfer ends
+                            stream->transfer = http::engine::instance().submit(std::move(req),
+                                [gpt, sink, on_finished](http::response response) { on_finished(response.error); });
+                        },
+                        [stream](std::string_view delta) {
+                            std::lock_guard<std::mutex> lock(stream->mutex);
+                            if (stream->cancelled) {
+                                return false;
+                            }
+                            stream->text.append(delta);
+                            helpers::request_redraw();
+                            return true;
+                        },
+                        [stream](std::string const&, std::string const& error) {
+                            finish_reply(*stream, error);
                         });
-                    
-                    // Extract message content
-                    std::string reply = response.choices[0].message.content;
-                    
-                    // Add to chat history
-                    chat_history.emplace_back("assistant", reply);
                 } catch (const std::exception& e) {
-                    chat_history.emplace_back("assistant", std::string("Error: ") + e.what());
+                    finish_reply(*stream, e.what());
                 }
-                waiting_for_response = false;
-                scroll_to_bottom = true;
-            }));
+            }, helpers::task_priority::high);
         }
-        
-        void process_pending_response() {
-            if (pending_response && pending_response->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
-                pending_response.reset();
-                // Clear input text and set focus flag after a response is received
-                input_text.clear();
-                reclaim_focus = true;
+
+        static void finish_reply(reply_stream& stream, std::string const& error) {
+            {
+                std::lock_guard<std::mutex> lock(stream.mutex);
+                stream.error = error;
+                stream.finished = true;
             }
+            helpers::request_redraw();
+        }
+
+        // The transfer, for a caller that can't wait for it to abort at its next chunk
+        static http::engine::transfer cancel_reply(reply_stream& stream) {
+            std::lock_guard<std::mutex> lock(stream.mutex);
+            stream.cancelled = true;
+            return stream.transfer;
+        }
+
+        // Copies the reply so far into its bubble; once it has ended, input opens again
+        void sync_reply() {
+            if (!streaming_) {
+                return;
+            }
+            auto& shown = chat_history.back().second;
+            bool finished = false;
+            {
+                std::lock_guard<std::mutex> lock(streaming_->mutex);
+                if (shown.size() != streaming_->text.size()) {
+                    shown = streaming_->text;
+                    scroll_to_bottom = true;
+                }
+                if (streaming_->finished) {
+                    finished = true;
+                    if (!streaming_->error.empty()) {
+                        shown += (shown.empty() ? "Error: " : "\n\nError: ") + streaming_->error;
+                    }
+                }
+            }
+            if (finished) {
+                end_reply();
+            }
+        }
+
+        // Keeps what has arrived and lets the transfer abort on its own
+        void stop_reply() {
+            if (streaming_) {
+                cancel_reply(*streaming_);
+                sync_reply();
+            }
+            if (streaming_) {
+                chat_history.back().second += chat_history.back().second.empty() ? "(stopped)" : " (stopped)";
+                end_reply();
+            }
+        }
+
+        void end_reply() {
+            streaming_.reset();
+            waiting_for_response = false;
+            scroll_to_bottom = true;
+            // Clear input text and set focus flag after a response is received
+            input_text.clear();
+            reclaim_focus = true;
         }
 
         void get_color(size_t index, const ImVec4& color) {
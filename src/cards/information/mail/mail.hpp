@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
 #include <format>
@@ -13,7 +14,10 @@
 // Include our compatibility layer for C++20/23 features
 #include "../../../helpers/compat/compat.hpp"
 
+#include "../../../helpers/redraw.hpp"
+#include "../../../helpers/timer_wheel.hpp"
 #include "../../../models/mail/imap_host.hpp"
+#include "../../../models/mail/imap_idle.hpp"
 #include "../../../models/mail/message.hpp"
 #include "../../../registrar.hpp"
 #include "../../interface/card.hpp"
@@ -31,7 +35,7 @@ namespace rouen::cards
             setup_colors();
             
             name("Mail");
-            requested_fps = 1; // Update once per second
+            requested_fps = 0; // Redrawn when a refresh finishes or IDLE pushes a change
             width = 770.0f;    // Wider to accommodate email content
 
             // Helper function to get value from env var if input is empty
@@ -57,8 +61,9 @@ namespace rouen::cards
             username_ = actual_username;
             password_ = actual_password;
 
-            // Initial load of messages
+            // Initial load of messages, then the server says when something changes
             refresh_messages();
+            start_idle();
         }
 
         ~mail() override
@@ -68,12 +73,10 @@ namespace rouen::cards
 
         bool render() override
         {
-            // Check if it's time to refresh based on refresh interval
-            auto now = std::chrono::steady_clock::now();
-            if (now - last_refresh_ > refresh_interval_)
+            // What IDLE pushed; refresh_timer_ is the fallback for when it isn't working
+            if (auto const pushed = pushed_.exchange(push_none); pushed != push_none)
             {
-                refresh_messages();
-                last_refresh_ = now;
+                refresh_messages(pushed == push_expunged);
             }
 
             return render_window([this]()
@@ -102,18 +105,24 @@ namespace rouen::cards
             return host_url_.empty() ? "mail" : std::format("mail:{}:{}", host_url_, username_);
         }
 
-        void refresh_messages()
+        // With `full`, also finds what was deleted; otherwise only asks for UIDs above the known ones.
+        // The next full refresh comes an interval later, a long one while IDLE pushes changes.
+        void refresh_messages(bool full = true)
         {
             stop_refresh_thread();
-            last_refresh_ = std::chrono::steady_clock::now();
+            if (auto const timers = rouen::helpers::timers()) {
+                auto const interval = idle_ && idle_->listening() ? idle_refresh_interval_ : refresh_interval_;
+                refresh_timer_ = timers->after(interval, [this]() { refresh_messages(); });
+            }
 
             // Start a new thread for refreshing
-            refresh_thread_ = std::jthread([this] {
-                execute_safely([this]() {
+            refresh_thread_ = std::jthread([this, full] {
+                execute_safely([this, full]() {
                     if (mail_screen_) {
-                        mail_screen_->refresh();
+                        mail_screen_->refresh(full);
                     }
                 }, "Failed to refresh messages");
+                invalidate();
             });
         }
 
@@ -123,6 +132,26 @@ namespace rouen::cards
         std::string username_;
         std::string password_;
 
+        static constexpr int push_none = 0;
+        static constexpr int push_exists = 1;
+        static constexpr int push_expunged = 2;
+
+        // An IDLE connection on the current mailbox; a removal outranks an arrival still waiting
+        void start_idle()
+        {
+            idle_.reset();
+            if (username_.empty() || password_.empty()) {
+                return;
+            }
+            idle_ = std::make_unique<::mail::imap_idle>(host_url_, username_, password_, current_mailbox_,
+                [this](::mail::imap_idle::change what) {
+                    auto const wanted = what == ::mail::imap_idle::change::expunged ? push_expunged : push_exists;
+                    auto current = pushed_.load();
+                    while (current < wanted && !pushed_.compare_exchange_weak(current, wanted)) {}
+                    rouen::helpers::request_redraw();
+                });
+        }
+
         // Helper methods for DRY code
         void setup_colors()
         {
@@ -232,6 +261,7 @@ namespace rouen::cards
                             execute_safely([this]() {
                                 host_->select_mailbox(current_mailbox_);
                                 refresh_messages();
+                                start_idle();
                             }, "Failed to select mailbox");
                         }
                     }
@@ -247,9 +277,12 @@ namespace rouen::cards
         std::unique_ptr<::mail::mail_screen> mail_screen_;
         std::vector<std::string> mailboxes_;
         std::string current_mailbox_ = "INBOX";
-        std::chrono::steady_clock::time_point last_refresh_ = std::chrono::steady_clock::now();
         std::chrono::seconds refresh_interval_{300}; // Refresh every 5 minutes
+        std::chrono::seconds idle_refresh_interval_{3600}; // While IDLE pushes changes, a full check hourly
+        std::atomic<int> pushed_{push_none};         // what IDLE reported since the last refresh
         std::jthread refresh_thread_;                // Thread for refreshing messages in the background
+        rouen::helpers::timer_wheel::timer refresh_timer_;  // the next full refresh_messages()
+        std::unique_ptr<::mail::imap_idle> idle_;    // last: its thread stops before the rest goes
     };
 
 } // namespace rouen::cards
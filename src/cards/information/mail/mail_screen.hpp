@@ -2,29 +2,39 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <filesystem>
 #include <format>
 #include <memory>
 #include <regex>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "../../../helpers/imgui_include.hpp"
 
+#include "../../../fonts.hpp"
+
+#include "../../../models/mail/header_store.hpp"
 #include "../../../models/mail/imap_host.hpp"
 #include "../../../models/mail/message.hpp"
+#include "../../../models/mail/metadata_pipeline.hpp"
 #include "../../../helpers/fetch.hpp"
 #include "../../../helpers/email_metadata_analyzer.hpp"
 #include "../../interface/card.hpp"
 #include "../../../registrar.hpp"
 #include "../../../helpers/platform_utils.hpp"
+#include "../../../helpers/task_scheduler.hpp"
 
 namespace mail {
     class mail_screen {
     public:
-        mail_screen(std::shared_ptr<imap_host> host): host_(host) {}
+        mail_screen(std::shared_ptr<imap_host> host): host_(host), metadata_(host) {}
         
         void render() noexcept {
+            render_filter();
             if (ImGui::BeginTable("Messages", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable)) {
                 ImGui::TableSetupColumn("From", ImGuiTableColumnFlags_WidthFixed, 130);
                 ImGui::TableSetupColumn("Title", ImGuiTableColumnFlags_WidthStretch);
@@ -32,12 +42,21 @@ namespace mail {
                 ImGui::TableHeadersRow();
                 
                 for (auto& msg : messages_) {
+                    if (!passes_filter(*msg)) {
+                        continue;
+                    }
                     ImGui::PushID(static_cast<int>(msg->uid()));
                     ImGui::TableNextRow();
                     ImGui::TableNextColumn();
                     ImGui::TextUnformatted(msg->from().data(), msg->from().data() + msg->from().size());
                     ImGui::TableNextColumn();
+                    if (!msg->seen()) {
+                        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4{1.0f, 1.0f, 1.0f, 1.0f});
+                    }
                     ImGui::TextUnformatted(msg->title().data(), msg->title().data() + msg->title().size());
+                    if (!msg->seen()) {
+                        ImGui::PopStyleColor();
+                    }
                     ImGui::TableNextColumn();
                     auto date_str = std::format("{:%Y-%m-%d %H:%M}", msg->date());
                     ImGui::TextUnformatted(date_str.data(), date_str.data() + date_str.size());
@@ -93,84 +112,129 @@ namespace mail {
             }
         }
         
-        void refresh() {
+        // Narrows the list to a tag and/or a minimum urgency; the tags offered come from the
+        // metadata repository's index, read only while the combo is open
+        void render_filter() {
+            static constexpr char const* urgency_labels[] = {"Any urgency", "Urgency 1+", "Urgency 2"};
+            ImGui::SetNextItemWidth(120);
+            ImGui::Combo("##urgency", &filter_urgency_, urgency_labels, IM_ARRAYSIZE(urgency_labels));
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(180);
+            if (ImGui::BeginCombo("##tag", filter_tag_.empty() ? "Any tag" : filter_tag_.c_str())) {
+                if (ImGui::Selectable("Any tag", filter_tag_.empty())) {
+                    filter_tag_.clear();
+                }
+                for (auto const& [tag, count] : metadata_repository_->tags()) {
+                    auto const label = std::format("{} ({})", tag, count);
+                    if (ImGui::Selectable(label.c_str(), tag == filter_tag_)) {
+                        filter_tag_ = tag;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+        }
+        
+        bool passes_filter(message const& msg) const {
+            return msg.urgency() >= filter_urgency_ && (filter_tag_.empty() || msg.tags().contains(filter_tag_));
+        }
+        
+        // With `full`, the whole UID list is read to find what went too; otherwise only the
+        // UIDs above the highest one known are asked for, which is all an EXISTS can mean.
+        // A mailbox opened for the first time shows what the header store has before asking
+        void refresh(bool full = true) {
             try {
+                auto const account = std::format("{}|{}", host_->host(), host_->user());
+                auto const mailbox = host_->mailbox();
+                auto& store = header_store::instance();
+                if (mailbox != synced_mailbox_) {
+                    synced_mailbox_ = mailbox;
+                    messages_.clear();
+                    metadata_.clear();
+                    highest_uid_ = 0;
+                    synced_ = false;
+                    for (auto const& row : store.load(account, mailbox)) {
+                        add_message(row.uid, row.header, row.flags);
+                        highest_uid_ = std::max(highest_uid_, row.uid);
+                    }
+                    sort_messages();
+                }
+                
                 // Try to establish a connection with retry logic
                 if (!connect_with_retry()) {
                     return; // Exit if we can't connect after retries
                 }
                 
-                auto uids = host_->get_mail_uids();
+                // Another UIDVALIDITY: the stored UIDs are other messages now
+                auto const status = host_->status();
+                auto const known_state = store.state(account, mailbox);
+                if (!known_state || known_state->uidvalidity != status.uidvalidity) {
+                    store.reset(account, mailbox, status.uidvalidity);
+                    messages_.clear();
+                    metadata_.clear();
+                    synced_ = false;
+                }
+                uidvalidity_ = status.uidvalidity;
+                
+                full = full || !synced_ || messages_.empty();
+                if (full) {
+                    highest_uid_ = 0;
+                }
+                auto uids = full ? host_->get_mail_uids() : host_->get_mail_uids_from(highest_uid_ + 1);
                 
                 // Find messages that are new
+                std::unordered_set<long long> known;
+                known.reserve(messages_.size());
+                for (auto const& msg : messages_) {
+                    known.insert(msg->uid());
+                }
                 std::vector<long long> new_uids;
                 for (auto uid : uids) {
-                    auto it = std::find_if(messages_.begin(), messages_.end(), 
-                        [uid](const auto& msg) { return msg->uid() == uid; });
-                    if (it == messages_.end()) {
+                    if (!known.contains(uid)) {
                         new_uids.push_back(uid);
                     }
+                    highest_uid_ = std::max(highest_uid_, uid);
                 }
                 
-                // Create message objects for new messages
-                for (auto uid : new_uids) {
-                    auto header = host_->get_mail_header(uid);
-                    auto msg = std::make_shared<message>(uid, header);
-                    messages_.emplace_back(msg);
-                    
-                    // Start a new thread to get the body of the mail and process metadata
-                    pending_tasks_.push_back([this, uid, msg]() {
-                        try {
-                            // Get the body of the mail
-                            auto body = host_->get_mail_body(uid);
-                            // Combine with the header to get the full message
-                            auto header_and_body = std::format("{}\n\n{}", msg->header(), body);
-                            
-                            // Process metadata using the EmailMetadataAnalyzer helper
-                            std::string metadata_json = generate_email_metadata(header_and_body);
-                            
-                            msg->set_metadata(metadata_json);
-                        } catch (const std::exception& e) {
-                            "notify"_sfn(std::format("Failed to process message UID {}: {}", 
-                                uid, e.what()));
+                // Create message objects for new messages, their headers fetched in batches
+                host_->fetch_headers(new_uids, [&](long long uid, std::string_view header, std::string_view flags) {
+                    store.put(account, mailbox, uidvalidity_, uid, header, flags);
+                    add_message(uid, header, flags);
+                });
+                
+                // Flag changes on messages already here: CONDSTORE servers list just those
+                if (known_state && known_state->uidvalidity == status.uidvalidity && known_state->highestmodseq > 0
+                    && status.highestmodseq > known_state->highestmodseq) {
+                    std::unordered_map<long long, std::shared_ptr<message>> by_uid;
+                    for (auto const& msg : messages_) {
+                        by_uid.emplace(msg->uid(), msg);
+                    }
+                    host_->fetch_flags_changed_since(known_state->highestmodseq, [&](long long uid, std::string_view flags) {
+                        if (auto pos = by_uid.find(uid); pos != by_uid.end()) {
+                            pos->second->set_flags(flags);
+                            store.set_flags(account, mailbox, uidvalidity_, uid, flags);
                         }
                     });
                 }
-                
-                // Process any pending tasks
-                std::thread([this]() {
-                    auto retry = std::vector<std::function<void()>>{};
-                    auto tasks = std::move(pending_tasks_);
-                    pending_tasks_.clear();
-                    
-                    while (!tasks.empty()) {
-                        retry.clear();
-                        for (auto& task : tasks) {
-                            try {
-                                task();
-                            } catch (...) {
-                                retry.push_back(task);
-                            }
-                        }
-                        tasks = retry;
-                    }
-                }).detach();
+                if (status.highestmodseq > 0) {
+                    store.set_modseq(account, mailbox, status.highestmodseq);
+                }
                 
                 // Remove messages that no longer exist on the server
-                messages_.erase(
-                    std::remove_if(messages_.begin(), messages_.end(), 
-                        [&uids](const auto& msg) {
-                            return std::find(uids.begin(), uids.end(), msg->uid()) == uids.end();
-                        }), 
-                    messages_.end()
-                );
+                if (full) {
+                    std::unordered_set<long long> const on_server(uids.begin(), uids.end());
+                    std::vector<long long> gone;
+                    std::erase_if(messages_, [&on_server, &gone](const auto& msg) {
+                        if (on_server.contains(msg->uid())) {
+                            return false;
+                        }
+                        gone.push_back(msg->uid());
+                        return true;
+                    });
+                    store.remove(account, mailbox, uidvalidity_, gone);
+                    synced_ = true;
+                }
                 
-                // Sort messages by date (newest first)
-                std::sort(messages_.begin(), messages_.end(), 
-                    [](const auto& a, const auto& b) { 
-                        return a->date() > b->date(); 
-                    }
-                );
+                sort_messages();
                 
             } catch (const std::exception& e) {
                 "notify"_sfn(std::format("Failed to refresh messages: {}", e.what()));
@@ -181,8 +245,14 @@ namespace mail {
     private:
         std::shared_ptr<imap_host> host_;
         std::vector<std::shared_ptr<message>> messages_;
-        std::vector<std::function<void()>> pending_tasks_;
-        EmailMetadataAnalyzer metadata_analyzer_;
+        long long highest_uid_{0};     // the UID cursor: anything above it is new
+        long long uidvalidity_{0};
+        std::string synced_mailbox_;   // the mailbox messages_ holds
+        bool synced_{false};           // a full comparison with the server was made
+        metadata_pipeline metadata_;
+        std::shared_ptr<MetadataRepository> metadata_repository_ {MetadataRepository::open("email_metadata.db")};
+        int filter_urgency_{0};
+        std::string filter_tag_;
         bool is_connected_{false};
         int connection_retry_count_{0};
         
@@ -247,7 +317,7 @@ namespace mail {
                         
                         // If the metadata is empty, we need to get it from the repository
                         if (metadata_json.empty()) {
-                            auto body = host->get_mail_body(msg->uid());
+                            auto body = host->get_text(msg->uid(), metadata_pipeline::text_chars);
                             auto header_and_body = std::format("{}\n\n{}", msg->header(), body);
                             EmailMetadataAnalyzer analyzer;
                             metadata_json = analyzer.generate_metadata(header_and_body);
@@ -275,6 +345,31 @@ namespace mail {
                     } catch (const std::exception& e) {
                         "notify"_sfn(std::format("Failed to open email: {}", e.what()));
                     }
+                }, false},
+                {"Attachments", [](std::shared_ptr<imap_host> host, std::shared_ptr<message> msg) {
+                    // Only now fetched, each streamed to disk, off the UI thread
+                    rouen::helpers::scheduler()->submit([host, uid = msg->uid()](std::stop_token) {
+                        try {
+                            auto const home = std::getenv("HOME");
+                            auto const folder = std::filesystem::path(home ? home : ".") / "Downloads";
+                            std::filesystem::create_directories(folder);
+                            size_t saved = 0;
+                            for (auto const& part : host->body_structure(uid)) {
+                                if (!part.is_attachment()) {
+                                    continue;
+                                }
+                                auto name = std::filesystem::path(message::decode_header(part.filename)).filename().string();
+                                if (name.empty() || name == "." || name == "..") {
+                                    name = std::format("attachment-{}-{}", uid, part.section);
+                                }
+                                host->save_part(uid, part, folder / name);
+                                ++saved;
+                            }
+                            "notify"_sfn(saved == 0 ? std::string{"No attachments"} : std::format("Saved {} attachment(s) to {}", saved, folder.string()));
+                        } catch (const std::exception& e) {
+                            "notify"_sfn(std::format("Failed to save attachments: {}", e.what()));
+                        }
+                    }, rouen::helpers::task_priority::normal);
                 }, false}
             };
             return email_actions;
@@ -309,9 +404,23 @@ namespace mail {
             return false;
         }
         
-        // Delegate email metadata generation to the dedicated analyzer class
-        std::string generate_email_metadata(const std::string& email_content) {
-            return metadata_analyzer_.generate_metadata(email_content);
+        // A message to show, with its metadata worked out later in the pipeline
+        void add_message(long long uid, std::string_view header, std::string_view flags) {
+            auto msg = std::make_shared<message>(uid, header);
+            msg->set_flags(flags);
+            rouen::fonts::request_glyphs(msg->from());
+            rouen::fonts::request_glyphs(msg->title());
+            messages_.emplace_back(msg);
+            metadata_.enqueue(std::move(msg));
+        }
+        
+        // Newest first
+        void sort_messages() {
+            std::sort(messages_.begin(), messages_.end(), 
+                [](const auto& a, const auto& b) { 
+                    return a->date() > b->date(); 
+                }
+            );
         }
     };
 }
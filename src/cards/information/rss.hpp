@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <chrono>
+#include <filesystem>
 #include <format>
+#include <iterator>
 #include "../../helpers/imgui_include.hpp"
 #include <memory>
 #include <string>
@@ -14,6 +16,7 @@
 #include "../../helpers/fetch.hpp"
 #include "../../helpers/debug.hpp"
 #include "../../helpers/string_helper.hpp"
+#include "../../helpers/task_scheduler.hpp"
 #include "../../hosts/rss_host.hpp"
 #include "../../models/rss/feed.hpp"
 #include "../../registrar.hpp"
@@ -35,7 +38,7 @@ public:
         get_color(5, ImVec4(0.7f, 0.7f, 0.7f, 1.0f)); // Light gray for secondary text
         
         name("RSS Reader");
-        requested_fps = 1;  // Update once per second
+        requested_fps = 0;  // The host wakes the loop as feeds are loaded and refreshed
         width = 430.0f;
         
         // Use the shared host instance instead of creating a new one
@@ -64,7 +67,7 @@ public:
             ImGui::GetWindowDrawList()->AddText(
                 ImVec2(pos.x + 5, pos.y + 2),
                 ImGui::GetColorU32(ImGuiCol_TextDisabled),
-                "Enter RSS feed URL..."
+                "Enter RSS feed URL or OPML file..."
             );
         }
         ImGui::PopItemWidth();
@@ -99,7 +102,7 @@ public:
                 ImGui::GetWindowDrawList()->AddText(
                     ImVec2(pos.x + 5, pos.y + 2),
                     ImGui::GetColorU32(ImGuiCol_TextDisabled),
-                    "Search feeds... (Type to filter)"
+                    rss_host->canSearch() ? "Search feeds and items..." : "Search feeds... (Type to filter)"
                 );
             }
             ImGui::PopItemWidth();
@@ -113,18 +116,26 @@ public:
             if (ImGui::BeginChild("FeedsScrollArea", scroll_area_size, true)) {
                 auto feeds = rss_host->feeds();
                 if (feeds.empty()) {
-                    ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No feeds added yet");
+                    ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "%s",
+                        rss_host->loading() ? "Loading feeds..." : "No feeds added yet");
                 } else {
                     std::string search_text = search_buffer;
                     bool has_matches = false;
 
-                    render_feed_list(feeds, search_text, has_matches);
+                    // While searching, the feeds share the area with the matching items
+                    bool const search_items = rss_host->canSearch() && !search_text.empty();
+                    ImVec2 feeds_size {0.0f, search_items ? ImGui::GetContentRegionAvail().y * 0.35f : 0.0f};
+                    render_feed_list(feeds, search_text, has_matches, feeds_size);
 
                     // Show message when no feeds match the search
                     if (!search_text.empty() && !has_matches) {
                         ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), 
                             "No feeds match your search");
                     }
+
+                    if (search_items) {
+                        render_item_results(search_text);
+                    }
                     
                     // Process deletion requests
                     for (const auto& url : feeds_to_delete) {
@@ -141,10 +152,10 @@ public:
         });
     }
 
-    void render_feed_list(auto &feeds, std::string &search_text, bool &has_matches)
+    void render_feed_list(auto &feeds, std::string &search_text, bool &has_matches, ImVec2 outer_size = {0.0f, 0.0f})
     {
         // Setup ImGui table for feeds
-        if (ImGui::BeginTable("FeedsTable", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY))
+        if (ImGui::BeginTable("FeedsTable", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY, outer_size))
         {
             ImGui::TableSetupColumn("Feed", ImGuiTableColumnFlags_WidthStretch, 0.0f, 0);
             ImGui::TableSetupColumn("Items", ImGuiTableColumnFlags_WidthFixed, 80.0f, 1);
@@ -196,9 +207,56 @@ public:
         }
     }
 
-    // Add a new feed by URL
+    // Items of every feed matching the search, ranked by the host's full-text index.
+    // Pages are fetched as the list is scrolled to its end.
+    void render_item_results(std::string const &search_text)
+    {
+        if (search_text != item_query) {
+            item_query = search_text;
+            item_hits = rss_host->searchItems(item_query, 0);
+            items_exhausted = item_hits.size() < hosts::RSSHost::SEARCH_PAGE_SIZE;
+        }
+
+        ImGui::Separator();
+        ImGui::TextColored(colors[2], "Matching items:");
+        if (ImGui::BeginChild("ItemResults", ImVec2(0, 0), false)) {
+            if (item_hits.empty()) {
+                ImGui::TextColored(colors[5], "No items match your search");
+            }
+            for (auto const &hit : item_hits) {
+                ImGui::PushID(hit.item.link.c_str());
+                if (ImGui::Selectable(hit.item.title.empty() ? hit.item.link.c_str() : hit.item.title.c_str(), false)) {
+                    "create_card"_sfn(std::format("rss-item:{},{}", hit.feed_id, hit.item.link));
+                }
+                if (!hit.snippet.empty()) {
+                    ImGui::PushStyleColor(ImGuiCol_Text, colors[5]);
+                    ImGui::TextWrapped("%s", hit.snippet.c_str());
+                    ImGui::PopStyleColor();
+                }
+                ImGui::PopID();
+            }
+            // Reaching the end of what is loaded pulls in the next page
+            if (!items_exhausted && ImGui::GetScrollY() >= ImGui::GetScrollMaxY() - ImGui::GetTextLineHeight()) {
+                auto more = rss_host->searchItems(item_query, item_hits.size());
+                items_exhausted = more.size() < hosts::RSSHost::SEARCH_PAGE_SIZE;
+                std::move(more.begin(), more.end(), std::back_inserter(item_hits));
+            }
+        }
+        ImGui::EndChild();
+    }
+
+    // Add a new feed by URL, or import every feed of an OPML file or URL list given by path
     bool addFeed(const std::string& url) {
         try {
+            std::error_code ec;
+            if (std::filesystem::is_regular_file(url, ec)) {
+                // Read and stored off the render thread; the feeds show up as they are added
+                rouen::helpers::scheduler()->submit([host = rss_host, path = std::filesystem::path{url}](std::stop_token) {
+                    auto const added = host->importFile(path);
+                    "notify"_sfn(std::format("Imported {} new feeds from {}", added, path.filename().string()));
+                }, rouen::helpers::task_priority::normal);
+                return true;
+            }
             // Use the RSSHost controller to add the feed
             return rss_host->addFeed(url);
         } catch (const std::exception& e) {
@@ -236,6 +294,11 @@ public:
 private:
     std::shared_ptr<hosts::RSSHost> rss_host;
     std::vector<std::string> feeds_to_delete;
+
+    // Item search: the query the hits were fetched for, and whether its last page is in
+    std::string item_query;
+    std::vector<hosts::RSSHost::SearchHit> item_hits;
+    bool items_exhausted {true};
 };
 
 } // namespace rouen::cards
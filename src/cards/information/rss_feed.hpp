@@ -2,8 +2,10 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <format>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include "../../helpers/imgui_include.hpp"
@@ -51,28 +53,13 @@ namespace rouen::cards
             // Get the RSS host controller
             rss_host = rss::getHost();
 
-            // Initialize the image cache
-            image_cache = std::make_shared<::helpers::ImageCache>(
-                "rss_images.db",    // SQLite database for image cache
-                "cache/rss_images", // Cache directory for image files
-                30                  // Expire images after 30 days
-            );
+            image_cache = makeImageCache();
 
             // Load feed information and items
             loadFeed();
             width *= 1.5f; // Adjust width for better display
         }
 
-        ~rss_feed() override
-        {
-            // Clean up textures
-            if (feed_image_texture)
-            {
-                SDL_DestroyTexture(feed_image_texture);
-                feed_image_texture = nullptr;
-            }
-        }
-
         void loadFeed()
         {
             if (feed_id < 0 || !rss_host)
@@ -91,23 +78,55 @@ namespace rouen::cards
             // Update the card title with the feed title
             name(std::format("{} - Feed", feed_title));
 
-            // Load feed items
-            items = rss_host->getFeedItems(feed_id);
+            // Load the first page of items
+            items_revision = rss_host->feedRevision(feed_id);
+            reloadItems(PAGE_SIZE);
+            rss_host->prefetchSummaries(feed_id);
 
             // Load the feed image if available
             loadFeedImage();
         }
 
-        void loadFeedImage()
+        // Reads the newest `count` items again, e.g. after a refresh stored new ones
+        void reloadItems(size_t count)
+        {
+            items.clear();
+            items_cursor = {};
+            items_exhausted = false;
+            has_enclosures = false;
+            loadMoreItems(count);
+        }
+
+        // Appends the next page of (older) items
+        void loadMoreItems(size_t count = PAGE_SIZE)
         {
-            // Clean up previous texture if it exists
-            if (feed_image_texture)
+            if (items_exhausted || feed_id < 0 || !rss_host)
+                return;
+
+            auto page = rss_host->getFeedItemsPage(feed_id, items_cursor, count);
+            items_exhausted = page.size() < count;
+            for (auto &item : page)
             {
-                SDL_DestroyTexture(feed_image_texture);
-                feed_image_texture = nullptr;
-                feed_image_width = 0;
-                feed_image_height = 0;
+                // Strip HTML tags (basic approach) once, not on every frame
+                item.description.erase(std::remove_if(item.description.begin(), item.description.end(),
+                    [](char c) { return c == '<' || c == '>'; }), item.description.end());
+                std::replace_if(item.description.begin(), item.description.end(),
+                    [](char c) { return c == '\n' || c == '\r' || c == '\t'; }, ' ');
+                has_enclosures = has_enclosures || !item.enclosure.empty();
+                items.push_back(std::move(item));
             }
+        }
+
+        // Loads the whole item, description included, into the detail pane
+        void expandItem(std::string const &link)
+        {
+            expanded = rss_host->getFeedItem(feed_id, link);
+        }
+
+        void loadFeedImage()
+        {
+            // Drops the previous image; one still in the pipeline is abandoned
+            feed_image.reset();
 
             // If there's no image URL or we don't have a renderer, we're done
             if (feed_image_url.empty() || !renderer)
@@ -115,12 +134,13 @@ namespace rouen::cards
                 return;
             }
 
-            // Use the image cache to load the image
-            feed_image_texture = image_cache->getTexture(
+            // Downloaded, decoded and scaled off the UI thread; shows up when uploaded.
+            // The width bound only stops panoramas: the height is what the header shows.
+            feed_image = image_cache->requestThumbnail(
                 renderer,
                 feed_image_url,
-                feed_image_width,
-                feed_image_height);
+                static_cast<int>(FEED_IMAGE_HEIGHT * 4),
+                static_cast<int>(FEED_IMAGE_HEIGHT));
         }
 
         void set_renderer(SDL_Renderer *r)
@@ -136,11 +156,18 @@ namespace rouen::cards
 
         bool render() override
         {
+            requested_fps = media_player::anyPlaying() ? 1 : 0;
             try
             {
                 return render_window([this]()
                                      {
                 try {
+                    // Pick up items stored by the background refresh
+                    if (feed_id >= 0 && rss_host && rss_host->feedRevision(feed_id) != items_revision) {
+                        items_revision = rss_host->feedRevision(feed_id);
+                        reloadItems(std::max(items.size(), PAGE_SIZE));
+                    }
+                    
                     auto currenty_y { ImGui::GetCursorPosY() };
                     // Add refresh button at the top of the card
                     ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(colors[0].x, colors[0].y, colors[0].z, 0.7f));
@@ -163,10 +190,23 @@ namespace rouen::cards
                     
                     ImGui::SetCursorPosY(currenty_y);
                     // Display the feed image if we have one
-                    if (feed_image_texture && feed_image_width > 0 && feed_image_height > 0) {
-                        // Set fixed height of 140.0f and scale width to maintain aspect ratio
-                        float fixed_height = 140.0f;
-                        float aspect_ratio = static_cast<float>(feed_image_width) / static_cast<float>(feed_image_height);
+                    if (feed_image && feed_image->state() == ::helpers::ImageCache::AsyncTexture::State::pending) {
+                        // Holds the image's place so the list does not jump when it arrives
+                        auto const origin = ImGui::GetCursorScreenPos();
+                        auto const size = ImVec2(FEED_IMAGE_HEIGHT, FEED_IMAGE_HEIGHT);
+                        float available_width = ImGui::GetContentRegionAvail().x;
+                        float offset = (available_width - size.x) * 0.5f;
+                        auto const corner = ImVec2(origin.x + std::max(offset, 0.0f), origin.y);
+                        ImGui::GetWindowDrawList()->AddRectFilled(corner, ImVec2(corner.x + size.x, corner.y + size.y),
+                                                                 ImGui::GetColorU32(ImGuiCol_FrameBg), 4.0f);
+                        auto const icon = ImGui::CalcTextSize(ICON_MD_IMAGE);
+                        ImGui::GetWindowDrawList()->AddText(ImVec2(corner.x + (size.x - icon.x) * 0.5f, corner.y + (size.y - icon.y) * 0.5f),
+                                                            ImGui::GetColorU32(ImGuiCol_TextDisabled), ICON_MD_IMAGE);
+                        ImGui::Dummy(ImVec2(available_width, size.y));
+                    } else if (feed_image && feed_image->ready() && feed_image->width() > 0 && feed_image->height() > 0) {
+                        // Fixed height, width scaled to maintain aspect ratio
+                        float fixed_height = FEED_IMAGE_HEIGHT;
+                        float aspect_ratio = static_cast<float>(feed_image->width()) / static_cast<float>(feed_image->height());
                         float display_width = fixed_height * aspect_ratio;
                         
                         // Center the image horizontally
@@ -178,86 +218,43 @@ namespace rouen::cards
                         
                         // Create ImGui image from SDL texture
                         ImGui::Image(
-                            reinterpret_cast<void*>(feed_image_texture),
-                            ImVec2(display_width, fixed_height)
+                            feed_image->textureId(),
+                            ImVec2(display_width, fixed_height),
+                            feed_image->uv0(),
+                            feed_image->uv1()
                         );
                     }
                                 
                     ImGui::Separator();
                     
-                    // Items in a scrollable area
-                    try {
-                            if (items.empty()) {
-                                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No items in this feed");
-                            } else {
-                                for (const auto& item : items) {
-                                    // Using scope guard pattern for ImGui pairs
-                                    ImGui::PushID(item.link.c_str());
-                                    
-                                    try {
-                                        // Item container with spacing
-                                        ImGui::BeginGroup();
-                                        
-                                        try {
-                                            // Title (selectable to open item)
-                                            if (ImGui::Selectable(item.title.c_str(), false)) {
-                                                // Open item in a new card
-                                                std::string item_uri = std::format("rss-item:{},{}", feed_id, item.link);
-                                                "create_card"_sfn(item_uri);
-                                            }
-                                            
-                                            // Date - format as "Day Month Year Hour:Minute"
-                                            auto time = std::chrono::system_clock::to_time_t(item.publish_date);
-                                            std::tm* tm = std::localtime(&time);
-                                            char date_str[64];
-                                            std::strftime(date_str, sizeof(date_str), "%d %b %Y %H:%M", tm);
-                                            
-                                            ImGui::TextColored(colors[3], "%s", date_str);
-                                            
-                                            // Truncated description (if available)
-                                            if (!item.description.empty()) {
-                                                std::string desc = item.description;
-                                                // Strip HTML tags (basic approach)
-                                                desc.erase(std::remove_if(desc.begin(), desc.end(), 
-                                                    [](char c) { return c == '<' || c == '>'; }), desc.end());
-                                                
-                                                // Limit length
-                                                if (desc.length() > 100) {
-                                                    desc = desc.substr(0, 97) + "...";
-                                                }
-                                                
-                                                ImGui::TextWrapped("%s", desc.c_str());
-                                            }
-
-                                            // if there's a playable enclosure, offer media controls
-                                            if (!item.enclosure.empty()) {
-                                                media_player::player(item.enclosure, colors[4], "Play Audio");
-                                            }
-                                        }
-                                        catch (const std::exception& e) {
-                                            RSS_ERROR_FMT("Exception in RSS feed item rendering: {}", e.what());
-                                        }
-                                        
-                                        // Always end the group - regardless of exceptions
-                                        ImGui::EndGroup();
-                                    }
-                                    catch (const std::exception& e) {
-                                        RSS_ERROR_FMT("Exception in RSS feed group: {}", e.what());
-                                        // Make sure we end any ImGui operations that were started
-                                        ImGui::EndGroup();
-                                    }
-                                    
-                                    ImGui::Separator();
-                                    
-                                    // Always pop the ID
-                                    ImGui::PopID();
-                                }
+                    if (items.empty()) {
+                        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No items in this feed");
+                        return;
+                    }
+
+                    // Only the visible rows are laid out; rows share one height so the clipper
+                    // can place them, and the expanded item gets its own pane below the list
+                    float const detail_height = expanded ? ImGui::GetContentRegionAvail().y * 0.4f : 0.0f;
+                    size_t last_visible = 0;
+                    if (ImGui::BeginChild("FeedItems", ImVec2(0, -detail_height), false)) {
+                        ImGuiListClipper clipper;
+                        clipper.Begin(static_cast<int>(items.size()));
+                        while (clipper.Step()) {
+                            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                                renderItemRow(items[static_cast<size_t>(row)]);
+                                last_visible = static_cast<size_t>(row);
+                            }
                         }
                     }
-                    catch (const std::exception& e) {
-                        RSS_ERROR_FMT("Exception in RSS feed items area: {}", e.what());
-                        // Always ensure EndChild is called to match the BeginChild
-                        ImGui::EndChild();
+                    ImGui::EndChild();
+
+                    // Fetch older items before the list runs out
+                    if (!items_exhausted && last_visible + PAGE_SIZE / 4 >= items.size()) {
+                        loadMoreItems();
+                    }
+
+                    if (expanded) {
+                        renderExpandedItem();
                     }
                 }
                 catch (const std::exception& e) {
@@ -271,11 +268,102 @@ namespace rouen::cards
             }
         }
 
+        void renderItemRow(rouen::hosts::RSSHost::FeedItem const &item)
+        {
+            auto const &style = ImGui::GetStyle();
+            float const row_height = ImGui::GetTextLineHeightWithSpacing() * 3.0f + style.ItemSpacing.y
+                + (has_enclosures ? ImGui::GetFrameHeightWithSpacing() * 2.0f : 0.0f);
+
+            ImGui::PushID(item.link.c_str());
+            if (ImGui::BeginChild("Row", ImVec2(0, row_height), false, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse)) {
+                // Title (selectable to open item), with a toggle for the full description
+                bool const is_expanded = expanded && expanded->link == item.link;
+                float const toggle_width = ImGui::GetFrameHeight();
+                if (ImGui::Selectable(item.title.c_str(), is_expanded, 0, ImVec2(ImGui::GetContentRegionAvail().x - toggle_width - style.ItemSpacing.x, 0))) {
+                    // Open item in a new card
+                    "create_card"_sfn(std::format("rss-item:{},{}", feed_id, item.link));
+                }
+                ImGui::SameLine();
+                if (ImGui::SmallButton(is_expanded ? ICON_MD_EXPAND_LESS : ICON_MD_EXPAND_MORE)) {
+                    if (is_expanded) {
+                        expanded.reset();
+                    } else {
+                        expandItem(item.link);
+                    }
+                }
+
+                // Date - format as "Day Month Year Hour:Minute"
+                auto time = std::chrono::system_clock::to_time_t(item.publish_date);
+                std::tm* tm = std::localtime(&time);
+                char date_str[64];
+                std::strftime(date_str, sizeof(date_str), "%d %b %Y %H:%M", tm);
+                ImGui::TextColored(colors[3], "%s", date_str);
+
+                // One line of the description preview
+                if (!item.description.empty()) {
+                    ImGui::TextUnformatted(item.description.c_str());
+                }
+
+                // if there's a playable enclosure, offer media controls
+                if (!item.enclosure.empty()) {
+                    media_player::player(item.enclosure, colors[4], "Play Audio", [host = rss_host.get()](std::string_view url) {
+                        return host->episodeSource(std::string{url});
+                    });
+                }
+            }
+            ImGui::EndChild();
+            ImGui::Separator();
+            ImGui::PopID();
+        }
+
+        void renderExpandedItem()
+        {
+            ImGui::Separator();
+            if (ImGui::SmallButton(ICON_MD_CLOSE)) {
+                expanded.reset();
+                return;
+            }
+            ImGui::SameLine();
+            ImGui::TextColored(colors[2], "%s", expanded->title.c_str());
+            if (ImGui::BeginChild("ExpandedItem", ImVec2(0, 0), false)) {
+                ImGui::TextWrapped("%s", expanded->description.c_str());
+            }
+            ImGui::EndChild();
+        }
+
         std::string get_uri() const override
         {
             return std::format("rss-feed:{}", feed_id);
         }
 
+        // The items, the expanded one and the image cache go; resume() reads the first page again
+        void hibernate() override
+        {
+            items.clear();
+            items.shrink_to_fit();
+            items_cursor = {};
+            items_exhausted = false;
+            expanded.reset();
+            feed_image.reset();
+            image_cache.reset();
+        }
+
+        void resume() override
+        {
+            image_cache = makeImageCache();
+            loadFeed();
+        }
+
+        size_t resident_bytes() const override
+        {
+            size_t bytes = items.capacity() * sizeof(rouen::hosts::RSSHost::FeedItem);
+            for (auto const &item : items)
+            {
+                bytes += item.title.size() + item.description.size() + item.link.size() + item.enclosure.size() + item.image_url.size();
+            }
+            return bytes;
+        }
+
         void refreshFeed()
         {
             try
@@ -308,18 +396,33 @@ namespace rouen::cards
         }
 
     private:
+        static std::shared_ptr<::helpers::ImageCache> makeImageCache()
+        {
+            return std::make_shared<::helpers::ImageCache>(
+                "rss_images.db",    // SQLite database for image cache
+                "cache/rss_images", // Cache directory for image files
+                30                  // Expire images after 30 days
+            );
+        }
+
         long long feed_id = -1;
         std::string feed_title;
         std::string feed_url;
         std::string feed_image_url;
         std::shared_ptr<rouen::hosts::RSSHost> rss_host;
+        // Items are read a page at a time, with description previews only
+        static constexpr size_t PAGE_SIZE = 100;
         std::vector<rouen::hosts::RSSHost::FeedItem> items;
+        rouen::hosts::RSSHost::ItemCursor items_cursor;
+        bool items_exhausted = false;
+        bool has_enclosures = false;
+        std::optional<rouen::hosts::RSSHost::FeedItem> expanded;    // shown in full below the list
+        uint64_t items_revision = 0;    // RSSHost::feedRevision() the items were loaded at
 
         // Image handling
+        static constexpr float FEED_IMAGE_HEIGHT = 140.0f;
         SDL_Renderer *renderer = nullptr;
-        SDL_Texture *feed_image_texture = nullptr;
-        int feed_image_width = 0;
-        int feed_image_height = 0;
+        std::shared_ptr<::helpers::ImageCache::AsyncTexture> feed_image;
         std::shared_ptr<::helpers::ImageCache> image_cache;
     };
 
@@ -53,8 +53,8 @@ public:
         // Adjust size to be larger for content display
         width *= 2.0f;
         
-        // Set refresh rate to check media playback status
-        requested_fps = 1;
+        // Raised to 1 while something plays, for the player's position (see render)
+        requested_fps = 0;
     }
     
     ~rss_item() override {
@@ -86,6 +86,7 @@ public:
     }
     
     bool render() override {
+        requested_fps = media_player::anyPlaying() ? 1 : 0;
         try {
             return render_window([this]() {
                 try {
@@ -116,7 +117,9 @@ public:
                         
                         // Use the media_player helper for playback controls
                         try {
-                            media_player::player(item.enclosure, colors[2]);
+                            media_player::player(item.enclosure, colors[2], "Media", [host = rss_host.get()](std::string_view url) {
+                                return host->episodeSource(std::string{url});
+                            });
                         } catch (const std::exception& e) {
                             RSS_ERROR_FMT("Exception in media player: {}", e.what());
                         }
@@ -124,6 +127,8 @@ public:
                         ImGui::Separator();
                     }
                     
+                    renderSummary();
+                    
                     // Content in a scrollable area
                     try {
                         // Note: BeginChild returns if content is visible, but EndChild must always be called
@@ -193,6 +198,34 @@ public:
         }
     }
 
+    // The article summary, or a placeholder while it is being written off the render thread.
+    // A failure stays on the card until Retry: it is not asked for again every frame
+    void renderSummary() {
+        if (!hosts::RSSHost::canSummarize()) {
+            return;
+        }
+        using media::rss::summarizer;
+        if (summary.what != summarizer::state::ready && summary.what != summarizer::state::failed) {
+            summary = rss_host->itemSummary(item_link);
+        }
+        ImGui::TextColored(colors[2], "Summary");
+        switch (summary.what) {
+        case summarizer::state::ready:
+            ImGui::TextWrapped("%s", summary.text.c_str());
+            break;
+        case summarizer::state::failed:
+            ImGui::TextColored(colors[5], "No summary: %s", summary.text.c_str());
+            if (ImGui::SmallButton("Retry")) {
+                summary = rss_host->retrySummary(item_link);
+            }
+            break;
+        default:
+            ImGui::TextColored(colors[3], "Summarizing...");
+            break;
+        }
+        ImGui::Separator();
+    }
+
     std::string get_uri() const override
     {
         return std::format("rss-item:{},{}", feed_id, item_link);
@@ -204,6 +237,7 @@ private:
     bool item_loaded = false;
     std::shared_ptr<hosts::RSSHost> rss_host;
     hosts::RSSHost::FeedItem item; // Use the FeedItem from the controller
+    media::rss::summarizer::status summary;
     
     // Use the media_player helper for media playback
     media_player::item media;
@@ -43,7 +43,7 @@ public:
         get_color(9, ImVec4(0.3f, 0.4f, 0.8f, 1.0f)); // Date picker current day
         
         name("Travel Plans");
-        requested_fps = 5;  // Higher FPS for smoother loading states
+        requested_fps = 0;  // Raised while the host loads, for the spinner (see render)
         width = 400.0f;
         
         DB_INFO("Travel card: Getting TravelHost");
@@ -68,8 +68,6 @@ public:
         current_month = now_tm.tm_mon;
         current_year = now_tm.tm_year + 1900;
         
-        last_refresh_time = std::chrono::steady_clock::now();
-        
         DB_INFO("Travel card: Constructor completed");
     }
     
@@ -482,19 +480,17 @@ public:
     bool render() override {
         DB_INFO("Travel card: Render starting");
         
-        // Check if we need to refresh our loading state
-        auto now = std::chrono::steady_clock::now();
-        if (is_loading && std::chrono::duration_cast<std::chrono::milliseconds>(now - last_refresh_time).count() > 100) {
-            // Check if TravelHost has completed initialization
+        // Loading until the host has read the database (an empty plan list counts); it wakes
+        // the loop when it has
+        if (is_loading) {
             if (!travel_host) {
                 DB_ERROR("Travel card: TravelHost is null when checking loading state");
-            } else {
-                // Accept empty plan vectors as valid initialized state, don't wait for plans to exist
+            } else if (travel_host->initialized()) {
                 is_loading = false;
-                DB_INFO("Travel card: Loading completed (accepting empty plans as valid)");
+                DB_INFO("Travel card: Loading completed");
             }
-            last_refresh_time = now;
         }
+        requested_fps = is_loading && travel_host ? 20 : 0;
         
         bool result = render_window([this]() {
             try {
@@ -520,7 +516,9 @@ public:
                 // Create scrollable area for travel plans
                 if (ImGui::BeginChild("PlansScrollArea", ImVec2(0, 0), true)) {
                     DB_INFO("Travel card: Getting plans from host");
-                    auto plans = travel_host->plans();
+                    // The host's current snapshot, by pointer: nothing is copied per frame
+                    auto const snapshot = travel_host->plans();
+                    auto const& plans = *snapshot;
                     DB_INFO_FMT("Travel card: Got {} plans", plans.size());
                     
                     if (plans.empty()) {
@@ -655,7 +653,6 @@ private:
     std::shared_ptr<hosts::TravelHost> travel_host;
     std::vector<long long> plans_to_delete;
     bool is_loading = false;
-    std::chrono::steady_clock::time_point last_refresh_time;
     
     // Date picker state
     int current_month;
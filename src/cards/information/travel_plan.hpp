@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../../helpers/imgui_include.hpp"
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <memory>
@@ -11,6 +13,7 @@
 #include <sstream>
 #include <iomanip>
 #include <ctime>
+#include <utility>
 
 #include "../interface/card.hpp"
 #include "../../hosts/travel_host.hpp"
@@ -45,7 +48,8 @@ public:
         );
         
         width = 600.0f;
-        requested_fps = 1;  // Update once per second
+        requested_fps = 0;  // Edits to the plan invalidate the card through the host (see below)
+        cache_texture = true;  // The plan rarely changes; reuse the last rendering between updates
         
         // Initialize the Travel host controller
         travel_host = hosts::TravelHost::getHost();
@@ -63,11 +67,36 @@ public:
         } catch (const std::exception& e) {
             name("Travel Plan (Invalid ID)");
         }
+
+        // Picked up on the next render when this plan is edited anywhere (another card included)
+        plan_link->owner = this;
+        subscription = travel_host->subscribe([link = plan_link, id = plan_id](long long changed) {
+            if (changed == id) {
+                std::lock_guard<std::mutex> lock(link->mutex);
+                link->stale = true;
+                if (link->owner) {
+                    link->owner->invalidate();
+                }
+            }
+        });
     }
     
-    ~travel_plan() override = default;
+    ~travel_plan() override {
+        {
+            std::lock_guard<std::mutex> lock(plan_link->mutex);
+            plan_link->owner = nullptr;
+        }
+        travel_host->unsubscribe(subscription);
+    }
 
     bool render() override {
+        if (plan_link->take_stale()) {
+            plan_ptr = travel_host->getPlan(plan_id);
+            if (plan_ptr) {
+                name(std::format("{} - Trip", plan_ptr->title));
+            }
+            invalidate();
+        }
         return render_window([this]() {            
             // Plan details section
             render_plan_details();
@@ -392,8 +421,21 @@ private:
     }
     
     std::shared_ptr<hosts::TravelHost> travel_host;
-    std::shared_ptr<media::travel::plan> plan_ptr;
+    hosts::TravelHost::plan_ptr plan_ptr;
     long long plan_id{-1};
+    // Shared with the host's listener, which may still be running once the card is gone
+    struct link {
+        std::mutex mutex;
+        card const* owner {nullptr};
+        bool stale {false};
+
+        bool take_stale() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return std::exchange(stale, false);
+        }
+    };
+    std::shared_ptr<link> plan_link {std::make_shared<link>()};
+    int subscription {-1};
     helpers::DatePicker date_picker;
 };
 
@@ -9,6 +9,7 @@
 
 #include "../interface/card.hpp"
 #include "../../helpers/debug.hpp"
+#include "../../helpers/timer_wheel.hpp"
 #include "../../hosts/weather_host.hpp"
 #include "../../registrar.hpp"
 
@@ -30,12 +31,16 @@ public:
         
         name("Weather & Time");
         width = 320.0f;
-        requested_fps = 1;  // Update once per second for the clock
+        requested_fps = 0;  // clock_timer invalidates once per second, the host when data arrives
+        cache_texture = true;  // Composite a cached texture between the once-per-second updates
+        if (auto const timers = helpers::timers()) {
+            clock_timer = timers->every(std::chrono::seconds{1}, [this]() { invalidate(); });
+        }
         
-        // Get the weather host
-        weather_host = std::make_shared<hosts::WeatherHost>();
+        // Every weather card shares the host, which fetches all their locations together
+        weather_host = hosts::WeatherHost::getHost();
 
-        setLocation(location);
+        setLocation(location.empty() ? std::string_view{"Paris,fr"} : location);
         
         DB_INFO("Weather card: Constructor completed");
     }
@@ -43,19 +48,25 @@ public:
     ~weather() override = default;
 
     bool render() override {
-        return render_window([this]() {
+        // One pointer copy per frame; the host swaps in a new snapshot when data arrives
+        auto const data = weather_host->getWeather(location_);
+        if (data != shown_) {
+            shown_ = data;
+            update_name();
+        }
+        return render_window([this, &data]() {
             // Display current time
-            render_time();
+            render_time(*data);
             
             ImGui::Separator();
             
             // Display current weather
-            render_weather();
+            render_weather(*data);
             
             ImGui::Separator();
             
             // Display weather forecast
-            render_forecast();
+            render_forecast(*data);
             
             // Allow changing location
             render_location_input();
@@ -63,14 +74,14 @@ public:
     }
 
     std::string get_uri() const override {
-        return std::format("weather:{}", weather_host->getLocation());
+        return std::format("weather:{}", location_);
     }
     
 private:
-    void render_time() {
+    void render_time(const hosts::weather::snapshot& data) {
         // Get current time
         auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
-        auto current_weather = weather_host->getCurrentWeather();
+        auto const& current_weather = data.current;
         if (current_weather) {
             // Adjust time zone based on weather data
             auto timezone_offset = std::chrono::seconds(current_weather->timezone);
@@ -92,8 +103,8 @@ private:
         ImGui::TextColored(colors[5], "%s", date_str.c_str());
     }
     
-    void render_weather() {
-        auto current_weather = weather_host->getCurrentWeather();
+    void render_weather(const hosts::weather::snapshot& data) {
+        auto const& current_weather = data.current;
         
         if (!current_weather) {
             ImGui::TextColored(colors[5], "Weather data loading...");
@@ -140,8 +151,8 @@ private:
         }
     }
     
-    void render_forecast() {
-        auto forecast = weather_host->getForecast();
+    void render_forecast(const hosts::weather::snapshot& data) {
+        auto const& forecast = data.forecast;
         
         if (!forecast) {
             ImGui::TextColored(colors[5], "Forecast data loading...");
@@ -205,7 +216,7 @@ private:
     void render_location_input() {
         
         if (!initialized_) {
-            std::string current_location = weather_host->getLocation();
+            std::string const& current_location = location_;
             auto len = std::min(current_location.size(), sizeof(location_buffer_) - 1);
             strncpy(location_buffer_, current_location.c_str(), len + 1);
             initialized_ = true;
@@ -231,12 +242,15 @@ private:
     
 private:
     void setLocation(std::string_view location) {
-        weather_host->setLocation(location);
-        weather_host->refreshWeather();
-        auto current_weather = weather_host->getCurrentWeather();
-        if (current_weather) {
-            auto location_name = current_weather->name;
-            std::string country = current_weather->sys.country;
+        location_ = location;
+        shown_ = weather_host->getWeather(location_);
+        update_name();
+    }
+
+    void update_name() {
+        if (shown_ && shown_->current) {
+            auto location_name = shown_->current->name;
+            std::string country = shown_->current->sys.country;
             if (!country.empty()) {
                 location_name += ", " + country;
             }
@@ -245,6 +259,9 @@ private:
     }
 
     std::shared_ptr<hosts::WeatherHost> weather_host;
+    std::string location_;
+    std::shared_ptr<const hosts::weather::snapshot> shown_;    // the snapshot the name was taken from
+    helpers::timer_wheel::timer clock_timer;
     bool initialized_{false};
     char location_buffer_[64]{};
 };
@@ -2,6 +2,8 @@
 
 // 1. Standard includes in alphabetic order
 #include <array>
+#include <atomic>
+#include <cstddef>
 #include <format>
 #include <functional>
 #include <memory>
@@ -10,7 +12,7 @@
 #include "../../helpers/imgui_include.hpp"
 
 // 3. All other includes
-// None in this file
+#include "../../helpers/redraw.hpp"
 
 struct card {
     using ptr = std::shared_ptr<card>;
@@ -33,8 +35,46 @@ struct card {
     
     virtual bool render() = 0;
 
+    // Called instead of render() while the card lies outside the visible viewport, on
+    // whatever frames the visible cards ask for. Nothing is drawn; work due at a given time
+    // (alarms, sounds, refreshes) belongs in a timer from helpers/timer_wheel.hpp instead.
+    // Returning false closes the card, as with render().
+    virtual bool render_offscreen() {
+        return true;
+    }
+
     virtual std::string get_uri() const = 0;
 
+    // Hibernation: the deck calls hibernate() on a card that has been out of view for a
+    // while, or sooner when the open cards hold more than its memory budget. The card drops
+    // what it can build again (textures, caches, loaded pages) and stops polling; get_uri()
+    // and what it needs to come back must still work. A hibernated card gets neither render()
+    // nor render_offscreen() until it is about to be shown, when resume() comes first.
+    virtual void hibernate() {}
+    virtual void resume() {}
+
+    // False while the card must keep running out of view (an alarm counting, a stream playing)
+    virtual bool can_hibernate() const {
+        return true;
+    }
+
+    // About how many bytes hibernate() would give back, for the deck's memory budget
+    virtual size_t resident_bytes() const {
+        return 0;
+    }
+
+    // Request a repaint of the deck; safe to call from background threads.
+    // Cards with requested_fps == 0 are only redrawn on input or invalidation.
+    void invalidate() const {
+        invalidated.store(true, std::memory_order_release);
+        rouen::helpers::request_redraw();
+    }
+
+    // Consumed by the deck to refresh a texture-cached card outside its own frame rate
+    bool take_invalidation() const {
+        return invalidated.exchange(false, std::memory_order_acq_rel);
+    }
+
     bool run_focused_handlers() {
         if (is_focused = ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows), is_focused) {
             // check for ctrl+w
@@ -82,5 +122,8 @@ struct card {
     bool is_focused{false};
     bool grab_focus{false};
     std::string window_title;
-    int requested_fps{1};
+    int requested_fps{0};               // Frames per second while shown; 0 = redraw on input/invalidate only
+    bool cache_texture{false};          // Render live at requested_fps only, composite a cached texture otherwise
+    mutable std::atomic<bool> invalidated{false};
+    bool hibernated{false};             // Set by the deck around hibernate() and resume()
 };
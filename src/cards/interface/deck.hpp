@@ -2,13 +2,20 @@
 
 // 1. Standard includes in alphabetic order
 #include <algorithm> // Added for std::find_if
+#include <atomic>
+#include <cctype>
 #include <chrono>    // Added for timestamp
+#include <cstdlib>
+#include <filesystem>
+#include <format>
 #include <fstream>   // Added for file I/O
 #include <functional>
 #include <iomanip>   // Added for std::put_time
 #include <iostream>  // Added for console output
+#include <memory>
 #include <sstream>   // Added for string stream
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -18,13 +25,24 @@
 
 // 3. All other includes
 #include "../../helpers/capture_helper.hpp"
+#include "../../helpers/card_texture_cache.hpp"
 #include "../../helpers/deferred_operations.hpp"
+#include "../../helpers/frame_profiler.hpp"
+#include "../../helpers/launcher_index.hpp"
+#include "../../helpers/memory_accounting.hpp"
+#include "../../helpers/redraw.hpp"
+#include "../../helpers/startup_timeline.hpp"
+#include "../../helpers/trace.hpp"
+#include "../../helpers/workspace.hpp"
 #include "../../registrar.hpp"
 #include "../productivity/editor.hpp"
 #include "factory.hpp"
+#include "placeholder.hpp"
 
 struct deck {
-    deck(SDL_Renderer* renderer): renderer(renderer), editor_() {
+    // A non-persistent deck neither restores nor saves the layout in workspace.db (used by rouen_bench)
+    explicit deck(SDL_Renderer* renderer, bool persistent = true)
+        : renderer(renderer), editor_(), profiler_(std::make_shared<rouen::helpers::frame_profiler>()), persistent_(persistent) {
         // Initialize colors
         background_color = {0.0, 0.0f, 0.0f, 0.70f};
         editor_background_color = {0.76f, 0.76f, 0.66f, 0.40f};
@@ -37,25 +55,41 @@ struct deck {
                 [this](std::string const& uri) { create_card(uri); }
             )
         );
+
+        // Expose per-card render timings to the profiler card and others
+        registrar::add<rouen::helpers::frame_profiler>("frame_profiler", profiler_);
         
-        // Load cards from ImGui configuration or create default menu card
-        load_card_uris();
+        // Restore the saved layout or create default menu card
+        if (persistent_) {
+            workspace_ = std::make_unique<rouen::helpers::workspace>();
+            load_workspace();
+            start_dashboard_snapshots();
+        }
     }
 
     ~deck() {
-        // Save card state when the deck is destroyed
-        save_card_uris();
+        // Save the layout as the deck is destroyed, and wait until it is written
+        if (persistent_) {
+            save_workspace();
+            workspace_->flush();
+        }
         
+        if (dashboard_timer_) {
+            SDL_RemoveTimer(dashboard_timer_);
+        }
+
         // Unregister the create_card function
         registrar::remove<std::function<void(std::string const&)>>("create_card");
+        registrar::remove<rouen::helpers::frame_profiler>("frame_profiler");
     }
 
-    void create_card(std::string_view uri, bool move_first = false) {
+    void create_card(std::string_view uri, bool move_first = false,
+                     deferred_operations::lane lane = deferred_operations::lane::input) {
         // this needs to be deferred
         auto deferred_ops = registrar::get<deferred_operations>("deferred_ops");
         deferred_ops->queue([this, uri = std::string{uri}, move_first] {
             create_card_impl(uri, move_first);
-        });
+        }, lane);
     }
 
     void create_card_impl(std::string_view uri, bool move_first = false) {
@@ -67,8 +101,8 @@ struct deck {
             (*existing_card)->grab_focus = true;
         }
         else {
-            static auto card_factory {rouen::cards::factory()};
-            auto card_ptr = card_factory.create_card(uri, renderer);
+            rouen::helpers::memory::scope memory_tag{card_memory_tag(uri)};
+            auto card_ptr = card_factory().create_card(uri, renderer);
             if (card_ptr) {
                 if (move_first) {
                     // Move the card to the front of the vector
@@ -78,6 +112,13 @@ struct deck {
                     cards_.emplace_back(std::move(card_ptr));
                 }
             }
+            else {
+                return;
+            }
+        }
+        // Every card opened, from the menu or from another card, counts towards the launcher's ranking
+        if (auto launcher = rouen::helpers::launcher_index::shared()) {
+            launcher->launched(std::string{uri});
         }
     }
 
@@ -136,9 +177,47 @@ struct deck {
         };
     };
 
+    // True when the card's rectangle misses the viewport entirely; focused cards and
+    // cards asking for focus are always drawn so keyboard navigation keeps working
+    static bool is_culled(card const &c, float x, float y, float height, ImVec2 viewport) {
+        if (c.grab_focus || c.is_focused) {
+            return false;
+        }
+        return x + c.width <= 0.0f || x >= viewport.x || y + height <= 0.0f || y >= viewport.y;
+    }
+
     bool render(card &c, float &x, float height, int &requested_fps, float y = 0.0f) {
-        ImGui::SetNextWindowPos({x, y}, ImGuiCond_Always);
-        ImGui::SetNextWindowSize({c.width, height}, ImGuiCond_Always);
+        rouen::helpers::memory::scope memory_tag{card_memory_tag(c)};
+        if (is_culled(c, x, y, height, ImGui::GetMainViewport()->Size)) {
+            // Out of view since it was first seen, as far as hibernation goes
+            last_shown_.try_emplace(&c, frame_time_);
+            profiler_->mark_culled(c.get_uri());
+            x += c.width + 2.0f;
+            if (c.hibernated) {
+                return true;
+            }
+            // Skip ImGui submission entirely; the card still gets to run its background
+            // checks, but what it can't show does not drive the frame rate: a card that must
+            // act at some time out of view sets a timer (helpers/timer_wheel.hpp)
+            return c.render_offscreen();
+        }
+
+        if (c.hibernated) {
+            c.hibernated = false;
+            c.resume();
+        }
+        last_shown_[&c] = frame_time_;
+
+        ImVec2 const pos {x, y};
+        ImVec2 const size {c.width, height};
+        ImGui::SetNextWindowPos(pos, ImGuiCond_Always);
+        ImGui::SetNextWindowSize(size, ImGuiCond_Always);
+
+        if (c.cache_texture && render_cached(c, pos, size)) {
+            requested_fps = std::max(requested_fps, std::min(c.requested_fps, 1));
+            x += c.width + 2.0f;
+            return true;
+        }
 
         color_setup colors(c.get_color(0), c.get_color(1));
 
@@ -147,13 +226,177 @@ struct deck {
             c.grab_focus = false;
             ImGui::SetNextWindowFocus();
         }
+        auto const render_start = rouen::helpers::frame_profiler::clock::now();
         bool result = c.render();
+        auto const render_end = rouen::helpers::frame_profiler::clock::now();
+        auto const uri = c.get_uri();
+        profiler_->record(uri, render_end - render_start);
+        rouen::helpers::trace::complete("WINDOW", "card", render_start, render_end, uri);
+        if (c.cache_texture) {
+            // Interactive frames are not worth keeping; recapture once the card is idle again
+            auto& entry = card_cache_[&c];
+            if (is_interacting(c, pos, size)) {
+                entry.stale = true;
+            } else {
+                pending_captures_.push_back({&c, c.window_title, pos, size});
+            }
+        }
         requested_fps = std::max(requested_fps, c.requested_fps);
         
         x += c.width + 2.0f;
         return result;
     }
 
+    /**
+     * Hibernates the cards out of view for ROUEN_HIBERNATE_SECONDS (600 by default, 0 for
+     * never); then, while the awake cards and their cached textures hold more than
+     * ROUEN_CARD_BUDGET_MB (256 by default, 0 for no budget), the other out-of-view cards,
+     * least recently shown first. Cards drawn this frame stay awake. Looked at once a second.
+     */
+    void hibernate_idle_cards() {
+        if (frame_time_ - last_hibernation_check_ < std::chrono::seconds{1}) {
+            return;
+        }
+        last_hibernation_check_ = frame_time_;
+        std::erase_if(last_shown_, [this](auto const& kv) {
+            return std::none_of(cards_.begin(), cards_.end(), [&kv](auto const& c) { return c.get() == kv.first; });
+        });
+
+        struct candidate {
+            activity_clock::time_point shown;
+            card* c;
+            size_t bytes;
+        };
+        std::vector<candidate> candidates;
+        size_t resident = 0;
+        for (auto const& c : cards_) {
+            if (c->hibernated) {
+                continue;
+            }
+            auto const bytes = resident_bytes(*c);
+            resident += bytes;
+            auto const shown = last_shown_.find(c.get());
+            if (shown == last_shown_.end() || shown->second == frame_time_ || !c->can_hibernate()) {
+                continue;
+            }
+            if (hibernate_after_.count() > 0 && frame_time_ - shown->second >= hibernate_after_) {
+                hibernate(*c);
+                resident -= bytes;
+            } else {
+                candidates.push_back({shown->second, c.get(), bytes});
+            }
+        }
+        if (memory_budget_ == 0 || resident <= memory_budget_) {
+            return;
+        }
+        std::sort(candidates.begin(), candidates.end(), [](auto const& a, auto const& b) { return a.shown < b.shown; });
+        for (auto const& next : candidates) {
+            if (resident <= memory_budget_) {
+                break;
+            }
+            hibernate(*next.c);
+            resident -= next.bytes;
+        }
+    }
+
+    // With ROUEN_MEMORY_TAGS, what a card allocates counts under its kind (the URI up to ':')
+    static rouen::helpers::memory::tag_t card_memory_tag(std::string_view uri) {
+        if (!rouen::helpers::memory::enabled()) {
+            return 0;
+        }
+        return rouen::helpers::memory::tag_id(std::format("card:{}", uri.substr(0, uri.find(':'))));
+    }
+
+    static rouen::helpers::memory::tag_t card_memory_tag(card const& c) {
+        return rouen::helpers::memory::enabled() ? card_memory_tag(c.get_uri()) : rouen::helpers::memory::tag_t{0};
+    }
+
+    // What the cards say they hold, by kind, and the deck's cached card textures
+    void report_memory(rouen::helpers::memory::report::emit_fn const& emit) const {
+        for (auto const& c : cards_) {
+            auto const uri = c->get_uri();
+            emit(std::format("card:{} (self-reported)", std::string_view{uri}.substr(0, uri.find(':'))), c->resident_bytes());
+        }
+        for (auto const& [owner, cached] : card_cache_) {
+            emit("deck card textures", cached.texture.bytes());
+        }
+    }
+
+    size_t resident_bytes(card const& c) const {
+        auto const cached = card_cache_.find(&c);
+        return c.resident_bytes() + (cached == card_cache_.end() ? 0 : cached->second.texture.bytes());
+    }
+
+    void hibernate(card& c) {
+        c.hibernate();
+        c.hibernated = true;
+        card_cache_.erase(&c);
+        std::erase_if(pending_captures_, [&c](auto const& pending) { return pending.owner == &c; });
+    }
+
+    static std::chrono::seconds hibernate_after_from_env() {
+        auto const spec = std::getenv("ROUEN_HIBERNATE_SECONDS");
+        return std::chrono::seconds{std::max(0, spec ? std::atoi(spec) : 600)};
+    }
+
+    static size_t memory_budget_from_env() {
+        auto const spec = std::getenv("ROUEN_CARD_BUDGET_MB");
+        return static_cast<size_t>(std::max(0, spec ? std::atoi(spec) : 256)) << 20;
+    }
+
+    // A card under the mouse, focused, or with a popup open must be drawn live
+    static bool is_interacting(card const &c, ImVec2 pos, ImVec2 size) {
+        return c.grab_focus || c.is_focused ||
+            ImGui::IsMouseHoveringRect(pos, ImVec2{pos.x + size.x, pos.y + size.y}, false) ||
+            ImGui::IsPopupOpen(nullptr, ImGuiPopupFlags_AnyPopupId);
+    }
+
+    // Composite the card's cached texture when nothing requires a live render
+    bool render_cached(card &c, ImVec2 pos, ImVec2 size) {
+        auto it = card_cache_.find(&c);
+        if (it == card_cache_.end() || it->second.stale || !it->second.texture.matches(pos, size)) {
+            return false;
+        }
+        if (is_interacting(c, pos, size) || c.take_invalidation()) {
+            return false;
+        }
+        if (c.requested_fps > 0) {
+            auto const period = std::chrono::milliseconds(1000 / c.requested_fps);
+            if (rouen::helpers::card_texture_cache::clock::now() - it->second.texture.last_capture() >= period) {
+                return false;
+            }
+        }
+
+        ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
+        ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
+        if (ImGui::Begin(c.window_title.c_str(), nullptr,
+                ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoBackground |
+                ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing)) {
+            it->second.texture.draw(ImGui::GetWindowDrawList(), pos);
+        }
+        ImGui::End();
+        ImGui::PopStyleVar(2);
+        return true;
+    }
+
+    // Replay this frame's live renders of texture-cached cards into their textures.
+    // Call after ImGui::Render() and before the draw data is presented.
+    void capture_cached_cards(ImDrawData const* draw_data) {
+        for (auto const& pending : pending_captures_) {
+            auto it = card_cache_.find(pending.owner);
+            if (it != card_cache_.end() &&
+                it->second.texture.capture(renderer, draw_data, pending.window_title, pending.pos, pending.size)) {
+                it->second.stale = false;
+            }
+        }
+        pending_captures_.clear();
+
+        // Drop textures of cards that have been closed
+        std::erase_if(card_cache_, [this](auto const& kv) {
+            return std::none_of(cards_.begin(), cards_.end(), [&kv](auto const& c) { return c.get() == kv.first; });
+        });
+    }
+
     void handle_shortcuts() {
         if (ImGui::GetIO().KeyCtrl) {
             if (ImGui::GetIO().KeyShift) {
@@ -187,73 +430,15 @@ struct deck {
                         ss << "card_" << std::put_time(std::localtime(&now_time_t), "%Y%m%d_%H%M%S") << ".png";
                         std::string filename = ss.str();
                         
-                        // Create a render function that draws the card content
-                        auto render_function = [this, &focused_card]() {
-                            auto &c = *(*focused_card);
-                            // Create a temporary rendering environment for the card
-                            // without its window decorations
-                            ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
-                            ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
-
-                            ImGui::PushStyleColor(ImGuiCol_WindowBg, background_color);
-                            ImGui::PushStyleColor(ImGuiCol_TitleBg, background_color);
-                            ImGui::PushStyleColor(ImGuiCol_Text, text_color);                
-                            color_setup colors(c.get_color(0), c.get_color(1));
-                            
-                            c.render();
-                            ImGui::PopStyleColor(3); // Pop the style colors
-                            ImGui::PopStyleVar(2); // Pop the style variables
-                        };
-                        
-                        // Get card dimensions
-                        int width = static_cast<int>((*focused_card)->width);
-                        int height = static_cast<int>(450.0f); // Use the standard card height
-                        
-                        // Use our capture helper to get a texture with the card contents
-                        SDL_Texture* snapshot_texture = rouen::helpers::capture_imgui(
-                            width, height, render_function, renderer);
-                        
-                        if (snapshot_texture) {
-                            // Read the pixel data from the texture
-                            int texture_width, texture_height;
-                            SDL_QueryTexture(snapshot_texture, nullptr, nullptr, &texture_width, &texture_height);
-                            
-                            // Create a surface to store the pixel data
-                            SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(
-                                0, texture_width, texture_height, 32, SDL_PIXELFORMAT_RGBA32);
-                            
-                            if (surface) {
-                                // We can't directly lock a render target texture, so we need to use SDL_RenderReadPixels
-                                // Make sure we're rendering to the texture we want to capture
-                                SDL_SetRenderTarget(renderer, snapshot_texture);
-                                
-                                // Read pixels directly into the surface
-                                SDL_Rect rect = { 0, 0, texture_width, texture_height };
-                                if (SDL_RenderReadPixels(renderer, &rect, 
-                                                        surface->format->format, 
-                                                        surface->pixels, 
-                                                        surface->pitch) == 0) {
-                                    // Save the surface as PNG
-                                    if (IMG_SavePNG(surface, filename.c_str()) == 0) {
-                                        // Success - show a message or notification if desired
-                                        std::cout << "Card snapshot saved to " << filename << std::endl;
-                                    } else {
-                                        std::cerr << "Failed to save snapshot: " << IMG_GetError() << std::endl;
-                                    }
+                        // Taken from the next frame's draw data; encoded and written off the UI thread
+                        rouen::helpers::snapshot_service::instance().request((*focused_card)->window_title, filename,
+                            [](std::filesystem::path const& file, bool saved) {
+                                if (saved) {
+                                    std::cout << "Card snapshot saved to " << file.string() << std::endl;
                                 } else {
-                                    std::cerr << "Failed to read pixels from texture: " << SDL_GetError() << std::endl;
+                                    std::cerr << "Failed to save snapshot " << file.string() << std::endl;
                                 }
-                                
-                                // Restore the default render target
-                                SDL_SetRenderTarget(renderer, nullptr);
-                                
-                                // Clean up the surface
-                                SDL_FreeSurface(surface);
-                            }
-                            
-                            // Clean up the texture
-                            SDL_DestroyTexture(snapshot_texture);
-                        }
+                            });
                     }
             }
             
@@ -281,129 +466,112 @@ struct deck {
         }
     }
     
-    // Save current cards to ImGui configuration
-    void save_card_uris() {
-        // Create a string with all card URIs separated by semicolons
-        std::string uris;
-        for (const auto& card : cards_) {
-            if (!uris.empty()) {
-                uris += ";";
-            }
-            uris += card->get_uri();
+    // Queues the layout for the workspace store when a card was opened, closed, moved or resized
+    void save_workspace_if_changed() {
+        workspace_signature_.clear();
+        for (auto const& c : cards_) {
+            workspace_signature_.emplace_back(c.get(), c->width);
         }
-        
-        // Save to a custom section in imgui.ini through a file write
-        // First read the file to preserve other settings
-        std::ifstream ini_file("rouen.ini");
-        std::stringstream buffer;
-        bool found_rouen_section = false;
-        bool in_rouen_section = false;
-
-        if (ini_file) {
-            std::string line;
-            while (std::getline(ini_file, line)) {
-                // Check for rouen section
-                if (line == "[rouen]") {
-                    found_rouen_section = true;
-                    in_rouen_section = true;
-                    buffer << line << std::endl;
-                    buffer << "cards=" << uris << std::endl;
-                    continue;
-                }
-                
-                // Check for new section after rouen
-                if (in_rouen_section && !line.empty() && line[0] == '[') {
-                    in_rouen_section = false;
-                }
-                
-                // Skip card entries in rouen section, keep everything else
-                if (!in_rouen_section || line.substr(0, 6) != "cards=") {
-                    buffer << line << std::endl;
-                }
-            }
-            ini_file.close();
-        }
-        
-        // If rouen section wasn't found, add it
-        if (!found_rouen_section) {
-            buffer << "[rouen]" << std::endl;
-            buffer << "cards=" << uris << std::endl;
+        if (workspace_signature_ != saved_signature_) {
+            save_workspace();
+            std::swap(workspace_signature_, saved_signature_);
         }
-        
-        // Write back to the file
-        std::ofstream out_file("rouen.ini");
-        if (out_file) {
-            out_file << buffer.str();
-            out_file.close();
+    }
+
+    void save_workspace() {
+        std::vector<rouen::helpers::workspace::slot> slots;
+        slots.reserve(cards_.size());
+        for (auto const& c : cards_) {
+            slots.push_back({c->get_uri(), c->width});
         }
+        workspace_->save(slots);
     }
-    
-    // Load cards from ImGui configuration
-    void load_card_uris() {
-        // Read from imgui.ini file
-        std::ifstream ini_file("rouen.ini");
-        if (!ini_file) {
-            // If file doesn't exist, create the default menu card
+
+    // Restores the saved layout, or starts with the menu card
+    void load_workspace() {
+        auto const slots = workspace_->load();
+        if (slots.empty()) {
             create_card("menu", true);
             return;
         }
-        
-        std::string line;
-        bool in_rouen_section = false;
-        std::string uris;
-        
-        while (std::getline(ini_file, line)) {
-            // Check for rouen section
-            if (line == "[rouen]") {
-                in_rouen_section = true;
-                continue;
-            }
-            
-            // Check for new section
-            if (in_rouen_section && !line.empty() && line[0] == '[') {
-                in_rouen_section = false;
-                continue;
+        for (auto const& slot : slots) {
+            // The placeholder holds the card's slot in the first frame; the real card is
+            // built later in the bulk lane, a few per frame, so startup stays responsive
+            auto placeholder = std::make_shared<rouen::cards::placeholder_card>(slot.uri);
+            if (slot.width > 0.0f) {
+                placeholder->width = slot.width;
             }
-            
-            // Look for cards entry in rouen section
-            if (in_rouen_section && line.substr(0, 6) == "cards=") {
-                uris = line.substr(6);
-                break;
+            cards_.emplace_back(placeholder);
+            ++pending_restores_;
+            registrar::get<deferred_operations>("deferred_ops")->queue([this, placeholder] {
+                restore_card(placeholder);
+            }, deferred_operations::lane::bulk);
+        }
+    }
+    
+    // Swap a placeholder for the card it stands for (if the user hasn't closed it meanwhile)
+    void restore_card(card::ptr const& placeholder) {
+        auto slot = std::find(cards_.begin(), cards_.end(), placeholder);
+        if (slot != cards_.end()) {
+            auto const uri = placeholder->get_uri();
+            rouen::helpers::startup_timeline::scope timing{"restore " + uri};
+            rouen::helpers::memory::scope memory_tag{card_memory_tag(uri)};
+            if (auto restored = card_factory().create_card(uri, renderer)) {
+                *slot = std::move(restored);
+            } else {
+                cards_.erase(slot);
             }
         }
-        
-        ini_file.close();
-        
-        // If no saved state, create the default menu card
-        if (uris.empty()) {
-            create_card("menu", true);
+        --pending_restores_;
+    }
+
+    /**
+     * With ROUEN_SNAPSHOT_DIR set, every card is saved there as a PNG every
+     * ROUEN_SNAPSHOT_SECONDS (60 by default), named by its place in the deck and its URI,
+     * for wall displays to show. An SDL timer wakes the otherwise idle main loop.
+     */
+    void start_dashboard_snapshots() {
+        auto const dir = std::getenv("ROUEN_SNAPSHOT_DIR");
+        if (!dir || !*dir) {
             return;
         }
-        
-        // Parse the string and create cards
-        size_t pos = 0;
-        while (pos < uris.length()) {
-            size_t end = uris.find(';', pos);
-            if (end == std::string::npos) {
-                end = uris.length();
-            }
-            
-            std::string uri = uris.substr(pos, end - pos);
-            if (!uri.empty()) {
-                create_card(uri);
-            }
-            
-            pos = end + 1;
+        dashboard_dir_ = dir;
+        auto const seconds_spec = std::getenv("ROUEN_SNAPSHOT_SECONDS");
+        auto const seconds = std::max(1, seconds_spec ? std::atoi(seconds_spec) : 60);
+        dashboard_timer_ = SDL_AddTimer(static_cast<Uint32>(seconds) * 1000, [](Uint32 interval, void* param) -> Uint32 {
+            static_cast<std::atomic<bool>*>(param)->store(true);
+            rouen::helpers::request_redraw();
+            return interval;
+        }, &dashboard_due_);
+        dashboard_due_ = true;  // and one right away
+    }
+
+    // Queues all cards for one capture pass
+    void snapshot_dashboard() {
+        size_t index = 0;
+        for (auto const& c : cards_) {
+            std::string name = c->get_uri();
+            std::replace_if(name.begin(), name.end(), [](unsigned char ch) { return !std::isalnum(ch); }, '_');
+            auto file = dashboard_dir_ / std::format("{:02}-{}.png", index++, name);
+            rouen::helpers::snapshot_service::instance().request(c->window_title, std::move(file));
         }
     }
-    
+
+    [[nodiscard]] size_t card_count() const {
+        return cards_.size();
+    }
+
     struct render_status {
-        int requested_fps {1};
+        int requested_fps {0};  // 0 = nothing is ticking, wait for input or an invalidation
     };
 
     [[nodiscard]] render_status render() {
         render_status result;
+        frame_time_ = activity_clock::now();
         handle_shortcuts();
+        if (dashboard_due_.exchange(false)) {
+            snapshot_dashboard();
+        }
         auto const size {ImGui::GetMainViewport()->Size};
         ImGui::PushStyleColor(ImGuiCol_WindowBg, background_color);
         ImGui::PushStyleColor(ImGuiCol_TitleBg, background_color);
@@ -479,18 +647,28 @@ struct deck {
             ImGui::PopStyleColor();
         }
 
-        // Save card state when a card is added or removed
-        static size_t last_card_count = 0;
-        if (cards_.size() != last_card_count) {
-            save_card_uris();
-            last_card_count = cards_.size();
+        hibernate_idle_cards();
+
+        if (persistent_) {
+            save_workspace_if_changed();
         }
 
         ImGui::PopStyleColor(3);
+        profiler_->end_frame();
+
+        if (!startup_reported_ && pending_restores_ == 0) {
+            startup_reported_ = true;
+            rouen::helpers::startup_timeline::instance().finish();
+        }
         return result;
     }
 
 private:
+    static rouen::cards::factory& card_factory() {
+        static rouen::cards::factory instance;
+        return instance;
+    }
+
     SDL_Renderer* renderer;
     std::vector<std::shared_ptr<card>> cards_;
     ImVec4 background_color;
@@ -498,4 +676,35 @@ private:
     ImVec4 text_color;
     editor editor_;
     float start_x {2.0f};
+    std::shared_ptr<rouen::helpers::frame_profiler> profiler_;
+    bool persistent_ {true};
+    std::unique_ptr<rouen::helpers::workspace> workspace_;     // only when persistent_
+    std::vector<std::pair<card const*, float>> workspace_signature_;   // this frame's cards and widths
+    std::vector<std::pair<card const*, float>> saved_signature_;       // as last saved
+    size_t pending_restores_ {0};       // placeholders still waiting for their card
+    bool startup_reported_ {false};
+
+    using activity_clock = std::chrono::steady_clock;
+    activity_clock::time_point frame_time_;
+    std::unordered_map<card const*, activity_clock::time_point> last_shown_;   // frame each card was last drawn
+    activity_clock::time_point last_hibernation_check_;
+    std::chrono::seconds hibernate_after_ {hibernate_after_from_env()};
+    size_t memory_budget_ {memory_budget_from_env()};
+
+    struct cached_card {
+        rouen::helpers::card_texture_cache texture;
+        bool stale {true};
+    };
+    struct pending_capture {
+        card const* owner;
+        std::string window_title;
+        ImVec2 pos;
+        ImVec2 size;
+    };
+    std::unordered_map<card const*, cached_card> card_cache_;
+    std::vector<pending_capture> pending_captures_;
+    std::filesystem::path dashboard_dir_;
+    std::atomic<bool> dashboard_due_ {false};
+    SDL_TimerID dashboard_timer_ {0};
+    rouen::helpers::memory::report memory_report_ {[this](auto const& emit) { report_memory(emit); }};   // last: goes first
 };
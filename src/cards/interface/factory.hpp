@@ -31,6 +31,10 @@
 #include "../productivity/pomodoro.hpp"
 #include "../system/dbrepair.hpp"
 #include "../system/envvars.hpp"
+#include "../system/logging.hpp"
+#include "../system/memory.hpp"
+#include "../system/net_stats.hpp"
+#include "../system/profiler.hpp"
 #include "../system/subnet_scanner.hpp"
 #include "../system/sysinfo.hpp"
 #include "../system/terminal.hpp"
@@ -110,14 +114,30 @@ namespace rouen::cards {
                     return std::make_shared<grok>();
                 });
                 
-                instance.emplace("radio", [](std::string_view, SDL_Renderer*) {
-                    return std::make_shared<radio>();
+                instance.emplace("radio", [](std::string_view uri, SDL_Renderer*) {
+                    return std::make_shared<radio>(uri);
                 });
                 
                 instance.emplace("envvars", [](std::string_view, SDL_Renderer*) {
                     return std::make_shared<envvars_card>();
                 });
                 
+                instance.emplace("logging", [](std::string_view, SDL_Renderer*) {
+                    return std::make_shared<logging_card>();
+                });
+                
+                instance.emplace("profiler", [](std::string_view, SDL_Renderer*) {
+                    return std::make_shared<profiler_card>();
+                });
+                
+                instance.emplace("memory", [](std::string_view, SDL_Renderer*) {
+                    return std::make_shared<memory_card>();
+                });
+
+                instance.emplace("net-stats", [](std::string_view, SDL_Renderer*) {
+                    return std::make_shared<net_stats_card>();
+                });
+                
                 // Register the new terminal card
                 instance.emplace("terminal", [](std::string_view uri, SDL_Renderer*) {
                     return std::make_shared<terminal>(uri);
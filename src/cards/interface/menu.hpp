@@ -1,12 +1,10 @@
 #pragma once
 
 // 1. Standard includes in alphabetic order
-#include <algorithm>
-#include <cctype>
 #include <filesystem>
-#include <format>
-#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 // 2. Libraries used in the project, in alphabetic order
@@ -14,12 +12,15 @@
 #include <SDL.h>
 
 // 3. All other includes
-#include "../../helpers/string_helper.hpp"
+#include "../../helpers/launcher_index.hpp"
 #include "../../registrar.hpp"
 #include "card.hpp"
 
 namespace rouen::cards {
     struct menu: public card {
+        // Most results listed for a query; the list only draws the rows in view
+        static constexpr size_t max_results = 500;
+
         menu() {
             colors[0] = {0.37f, 0.53f, 0.71f, 1.0f}; // Blue accent color for primary elements
             colors[1] = {0.251f, 0.878f, 0.816f, 0.7f}; // Turquoise for secondary elements
@@ -32,6 +33,16 @@ namespace rouen::cards {
             
             name("Application Menu");
             width = 320.0f; // Slightly wider for better menu display
+
+            // The cards below are one source of the launcher's index; the other sources publish their own
+            index_ = rouen::helpers::launcher_index::shared();
+            if (index_) {
+                std::vector<rouen::helpers::launch_target> targets;
+                for (auto const& category : categories()) {
+                    targets.insert(targets.end(), category.items.begin(), category.items.end());
+                }
+                index_->publish("cards", std::move(targets));
+            }
         }
 
         std::string get_uri() const override {
@@ -40,64 +51,6 @@ namespace rouen::cards {
         
         bool render() override {
             return render_window([this]() {
-                // Define menu categories
-                struct MenuCategory {
-                    std::string name;
-                    std::vector<std::pair<std::string, std::function<void()>>> items;
-                };
-                
-                static std::vector<MenuCategory> menu_categories = {
-                    { "Development", {
-                        {"Git", []() { "create_card"_sfn("git"); }},
-                        {"GitHub", []() { "create_card"_sfn("github"); }},
-                        {"CMake", []() { "create_card"_sfn("cmake:" + std::filesystem::current_path().string() + "/CMakeLists.txt"); }},
-                        {"Root Directory", []() { "create_card"_sfn("dir:/"); }},
-                        {"Home Directory", []() { "create_card"_sfn("dir:$HOME"); }}
-                    }},
-                    { "Productivity", {
-                        {"Pomodoro", []() { "create_card"_sfn("pomodoro"); }},
-                        {"Alarm", []() { "create_card"_sfn("alarm"); }},
-                        {"Jira", []() { "create_card"_sfn("jira"); }},
-                        {"Jira Projects", []() { "create_card"_sfn("jira-projects"); }},
-                        {"Jira Search", []() { "create_card"_sfn("jira-search"); }},
-                    }},
-                    { "Information", {
-                        {"Calendar", []() { "create_card"_sfn("calendar"); }},
-                        {"Grok AI Chat", []() { "create_card"_sfn("grok"); }},
-                        {"Podcasts and News", []() { "create_card"_sfn("rss"); }},
-                        {"Travel Plans", []() { "create_card"_sfn("travel"); }},
-                        {"Weather & Time", []() { "create_card"_sfn("weather"); }},
-                        {"Email", []() { "create_card"_sfn("mail"); }}
-                    }},
-                    { "Media", {
-                        {"Radio", []() { "create_card"_sfn("radio"); }},
-                        {"Chess Replay", []() { "create_card"_sfn("chess"); }}
-                    }},
-                    { "System", {
-                        {"System Info", []() { "create_card"_sfn("sysinfo"); }},
-                        {"Terminal", []() { "create_card"_sfn("terminal"); }},
-                        {"Environment Variables", []() { "create_card"_sfn("envvars"); }},
-                        {"Subnet Scanner", []() { "create_card"_sfn("subnet-scanner"); }},
-                        {"Database Repair", []() { "create_card"_sfn("dbrepair"); }},
-                        {"Exit Application", []() { [[maybe_unused]] bool was_exiting = "exit"_fnb(); }} // Fixed: Use [[maybe_unused]] to suppress nodiscard warning
-                    }}
-                };
-                
-                // Flatten menu items for search
-                static std::vector<std::tuple<int, int, std::string>> all_menu_items;
-                if (all_menu_items.empty()) {
-                    for (size_t cat_idx = 0; cat_idx < menu_categories.size(); cat_idx++) {
-                        for (size_t item_idx = 0; item_idx < menu_categories[cat_idx].items.size(); item_idx++) {
-                            all_menu_items.push_back(std::make_tuple(
-                                cat_idx, item_idx, menu_categories[cat_idx].items[item_idx].first
-                            ));
-                        }
-                    }
-                }
-                
-                // Search filter implementation
-                static char search_buffer[256] = "";
-                static int selected_index = 0;
                 bool enter_pressed = false;
                 
                 // Command palette style input box at the top
@@ -114,17 +67,17 @@ namespace rouen::cards {
                 
                 // Input with placeholder text
                 ImGuiInputTextFlags input_flags = ImGuiInputTextFlags_EnterReturnsTrue;
-                if (ImGui::InputText("##search", search_buffer, IM_ARRAYSIZE(search_buffer), input_flags)) {
+                if (ImGui::InputText("##search", search_buffer_, IM_ARRAYSIZE(search_buffer_), input_flags)) {
                     enter_pressed = true;
                 }
                 
                 // Show placeholder when empty
-                if (search_buffer[0] == '\0' && !ImGui::IsItemActive()) {
+                if (search_buffer_[0] == '\0' && !ImGui::IsItemActive()) {
                     auto pos = ImGui::GetItemRectMin();
                     ImGui::GetWindowDrawList()->AddText(
                         ImVec2(pos.x + 5, pos.y + 2), 
                         ImGui::GetColorU32(ImGuiCol_TextDisabled), 
-                        "Search applications... (Type to filter)"
+                        "Search cards, repos, feeds, stations..."
                     );
                 }
                 ImGui::PopItemWidth();
@@ -132,18 +85,11 @@ namespace rouen::cards {
                 
                 ImGui::Separator();
                 
-                // Filter items based on search text
-                std::string search_text = search_buffer;
-                
-                // Create a vector of filtered items
-                std::vector<std::tuple<int, int, std::string>> filtered_items;
-                if (search_text.empty()) {
+                if (search_buffer_[0] == '\0') {
                     // Display categorized menu when no search text
                     ImGui::BeginChild("MenuCategories", ImVec2(0, 0), false);
                     
-                    for (size_t cat_idx = 0; cat_idx < menu_categories.size(); cat_idx++) {
-                        const auto& category = menu_categories[cat_idx];
-                        
+                    for (auto const& category : categories()) {
                         // Category header
                         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.8f, 0.8f, 1.0f, 1.0f));
                         ImGui::TextUnformatted(category.name.c_str());
@@ -151,15 +97,13 @@ namespace rouen::cards {
                         ImGui::Separator();
                         
                         // Category items
-                        for (size_t item_idx = 0; item_idx < category.items.size(); item_idx++) {
-                            const auto& item = category.items[item_idx];
-                            
+                        for (auto const& item : category.items) {
                             ImGui::PushStyleColor(ImGuiCol_Header, colors[2]);
                             ImGui::PushStyleColor(ImGuiCol_HeaderHovered, colors[3]);
                             ImGui::PushStyleColor(ImGuiCol_HeaderActive, colors[4]);
                             
-                            if (ImGui::Selectable(item.first.c_str(), false)) {
-                                item.second();
+                            if (ImGui::Selectable(item.label.c_str(), false)) {
+                                launch(item.uri);
                             }
                             
                             ImGui::PopStyleColor(3);
@@ -171,69 +115,166 @@ namespace rouen::cards {
                     }
                     
                     ImGui::EndChild();
-                } else {
-                    // Filter and display search results
-                    for (const auto& [cat_idx, item_idx, item_text] : all_menu_items) {
-                        if (::helpers::StringHelper::contains_case_insensitive(item_text, search_text)) {
-                            filtered_items.push_back(std::make_tuple(cat_idx, item_idx, item_text));
-                        }
+                    return;
+                }
+
+                // Ranked again only when the query or the index changed
+                refresh_results();
+                
+                // Handle keyboard navigation
+                bool scroll_to_selected = false;
+                if (ImGui::IsWindowFocused() && !results_.empty()) {
+                    if (ImGui::IsKeyPressed(ImGuiKey_DownArrow)) {
+                        selected_index_ = (selected_index_ + 1) % results_.size();
+                        scroll_to_selected = true;
                     }
-                    
-                    // Handle keyboard navigation
-                    if (ImGui::IsWindowFocused()) {
-                        if (ImGui::IsKeyPressed(ImGuiKey_DownArrow) && !filtered_items.empty()) {
-                            selected_index = static_cast<int>((static_cast<size_t>(selected_index) + 1) % filtered_items.size());
-                        }
-                        else if (ImGui::IsKeyPressed(ImGuiKey_UpArrow) && !filtered_items.empty()) {
-                            selected_index = static_cast<int>((static_cast<size_t>(selected_index) + filtered_items.size() - 1) % filtered_items.size());
-                        }
-                        
-                        // Execute the selected command on Enter key
-                        if (enter_pressed && !filtered_items.empty()) {
-                            if (selected_index >= 0 && static_cast<size_t>(selected_index) < filtered_items.size()) {
-                                auto [cat_idx, item_idx, _] = filtered_items[static_cast<size_t>(selected_index)];
-                                menu_categories[static_cast<size_t>(cat_idx)].items[static_cast<size_t>(item_idx)].second();
-                                // also clear the filter
-                                search_buffer[0] = '\0';
-                            }
-                        }
+                    else if (ImGui::IsKeyPressed(ImGuiKey_UpArrow)) {
+                        selected_index_ = (selected_index_ + results_.size() - 1) % results_.size();
+                        scroll_to_selected = true;
                     }
                     
-                    // Display search results
-                    ImGui::BeginChild("SearchResults", ImVec2(0, 0), false);
-                    
-                    // If no items match the filter, show a message
-                    if (filtered_items.empty()) {
-                        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "%s", "No applications match your search");
-                    } 
-                    else {
-                        // Render filtered items
-                        for (size_t i = 0; i < filtered_items.size(); i++) {
-                            auto [cat_idx, item_idx, item_text] = filtered_items[i];
-                            
-                            // Set selection color for the currently selected item
-                            bool is_selected = (static_cast<int>(i) == selected_index);
+                    // Execute the selected command on Enter key
+                    if (enter_pressed) {
+                        launch((*shown_entries_)[results_[selected_index_].entry].target.uri);
+                        // also clear the filter
+                        search_buffer_[0] = '\0';
+                        return;
+                    }
+                }
+                
+                // Display search results
+                ImGui::BeginChild("SearchResults", ImVec2(0, 0), false);
+                
+                // If no items match the filter, show a message
+                if (results_.empty()) {
+                    ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "%s", "Nothing matches your search");
+                } 
+                else {
+                    ImGuiListClipper clipper;
+                    clipper.Begin(static_cast<int>(results_.size()));
+                    if (scroll_to_selected) {
+                        clipper.IncludeItemByIndex(static_cast<int>(selected_index_));
+                    }
+                    while (clipper.Step()) {
+                        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                            auto const i = static_cast<size_t>(row);
+                            auto const& e = (*shown_entries_)[results_[i].entry];
+                            bool const is_selected = i == selected_index_;
                             
+                            ImGui::PushID(row);
                             ImGui::PushStyleColor(ImGuiCol_Header, colors[2]);
                             ImGui::PushStyleColor(ImGuiCol_HeaderHovered, colors[3]);
                             ImGui::PushStyleColor(ImGuiCol_HeaderActive, colors[4]);
                             
-                            if (ImGui::Selectable(item_text.c_str(), is_selected)) {
-                                menu_categories[static_cast<size_t>(cat_idx)].items[static_cast<size_t>(item_idx)].second();
+                            if (ImGui::Selectable(e.target.label.c_str(), is_selected)) {
+                                launch(e.target.uri);
                             }
                             
-                            // Make the selected item visible - auto-scroll to it
-                            if (is_selected) {
-                                ImGui::SetItemDefaultFocus();
+                            // Keep the row moved to with the arrows in view
+                            if (is_selected && scroll_to_selected) {
+                                ImGui::SetScrollHereY();
                             }
                             
                             ImGui::PopStyleColor(3);
+
+                            // Where the target comes from, to tell apart equal labels
+                            ImGui::SameLine(ImGui::GetContentRegionAvail().x - ImGui::CalcTextSize(e.source.c_str()).x);
+                            ImGui::TextDisabled("%s", e.source.c_str());
+                            ImGui::PopID();
                         }
                     }
-                    
-                    ImGui::EndChild();
                 }
+                
+                ImGui::EndChild();
             });
         }
+
+    private:
+        struct menu_category {
+            std::string name;
+            std::vector<rouen::helpers::launch_target> items;
+        };
+
+        static std::vector<menu_category> const& categories() {
+            static std::vector<menu_category> const menu_categories = {
+                { "Development", {
+                    {"Git", "git"},
+                    {"GitHub", "github"},
+                    {"CMake", "cmake:" + std::filesystem::current_path().string() + "/CMakeLists.txt"},
+                    {"Root Directory", "dir:/"},
+                    {"Home Directory", "dir:$HOME"}
+                }},
+                { "Productivity", {
+                    {"Pomodoro", "pomodoro"},
+                    {"Alarm", "alarm"},
+                    {"Jira", "jira"},
+                    {"Jira Projects", "jira-projects"},
+                    {"Jira Search", "jira-search"},
+                }},
+                { "Information", {
+                    {"Calendar", "calendar"},
+                    {"Grok AI Chat", "grok"},
+                    {"Podcasts and News", "rss"},
+                    {"Travel Plans", "travel"},
+                    {"Weather & Time", "weather"},
+                    {"Email", "mail"}
+                }},
+                { "Media", {
+                    {"Radio", "radio"},
+                    {"Chess Replay", "chess"}
+                }},
+                { "System", {
+                    {"System Info", "sysinfo"},
+                    {"Terminal", "terminal"},
+                    {"Environment Variables", "envvars"},
+                    {"Subnet Scanner", "subnet-scanner"},
+                    {"Database Repair", "dbrepair"},
+                    {"Frame Profiler", "profiler"},
+                    {"Memory", "memory"},
+                    {"Network Stats", "net-stats"},
+                    {"Logging", "logging"},
+                    {"Exit Application", exit_uri}
+                }}
+            };
+            return menu_categories;
+        }
+
+        // Not a card: the one target that quits instead
+        static constexpr char const* exit_uri = "exit";
+
+        static void launch(std::string const& uri) {
+            if (uri == exit_uri) {
+                [[maybe_unused]] bool was_exiting = "exit"_fnb();
+            } else {
+                "create_card"_sfn(uri);
+            }
+        }
+
+        void refresh_results() {
+            auto entries = index_ ? index_->entries() : nullptr;
+            std::string_view const query {search_buffer_};
+            if (entries == shown_entries_ && query == shown_query_) {
+                return;
+            }
+            if (query != shown_query_) {
+                selected_index_ = 0;
+            }
+            shown_entries_ = std::move(entries);
+            shown_query_ = query;
+            results_.clear();
+            if (shown_entries_) {
+                results_ = rouen::helpers::launcher_index::rank(*shown_entries_, query, max_results);
+            }
+            if (selected_index_ >= results_.size()) {
+                selected_index_ = 0;
+            }
+        }
+
+        std::shared_ptr<rouen::helpers::launcher_index> index_;
+        char search_buffer_[256] {};
+        std::string shown_query_;
+        std::shared_ptr<rouen::helpers::launcher_index::snapshot const> shown_entries_;
+        std::vector<rouen::helpers::launcher_index::match> results_;
+        size_t selected_index_ {0};
     };
 }
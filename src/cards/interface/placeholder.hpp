@@ -0,0 +1,40 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <string>
+#include <string_view>
+
+// 2. Libraries used in the project, in alphabetic order
+#include "../../helpers/imgui_include.hpp"
+
+// 3. All other includes
+#include "card.hpp"
+
+namespace rouen::cards {
+
+// Stands in for a restored card until the deck has built it, so the first frame
+// shows the saved layout straight away. Keeps the real card's URI for the saved workspace.
+struct placeholder_card : public card {
+    explicit placeholder_card(std::string_view uri) : uri_(uri) {
+        colors[0] = {0.35f, 0.35f, 0.35f, 1.0f};  // Neutral gray primary color (first_color)
+        colors[1] = {0.45f, 0.45f, 0.45f, 0.5f};  // Light gray secondary color (second_color)
+
+        name(uri_);
+        requested_fps = 0;  // the deck replaces it; nothing to animate meanwhile
+    }
+
+    bool render() override {
+        return render_window([]() {
+            ImGui::TextDisabled("Loading...");
+        });
+    }
+
+    std::string get_uri() const override {
+        return uri_;
+    }
+
+private:
+    std::string uri_;
+};
+
+} // namespace rouen::cards
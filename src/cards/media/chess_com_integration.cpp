@@ -1,6 +1,9 @@
 #include "chess_com_integration.hpp"
 #include <imgui.h>
 #include <algorithm>
+#include "../../helpers/task_scheduler.hpp"
+#include "../../models/chess/pgn_reader.hpp"
+#include "../../models/chess/position_index.hpp"
 
 namespace rouen::cards {
 
@@ -19,11 +22,17 @@ void ChessComIntegration::render_ui(ImVec4 info_color, ImVec4 error_color, std::
         state_.from_chess_com = true;
     }
     ImGui::SameLine();
+    if (ImGui::Button("All Games")) {
+        import_all_games(state_.username_buffer);
+        state_.chess_com_username = state_.username_buffer;
+        state_.from_chess_com = true;
+    }
+    ImGui::SameLine();
     ImGui::TextDisabled("(?)");
     if (ImGui::IsItemHovered()) {
-        ImGui::SetTooltip("Enter a Chess.com username and click Search to find their games");
+        ImGui::SetTooltip("Enter a Chess.com username and click Search to find their games by month, or All Games to load every month at once");
     }
-    if (state_.is_fetching_archives || state_.is_fetching_games) {
+    if (state_.is_fetching_archives || state_.is_fetching_games || state_.is_importing) {
         ImGui::SameLine();
         ImGui::Text("Loading...");
     }
@@ -45,21 +54,28 @@ void ChessComIntegration::render_ui(ImVec4 info_color, ImVec4 error_color, std::
             }
             ImGui::EndCombo();
         }
-        if (!state_.archive_games.empty()) {
-            ImGui::SetNextItemWidth(500.0f);
-            if (ImGui::BeginCombo("##GamesList", state_.selected_game_index < 0 ? "Select Game" : api_.format_game_display(state_.archive_games[static_cast<size_t>(state_.selected_game_index)]).c_str())) {
-                for (size_t i = 0; i < state_.archive_games.size(); ++i) {
-                    const auto& chess_game_item = state_.archive_games[i];
+    }
+    if (!state_.archive_games.empty()) {
+        ImGui::SetNextItemWidth(500.0f);
+        if (ImGui::BeginCombo("##GamesList", state_.selected_game_index < 0 ? "Select Game" : api_.format_game_display(state_.archive_games[static_cast<size_t>(state_.selected_game_index)]).c_str())) {
+            // All of a player's games can be thousands: only the visible ones are formatted
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(state_.archive_games.size()));
+            while (clipper.Step()) {
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                    const auto& chess_game_item = state_.archive_games[static_cast<size_t>(i)];
                     std::string game_display = api_.format_game_display(chess_game_item);
-                    bool is_selected = (state_.selected_game_index == static_cast<int>(i));
+                    bool is_selected = (state_.selected_game_index == i);
+                    ImGui::PushID(i);
                     if (ImGui::Selectable(game_display.c_str(), is_selected)) {
-                        state_.selected_game_index = static_cast<int>(i);
+                        state_.selected_game_index = i;
                         if (on_game_selected) on_game_selected();
                     }
+                    ImGui::PopID();
                     if (is_selected) ImGui::SetItemDefaultFocus();
                 }
-                ImGui::EndCombo();
             }
+            ImGui::EndCombo();
         }
     }
 }
@@ -86,6 +102,48 @@ void ChessComIntegration::fetch_archive_games(const std::string& archive_url) {
     state_.games_future = api_.fetch_archive_games(archive_url);
 }
 
+void ChessComIntegration::import_all_games(const std::string& username) {
+    if (username.empty()) {
+        state_.api_error = "Please enter a username";
+        return;
+    }
+    state_.archive_games.clear();
+    state_.selected_archive.clear();
+    state_.selected_game_index = -1;
+    state_.api_error.clear();
+    state_.is_importing = true;
+    state_.import_future = api_.import_all_games(username);
+}
+
+void ChessComIntegration::index_positions(const std::vector<rouen::chess::ChessGameArchive>& games) {
+    std::vector<std::pair<std::string, std::string>> pending;
+    for (const auto& g : games) {
+        if (!g.url.empty() && !g.pgn.empty()) {
+            pending.emplace_back(g.url, g.pgn);
+        }
+    }
+    if (pending.empty()) {
+        return;
+    }
+    helpers::scheduler()->submit([pending = std::move(pending)](std::stop_token stop) {
+        auto& index = models::chess::PositionIndex::instance();
+        for (const auto& [url, pgn] : pending) {
+            if (stop.stop_requested()) {
+                return;
+            }
+            // Games already indexed are not replayed again
+            if (index.contains(url)) {
+                continue;
+            }
+            auto view = models::chess::PgnReader{pgn}.next();
+            models::chess::Game game;
+            if (view && game.load_from_view(*view)) {
+                index.add(url, game);
+            }
+        }
+    }, helpers::task_priority::background);
+}
+
 void ChessComIntegration::process_api_responses() {
     if (state_.is_fetching_archives && state_.archives_future.valid()) {
         auto status = state_.archives_future.wait_for(std::chrono::seconds(0));
@@ -100,6 +158,15 @@ void ChessComIntegration::process_api_responses() {
             }
         }
     }
+    if (state_.is_importing && state_.import_future.valid()) {
+        if (state_.import_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            auto imported = state_.import_future.get();
+            state_.is_importing = false;
+            state_.archive_games = std::move(imported.games);
+            state_.api_error = std::move(imported.error);
+            index_positions(state_.archive_games);
+        }
+    }
     if (state_.is_fetching_games && state_.games_future.valid()) {
         auto status = state_.games_future.wait_for(std::chrono::seconds(0));
         if (status == std::future_status::ready) {
@@ -108,6 +175,7 @@ void ChessComIntegration::process_api_responses() {
             if (success) {
                 bool parsed = api_.process_games_response(result, state_.archive_games);
                 if (!parsed) state_.api_error = "Error parsing games response";
+                else index_positions(state_.archive_games);
             } else {
                 state_.api_error = result;
             }
@@ -131,4 +199,8 @@ bool ChessComIntegration::has_selected_game() const {
     return state_.selected_game_index >= 0 && static_cast<size_t>(state_.selected_game_index) < state_.archive_games.size();
 }
 
+bool ChessComIntegration::busy() const {
+    return state_.is_fetching_archives || state_.is_fetching_games || state_.is_importing;
+}
+
 } // namespace rouen::cards
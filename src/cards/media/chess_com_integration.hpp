@@ -15,12 +15,14 @@ struct ChessComIntegrationState {
     int selected_game_index = -1;
     bool is_fetching_archives = false;
     bool is_fetching_games = false;
+    bool is_importing = false;
     std::string api_error;
     bool auto_search_on_render = false;
     bool from_chess_com = false;
     std::string chess_com_username;
     std::future<std::pair<bool, std::string>> archives_future;
     std::future<std::pair<bool, std::string>> games_future;
+    std::future<rouen::chess::ChessComImport> import_future;
 };
 
 class ChessComIntegration {
@@ -31,12 +33,18 @@ public:
     void render_ui(ImVec4 info_color, ImVec4 error_color, std::function<void()> on_game_selected);
     void fetch_player_archives(const std::string& username);
     void fetch_archive_games(const std::string& archive_url);
+    void import_all_games(const std::string& username);
     void process_api_responses();
     std::string get_selected_pgn() const;
     std::string get_selected_game_display() const;
     bool has_selected_game() const;
+    // A request to Chess.com is still out; its answer is picked up by process_api_responses()
+    bool busy() const;
     // ... add more as needed ...
 private:
+    // Adds games to the position index, on a worker
+    static void index_positions(const std::vector<rouen::chess::ChessGameArchive>& games);
+
     ChessComIntegrationState& state_;
     rouen::chess::ChessComApiClient& api_;
 };
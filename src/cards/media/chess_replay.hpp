@@ -10,6 +10,8 @@
 #include <filesystem>
 #include <algorithm>
 #include <map>
+#include <atomic>
+#include <optional>
 #include <glaze/json.hpp>
 
 #include "../../helpers/imgui_include.hpp"
@@ -18,8 +20,14 @@
 
 #include "../interface/card.hpp"
 #include "../../models/chess/chess.hpp"
+#include "../../models/chess/pgn_reader.hpp"
+#include "../../models/chess/position_index.hpp"
 #include "../../helpers/debug.hpp"  // Include debug system for better logging
+#include "../../helpers/texture_atlas.hpp"
 #include "../../helpers/texture_helper.hpp"
+#include "../../helpers/redraw.hpp"
+#include "../../helpers/task_scheduler.hpp"
+#include "../../helpers/uci_engine.hpp"
 #include "../../helpers/chess_com_api.hpp"  // New dedicated helper for Chess.com API
 #include "../../registrar.hpp"
 #include "../../fonts.hpp"  // For font utilities
@@ -51,7 +59,7 @@ public:
         get_color(9, ImVec4(0.3f, 0.3f, 0.8f, 1.0f)); // Info color for Chess.com
         
         name("Chess Replay");
-        requested_fps = 30;  // Higher refresh rate for smoother animations
+        requested_fps = 0;   // Raised only while autoplaying or waiting on Chess.com (see render)
         width = 700.0f;      // Wider card to accommodate board and move list
         
         // Try to get the SDL renderer from the registrar
@@ -77,12 +85,12 @@ public:
     }
     
     ~chess_replay() override {
-        // Clean up textures
-        for (auto& [piece, texture] : piece_textures) {
-            if (texture) {
-                SDL_DestroyTexture(texture);
-                texture = nullptr;
-            }
+        collection_stop.request_stop();
+        analysis_stop.request_stop();
+        
+        // Clean up the textures made for pieces the atlas had no room for
+        for (auto texture : own_textures) {
+            SDL_DestroyTexture(texture);
         }
         
         CHESS_INFO("Chess replay card destroyed");
@@ -107,6 +115,9 @@ public:
             // Chess.com UI
             chess_com_integration.render_ui(colors[9], colors[8], [this](){ load_selected_game(); });
             
+            // Games of a local collection
+            render_collection_games();
+            
             // Calculate board size based on card width
             float board_size = std::min(width - 40.0f, 400.0f);
             float square_size = board_size / 8.0f;
@@ -127,23 +138,37 @@ public:
             render_controls();
             ImGui::Separator();
             render_move_list();
+            ImGui::Separator();
+            render_position_stats();
+            ImGui::Separator();
+            render_engine();
             
             // Reset column layout
             ImGui::Columns(1);
             
             // Process any pending API responses
             chess_com_integration.process_api_responses();
+            
+            // Autoplay steps and Chess.com answers are checked for once a frame
+            requested_fps = autoplay || chess_com_integration.busy() ? 10 : 0;
         });
     }
     
-    // Load a PGN file
+    // Load a PGN file: its first game at once, the rest listed as the file is indexed
     bool load_pgn(const std::string& filepath) {
         if (!game) {
             CHESS_ERROR("Chess game model not initialized");
             return false;
         }
         
-        bool success = game->load_from_pgn_file(filepath);
+        auto file = models::chess::PgnFile::open(filepath);
+        if (!file) {
+            CHESS_ERROR_FMT("Failed to open PGN file: {}", filepath);
+            return false;
+        }
+        auto first = models::chess::PgnReader{file->text()}.next();
+        bool success = first && game->load_from_view(*first);
+        game_loaded();
         if (success) {
             CHESS_INFO_FMT("Successfully loaded PGN file: {}", filepath);
             loaded_pgn_path = filepath;
@@ -151,9 +176,51 @@ public:
             CHESS_ERROR_FMT("Failed to load PGN file: {}", filepath);
         }
         
+        collection_stop.request_stop();
+        collection_stop = {};
+        collection = std::make_shared<models::chess::PgnCollection>(std::move(file));
+        collection_game = 0;
+        helpers::scheduler()->submit([collection = collection](std::stop_token stop) {
+            collection->index(stop);
+            helpers::request_redraw();
+        }, helpers::task_priority::background, collection_stop);
+        
         return success;
     }
     
+    // The list of a collection's games, when the file has more than one
+    void render_collection_games() {
+        if (!collection || collection->size() < 2) {
+            return;
+        }
+        auto const count = collection->size();
+        auto const label = std::format("Game {} of {}{}", collection_game + 1, count, collection->indexed() ? "" : "+");
+        ImGui::SetNextItemWidth(500.0f);
+        if (ImGui::BeginCombo("##CollectionGames", label.c_str())) {
+            // Only the games on screen are read, from the mapped file
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(count));
+            while (clipper.Step()) {
+                for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                    auto const view = collection->game(static_cast<size_t>(i));
+                    if (!view) {
+                        continue;
+                    }
+                    auto const display = std::format("{}. {} - {}  {}  {}", i + 1, view->tag("White"), view->tag("Black"),
+                                                     view->tag("Result"), view->tag("Date"));
+                    ImGui::PushID(i);
+                    if (ImGui::Selectable(display.c_str(), static_cast<size_t>(i) == collection_game)) {
+                        collection_game = static_cast<size_t>(i);
+                        game->load_from_view(*view);
+                        game_loaded();
+                    }
+                    ImGui::PopID();
+                }
+            }
+            ImGui::EndCombo();
+        }
+    }
+    
     // Load PGN from string content
     bool load_pgn_content(const std::string& pgn_content) {
         if (!game) {
@@ -162,6 +229,7 @@ public:
         }
         
         bool success = game->load_from_pgn(pgn_content);
+        game_loaded();
         if (success) {
             CHESS_INFO("Successfully loaded PGN from content");
         } else {
@@ -234,12 +302,23 @@ public:
             // Create the full path to the image file
             std::filesystem::path full_path = app_path / file_path;
             
-            int width, height;
-            SDL_Texture* texture = TextureHelper::loadTextureFromFile(renderer, full_path.string().c_str(), width, height);
+            // All twelve share one atlas page, so the board binds a single texture
+            std::shared_ptr<helpers::texture_atlas::region> image;
+            if (SDL_Surface* surface = IMG_Load(full_path.string().c_str()); surface) {
+                image = helpers::texture_atlas::instance().add(renderer, surface);
+                if (!image) {
+                    if (SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface); texture) {
+                        own_textures.push_back(texture);
+                        image = std::make_shared<helpers::texture_atlas::region>(helpers::texture_atlas::region{
+                            reinterpret_cast<ImTextureID>(texture), ImVec2{0.0f, 0.0f}, ImVec2{1.0f, 1.0f}, surface->w, surface->h});
+                    }
+                }
+                SDL_FreeSurface(surface);
+            }
             
-            if (texture) {
-                piece_textures[piece] = texture;
-                piece_dimensions[piece] = std::make_pair(width, height);
+            if (image) {
+                piece_textures[piece] = image;
+                piece_dimensions[piece] = std::make_pair(image->width, image->height);
                 success_count++;
                 CHESS_INFO_FMT("Loaded chess piece texture: {}", file_path);
             } else {
@@ -311,8 +390,8 @@ public:
                 models::chess::Piece piece = board_array[static_cast<std::size_t>(rank) * 8 + static_cast<std::size_t>(file)];
                 if (piece != models::chess::Piece::None) {
                     // Draw piece using image texture if available
-                    if (renderer && textures_loaded && piece_textures.count(piece) > 0 && piece_textures[piece] != nullptr) {
-                        SDL_Texture* texture = piece_textures[piece];
+                    if (renderer && textures_loaded && piece_textures.count(piece) > 0 && piece_textures[piece]->texture) {
+                        auto const& image = *piece_textures[piece];
                         auto [tex_width, tex_height] = piece_dimensions[piece];
                         
                         // Calculate scaling to fit the square
@@ -336,9 +415,11 @@ public:
                         
                         // Draw the texture
                         draw_list->AddImage(
-                            (ImTextureID)(intptr_t)texture,
+                            image.texture,
                             piece_pos,
-                            ImVec2(piece_pos.x + piece_width, piece_pos.y + piece_height)
+                            ImVec2(piece_pos.x + piece_width, piece_pos.y + piece_height),
+                            image.uv0,
+                            image.uv1
                         );
                     } else {
                         // Fallback to a colored rectangle if image not available
@@ -520,13 +601,213 @@ public:
         ImGui::EndChild();
     }
     
+    // What was played from the current position in the indexed games
+    void render_position_stats() {
+        if (!game) return;
+
+        auto& index = models::chess::PositionIndex::instance();
+        bool const white_to_move = game->get_current_move_index() % 2 == 0;
+        auto const hash = models::chess::zobrist::hash(game->get_current_position(), white_to_move);
+        // Read again only when the position changes or more games have been indexed
+        if (hash != stats_hash || index.generation() != stats_generation) {
+            stats_hash = hash;
+            stats_generation = index.generation();
+            position_stats = index.moves_from(game->get_current_position(), white_to_move);
+        }
+
+        ImGui::TextColored(colors[0], "Position Statistics:");
+        if (position_stats.empty()) {
+            ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Not reached in imported games");
+            return;
+        }
+        if (ImGui::BeginTable("PositionStats", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 150))) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Move");
+            ImGui::TableSetupColumn("Games");
+            ImGui::TableSetupColumn("White");
+            ImGui::TableSetupColumn("Draw");
+            ImGui::TableSetupColumn("Black");
+            ImGui::TableHeadersRow();
+            for (const auto& s : position_stats) {
+                auto const percent = [&s](int n) { return 100.0f * static_cast<float>(n) / static_cast<float>(s.games); };
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(s.move.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", s.games);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f%%", percent(s.white_wins));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f%%", percent(s.draws));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f%%", percent(s.black_wins));
+            }
+            ImGui::EndTable();
+        }
+    }
+    
+    // Engine lines for the current position, and the evaluation of the whole game once analyzed
+    void render_engine() {
+        if (!game) return;
+
+        if (ImGui::Checkbox("Engine", &engine_on)) {
+            engine.reset();
+            engine_hash = 0;
+            if (engine_on) {
+                engine = std::make_unique<chess::UciEngine>();
+            }
+        }
+        ImGui::SameLine();
+        if (analysis_progress) {
+            auto const done = analysis_progress->load();
+            ImGui::ProgressBar(static_cast<float>(done) / static_cast<float>(std::max<size_t>(analysis_total, 1)), ImVec2(150, 0),
+                               std::format("{}/{}", done, analysis_total).c_str());
+            ImGui::SameLine();
+            if (ImGui::Button("Stop")) {
+                analysis_stop.request_stop();
+            }
+            if (done != curve_progress) {
+                curve_progress = done;
+                read_eval_curve();
+            }
+            if (done >= analysis_total) {
+                analysis_progress.reset();
+            }
+        } else if (ImGui::Button("Analyze game")) {
+            analyze_game();
+        }
+
+        if (!eval_curve.empty()) {
+            ImGui::PlotLines("##EvalCurve", eval_curve.data(), static_cast<int>(eval_curve.size()), 0, "White's advantage (pawns)",
+                             -8.0f, 8.0f, ImVec2(0, 60));
+        }
+
+        bool const white_to_move = game->get_current_move_index() % 2 == 0;
+        auto const hash = models::chess::zobrist::hash(game->get_current_position(), white_to_move);
+        if (!engine) {
+            // The cache answers without an engine running
+            if (hash != engine_hash) {
+                engine_hash = hash;
+                cached_eval = chess::EngineEvalCache::instance().get(hash);
+            }
+            if (cached_eval) {
+                render_engine_line(*cached_eval);
+            }
+            return;
+        }
+        if (!engine->running()) {
+            ImGui::TextColored(colors[8], "Engine: %s", engine->error().c_str());
+            return;
+        }
+        if (hash != engine_hash) {
+            engine_hash = hash;
+            engine->analyze(hash, uci_moves(game->get_current_move_index()), white_to_move);
+        }
+        for (const auto& line : engine->current().lines) {
+            render_engine_line(line);
+        }
+    }
+
+    void render_engine_line(const chess::EngineLine& line) {
+        auto const score = line.mate ? std::format("#{}", *line.mate) : std::format("{:+.2f}", line.centipawns.value_or(0) / 100.0);
+        // The first few moves are enough to read the idea
+        std::string_view pv {line.pv};
+        size_t end = 0;
+        for (int moves = 0; moves < 8 && end != std::string_view::npos; ++moves) {
+            end = pv.find(' ', end + 1);
+        }
+        auto const shown = end == std::string_view::npos ? pv : pv.substr(0, end);
+        ImGui::Text("%6s  d%-2d  %.*s", score.c_str(), line.depth, static_cast<int>(shown.size()), shown.data());
+    }
+
+    // The first `count` moves of the game, as "position startpos moves" takes them
+    std::string uci_moves(size_t count) const {
+        std::string text;
+        const auto& moves = game->get_moves();
+        for (size_t i = 0; i < std::min(count, moves.size()); ++i) {
+            if (i > 0) text += ' ';
+            text += moves[i].uci();
+        }
+        return text;
+    }
+
+    // Every position of the game, analyzed on a worker with an engine of its own
+    void analyze_game() {
+        analysis_stop.request_stop();
+        analysis_stop = {};
+        std::vector<std::pair<std::uint64_t, std::string>> positions;
+        models::chess::Board board;
+        const auto& moves = game->get_moves();
+        for (size_t ply = 0; ply <= moves.size(); ++ply) {
+            positions.emplace_back(models::chess::zobrist::hash(board, ply % 2 == 0), uci_moves(ply));
+            if (ply < moves.size()) {
+                board.apply_move(moves[ply]);
+            }
+        }
+        curve_hashes.clear();
+        for (const auto& position : positions) {
+            curve_hashes.push_back(position.first);
+        }
+        analysis_total = positions.size();
+        analysis_progress = std::make_shared<std::atomic<size_t>>(0);
+        curve_progress = 0;
+        helpers::scheduler()->submit([positions = std::move(positions), progress = analysis_progress](std::stop_token stop) {
+            chess::analyze_positions(positions, analysis_depth, stop, [&progress](size_t done) {
+                progress->store(done);
+                helpers::request_redraw();
+            });
+            // Stopped or failed: let the card stop waiting
+            progress->store(positions.size());
+            helpers::request_redraw();
+        }, helpers::task_priority::background, analysis_stop);
+    }
+
+    // Cached evaluations of the analyzed game, for white, in pawns
+    void read_eval_curve() {
+        eval_curve.clear();
+        for (auto hash : curve_hashes) {
+            auto line = chess::EngineEvalCache::instance().get(hash);
+            if (!line) break;
+            eval_curve.push_back(line->mate ? (*line->mate > 0 ? 8.0f : -8.0f)
+                                            : std::clamp(static_cast<float>(line->centipawns.value_or(0)) / 100.0f, -8.0f, 8.0f));
+        }
+    }
+
+    // A different game: its analysis starts over
+    void game_loaded() {
+        analysis_stop.request_stop();
+        analysis_progress.reset();
+        curve_hashes.clear();
+        eval_curve.clear();
+        engine_hash = 0;
+    }
+    
 private:
+    static constexpr int analysis_depth = 18;
+
     std::unique_ptr<models::chess::Game> game;
     std::string loaded_pgn_path;
+    std::shared_ptr<models::chess::PgnCollection> collection;   // the games of loaded_pgn_path
+    size_t collection_game = 0;
+    std::stop_source collection_stop;
+    std::vector<models::chess::PositionIndex::MoveStats> position_stats;
+    std::uint64_t stats_hash = 0;
+    std::uint64_t stats_generation = ~std::uint64_t{0};
+    bool engine_on = false;
+    std::unique_ptr<chess::UciEngine> engine;
+    std::uint64_t engine_hash = 0;                  // the position the engine (or cached_eval) is on
+    std::optional<chess::EngineLine> cached_eval;
+    std::stop_source analysis_stop;
+    std::shared_ptr<std::atomic<size_t>> analysis_progress;     // positions done, while a game is analyzed
+    size_t analysis_total = 0;
+    size_t curve_progress = 0;
+    std::vector<std::uint64_t> curve_hashes;
+    std::vector<float> eval_curve;
     bool autoplay = false;
     float autoplay_speed = 1.0f;
     SDL_Renderer* renderer = nullptr;
-    std::unordered_map<models::chess::Piece, SDL_Texture*> piece_textures;
+    std::unordered_map<models::chess::Piece, std::shared_ptr<helpers::texture_atlas::region>> piece_textures;
+    std::vector<SDL_Texture*> own_textures;
     std::unordered_map<models::chess::Piece, std::pair<int, int>> piece_dimensions;
     bool textures_loaded = false;
     ChessComIntegrationState chess_com_state;
@@ -1,61 +1,85 @@
 #pragma once
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <future>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "../../helpers/imgui_include.hpp"
 
 #include "../interface/card.hpp"
 #include "../../models/radio.hpp"
+#include "../../models/radio_directory.hpp"
 #include "../../helpers/media_player.hpp"
+#include "../../helpers/redraw.hpp"
+#include "../../helpers/task_scheduler.hpp"
 
 namespace rouen::cards {
-    
+
     class radio : public card {
     public:
-        radio() {
+        // Directory hits kept per search; the table only draws the visible rows
+        static constexpr size_t directory_results = 500;
+
+        // With a preset's name, e.g. from the launcher's "radio:<name>", that station starts playing
+        explicit radio(std::string_view station = {}) {
             // Set custom colors for the radio card
             colors[0] = {0.5f, 0.3f, 0.7f, 1.0f}; // Purple primary color
             colors[1] = {0.4f, 0.2f, 0.6f, 0.7f}; // Darker purple secondary color
-            
+
             // Additional colors for status indicators
             get_color(2, ImVec4(0.2f, 0.8f, 0.2f, 1.0f)); // Green for playing
             get_color(3, ImVec4(0.8f, 0.2f, 0.2f, 1.0f)); // Red for errors
-            
+
             name("Radio");
-            requested_fps = 5;  // Update 5 times per second
-            
+            requested_fps = 0;  // The player and directory searches wake the loop when something changes
+
             // Create radio model
             radio_model = std::make_unique<rouen::models::radio>();
+            if (!station.empty()) {
+                radio_model->playStation(std::string{station});
+            }
         }
-        
+
         ~radio() override {
             // Ensure the radio is stopped when the card is destroyed
             if (radio_model) {
                 radio_model->stopCurrentStation();
             }
         }
-        
+
         std::string get_uri() const override
         {
             return "radio";
         }
 
+        // Stays awake while a station plays, so it can be stopped where it was started
+        bool can_hibernate() const override
+        {
+            return !radio_model || radio_model->getCurrentStation().empty();
+        }
+
         bool render() override {
             return render_window([this]() {
                 if (!radio_model) {
                     ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Radio model not initialized");
                     return; // This is fine in a void lambda
                 }
-                
-                // Get current station and all station names
+
+                // Get current station
                 const std::string& current_station = radio_model->getCurrentStation();
-                const std::vector<std::string>& stations = radio_model->getStationNames();
-                
+
                 // Display currently playing station
                 if (!current_station.empty()) {
                     ImGui::TextColored(colors[2], "Now Playing: %s", current_station.c_str());
-                    
+                    if (auto const title = radio_model->getStreamTitle(); !title.empty()) {
+                        ImGui::TextWrapped("%s", title.c_str());
+                    }
+
                     // Stop button
                     if (ImGui::Button("Stop")) {
                         radio_model->stopCurrentStation();
@@ -63,72 +87,191 @@ namespace rouen::cards {
                 } else {
                     ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No station playing");
                 }
-                
-                ImGui::Separator();
-                
-                // Search filter
-                static char search_buffer[256] = "";
-                ImGui::PushItemWidth(-1);
-                ImGui::InputText("##search", search_buffer, IM_ARRAYSIZE(search_buffer));
-                
-                // Show placeholder text when search is empty
-                if (search_buffer[0] == '\0' && !ImGui::IsItemActive()) {
-                    auto pos = ImGui::GetItemRectMin();
-                    ImGui::GetWindowDrawList()->AddText(
-                        ImVec2(pos.x + 5, pos.y + 2),
-                        ImGui::GetColorU32(ImGuiCol_TextDisabled),
-                        "Search stations..."
-                    );
-                }
-                ImGui::PopItemWidth();
-                
+
                 ImGui::Separator();
-                
-                // List of stations with scroll
-                if (ImGui::BeginChild("StationsList", ImVec2(0, 0), true)) {
-                    std::string search_text = search_buffer;
-                    std::transform(search_text.begin(), search_text.end(), search_text.begin(),
-                                  [](unsigned char c) { return std::tolower(c); });
-                    
-                    for (const auto& station_name : stations) {
-                        // Apply search filter
-                        std::string lower_name = station_name;
-                        std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(),
-                                      [](unsigned char c) { return std::tolower(c); });
-                        
-                        if (!search_text.empty() && lower_name.find(search_text) == std::string::npos) {
-                            continue;  // Skip stations that don't match search
-                        }
-                        
-                        // Highlight currently playing station
-                        bool is_current = (station_name == current_station);
-                        if (is_current) {
-                            ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[2]));
-                        }
-                        
-                        // Station entry with play button
-                        // if (ImGui::Selectable(station_name.c_str(), is_current)) {
-                        //     radio_model->playStation(station_name);
-                        // }
-
-                        media_player::player(radio_model->getStation(station_name)->url, colors[0], station_name);
-                        
-                        if (is_current) {
-                            ImGui::PopStyleColor();
-                        }
+
+                if (ImGui::BeginTabBar("RadioTabs")) {
+                    if (ImGui::BeginTabItem("Presets")) {
+                        render_presets(current_station);
+                        ImGui::EndTabItem();
                     }
-                    
-                    // If no stations match the search, show a message
-                    if (ImGui::GetScrollMaxY() == 0 && search_text.length() > 0) {
-                        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No stations match your search");
+                    if (ImGui::BeginTabItem("Directory")) {
+                        render_directory(current_station);
+                        ImGui::EndTabItem();
                     }
+                    ImGui::EndTabBar();
                 }
-                ImGui::EndChild();
             });
         }
-        
+
     private:
+        void search_box(const char* id, char* buffer, size_t size, const char* placeholder) {
+            ImGui::PushItemWidth(-1);
+            ImGui::InputText(id, buffer, size);
+
+            // Show placeholder text when search is empty
+            if (buffer[0] == '\0' && !ImGui::IsItemActive()) {
+                auto pos = ImGui::GetItemRectMin();
+                ImGui::GetWindowDrawList()->AddText(
+                    ImVec2(pos.x + 5, pos.y + 2),
+                    ImGui::GetColorU32(ImGuiCol_TextDisabled),
+                    placeholder
+                );
+            }
+            ImGui::PopItemWidth();
+        }
+
+        void render_presets(const std::string& current_station) {
+            search_box("##search", preset_buffer, IM_ARRAYSIZE(preset_buffer), "Search stations...");
+            ImGui::Separator();
+
+            // Filtered again only when the text changes
+            const std::vector<std::string>& stations = radio_model->getStationNames();
+            std::string search_text = preset_buffer;
+            std::transform(search_text.begin(), search_text.end(), search_text.begin(),
+                           [](unsigned char c) { return std::tolower(c); });
+            if (search_text != preset_query) {
+                preset_query = search_text;
+                preset_matches.clear();
+                const auto& keys = radio_model->getStationKeys();
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    if (search_text.empty() || keys[i].find(search_text) != std::string::npos) {
+                        preset_matches.push_back(i);
+                    }
+                }
+            }
+
+            // List of stations with scroll
+            if (ImGui::BeginChild("StationsList", ImVec2(0, 0), true)) {
+                for (auto index : preset_matches) {
+                    const auto& station_name = stations[index];
+
+                    // Highlight currently playing station
+                    bool is_current = (station_name == current_station);
+                    if (is_current) {
+                        ImGui::PushStyleColor(ImGuiCol_Text, ImGui::ColorConvertFloat4ToU32(colors[2]));
+                    }
+
+                    media_player::player(radio_model->getStation(station_name)->url, colors[0], station_name);
+
+                    if (is_current) {
+                        ImGui::PopStyleColor();
+                    }
+                }
+
+                // If no stations match the search, show a message
+                if (preset_matches.empty() && !search_text.empty()) {
+                    ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No stations match your search");
+                }
+            }
+            ImGui::EndChild();
+        }
+
+        // The radio-browser directory: synced in the background, searched on the scheduler so
+        // typing never waits on a query, and drawn through a clipper
+        void render_directory(const std::string& current_station) {
+            auto& directory = rouen::models::radio_directory::instance();
+            auto const syncing = directory.syncing();
+            if (!sync_checked) {
+                sync_checked = true;
+                if (directory.stale()) {
+                    start_sync();
+                }
+            }
+            if (was_syncing && !syncing) {
+                directory_count = -1;
+                directory_query.reset();   // search again over what arrived
+            }
+            was_syncing = syncing;
+
+            if (directory_count < 0) {
+                directory_count = directory.station_count();
+            }
+            if (syncing) {
+                ImGui::TextColored(colors[1], "Syncing directory... %zu stations", directory.synced_so_far());
+            } else {
+                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "%lld stations", static_cast<long long>(directory_count));
+                ImGui::SameLine();
+                if (ImGui::SmallButton("Sync now")) {
+                    start_sync();
+                }
+            }
+
+            search_box("##directory_search", directory_buffer, IM_ARRAYSIZE(directory_buffer), "Search name, tag, country...");
+
+            // One query in flight; the newest text is picked up when it finishes
+            if (pending_search.valid() && pending_search.wait_for(std::chrono::seconds{0}) == std::future_status::ready) {
+                directory_hits = pending_search.get();
+            }
+            if (!pending_search.valid() && directory_query != std::string{directory_buffer}) {
+                directory_query = directory_buffer;
+                pending_search = rouen::helpers::scheduler()->async([text = *directory_query] {
+                    auto hits = rouen::models::radio_directory::instance().search(text, directory_results);
+                    rouen::helpers::request_redraw();
+                    return hits;
+                }, rouen::helpers::task_priority::high);
+            }
+
+            constexpr auto flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersInnerV;
+            if (ImGui::BeginTable("DirectoryStations", 4, flags)) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch, 3.0f);
+                ImGui::TableSetupColumn("Format", ImGuiTableColumnFlags_WidthFixed, ImGui::GetFontSize() * 6);
+                ImGui::TableSetupColumn("Country", ImGuiTableColumnFlags_WidthStretch, 1.0f);
+                ImGui::TableSetupColumn("Tags", ImGuiTableColumnFlags_WidthStretch, 2.0f);
+                ImGui::TableHeadersRow();
+
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(directory_hits.size()));
+                while (clipper.Step()) {
+                    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                        auto const& station = directory_hits[static_cast<size_t>(row)];
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::PushID(row);
+                        bool const is_current = station.name == current_station;
+                        if (ImGui::Selectable(station.name.c_str(), is_current, ImGuiSelectableFlags_SpanAllColumns)) {
+                            radio_model->playUrl(station.name, station.url);
+                        }
+                        ImGui::PopID();
+                        ImGui::TableNextColumn();
+                        if (station.bitrate > 0) {
+                            ImGui::Text("%s %lld", station.codec.c_str(), static_cast<long long>(station.bitrate));
+                        } else {
+                            ImGui::TextUnformatted(station.codec.c_str());
+                        }
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(station.country.c_str());
+                        ImGui::TableNextColumn();
+                        ImGui::TextUnformatted(station.tags.c_str());
+                    }
+                }
+                ImGui::EndTable();
+            }
+        }
+
+        void start_sync() {
+            rouen::helpers::scheduler()->submit([](std::stop_token) {
+                rouen::models::radio_directory::instance().sync();
+                rouen::helpers::request_redraw();
+            }, rouen::helpers::task_priority::background);
+        }
+
         std::unique_ptr<rouen::models::radio> radio_model;
+
+        // Presets: the filter text and the indexes of the names it matches
+        char preset_buffer[256] = "";
+        std::optional<std::string> preset_query;
+        std::vector<size_t> preset_matches;
+
+        // Directory search
+        char directory_buffer[256] = "";
+        std::optional<std::string> directory_query;     // what directory_hits (or the search in flight) is for
+        std::future<std::vector<rouen::models::radio_directory::station>> pending_search;
+        std::vector<rouen::models::radio_directory::station> directory_hits;
+        int64_t directory_count {-1};
+        bool sync_checked {false};
+        bool was_syncing {false};
     };
-    
+
 }
@@ -7,8 +7,10 @@
 #include <sstream>
 #include <string>
 
+#include "../../helpers/audio_engine.hpp"
 #include "../../helpers/imgui_include.hpp"
 #include "../../helpers/media_player.hpp"
+#include "../../helpers/timer_wheel.hpp"
 
 #include "../interface/card.hpp"
 
@@ -23,7 +25,7 @@ namespace rouen::cards {
             get_color(2, ImVec4(1.0f, 0.6f, 0.2f, 1.0f)); // Brighter orange for highlights
             get_color(3, ImVec4(0.7f, 0.7f, 0.7f, 1.0f)); // Light gray for secondary text
             
-            requested_fps = 60;
+            requested_fps = 2;  // Countdown and blink only change once per second; 0 once stopped (see render)
             width = 175.0f; // Reduced to half the default width (default is 300.0f)
             
             // Set up default alarm time (1 hour from current time)
@@ -42,24 +44,18 @@ namespace rouen::cards {
             
             // Format the initial time for display
             update_time_string();
+            arm();
+        }
+
+        // The countdown has to ring out of view too
+        bool can_hibernate() const override {
+            return false;
         }
 
         bool render() override {
             auto time_remaining = get_time_remaining(std::chrono::system_clock::now());
-
-            // Play alarm sound in loop if ringing and not already playing
-            if (time_remaining <= std::chrono::seconds(0)) {
-                if (!alarm_playing) {
-                    media_player_alarm_helper::play_sound_loop("img/alarm.mp3");
-                    alarm_playing = true;
-                }
-            } else {
-                // Stop alarm sound if not ringing
-                if (alarm_playing) {
-                    media_player_alarm_helper::stop_sound_loop();
-                    alarm_playing = false;
-                }
-            }
+            update_sound(time_remaining);
+            requested_fps = time_remaining > std::chrono::seconds(0) || alarm_playing ? 2 : 0;
 
             if (time_remaining <= std::chrono::seconds(0)) {
                 static auto last_blink_time = std::chrono::steady_clock::now();
@@ -181,40 +177,37 @@ namespace rouen::cards {
         }
         
         void snooze(int minutes) {
+            silence();
             set_to_current_time();
             add_minutes(minutes);
-            alarm_playing = false;
-            media_player_alarm_helper::stop_sound_loop();
         }
         void stop_alarm() {
-            alarm_playing = false;
-            media_player_alarm_helper::stop_sound_loop();
+            silence();
             set_to_current_time();
         }
         void reset() {
             set_to_current_time();
             add_minutes(30);
             if (alarm_playing) {
-                alarm_playing = false;
-                media_player_alarm_helper::stop_sound_loop();
+                silence();
             }
         }
         void set_to_current_time() {
             target_time = std::chrono::system_clock::now();
             update_time_string();
             if (alarm_playing) {
-                alarm_playing = false;
-                media_player_alarm_helper::stop_sound_loop();
+                silence();
             }
+            arm();
         }
         void add_minutes(int minutes) {
             target_time += std::chrono::minutes(minutes);
             update_time_string();
             auto new_time_remaining = get_time_remaining(std::chrono::system_clock::now());
             if (alarm_playing && new_time_remaining > std::chrono::seconds(0)) {
-                alarm_playing = false;
-                media_player_alarm_helper::stop_sound_loop();
+                silence();
             }
+            arm();
         }
         void parse_time(const std::string& time_str) {
             // Handle several formats: "HH:MM", "HH:MM:SS", or just "HHMM"
@@ -260,9 +253,9 @@ namespace rouen::cards {
                 target_time = new_target;
                 update_time_string();
                 if (alarm_playing) {
-                    alarm_playing = false;
-                    media_player_alarm_helper::stop_sound_loop();
+                    silence();
                 }
+                arm();
             }
         }
         
@@ -407,6 +400,60 @@ namespace rouen::cards {
             }
         }
         
+        // Hands the ring to the audio thread for target_time, so it starts on the second whether
+        // or not a frame is drawn then, and sets a timer to show it, in view or not. A ringing
+        // alarm is left alone: silence() stops it.
+        void arm() {
+            if (alarm_playing) {
+                return;
+            }
+            auto& audio = helpers::audio_engine::instance();
+            audio.stop(alarm_voice);
+            alarm_voice = -1;
+            ring_timer.cancel();
+            auto const now = std::chrono::system_clock::now();
+            if (target_time > now) {
+                alarm_voice = audio.play_at("alarm", target_time, true);
+                if (auto const timers = helpers::timers()) {
+                    auto const remaining = std::chrono::duration_cast<helpers::timer_wheel::clock::duration>(target_time - now);
+                    ring_timer = timers->after(remaining, [this]() {
+                        update_sound(get_time_remaining(std::chrono::system_clock::now()));
+                        invalidate();
+                    });
+                }
+            }
+        }
+
+        void silence() {
+            alarm_playing = false;
+            helpers::audio_engine::instance().stop(alarm_voice);
+            alarm_voice = -1;
+            media_player_alarm_helper::stop_sound_loop();
+        }
+
+        // Ring in a loop once the time is up; the armed voice has normally started already.
+        // Without an audio device (or before the sound is loaded) mpv rings instead.
+        void update_sound(std::chrono::seconds time_remaining) {
+            if (time_remaining <= std::chrono::seconds(0)) {
+                if (!alarm_playing) {
+                    auto& audio = helpers::audio_engine::instance();
+                    if (!audio.is_playing(alarm_voice)) {
+                        alarm_voice = audio.play("alarm", true);
+                    }
+                    if (alarm_voice < 0) {
+                        media_player_alarm_helper::play_sound_loop("img/alarm.mp3");
+                    }
+                    alarm_playing = true;
+                }
+            } else {
+                // Stop alarm sound if not ringing
+                if (alarm_playing) {
+                    silence();
+                    arm();
+                }
+            }
+        }
+
         std::string get_uri() const override {
             // Support for URI parameters like alarm:14:30
             if (time_buffer[0] != '\0') {
@@ -416,13 +463,14 @@ namespace rouen::cards {
         }
 
         ~alarm() override {
-            media_player_alarm_helper::stop_sound_loop();
-            alarm_playing = false;
+            silence();
         }
 
     private:
         std::chrono::system_clock::time_point target_time;
         char time_buffer[16] = {0};
         bool alarm_playing = false;
+        int alarm_voice = -1;       // audio_engine voice, armed or ringing
+        helpers::timer_wheel::timer ring_timer;
     };
 }
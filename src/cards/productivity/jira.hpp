@@ -28,7 +28,7 @@ public:
         
         name("JIRA");
         width = 500.0f;
-        requested_fps = 5;
+        requested_fps = 0;  // the model wakes the loop as answers arrive
         
         // Initialize model
         jira_model_ = std::make_shared<models::jira_model>();
@@ -55,6 +55,7 @@ public:
                     // Fetch projects after connection
                     projects_future_ = jira_model_->get_projects();
                 }
+                invalidate();
             }).detach();
         }
         first_render_done_ = true;
@@ -220,6 +221,7 @@ private:
                     }
                     
                     login_in_progress_ = false;
+                    invalidate();
                 }).detach();
             }
             
@@ -274,6 +276,7 @@ private:
             }
             
             login_in_progress_ = false;
+            invalidate();
         }).detach();
     }
     
@@ -661,6 +664,7 @@ private:
                 }
                 
                 comment_in_progress = false;
+                invalidate();
             }).detach();
             
             new_comment.clear();
@@ -793,6 +797,7 @@ private:
                 }
                 
                 issue_creation_in_progress_ = false;
+                invalidate();
             }).detach();
         }
         
@@ -16,6 +16,7 @@
 #include "../../helpers/views/json_view.hpp"
 #include "../../helpers/api_keys.hpp"
 #include "../../helpers/debug.hpp"
+#include "../../helpers/redraw.hpp"
 #include "../../../external/IconsMaterialDesign.h"
 #include "jira_ui_components.hpp"
 
@@ -293,31 +294,14 @@ private:
         
         // Loading indicator
         if (is_loading_issues_) {
-            ImGui::TextColored(colors[1], "Loading issues...");
+            ImGui::TextColored(colors[1], "%s", project_issues_.empty() ? "Loading issues..." : "Syncing issues...");
         }
         
         // Issues table
-        if (ImGui::BeginTable("IssuesTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
-            jira_ui::TableRenderers::setup_issue_table_headers();
-            
-            // Status column will be rendered inline
-            
-            // Use our filterable table component
-            jira_ui::render_filterable_table(
-                project_issues_,
-                issue_filter_,
-                colors,
-                [this](const models::jira_issue& issue) {
-                    selected_issue_ = issue;
-                    show_issue_details_ = true;
-                },
-                [this](const models::jira_issue& issue) {
-                    jira_ui::TableRenderers::render_status_column(issue, colors);
-                }
-            );
-            
-            ImGui::EndTable();
-        }
+        project_issues_table_.render("IssuesTable", project_issues_, issue_filter_, [this](const models::jira_issue& issue) {
+                selected_issue_ = issue;
+                show_issue_details_ = true;
+            });
     }
     
     // My Issues tab rendering
@@ -335,34 +319,10 @@ private:
         ImGui::PopItemWidth();
         
         // Issues table
-        if (ImGui::BeginTable("MyIssuesTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
-            // Setup table headers
-            ImGui::TableSetupColumn("Key", ImGuiTableColumnFlags_WidthFixed, 100.0f);
-            ImGui::TableSetupColumn("Project", ImGuiTableColumnFlags_WidthFixed, 80.0f);
-            ImGui::TableSetupColumn("Summary", ImGuiTableColumnFlags_WidthStretch);
-            ImGui::TableSetupColumn("Status", ImGuiTableColumnFlags_WidthFixed, 120.0f);
-            ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed, 80.0f);
-            ImGui::TableHeadersRow();
-            
-            // Extra columns will be rendered inline
-            
-            // Use our filterable table component
-            jira_ui::render_filterable_table(
-                my_issues_,
-                my_issue_filter_,
-                colors,
-                [this](const models::jira_issue& issue) {
-                    selected_issue_ = issue;
-                    show_issue_details_ = true;
-                },
-                [this](const models::jira_issue& issue) {
-                    jira_ui::TableRenderers::render_project_column(issue);
-                    jira_ui::TableRenderers::render_status_column(issue, colors);
-                }
-            );
-            
-            ImGui::EndTable();
-        }
+        my_issues_table_.render("MyIssuesTable", my_issues_, my_issue_filter_, [this](const models::jira_issue& issue) {
+                selected_issue_ = issue;
+                show_issue_details_ = true;
+            });
         
         // Issue details popup
         render_issue_details_popup();
@@ -408,10 +368,12 @@ private:
         }
         
         // Show loading indicator or error
-        if (is_loading_search_results_) {
-            ImGui::TextColored(colors[1], "Searching...");
-        } else if (!search_error_.empty()) {
+        if (!search_error_.empty()) {
             ImGui::TextColored(colors[2], "%s", search_error_.c_str());
+        } else if (search_ && !search_->error().empty()) {
+            ImGui::TextColored(colors[2], "%s", search_->error().c_str());
+        } else if (search_ && search_->loading() && search_->total() < 0) {
+            ImGui::TextColored(colors[1], "Searching...");
         }
         
         render_search_results();
@@ -436,53 +398,33 @@ private:
     }
     
     void render_search_results() {
-        if (search_results_.issues.empty()) {
+        if (!search_) {
             return;
         }
         
-        ImGui::Separator();
-        ImGui::TextColored(colors[0], "Search Results: %d issue(s) found", search_results_.total);
-        
-        if (search_results_.total > static_cast<int>(search_results_.issues.size())) {
-            ImGui::SameLine();
-            ImGui::TextColored(colors[4], "(showing %zu of %d)", 
-                            search_results_.issues.size(), search_results_.total);
-            
-            // Load more button
-            if (ImGui::Button("Load More")) {
-                load_more_search_results();
+        search_->read([this](const std::vector<models::jira_issue>& issues, int total) {
+            if (issues.empty()) {
+                return;
             }
-        }
-        
-        // Results table
-        if (ImGui::BeginTable("SearchResultsTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
-            // Setup columns
-            ImGui::TableSetupColumn("Key", ImGuiTableColumnFlags_WidthFixed, 100.0f);
-            ImGui::TableSetupColumn("Project", ImGuiTableColumnFlags_WidthFixed, 80.0f);
-            ImGui::TableSetupColumn("Summary", ImGuiTableColumnFlags_WidthStretch);
-            ImGui::TableSetupColumn("Status", ImGuiTableColumnFlags_WidthFixed, 120.0f);
-            ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed, 80.0f);
-            ImGui::TableHeadersRow();
             
-            // Extra columns will be rendered inline
+            ImGui::Separator();
+            ImGui::TextColored(colors[0], "Search Results: %d issue(s) found", total);
             
-            // Use our filterable table component - search results don't need additional filtering
-            // So we're passing an empty filter string
-            jira_ui::render_filterable_table(
-                search_results_.issues,
-                "",
-                colors,
-                [this](const models::jira_issue& issue) {
-                    selected_issue_ = issue;
-                    show_issue_details_ = true;
-                },
-                [this](const models::jira_issue& issue) {
-                    jira_ui::TableRenderers::render_project_column(issue);
-                    jira_ui::TableRenderers::render_status_column(issue, colors);
-                }
-            );
+            if (total > static_cast<int>(issues.size())) {
+                ImGui::SameLine();
+                ImGui::TextColored(colors[4], "(loaded %zu of %d)", issues.size(), total);
+            }
             
-            ImGui::EndTable();
+            // Results table; search results have no filter of their own
+            search_table_.render("SearchResultsTable", issues, "", [this](const models::jira_issue& issue) {
+                selected_issue_ = issue;
+                show_issue_details_ = true;
+            });
+        });
+        
+        // Within a screen of the end: keep the next pages coming
+        if (ImGui::GetScrollMaxY() - ImGui::GetScrollY() < ImGui::GetWindowHeight()) {
+            search_->want(search_->size());
         }
     }
     
@@ -596,6 +538,7 @@ private:
         if (ImGui::BeginPopupModal(std::format("Issue: {}", selected_issue_.key).c_str(), &show_issue_details_)) {
             render_issue_basic_info();
             render_issue_description();
+            render_issue_activity();
             render_issue_transitions();
             
             // Close button
@@ -642,17 +585,50 @@ private:
     }
     
     void render_issue_description() {
+        // Lists carry no description: the details bring it, with comments and history
+        if (issue_details_requested_ != selected_issue_.key) {
+            load_issue_details(selected_issue_.key);
+        }
+        
         // Description (in a scrollable region)
         ImGui::TextColored(colors[0], "Description:");
         ImGui::BeginChild("Description", ImVec2(0, 200), true);
-        if (!selected_issue_.description.empty()) {
-            ImGui::TextWrapped("%s", selected_issue_.description.c_str());
+        auto const& description = issue_details_.key == selected_issue_.key ? issue_details_.description : selected_issue_.description;
+        if (!description.empty()) {
+            ImGui::TextWrapped("%s", description.c_str());
+        } else if (is_loading_details_) {
+            ImGui::TextColored(colors[1], "Loading...");
         } else {
             ImGui::TextColored(colors[5], "No description provided");
         }
         ImGui::EndChild();
     }
     
+    void render_issue_activity() {
+        if (issue_details_.key != selected_issue_.key) {
+            return;
+        }
+        
+        if (ImGui::CollapsingHeader(std::format("Comments ({})###comments", issue_details_.comments.size()).c_str())) {
+            for (const auto& comment : issue_details_.comments) {
+                ImGui::TextColored(colors[0], "%s", comment.author.display_name.c_str());
+                ImGui::SameLine();
+                ImGui::TextColored(colors[5], "%s", format_jira_date(comment.created).c_str());
+                ImGui::TextWrapped("%s", comment.body.c_str());
+                ImGui::Separator();
+            }
+        }
+        
+        if (ImGui::CollapsingHeader(std::format("History ({})###history", issue_details_.changes.size()).c_str())) {
+            for (const auto& change : issue_details_.changes) {
+                ImGui::TextColored(colors[5], "%s", format_jira_date(change.created).c_str());
+                ImGui::SameLine();
+                ImGui::TextWrapped("%s: %s: %s -> %s", change.author.c_str(), change.field.c_str(),
+                                   change.from.c_str(), change.to.c_str());
+            }
+        }
+    }
+    
     void render_issue_transitions() {
         ImGui::Separator();
         ImGui::TextColored(colors[0], "Transitions:");
@@ -769,26 +745,20 @@ private:
         );
     }
     
-    // Load issues for a specific project
+    // Load issues for a specific project: the cached ones at once, then what changed on the server
     void load_project_issues(const std::string& project_key) {
+        project_issues_ = jira_host_->cached_project_issues(project_key);
+        project_issues_table_.invalidate();
         is_loading_issues_ = true;
         
-        // Use search_issues to get issues for the project
-        std::string jql = std::format("project = {} ORDER BY updated DESC", project_key);
-        auto future = jira_host_->search_issues(jql);
-        
-        // Handle the future asynchronously
-        jira_ui::execute_async<models::jira_search_result>(
-            std::move(future),
-            [this](const models::jira_search_result& result) {
-                project_issues_ = result.issues;
-            },
-            [this](const std::string& error) {
-                error_message_ = std::format("Failed to load issues: {}", error);
-            },
-            nullptr,
-            &is_loading_issues_
-        );
+        jira_host_->sync_project(project_key, [this, project_key](std::vector<models::jira_issue> issues) {
+            if (selected_project_.key == project_key) {
+                project_issues_ = std::move(issues);
+                project_issues_table_.invalidate();
+            }
+            is_loading_issues_ = false;
+            helpers::request_redraw();
+        });
     }
     
     // Load issues assigned to current user
@@ -812,6 +782,7 @@ private:
             std::move(future),
             [this](const models::jira_search_result& result) {
                 my_issues_ = result.issues;
+                my_issues_table_.invalidate();
             },
             [this](const std::string& error) {
                 error_message_ = std::format("Error loading your issues: {}", error);
@@ -849,7 +820,7 @@ private:
         }
     }
     
-    // Perform JQL search
+    // Perform JQL search; a search still paging is dropped
     void perform_jql_search() {
         if (std::string(jql_query_).empty()) {
             search_error_ = "Please enter a JQL query";
@@ -857,54 +828,30 @@ private:
         }
         
         search_error_.clear();
-        is_loading_search_results_ = true;
-        current_search_start_at_ = 0;
-        
-        auto future = jira_host_->search_issues(jql_query_, current_search_start_at_);
-        
-        // Handle the future asynchronously
-        jira_ui::execute_async<models::jira_search_result>(
-            std::move(future),
-            [this](const models::jira_search_result& result) {
-                search_results_ = result;
-            },
-            [this](const std::string& error) {
-                search_error_ = std::format("Search error: {}", error);
-                JIRA_ERROR_FMT("JQL search error: {}", error);
-            },
-            nullptr,
-            &is_loading_search_results_
-        );
+        if (search_) {
+            search_->cancel();
+        }
+        search_ = models::jira_model::search(jira_host_, jql_query_);
+        search_table_.invalidate();
     }
     
-    // Load more search results (pagination)
-    void load_more_search_results() {
-        if (is_loading_search_results_) {
-            return;
-        }
-        
-        is_loading_search_results_ = true;
-        current_search_start_at_ += search_results_.max_results;
-        
-        auto future = jira_host_->search_issues(jql_query_, current_search_start_at_);
-        
-        // Handle the future asynchronously
-        jira_ui::execute_async<models::jira_search_result>(
-            std::move(future),
-            [this](const models::jira_search_result& result) {
-                // Append new issues to existing results
-                search_results_.issues.insert(
-                    search_results_.issues.end(), 
-                    result.issues.begin(), 
-                    result.issues.end()
-                );
+    // Load description, comments and history of the issue shown
+    void load_issue_details(const std::string& issue_key) {
+        issue_details_requested_ = issue_key;
+        is_loading_details_ = true;
+        
+        jira_ui::execute_async<models::jira_issue_details>(
+            jira_host_->get_issue_details(issue_key),
+            [this](const models::jira_issue_details& result) {
+                issue_details_ = result;
+                helpers::request_redraw();
             },
             [this](const std::string& error) {
-                search_error_ = std::format("Error loading more results: {}", error);
-                JIRA_ERROR_FMT("Error loading more search results: {}", error);
+                error_message_ = std::format("Error loading issue details: {}", error);
+                JIRA_ERROR_FMT("Error loading issue details: {}", error);
             },
             nullptr,
-            &is_loading_search_results_
+            &is_loading_details_
         );
     }
     
@@ -940,8 +887,9 @@ private:
                 [this, issue_key](const models::jira_issue& result) {
                     selected_issue_ = result;
                     
-                    // Also refresh transitions
+                    // Also refresh transitions, and the history with the change just made
                     issue_transitions_.clear();
+                    issue_details_requested_.clear();
                     load_issue_transitions(issue_key);
                     
                     // Refresh affected lists
@@ -1062,24 +1010,33 @@ private:
     std::vector<models::jira_issue> project_issues_;
     bool is_loading_issues_ = false;
     char issue_filter_[256] = "";
+    jira_ui::filterable_table<models::jira_issue> project_issues_table_ {{
+        jira_ui::issue_columns::key(colors), jira_ui::issue_columns::summary(), jira_ui::issue_columns::status(colors)}};
     
     // My issues data
     std::vector<models::jira_issue> my_issues_;
     bool is_loading_my_issues_ = false;
     char my_issue_filter_[256] = "";
+    jira_ui::filterable_table<models::jira_issue> my_issues_table_ {{
+        jira_ui::issue_columns::key(colors), jira_ui::issue_columns::project(),
+        jira_ui::issue_columns::summary(), jira_ui::issue_columns::status(colors)}};
     std::string status_filter_ = "All";
     
     // Search data
     char jql_query_[1024] = "";
-    models::jira_search_result search_results_;
-    bool is_loading_search_results_ = false;
+    std::shared_ptr<models::jira_search_cursor> search_;
+    jira_ui::filterable_table<models::jira_issue> search_table_ {{
+        jira_ui::issue_columns::key(colors), jira_ui::issue_columns::project(),
+        jira_ui::issue_columns::summary(), jira_ui::issue_columns::status(colors)}};
     std::string search_error_;
-    int current_search_start_at_ = 0;
     
     // Issue details
     models::jira_issue selected_issue_;
     bool show_issue_details_ = false;
     std::vector<models::jira_transition> issue_transitions_;
+    models::jira_issue_details issue_details_;
+    std::string issue_details_requested_;
+    bool is_loading_details_ = false;
     bool is_loading_transitions_ = false;
     
     // Create issue
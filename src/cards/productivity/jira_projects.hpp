@@ -3,6 +3,7 @@
 #include "../interface/card.hpp"
 #include "../../models/jira_model.hpp"
 #include "../../helpers/imgui_include.hpp"
+#include "../../helpers/launcher_index.hpp"
 #include <memory>
 #include <string>
 #include <vector>
@@ -29,7 +30,7 @@ public:
         
         name("JIRA Projects");
         width = 500.0f;
-        requested_fps = 5;
+        requested_fps = 0;  // the model wakes the loop as answers arrive
         
         // Initialize model
         jira_model_ = std::make_shared<models::jira_model>();
@@ -47,6 +48,7 @@ public:
                     // Fetch projects after connection
                     projects_future_ = jira_model_->get_projects();
                 }
+                invalidate();
             }).detach();
         }
     }
@@ -137,6 +139,16 @@ private:
             projects_future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
             projects_ = projects_future_.get();
             
+            // Each project becomes a launcher target opening a search of its issues
+            if (auto launcher = rouen::helpers::launcher_index::shared()) {
+                std::vector<rouen::helpers::launch_target> targets;
+                for (const auto& project : projects_) {
+                    targets.push_back({std::format("{} {}", project.key, project.name),
+                                       std::format("jira-search:project = {}", project.key)});
+                }
+                launcher->publish("jira", std::move(targets));
+            }
+            
             // If we have projects but none selected, fetch overview stats
             if (!projects_.empty() && selected_project_key_.empty()) {
                 for (const auto& project : projects_) {
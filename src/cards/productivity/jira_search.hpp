@@ -27,7 +27,7 @@ public:
         
         name("JIRA Search");
         width = 500.0f;
-        requested_fps = 5;
+        requested_fps = 0;  // the model wakes the loop as answers arrive
         
         // Initialize model
         jira_model_ = std::make_shared<models::jira_model>();
@@ -9,10 +9,15 @@
 #include <type_traits>
 #include <future>
 #include <optional>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <unordered_map>
 
 #include "../../helpers/imgui_include.hpp"
 #include "../../models/jira_model.hpp"
 #include "../../helpers/debug.hpp"
+#include "../../helpers/redraw.hpp"
 
 namespace rouen::cards::jira_ui {
 
@@ -62,79 +67,195 @@ inline void render_status_text(const std::string& category, const std::string& n
     ImGui::TextColored(status_color, "%s", name.c_str());
 }
 
-// Function to render a filterable table of items
-template <
-    typename T,
-    typename ColorArray,
-    typename OnClickFunc,
-    typename RenderExtraFunc
->
+/**
+ * A filterable, sortable table of items that does its work when its inputs change rather
+ * than every frame: each item's lowercase "key summary" is computed once, when it first
+ * shows up; the rows passing the filter only when the filter, the sort or the items change;
+ * and each column's ordering once per set of items. Rows are drawn through ImGuiListClipper,
+ * so only the visible ones cost anything. Items are recognized by their vector's buffer and
+ * size; a caller that replaces them in place calls invalidate().
+ */
+template <typename T>
 requires HasKeyAndSummary<T>
-void render_filterable_table(
-    const std::vector<T>& items,
-    const char* filter_buffer,
-    const ColorArray& colors,
-    OnClickFunc on_item_click,
-    RenderExtraFunc render_extra_columns
-) {
-    // Apply filter
-    std::string filter = filter_buffer;
-    std::transform(filter.begin(), filter.end(), filter.begin(), ::tolower);
+class filterable_table {
+public:
+    struct column {
+        const char* label;
+        float width;                                          // 0 stretches
+        std::function<std::string_view(const T&)> sort_key;   // empty: not sortable
+        std::function<void(const T&)> render;
+    };
     
-    // Render each row that passes the filter
-    for (const auto& item : items) {
-        // Apply filter
-        std::string summary_lower = item.summary;
-        std::string key_lower = item.key;
-        std::transform(summary_lower.begin(), summary_lower.end(), summary_lower.begin(), ::tolower);
-        std::transform(key_lower.begin(), key_lower.end(), key_lower.begin(), ::tolower);
+    explicit filterable_table(std::vector<column> columns) : columns_(std::move(columns)) {}
+    
+    // The items were replaced: index them again on the next render (callable from any thread)
+    void invalidate() {
+        stale_ = true;
+    }
+    
+    // The table, with a View button per row calling on_item_click
+    template <typename OnClickFunc>
+    void render(const char* id, const std::vector<T>& items, std::string_view filter, OnClickFunc on_item_click) {
+        update_index(items);
         
-        if (!filter.empty() && 
-            summary_lower.find(filter) == std::string::npos && 
-            key_lower.find(filter) == std::string::npos) {
-            continue;
+        auto const flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Sortable | ImGuiTableFlags_SortTristate;
+        if (!ImGui::BeginTable(id, static_cast<int>(columns_.size()) + 1, flags)) {
+            return;
         }
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            auto const& c = columns_[i];
+            ImGuiTableColumnFlags column_flags = c.width > 0 ? ImGuiTableColumnFlags_WidthFixed : ImGuiTableColumnFlags_WidthStretch;
+            if (!c.sort_key) {
+                column_flags |= ImGuiTableColumnFlags_NoSort;
+            }
+            ImGui::TableSetupColumn(c.label, column_flags, c.width, static_cast<ImGuiID>(i));
+        }
+        ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoSort, 80.0f);
+        ImGui::TableHeadersRow();
         
-        // Item row
-        ImGui::TableNextRow();
-        
-        // Key column
-        ImGui::TableNextColumn();
-        ImGui::TextColored(colors[0], "%s", item.key.c_str());
-        
-        // Summary column
-        ImGui::TableNextColumn();
-        ImGui::Text("%s", item.summary.c_str());
+        if (auto* specs = ImGui::TableGetSortSpecs(); specs && specs->SpecsDirty) {
+            sort_column_ = specs->SpecsCount > 0 ? static_cast<int>(specs->Specs[0].ColumnUserID) : -1;
+            descending_ = specs->SpecsCount > 0 && specs->Specs[0].SortDirection == ImGuiSortDirection_Descending;
+            specs->SpecsDirty = false;
+            rows_dirty_ = true;
+        }
+        if (filter != filter_) {
+            filter_ = filter;
+            filter_lower_ = to_lower(filter_);
+            rows_dirty_ = true;
+        }
+        if (rows_dirty_) {
+            select_rows(items);
+        }
         
-        // Let caller render any additional columns
-        render_extra_columns(item);
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(rows_.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const T& item = items[rows_[row]];
+                ImGui::TableNextRow();
+                for (auto const& c : columns_) {
+                    ImGui::TableNextColumn();
+                    c.render(item);
+                }
+                ImGui::TableNextColumn();
+                std::string_view const key = item.key;
+                ImGui::PushID(key.data(), key.data() + key.size());
+                if (ImGui::Button("View")) {
+                    on_item_click(item);
+                }
+                ImGui::PopID();
+            }
+        }
         
-        // Actions column
-        ImGui::TableNextColumn();
-        std::string view_btn_id = "View##" + std::string(item.key);
-        if (ImGui::Button(view_btn_id.c_str())) {
-            on_item_click(item);
+        ImGui::EndTable();
+    }
+    
+    // Rows passing the filter
+    size_t visible_count() const { return rows_.size(); }
+    
+private:
+    void update_index(const std::vector<T>& items) {
+        if (stale_.exchange(false) || items.data() != source_ || items.size() < lower_.size()) {
+            source_ = items.data();
+            lower_.clear();
+            orders_.clear();
+            rows_dirty_ = true;
         }
+        if (lower_.size() == items.size()) {
+            return;
+        }
+        lower_.reserve(items.size());
+        for (size_t i = lower_.size(); i < items.size(); ++i) {
+            std::string text {std::string_view{items[i].key}};
+            text += '\n';
+            text += std::string_view{items[i].summary};
+            lower_.push_back(to_lower(std::move(text)));
+        }
+        orders_.clear();
+        rows_dirty_ = true;
     }
-}
+    
+    // Item indices sorted by a column, ascending
+    const std::vector<size_t>& order_by(int column_index, const std::vector<T>& items) {
+        auto [pos, added] = orders_.try_emplace(column_index);
+        if (added) {
+            auto& order = pos->second;
+            order.resize(items.size());
+            std::iota(order.begin(), order.end(), size_t{0});
+            auto const& key = columns_[column_index].sort_key;
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return key(items[a]) < key(items[b]); });
+        }
+        return pos->second;
+    }
+    
+    void select_rows(const std::vector<T>& items) {
+        rows_dirty_ = false;
+        rows_.clear();
+        auto const passes = [this](size_t i) { return filter_lower_.empty() || lower_[i].find(filter_lower_) != std::string::npos; };
+        if (sort_column_ < 0 || sort_column_ >= static_cast<int>(columns_.size()) || !columns_[sort_column_].sort_key) {
+            for (size_t i = 0; i < items.size(); ++i) {
+                if (passes(i)) {
+                    rows_.push_back(i);
+                }
+            }
+            return;
+        }
+        auto const& order = order_by(sort_column_, items);
+        auto const take = [&](size_t i) {
+            if (passes(i)) {
+                rows_.push_back(i);
+            }
+        };
+        if (descending_) {
+            std::for_each(order.rbegin(), order.rend(), take);
+        } else {
+            std::for_each(order.begin(), order.end(), take);
+        }
+    }
+    
+    std::vector<column> columns_;
+    const T* source_ = nullptr;
+    std::atomic<bool> stale_ {false};
+    std::vector<std::string> lower_;                        // per item: "key\nsummary", lowercase
+    std::unordered_map<int, std::vector<size_t>> orders_;   // per sorted column
+    std::vector<size_t> rows_;                              // what is shown, in order
+    std::string filter_;
+    std::string filter_lower_;
+    int sort_column_ = -1;
+    bool descending_ = false;
+    bool rows_dirty_ = true;
+};
 
-// Overload with no extra columns renderer
-template <
-    typename T,
-    typename ColorArray,
-    typename OnClickFunc
->
-requires HasKeyAndSummary<T>
-void render_filterable_table(
-    const std::vector<T>& items,
-    const char* filter_buffer,
-    const ColorArray& colors,
-    OnClickFunc on_item_click
-) {
-    // Using a no-op lambda for the extra columns
-    render_filterable_table(items, filter_buffer, colors, on_item_click, 
-                           [](const T&){});
-}
+// Columns of an issue table
+struct issue_columns {
+    template <typename ColorArray>
+    static filterable_table<models::jira_issue>::column key(const ColorArray& colors, float width = 100.0f) {
+        return {"Key", width, [](const models::jira_issue& issue) -> std::string_view { return issue.key; },
+                [&colors](const models::jira_issue& issue) { ImGui::TextColored(colors[0], "%s", issue.key.c_str()); }};
+    }
+    
+    static filterable_table<models::jira_issue>::column summary() {
+        return {"Summary", 0.0f, [](const models::jira_issue& issue) -> std::string_view { return issue.summary; },
+                [](const models::jira_issue& issue) { ImGui::TextUnformatted(issue.summary.c_str()); }};
+    }
+    
+    // The project key, from the issue key ("PROJ-123" -> "PROJ")
+    static filterable_table<models::jira_issue>::column project() {
+        auto project_of = [](const models::jira_issue& issue) { return std::string_view{issue.key}.substr(0, issue.key.find('-')); };
+        return {"Project", 80.0f, project_of,
+                [project_of](const models::jira_issue& issue) {
+                    auto const project = project_of(issue);
+                    ImGui::TextUnformatted(project.data(), project.data() + project.size());
+                }};
+    }
+    
+    template <typename ColorArray>
+    static filterable_table<models::jira_issue>::column status(const ColorArray& colors) {
+        return {"Status", 120.0f, [](const models::jira_issue& issue) -> std::string_view { return issue.status.name; },
+                [&colors](const models::jira_issue& issue) { render_status_text(issue.status.category, issue.status.name, colors); }};
+    }
+};
 
 // Generic async operation handler
 template <typename T>
@@ -172,20 +293,13 @@ void execute_async(
         if (on_complete) {
             on_complete();
         }
+        // The card shows the outcome on its next frame
+        rouen::helpers::request_redraw();
     }).detach();
 }
 
 // Common rendering functions for tables
 struct TableRenderers {
-    // Standard issue table headers setup
-    static void setup_issue_table_headers(const char* first_col_title = "Key") {
-        ImGui::TableSetupColumn(first_col_title, ImGuiTableColumnFlags_WidthFixed, 100.0f);
-        ImGui::TableSetupColumn("Summary", ImGuiTableColumnFlags_WidthStretch);
-        ImGui::TableSetupColumn("Status", ImGuiTableColumnFlags_WidthFixed, 120.0f);
-        ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed, 80.0f);
-        ImGui::TableHeadersRow();
-    }
-    
     // Setup for project table headers
     static void setup_project_table_headers() {
         ImGui::TableSetupColumn("Key", ImGuiTableColumnFlags_WidthFixed, 80.0f);
@@ -193,21 +307,7 @@ struct TableRenderers {
         ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed, 100.0f);
         ImGui::TableHeadersRow();
     }
-    
-    // Status column rendering
-    template <typename ColorArray>
-    static void render_status_column(const models::jira_issue& issue, const ColorArray& colors) {
-        ImGui::TableNextColumn();
-        render_status_text(issue.status.category, issue.status.name, colors);
-    }
-    
-    // Project column rendering (extracts project key from issue key)
-    static void render_project_column(const models::jira_issue& issue) {
-        ImGui::TableNextColumn();
-        // Extract project key from issue key (e.g., "PROJ-123" -> "PROJ")
-        std::string project_key = issue.key.substr(0, issue.key.find('-'));
-        ImGui::Text("%s", project_key.c_str());
-    }
+
 };
 
 } // namespace rouen::cards::jira_ui
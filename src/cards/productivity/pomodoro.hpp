@@ -5,8 +5,10 @@
 #include <cmath>
 #include <format>
 
+#include "../../helpers/audio_engine.hpp"
 #include "../../helpers/imgui_include.hpp"
 #include "../../helpers/media_player.hpp"
+#include "../../helpers/timer_wheel.hpp"
 
 #include "../interface/card.hpp"
 
@@ -17,25 +19,19 @@ namespace rouen::cards {
             name("Pomodoro");
             colors[0] = {0.37f, 0.53f, 0.71f, 1.0f}; // Changed from orange to blue accent color (first_color)
             colors[1] = {0.251f, 0.878f, 0.816f, 0.7f}; // Turquoise color (second_color)
-            requested_fps = 60;
+            requested_fps = 2;  // The dial advances a fraction of a degree per second
+            arm();
         }
         ~pomodoro() override {
-            media_player_alarm_helper::stop_sound_loop();
-            pomodoro_playing = false;
+            silence();
+        }
+        bool can_hibernate() const override {
+            return false;
         }
         bool render() override {
-            auto const current_time = std::chrono::system_clock::now();
-            if (is_done(current_time)) {
-                if (!pomodoro_playing) {
-                    media_player_alarm_helper::play_sound_loop("img/alarm.mp3");
-                    pomodoro_playing = true;
-                }
-            } else {
-                if (pomodoro_playing) {
-                    media_player_alarm_helper::stop_sound_loop();
-                    pomodoro_playing = false;
-                }
-            }
+            update_sound(std::chrono::system_clock::now());
+            // Only the dial moves; once done, the card waits for Reset
+            requested_fps = is_done(std::chrono::system_clock::now()) ? 0 : 2;
             return render_window([this]() {
                 if (ImGui::SmallButton("Reset")) {
                     reset();
@@ -106,12 +102,30 @@ namespace rouen::cards {
                 }
             });
         }
+        // The ring is scheduled on the audio thread for the end of the 25 minutes; mpv rings
+        // instead when there is no audio device
+        void update_sound(std::chrono::system_clock::time_point current_time) {
+            if (is_done(current_time)) {
+                if (!pomodoro_playing) {
+                    auto& audio = helpers::audio_engine::instance();
+                    if (!audio.is_playing(pomodoro_voice)) {
+                        pomodoro_voice = audio.play("alarm", true);
+                    }
+                    if (pomodoro_voice < 0) {
+                        media_player_alarm_helper::play_sound_loop("img/alarm.mp3");
+                    }
+                    pomodoro_playing = true;
+                }
+            } else {
+                if (pomodoro_playing) {
+                    silence();
+                }
+            }
+        }
         void reset() {
             start_time = std::chrono::system_clock::now();
-            if (pomodoro_playing) {
-                media_player_alarm_helper::stop_sound_loop();
-                pomodoro_playing = false;
-            }
+            silence();
+            arm();
         }
         bool is_done(std::chrono::system_clock::time_point current_time) const {
             return std::chrono::duration_cast<std::chrono::minutes>(current_time - start_time).count() >= 25;
@@ -125,9 +139,29 @@ namespace rouen::cards {
             return "pomodoro";
         }
     private:
+        // The ring starts on time without a frame; the timer then updates the card, in view or not
+        void arm() {
+            auto const end = start_time + std::chrono::minutes(25);
+            pomodoro_voice = helpers::audio_engine::instance().play_at("alarm", end, true);
+            if (auto const timers = helpers::timers()) {
+                auto const remaining = std::chrono::duration_cast<helpers::timer_wheel::clock::duration>(end - std::chrono::system_clock::now());
+                ring_timer = timers->after(remaining, [this]() {
+                    update_sound(std::chrono::system_clock::now());
+                    invalidate();
+                });
+            }
+        }
+        void silence() {
+            pomodoro_playing = false;
+            helpers::audio_engine::instance().stop(pomodoro_voice);
+            pomodoro_voice = -1;
+            media_player_alarm_helper::stop_sound_loop();
+        }
         std::chrono::system_clock::time_point start_time {std::chrono::system_clock::now()};
         std::chrono::system_clock::time_point end_time {start_time + std::chrono::minutes(25)};
         ImVec4 third_color {1.0f, 1.0f, 0.0f, 0.5f};
         bool pomodoro_playing = false;
+        int pomodoro_voice = -1;    // audio_engine voice, armed or ringing
+        helpers::timer_wheel::timer ring_timer;
     };
 }
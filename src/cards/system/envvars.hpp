@@ -28,8 +28,8 @@ struct envvars_card : public card {
         name("Environment Variables");
         width = 600.0f; // Set initial width
         
-        // Request refresh rate for updating variables
-        requested_fps = 2;  // Update twice per second
+        // Read once when the card opens; nothing changes them behind its back
+        requested_fps = 0;
         
         // Load environment variables
         refresh_env_vars();
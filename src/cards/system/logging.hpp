@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../../helpers/imgui_include.hpp"
+#include "../../helpers/logger.hpp"
+#include "../interface/card.hpp"
+
+namespace rouen::cards {
+
+// Runtime control of the logger: default level, per-component levels and output format
+struct logging_card : public card {
+    logging_card() {
+        colors[0] = {0.45f, 0.45f, 0.50f, 1.0f};  // Slate primary color (first_color)
+        colors[1] = {0.55f, 0.55f, 0.60f, 0.7f};  // Light slate secondary color (second_color)
+
+        name("Logging");
+        width = 320.0f;
+        requested_fps = 0;  // components logging for the first time show up on the next frame
+    }
+
+    bool render() override {
+        return render_window([]() {
+            auto& log = rouen::helpers::logger::instance();
+
+            int default_level = log.default_level();
+            if (level_combo("Default", default_level, false)) {
+                log.set_level("*", default_level);
+            }
+
+            bool json = log.format() == rouen::helpers::logger::output_format::json;
+            if (ImGui::Checkbox("JSON lines", &json)) {
+                log.set_format(json ? rouen::helpers::logger::output_format::json
+                                    : rouen::helpers::logger::output_format::text);
+            }
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Flush")) {
+                log.flush();
+            }
+            ImGui::Separator();
+
+            for (auto [component, level] : log.components()) {
+                if (level_combo(component.c_str(), level, true)) {
+                    log.set_level(component, level);
+                }
+            }
+        });
+    }
+
+    std::string get_uri() const override {
+        return "logging";
+    }
+
+private:
+    // -1 is shown as "Default" when the component may follow the default level
+    static bool level_combo(char const* label, int& level, bool allow_default) {
+        auto const preview = level < 0 ? "Default" : rouen::helpers::logger::level_name(level);
+        bool changed = false;
+        ImGui::SetNextItemWidth(120.0f);
+        if (ImGui::BeginCombo(label, preview)) {
+            for (int l = allow_default ? -1 : 0; l <= rouen::helpers::logger::level_trace; ++l) {
+                auto const text = l < 0 ? "Default" : rouen::helpers::logger::level_name(l);
+                if (ImGui::Selectable(text, l == level)) {
+                    level = l;
+                    changed = true;
+                }
+            }
+            ImGui::EndCombo();
+        }
+        return changed;
+    }
+};
+
+} // namespace rouen::cards
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sqlite3.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "../../helpers/imgui_include.hpp"
+#include "../../helpers/memory_accounting.hpp"
+#include "../interface/card.hpp"
+
+namespace rouen::cards {
+
+// Where the resident set goes: the process totals, SQLite's own heap, the heap by
+// allocation tag (with ROUEN_MEMORY_TAGS=1) and what caches and cards report holding
+struct memory_card : public card {
+    memory_card() {
+        colors[0] = {0.45f, 0.5f, 0.3f, 1.0f};    // Olive primary color (first_color)
+        colors[1] = {0.55f, 0.6f, 0.4f, 0.7f};    // Light olive secondary color (second_color)
+
+        name("Memory");
+        width = 520.0f;
+        requested_fps = 1;  // Sampled, not pushed: the resident set moves without telling anyone
+    }
+
+    bool render() override {
+        return render_window([this]() {
+            auto const [rss, peak_rss] = process_resident();
+            ImGui::Text("Resident: %s (peak %s)", rss ? format_size(rss).c_str() : "n/a", format_size(peak_rss).c_str());
+
+            sqlite3_int64 sqlite_used = 0;
+            sqlite3_int64 sqlite_peak = 0;
+            sqlite3_status64(SQLITE_STATUS_MEMORY_USED, &sqlite_used, &sqlite_peak, 0);
+            sqlite3_int64 pages = 0;
+            sqlite3_int64 pages_peak = 0;
+            sqlite3_status64(SQLITE_STATUS_PAGECACHE_OVERFLOW, &pages, &pages_peak, 0);
+            ImGui::Text("SQLite: %s (peak %s), page caches %s (peak %s)",
+                        format_size(sqlite_used).c_str(), format_size(sqlite_peak).c_str(),
+                        format_size(pages).c_str(), format_size(pages_peak).c_str());
+
+            ImGui::SeparatorText("Heap by tag");
+            if (!rouen::helpers::memory::enabled()) {
+                ImGui::TextDisabled("Start with ROUEN_MEMORY_TAGS=1 to count allocations by card and host");
+            } else {
+                usage_table("##tags", rouen::helpers::memory::tag_usage(), true);
+            }
+
+            ImGui::SeparatorText("Reported by caches and cards");
+            usage_table("##reports", rouen::helpers::memory::report::collect(), false);
+        });
+    }
+
+    std::string get_uri() const override {
+        return "memory";
+    }
+
+private:
+    static void usage_table(char const* id, std::vector<rouen::helpers::memory::usage> const& rows, bool with_allocations) {
+        if (rows.empty()) {
+            ImGui::TextDisabled("Nothing yet");
+            return;
+        }
+        if (ImGui::BeginTable(id, with_allocations ? 4 : 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders)) {
+            ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Live", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("Peak", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            if (with_allocations) {
+                ImGui::TableSetupColumn("Allocations", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+            }
+            ImGui::TableHeadersRow();
+
+            for (auto const& row : rows) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(row.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(format_size(row.live).c_str());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(format_size(row.peak).c_str());
+                if (with_allocations) {
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(std::to_string(row.allocations).c_str());
+                }
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    // Resident bytes now (0 where /proc isn't there to tell) and at the peak
+    static std::pair<int64_t, int64_t> process_resident() {
+        int64_t current = 0;
+        if (auto* statm = std::fopen("/proc/self/statm", "r")) {
+            long size = 0;
+            long resident = 0;
+            if (std::fscanf(statm, "%ld %ld", &size, &resident) == 2) {
+                current = static_cast<int64_t>(resident) * sysconf(_SC_PAGESIZE);
+            }
+            std::fclose(statm);
+        }
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        int64_t const peak = usage.ru_maxrss;           // bytes
+#else
+        int64_t const peak = usage.ru_maxrss * 1024;    // kilobytes
+#endif
+        return {current, peak};
+    }
+
+    static std::string format_size(int64_t bytes) {
+        if (bytes < 0) {
+            return "-" + format_size(-bytes);
+        }
+        if (bytes < 1024) {
+            return std::format("{} B", bytes);
+        }
+        if (bytes < 1024 * 1024) {
+            return std::format("{:.1f} KB", static_cast<double>(bytes) / 1024);
+        }
+        if (bytes < int64_t{1} << 30) {
+            return std::format("{:.1f} MB", static_cast<double>(bytes) / (1024 * 1024));
+        }
+        return std::format("{:.2f} GB", static_cast<double>(bytes) / (1024 * 1024 * 1024));
+    }
+};
+
+} // namespace rouen::cards
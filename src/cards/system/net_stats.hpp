@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../../helpers/http_telemetry.hpp"
+#include "../../helpers/imgui_include.hpp"
+#include "../interface/card.hpp"
+
+namespace rouen::cards {
+
+// Per-host HTTP timings, sizes and error rates collected by http::fetch and the engine
+struct net_stats_card : public card {
+    net_stats_card() {
+        colors[0] = {0.25f, 0.55f, 0.65f, 1.0f};  // Teal primary color (first_color)
+        colors[1] = {0.35f, 0.65f, 0.75f, 0.7f};  // Light teal secondary color (second_color)
+
+        get_color(2, {1.0f, 0.45f, 0.35f, 1.0f}); // Red for hosts with failures
+
+        name("Network Stats");
+        width = 640.0f;
+        requested_fps = 0;  // Timings only move with transfers, whose owners redraw when they end
+    }
+
+    bool render() override {
+        return render_window([this]() {
+            auto& metrics = http::telemetry::instance();
+            auto hosts = metrics.snapshot();
+            std::sort(hosts.begin(), hosts.end(), [](auto const& a, auto const& b) {
+                return a.p99_ms > b.p99_ms;
+            });
+
+            if (ImGui::SmallButton("Reset")) {
+                metrics.reset();
+            }
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Copy JSON")) {
+                ImGui::SetClipboardText(metrics.to_json().c_str());
+            }
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Export JSON")) {
+                std::ofstream out{export_path};
+                out << metrics.to_json();
+                export_status = out ? std::format("Saved {}", export_path) : std::format("Could not write {}", export_path);
+            }
+            if (!export_status.empty()) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("%s", export_status.c_str());
+            }
+
+            if (ImGui::BeginTable("##net_stats", 9, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY)) {
+                ImGui::TableSetupColumn("Host", ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("Req", ImGuiTableColumnFlags_WidthFixed, 45.0f);
+                ImGui::TableSetupColumn("Err", ImGuiTableColumnFlags_WidthFixed, 45.0f);
+                ImGui::TableSetupColumn("p50", ImGuiTableColumnFlags_WidthFixed, 55.0f);
+                ImGui::TableSetupColumn("p99", ImGuiTableColumnFlags_WidthFixed, 55.0f);
+                ImGui::TableSetupColumn("DNS", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+                ImGui::TableSetupColumn("Conn+TLS", ImGuiTableColumnFlags_WidthFixed, 65.0f);
+                ImGui::TableSetupColumn("TTFB", ImGuiTableColumnFlags_WidthFixed, 55.0f);
+                ImGui::TableSetupColumn("In", ImGuiTableColumnFlags_WidthFixed, 65.0f);
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableHeadersRow();
+
+                for (auto const& h : hosts) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(h.host.c_str());
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("2xx %llu  3xx %llu  4xx %llu  5xx %llu  no response %llu\n"
+                                          "%llu over HTTP/2, %llu retries, %s sent, %.1f ms average",
+                            static_cast<unsigned long long>(h.status_classes[2]),
+                            static_cast<unsigned long long>(h.status_classes[3]),
+                            static_cast<unsigned long long>(h.status_classes[4]),
+                            static_cast<unsigned long long>(h.status_classes[5]),
+                            static_cast<unsigned long long>(h.status_classes[0]),
+                            static_cast<unsigned long long>(h.http2), static_cast<unsigned long long>(h.retries),
+                            bytes(h.bytes_out).c_str(), h.total_ms);
+                    }
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", static_cast<unsigned long long>(h.requests));
+                    ImGui::TableNextColumn();
+                    if (h.failures) {
+                        ImGui::TextColored(colors[2], "%llu", static_cast<unsigned long long>(h.failures));
+                    } else {
+                        ImGui::TextDisabled("0");
+                    }
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.0f", h.p50_ms);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.0f", h.p99_ms);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", h.dns_ms);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", h.connect_ms + h.tls_ms);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", h.ttfb_ms);
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(bytes(h.bytes_in).c_str());
+                }
+                ImGui::EndTable();
+            }
+            ImGui::TextDisabled("Times in ms; phases are averages, p50/p99 are histogram estimates of the total");
+        });
+    }
+
+    std::string get_uri() const override {
+        return "net-stats";
+    }
+
+private:
+    static std::string bytes(uint64_t n) {
+        if (n >= 1024 * 1024) {
+            return std::format("{:.1f} MB", static_cast<double>(n) / (1024.0 * 1024.0));
+        }
+        if (n >= 1024) {
+            return std::format("{:.1f} KB", static_cast<double>(n) / 1024.0);
+        }
+        return std::format("{} B", n);
+    }
+
+    static constexpr char const* export_path = "net-stats.json";
+    std::string export_status;
+};
+
+} // namespace rouen::cards
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../../helpers/frame_profiler.hpp"
+#include "../../helpers/imgui_include.hpp"
+#include "../../helpers/redraw.hpp"
+#include "../../helpers/task_scheduler.hpp"
+#include "../../helpers/trace.hpp"
+#include "../../registrar.hpp"
+#include "../interface/card.hpp"
+
+namespace rouen::cards {
+
+struct profiler_card : public card {
+    profiler_card() {
+        colors[0] = {0.55f, 0.35f, 0.65f, 1.0f};  // Purple primary color (first_color)
+        colors[1] = {0.65f, 0.45f, 0.75f, 0.7f};  // Light purple secondary color (second_color)
+
+        get_color(2, {1.0f, 0.45f, 0.35f, 1.0f}); // Red for cards over the frame budget
+        get_color(3, {0.9f, 0.8f, 0.3f, 1.0f});   // Yellow for cards close to the budget
+
+        name("Frame Profiler");
+        width = 420.0f;
+        requested_fps = 0;  // Times come from frames drawn anyway; ticking would only measure itself
+    }
+
+    bool render() override {
+        return render_window([this]() {
+            auto& profiler = registrar::cached<rouen::helpers::frame_profiler, "frame_profiler">();
+            if (!profiler) {
+                ImGui::TextUnformatted("Frame profiler is not available");
+                return;
+            }
+
+            auto entries = profiler->snapshot();
+            std::sort(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+                return a.second.p99_ms > b.second.p99_ms;
+            });
+
+            ImGui::SliderFloat("Budget (ms)", &budget_ms, 1.0f, 33.0f, "%.1f");
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Reset")) {
+                profiler->reset();
+            }
+            trace_controls();
+
+            if (ImGui::BeginTable("##frame_times", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY)) {
+                ImGui::TableSetupColumn("Card", ImGuiTableColumnFlags_WidthStretch);
+                ImGui::TableSetupColumn("p50", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+                ImGui::TableSetupColumn("p99", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+                ImGui::TableSetupColumn("Worst", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableHeadersRow();
+
+                for (auto const& [uri, s] : entries) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    if (s.culled) {
+                        ImGui::TextDisabled("%s (culled)", uri.c_str());
+                    } else {
+                        ImGui::TextUnformatted(uri.c_str());
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        if (s.culled) {
+                            ImGui::SetTooltip("Out of view; %zu samples, last %.3f ms when drawn", s.samples, s.last_ms);
+                        } else {
+                            ImGui::SetTooltip("%zu samples, last %.3f ms", s.samples, s.last_ms);
+                        }
+                    }
+                    ImGui::TableNextColumn();
+                    timing_cell(s.p50_ms);
+                    ImGui::TableNextColumn();
+                    timing_cell(s.p99_ms);
+                    ImGui::TableNextColumn();
+                    timing_cell(s.worst_ms);
+                }
+                ImGui::EndTable();
+            }
+        });
+    }
+
+    std::string get_uri() const override {
+        return "profiler";
+    }
+
+private:
+    struct save_status {
+        std::mutex mutex;
+        std::string text;
+    };
+
+    // Spans of every thread (see helpers/trace.hpp), saved as JSON for ui.perfetto.dev
+    void trace_controls() {
+        using rouen::helpers::trace;
+        bool recording = trace::enabled();
+        if (ImGui::Checkbox("Record trace", &recording)) {
+            if (recording) {
+                trace::start();
+            } else {
+                trace::stop();
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Save trace")) {
+            auto const path = std::format("rouen-trace-{:%Y%m%d-%H%M%S}.json",
+                std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+            rouen::helpers::scheduler()->submit([status = trace_status_, path](std::stop_token) {
+                auto const written = trace::dump(path);
+                {
+                    std::lock_guard lock(status->mutex);
+                    status->text = written ? std::format("Saved {}", path) : std::format("Could not write {}", path);
+                }
+                rouen::helpers::request_redraw();
+            }, rouen::helpers::task_priority::background);
+        }
+        std::lock_guard lock(trace_status_->mutex);
+        if (!trace_status_->text.empty()) {
+            ImGui::TextDisabled("%s", trace_status_->text.c_str());
+        }
+    }
+
+    void timing_cell(double ms) {
+        auto const text = std::format("{:.2f}", ms);
+        if (ms >= static_cast<double>(budget_ms)) {
+            ImGui::TextColored(colors[2], "%s", text.c_str());
+        } else if (ms >= static_cast<double>(budget_ms) * 0.5) {
+            ImGui::TextColored(colors[3], "%s", text.c_str());
+        } else {
+            ImGui::TextUnformatted(text.c_str());
+        }
+    }
+
+    float budget_ms {4.0f};
+    std::shared_ptr<save_status> trace_status_ {std::make_shared<save_status>()};
+};
+
+} // namespace rouen::cards
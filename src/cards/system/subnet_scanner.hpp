@@ -6,14 +6,18 @@
 #include <mutex>
 #include <atomic>
 #include <chrono>
+#include <cstdio>
 #include <format>
-#include <future>
 #include <algorithm>
-#include <queue>
-#include <condition_variable>
+#include <charconv>
+#include <iterator>
+#include <limits>
 #include <functional>
-#include <random>       // For std::random_device, std::mt19937, and std::shuffle
+#include <memory>
+#include <optional>
+#include <stop_token>
 #include <unordered_map> // For std::unordered_map
+#include <ctime>
 
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -26,6 +30,11 @@
 #include "../../helpers/imgui_include.hpp"
 #include "../interface/card.hpp"
 #include "../../helpers/debug.hpp"
+#include "../../helpers/net_prober.hpp"
+#include "../../helpers/redraw.hpp"
+#include "../../helpers/task_scheduler.hpp"
+#include "../../helpers/timer_wheel.hpp"
+#include "../../models/network_inventory.hpp"
 
 // Define subnet scanner specific logging macros
 #define NET_ERROR(message) LOG_COMPONENT("SUBNET", LOG_LEVEL_ERROR, message)
@@ -43,114 +52,44 @@
 
 namespace rouen::cards {
 
+// What told us a host is there
+enum discovery_source : uint8_t {
+    source_tcp = 1,
+    source_icmp = 2,
+    source_neighbors = 4,
+};
+
 struct device_info {
     std::string ip_address;
     std::string hostname;
     std::string mac_address;
+    std::vector<uint16_t> open_ports;
+    uint8_t seen_by{0};     // discovery_source bits
     bool is_online{true};
+    std::chrono::system_clock::time_point first_seen{std::chrono::system_clock::now()};
     std::chrono::system_clock::time_point last_seen{std::chrono::system_clock::now()};
 };
 
-// ThreadPool class for managing worker threads
-class ThreadPool {
-public:
-    explicit ThreadPool(size_t num_threads) : stop(false) {
-        for (size_t i = 0; i < num_threads; ++i) {
-            workers.emplace_back([this] {
-                while (true) {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> lock(queue_mutex);
-                        condition.wait(lock, [this] { 
-                            return stop || !tasks.empty(); 
-                        });
-                        
-                        if (stop && tasks.empty()) {
-                            return;
-                        }
-                        
-                        task = std::move(tasks.front());
-                        tasks.pop();
-                    }
-                    
-                    task();
-                }
-            });
-        }
-        
-        NET_INFO_FMT("Created thread pool with {} worker threads", num_threads);
-    }
-    
-    ~ThreadPool() {
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            stop = true;
-        }
-        
-        condition.notify_all();
-        
-        for (std::thread &worker : workers) {
-            if (worker.joinable()) {
-                worker.join();
-            }
-        }
-        
-        NET_INFO("Thread pool destroyed");
-    }
-    
-    template<class F>
-    void enqueue(F&& f) {
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            if (stop) {
-                throw std::runtime_error("Cannot enqueue on stopped ThreadPool");
-            }
-            
-            tasks.emplace(std::forward<F>(f));
-        }
-        
-        condition.notify_one();
-    }
-    
-    size_t get_thread_count() const {
-        return workers.size();
-    }
-    
-    size_t get_queue_size() {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        return tasks.size();
-    }
-    
-private:
-    std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
-    std::mutex queue_mutex;
-    std::condition_variable condition;
-    bool stop;
-};
-
 class subnet_scanner : public card {
 public:
-    subnet_scanner() 
-        : thread_pool(std::thread::hardware_concurrency() > 0 ? 
-                     std::thread::hardware_concurrency() : 4) {
+    subnet_scanner() {
         // Set custom colors for the card
         colors[0] = {0.2f, 0.4f, 0.6f, 1.0f};   // Blue primary color
         colors[1] = {0.3f, 0.5f, 0.7f, 0.7f};   // Light blue secondary color
         colors[2] = {0.1f, 0.6f, 0.9f, 1.0f};   // Scan button color
         colors[3] = {0.0f, 0.8f, 0.2f, 1.0f};   // Online device color
         colors[4] = {0.8f, 0.2f, 0.2f, 1.0f};   // Offline device color
-        colors[5] = {0.5f, 0.5f, 0.1f, 1.0f};   // Thread activity color
+        colors[5] = {0.5f, 0.5f, 0.1f, 1.0f};   // Probe activity color
         
         name("Subnet Scanner");
         width = 400.0f;  // Make the card a bit wider
-        requested_fps = 10; // Higher refresh rate to update progress more smoothly
+        requested_fps = 0;  // 10 while a scan runs, for its progress (see render)
         
         // Detect local interfaces and subnets
         detect_local_interfaces();
         
-        // Log the number of threads created
-        NET_INFO_FMT("Subnet scanner initialized with {} threads", thread_pool.get_thread_count());
+        // What earlier scans found, until this one says otherwise
+        load_inventory();
     }
     
     ~subnet_scanner() override {
@@ -158,10 +97,16 @@ public:
     }
     
     bool render() override {
+        // Monitoring: rescan on an interval, known hosts first, so each pass is cheap
+        if (monitor && !is_scanning && std::chrono::steady_clock::now() >= next_rescan) {
+            start_scan();
+        }
+        
+        requested_fps = is_scanning ? 10 : 0;
         return render_window([this]() {
             // Show scanning status if active
             if (is_scanning) {
-                ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "Scanning in progress...");
+                ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.0f, 1.0f), "Scanning in progress: %s", scan_phase.load());
                 // Use load() to get current values from atomic variables
                 int scanned = scanned_hosts.load();
                 int total = total_hosts.load();
@@ -171,9 +116,8 @@ public:
                 std::string progress_text = std::format("{}/{}", scanned, total);
                 ImGui::ProgressBar(progress, ImVec2(-1, 0), progress_text.c_str());
                 
-                // Show thread pool stats
-                ImGui::TextColored(colors[5], "Active threads: %zu, Queued tasks: %zu", 
-                                 thread_pool.get_thread_count(), thread_pool.get_queue_size());
+                // Show prober stats
+                ImGui::TextColored(colors[5], "Probes in flight: %d, hosts up: %d", probes_in_flight.load(), hosts_up.load());
                 
                 if (ImGui::Button("Stop Scan", ImVec2(120, 0))) {
                     stop_scan();
@@ -190,6 +134,7 @@ public:
                             if (ImGui::Selectable(interface.first.c_str(), is_selected)) {
                                 current_interface = interface.first;
                                 selected_subnet = interface.second;
+                                std::snprintf(subnet_buffer, sizeof(subnet_buffer), "%s", selected_subnet.c_str());
                             }
                             if (is_selected) {
                                 ImGui::SetItemDefaultFocus();
@@ -205,13 +150,56 @@ public:
                     
                     ImGui::Separator();
                     
-                    ImGui::Text("Subnet: %s", selected_subnet.c_str());
+                    // Any range down to a /16 can be typed in
+                    ImGui::Text("Subnet:");
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(180.0f);
+                    if (ImGui::InputText("##subnet", subnet_buffer, sizeof(subnet_buffer))) {
+                        selected_subnet = subnet_buffer;
+                    }
+                    if (!scan_error.empty()) {
+                        ImGui::TextColored(colors[4], "%s", scan_error.c_str());
+                    }
                     
                     ImGui::Separator();
                     
+                    ImGui::Text("Discover with:");
+                    if (ImGui::RadioButton("All", discovery == 0)) discovery = 0;
+                    ImGui::SameLine();
+                    if (ImGui::RadioButton("TCP", discovery == 1)) discovery = 1;
+                    ImGui::SameLine();
+                    if (ImGui::RadioButton("ICMP", discovery == 2)) discovery = 2;
+                    ImGui::SameLine();
+                    if (ImGui::RadioButton("ARP table", discovery == 3)) discovery = 3;
+                    if (icmp_unavailable) {
+                        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "ICMP needs net.ipv4.ping_group_range or CAP_NET_RAW");
+                    }
+                    
                     if (ImGui::RadioButton("Fast Ping Scan", scan_type == 0)) scan_type = 0;
                     ImGui::SameLine();
-                    if (ImGui::RadioButton("Deep Port Scan", scan_type == 1)) scan_type = 1;
+                    if (ImGui::RadioButton("Port Scan", scan_type == 1)) scan_type = 1;
+                    
+                    if (scan_type == 1) {
+                        // Ports as "22,80,8000-8100"; a preset fills the field in
+                        ImGui::SetNextItemWidth(140.0f);
+                        if (ImGui::BeginCombo("##preset", port_presets[port_preset].name)) {
+                            for (int i = 0; i < static_cast<int>(std::size(port_presets)); ++i) {
+                                if (ImGui::Selectable(port_presets[i].name, port_preset == i)) {
+                                    port_preset = i;
+                                    std::snprintf(ports_buffer, sizeof(ports_buffer), "%s", port_presets[i].ports);
+                                }
+                            }
+                            ImGui::EndCombo();
+                        }
+                        ImGui::SameLine();
+                        ImGui::SetNextItemWidth(-1);
+                        ImGui::InputText("##ports", ports_buffer, sizeof(ports_buffer));
+                        ImGui::Checkbox("Grab banners", &grab_banners);
+                        ImGui::SameLine();
+                        ImGui::SetNextItemWidth(120.0f);
+                        // Connects in flight per host to start with; answers widen it, drops narrow it
+                        ImGui::SliderInt("per host##window", &per_host_window, 1, 256, "%d", ImGuiSliderFlags_Logarithmic);
+                    }
                     
                     ImGui::Separator();
                     
@@ -219,10 +207,16 @@ public:
                     ImGui::Text("Timeout (ms):");
                     ImGui::SliderInt("##timeout", &ping_timeout_ms, 100, 3000);
                     
-                    // Number of worker threads slider
-                    size_t hw_threads = std::thread::hardware_concurrency();
-                    ImGui::Text("Threads to use (%zu available):", hw_threads);
-                    ImGui::SliderInt("##threads", &num_threads, 1, static_cast<int>(hw_threads * 2));
+                    // Connects kept in flight at once, all on one thread
+                    ImGui::Text("Probes in flight:");
+                    ImGui::SliderInt("##concurrency", &max_in_flight, 64, 8192, "%d", ImGuiSliderFlags_Logarithmic);
+                    
+                    // Hosts up last time are probed first, the rest of the range after them at a quarter of the rate
+                    ImGui::Checkbox("Known hosts first", &known_first);
+                    ImGui::Checkbox("Rescan every", &monitor);
+                    ImGui::SameLine();
+                    ImGui::SetNextItemWidth(120.0f);
+                    ImGui::SliderInt("minutes##monitor", &monitor_minutes, 1, 60);
                     
                     ImGui::Separator();
                     
@@ -232,10 +226,15 @@ public:
                     }
                     ImGui::PopStyleColor();
                     
-                    if (!devices.empty()) {
+                    if (!found->devices.empty()) {
                         ImGui::SameLine();
                         if (ImGui::Button("Clear Results", ImVec2(120, 0))) {
-                            devices.clear();
+                            std::lock_guard<std::mutex> lock(found->mutex);
+                            found->devices.clear();
+                            found->index.clear();
+                            found->changes.clear();
+                            found->findings.clear();
+                            models::network_inventory::instance().clear();
                         }
                     }
                 }
@@ -243,36 +242,69 @@ public:
             
             ImGui::Separator();
             
-            if (!devices.empty()) {
-                ImGui::Text("Discovered Devices: %zu", devices.size());
+            // Use a mutex to safely access the devices list
+            std::lock_guard<std::mutex> lock(found->mutex);
+            if (!found->changes.empty() && ImGui::CollapsingHeader(std::format("Changes ({})###changes", found->changes.size()).c_str())) {
+                for (auto change = found->changes.rbegin(); change != found->changes.rend(); ++change) {
+                    ImGui::TextUnformatted(change->c_str());
+                }
+            }
+            if (!found->findings.empty()) {
+                render_open_ports();
+            }
+            if (!found->devices.empty()) {
+                ImGui::Text("Discovered Devices: %zu", found->devices.size());
                 
-                // Create columns for the results table
-                if (ImGui::BeginTable("devices_table", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                // Create columns for the results table; a /16 can find thousands, so only visible rows are drawn
+                if (ImGui::BeginTable("devices_table", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+                    ImGui::TableSetupScrollFreeze(0, 1);
                     ImGui::TableSetupColumn("IP Address", ImGuiTableColumnFlags_WidthFixed, 120.0f);
                     ImGui::TableSetupColumn("Hostname", ImGuiTableColumnFlags_WidthStretch);
-                    ImGui::TableSetupColumn("Status", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+                    ImGui::TableSetupColumn("MAC", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+                    ImGui::TableSetupColumn("Open Ports", ImGuiTableColumnFlags_WidthStretch);
+                    ImGui::TableSetupColumn("Seen By", ImGuiTableColumnFlags_WidthFixed, 90.0f);
+                    ImGui::TableSetupColumn("Status", ImGuiTableColumnFlags_WidthFixed, 90.0f);
                     ImGui::TableHeadersRow();
                     
-                    // Use a mutex to safely access the devices list
-                    std::lock_guard<std::mutex> lock(devices_mutex);
-                    
-                    for (const auto& device : devices) {
-                        ImGui::TableNextRow();
-                        
-                        // IP Address
-                        ImGui::TableNextColumn();
-                        ImGui::Text("%s", device.ip_address.c_str());
-                        
-                        // Hostname
-                        ImGui::TableNextColumn();
-                        ImGui::Text("%s", device.hostname.empty() ? "Unknown" : device.hostname.c_str());
-                        
-                        // Status
-                        ImGui::TableNextColumn();
-                        if (device.is_online) {
-                            ImGui::TextColored(colors[3], "Online");
-                        } else {
-                            ImGui::TextColored(colors[4], "Offline");
+                    ImGuiListClipper clipper;
+                    clipper.Begin(static_cast<int>(found->devices.size()));
+                    while (clipper.Step()) {
+                        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                            const auto& device = found->devices[static_cast<size_t>(row)];
+                            ImGui::TableNextRow();
+                            
+                            // IP Address
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%s", device.ip_address.c_str());
+                            
+                            // Hostname
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%s", device.hostname.empty() ? "Unknown" : device.hostname.c_str());
+                            
+                            // MAC address, from the neighbor table
+                            ImGui::TableNextColumn();
+                            ImGui::TextUnformatted(device.mac_address.c_str());
+                            
+                            // Open ports
+                            ImGui::TableNextColumn();
+                            std::string ports;
+                            for (auto port : device.open_ports) {
+                                ports += std::format("{}{}", ports.empty() ? "" : " ", port);
+                            }
+                            ImGui::TextUnformatted(ports.c_str());
+                            
+                            // Sources
+                            ImGui::TableNextColumn();
+                            ImGui::Text("%s%s%s", device.seen_by & source_neighbors ? "arp " : "",
+                                        device.seen_by & source_icmp ? "icmp " : "", device.seen_by & source_tcp ? "tcp" : "");
+                            
+                            // Status
+                            ImGui::TableNextColumn();
+                            if (device.is_online) {
+                                ImGui::TextColored(colors[3], "Online");
+                            } else {
+                                ImGui::TextColored(colors[4], "%s", seen_ago(device.last_seen).c_str());
+                            }
                         }
                     }
                     
@@ -294,23 +326,66 @@ private:
     std::string current_interface;
     std::string selected_subnet;
     
+    char subnet_buffer[64] = {};
+    std::string scan_error;
+    
     // Scan settings
     int scan_type = 0;  // 0 = ping scan, 1 = port scan
+    char ports_buffer[256] = "22,80,443,445,3389,8080,8443";
+    int port_preset = 0;
+    std::vector<uint16_t> scan_ports;   // parsed from ports_buffer when a port scan starts
+    bool grab_banners = false;
+    int per_host_window = 32;
+    int discovery = 0;  // 0 = all sources, 1 = TCP connects, 2 = ICMP echo, 3 = ARP table only
+    std::atomic<bool> icmp_unavailable{false};
     int ping_timeout_ms = 500;
-    int num_threads = static_cast<int>(std::thread::hardware_concurrency());
-    
-    // Thread pool for parallel scanning
-    ThreadPool thread_pool;
+    int max_in_flight = 2048;
+    bool known_first = true;
+    bool monitor = false;
+    int monitor_minutes = 5;
+    std::chrono::steady_clock::time_point next_rescan;
+    helpers::timer_wheel::timer rescan_timer;     // wakes render() at next_rescan
     
     // Scan status
     std::atomic<bool> is_scanning{false};
     std::atomic<int> scanned_hosts{0};
     std::atomic<int> total_hosts{0};
-    std::thread coordinator_thread;
+    std::atomic<int> probes_in_flight{0};
+    std::atomic<int> hosts_up{0};
+    std::atomic<const char*> scan_phase{""};
     
-    // Results
-    std::vector<device_info> devices;
-    std::mutex devices_mutex;
+    struct port_preset_t {
+        const char* name;
+        const char* ports;
+    };
+    static constexpr port_preset_t port_presets[] = {
+        {"Common", "22,80,443,445,3389,8080,8443"},
+        {"Web", "80,443,3000,5000,8000,8008,8080,8443,8888,9000"},
+        {"Remote access", "22,23,3389,5900-5903,5985,5986"},
+        {"Mail", "25,110,143,465,587,993,995"},
+        {"Databases", "1433,1521,3306,5432,6379,9200,11211,27017"},
+        {"File sharing", "21,139,445,873,2049"},
+        {"Well-known", "1-1023"},
+        {"All", "1-65535"},
+    };
+    
+    struct port_finding {
+        std::string ip_address;
+        uint16_t port;
+        std::string banner;
+        std::chrono::microseconds rtt;
+    };
+    
+    // Results, shared with the hostname lookups, which can outlive the card
+    struct device_list {
+        std::vector<device_info> devices;
+        std::unordered_map<uint32_t, size_t> index;     // address (host order) -> devices
+        std::vector<std::string> changes;               // what rescans found different, oldest first
+        std::vector<port_finding> findings;             // the last port scan's, as they came
+        std::mutex mutex;
+    };
+    std::shared_ptr<device_list> found = std::make_shared<device_list>();
+    std::jthread scan_thread;
     
     // Detect available network interfaces and their subnets
     void detect_local_interfaces() {
@@ -370,6 +445,7 @@ private:
                 if (current_interface.empty()) {
                     current_interface = display_name;
                     selected_subnet = subnet;
+                    std::snprintf(subnet_buffer, sizeof(subnet_buffer), "%s", selected_subnet.c_str());
                 }
             }
         }
@@ -382,233 +458,548 @@ private:
         if (is_scanning || selected_subnet.empty()) {
             return;
         }
-        
-        is_scanning = true;
-        scanned_hosts = 0;
+        next_rescan = std::chrono::steady_clock::now() + std::chrono::minutes{monitor_minutes};
+        if (auto const timers = helpers::timers()) {
+            rescan_timer = timers->at(next_rescan, [this]() { invalidate(); });
+        }
+        scan_error.clear();
         
         // Parse the subnet (e.g., 192.168.1.0/24)
         size_t slash_pos = selected_subnet.find('/');
-        if (slash_pos == std::string::npos) {
-            is_scanning = false;
+        struct in_addr network_addr;
+        int cidr = -1;
+        if (slash_pos != std::string::npos) {
+            cidr = std::atoi(selected_subnet.c_str() + slash_pos + 1);
+        }
+        if (slash_pos == std::string::npos || inet_pton(AF_INET, selected_subnet.substr(0, slash_pos).c_str(), &network_addr) != 1 || cidr < 16 || cidr > 32) {
+            scan_error = "Enter a subnet from /16 to /32, like 192.168.1.0/24";
             NET_ERROR_FMT("Invalid subnet format: {}", selected_subnet);
             return;
         }
         
-        std::string network_str = selected_subnet.substr(0, slash_pos);
-        int cidr = std::stoi(selected_subnet.substr(slash_pos + 1));
-        
-        // Calculate the number of hosts in this subnet
-        unsigned int host_bits = static_cast<unsigned int>(32 - cidr);
-        total_hosts = (1 << host_bits) - 2;  // Exclude network and broadcast addresses
+        if (scan_type == 1) {
+            scan_ports = parse_ports(ports_buffer);
+            if (scan_ports.empty()) {
+                scan_error = "Enter ports like 22,80,8000-8100";
+                return;
+            }
+        }
         
-        // Convert network to integer
-        struct in_addr network_addr;
-        inet_pton(AF_INET, network_str.c_str(), &network_addr);
-        unsigned int network_int = ntohl(network_addr.s_addr);
+        // Every address but the network and broadcast ones, when there are those
+        uint32_t const size = 1u << (32 - cidr);
+        uint32_t const network = ntohl(network_addr.s_addr) & ~(size - 1);
+        uint32_t const first = size > 2 ? network + 1 : network;
+        uint32_t const count = size > 2 ? size - 2 : size;
         
-        // Start the scan coordinator thread
-        coordinator_thread = std::thread([this, network_int, host_bits]() {
-            NET_INFO_FMT("Starting subnet scan on {} using {} threads", 
-                        selected_subnet, num_threads);
-            
-            unsigned int network_size = 1 << host_bits;
-            
-            // Create a synchronized queue of IP addresses to scan
-            std::vector<std::string> ip_queue;
-            ip_queue.reserve(network_size - 2);
-            
-            // Generate all IP addresses in the subnet
-            for (unsigned int i = 1; i < network_size - 1; i++) {
-                unsigned int host_ip = network_int + i;
-                
-                struct in_addr ip_addr;
-                ip_addr.s_addr = htonl(host_ip);
-                
-                char ip_str[INET_ADDRSTRLEN];
-                inet_ntop(AF_INET, &ip_addr, ip_str, INET_ADDRSTRLEN);
-                
-                ip_queue.push_back(ip_str);
-            }
-            
-            // Shuffle the IP addresses to distribute the load more evenly
-            std::random_device rd;
-            std::mt19937 g(rd());
-            std::shuffle(ip_queue.begin(), ip_queue.end(), g);
-            
-            std::atomic<size_t> completed_tasks{0};
-            std::atomic<size_t> total_tasks{ip_queue.size()};
-            
-            // Submit scanning tasks to the thread pool
-            for (const auto& ip : ip_queue) {
-                if (!is_scanning) {
-                    break;  // Stop if scanning was cancelled
-                }
-                
-                thread_pool.enqueue([this, ip, &completed_tasks]() {
-                    // Check if the host is online
-                    bool is_online = ping_host_with_ports(ip.c_str());
-                    
-                    if (is_online || scan_type == 1) {  // Always add if deep scan or if online
-                        device_info device;
-                        device.ip_address = ip;
-                        device.is_online = is_online;
-                        
-                        // Try to resolve hostname
-                        resolve_hostname(ip.c_str(), device.hostname);
-                        
-                        // Add the device to our list
-                        {
-                            std::lock_guard<std::mutex> lock(devices_mutex);
-                            
-                            // Check if the device is already in our list
-                            auto it = std::find_if(devices.begin(), devices.end(),
-                                [&](const auto& d) { return d.ip_address == device.ip_address; });
-                            
-                            if (it != devices.end()) {
-                                // Update existing device
-                                it->hostname = device.hostname;
-                                it->is_online = device.is_online;
-                                it->last_seen = std::chrono::system_clock::now();
-                            } else {
-                                // Add new device
-                                devices.push_back(device);
-                            }
-                        }
-                    }
-                    
-                    scanned_hosts++;
-                    completed_tasks++;
-                });
-            }
-            
-            // Wait for all tasks to complete or for scanning to be cancelled
-            while (completed_tasks < total_tasks && is_scanning) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
-            
-            // Sort the devices by IP address (numeric order)
-            if (!devices.empty()) {
-                std::lock_guard<std::mutex> lock(devices_mutex);
-                std::sort(devices.begin(), devices.end(), [](const auto& a, const auto& b) {
-                    return inet_addr(a.ip_address.c_str()) < inet_addr(b.ip_address.c_str());
-                });
-            }
-            
-            is_scanning = false;
-            NET_INFO("Subnet scan completed");
+        is_scanning = true;
+        scanned_hosts = 0;
+        hosts_up = 0;
+        total_hosts = static_cast<int>(count);
+        scan_thread = std::jthread([this, first, count](std::stop_token stop) {
+            run_scan(stop, first, count);
         });
-        
-        coordinator_thread.detach();
     }
     
     // Stop an ongoing scan
     void stop_scan() {
-        if (is_scanning) {
-            is_scanning = false;
-            
-            // Wait for the coordinator thread to finish
-            if (coordinator_thread.joinable()) {
-                coordinator_thread.join();
+        if (scan_thread.joinable()) {
+            scan_thread.request_stop();
+            scan_thread.join();
+            if (is_scanning) {
+                NET_INFO("Subnet scan stopped by user");
             }
-            
-            NET_INFO("Subnet scan stopped by user");
         }
+        is_scanning = false;
     }
     
-    // Try connecting to a specific port with timeout
-    bool try_port(const char* ip_str, int port) {
-        // Create the socket
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
-        if (sock < 0) {
-            return false;
+    /**
+     * Asks every source the discovery mode allows, cheapest first: the kernel's ARP table
+     * (instant, link-local hosts only), ICMP echo (one socket, every address at once), then TCP
+     * connects. A fast scan leaves out of the later sources what an earlier one found; the ARP
+     * table is read again at the end, when the sweep has filled it. With "known hosts first",
+     * the hosts up at the last scan are swept before the rest of the range, which follows at a
+     * quarter of the probes in flight.
+     */
+    void run_scan(std::stop_token stop, uint32_t first, uint32_t count) {
+        bool const use_neighbors = discovery == 0 || discovery == 3;
+        bool const use_icmp = discovery == 0 || discovery == 2;
+        bool const use_tcp = discovery == 0 || discovery == 1;
+        NET_INFO_FMT("Starting subnet scan on {} with up to {} probes in flight", selected_subnet, max_in_flight);
+        
+        // How each host answered this time (0 while it hasn't), and the ports it accepted on
+        std::vector<uint8_t> sources(count, 0);
+        std::unordered_map<uint32_t, std::vector<uint16_t>> ports_found;
+        auto host_up = [&](uint32_t address, uint8_t source, uint16_t open_port, std::string mac) {
+            auto const h = address - first;
+            if (sources[h] == 0) {
+                ++hosts_up;
+            }
+            sources[h] |= source;
+            if (open_port != 0) {
+                ports_found[h].push_back(open_port);
+            }
+            record_device(address, source, open_port, std::move(mac));
+        };
+        auto read_neighbors = [&]() {
+            for (auto& n : helpers::read_neighbors()) {
+                if (n.address - first < count) {
+                    host_up(n.address, source_neighbors, 0, std::move(n.mac));
+                }
+            }
+        };
+        
+        // What the range looked like before, to tell what changed; the hosts up then go first
+        std::unordered_map<uint32_t, previous_state> before;
+        std::vector<uint32_t> known, rest;
+        {
+            std::lock_guard<std::mutex> lock(found->mutex);
+            if (scan_type == 1 && use_tcp) {
+                found->findings.clear();
+            }
+            for (auto const& [address, i] : found->index) {
+                if (address - first < count) {
+                    auto const& device = found->devices[i];
+                    before.emplace(address, previous_state{device.is_online, device.mac_address, device.open_ports});
+                    if (known_first && device.is_online) {
+                        known.push_back(address - first);
+                    }
+                }
+            }
+        }
+        std::sort(known.begin(), known.end());
+        rest.reserve(count - known.size());
+        for (uint32_t h = 0, k = 0; h < count; ++h) {
+            if (k < known.size() && known[k] == h) {
+                ++k;
+            } else {
+                rest.push_back(h);
+            }
         }
         
-        // Set the socket to non-blocking mode
-        int flags = fcntl(sock, F_GETFL, 0);
-        fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+        auto sweep = [&](std::vector<uint32_t> const& hosts, size_t concurrency, bool background) {
+            total_hosts = static_cast<int>(hosts.size());
+            if (use_icmp && !stop.stop_requested() && !hosts.empty()) {
+                scan_phase = background ? "ICMP echo, rest of range" : "ICMP echo";
+                scanned_hosts = 0;
+                helpers::icmp_prober icmp {{concurrency, std::chrono::milliseconds{ping_timeout_ms}}};
+                if (!icmp.available()) {
+                    icmp_unavailable = true;
+                    NET_WARN("No ICMP socket: skipping echo discovery");
+                } else {
+                    size_t next = 0;
+                    icmp.run([&]() -> std::optional<uint32_t> {
+                        while (next < hosts.size() && scan_type == 0 && sources[hosts[next]] != 0) {
+                            ++next;
+                            ++scanned_hosts;
+                        }
+                        if (next == hosts.size()) {
+                            return std::nullopt;
+                        }
+                        ++scanned_hosts;
+                        return first + hosts[next++];
+                    }, [&](uint32_t address, std::chrono::microseconds) {
+                        host_up(address, source_icmp, 0, {});
+                    }, stop);
+                }
+            }
+            if (use_tcp && !stop.stop_requested() && !hosts.empty()) {
+                scan_phase = background ? "TCP connect, rest of range" : "TCP connect";
+                scanned_hosts = 0;
+                run_tcp_sweep(stop, first, hosts, concurrency, sources, host_up);
+            }
+        };
         
-        // Prepare the address
-        struct sockaddr_in addr;
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(port);
-        inet_pton(AF_INET, ip_str, &addr.sin_addr);
+        if (use_neighbors) {
+            scan_phase = "ARP table";
+            read_neighbors();
+        }
+        auto const full_rate = static_cast<size_t>(max_in_flight);
+        if (!known.empty()) {
+            sweep(known, full_rate, false);
+            sweep(rest, std::max<size_t>(64, full_rate / 4), true);
+        } else {
+            sweep(rest, full_rate, false);
+        }
+        if (use_neighbors && !stop.stop_requested()) {
+            read_neighbors();
+        }
+        scanned_hosts = total_hosts.load();
         
-        // Attempt to connect (non-blocking)
-        int result = connect(sock, (struct sockaddr*)&addr, sizeof(addr));
+        finish_scan(first, count, sources, ports_found, before, !stop.stop_requested(),
+                    scan_type == 1 && use_tcp ? scan_ports : std::vector<uint16_t>{});
         
-        // Handle the non-blocking connect
-        if (result < 0) {
-            if (errno == EINPROGRESS) {
-                // Select with timeout to wait for connection
-                fd_set write_fds;
-                FD_ZERO(&write_fds);
-                FD_SET(sock, &write_fds);
-                
-                // Prepare timeout
-                struct timeval timeout;
-                timeout.tv_sec = ping_timeout_ms / 1000;
-                timeout.tv_usec = (ping_timeout_ms % 1000) * 1000;
-                
-                // Wait for the socket to become writable (connection complete) or timeout
-                result = select(sock + 1, nullptr, &write_fds, nullptr, &timeout);
-                
-                if (result > 0) {
-                    // Socket became writable, but we need to check if connection succeeded
-                    int error = 0;
-                    socklen_t len = sizeof(error);
-                    if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error) {
-                        // Connection failed
-                        close(sock);
-                        return false;
+        is_scanning = false;
+        helpers::request_redraw();
+        NET_INFO("Subnet scan completed");
+    }
+    
+    struct previous_state {
+        bool online;
+        std::string mac;
+        std::vector<uint16_t> ports;
+    };
+    
+    /**
+     * Settles what the scan found against what was known: hosts found are up, with the sources
+     * and (after a deep scan) the ports of this scan; hosts not found go down, but only when the
+     * scan ran to the end. Each difference becomes a line of the change list, and every host
+     * touched is written back to the inventory.
+     */
+    void finish_scan(uint32_t first, uint32_t count, std::vector<uint8_t> const& sources,
+                     std::unordered_map<uint32_t, std::vector<uint16_t>>& ports_found,
+                     std::unordered_map<uint32_t, previous_state> const& before, bool complete, std::vector<uint16_t> const& ports_scanned) {
+        auto& inventory = models::network_inventory::instance();
+        std::string const stamp = clock_time(std::chrono::system_clock::now());
+        std::vector<std::string> changes;
+        
+        std::lock_guard<std::mutex> lock(found->mutex);
+        for (auto const& [address, i] : found->index) {
+            auto const h = address - first;
+            if (h >= count) {
+                continue;
+            }
+            auto& device = found->devices[i];
+            auto const was = before.find(address);
+            if (sources[h] != 0) {
+                device.seen_by = sources[h];
+                if (complete && !ports_scanned.empty()) {
+                    // The ports scanned now are as found; the others are as they were
+                    auto ports = std::move(ports_found[h]);
+                    if (was != before.end()) {
+                        std::copy_if(was->second.ports.begin(), was->second.ports.end(), std::back_inserter(ports), [&](uint16_t port) {
+                            return !std::binary_search(ports_scanned.begin(), ports_scanned.end(), port);
+                        });
                     }
-                    // Connection succeeded
-                    close(sock);
-                    return true;
+                    std::sort(ports.begin(), ports.end());
+                    ports.erase(std::unique(ports.begin(), ports.end()), ports.end());
+                    device.open_ports = std::move(ports);
+                }
+                if (was == before.end()) {
+                    changes.push_back(std::format("{} new: {}{}{}", stamp, device.ip_address, device.mac_address.empty() ? "" : " ", device.mac_address));
                 } else {
-                    // Timeout or error
-                    close(sock);
-                    return false;
+                    if (!was->second.online) {
+                        changes.push_back(std::format("{} up again: {}", stamp, device.ip_address));
+                    }
+                    if (!was->second.mac.empty() && !device.mac_address.empty() && was->second.mac != device.mac_address) {
+                        changes.push_back(std::format("{} {} changed MAC: {} -> {}", stamp, device.ip_address, was->second.mac, device.mac_address));
+                    }
+                    if (complete && !ports_scanned.empty() && was->second.ports != device.open_ports) {
+                        changes.push_back(std::format("{} {} ports: {} -> {}", stamp, device.ip_address,
+                                                      port_list(was->second.ports), port_list(device.open_ports)));
+                    }
                 }
+            } else if (complete && device.is_online) {
+                device.is_online = false;
+                changes.push_back(std::format("{} down: {}", stamp, device.ip_address));
             } else {
-                // Immediate connection failure
-                close(sock);
-                return false;
+                continue;
             }
-        } else {
-            // Immediate connection success (rare but possible)
-            close(sock);
-            return true;
+            inventory.put(to_record(address, device));
+        }
+        
+        for (auto const& change : changes) {
+            NET_INFO_FMT("Subnet change: {}", change);
         }
+        found->changes.insert(found->changes.end(), std::make_move_iterator(changes.begin()), std::make_move_iterator(changes.end()));
+        if (found->changes.size() > max_changes) {
+            found->changes.erase(found->changes.begin(), found->changes.end() - static_cast<std::ptrdiff_t>(max_changes));
+        }
+        sort_devices();
     }
     
-    bool ping_host_with_ports(const char* ip_str) {
-        // First try HTTP port (80)
-        if (try_port(ip_str, 80)) {
-            return true;
+    // Sort the devices by IP address (numeric order); found->mutex held
+    void sort_devices() {
+        std::sort(found->devices.begin(), found->devices.end(), [](const auto& a, const auto& b) {
+            return ntohl(inet_addr(a.ip_address.c_str())) < ntohl(inet_addr(b.ip_address.c_str()));
+        });
+        found->index.clear();
+        for (size_t i = 0; i < found->devices.size(); ++i) {
+            found->index[ntohl(inet_addr(found->devices[i].ip_address.c_str()))] = i;
         }
+    }
+    
+    /**
+     * Probes ports one at a time across the given hosts (every host's first port, then every
+     * host's second one, ...) so that a fast scan skips a host's remaining ports once it has
+     * answered, and a port scan has hosts × ports in flight without piling onto one host; the
+     * prober's per-host window keeps a host that drops probes from being hammered. A refused
+     * connection counts: only a live host sends the RST.
+     */
+    template <typename HostUp>
+    void run_tcp_sweep(std::stop_token stop, uint32_t first, std::vector<uint32_t> const& hosts, size_t concurrency,
+                       std::vector<uint8_t> const& sources, HostUp&& host_up) {
+        static constexpr uint16_t fast_ports[] = {80, 443, 22, 445};
+        std::vector<uint16_t> const ports = scan_type == 1 ? scan_ports : std::vector<uint16_t>(std::begin(fast_ports), std::end(fast_ports));
+        bool const stop_at_first = scan_type == 0;
         
-        // If the deep scan is enabled, try additional common ports
-        if (scan_type == 1) {
-            // Common ports to try: SSH (22), HTTPS (443), SMB (445)
-            const int common_ports[] = {22, 443, 445, 3389, 8080, 8443};
+        // A ping scan counts hosts done, a port scan every probe
+        std::vector<uint32_t> remaining(sources.size(), static_cast<uint32_t>(ports.size()));     // ports not answered, per host
+        if (!stop_at_first) {
+            total_hosts = static_cast<int>(std::min<size_t>(hosts.size() * ports.size(), std::numeric_limits<int>::max()));
+        }
+        auto host_done = [&](uint32_t host) {
+            if (--remaining[host] == 0 || !stop_at_first) {
+                ++scanned_hosts;
+            }
+        };
+        
+        size_t port_index = 0;
+        size_t next_host = 0;
+        auto next = [&]() -> std::optional<helpers::probe_target> {
+            while (port_index < ports.size()) {
+                if (next_host == hosts.size()) {
+                    next_host = 0;
+                    ++port_index;
+                    continue;
+                }
+                auto const h = hosts[next_host++];
+                if (stop_at_first && sources[h] != 0) {
+                    host_done(h);
+                    continue;
+                }
+                ++probes_in_flight;
+                return helpers::probe_target{first + h, ports[port_index]};
+            }
+            return std::nullopt;
+        };
+        auto sink = [&](helpers::probe_result const& result) {
+            --probes_in_flight;
+            if (result.status == helpers::probe_status::open || result.status == helpers::probe_status::closed) {
+                host_up(result.target.address, source_tcp, result.status == helpers::probe_status::open ? result.target.port : 0, std::string{});
+            }
+            if (result.status == helpers::probe_status::open && !stop_at_first) {
+                record_open_port(result);
+            }
+            host_done(result.target.address - first);
+        };
+        
+        helpers::probe_options options {concurrency, std::chrono::milliseconds{ping_timeout_ms}};
+        if (!stop_at_first) {
+            options.per_host = static_cast<size_t>(per_host_window);
+            options.banner = grab_banners;
+            options.banner_timeout = std::chrono::milliseconds{std::max(ping_timeout_ms * 2, 1000)};
+        }
+        helpers::tcp_prober prober {options};
+        prober.run(next, sink, stop);
+        probes_in_flight = 0;
+    }
+    
+    // A host that answered, how, with the port it accepted on (0 for none) and its MAC when known
+    void record_device(uint32_t address, uint8_t source, uint16_t open_port, std::string mac) {
+        std::lock_guard<std::mutex> lock(found->mutex);
+        auto [pos, added] = found->index.try_emplace(address, found->devices.size());
+        if (added) {
+            struct in_addr ip_addr;
+            ip_addr.s_addr = htonl(address);
+            char ip_str[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &ip_addr, ip_str, INET_ADDRSTRLEN);
+            device_info device;
+            device.ip_address = ip_str;
+            found->devices.push_back(std::move(device));
+        }
+        auto& device = found->devices[pos->second];
+        if (added || (device.hostname.empty() && !device.is_online)) {
+            // Reverse lookups block: they go to the scheduler, not the prober's thread
+            helpers::scheduler()->submit([list = found, address, ip = device.ip_address](std::stop_token) {
+                std::string hostname;
+                resolve_hostname(ip.c_str(), hostname);
+                if (hostname.empty()) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(list->mutex);
+                if (auto at = list->index.find(address); at != list->index.end()) {
+                    auto& named = list->devices[at->second];
+                    named.hostname = std::move(hostname);
+                    models::network_inventory::instance().put(to_record(address, named));
+                }
+            }, helpers::task_priority::background);
+        }
+        device.seen_by |= source;
+        if (!mac.empty()) {
+            device.mac_address = std::move(mac);
+        }
+        device.is_online = true;
+        device.last_seen = std::chrono::system_clock::now();
+        if (open_port != 0 && std::find(device.open_ports.begin(), device.open_ports.end(), open_port) == device.open_ports.end()) {
+            device.open_ports.push_back(open_port);
+            std::sort(device.open_ports.begin(), device.open_ports.end());
+        }
+    }
+    
+    void record_open_port(helpers::probe_result const& result) {
+        struct in_addr ip_addr;
+        ip_addr.s_addr = htonl(result.target.address);
+        char ip_str[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &ip_addr, ip_str, INET_ADDRSTRLEN);
+        std::lock_guard<std::mutex> lock(found->mutex);
+        found->findings.push_back({ip_str, result.target.port, result.banner, result.rtt});
+    }
+    
+    // The port scan's findings as they stream in; found->mutex held
+    void render_open_ports() {
+        ImGui::Text("Open Ports: %zu", found->findings.size());
+        if (ImGui::BeginTable("open_ports_table", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY,
+                              ImVec2(0.0f, 180.0f))) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("IP Address", ImGuiTableColumnFlags_WidthFixed, 120.0f);
+            ImGui::TableSetupColumn("Port", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+            ImGui::TableSetupColumn("Service", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+            ImGui::TableSetupColumn("RTT", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+            ImGui::TableSetupColumn("Banner", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableHeadersRow();
             
-            for (int port : common_ports) {
-                if (try_port(ip_str, port)) {
-                    return true;
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(found->findings.size()));
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                    const auto& finding = found->findings[static_cast<size_t>(row)];
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(finding.ip_address.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%u", static_cast<unsigned>(finding.port));
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(service_name(finding.port));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f ms", static_cast<double>(finding.rtt.count()) / 1000.0);
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(finding.banner.c_str());
                 }
             }
+            ImGui::EndTable();
         }
-        
-        // As a fallback, try ICMP ping using the system's ping command
-        // Use a short timeout for the ping command as well
-        std::string cmd = std::format("ping -c 1 -W 1 {} > /dev/null 2>&1", ip_str);
-        int ping_result = system(cmd.c_str());
-        
-        return (ping_result == 0);
     }
     
+    // "22,80,8000-8100" as a sorted list without repeats; empty when it doesn't parse
+    static std::vector<uint16_t> parse_ports(std::string_view spec) {
+        std::vector<uint16_t> ports;
+        while (!spec.empty()) {
+            auto const comma = std::min(spec.find(','), spec.size());
+            auto item = spec.substr(0, comma);
+            spec.remove_prefix(std::min(comma + 1, spec.size()));
+            while (!item.empty() && item.front() == ' ') item.remove_prefix(1);
+            while (!item.empty() && item.back() == ' ') item.remove_suffix(1);
+            if (item.empty()) {
+                continue;
+            }
+            auto const dash = item.find('-');
+            unsigned low = 0, high = 0;
+            auto const parse = [](std::string_view text, unsigned& value) {
+                auto const [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+                return ec == std::errc{} && end == text.data() + text.size() && value >= 1 && value <= 65535;
+            };
+            if (!parse(item.substr(0, dash), low) || !parse(dash == std::string_view::npos ? item : item.substr(dash + 1), high) || high < low) {
+                return {};
+            }
+            for (unsigned port = low; port <= high; ++port) {
+                ports.push_back(static_cast<uint16_t>(port));
+            }
+        }
+        std::sort(ports.begin(), ports.end());
+        ports.erase(std::unique(ports.begin(), ports.end()), ports.end());
+        return ports;
+    }
+    
+    static const char* service_name(uint16_t port) {
+        switch (port) {
+            case 21: return "ftp";
+            case 22: return "ssh";
+            case 23: return "telnet";
+            case 25: return "smtp";
+            case 53: return "dns";
+            case 80: return "http";
+            case 110: return "pop3";
+            case 139: return "netbios";
+            case 143: return "imap";
+            case 443: return "https";
+            case 445: return "smb";
+            case 465: return "smtps";
+            case 587: return "submission";
+            case 873: return "rsync";
+            case 993: return "imaps";
+            case 995: return "pop3s";
+            case 1433: return "mssql";
+            case 1521: return "oracle";
+            case 2049: return "nfs";
+            case 3306: return "mysql";
+            case 3389: return "rdp";
+            case 5432: return "postgres";
+            case 5900: case 5901: case 5902: case 5903: return "vnc";
+            case 5985: case 5986: return "winrm";
+            case 6379: return "redis";
+            case 8000: case 8008: case 8080: case 8888: return "http-alt";
+            case 8443: return "https-alt";
+            case 9200: return "elastic";
+            case 11211: return "memcached";
+            case 27017: return "mongodb";
+            default: return "";
+        }
+    }
+    
+    // The devices earlier scans left in the inventory, as they were last seen
+    void load_inventory() {
+        auto records = models::network_inventory::instance().load();
+        std::lock_guard<std::mutex> lock(found->mutex);
+        for (auto& record : records) {
+            struct in_addr ip_addr;
+            ip_addr.s_addr = htonl(record.address);
+            char ip_str[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &ip_addr, ip_str, INET_ADDRSTRLEN);
+            device_info device;
+            device.ip_address = ip_str;
+            device.hostname = std::move(record.hostname);
+            device.mac_address = std::move(record.mac);
+            device.open_ports = std::move(record.open_ports);
+            device.seen_by = record.seen_by;
+            device.is_online = record.online;
+            device.first_seen = std::chrono::system_clock::time_point{std::chrono::seconds{record.first_seen}};
+            device.last_seen = std::chrono::system_clock::time_point{std::chrono::seconds{record.last_seen}};
+            found->index[record.address] = found->devices.size();
+            found->devices.push_back(std::move(device));
+        }
+    }
+    
+    static models::network_inventory::device to_record(uint32_t address, const device_info& device) {
+        auto const seconds = [](std::chrono::system_clock::time_point t) {
+            return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+        };
+        return {address, device.mac_address, device.hostname, device.open_ports, device.seen_by, device.is_online,
+                seconds(device.first_seen), seconds(device.last_seen)};
+    }
+    
+    static std::string port_list(std::vector<uint16_t> const& ports) {
+        std::string text;
+        for (auto port : ports) {
+            text += std::format("{}{}", text.empty() ? "" : " ", port);
+        }
+        return text.empty() ? "none" : text;
+    }
+    
+    // Local wall-clock time, for the change list
+    static std::string clock_time(std::chrono::system_clock::time_point t) {
+        std::time_t const time = std::chrono::system_clock::to_time_t(t);
+        std::tm local {};
+        localtime_r(&time, &local);
+        char text[32];
+        std::strftime(text, sizeof(text), "%m-%d %H:%M", &local);
+        return text;
+    }
+    
+    static std::string seen_ago(std::chrono::system_clock::time_point t) {
+        auto const minutes = std::chrono::duration_cast<std::chrono::minutes>(std::chrono::system_clock::now() - t).count();
+        if (minutes < 60) {
+            return std::format("Seen {}m ago", std::max<long long>(minutes, 0));
+        }
+        if (minutes < 48 * 60) {
+            return std::format("Seen {}h ago", minutes / 60);
+        }
+        return std::format("Seen {}d ago", minutes / (24 * 60));
+    }
+    
+    static constexpr size_t max_changes = 500;
+    
     // Resolve hostname from IP
-    void resolve_hostname(const char* ip_str, std::string& hostname) {
+    static void resolve_hostname(const char* ip_str, std::string& hostname) {
         struct sockaddr_in addr;
         addr.sin_family = AF_INET;
         addr.sin_port = 0;
@@ -1,22 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <format>
+#include <memory>
 #include <string>
 #include <chrono>
-#include <fstream>
-#include <sstream>
-#include <filesystem>
-
-// Platform-specific includes for system information
-#ifdef __APPLE__
-#include "../../helpers/compat/sysinfo.hpp" // macOS compatibility layer
-#include <sys/mount.h> // for statfs (macOS equivalent of statvfs)
-#else
-#include <sys/sysinfo.h>
-#include <sys/statvfs.h>
-#endif
+#include <vector>
 
+#include "../../helpers/frame_profiler.hpp"
 #include "../../helpers/imgui_include.hpp"
+#include "../../helpers/process_table.hpp"
+#include "../../helpers/system_sampler.hpp"
+#include "../../helpers/timer_wheel.hpp"
+#include "../../registrar.hpp"
 #include "../interface/card.hpp"
 
 namespace rouen::cards {
@@ -33,135 +30,11 @@ struct sysinfo_card : public card {
         name("System Info");
         width = 350.0f;
         
-        // Request higher refresh rate for updating metrics
-        requested_fps = 5;  // Update 5 times per second
-        
-        // Initialize last update time
-        last_update = std::chrono::steady_clock::now();
-    }
-    
-    // Add explicit destructor
-    ~sysinfo_card() override {
-        // Ensure proper cleanup
-        memory_info = {0.0, 0.0, 0.0};
-        disk_info = {0.0, 0.0, 0.0};
-        cpu_usage = 0.0;
-    }
-    
-    // Get memory information (total, used, free)
-    std::tuple<double, double, double> get_memory_info() {
-        struct sysinfo memInfo;
-        sysinfo(&memInfo);
-        
-        double total = static_cast<double>(memInfo.totalram) * memInfo.mem_unit / (1024 * 1024 * 1024); // Total RAM in GB
-        double free = static_cast<double>(memInfo.freeram) * memInfo.mem_unit / (1024 * 1024 * 1024);  // Free RAM in GB
-        double used = total - free; // Used RAM in GB
+        // Redrawn when a new sample is there to show, not at a frame rate of its own
+        requested_fps = 0;
         
-        return {total, used, free};
-    }
-    
-    // Get disk space information (total, used, free)
-    std::tuple<double, double, double> get_disk_info(const std::string& path = "/") {
-#ifdef __APPLE__
-        struct statfs stat;
-        statfs(path.c_str(), &stat);
-        
-        double total = static_cast<double>(stat.f_blocks) * static_cast<double>(stat.f_bsize) / (1024.0 * 1024.0 * 1024.0); // Total space in GB
-        double free = static_cast<double>(stat.f_bfree) * static_cast<double>(stat.f_bsize) / (1024.0 * 1024.0 * 1024.0);  // Free space in GB
-#else
-        struct statvfs stat;
-        statvfs(path.c_str(), &stat);
-        
-        double total = static_cast<double>(stat.f_blocks) * static_cast<double>(stat.f_frsize) / (1024.0 * 1024.0 * 1024.0); // Total space in GB
-        double free = static_cast<double>(stat.f_bfree) * static_cast<double>(stat.f_frsize) / (1024.0 * 1024.0 * 1024.0);  // Free space in GB
-#endif
-        double used = total - free; // Used space in GB
-        
-        return {total, used, free};
-    }
-    
-    // Get CPU usage in percentage
-    double get_cpu_usage() {
-#ifdef __APPLE__
-        // macOS CPU usage calculation
-        static host_cpu_load_info_data_t prev_cpu_load;
-        host_cpu_load_info_data_t cpu_load;
-        mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
-        
-        kern_return_t error = host_statistics(mach_host_self(), HOST_CPU_LOAD_INFO, 
-                                            (host_info_t)&cpu_load, &count);
-        if (error != KERN_SUCCESS) {
-            return 0.0;
-        }
-        
-        // Calculate CPU usage based on ticks with proper type casting to avoid precision loss warnings
-        unsigned long long user_diff = cpu_load.cpu_ticks[CPU_STATE_USER] - prev_cpu_load.cpu_ticks[CPU_STATE_USER];
-        unsigned long long system_diff = cpu_load.cpu_ticks[CPU_STATE_SYSTEM] - prev_cpu_load.cpu_ticks[CPU_STATE_SYSTEM];
-        unsigned long long idle_diff = cpu_load.cpu_ticks[CPU_STATE_IDLE] - prev_cpu_load.cpu_ticks[CPU_STATE_IDLE];
-        unsigned long long nice_diff = cpu_load.cpu_ticks[CPU_STATE_NICE] - prev_cpu_load.cpu_ticks[CPU_STATE_NICE];
-        
-        unsigned long long total_diff = user_diff + system_diff + idle_diff + nice_diff;
-        double percent = 0.0;
-        
-        if (total_diff > 0) {
-            // Cast to double before arithmetic operations to avoid precision loss
-            double user_diff_d = static_cast<double>(user_diff);
-            double system_diff_d = static_cast<double>(system_diff);
-            double nice_diff_d = static_cast<double>(nice_diff);
-            double total_diff_d = static_cast<double>(total_diff);
-            
-            percent = (user_diff_d + system_diff_d + nice_diff_d) * 100.0 / total_diff_d;
-        }
-        
-        // Save current CPU load for next calculation
-        prev_cpu_load = cpu_load;
-        
-        return percent;
-#else
-        // Linux CPU usage calculation
-        static unsigned long long prev_idle = 0, prev_total = 0;
-        unsigned long long idle = 0, total = 0;
-        
-        std::ifstream file("/proc/stat");
-        if (!file.is_open()) {
-            return 0.0; // Return 0 if we can't open the file
-        }
-        
-        std::string line;
-        if (!std::getline(file, line)) {
-            file.close();
-            return 0.0; // Return 0 if we can't read the line
-        }
-        file.close();
-        
-        std::istringstream iss(line);
-        std::string cpu;
-        unsigned long long user = 0, nice = 0, system = 0, idle_time = 0, 
-                           iowait = 0, irq = 0, softirq = 0, steal = 0, 
-                           guest = 0, guest_nice = 0;
-        
-        iss >> cpu >> user >> nice >> system >> idle_time >> iowait >> irq >> softirq >> steal >> guest >> guest_nice;
-        
-        // Check if we successfully read all values
-        if (iss.fail()) {
-            return 0.0; // Return 0 if parsing failed
-        }
-        
-        idle = idle_time + iowait;
-        total = idle + user + nice + system + irq + softirq + steal;
-        
-        double percent = 0.0;
-        if (prev_total > 0 && total > prev_total) {
-            double idle_delta = static_cast<double>(idle - prev_idle);
-            double total_delta = static_cast<double>(total - prev_total);
-            percent = 100.0 * (1.0 - idle_delta / total_delta);
-        }
-        
-        prev_idle = idle;
-        prev_total = total;
-        
-        return percent;
-#endif
+        interval_ms = static_cast<int>(sampler->interval().count());
+        follow_sampler();
     }
     
     // Draw a progress bar with text overlay
@@ -173,69 +46,221 @@ struct sysinfo_card : public card {
         ImGui::Text("%s", label);
     }
     
+    // A ring's history as a line, scaled from 0 to `max` (0: to its largest value)
+    void draw_history(const char* id, helpers::system_sampler::ring const& ring, float max, const char* overlay) {
+        auto const n = ring.copy(plot_buffer);
+        if (max == 0.0f) {
+            max = std::max(1.0f, *std::max_element(plot_buffer.begin(), plot_buffer.begin() + static_cast<std::ptrdiff_t>(n)));
+        }
+        ImGui::PlotLines(id, plot_buffer.data(), static_cast<int>(n), 0, overlay, 0.0f, max, ImVec2(-1, 40));
+    }
+    
+    static std::string rate_text(double bytes_per_second) {
+        if (bytes_per_second >= 1024.0 * 1024.0) {
+            return std::format("{:.1f} MB/s", bytes_per_second / (1024.0 * 1024.0));
+        }
+        return std::format("{:.1f} KB/s", bytes_per_second / 1024.0);
+    }
+    
     bool render() override {
         return render_window([this]() {
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_update).count();
-            
-            // Update metrics every 500ms (twice per second)
-            if (elapsed >= 500) {
-                refresh_metrics();
-                last_update = now;
-            }
+            constexpr double gb = 1024.0 * 1024.0 * 1024.0;
             
             // System uptime information
-            struct sysinfo si;
-            sysinfo(&si);
-            long days = si.uptime / (60 * 60 * 24);
-            int hours = static_cast<int>((si.uptime / (60 * 60)) % 24);
-            int minutes = static_cast<int>((si.uptime / 60) % 60);
-            int seconds = static_cast<int>(si.uptime % 60);
+            auto const uptime = sampler->uptime();
+            long days = uptime / (60 * 60 * 24);
+            int hours = static_cast<int>((uptime / (60 * 60)) % 24);
+            int minutes = static_cast<int>((uptime / 60) % 60);
+            int seconds = static_cast<int>(uptime % 60);
             
             ImGui::Text("System Uptime: %ld days, %d:%02d:%02d", days, hours, minutes, seconds);
+            ImGui::SetNextItemWidth(150.0f);
+            if (ImGui::SliderInt("Sample every (ms)", &interval_ms, 100, 5000, "%d", ImGuiSliderFlags_Logarithmic)) {
+                sampler->set_interval(std::chrono::milliseconds{interval_ms});
+                if (processes) {
+                    processes->set_interval(std::chrono::milliseconds{std::max(interval_ms, 500)});
+                }
+                follow_sampler();
+            }
             ImGui::Separator();
             
             // Memory section
             ImGui::Text("Memory Usage:");
-            auto [mem_total, mem_used, mem_free] = memory_info;
-            std::string mem_text = std::format("{:.2f}/{:.2f} GB ({:.1f}%)", mem_used, mem_total, (mem_used / mem_total) * 100.0);
-            draw_progress_bar("RAM", static_cast<float>(mem_used / mem_total), mem_text.c_str());
+            auto const mem_total = sampler->memory_total() / gb;
+            auto const mem_used = sampler->memory_used().latest() / gb;
+            auto const mem_fraction = mem_total > 0 ? mem_used / mem_total : 0.0;
+            std::string mem_text = std::format("{:.2f}/{:.2f} GB ({:.1f}%)", mem_used, mem_total, mem_fraction * 100.0);
+            draw_progress_bar("RAM", static_cast<float>(mem_fraction), mem_text.c_str());
+            draw_history("##memory", sampler->memory_used(), static_cast<float>(sampler->memory_total()), nullptr);
             
             ImGui::Spacing();
             
             // Disk space section
             ImGui::Text("Disk Usage:");
-            auto [disk_total, disk_used, disk_free] = disk_info;
-            std::string disk_text = std::format("{:.2f}/{:.2f} GB ({:.1f}%)", disk_used, disk_total, (disk_used / disk_total) * 100.0);
-            draw_progress_bar("Disk", static_cast<float>(disk_used / disk_total), disk_text.c_str());
+            auto const disk_total = sampler->disk_total() / gb;
+            auto const disk_used = sampler->disk_used() / gb;
+            auto const disk_fraction = disk_total > 0 ? disk_used / disk_total : 0.0;
+            std::string disk_text = std::format("{:.2f}/{:.2f} GB ({:.1f}%)", disk_used, disk_total, disk_fraction * 100.0);
+            draw_progress_bar("Disk", static_cast<float>(disk_fraction), disk_text.c_str());
+            auto const read_text = std::format("read {}", rate_text(sampler->disk_read().latest()));
+            draw_history("##disk_read", sampler->disk_read(), 0.0f, read_text.c_str());
+            auto const write_text = std::format("write {}", rate_text(sampler->disk_written().latest()));
+            draw_history("##disk_write", sampler->disk_written(), 0.0f, write_text.c_str());
             
             ImGui::Spacing();
             
             // CPU usage section
             ImGui::Text("CPU Usage:");
+            auto const cpu_usage = sampler->cpu_percent().latest();
             std::string cpu_text = std::format("{:.1f}%", cpu_usage);
-            draw_progress_bar("CPU", static_cast<float>(cpu_usage / 100.0), cpu_text.c_str());
+            draw_progress_bar("CPU", cpu_usage / 100.0f, cpu_text.c_str());
+            draw_history("##cpu", sampler->cpu_percent(), 100.0f, nullptr);
+            if (auto const cores = std::min(sampler->cores(), core_buffer.size()); cores > 0) {
+                for (size_t core = 0; core < cores; ++core) {
+                    core_buffer[core] = sampler->core_percent(core).latest();
+                }
+                ImGui::PlotHistogram("##cores", core_buffer.data(), static_cast<int>(cores), 0, "per core", 0.0f, 100.0f, ImVec2(-1, 40));
+            }
+            
+            ImGui::Spacing();
+            
+            // Network section, loopback left out
+            ImGui::Text("Network:");
+            auto const receive_text = std::format("in {}", rate_text(sampler->net_received().latest()));
+            draw_history("##net_in", sampler->net_received(), 0.0f, receive_text.c_str());
+            auto const send_text = std::format("out {}", rate_text(sampler->net_sent().latest()));
+            draw_history("##net_out", sampler->net_sent(), 0.0f, send_text.c_str());
             
             // Display number of processes
-            ImGui::Text("Running Processes: %d", si.procs);
+            ImGui::Text("Running Processes: %d", sampler->processes());
+
+            render_slowest_card();
+            
+            // Sampled only while the list is open
+            if (ImGui::CollapsingHeader("Processes")) {
+                if (!processes) {
+                    processes = helpers::process_table::shared();
+                    processes->set_interval(std::chrono::milliseconds{std::max(interval_ms, 500)});
+                }
+                render_processes();
+            } else {
+                processes.reset();
+                process_rows.clear();
+            }
         });
     }
     
-    void refresh_metrics() {
-        memory_info = get_memory_info();
-        disk_info = get_disk_info();
-        cpu_usage = get_cpu_usage();
+    // The process table's latest sample, sorted by the chosen column; re-sorted only when either changes
+    void render_processes() {
+        if (!ImGui::BeginTable("processes", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+                               ImGuiTableFlags_Sortable, ImVec2(0.0f, 260.0f))) {
+            return;
+        }
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("PID", ImGuiTableColumnFlags_WidthFixed, 55.0f, 0);
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch, 0.0f, 1);
+        ImGui::TableSetupColumn("S", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoSort, 15.0f, 2);
+        ImGui::TableSetupColumn("CPU%", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_DefaultSort |
+                                ImGuiTableColumnFlags_PreferSortDescending, 50.0f, 3);
+        ImGui::TableSetupColumn("RSS", ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_PreferSortDescending, 70.0f, 4);
+        ImGui::TableHeadersRow();
+        
+        bool resort = false;
+        if (auto* specs = ImGui::TableGetSortSpecs(); specs && specs->SpecsDirty) {
+            sort_column = specs->SpecsCount > 0 ? static_cast<int>(specs->Specs[0].ColumnUserID) : 3;
+            sort_descending = specs->SpecsCount > 0 && specs->Specs[0].SortDirection == ImGuiSortDirection_Descending;
+            specs->SpecsDirty = false;
+            resort = true;
+        }
+        if (auto const generation = processes->generation(); generation != process_generation) {
+            process_generation = generation;
+            auto const sample = processes->snapshot();
+            process_rows.assign(sample->begin(), sample->end());
+            resort = true;
+        }
+        if (resort) {
+            auto const less = [column = sort_column](helpers::process_info const& a, helpers::process_info const& b) {
+                switch (column) {
+                    case 0: return a.pid < b.pid;
+                    case 1: return a.name < b.name;
+                    case 4: return a.rss < b.rss;
+                    default: return a.cpu_percent < b.cpu_percent;
+                }
+            };
+            std::sort(process_rows.begin(), process_rows.end(), [&](auto const& a, auto const& b) {
+                return sort_descending ? less(b, a) : less(a, b);
+            });
+        }
+        
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(process_rows.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                auto const& p = process_rows[static_cast<size_t>(row)];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", p.pid);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(p.name.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%c", p.state);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", static_cast<double>(p.cpu_percent));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f MB", static_cast<double>(p.rss) / (1024.0 * 1024.0));
+            }
+        }
+        ImGui::EndTable();
+    }
+    
+    // Show the card with the worst p99 render time, as recorded by the deck
+    void render_slowest_card() {
+        auto& profiler = registrar::cached<rouen::helpers::frame_profiler, "frame_profiler">();
+        if (!profiler) {
+            return;
+        }
+        auto const entries = profiler->snapshot();
+        auto const slowest = std::max_element(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+            return a.second.p99_ms < b.second.p99_ms;
+        });
+        if (slowest != entries.end()) {
+            ImGui::Text("Slowest Card: %s (p99 %.2f ms)", slowest->first.c_str(), slowest->second.p99_ms);
+        }
     }
 
     std::string get_uri() const override {
         return "sysinfo";
     }
+
+    // Out of view for a while: no more redraws until it is back
+    void hibernate() override {
+        redraw_timer.cancel();
+    }
+
+    void resume() override {
+        follow_sampler();
+    }
     
 private:
-    std::chrono::steady_clock::time_point last_update;
-    std::tuple<double, double, double> memory_info {0.0, 0.0, 0.0};
-    std::tuple<double, double, double> disk_info {0.0, 0.0, 0.0};
-    double cpu_usage = 0.0;
+    // One redraw per sampling interval
+    void follow_sampler() {
+        if (auto const timers = helpers::timers()) {
+            redraw_timer = timers->every(std::chrono::milliseconds{interval_ms}, [this]() { invalidate(); });
+        }
+    }
+
+    // Samples arrive on the sampler's thread; rendering only copies them out
+    std::shared_ptr<helpers::system_sampler> sampler = helpers::system_sampler::shared();
+    int interval_ms = 1000;
+    helpers::timer_wheel::timer redraw_timer;
+    std::array<float, helpers::system_sampler::history> plot_buffer {};
+    std::array<float, 256> core_buffer {};
+    
+    std::shared_ptr<helpers::process_table> processes;
+    std::vector<helpers::process_info> process_rows;
+    uint64_t process_generation = 0;
+    int sort_column = 3;            // CPU%
+    bool sort_descending = true;
 };
 
 } // namespace rouen::cards
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
-#include <deque>
+#include <cstdint>
 #include <format>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <thread>
@@ -31,6 +35,10 @@
 #include "../../helpers/api_keys.hpp"
 #include "../../helpers/cppgpt.hpp"
 #include "../../helpers/fetch.hpp"
+#include "../../helpers/memory_accounting.hpp"
+#include "../../helpers/scrollback_buffer.hpp"
+#include "../../helpers/session_log.hpp"
+#include "../../helpers/task_scheduler.hpp"
 
 // Define terminal-specific logging macros
 #define TERM_ERROR(message) LOG_COMPONENT("TERM", LOG_LEVEL_ERROR, message)
@@ -66,7 +74,7 @@ public:
         // Set window title and properties
         name("Terminal");
         width = 600.0f;                  // Default width
-        requested_fps = 30;              // High refresh rate for smoother output
+        requested_fps = 0;               // Output and Grok's reply invalidate as they arrive
         
         // Initialize working directory
         if (initial_dir.empty()) {
@@ -81,7 +89,7 @@ public:
         // Add initial welcome message
         add_to_output(std::format("Interactive Bash Terminal initialized in {}", current_working_dir), OutputType::System);
         add_to_output("Type commands and press Enter to execute. Use Up/Down arrows for history.", OutputType::System);
-        add_to_output("Press Ctrl+Enter to use Grok AI to convert natural language to Bash commands.", OutputType::System);
+        add_to_output("Press Ctrl+Enter to use Grok AI to convert natural language to Bash commands (Ctrl+C stops it).", OutputType::System);
         add_to_output("", OutputType::Blank);
         
         // Add prompt
@@ -89,6 +97,8 @@ public:
     }
     
     ~terminal() override {
+        search_stop.request_stop();
+        ai_thread.request_stop();
         // Stop all running processes and terminate the bash session
         terminate_bash_session();
     }
@@ -111,43 +121,81 @@ public:
                 test_stderr_output();
             }
             
-            // Render the output area (taking most of the space)
-            if (ImGui::BeginChild("OutputScrollRegion", ImVec2(window_width, -footer_height), true)) {
+            // Ctrl+F searches the scrollback, or the whole session log when there is one
+            if (ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows) && ImGui::GetIO().KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_F)) {
+                search_open = true;
+                focus_search = true;
+            }
+            if (search_open) {
+                render_search_bar(window_width);
+            }
+            
+            // Ctrl+C abandons a Grok reply still streaming in; a finished one runs from here
+            if (ai_running && ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows) && ImGui::GetIO().KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_C)) {
+                cancel_ai_request();
+            }
+            std::optional<std::string> generated;
+            {
+                std::lock_guard<std::mutex> lock(output_mutex);
+                generated.swap(ai_command);
+            }
+            if (generated) {
+                execute_command(*generated);
+            }
+            
+            // Render the output area (taking most of the space); lines aren't wrapped, so they
+            // all have one height and only the visible ones are drawn
+            if (ImGui::BeginChild("OutputScrollRegion", ImVec2(window_width, -footer_height), true, ImGuiWindowFlags_HorizontalScrollbar)) {
                 // Process any output from running commands
                 check_command_output();
                 
                 // Display output buffer
                 std::lock_guard<std::mutex> lock(output_mutex);
-                for (const auto& [text, type] : output_buffer) {
-                    switch (type) {
-                        case OutputType::Command:
-                            ImGui::PushStyleColor(ImGuiCol_Text, colors[6]);
-                            break;
-                        case OutputType::StdOut:
-                            ImGui::PushStyleColor(ImGuiCol_Text, colors[2]);
-                            break;
-                        case OutputType::StdErr:
-                            ImGui::PushStyleColor(ImGuiCol_Text, colors[4]);
-                            break;
-                        case OutputType::System:
-                            ImGui::PushStyleColor(ImGuiCol_Text, colors[5]);
-                            break;
-                        case OutputType::Prompt:
-                            ImGui::PushStyleColor(ImGuiCol_Text, colors[3]);
-                            break;
-                        case OutputType::Blank:
-                            ImGui::Spacing();
-                            continue;
-                        default:
-                            ImGui::PushStyleColor(ImGuiCol_Text, colors[2]);
+                auto const line_height = ImGui::GetTextLineHeightWithSpacing();
+                bool const at_bottom = ImGui::GetScrollY() >= ImGui::GetScrollMaxY() - 20.0f;
+                
+                // Lines dropped off the front since the last frame would shift what is being read
+                auto const dropped = output_buffer.dropped();
+                if (!should_auto_scroll && !at_bottom && dropped > rendered_dropped) {
+                    ImGui::SetScrollY(std::max(0.0f, ImGui::GetScrollY() - line_height * static_cast<float>(dropped - rendered_dropped)));
+                }
+                rendered_dropped = dropped;
+                
+                // A match to show that is still in the scrollback: bring it to the middle
+                auto const current_hit = search_open ? current_search_line() : std::nullopt;
+                if (scroll_to_hit && current_hit && *current_hit >= dropped && *current_hit - dropped < output_buffer.size()) {
+                    auto const row = static_cast<float>(*current_hit - dropped);
+                    ImGui::SetScrollY(std::max(0.0f, row * line_height - ImGui::GetWindowHeight() / 2));
+                    scroll_to_hit = false;
+                }
+                
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(output_buffer.size()), line_height);
+                while (clipper.Step()) {
+                    for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                        auto const [text, tag] = output_buffer.line(static_cast<size_t>(i));
+                        if (current_hit && *current_hit == dropped + static_cast<uint64_t>(i)) {
+                            auto const from = ImGui::GetCursorScreenPos();
+                            ImGui::GetWindowDrawList()->AddRectFilled(from,
+                                ImVec2(from.x + std::max(ImGui::GetContentRegionAvail().x, ImGui::CalcTextSize(text.data(), text.data() + text.size()).x),
+                                       from.y + line_height),
+                                ImGui::GetColorU32(ImGuiCol_TextSelectedBg));
+                        }
+                        ImGui::PushStyleColor(ImGuiCol_Text, color_of(static_cast<OutputType>(tag)));
+                        ImGui::TextUnformatted(text.data(), text.data() + text.size());
+                        ImGui::PopStyleColor();
                     }
-                    
-                    ImGui::TextWrapped("%s", text.c_str());
+                }
+                
+                // The line of a streaming reply that hasn't ended yet
+                if (!ai_partial.empty()) {
+                    ImGui::PushStyleColor(ImGuiCol_Text, color_of(OutputType::System));
+                    ImGui::TextUnformatted(ai_partial.data(), ai_partial.data() + ai_partial.size());
                     ImGui::PopStyleColor();
                 }
                 
                 // Auto-scroll to the bottom if needed
-                if (should_auto_scroll || ImGui::GetScrollY() >= ImGui::GetScrollMaxY() - 20.0f) {
+                if ((should_auto_scroll || at_bottom) && !(search_open && current_hit)) {
                     ImGui::SetScrollHereY(1.0f);
                     should_auto_scroll = false;
                 }
@@ -165,15 +213,172 @@ public:
                 render_command_input(window_width);
             }
             
-            // Status indicator for running processes
-            if (is_command_running) {
+            // Status indicator for running processes; it keeps turning only while one runs
+            if (is_command_running || ai_running) {
                 ImGui::SameLine();
                 ImGui::TextColored(colors[3], "%c", spinner_chars[(spinner_counter/5) % 4]);
                 spinner_counter++;
             }
+            requested_fps = is_command_running || ai_running ? 20 : 0;
         });
     }
     
+    // Render the find bar: Enter for the next match, Shift+Enter the previous, Escape closes
+    void render_search_bar(float window_width) {
+        if (focus_search) {
+            ImGui::SetKeyboardFocusHere();
+            focus_search = false;
+        }
+        ImGui::SetNextItemWidth(window_width * 0.5f);
+        bool const entered = ImGui::InputTextWithHint("##TerminalSearch", "Find", search_buffer, IM_ARRAYSIZE(search_buffer),
+            ImGuiInputTextFlags_EnterReturnsTrue);
+        ImGui::SameLine();
+        if (ImGui::Checkbox("Aa", &search_match_case)) {
+            searched_for.clear();
+        }
+        
+        if (entered) {
+            std::string_view const query {search_buffer};
+            if (query != searched_for || search_match_case != searched_match_case) {
+                start_search(std::string{query});
+            } else {
+                step_search(ImGui::GetIO().KeyShift ? -1 : 1);
+            }
+            focus_search = true;
+        }
+        if (ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows) && ImGui::IsKeyPressed(ImGuiKey_Escape)) {
+            close_search();
+            return;
+        }
+        
+        ImGui::SameLine();
+        {
+            std::lock_guard<std::mutex> lock(search->mutex);
+            if (search->running) {
+                ImGui::TextUnformatted("searching...");
+            } else if (!searched_for.empty()) {
+                if (search->lines.empty()) {
+                    ImGui::TextUnformatted("no matches");
+                } else {
+                    ImGui::Text("%zu of %zu%s", search_index + 1, search->lines.size(),
+                                search->lines.size() >= search_limit ? "+" : "");
+                }
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("x")) {
+            close_search();
+            return;
+        }
+        
+        // A match older than the scrollback is only in the log: show it with its neighbours
+        auto const hit = current_search_line();
+        std::lock_guard<std::mutex> lock(output_mutex);
+        if (hit && history_log && *hit < output_buffer.dropped()) {
+            ImGui::TextDisabled("Line %llu, from the session log:", static_cast<unsigned long long>(*hit + 1));
+            for (auto line = *hit >= 2 ? *hit - 2 : 0; line <= *hit + 2; ++line) {
+                auto const [text, tag] = history_log->line(line);
+                ImGui::PushStyleColor(ImGuiCol_Text, line == *hit ? colors[5] : color_of(static_cast<OutputType>(tag)));
+                ImGui::TextUnformatted(text.data(), text.data() + text.size());
+                ImGui::PopStyleColor();
+            }
+        }
+    }
+    
+    // Matches are found on a worker when there is a log (it can be gigabytes), else right here
+    void start_search(std::string query) {
+        search_stop.request_stop();
+        searched_for = query;
+        searched_match_case = search_match_case;
+        search_index = 0;
+        scroll_to_hit = true;
+        {
+            std::lock_guard<std::mutex> lock(search->mutex);
+            search->lines.clear();
+            search->running = static_cast<bool>(history_log);
+        }
+        if (query.empty()) {
+            std::lock_guard<std::mutex> lock(search->mutex);
+            search->running = false;
+            return;
+        }
+        
+        if (!history_log) {
+            std::vector<uint64_t> lines;
+            {
+                std::lock_guard<std::mutex> lock(output_mutex);
+                for (size_t i = 0; i < output_buffer.size() && lines.size() < search_limit; ++i) {
+                    auto const text = output_buffer.line(i).text;
+                    if (rouen::helpers::find_bytes(text.data(), text.data() + text.size(), query, search_match_case)) {
+                        lines.push_back(output_buffer.dropped() + i);
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lock(search->mutex);
+            search->lines = std::move(lines);
+            search_index = search->lines.empty() ? 0 : search->lines.size() - 1;   // the latest first
+            return;
+        }
+        
+        // The task holds the log and the results, not the card, which may be closed meanwhile
+        search_stop = std::stop_source{};
+        rouen::helpers::scheduler()->submit(
+            [log = history_log, results = search, query, match_case = search_match_case](std::stop_token stoken) {
+                std::vector<uint64_t> lines;
+                for (auto const& hit : log->find(query, match_case, search_limit, stoken)) {
+                    if (lines.empty() || lines.back() != hit.line) {
+                        lines.push_back(hit.line);
+                    }
+                }
+                if (stoken.stop_requested()) {
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(results->mutex);
+                    results->lines = std::move(lines);
+                    results->running = false;
+                    results->fresh = true;
+                }
+                rouen::helpers::request_redraw();
+            },
+            rouen::helpers::task_priority::high, search_stop);
+    }
+    
+    void step_search(int direction) {
+        std::lock_guard<std::mutex> lock(search->mutex);
+        if (search->lines.empty()) {
+            return;
+        }
+        auto const count = search->lines.size();
+        search_index = (search_index + (direction > 0 ? 1 : count - 1)) % count;
+        scroll_to_hit = true;
+    }
+    
+    std::optional<uint64_t> current_search_line() {
+        std::lock_guard<std::mutex> lock(search->mutex);
+        if (search->fresh) {
+            // Results that just arrived start at the latest match
+            search->fresh = false;
+            search_index = search->lines.empty() ? 0 : search->lines.size() - 1;
+            scroll_to_hit = true;
+        }
+        if (search_index >= search->lines.size()) {
+            return std::nullopt;
+        }
+        return search->lines[search_index];
+    }
+    
+    void close_search() {
+        search_stop.request_stop();
+        search_open = false;
+        searched_for.clear();
+        search_index = 0;
+        std::lock_guard<std::mutex> lock(search->mutex);
+        search->lines.clear();
+        search->running = false;
+        focus_input = true;
+    }
+    
     // Render the sudo password prompt
     void render_sudo_prompt(float window_width) {
         ImGui::PushStyleColor(ImGuiCol_FrameBg, colors[7]);
@@ -274,7 +479,7 @@ public:
     }
     
 private:
-    enum class OutputType {
+    enum class OutputType : uint8_t {
         StdOut,     // Standard output (white)
         StdErr,     // Error output (red)
         Command,    // Commands entered by user (blue)
@@ -283,15 +488,28 @@ private:
         Blank       // Empty line
     };
     
-    void add_to_output(const std::string& text, OutputType type) {
-        std::lock_guard<std::mutex> lock(output_mutex);
-        output_buffer.emplace_back(text, type);
-        
-        // Keep buffer from growing too large (max 500 lines)
-        if (output_buffer.size() > 500) {
-            output_buffer.pop_front();
+    ImVec4 const& color_of(OutputType type) const {
+        switch (type) {
+            case OutputType::Command: return colors[6];
+            case OutputType::StdErr:  return colors[4];
+            case OutputType::System:  return colors[5];
+            case OutputType::Prompt:  return colors[3];
+            default:                  return colors[2];
         }
-        
+    }
+    
+    // Under output_mutex. The scrollback drops its oldest lines by itself once full; the
+    // session log, when there is one, keeps them all, numbered the same way
+    void append_line(std::string_view text, OutputType type) {
+        output_buffer.append(text, static_cast<uint8_t>(type));
+        if (history_log) {
+            history_log->append(text, static_cast<uint8_t>(type));
+        }
+    }
+    
+    void add_to_output(std::string_view text, OutputType type) {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        append_line(text, type);
         should_auto_scroll = true;
     }
     
@@ -299,14 +517,8 @@ private:
     void add_multiple_outputs(const std::vector<std::pair<std::string, OutputType>>& entries) {
         std::lock_guard<std::mutex> lock(output_mutex);
         for (const auto& [text, type] : entries) {
-            output_buffer.emplace_back(text, type);
+            append_line(text, type);
         }
-        
-        // Keep buffer from growing too large (max 500 lines)
-        while (output_buffer.size() > 500) {
-            output_buffer.pop_front();
-        }
-        
         should_auto_scroll = true;
     }
     
@@ -314,14 +526,14 @@ private:
     void clear_terminal() {
         std::lock_guard<std::mutex> lock(output_mutex);
         output_buffer.clear();
-        output_buffer.emplace_back("Terminal cleared.", OutputType::System);
-        output_buffer.emplace_back("", OutputType::Blank);
+        append_line("Terminal cleared.", OutputType::System);
+        append_line("", OutputType::Blank);
         
         // Get current working directory from bash
         update_cwd_from_bash();
         
         // Add prompt with updated working directory
-        output_buffer.emplace_back(std::format("{}$ ", current_working_dir), OutputType::Prompt);
+        append_line(std::format("{}$ ", current_working_dir), OutputType::Prompt);
         should_auto_scroll = true;
     }
     
@@ -515,90 +727,120 @@ private:
 #endif
     }
     
-    // Reader thread for bash output stream (stdout or stderr)
+    // Reader thread for bash output stream (stdout or stderr). Each read (up to 64 KiB) is
+    // split on newlines with memchr, which glibc vectorizes, into views of the read buffer;
+    // the lines go into the scrollback together under one lock, copied only into its arena
     void read_bash_stream(std::stop_token stoken, int pipe_fd, OutputType output_type) {
 #ifndef _WIN32
         if (pipe_fd < 0) return;
         
-        char buffer[4096];
-        std::string accumulated_output;
+        static constexpr size_t read_chunk = 64 * 1024;
+        std::vector<char> buffer(read_chunk);
+        std::string partial;                    // the last read's unterminated line
+        std::string joined;                     // partial plus the rest of it from this read
+        std::vector<std::string_view> batch;    // this read's lines, not yet published
         bool command_running = false;
+        auto const stream_name = output_type == OutputType::StdOut ? "stdout" : "stderr";
         
         // Set up poll structure to check for data
         struct pollfd pfd;
         pfd.fd = pipe_fd;
         pfd.events = POLLIN;
         
+        // A marker line acts on the output, so the lines before it go out first
+        auto publish = [&] {
+            if (batch.empty()) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(output_mutex);
+                for (auto line : batch) {
+                    append_line(line, output_type);
+                }
+                should_auto_scroll = true;
+            }
+            batch.clear();
+            invalidate();
+        };
+        
+        auto handle_line = [&](std::string_view line) {
+            // Filter out job control warning messages ("bash: cannot set terminal process group ...")
+            if (line.starts_with("bash: ") &&
+                (line.find("cannot set terminal process group") != std::string_view::npos ||
+                 line.find("no job control in shell") != std::string_view::npos)) {
+                return;
+            }
+            
+            // Special handling for stdout stream
+            if (output_type == OutputType::StdOut && (!command_running || line.starts_with("ROUEN_"))) {
+                // Check for special markers
+                if (line.starts_with("ROUEN_PROMPT|")) {
+                    // Bash prompt - indicates command has finished
+                    publish();
+                    is_command_running = false;
+                    command_running = false;
+                    
+                    // Update current working directory
+                    update_cwd_from_bash();
+                    
+                    // Add prompt to output
+                    add_to_output("", OutputType::Blank);
+                    add_prompt();
+                    return;
+                } else if (line == "ROUEN_CMD_DONE") {
+                    // End marker for command output
+                    is_command_running = false;
+                    command_running = false;
+                    return;
+                } else if (!command_running && 
+                          (line.empty() || line.find("bash") != std::string_view::npos || 
+                           line.find("TERM=") != std::string_view::npos)) {
+                    // Ignore initial bash startup messages
+                    return;
+                }
+            }
+            
+            // Regular output line - stdout or stderr
+            command_running = true;
+            batch.push_back(line);
+        };
+        
         while (!stoken.stop_requested()) {
-            // Poll with a short timeout
-            int poll_result = poll(&pfd, 1, 10); // 10ms timeout
+            // The timeout only bounds how long a stop request waits
+            int poll_result = poll(&pfd, 1, 100);
             
-            if (poll_result > 0 && (pfd.revents & POLLIN)) {
+            if (poll_result > 0 && (pfd.revents & (POLLIN | POLLHUP))) {
                 // Data is available to read
-                ssize_t bytes_read = read(pipe_fd, buffer, sizeof(buffer) - 1);
+                ssize_t bytes_read = read(pipe_fd, buffer.data(), buffer.size());
                 
                 if (bytes_read > 0) {
-                    // Null-terminate the buffer
-                    buffer[bytes_read] = '\0';
-                    
-                    // Add to accumulated output
-                    accumulated_output += buffer;
-                    
-                    // Process accumulated output line by line
-                    size_t pos = 0;
-                    size_t end_line;
-                    
-                    while ((end_line = accumulated_output.find('\n', pos)) != std::string::npos) {
-                        // Extract line
-                        std::string line = accumulated_output.substr(pos, end_line - pos);
-                        pos = end_line + 1;
-                        
-                        // Filter out job control warning messages
-                        if (line.find("cannot set terminal process group") != std::string::npos ||
-                            line.find("no job control in shell") != std::string::npos) {
-                            // Skip these bash startup warning messages
-                            continue;
-                        }
-                        
-                        // Special handling for stdout stream
-                        if (output_type == OutputType::StdOut) {
-                            // Check for special markers
-                            if (line.starts_with("ROUEN_PROMPT|")) {
-                                // Bash prompt - indicates command has finished
-                                is_command_running = false;
-                                command_running = false;
-                                
-                                // Update current working directory
-                                update_cwd_from_bash();
-                                
-                                // Add prompt to output
-                                add_to_output("", OutputType::Blank);
-                                add_prompt();
-                                continue;
-                            } else if (line == "ROUEN_CMD_DONE") {
-                                // End marker for command output
-                                is_command_running = false;
-                                command_running = false;
-                                continue;
-                            } else if (!command_running && 
-                                      (line.empty() || line.find("bash") != std::string::npos || 
-                                       line.find("TERM=") != std::string::npos)) {
-                                // Ignore initial bash startup messages
-                                continue;
-                            }
+                    char const* begin = buffer.data();
+                    char const* const end = begin + bytes_read;
+                    while (auto const* newline = static_cast<char const*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)))) {
+                        std::string_view line {begin, static_cast<size_t>(newline - begin)};
+                        if (!partial.empty()) {
+                            // Only the first line of a read can continue the last one
+                            joined.assign(partial).append(line);
+                            partial.clear();
+                            line = joined;
                         }
-                        
-                        // Regular output line - stdout or stderr
-                        command_running = true;
-                        add_to_output(line, output_type);
+                        handle_line(line);
+                        begin = newline + 1;
                     }
+                    publish();
                     
-                    // Keep any remaining partial line
-                    accumulated_output.erase(0, pos);
+                    // Keep any remaining partial line; one that never ends (progress bars
+                    // redrawn with \r) goes out once it is a chunk long
+                    partial.append(begin, end);
+                    if (partial.size() >= read_chunk) {
+                        handle_line(partial);
+                        publish();
+                        partial.clear();
+                    }
                     
                 } else if (bytes_read == 0) {
                     // EOF - bash has closed the pipe
-                    TERM_WARN_FMT("Bash {} stream closed unexpectedly", output_type == OutputType::StdOut ? "stdout" : "stderr");
+                    TERM_WARN_FMT("Bash {} stream closed unexpectedly", stream_name);
                     break;
                 } else if (bytes_read < 0) {
                     if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -606,25 +848,21 @@ private:
                         continue;
                     } else {
                         // Error
-                        TERM_ERROR_FMT("Error reading from bash {}: {}", 
-                            output_type == OutputType::StdOut ? "stdout" : "stderr", 
-                            strerror(errno));
+                        TERM_ERROR_FMT("Error reading from bash {}: {}", stream_name, strerror(errno));
                         break;
                     }
                 }
             } else if (poll_result < 0) {
                 // Poll error
                 if (errno != EINTR) {
-                    TERM_ERROR_FMT("Poll error on bash {}: {}", 
-                        output_type == OutputType::StdOut ? "stdout" : "stderr", 
-                        strerror(errno));
+                    TERM_ERROR_FMT("Poll error on bash {}: {}", stream_name, strerror(errno));
                     break;
                 }
             }
             // Poll timeout or no data - just continue
         }
         
-        TERM_INFO_FMT("Bash {} reader thread exiting", output_type == OutputType::StdOut ? "stdout" : "stderr");
+        TERM_INFO_FMT("Bash {} reader thread exiting", stream_name);
 #endif
     }
     
@@ -665,18 +903,12 @@ private:
     
     // Execute command with sudo if needed
     void execute_command(const std::string& command, bool use_llm = false) {
-        // If use_llm is true, generate a shell command using Grok
-        std::string cmd_to_execute = command;
-        
+        // If use_llm is true, Grok turns it into a shell command first; that comes back here once streamed
         if (use_llm) {
-            std::string generated_cmd = generate_shell_command(command);
-            if (!generated_cmd.empty()) {
-                cmd_to_execute = generated_cmd;
-            } else {
-                // If command generation failed, fallback to original command
-                add_to_output("Failed to generate command with Grok. Using original command.", OutputType::StdErr);
-            }
+            start_ai_request(command);
+            return;
         }
+        std::string cmd_to_execute = command;
         
         // Check if command needs sudo privileges
         if (cmd_to_execute.starts_with("sudo ")) {
@@ -721,19 +953,62 @@ private:
         }
     }
     
-    // Use Grok to generate a shell command from a natural language description
-    std::string generate_shell_command(const std::string& description) {
+    // Ask Grok for a shell command matching a natural language description. The reply streams
+    // into the scrollback on ai_thread; the command it settles on is run by render()
+    void start_ai_request(const std::string& description) {
+        if (ai_running) {
+            add_to_output("Grok is still answering; press Ctrl+C to stop it.", OutputType::System);
+            return;
+        }
+        
         // Get Grok API key using our centralized API key manager
         std::string api_key = rouen::helpers::ApiKeys::get_grok_api_key();
         if (api_key.empty()) {
             add_to_output("Error: GROK_API_KEY environment variable is not set.", OutputType::StdErr);
-            return "";
+            add_to_output("Failed to generate command with Grok. Using original command.", OutputType::StdErr);
+            execute_command(description);
+            return;
         }
         
+        add_to_output("Generating shell command with Grok AI...", OutputType::System);
+        ai_running = true;
+        ai_thread = std::jthread([this, description, api_key](std::stop_token stoken) {
+            generate_shell_command(stoken, description, api_key);
+        });
+    }
+    
+    void cancel_ai_request() {
+        ai_thread.request_stop();
+        std::lock_guard<std::mutex> lock(output_mutex);
+        flush_ai_partial();
+        append_line("Grok request cancelled.", OutputType::System);
+        should_auto_scroll = true;
+    }
+    
+    // Under output_mutex: whole lines of the reply go to the scrollback, the rest waits in ai_partial
+    void stream_ai_text(std::string_view text) {
+        for (size_t newline; (newline = text.find('\n')) != std::string_view::npos; text.remove_prefix(newline + 1)) {
+            ai_partial.append(text.substr(0, newline));
+            flush_ai_partial();
+        }
+        ai_partial.append(text);
+        should_auto_scroll = true;
+    }
+    
+    // Under output_mutex
+    void flush_ai_partial() {
+        if (!ai_partial.empty()) {
+            append_line(ai_partial, OutputType::System);
+            ai_partial.clear();
+        }
+    }
+    
+    // On ai_thread. Once stop is requested nothing more reaches the output: cancel_ai_request()
+    // has already closed the reply off
+    void generate_shell_command(std::stop_token const& stoken, std::string const& description, std::string const& api_key) {
+        std::string command;
+        std::string error;
         try {
-            // Add a loader to indicate processing
-            add_to_output("Generating shell command with Grok AI...", OutputType::System);
-            
             // Initialize Grok client
             ignacionr::cppgpt gpt(api_key, ignacionr::cppgpt::grok_base);
             
@@ -745,29 +1020,54 @@ private:
                 "directly in a Linux terminal. Ensure the command is safe and efficient."
             );
             
-            // Send the request to Grok
+            // Send the request to Grok; a stop aborts the transfer at its next chunk
             http::fetch fetcher;
-            auto response = gpt.sendMessage(
+            command = gpt.sendMessageStream(
                 description,
-                [&fetcher](const std::string& url, const std::string& data, auto header_client) {
-                    return fetcher.post(url, data, header_client);
+                [&fetcher, &stoken](const std::string& url, const std::string& data, auto header_client,
+                                    std::function<bool(std::string_view)> on_chunk) {
+                    http::callback_sink sink{[&stoken, &on_chunk](std::string_view chunk) {
+                        return !stoken.stop_requested() && on_chunk(chunk);
+                    }};
+                    fetcher.post_stream(url, data, header_client, sink);
+                },
+                [this, &stoken](std::string_view delta) {
+                    std::lock_guard<std::mutex> lock(output_mutex);
+                    if (stoken.stop_requested()) {
+                        return false;
+                    }
+                    stream_ai_text(delta);
+                    invalidate();
+                    return true;
                 },
                 "user",
                 "grok-2-latest"
             );
             
-            // Extract the command from the response
-            std::string command = response.choices[0].message.content;
-            
             // Clean up the command (remove quotes, backticks, etc.)
-            command = command.substr(command.find_first_not_of(" \t\n`"));
-            command = command.substr(0, command.find_last_not_of(" \t\n`") + 1);
-            
-            return command;
+            auto const first = command.find_first_not_of(" \t\n`");
+            command = first == std::string::npos ? std::string{} : command.substr(first, command.find_last_not_of(" \t\n`") + 1 - first);
         } catch (const std::exception& e) {
-            add_to_output(std::format("Error generating command: {}", e.what()), OutputType::StdErr);
-            return "";
+            error = e.what();
+            command.clear();
+        }
+        
+        std::lock_guard<std::mutex> lock(output_mutex);
+        if (!stoken.stop_requested()) {
+            flush_ai_partial();
+            if (!error.empty()) {
+                append_line(std::format("Error generating command: {}", error), OutputType::StdErr);
+            }
+            if (command.empty()) {
+                // If command generation failed, fallback to original command
+                append_line("Failed to generate command with Grok. Using original command.", OutputType::StdErr);
+                command = description;
+            }
+            ai_command = std::move(command);
+            should_auto_scroll = true;
         }
+        ai_running = false;
+        invalidate();
     }
     
     void execute_external_command(const std::string& command) {
@@ -953,8 +1253,28 @@ private:
     bool show_sudo_prompt = false;
     std::string sudo_command;  // Stores the command to run after sudo authentication
     
-    using OutputEntry = std::pair<std::string, OutputType>;
-    std::deque<OutputEntry> output_buffer;
+    rouen::helpers::scrollback_buffer output_buffer;   // lines tagged with their OutputType
+    uint64_t rendered_dropped = 0;                     // output_buffer.dropped() as of the last frame
+    std::shared_ptr<rouen::helpers::session_log> history_log {rouen::helpers::session_log::open_from_env("terminal")};
+    
+    // Find bar; the lines matching are overall line numbers, as output_buffer.dropped() + i
+    struct search_results {
+        std::mutex mutex;
+        std::vector<uint64_t> lines;
+        bool running = false;
+        bool fresh = false;         // just arrived from the worker
+    };
+    static constexpr size_t search_limit = 100000;
+    bool search_open = false;
+    bool focus_search = false;
+    bool search_match_case = false;
+    bool searched_match_case = false;
+    bool scroll_to_hit = false;
+    char search_buffer[256] = "";
+    std::string searched_for;
+    size_t search_index = 0;
+    std::shared_ptr<search_results> search {std::make_shared<search_results>()};
+    std::stop_source search_stop;
     std::mutex output_mutex;
     std::mutex command_pipe_mutex; // Mutex for synchronizing access to command_pipe
     
@@ -978,6 +1298,16 @@ private:
     int spinner_counter = 0;
     const char spinner_chars[4] = {'|', '/', '-', '\\'};
     
+    // Ctrl+Enter: Grok's reply streams in on ai_thread
+    std::string ai_partial;                     // under output_mutex: the reply since its last newline
+    std::optional<std::string> ai_command;      // under output_mutex: the command to run on the UI thread
+    std::atomic<bool> ai_running {false};
+    rouen::helpers::memory::report scrollback_report {"terminal scrollback", [this] {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        return output_buffer.bytes();
+    }};
+    std::jthread ai_thread;                     // last, so it's stopped and joined before what it writes to goes
+    
     // Restart bash session with sudo privileges
     void restart_with_sudo(const char* password) {
 #ifndef _WIN32
@@ -1,12 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include "../helpers/imgui_include.hpp"
 #include <SDL.h>
-#include <SDL_image.h>
 
 #include "editor_interface.hpp"
-#include "../helpers/texture_helper.hpp"
+#include "tiled_image.hpp"
 #include "../registrar.hpp"
 
 namespace rouen {
@@ -17,9 +18,6 @@ public:
     ImageEditor() 
         : 
           should_focus_{false}
-        , image_texture_{nullptr}
-        , image_width_{0}
-        , image_height_{0}
     {
         // Initialize colors
         error_color = {1.0f, 0.0f, 0.0f, 1.0f};   // Red error text
@@ -33,12 +31,7 @@ public:
         }
     }
     
-    virtual ~ImageEditor() {
-        if (image_texture_) {
-            SDL_DestroyTexture(image_texture_);
-            image_texture_ = nullptr;
-        }
-    }
+    virtual ~ImageEditor() = default;
 
     bool empty() const override {
         return source_file_.empty();
@@ -47,13 +40,7 @@ public:
     void clear() override {
         source_file_.clear();
         error_.clear();
-        
-        if (image_texture_) {
-            SDL_DestroyTexture(image_texture_);
-            image_texture_ = nullptr;
-            image_width_ = 0;
-            image_height_ = 0;
-        }
+        image_.reset();
     }
 
     void select(const std::string& uri) override {
@@ -63,27 +50,13 @@ public:
         should_focus_ = true;
         
         // Clear previous resources
-        if (image_texture_) {
-            SDL_DestroyTexture(image_texture_);
-            image_texture_ = nullptr;
-            image_width_ = 0;
-            image_height_ = 0;
-        }
-        
+        image_.reset();
+        zoom_ = 0.0f;
         error_.clear();
         
         if (renderer_) {
-            // Load image as texture
-            image_texture_ = TextureHelper::loadTextureFromFile(
-                renderer_,
-                uri.c_str(),
-                image_width_,
-                image_height_
-            );
-            
-            if (!image_texture_) {
-                error_ = "Failed to load image: " + std::string(SDL_GetError());
-            }
+            // Decoded off the UI thread; shown in tiles, so any size fits
+            image_ = std::make_unique<TiledImage>(renderer_, uri);
         } else {
             error_ = "Cannot load image: SDL renderer not available";
         }
@@ -95,37 +68,63 @@ public:
     }
 
     void render() override {
-        if (!image_texture_ && error_.empty()) {
+        if (!image_ && error_.empty()) {
             return;
         }
+        if (image_ && image_->state() == TiledImage::State::failed) {
+            error_ = image_->error();
+            image_.reset();
+        }
 
         if (!error_.empty()) {
             ImGui::TextColored(error_color, "Error: %s", error_.c_str());
         }
-        else if (image_texture_) {
-            // Display the image
+        else if (image_->state() == TiledImage::State::loading) {
+            ImGui::TextUnformatted("Loading image...");
+        }
+        else {
             ImGui::Separator();
-            
-            // Calculate the display size while maintaining aspect ratio
-            ImVec2 content_size = ImGui::GetContentRegionAvail();
-            float aspect_ratio = static_cast<float>(image_width_) / static_cast<float>(image_height_);
-            
-            ImVec2 display_size;
-            if (content_size.x / aspect_ratio <= content_size.y) {
-                // Width constrained
-                display_size = ImVec2(content_size.x, content_size.x / aspect_ratio);
-            } else {
-                // Height constrained
-                display_size = ImVec2(content_size.y * aspect_ratio, content_size.y);
+            ImGui::Text("%d x %d  %.0f%%", image_->width(), image_->height(),
+                        (zoom_ > 0.0f ? zoom_ : fit_zoom(ImGui::GetContentRegionAvail())) * 100.0f);
+
+            // The canvas takes the mouse: wheel zooms around the pointer, drag pans, double-click fits
+            ImVec2 const canvas_size = ImGui::GetContentRegionAvail();
+            if (canvas_size.x < 1.0f || canvas_size.y < 1.0f) {
+                return;
+            }
+            ImVec2 const canvas_min = ImGui::GetCursorScreenPos();
+            ImVec2 const canvas_max {canvas_min.x + canvas_size.x, canvas_min.y + canvas_size.y};
+            ImGui::InvisibleButton("##image_canvas", canvas_size);
+
+            float const fit = fit_zoom(canvas_size);
+            if (zoom_ <= 0.0f) {
+                // Fit to the window, centred, as long as nobody zoomed
+                zoom_for_view_ = fit;
+                origin_ = {
+                    (image_->width() - canvas_size.x / fit) * 0.5f,
+                    (image_->height() - canvas_size.y / fit) * 0.5f
+                };
+            }
+            auto& io = ImGui::GetIO();
+            if (ImGui::IsItemHovered() && io.MouseWheel != 0.0f) {
+                float const zoom = zoom_ > 0.0f ? zoom_ : fit;
+                float const next = std::clamp(zoom * (io.MouseWheel > 0.0f ? 1.25f : 0.8f), std::min(fit, 1.0f) * 0.5f, 32.0f);
+                ImVec2 const mouse {io.MousePos.x - canvas_min.x, io.MousePos.y - canvas_min.y};
+                origin_.x += mouse.x / zoom - mouse.x / next;
+                origin_.y += mouse.y / zoom - mouse.y / next;
+                zoom_ = next;
+            }
+            if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+                float const zoom = zoom_ > 0.0f ? zoom_ : fit;
+                origin_.x -= io.MouseDelta.x / zoom;
+                origin_.y -= io.MouseDelta.y / zoom;
+                zoom_ = zoom;
             }
-            
-            // Center the image in the available space
-            ImVec2 pos = ImGui::GetCursorPos();
-            pos.x += (content_size.x - display_size.x) * 0.5f;
-            ImGui::SetCursorPos(pos);
-            
-            // Draw the image
-            ImGui::Image((ImTextureID)(intptr_t)image_texture_, display_size);
+            if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+                zoom_ = 0.0f;
+            }
+
+            image_->draw(ImGui::GetWindowDrawList(), canvas_min, canvas_max, origin_, zoom_ > 0.0f ? zoom_ : zoom_for_view_);
         }
     }
 
@@ -138,15 +137,21 @@ public:
     }
 
 private:
+    // The zoom that shows the whole image in `area`
+    float fit_zoom(ImVec2 area) const {
+        return std::min(area.x / std::max(1, image_->width()), area.y / std::max(1, image_->height()));
+    }
+
     std::string source_file_;
     std::string error_;
     bool should_focus_ = false;  // Flag to track when the window should grab focus
     
     // Image handling
     SDL_Renderer* renderer_ {nullptr};
-    SDL_Texture* image_texture_ {nullptr};
-    int image_width_ = 0;
-    int image_height_ = 0;
+    std::unique_ptr<TiledImage> image_;
+    float zoom_ {0.0f};             // screen pixels per image pixel; 0 = fit to the window
+    float zoom_for_view_ {1.0f};    // the fitted zoom, while zoom_ is 0
+    ImVec2 origin_ {0.0f, 0.0f};    // image pixel at the canvas corner
 
     // Color variable
     ImVec4 error_color;
@@ -0,0 +1,372 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rouen {
+namespace editor {
+
+/**
+ * A file too large to hold as glyph lines: the original is mapped read-only and never
+ * copied, and edits go in a piece table, a list of slices of either the mapping or an
+ * append-only buffer of added text. A background thread indexes the original's newlines;
+ * lines can be read as it goes, and edits wait until it has finished. Undo restores an
+ * earlier piece list, which stays valid because neither source ever changes.
+ * Lines are numbered from 0 and don't include their '\n'.
+ */
+class large_text {
+public:
+    explicit large_text(std::filesystem::path path) : path_(std::move(path)) {
+        fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), path_.string());
+        }
+        struct stat st {};
+        if (fstat(fd_, &st) != 0) {
+            auto const error = errno;
+            ::close(fd_);
+            throw std::system_error(error, std::generic_category(), path_.string());
+        }
+        size_ = static_cast<uint64_t>(st.st_size);
+        length_ = size_;
+        if (size_ > 0) {
+            void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (map == MAP_FAILED) {
+                auto const error = errno;
+                ::close(fd_);
+                throw std::system_error(error, std::generic_category(), "mmap " + path_.string());
+            }
+            madvise(map, size_, MADV_SEQUENTIAL);
+            original_ = static_cast<char const*>(map);
+            pieces_.push_back({false, 0, size_, 0});
+        }
+        indexer_ = std::jthread{[this](std::stop_token stoken) { index(stoken); }};
+    }
+
+    ~large_text() {
+        indexer_.request_stop();
+        if (indexer_.joinable()) {
+            indexer_.join();
+        }
+        if (original_) {
+            munmap(const_cast<char*>(original_), size_);
+        }
+        ::close(fd_);
+    }
+
+    large_text(large_text const&) = delete;
+    large_text& operator=(large_text const&) = delete;
+
+    [[nodiscard]] std::filesystem::path const& path() const { return path_; }
+    [[nodiscard]] bool indexed() const { return indexed_.load(std::memory_order_acquire); }
+    [[nodiscard]] float index_progress() const {
+        return size_ == 0 ? 1.0f : static_cast<float>(scanned_.load(std::memory_order_relaxed)) / static_cast<float>(size_);
+    }
+
+    // Bytes in the document as edited
+    [[nodiscard]] uint64_t bytes() const { return length_; }
+
+    // All lines once indexed; until then, the lines of the original indexed so far
+    [[nodiscard]] uint64_t lines() const {
+        if (!indexed()) {
+            std::shared_lock lock(index_mutex_);
+            return original_nl_.size();
+        }
+        uint64_t newlines = 0;
+        for (auto const& p : pieces_) {
+            newlines += p.newlines;
+        }
+        return newlines + 1;
+    }
+
+    // Line i, cut at max_bytes
+    [[nodiscard]] std::string line(uint64_t i, size_t max_bytes = std::numeric_limits<size_t>::max()) const {
+        if (!indexed()) {
+            std::shared_lock lock(index_mutex_);
+            if (i >= original_nl_.size()) {
+                return {};
+            }
+            auto const start = i == 0 ? 0 : original_nl_[i - 1] + 1;
+            auto const length = std::min<uint64_t>(original_nl_[i] - start, max_bytes);
+            return std::string{original_ + start, static_cast<size_t>(length)};
+        }
+        auto const start = line_start(i);
+        auto const length = std::min<uint64_t>(line_end(i) - start, max_bytes);
+        return read(start, length);
+    }
+
+    // Edits; all need the index, so they do nothing before indexed()
+    void replace_line(uint64_t i, std::string_view text) {
+        if (indexed() && i < lines()) {
+            auto const start = line_start(i);
+            replace(start, line_end(i) - start, text);
+        }
+    }
+
+    void insert_after(uint64_t i, std::string_view text) {
+        if (indexed() && i < lines()) {
+            std::string inserted{"\n"};
+            inserted += text;
+            replace(line_end(i), 0, inserted);
+        }
+    }
+
+    void erase_line(uint64_t i) {
+        auto const count = indexed() ? lines() : 0;
+        if (i >= count) {
+            return;
+        }
+        if (count == 1) {
+            replace(0, length_, {});
+        } else if (i + 1 < count) {
+            auto const start = line_start(i);
+            replace(start, line_start(i + 1) - start, {});
+        } else {
+            // The last line takes the newline before it along
+            auto const start = line_end(i - 1);
+            replace(start, length_ - start, {});
+        }
+    }
+
+    [[nodiscard]] bool can_undo() const { return !undo_.empty(); }
+    [[nodiscard]] bool can_redo() const { return !redo_.empty(); }
+    [[nodiscard]] bool modified() const { return revision_ != saved_revision_; }
+
+    void undo() {
+        if (!undo_.empty()) {
+            redo_.push_back(current());
+            restore(std::move(undo_.back()));
+            undo_.pop_back();
+        }
+    }
+
+    void redo() {
+        if (!redo_.empty()) {
+            undo_.push_back(current());
+            restore(std::move(redo_.back()));
+            redo_.pop_back();
+        }
+    }
+
+    /**
+     * Streams the pieces into a file beside the original and renames it over it, so a failed
+     * write leaves the original as it was. The mapping keeps the replaced file's pages, which
+     * the pieces still point into, until this document closes.
+     */
+    void save() {
+        auto const temp = std::filesystem::path{path_.string() + ".rouen-save"};
+        {
+            std::ofstream output{temp, std::ios::binary | std::ios::trunc};
+            if (!output) {
+                throw std::runtime_error("Could not open file for writing: " + temp.string());
+            }
+            for (auto const& p : pieces_) {
+                output.write(source(p) + p.offset, static_cast<std::streamsize>(p.length));
+            }
+            output.flush();
+            if (!output) {
+                std::error_code ignored;
+                std::filesystem::remove(temp, ignored);
+                throw std::runtime_error("Could not write " + temp.string());
+            }
+        }
+        std::error_code ec;
+        std::filesystem::permissions(temp, std::filesystem::status(path_, ec).permissions(), ec);
+        std::filesystem::rename(temp, path_);
+        saved_revision_ = revision_;
+    }
+
+private:
+    struct piece {
+        bool added;             // from added_, else from the original
+        uint64_t offset;        // in its source
+        uint64_t length;
+        uint64_t newlines;      // '\n's inside it
+    };
+
+    struct state {
+        std::vector<piece> pieces;
+        uint64_t length;
+        uint64_t revision;
+    };
+
+    void index(std::stop_token const& stoken) {
+        // Published in slices, so the first screen shows while the rest is scanned
+        constexpr uint64_t slice = 8u << 20;
+        std::vector<uint64_t> found;
+        for (uint64_t from = 0; from < size_ && !stoken.stop_requested(); from += slice) {
+            auto const to = std::min(size_, from + slice);
+            found.clear();
+            for (auto const* at = original_ + from;
+                 (at = static_cast<char const*>(std::memchr(at, '\n', static_cast<size_t>(original_ + to - at)))); ++at) {
+                found.push_back(static_cast<uint64_t>(at - original_));
+            }
+            {
+                std::unique_lock lock(index_mutex_);
+                original_nl_.insert(original_nl_.end(), found.begin(), found.end());
+            }
+            scanned_.store(to, std::memory_order_relaxed);
+        }
+        if (stoken.stop_requested()) {
+            return;
+        }
+        if (!pieces_.empty()) {
+            pieces_.front().newlines = original_nl_.size();
+        }
+        indexed_.store(true, std::memory_order_release);
+    }
+
+    char const* source(piece const& p) const {
+        return p.added ? added_.data() : original_;
+    }
+
+    std::vector<uint64_t> const& newlines_of(piece const& p) const {
+        return p.added ? added_nl_ : original_nl_;
+    }
+
+    uint64_t count_newlines(bool added, uint64_t offset, uint64_t length) const {
+        auto const& nl = added ? added_nl_ : original_nl_;
+        return static_cast<uint64_t>(std::ranges::lower_bound(nl, offset + length) - std::ranges::lower_bound(nl, offset));
+    }
+
+    // Offset just past the n-th newline of the document (n from 1), or length_ past the last
+    uint64_t after_newline(uint64_t n) const {
+        uint64_t at = 0;
+        for (auto const& p : pieces_) {
+            if (n <= p.newlines) {
+                auto const& nl = newlines_of(p);
+                auto const first = std::ranges::lower_bound(nl, p.offset) - nl.begin();
+                return at + (nl[static_cast<size_t>(first) + n - 1] - p.offset) + 1;
+            }
+            n -= p.newlines;
+            at += p.length;
+        }
+        return length_;
+    }
+
+    uint64_t line_start(uint64_t i) const {
+        return i == 0 ? 0 : after_newline(i);
+    }
+
+    uint64_t line_end(uint64_t i) const {
+        auto const next = after_newline(i + 1);
+        return next == length_ && i + 1 >= lines() ? length_ : next - 1;
+    }
+
+    std::string read(uint64_t offset, uint64_t length) const {
+        std::string text;
+        text.reserve(static_cast<size_t>(length));
+        uint64_t at = 0;
+        for (auto const& p : pieces_) {
+            if (length == 0) {
+                break;
+            }
+            if (offset < at + p.length) {
+                auto const skip = offset - at;
+                auto const take = std::min(length, p.length - skip);
+                text.append(source(p) + p.offset + skip, static_cast<size_t>(take));
+                offset += take;
+                length -= take;
+            }
+            at += p.length;
+        }
+        return text;
+    }
+
+    // Splits so a piece boundary falls at `offset`; the index of the piece starting there
+    size_t split(uint64_t offset) {
+        uint64_t at = 0;
+        for (size_t i = 0; i < pieces_.size(); ++i) {
+            auto const p = pieces_[i];
+            if (offset == at) {
+                return i;
+            }
+            if (offset < at + p.length) {
+                auto const head = offset - at;
+                pieces_[i] = {p.added, p.offset, head, count_newlines(p.added, p.offset, head)};
+                pieces_.insert(pieces_.begin() + static_cast<std::ptrdiff_t>(i) + 1,
+                               {p.added, p.offset + head, p.length - head, p.newlines - pieces_[i].newlines});
+                return i + 1;
+            }
+            at += p.length;
+        }
+        return pieces_.size();
+    }
+
+    void replace(uint64_t offset, uint64_t length, std::string_view text) {
+        undo_.push_back(current());
+        redo_.clear();
+
+        auto const first = split(offset);
+        auto const last = split(offset + length);
+        pieces_.erase(pieces_.begin() + static_cast<std::ptrdiff_t>(first), pieces_.begin() + static_cast<std::ptrdiff_t>(last));
+        if (!text.empty()) {
+            auto const at = static_cast<uint64_t>(added_.size());
+            added_.append(text);
+            for (size_t i = 0; i < text.size(); ++i) {
+                if (text[i] == '\n') {
+                    added_nl_.push_back(at + i);
+                }
+            }
+            pieces_.insert(pieces_.begin() + static_cast<std::ptrdiff_t>(first),
+                           {true, at, text.size(), count_newlines(true, at, text.size())});
+        }
+        length_ = length_ - length + text.size();
+        revision_ = ++last_revision_;
+    }
+
+    state current() const {
+        return {pieces_, length_, revision_};
+    }
+
+    void restore(state s) {
+        pieces_ = std::move(s.pieces);
+        length_ = s.length;
+        revision_ = s.revision;
+    }
+
+    std::filesystem::path path_;
+    int fd_ {-1};
+    char const* original_ {nullptr};
+    uint64_t size_ {0};                             // of the original
+
+    mutable std::shared_mutex index_mutex_;         // guards original_nl_ until indexed_
+    std::vector<uint64_t> original_nl_;             // offset of each '\n' in the original
+    std::atomic<uint64_t> scanned_ {0};
+    std::atomic<bool> indexed_ {false};
+
+    std::string added_;                             // append-only
+    std::vector<uint64_t> added_nl_;
+    std::vector<piece> pieces_;
+    uint64_t length_ {0};
+    std::vector<state> undo_;
+    std::vector<state> redo_;
+    uint64_t revision_ {0};
+    uint64_t last_revision_ {0};
+    uint64_t saved_revision_ {0};
+    std::jthread indexer_;                          // last, so it stops before the rest goes
+};
+
+} // namespace editor
+} // namespace rouen
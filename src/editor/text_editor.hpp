@@ -1,12 +1,19 @@
 #pragma once
 
+#include <climits>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
+#include <memory>
 #include <string>
+#include <vector>
 #include "../helpers/imgui_include.hpp"
 #include <TextEditor.h>
 
 #include "editor_interface.hpp"
+#include "large_text.hpp"
 #include "../fonts.hpp"
+#include "../helpers/redraw.hpp"
 
 namespace rouen {
 namespace editor {
@@ -33,6 +40,9 @@ public:
         // Use a dark palette
         ::TextEditor::Palette palette = text_editor_.GetDarkPalette();
         text_editor_.SetPalette(palette);
+
+        // Colors are computed off the render thread; show them as soon as they land
+        text_editor_.SetColorizeCallback([] { rouen::helpers::request_redraw(); });
     }
     
     bool empty() const override {
@@ -45,6 +55,8 @@ public:
         error_.clear();
         file_modified_ = false;
         save_message_.clear();
+        large_.reset();
+        editing_line_ = -1;
         
         text_editor_.SetText("");
         text_editor_.SetLanguageDefinition(::TextEditor::LanguageDefinition::CPlusPlus());
@@ -58,9 +70,20 @@ public:
         
         buffer_.clear();
         error_.clear();
+        large_.reset();
+        editing_line_ = -1;
         
         // Handle as text file
         try {
+            // Past the threshold the file is mapped and only the lines on screen are read
+            std::error_code ec;
+            auto const size = std::filesystem::file_size(uri, ec);
+            if (!ec && size >= large_file_threshold()) {
+                large_ = std::make_unique<large_text>(uri);
+                text_editor_.SetText("");
+                return;
+            }
+
             std::ifstream input{uri};
             if (!input) {
                 throw std::runtime_error("Could not open file: " + uri);
@@ -103,6 +126,13 @@ public:
         }
         
         try {
+            if (large_) {
+                large_->save();
+                save_message_ = "File saved successfully!";
+                save_message_time_ = 3.0f;
+                return true;
+            }
+
             // Get text from the TextEditor widget
             buffer_ = text_editor_.GetText();
             
@@ -131,6 +161,9 @@ public:
         if (!error_.empty()) {
             ImGui::TextColored(error_color, "Error: %s", error_.c_str());
         }
+        else if (large_) {
+            render_large();
+        }
         else {
             rouen::fonts::with_font fnt{rouen::fonts::FontType::Mono};
             // Create a child window for the text editor
@@ -155,19 +188,22 @@ public:
     }
 
     bool isModified() const {
-        return file_modified_;
+        return large_ ? large_->modified() : file_modified_;
     }
 
     // Expose text editor methods that might be needed by parent classes
-    bool canUndo() const { return text_editor_.CanUndo(); }
-    bool canRedo() const { return text_editor_.CanRedo(); }
-    bool hasSelection() const { return text_editor_.HasSelection(); }
-    void undo() { text_editor_.Undo(); }
-    void redo() { text_editor_.Redo(); }
-    void cut() { text_editor_.Cut(); }
-    void copy() { text_editor_.Copy(); }
-    void paste() { text_editor_.Paste(); }
+    bool canUndo() const { return large_ ? large_->can_undo() : text_editor_.CanUndo(); }
+    bool canRedo() const { return large_ ? large_->can_redo() : text_editor_.CanRedo(); }
+    bool hasSelection() const { return !large_ && text_editor_.HasSelection(); }
+    void undo() { if (large_) { editing_line_ = -1; large_->undo(); } else { text_editor_.Undo(); } }
+    void redo() { if (large_) { editing_line_ = -1; large_->redo(); } else { text_editor_.Redo(); } }
+    void cut() { if (!large_) text_editor_.Cut(); }
+    void copy() { if (!large_) text_editor_.Copy(); }
+    void paste() { if (!large_) text_editor_.Paste(); }
     void selectAll() { 
+        if (large_) {
+            return;
+        }
         text_editor_.SetSelection(
             ::TextEditor::Coordinates(), 
             ::TextEditor::Coordinates(text_editor_.GetTotalLines(), 0)
@@ -177,6 +213,97 @@ public:
     void setShowWhitespaces(bool show) { text_editor_.SetShowWhitespaces(show); }
 
 private:
+    // Files from this size up (ROUEN_EDITOR_LARGE_FILE_MB, 32) open in large-file mode
+    static uint64_t large_file_threshold() {
+        auto const mb = std::getenv("ROUEN_EDITOR_LARGE_FILE_MB");
+        return (mb && *mb ? std::strtoull(mb, nullptr, 10) : 32) << 20;
+    }
+
+    /**
+     * Large-file mode: the lines in view are read from the piece table each frame and drawn
+     * as plain text. Double-click a line to edit it; Enter keeps the edit, Escape drops it.
+     */
+    void render_large() {
+        constexpr size_t shown_bytes = 4096;    // of a line; the rest is elided on screen only
+        auto const indexed = large_->indexed();
+        auto const lines = large_->lines();
+
+        if (indexed) {
+            ImGui::Text("%llu lines, %.1f MiB (large file mode)", static_cast<unsigned long long>(lines),
+                        static_cast<double>(large_->bytes()) / (1 << 20));
+        } else {
+            ImGui::TextColored(warning_color, "Indexing lines... %.0f%% (editing waits until done)",
+                               large_->index_progress() * 100.0f);
+        }
+        ImGui::Separator();
+
+        rouen::fonts::with_font fnt{rouen::fonts::FontType::Mono};
+        if (!ImGui::BeginChild("##large", ImGui::GetContentRegionAvail(), false, ImGuiWindowFlags_HorizontalScrollbar)) {
+            ImGui::EndChild();
+            return;
+        }
+        auto const digits = static_cast<int>(std::to_string(lines).size());
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(std::min<uint64_t>(lines, INT_MAX)));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                auto const i = static_cast<uint64_t>(row);
+                ImGui::PushID(row);
+                ImGui::TextDisabled("%*llu", digits, static_cast<unsigned long long>(i + 1));
+                ImGui::SameLine();
+                if (editing_line_ == row) {
+                    render_line_edit(i);
+                } else {
+                    auto text = large_->line(i, shown_bytes + 1);
+                    if (text.size() > shown_bytes) {
+                        text.resize(shown_bytes);
+                        text += "...";
+                    }
+                    ImGui::TextUnformatted(text.data(), text.data() + text.size());
+                    if (indexed && ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+                        start_line_edit(row);
+                    }
+                }
+                ImGui::PopID();
+            }
+        }
+        ImGui::EndChild();
+    }
+
+    void start_line_edit(int row) {
+        auto const text = large_->line(static_cast<uint64_t>(row));
+        line_buffer_.assign(text.begin(), text.end());
+        line_buffer_.resize(text.size() + 1024, '\0');
+        editing_line_ = row;
+        focus_line_edit_ = true;
+    }
+
+    void render_line_edit(uint64_t i) {
+        if (focus_line_edit_) {
+            ImGui::SetKeyboardFocusHere();
+            focus_line_edit_ = false;
+        }
+        ImGui::SetNextItemWidth(-80.0f);
+        if (ImGui::InputText("##line", line_buffer_.data(), line_buffer_.size(), ImGuiInputTextFlags_EnterReturnsTrue)) {
+            if (large_->line(i) != line_buffer_.data()) {
+                large_->replace_line(i, line_buffer_.data());
+            }
+            editing_line_ = -1;
+        } else if (ImGui::IsItemFocused() && ImGui::IsKeyPressed(ImGuiKey_Escape)) {
+            editing_line_ = -1;
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("+")) {
+            large_->insert_after(i, {});
+            start_line_edit(static_cast<int>(i) + 1);
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("-")) {
+            large_->erase_line(i);
+            editing_line_ = -1;
+        }
+    }
+
     std::string source_file_;
     std::string buffer_;
     std::string error_;
@@ -188,6 +315,12 @@ private:
     // Text editor
     ::TextEditor text_editor_;
 
+    // Large-file mode, instead of text_editor_ when set
+    std::unique_ptr<large_text> large_;
+    int editing_line_ = -1;
+    std::vector<char> line_buffer_;
+    bool focus_line_edit_ = false;
+
     // Color variables
     ImVec4 success_color;
     ImVec4 error_color;
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../helpers/imgui_include.hpp"
+#include <SDL.h>
+#include <SDL_image.h>
+
+#include "../helpers/redraw.hpp"
+#include "../helpers/task_scheduler.hpp"
+#include "../helpers/texture_helper.hpp"
+
+namespace rouen {
+namespace editor {
+
+/**
+ * An image too large for one texture (or for video memory), shown in tiles.
+ *
+ * The file is decoded on the task scheduler into a pyramid of levels, each half the size
+ * of the one before, down to one that fits a single tile; the levels stay in system memory
+ * (SDL_image only decodes whole files). draw() uploads the tiles the view needs from the
+ * level matching the zoom, a few per frame, and keeps them in an LRU under a byte budget,
+ * ROUEN_TILE_BUDGET_MB (256 by default). The last level is always drawn underneath, so
+ * tiles not uploaded yet show as a blurred preview instead of a hole.
+ */
+class TiledImage {
+public:
+    static constexpr int tile_size = 512;
+    static constexpr int uploads_per_frame = 4;
+
+    enum class State { loading, ready, failed };
+
+    TiledImage(SDL_Renderer* renderer, std::string const& path)
+        : renderer_{renderer}
+        , decoded_{std::make_shared<decoded>()}
+    {
+        auto const spec = std::getenv("ROUEN_TILE_BUDGET_MB");
+        budget_ = (spec ? static_cast<size_t>(std::strtoull(spec, nullptr, 10)) : size_t{256}) << 20;
+        stop_ = rouen::helpers::scheduler()->submit([target = decoded_, path](std::stop_token stoken) {
+            decode(*target, path, stoken);
+        }, rouen::helpers::task_priority::high);
+    }
+
+    ~TiledImage() {
+        stop_.request_stop();
+        for (auto& t : tiles_) {
+            SDL_DestroyTexture(t.texture);
+        }
+    }
+
+    TiledImage(TiledImage const&) = delete;
+    TiledImage& operator=(TiledImage const&) = delete;
+
+    [[nodiscard]] State state() const { return decoded_->state.load(std::memory_order_acquire); }
+    // Once ready
+    [[nodiscard]] int width() const { return decoded_->levels.empty() ? 0 : decoded_->levels.front()->w; }
+    [[nodiscard]] int height() const { return decoded_->levels.empty() ? 0 : decoded_->levels.front()->h; }
+    [[nodiscard]] std::string const& error() const { return decoded_->error; }
+
+    /**
+     * Draws the image with its pixel `origin` at `screen_min`, `zoom` screen pixels to an
+     * image pixel, clipped to [screen_min, screen_max]. Main thread.
+     */
+    void draw(ImDrawList* draw_list, ImVec2 screen_min, ImVec2 screen_max, ImVec2 origin, float zoom) {
+        if (state() != State::ready || zoom <= 0.0f) {
+            return;
+        }
+        ++frame_;
+        auto const& levels = decoded_->levels;
+        auto const image_w = static_cast<float>(width());
+        auto const image_h = static_cast<float>(height());
+        auto to_screen = [&](float x, float y) {
+            return ImVec2{screen_min.x + (x - origin.x) * zoom, screen_min.y + (y - origin.y) * zoom};
+        };
+        draw_list->PushClipRect(screen_min, screen_max, true);
+
+        // The preview underneath
+        int preview_upload = 1;
+        if (auto preview = texture_for(static_cast<int>(levels.size()) - 1, 0, 0, preview_upload); preview) {
+            draw_list->AddImage(reinterpret_cast<ImTextureID>(preview), to_screen(0.0f, 0.0f), to_screen(image_w, image_h));
+        }
+
+        // The level with about one of its pixels per screen pixel, and the tiles in view
+        auto const wanted = static_cast<int>(std::floor(std::log2(1.0f / zoom)));
+        auto const level = std::clamp(wanted, 0, static_cast<int>(levels.size()) - 1);
+        auto const* surface = levels[static_cast<size_t>(level)];
+        auto const scale = static_cast<float>(surface->w) / image_w;     // level pixels per image pixel
+        auto const view_w = (screen_max.x - screen_min.x) / zoom;
+        auto const view_h = (screen_max.y - screen_min.y) / zoom;
+        int const first_x = std::max(0, static_cast<int>(origin.x * scale) / tile_size);
+        int const first_y = std::max(0, static_cast<int>(origin.y * scale) / tile_size);
+        int const last_x = std::min((surface->w - 1) / tile_size, static_cast<int>((origin.x + view_w) * scale) / tile_size);
+        int const last_y = std::min((surface->h - 1) / tile_size, static_cast<int>((origin.y + view_h) * scale) / tile_size);
+        bool missing = false;
+        int uploads = uploads_per_frame;
+        for (int ty = first_y; ty <= last_y; ++ty) {
+            for (int tx = first_x; tx <= last_x; ++tx) {
+                auto texture = texture_for(level, tx, ty, uploads);
+                if (!texture) {
+                    missing = true;
+                    continue;
+                }
+                int const x = tx * tile_size;
+                int const y = ty * tile_size;
+                int const w = std::min(tile_size, surface->w - x);
+                int const h = std::min(tile_size, surface->h - y);
+                draw_list->AddImage(reinterpret_cast<ImTextureID>(texture),
+                    to_screen(x / scale, y / scale), to_screen((x + w) / scale, (y + h) / scale));
+            }
+        }
+        draw_list->PopClipRect();
+
+        evict();
+        if (missing) {
+            rouen::helpers::request_redraw();   // the rest of the tiles over the next frames
+        }
+    }
+
+private:
+    struct decoded {
+        std::atomic<State> state {State::loading};
+        std::vector<SDL_Surface*> levels;   // full size first; written before state turns ready
+        std::string error;
+
+        ~decoded() {
+            for (auto* level : levels) {
+                SDL_FreeSurface(level);
+            }
+        }
+    };
+
+    struct tile {
+        uint64_t key;
+        SDL_Texture* texture;
+        size_t bytes;
+        uint64_t used_in;   // frame
+    };
+
+    static void decode(decoded& target, std::string const& path, std::stop_token stoken) {
+        SDL_Surface* loaded = IMG_Load(path.c_str());
+        SDL_Surface* full = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0) : nullptr;
+        if (loaded) {
+            SDL_FreeSurface(loaded);
+        }
+        if (!full) {
+            target.error = std::string{"Failed to load image: "} + IMG_GetError();
+            target.state.store(State::failed, std::memory_order_release);
+            rouen::helpers::request_redraw();
+            return;
+        }
+        target.levels.push_back(full);
+        while (!stoken.stop_requested() && (target.levels.back()->w > tile_size || target.levels.back()->h > tile_size)) {
+            auto* previous = target.levels.back();
+            auto* next = TextureHelper::scaledCopy(previous, std::max(1, previous->w / 2), std::max(1, previous->h / 2));
+            if (!next) {
+                break;
+            }
+            target.levels.push_back(next);
+        }
+        TEXTURE_INFO_FMT("Decoded {} ({}x{}, {} levels)", path, full->w, full->h, target.levels.size());
+        target.state.store(State::ready, std::memory_order_release);
+        rouen::helpers::request_redraw();
+    }
+
+    static uint64_t key_of(int level, int tx, int ty) {
+        return (static_cast<uint64_t>(level) << 48) | (static_cast<uint64_t>(tx) << 24) | static_cast<uint64_t>(ty);
+    }
+
+    // The tile's texture, uploaded while `uploads` lasts; refreshes its place in the LRU
+    SDL_Texture* texture_for(int level, int tx, int ty, int& uploads) {
+        auto const key = key_of(level, tx, ty);
+        if (auto pos = index_.find(key); pos != index_.end()) {
+            tiles_.splice(tiles_.begin(), tiles_, pos->second);
+            pos->second->used_in = frame_;
+            return pos->second->texture;
+        }
+        if (uploads <= 0) {
+            return nullptr;
+        }
+        --uploads;
+        auto* surface = decoded_->levels[static_cast<size_t>(level)];
+        int const x = tx * tile_size;
+        int const y = ty * tile_size;
+        int const w = std::min(tile_size, surface->w - x);
+        int const h = std::min(tile_size, surface->h - y);
+        SDL_Texture* texture = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, w, h);
+        if (!texture) {
+            TEXTURE_ERROR_FMT("Failed to create image tile: {}", SDL_GetError());
+            return nullptr;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        auto const* pixels = static_cast<Uint8 const*>(surface->pixels) + static_cast<size_t>(y) * surface->pitch + static_cast<size_t>(x) * 4;
+        SDL_UpdateTexture(texture, nullptr, pixels, surface->pitch);
+        tiles_.push_front({key, texture, static_cast<size_t>(w) * h * 4, frame_});
+        index_[key] = tiles_.begin();
+        bytes_ += tiles_.front().bytes;
+        return texture;
+    }
+
+    // Least recently drawn tiles go while over budget; this frame's stay whatever the budget
+    void evict() {
+        while (bytes_ > budget_ && !tiles_.empty() && tiles_.back().used_in != frame_) {
+            auto& oldest = tiles_.back();
+            bytes_ -= oldest.bytes;
+            SDL_DestroyTexture(oldest.texture);
+            index_.erase(oldest.key);
+            tiles_.pop_back();
+        }
+    }
+
+    SDL_Renderer* renderer_;
+    std::shared_ptr<decoded> decoded_;
+    std::stop_source stop_;
+    std::list<tile> tiles_;     // most recently drawn first
+    std::unordered_map<uint64_t, std::list<tile>::iterator> index_;
+    size_t bytes_ {0};
+    size_t budget_ {0};
+    uint64_t frame_ {0};
+};
+
+} // namespace editor
+} // namespace rouen
@@ -1,7 +1,14 @@
+#include <algorithm>
 #include <codecvt>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <locale>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <set>
 #include <vector>  // Added missing header for std::vector
 #include <sstream> // Added for std::stringstream
 #include <iomanip> // Added for std::setw and std::setfill
@@ -9,8 +16,359 @@
 
 #include "fonts.hpp"
 #include "helpers/debug.hpp"  // For logging
+#include "helpers/redraw.hpp"
 
 namespace rouen::fonts {
+    namespace {
+        // Preloaded in both fonts; anything else is added on request
+        const ImWchar default_ranges[] = {
+            0x0020, 0x00FF, // Basic Latin + Latin Supplement
+            0x0400, 0x052F, // Cyrillic + Cyrillic Supplement
+            0x2DE0, 0x2DFF, // Cyrillic Extended-A
+            0xA640, 0xA69F, // Cyrillic Extended-B
+            0x25A0, 0x25FF, // Geometric Shapes (includes triangles)
+            0x2000, 0x206F, // General Punctuation (includes special quotes and apostrophes)
+            0x2B00, 0x2BFF, // Miscellaneous Symbols and Arrows
+             0,
+        };
+
+        const std::filesystem::path cache_dir {"cache/fonts"};
+        const std::filesystem::path atlas_file {cache_dir / "atlas.bin"};
+        const std::filesystem::path glyphs_file {cache_dir / "glyphs.txt"};   // requested codepoints, one hex per line
+
+        constexpr char atlas_magic[4] {'R', 'F', 'A', 'T'};
+        constexpr uint32_t atlas_format = 1;
+
+        // Glyphs added on request: merged into the default font from a font that has them
+        struct on_demand {
+            std::mutex mutex;
+            std::set<ImWchar> seen;         // ever requested, so each is looked at once
+            std::vector<ImWchar> pending;   // requested since the last apply
+            // Main thread (or setup) only
+            std::set<ImWchar> added;
+            std::vector<ImWchar> ranges;    // the fallback config's GlyphRanges point here
+            std::string fallback_path;
+            int fallback_config {-1};       // index in the atlas' ConfigData
+            bool warned {false};
+        };
+
+        on_demand& glyphs() {
+            static on_demand instance;
+            return instance;
+        }
+
+        bool preloaded(ImWchar c) {
+            for (auto const* r = default_ranges; r[0]; r += 2) {
+                if (c >= r[0] && c <= r[1]) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // A font with wide coverage (CJK above all) the default one lacks; ROUEN_FALLBACK_FONT overrides
+        std::string find_fallback_font() {
+            if (auto const* env = std::getenv("ROUEN_FALLBACK_FONT"); env && std::filesystem::exists(env)) {
+                return env;
+            }
+            static const char* const candidates[] = {
+                #ifdef __APPLE__
+                "/System/Library/Fonts/PingFang.ttc",
+                "/System/Library/Fonts/Hiragino Sans GB.ttc",
+                "/Library/Fonts/Arial Unicode.ttf",
+                "/System/Library/Fonts/Supplemental/Arial Unicode.ttf",
+                #else
+                "/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc",
+                "/usr/share/fonts/noto-cjk/NotoSansCJK-Regular.ttc",
+                "/usr/share/fonts/google-noto-cjk/NotoSansCJK-Regular.ttc",
+                "/usr/share/fonts/truetype/droid/DroidSansFallbackFull.ttf",
+                "/usr/share/fonts/truetype/wqy/wqy-microhei.ttc",
+                "/usr/share/fonts/wenquanyi/wqy-microhei/wqy-microhei.ttc",
+                #endif
+            };
+            for (auto const* candidate : candidates) {
+                if (std::filesystem::exists(candidate)) {
+                    return candidate;
+                }
+            }
+            return {};
+        }
+
+        // ImGui ranges (inclusive pairs, zero terminated) covering `codepoints`
+        std::vector<ImWchar> ranges_of(std::set<ImWchar> const& codepoints) {
+            std::vector<ImWchar> ranges;
+            for (auto c : codepoints) {
+                if (!ranges.empty() && ranges.back() + 1 == c) {
+                    ranges.back() = c;
+                } else {
+                    ranges.push_back(c);
+                    ranges.push_back(c);
+                }
+            }
+            ranges.push_back(0);
+            return ranges;
+        }
+
+        // Merges the fallback font into the default one for the glyphs added so far
+        bool add_fallback_config(ImFontAtlas* atlas) {
+            auto& state = glyphs();
+            state.ranges = ranges_of(state.added);
+            if (state.fallback_config >= 0) {
+                atlas->ConfigData[state.fallback_config].GlyphRanges = state.ranges.data();
+                return true;
+            }
+            if (state.fallback_path.empty() || atlas->Fonts.empty()) {
+                return false;
+            }
+            ImFontConfig config;
+            config.MergeMode = true;
+            config.DstFont = atlas->Fonts[0];
+            config.OversampleH = 1;     // thousands of CJK glyphs would otherwise take several pages
+            config.PixelSnapH = true;
+            strcpy(config.Name, "Fallback");
+            if (!atlas->AddFontFromFileTTF(state.fallback_path.c_str(), base_size, &config, state.ranges.data())) {
+                SYS_ERROR_FMT("Could not load fallback font {}", state.fallback_path);
+                state.fallback_path.clear();
+                return false;
+            }
+            state.fallback_config = atlas->ConfigData.Size - 1;
+            return true;
+        }
+
+        void save_requested_glyphs() {
+            std::error_code ec;
+            std::filesystem::create_directories(cache_dir, ec);
+            std::ofstream out {glyphs_file, std::ios::trunc};
+            for (auto c : glyphs().added) {
+                out << std::format("{:04X}\n", static_cast<unsigned>(c));
+            }
+        }
+
+        void load_requested_glyphs() {
+            std::ifstream in {glyphs_file};
+            std::string line;
+            while (std::getline(in, line)) {
+                auto const c = std::strtoul(line.c_str(), nullptr, 16);
+                if (c > 0 && c <= 0xFFFF) {
+                    glyphs().added.insert(static_cast<ImWchar>(c));
+                    glyphs().seen.insert(static_cast<ImWchar>(c));
+                }
+            }
+        }
+
+        // 64-bit FNV-1a over `size` bytes
+        uint64_t hash_bytes(uint64_t h, void const* data, size_t size) {
+            auto const* bytes = static_cast<unsigned char const*>(data);
+            for (size_t i = 0; i < size; ++i) {
+                h = (h ^ bytes[i]) * 0x100000001b3ull;
+            }
+            return h;
+        }
+
+        template<typename T>
+        uint64_t hash_value(uint64_t h, T const& value) {
+            return hash_bytes(h, &value, sizeof(value));
+        }
+
+        // Everything the built atlas depends on: ImGui's layout, the font files and their configs
+        uint64_t atlas_key(ImFontAtlas const* atlas) {
+            uint64_t h = 0xcbf29ce484222325ull;
+            h = hash_value(h, IMGUI_VERSION_NUM);
+            h = hash_value(h, sizeof(ImFontGlyph));
+            h = hash_value(h, sizeof(ImFontAtlasCustomRect));
+            h = hash_value(h, atlas->Flags);
+            h = hash_value(h, atlas->TexDesiredWidth);
+            h = hash_value(h, atlas->TexGlyphPadding);
+            h = hash_value(h, atlas->Fonts.Size);
+            for (auto const& cfg : atlas->ConfigData) {
+                // 8 bytes at a time: the CJK fonts run to tens of megabytes
+                auto const* data = static_cast<unsigned char const*>(cfg.FontData);
+                size_t const size = static_cast<size_t>(cfg.FontDataSize);
+                size_t i = 0;
+                for (; i + 8 <= size; i += 8) {
+                    uint64_t word;
+                    std::memcpy(&word, data + i, 8);
+                    h = (h ^ word) * 0x100000001b3ull;
+                }
+                h = hash_bytes(h, data + i, size - i);
+                h = hash_value(h, cfg.FontDataSize);
+                h = hash_value(h, cfg.FontNo);
+                h = hash_value(h, cfg.SizePixels);
+                h = hash_value(h, cfg.OversampleH);
+                h = hash_value(h, cfg.OversampleV);
+                h = hash_value(h, cfg.PixelSnapH);
+                h = hash_value(h, cfg.GlyphExtraSpacing);
+                h = hash_value(h, cfg.GlyphOffset);
+                h = hash_value(h, cfg.GlyphMinAdvanceX);
+                h = hash_value(h, cfg.GlyphMaxAdvanceX);
+                h = hash_value(h, cfg.MergeMode);
+                h = hash_value(h, cfg.FontBuilderFlags);
+                h = hash_value(h, cfg.RasterizerMultiply);
+                h = hash_value(h, atlas->Fonts.index_from_ptr(atlas->Fonts.find(cfg.DstFont)));
+                for (auto const* r = cfg.GlyphRanges; r && r[0]; r += 2) {
+                    h = hash_value(h, r[0]);
+                    h = hash_value(h, r[1]);
+                }
+            }
+            return h;
+        }
+
+        struct atlas_header {
+            char magic[4];
+            uint32_t format;
+            uint64_t key;
+            int32_t width;
+            int32_t height;
+            ImVec2 uv_scale;
+            ImVec2 uv_white;
+            int32_t pack_cursors;
+            int32_t pack_lines;
+            uint32_t rects;
+            uint32_t fonts;
+        };
+
+        struct font_header {
+            float size;
+            float ascent;
+            float descent;
+            int32_t surface;
+            uint32_t glyphs;
+        };
+
+        void save_atlas(ImFontAtlas const* atlas, uint64_t key) {
+            if (!atlas->TexPixelsAlpha8 || atlas->TexWidth <= 0 || atlas->TexHeight <= 0) {
+                return;
+            }
+            for (auto const& rect : atlas->CustomRects) {
+                if (rect.Font) {
+                    return;     // custom glyphs point at fonts; not worth serializing
+                }
+            }
+            atlas_header header {};
+            std::memcpy(header.magic, atlas_magic, sizeof(atlas_magic));
+            header.format = atlas_format;
+            header.key = key;
+            header.width = atlas->TexWidth;
+            header.height = atlas->TexHeight;
+            header.uv_scale = atlas->TexUvScale;
+            header.uv_white = atlas->TexUvWhitePixel;
+            header.pack_cursors = atlas->PackIdMouseCursors;
+            header.pack_lines = atlas->PackIdLines;
+            header.rects = static_cast<uint32_t>(atlas->CustomRects.Size);
+            header.fonts = static_cast<uint32_t>(atlas->Fonts.Size);
+
+            std::error_code ec;
+            std::filesystem::create_directories(cache_dir, ec);
+            auto temporary = atlas_file;
+            temporary += ".tmp";
+            {
+                std::ofstream out {temporary, std::ios::binary | std::ios::trunc};
+                out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+                out.write(reinterpret_cast<char const*>(atlas->TexUvLines), sizeof(atlas->TexUvLines));
+                out.write(reinterpret_cast<char const*>(atlas->CustomRects.Data), static_cast<std::streamsize>(atlas->CustomRects.size_in_bytes()));
+                for (auto const* font : atlas->Fonts) {
+                    font_header fh {font->FontSize, font->Ascent, font->Descent, font->MetricsTotalSurface, static_cast<uint32_t>(font->Glyphs.Size)};
+                    out.write(reinterpret_cast<char const*>(&fh), sizeof(fh));
+                    out.write(reinterpret_cast<char const*>(font->Glyphs.Data), static_cast<std::streamsize>(font->Glyphs.size_in_bytes()));
+                }
+                out.write(reinterpret_cast<char const*>(atlas->TexPixelsAlpha8), static_cast<std::streamsize>(atlas->TexWidth) * atlas->TexHeight);
+                if (!out) {
+                    SYS_WARN_FMT("Could not write font atlas cache {}", temporary.string());
+                    return;
+                }
+            }
+            std::filesystem::rename(temporary, atlas_file, ec);
+            if (ec) {
+                SYS_WARN_FMT("Could not write font atlas cache {}: {}", atlas_file.string(), ec.message());
+            }
+        }
+
+        // What ImFontAtlas::Build leaves behind, from the cache; false (atlas untouched) unless it matches
+        bool load_atlas(ImFontAtlas* atlas, uint64_t key) {
+            std::ifstream in {atlas_file, std::ios::binary};
+            if (!in) {
+                return false;
+            }
+            std::vector<char> data {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+            size_t at = 0;
+            auto read = [&](void* target, size_t size) {
+                if (data.size() - at < size) {
+                    return false;
+                }
+                std::memcpy(target, data.data() + at, size);
+                at += size;
+                return true;
+            };
+
+            atlas_header header {};
+            if (!read(&header, sizeof(header))
+                || std::memcmp(header.magic, atlas_magic, sizeof(atlas_magic)) != 0
+                || header.format != atlas_format || header.key != key
+                || header.fonts != static_cast<uint32_t>(atlas->Fonts.Size)
+                || header.width <= 0 || header.height <= 0) {
+                return false;
+            }
+            ImVec4 uv_lines[IM_ARRAYSIZE(atlas->TexUvLines)];
+            ImVector<ImFontAtlasCustomRect> rects;
+            rects.resize(static_cast<int>(header.rects));
+            if (!read(uv_lines, sizeof(uv_lines)) || !read(rects.Data, static_cast<size_t>(rects.size_in_bytes()))) {
+                return false;
+            }
+            std::vector<font_header> font_headers(header.fonts);
+            std::vector<ImVector<ImFontGlyph>> font_glyphs(header.fonts);
+            for (uint32_t i = 0; i < header.fonts; ++i) {
+                if (!read(&font_headers[i], sizeof(font_header))) {
+                    return false;
+                }
+                font_glyphs[i].resize(static_cast<int>(font_headers[i].glyphs));
+                if (!read(font_glyphs[i].Data, static_cast<size_t>(font_glyphs[i].size_in_bytes()))) {
+                    return false;
+                }
+            }
+            auto const pixels_size = static_cast<size_t>(header.width) * static_cast<size_t>(header.height);
+            if (data.size() - at != pixels_size) {
+                return false;
+            }
+
+            // All there: lay it out the way ImFontAtlasBuildWithStbTruetype and ImFontAtlasBuildFinish would
+            atlas->ClearTexData();
+            atlas->TexWidth = header.width;
+            atlas->TexHeight = header.height;
+            atlas->TexUvScale = header.uv_scale;
+            atlas->TexUvWhitePixel = header.uv_white;
+            std::memcpy(atlas->TexUvLines, uv_lines, sizeof(uv_lines));
+            atlas->TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(pixels_size));
+            std::memcpy(atlas->TexPixelsAlpha8, data.data() + at, pixels_size);
+            for (auto& rect : rects) {
+                rect.Font = nullptr;
+            }
+            atlas->CustomRects.swap(rects);
+            atlas->PackIdMouseCursors = header.pack_cursors;
+            atlas->PackIdLines = header.pack_lines;
+            for (auto& cfg : atlas->ConfigData) {
+                if (!cfg.MergeMode) {
+                    cfg.DstFont->ClearOutputData();
+                    cfg.DstFont->ConfigData = &cfg;
+                    cfg.DstFont->ConfigDataCount = 0;
+                    cfg.DstFont->ContainerAtlas = atlas;
+                }
+                cfg.DstFont->ConfigDataCount++;
+            }
+            for (int i = 0; i < atlas->Fonts.Size; ++i) {
+                auto* font = atlas->Fonts[i];
+                auto const& fh = font_headers[static_cast<size_t>(i)];
+                font->FontSize = fh.size;
+                font->Ascent = fh.ascent;
+                font->Descent = fh.descent;
+                font->MetricsTotalSurface = fh.surface;
+                font->Glyphs.swap(font_glyphs[static_cast<size_t>(i)]);
+                font->BuildLookupTable();
+            }
+            atlas->TexReady = true;
+            return true;
+        }
+    }
+
     // Helper function to find font file
     std::string find_font_path(const std::string& filename, const std::vector<std::string>& search_paths) {
         for (const auto& base_path : search_paths) {
@@ -56,17 +414,8 @@ namespace rouen::fonts {
     void setup() {
         // Load font with Cyrillic support and symbols
         // Add default font with Cyrillic character range and geometric symbols
-        static const ImWchar ranges[] = {
-            0x0020, 0x00FF, // Basic Latin + Latin Supplement
-            0x0400, 0x052F, // Cyrillic + Cyrillic Supplement
-            0x2DE0, 0x2DFF, // Cyrillic Extended-A
-            0xA640, 0xA69F, // Cyrillic Extended-B
-            0x25A0, 0x25FF, // Geometric Shapes (includes triangles)
-            0x2000, 0x206F, // General Punctuation (includes special quotes and apostrophes)
-            0x2B00, 0x2BFF, // Miscellaneous Symbols and Arrows
-             0,
-        };
-        
+        auto const* ranges = default_ranges;
+
         // Setup Material Design Icons font
         // Use a smaller range that fits within ImWchar limits (unsigned short)
         static const ImWchar icon_ranges[] = { 
@@ -182,6 +531,96 @@ namespace rouen::fonts {
         } else {
             std::cerr << "WARNING: Could not find a suitable monospace font!" << std::endl;
         }
+
+        // Glyphs requested in earlier sessions are preloaded, so the cached atlas has them
+        auto& state = glyphs();
+        state.fallback_path = find_fallback_font();
+        std::cout << "Fallback font path: " << state.fallback_path << std::endl;
+        load_requested_glyphs();
+        if (!state.added.empty()) {
+            add_fallback_config(io.Fonts);
+        }
+    }
+
+    void build_atlas(ImFontAtlas* atlas) {
+        auto const key = atlas_key(atlas);
+        if (load_atlas(atlas, key)) {
+            SYS_INFO_FMT("Font atlas loaded from {} ({}x{})", atlas_file.string(), atlas->TexWidth, atlas->TexHeight);
+            return;
+        }
+        atlas->Build();
+        save_atlas(atlas, key);
+        SYS_INFO_FMT("Font atlas built ({}x{}) and cached", atlas->TexWidth, atlas->TexHeight);
+    }
+
+    void request_glyphs(std::string_view utf8) {
+        std::vector<ImWchar> wanted;
+        unsigned int c = 0;
+        char const* text = utf8.data();
+        char const* const end = text + utf8.size();
+        while (text < end) {
+            if (static_cast<unsigned char>(*text) < 0x80) {
+                ++text;     // ASCII is always there
+                continue;
+            }
+            auto const length = ImTextCharFromUtf8(&c, text, end);
+            text += length > 0 ? length : 1;
+            if (c <= 0xFFFF && !preloaded(static_cast<ImWchar>(c))) {   // ImWchar holds no more
+                wanted.push_back(static_cast<ImWchar>(c));
+            }
+        }
+        if (wanted.empty()) {
+            return;
+        }
+
+        auto& state = glyphs();
+        bool added = false;
+        {
+            std::lock_guard lock {state.mutex};
+            for (auto w : wanted) {
+                if (state.seen.insert(w).second) {
+                    state.pending.push_back(w);
+                    added = true;
+                }
+            }
+        }
+        if (added) {
+            rouen::helpers::request_redraw();
+        }
+    }
+
+    bool apply_requested_glyphs() {
+        auto& state = glyphs();
+        std::vector<ImWchar> pending;
+        {
+            std::lock_guard lock {state.mutex};
+            pending.swap(state.pending);
+        }
+        auto* atlas = ImGui::GetIO().Fonts;
+        auto* font = get_font(FontType::Default);
+        bool missing = false;
+        for (auto c : pending) {
+            if (font && !font->FindGlyphNoFallback(c)) {
+                state.added.insert(c);
+                missing = true;
+            }
+        }
+        if (!missing) {
+            return false;
+        }
+        if (!add_fallback_config(atlas)) {
+            if (!state.warned) {
+                SYS_WARN("Characters outside the loaded fonts requested, but no fallback font was found (set ROUEN_FALLBACK_FONT)");
+                state.warned = true;
+            }
+            return false;
+        }
+        atlas->Build();
+        // Whatever the fallback font lacks as well is not asked for again next session
+        std::erase_if(state.added, [font](ImWchar c) { return !font->FindGlyphNoFallback(c); });
+        save_requested_glyphs();
+        SYS_INFO_FMT("Font atlas rebuilt with {} requested glyphs ({}x{})", state.added.size(), atlas->TexWidth, atlas->TexHeight);
+        return true;
     }
 
     ImFont* get_font(FontType type) {
@@ -2,6 +2,7 @@
 
 // 1. Standard includes in alphabetic order
 #include <string>
+#include <string_view>
 
 // 2. Libraries used in the project, in alphabetic order
 #include "helpers/imgui_include.hpp"
@@ -22,6 +23,18 @@ namespace rouen::fonts {
     // Setup fonts for the application
     void setup();
 
+    // Rasterizes the atlas set up by setup(), or reloads it from cache/fonts when the font
+    // files, sizes and ranges are those of the last build. Any thread, before the backend is up
+    void build_atlas(ImFontAtlas* atlas);
+
+    // Notes the characters of `utf8` outside the preloaded ranges (CJK in mail subjects);
+    // any thread. apply_requested_glyphs() adds the missing ones from a fallback font
+    void request_glyphs(std::string_view utf8);
+
+    // Main thread, between frames: rebuilds the atlas when requested glyphs are missing.
+    // True when it did; the renderer's font texture is then stale and must be recreated
+    bool apply_requested_glyphs();
+
     // Get a font by type
     ImFont* get_font(FontType type);
 
@@ -0,0 +1,3 @@
+// dr_mp3's implementation, compiled once; audio_engine.hpp includes only its declarations
+#define DR_MP3_IMPLEMENTATION
+#include <dr_mp3.h>
@@ -0,0 +1,295 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <SDL.h>
+#include <dr_mp3.h>     // the implementation is compiled in audio_engine.cpp
+
+// 3. All other includes
+#include "debug.hpp"
+
+namespace rouen::helpers {
+
+/**
+ * Short notification sounds (alarm, pomodoro) played inside the process on an SDL audio
+ * device: each is decoded once into float PCM at the device's rate and channel count, and
+ * the device callback mixes whatever voices are active. Nothing is spawned and nothing is
+ * read or decoded when a sound starts.
+ *
+ * play_at() hands the start time itself to the audio thread: every callback compares the
+ * voices' start times with the wall clock and starts them at the right sample of its buffer,
+ * so a scheduled alarm rings on time even while the UI thread is busy or the card is not
+ * being drawn. The device runs only while some voice is scheduled or playing.
+ *
+ * Voice ids stay valid until stop(); a voice that has finished reports !is_playing().
+ */
+class audio_engine {
+public:
+    using clock = std::chrono::system_clock;
+    static constexpr size_t max_voices = 16;
+
+    static audio_engine& instance() {
+        static audio_engine engine;
+        return engine;
+    }
+
+    audio_engine(const audio_engine&) = delete;
+    audio_engine& operator=(const audio_engine&) = delete;
+
+    ~audio_engine() {
+        close();
+    }
+
+    // Opens the default output device; false when there is no audio (sounds then fall back to mpv)
+    bool open() {
+        std::lock_guard lock(mutex_);
+        if (device_ != 0) {
+            return true;
+        }
+        if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+            SYS_ERROR_FMT("audio_engine: cannot initialize SDL audio: {}", SDL_GetError());
+            return false;
+        }
+        SDL_AudioSpec want {};
+        want.freq = 48000;
+        want.format = AUDIO_F32SYS;
+        want.channels = 2;
+        want.samples = 512;     // about 10 ms: the most a start can wait for the next buffer
+        want.callback = &audio_engine::callback;
+        want.userdata = this;
+        SDL_AudioSpec have {};
+        device_ = SDL_OpenAudioDevice(nullptr, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
+        if (device_ == 0) {
+            SYS_ERROR_FMT("audio_engine: cannot open an audio device: {}", SDL_GetError());
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+            return false;
+        }
+        rate_ = have.freq;
+        channels_ = have.channels;
+        return true;
+    }
+
+    void close() {
+        std::lock_guard lock(mutex_);
+        if (device_ != 0) {
+            SDL_CloseAudioDevice(device_);
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+            device_ = 0;
+        }
+    }
+
+    [[nodiscard]] bool is_open() const {
+        std::lock_guard lock(mutex_);
+        return device_ != 0;
+    }
+
+    // Decodes an MP3 file under `name`, converted for the open device
+    bool preload(std::string const& name, std::string const& path) {
+        std::lock_guard lock(mutex_);
+        if (device_ == 0) {
+            return false;
+        }
+        drmp3_config config {};
+        drmp3_uint64 frames = 0;
+        auto* decoded = drmp3_open_file_and_read_pcm_frames_f32(path.c_str(), &config, &frames, nullptr);
+        if (!decoded || frames == 0 || config.channels == 0) {
+            SYS_ERROR_FMT("audio_engine: cannot decode {}", path);
+            drmp3_free(decoded, nullptr);
+            return false;
+        }
+        auto converted = std::make_shared<sound>(convert(decoded, static_cast<size_t>(frames), static_cast<int>(config.channels),
+                                                         static_cast<int>(config.sampleRate)));
+        drmp3_free(decoded, nullptr);
+        sounds_[name] = std::move(converted);
+        return true;
+    }
+
+    [[nodiscard]] bool has(std::string_view name) const {
+        std::lock_guard lock(mutex_);
+        return sounds_.contains(std::string{name});
+    }
+
+    // Starts `name` now; -1 if it is not loaded or every voice is busy
+    int play(std::string_view name, bool loop = false, float gain = 1.0f) {
+        return start(name, clock::time_point{}, loop, gain);
+    }
+
+    // Starts `name` at `when`, to the sample, without the caller being around then
+    int play_at(std::string_view name, clock::time_point when, bool loop = false, float gain = 1.0f) {
+        return start(name, when, loop, gain);
+    }
+
+    // Scheduled or sounding
+    [[nodiscard]] bool is_playing(int id) const {
+        std::lock_guard lock(mutex_);
+        if (device_ == 0 || id < 0) {
+            return false;
+        }
+        SDL_LockAudioDevice(device_);
+        bool const playing = std::ranges::any_of(voices_, [id](voice const& v) { return v.active && v.id == id; });
+        SDL_UnlockAudioDevice(device_);
+        return playing;
+    }
+
+    void stop(int id) {
+        std::lock_guard lock(mutex_);
+        if (device_ == 0 || id < 0) {
+            return;
+        }
+        SDL_LockAudioDevice(device_);
+        for (auto& v : voices_) {
+            if (v.id == id) {
+                v = voice{};
+            }
+        }
+        SDL_UnlockAudioDevice(device_);
+        pause_if_idle();
+    }
+
+private:
+    struct sound {
+        std::vector<float> samples;     // interleaved, channels_ per frame
+        size_t frames {0};
+    };
+
+    struct voice {
+        std::shared_ptr<const sound> clip;  // set and cleared off the audio thread only
+        clock::time_point start;            // not started while in the future
+        size_t frame {0};
+        float gain {1.0f};
+        int id {-1};
+        bool loop {false};
+        bool active {false};
+    };
+
+    audio_engine() = default;
+
+    int start(std::string_view name, clock::time_point when, bool loop, float gain) {
+        std::lock_guard lock(mutex_);
+        if (device_ == 0) {
+            return -1;
+        }
+        auto const found = sounds_.find(std::string{name});
+        if (found == sounds_.end()) {
+            return -1;
+        }
+        int id = -1;
+        SDL_LockAudioDevice(device_);
+        for (auto& v : voices_) {
+            if (!v.active) {
+                id = next_id_++;
+                v = voice{found->second, when, 0, gain, id, loop, true};
+                break;
+            }
+        }
+        SDL_UnlockAudioDevice(device_);
+        if (id < 0) {
+            SYS_ERROR("audio_engine: every voice is busy");
+            return -1;
+        }
+        SDL_PauseAudioDevice(device_, 0);
+        return id;
+    }
+
+    // Caller holds mutex_; stops the callback once nothing is scheduled or sounding
+    void pause_if_idle() {
+        SDL_LockAudioDevice(device_);
+        bool const idle = std::ranges::none_of(voices_, [](voice const& v) { return v.active; });
+        SDL_UnlockAudioDevice(device_);
+        if (idle) {
+            SDL_PauseAudioDevice(device_, 1);
+        }
+    }
+
+    // To the device's channel count (mono is copied to every channel, extra channels are
+    // dropped) and rate (linear interpolation: these are alerts, not music)
+    sound convert(float const* input, size_t frames, int channels, int rate) const {
+        auto const out_channels = static_cast<size_t>(channels_);
+        auto const in_channels = static_cast<size_t>(channels);
+        auto const step = static_cast<double>(rate) / static_cast<double>(rate_);
+        auto const out_frames = static_cast<size_t>(static_cast<double>(frames) / step);
+        sound result;
+        result.frames = out_frames;
+        result.samples.resize(out_frames * out_channels);
+        for (size_t f = 0; f < out_frames; ++f) {
+            auto const position = static_cast<double>(f) * step;
+            auto const index = std::min(static_cast<size_t>(position), frames - 1);
+            auto const next = std::min(index + 1, frames - 1);
+            auto const t = static_cast<float>(position - static_cast<double>(index));
+            for (size_t c = 0; c < out_channels; ++c) {
+                auto const source = std::min(c, in_channels - 1);
+                auto const a = input[index * in_channels + source];
+                auto const b = input[next * in_channels + source];
+                result.samples[f * out_channels + c] = a + (b - a) * t;
+            }
+        }
+        return result;
+    }
+
+    // On SDL's audio thread, with the device lock held
+    static void callback(void* userdata, Uint8* stream, int length) {
+        auto& self = *static_cast<audio_engine*>(userdata);
+        auto* out = reinterpret_cast<float*>(stream);
+        auto const channels = static_cast<size_t>(self.channels_);
+        auto const frames = static_cast<size_t>(length) / sizeof(float) / channels;
+        std::fill(out, out + frames * channels, 0.0f);
+
+        auto const now = clock::now();
+        for (auto& v : self.voices_) {
+            if (!v.active || !v.clip) {
+                continue;
+            }
+            // A start inside this buffer begins at its sample; one further out waits
+            size_t offset = 0;
+            if (v.start > now) {
+                auto const wait = std::chrono::duration<double>(v.start - now).count();
+                auto const wait_frames = static_cast<size_t>(wait * self.rate_);
+                if (wait_frames >= frames) {
+                    continue;
+                }
+                offset = wait_frames;
+                v.start = clock::time_point{};
+            }
+            auto const& samples = v.clip->samples;
+            for (size_t f = offset; f < frames; ++f) {
+                if (v.frame >= v.clip->frames) {
+                    if (!v.loop) {
+                        v.active = false;
+                        break;
+                    }
+                    v.frame = 0;
+                }
+                auto const* source = &samples[v.frame * channels];
+                for (size_t c = 0; c < channels; ++c) {
+                    out[f * channels + c] += source[c] * v.gain;
+                }
+                ++v.frame;
+            }
+        }
+        for (size_t i = 0; i < frames * channels; ++i) {
+            out[i] = std::clamp(out[i], -1.0f, 1.0f);
+        }
+    }
+
+    mutable std::mutex mutex_;      // device_, sounds_ and the callers' side of voices_
+    SDL_AudioDeviceID device_ {0};
+    int rate_ {48000};
+    int channels_ {2};
+    std::unordered_map<std::string, std::shared_ptr<const sound>> sounds_;
+    std::array<voice, max_voices> voices_ {};   // shared with the callback under the device lock
+    int next_id_ {0};
+};
+
+} // namespace rouen::helpers
@@ -1,5 +1,14 @@
 #include "capture_helper.hpp"
 
+#include <algorithm>
+#include <memory>
+#include <system_error>
+
+#include <SDL_image.h>
+
+#include "redraw.hpp"
+#include "task_scheduler.hpp"
+
 namespace rouen::helpers {
 
 SDL_Texture* capture_imgui(
@@ -114,4 +123,299 @@ SDL_Texture* capture_imgui(
     return capture_texture;
 }
 
-} // namespace rouen::helpers
\ No newline at end of file
+namespace {
+
+// A window owns its own list and those of its child windows ("Parent/Child_XXXXXXXX")
+bool owned_by(char const* owner, std::string_view window_name) {
+    if (!owner) {
+        return false;
+    }
+    std::string_view const name{owner};
+    return name == window_name ||
+        (name.size() > window_name.size() && name.starts_with(window_name) && name[window_name.size()] == '/');
+}
+
+// Frames a queued window may go without drawing before its snapshot is given up
+constexpr int snapshot_patience = 3;
+
+} // namespace
+
+bool window_drawn(ImDrawData const* draw_data, std::string_view window_name) {
+    if (!draw_data) {
+        return false;
+    }
+    for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+        if (owned_by(draw_data->CmdLists[i]->_OwnerName, window_name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool replay_window(
+    ImDrawData const* draw_data,
+    std::string_view window_name,
+    ImVec2 window_pos,
+    ImVec2 window_size,
+    ImVec2 origin
+) {
+    if (!draw_data) {
+        return false;
+    }
+    ImVec2 const shift{origin.x - window_pos.x, origin.y - window_pos.y};
+
+    // Clone the window's lists and move them so the window's corner lands on `origin`
+    std::vector<ImDrawList*> lists;
+    int total_vtx = 0;
+    int total_idx = 0;
+    for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+        ImDrawList const* source = draw_data->CmdLists[i];
+        if (!owned_by(source->_OwnerName, window_name)) {
+            continue;
+        }
+        ImDrawList* clone = source->CloneOutput();
+        for (auto& v : clone->VtxBuffer) {
+            v.pos.x += shift.x;
+            v.pos.y += shift.y;
+        }
+        for (auto& cmd : clone->CmdBuffer) {
+            cmd.ClipRect.x += shift.x;
+            cmd.ClipRect.y += shift.y;
+            cmd.ClipRect.z += shift.x;
+            cmd.ClipRect.w += shift.y;
+        }
+        total_vtx += clone->VtxBuffer.Size;
+        total_idx += clone->IdxBuffer.Size;
+        lists.push_back(clone);
+    }
+    if (lists.empty()) {
+        return false;
+    }
+
+    ImDrawData local;
+    local.Valid = true;
+    for (auto* list : lists) {
+        local.CmdLists.push_back(list);
+    }
+    local.CmdListsCount = static_cast<int>(lists.size());
+    local.TotalVtxCount = total_vtx;
+    local.TotalIdxCount = total_idx;
+    local.DisplayPos = ImVec2{0.0f, 0.0f};
+    local.DisplaySize = ImVec2{origin.x + window_size.x, origin.y + window_size.y};
+    local.FramebufferScale = ImVec2{1.0f, 1.0f};  // captures are at logical resolution
+    ImGui_ImplSDLRenderer2_RenderDrawData(&local);
+
+    for (auto* list : lists) {
+        IM_DELETE(list);
+    }
+    return true;
+}
+
+snapshot_service& snapshot_service::instance() {
+    static snapshot_service service;
+    return service;
+}
+
+snapshot_service::~snapshot_service() {
+    if (target_) {
+        SDL_DestroyTexture(target_);
+    }
+}
+
+void snapshot_service::shutdown() {
+    std::vector<pending> abandoned;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        abandoned.swap(queue_);
+        encoded_.wait(lock, [this] { return encoding_ == 0; });
+    }
+    for (auto& r : abandoned) {
+        if (r.done) {
+            r.done(r.file, false);
+        }
+    }
+    if (target_) {
+        SDL_DestroyTexture(target_);
+        target_ = nullptr;
+        target_width_ = target_height_ = 0;
+    }
+}
+
+void snapshot_service::request(std::string window_title, std::filesystem::path file, done_fn done) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back({std::move(window_title), std::move(file), std::move(done), snapshot_patience});
+    }
+    request_redraw();
+}
+
+bool snapshot_service::has_pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !queue_.empty();
+}
+
+bool snapshot_service::ensure_target(SDL_Renderer* renderer, int width, int height) {
+    if (target_ && target_width_ >= width && target_height_ >= height) {
+        return true;
+    }
+    if (target_) {
+        SDL_DestroyTexture(target_);
+    }
+    target_width_ = std::max(target_width_, width);
+    target_height_ = std::max(target_height_, height);
+    target_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, target_width_, target_height_);
+    if (!target_) {
+        CAPTURE_ERROR_FMT("Failed to create snapshot target: {}", SDL_GetError());
+        target_width_ = target_height_ = 0;
+        return false;
+    }
+    return true;
+}
+
+void snapshot_service::capture(SDL_Renderer* renderer, ImDrawData const* draw_data) {
+    std::vector<pending> requests;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests.swap(queue_);
+    }
+    if (requests.empty() || !renderer || !draw_data) {
+        return;
+    }
+
+    // Shelves of windows, left to right, no wider than the renderer allows
+    SDL_RendererInfo info {};
+    SDL_GetRendererInfo(renderer, &info);
+    int const max_width = info.max_texture_width > 0 ? std::min(info.max_texture_width, 8192) : 4096;
+    struct slot {
+        pending request;
+        ImVec2 pos;
+        SDL_Rect rect;
+    };
+    std::vector<slot> slots;
+    std::vector<pending> retry;
+    int x = 0, y = 0, shelf = 0, used_width = 0;
+    for (auto& r : requests) {
+        ImGuiWindow* window = ImGui::FindWindowByName(r.window_title.c_str());
+        if (!window || !window->Active) {
+            retry.push_back(std::move(r));
+            continue;
+        }
+        int const w = static_cast<int>(window->Size.x);
+        int const h = static_cast<int>(window->Size.y);
+        if (w <= 0 || h <= 0 || w > max_width) {
+            CAPTURE_ERROR_FMT("Cannot snapshot {} ({}x{})", r.window_title, w, h);
+            if (r.done) {
+                r.done(r.file, false);
+            }
+            continue;
+        }
+        if (x + w > max_width) {
+            x = 0;
+            y += shelf;
+            shelf = 0;
+        }
+        slots.push_back({std::move(r), window->Pos, SDL_Rect{x, y, w, h}});
+        x += w;
+        shelf = std::max(shelf, h);
+        used_width = std::max(used_width, x);
+    }
+    int const used_height = y + shelf;
+
+    if (!slots.empty() && ensure_target(renderer, used_width, used_height)) {
+        SDL_Texture* original_target = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, target_);
+        SDL_SetRenderDrawColor(renderer, 40, 40, 40, 255);   // the deck's background, as on screen
+        SDL_RenderClear(renderer);
+        std::erase_if(slots, [&](slot& s) {
+            ImVec2 const origin{static_cast<float>(s.rect.x), static_cast<float>(s.rect.y)};
+            ImVec2 const size{static_cast<float>(s.rect.w), static_cast<float>(s.rect.h)};
+            if (replay_window(draw_data, s.request.window_title, s.pos, size, origin)) {
+                return false;
+            }
+            retry.push_back(std::move(s.request));
+            return true;
+        });
+
+        // One readback for the whole pass; everything after it happens on a worker
+        std::shared_ptr<SDL_Surface> pixels{
+            SDL_CreateRGBSurfaceWithFormat(0, used_width, used_height, 32, SDL_PIXELFORMAT_RGBA32),
+            [](SDL_Surface* surface) { SDL_FreeSurface(surface); }};
+        SDL_Rect const area{0, 0, used_width, used_height};
+        bool const read = pixels && !slots.empty() &&
+            SDL_RenderReadPixels(renderer, &area, SDL_PIXELFORMAT_RGBA32, pixels->pixels, pixels->pitch) == 0;
+        SDL_SetRenderTarget(renderer, original_target);
+
+        if (!read) {
+            CAPTURE_ERROR_FMT("Failed to read snapshot pixels: {}", SDL_GetError());
+            for (auto& s : slots) {
+                if (s.request.done) {
+                    s.request.done(s.request.file, false);
+                }
+            }
+        } else {
+            // Released once the task has run or the scheduler has dropped it; shutdown() waits for that
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++encoding_;
+            }
+            std::shared_ptr<void> const ticket{nullptr, [this](void*) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    --encoding_;
+                }
+                encoded_.notify_all();
+            }};
+            scheduler()->submit([pixels, slots = std::move(slots), ticket](std::stop_token) {
+                for (auto const& s : slots) {
+                    auto* start = static_cast<Uint8*>(pixels->pixels) +
+                        static_cast<size_t>(s.rect.y) * pixels->pitch + static_cast<size_t>(s.rect.x) * 4;
+                    SDL_Surface* slice = SDL_CreateRGBSurfaceWithFormatFrom(
+                        start, s.rect.w, s.rect.h, 32, pixels->pitch, SDL_PIXELFORMAT_RGBA32);
+                    std::error_code ec;
+                    if (s.request.file.has_parent_path()) {
+                        std::filesystem::create_directories(s.request.file.parent_path(), ec);
+                    }
+                    // Written aside and renamed, so whoever shows the file never reads half of it
+                    auto temp = s.request.file;
+                    temp += ".tmp";
+                    bool saved = slice && IMG_SavePNG(slice, temp.string().c_str()) == 0;
+                    if (!saved) {
+                        CAPTURE_ERROR_FMT("Failed to save snapshot {}: {}", s.request.file.string(), IMG_GetError());
+                    } else {
+                        std::filesystem::rename(temp, s.request.file, ec);
+                        saved = !ec;
+                    }
+                    if (!saved) {
+                        std::filesystem::remove(temp, ec);
+                    }
+                    if (slice) {
+                        SDL_FreeSurface(slice);
+                    }
+                    if (s.request.done) {
+                        s.request.done(s.request.file, saved);
+                    }
+                }
+            }, task_priority::background);
+        }
+    }
+
+    // Windows that did not draw this frame get another few frames
+    bool again = false;
+    for (auto& r : retry) {
+        if (--r.frames_left > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(r));
+            again = true;
+        } else {
+            CAPTURE_WARN_FMT("Window {} did not draw; snapshot dropped", r.window_title);
+            if (r.done) {
+                r.done(r.file, false);
+            }
+        }
+    }
+    if (again) {
+        request_redraw();
+    }
+}
+
+} // namespace rouen::helpers
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <condition_variable>
+#include <filesystem>
 #include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "./imgui_include.hpp"
 #include "backends/imgui_impl_sdl2.h"
 #include "backends/imgui_impl_sdlrenderer2.h"
@@ -14,6 +20,8 @@
 #define CAPTURE_ERROR_FMT(fmt, ...) CAPTURE_ERROR(debug::format_log(fmt, __VA_ARGS__))
 #define CAPTURE_INFO(message) LOG_COMPONENT("CAPTURE", LOG_LEVEL_INFO, message)
 #define CAPTURE_INFO_FMT(fmt, ...) CAPTURE_INFO(debug::format_log(fmt, __VA_ARGS__))
+#define CAPTURE_WARN(message) LOG_COMPONENT("CAPTURE", LOG_LEVEL_WARN, message)
+#define CAPTURE_WARN_FMT(fmt, ...) CAPTURE_WARN(debug::format_log(fmt, __VA_ARGS__))
 
 namespace rouen::helpers {
 
@@ -34,4 +42,73 @@ SDL_Texture* capture_imgui(
     SDL_Renderer* renderer = nullptr
 );
 
+// Whether `window_name` (or one of its child windows) has draw lists in `draw_data`
+bool window_drawn(ImDrawData const* draw_data, std::string_view window_name);
+
+/**
+ * Replays the draw lists `window_name` owns in `draw_data` (its own and its child windows')
+ * into the renderer's current target, with the window's corner at `origin`. For use after
+ * ImGui::Render() and before the frame's draw data is submitted.
+ *
+ * @return false if the window drew nothing this frame
+ */
+bool replay_window(
+    ImDrawData const* draw_data,
+    std::string_view window_name,
+    ImVec2 window_pos,
+    ImVec2 window_size,
+    ImVec2 origin = ImVec2{0.0f, 0.0f}
+);
+
+/**
+ * Saves card windows to PNG files without stalling the frame on file I/O.
+ *
+ * request() queues windows by title. After ImGui::Render(), capture() replays every queued
+ * window that drew this frame into one shared off-screen target, side by side, reads the
+ * target back once, and leaves slicing, PNG encoding and writing to the task scheduler.
+ * The target is kept for the next pass and only grows. Windows that drew nothing this
+ * frame stay queued for the next one.
+ */
+class snapshot_service {
+public:
+    using done_fn = std::function<void(std::filesystem::path const& file, bool saved)>;
+
+    static snapshot_service& instance();
+
+    snapshot_service() = default;
+    snapshot_service(snapshot_service const&) = delete;
+    snapshot_service& operator=(snapshot_service const&) = delete;
+    ~snapshot_service();
+
+    // Any thread. `done` is called on a worker thread once the file is written or has failed.
+    void request(std::string window_title, std::filesystem::path file, done_fn done = {});
+
+    [[nodiscard]] bool has_pending() const;
+
+    // Main thread, after ImGui::Render() and before presenting
+    void capture(SDL_Renderer* renderer, ImDrawData const* draw_data);
+
+    // Main thread, before the renderer is destroyed: gives up queued requests, waits for the
+    // files still being written and frees the target
+    void shutdown();
+
+private:
+    struct pending {
+        std::string window_title;
+        std::filesystem::path file;
+        done_fn done;
+        int frames_left;
+    };
+
+    bool ensure_target(SDL_Renderer* renderer, int width, int height);
+
+    mutable std::mutex mutex_;
+    std::vector<pending> queue_;
+    std::condition_variable encoded_;
+    int encoding_ {0};          // passes handed to the scheduler and not yet run or dropped
+    SDL_Texture* target_ {nullptr};
+    int target_width_ {0};
+    int target_height_ {0};
+};
+
 } // namespace rouen::helpers
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// 2. Libraries used in the project, in alphabetic order
+#include "./imgui_include.hpp"
+#include <SDL.h>
+
+// 3. All other includes
+#include "capture_helper.hpp"
+
+namespace rouen::helpers {
+
+/**
+ * Holds the last live rendering of one card window as a render-target texture.
+ *
+ * After ImGui::Render(), capture() replays the window's draw lists (and those of its
+ * child windows) into the texture; on the following frames the deck can composite the
+ * texture instead of running the card's render() again. Content is stored with
+ * premultiplied alpha so the card's translucent background blends the same way it
+ * does when drawn live.
+ */
+class card_texture_cache {
+public:
+    using clock = std::chrono::steady_clock;
+
+    card_texture_cache() = default;
+    card_texture_cache(card_texture_cache const&) = delete;
+    card_texture_cache& operator=(card_texture_cache const&) = delete;
+    card_texture_cache(card_texture_cache&& other) noexcept { *this = std::move(other); }
+    card_texture_cache& operator=(card_texture_cache&& other) noexcept {
+        if (this != &other) {
+            release();
+            texture_ = other.texture_;
+            pos_ = other.pos_;
+            size_ = other.size_;
+            last_capture_ = other.last_capture_;
+            other.texture_ = nullptr;
+        }
+        return *this;
+    }
+    ~card_texture_cache() { release(); }
+
+    // The cached image is usable for a window at this position and size
+    [[nodiscard]] bool matches(ImVec2 pos, ImVec2 size) const {
+        return texture_ && pos.x == pos_.x && pos.y == pos_.y && size.x == size_.x && size.y == size_.y;
+    }
+
+    [[nodiscard]] clock::time_point last_capture() const { return last_capture_; }
+
+    // Replay the draw lists owned by `window_name` into the cached texture.
+    // Must run after ImGui::Render() and before the frame's draw data is submitted.
+    bool capture(SDL_Renderer* renderer, ImDrawData const* draw_data, std::string_view window_name, ImVec2 pos, ImVec2 size) {
+        if (!renderer || !draw_data || size.x < 1.0f || size.y < 1.0f) {
+            return false;
+        }
+        if (!window_drawn(draw_data, window_name) || !ensure_texture(renderer, size)) {
+            return false;   // keeps the last capture when the window drew nothing
+        }
+
+        SDL_Texture* original_target = SDL_GetRenderTarget(renderer);
+        SDL_SetRenderTarget(renderer, texture_);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderClear(renderer);
+        bool const drawn = replay_window(draw_data, window_name, pos, size);
+        SDL_SetRenderTarget(renderer, original_target);
+        if (!drawn) {
+            return false;
+        }
+
+        pos_ = pos;
+        size_ = size;
+        last_capture_ = clock::now();
+        return true;
+    }
+
+    // Composite the cached image into the current window
+    void draw(ImDrawList* target, ImVec2 pos) const {
+        if (texture_) {
+            target->AddImage(static_cast<ImTextureID>(texture_), pos, ImVec2{pos.x + size_.x, pos.y + size_.y});
+        }
+    }
+
+    // What the texture takes in video memory, 0 when none is held
+    [[nodiscard]] size_t bytes() const {
+        return texture_ ? static_cast<size_t>(size_.x) * static_cast<size_t>(size_.y) * 4 : 0;
+    }
+
+    void release() {
+        if (texture_) {
+            SDL_DestroyTexture(texture_);
+            texture_ = nullptr;
+        }
+    }
+
+private:
+    bool ensure_texture(SDL_Renderer* renderer, ImVec2 size) {
+        int const w = static_cast<int>(size.x);
+        int const h = static_cast<int>(size.y);
+        if (texture_) {
+            int tw = 0;
+            int th = 0;
+            SDL_QueryTexture(texture_, nullptr, nullptr, &tw, &th);
+            if (tw == w && th == h) {
+                return true;
+            }
+            release();
+        }
+        texture_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (!texture_) {
+            CAPTURE_ERROR_FMT("Failed to create card cache texture: {}", SDL_GetError());
+            return false;
+        }
+        // Rendering into a cleared target with normal blending leaves premultiplied colour
+        SDL_SetTextureBlendMode(texture_, SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD));
+        return true;
+    }
+
+    SDL_Texture* texture_ {nullptr};
+    ImVec2 pos_ {0.0f, 0.0f};
+    ImVec2 size_ {0.0f, 0.0f};
+    clock::time_point last_capture_ {};
+};
+
+} // namespace rouen::helpers
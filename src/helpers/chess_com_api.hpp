@@ -10,8 +10,10 @@
 #include <glaze/json.hpp>
 #include <regex>
 
+#include "chess_com_archive.hpp"
 #include "debug.hpp"
 #include "fetch.hpp"
+#include "task_scheduler.hpp"
 
 // Chess API debug macros
 #define CHESS_API_ERROR(message) LOG_COMPONENT("CHESS_API", LOG_LEVEL_ERROR, message)
@@ -61,6 +63,15 @@ struct ChessGameArchive {
     std::string result;
 };
 
+// Every game of a player, from all archive months
+struct ChessComImport {
+    bool success = false;
+    std::string error;
+    std::vector<ChessGameArchive> games;    // most recent first
+    size_t months = 0;
+    size_t months_fetched = 0;              // the rest came from the archive store
+};
+
 // JSON structure for Chess.com API archives response
 struct ChessComArchives {
     std::vector<std::string> archives;
@@ -81,36 +92,69 @@ public:
     // Fetch a player's game archives (available months)
     std::future<std::pair<bool, std::string>> fetch_player_archives(const std::string& username) {
         if (username.empty()) {
-            return std::async(std::launch::async, []() {
-                return std::make_pair(false, std::string("Username cannot be empty"));
-            });
+            std::promise<std::pair<bool, std::string>> failed;
+            failed.set_value(std::make_pair(false, std::string("Username cannot be empty")));
+            return failed.get_future();
         }
         
-        return std::async(std::launch::async, [username]() {
-            try {
-                http::fetch fetcher;
-                std::string url = "https://api.chess.com/pub/player/" + username + "/games/archives";
-                std::string response = fetcher(url);
-                
-                return std::make_pair(true, response);
-            } catch (const std::exception& e) {
-                return std::make_pair(false, std::string(e.what()));
-            }
-        });
+        return fetch_async("https://api.chess.com/pub/player/" + username + "/games/archives");
     }
     
-    // Fetch games from a specific archive URL
+    // Fetch games from a specific archive URL; a month that is over comes from the archive store
     std::future<std::pair<bool, std::string>> fetch_archive_games(const std::string& archive_url) {
-        return std::async(std::launch::async, [archive_url]() {
-            try {
-                http::fetch fetcher;
-                std::string response = fetcher(archive_url);
-                
-                return std::make_pair(true, response);
-            } catch (const std::exception& e) {
-                return std::make_pair(false, std::string(e.what()));
+        if (auto stored = ChessComArchiveStore::instance().get(archive_url)) {
+            return ready(std::move(*stored));
+        }
+        return fetch_async(archive_url, true);
+    }
+    
+    // Every game of a player: the archive list, then all months at once (the engine's per-host
+    // limit paces them), the closed ones read from the archive store instead
+    std::future<ChessComImport> import_all_games(const std::string& username) {
+        auto promise = std::make_shared<std::promise<ChessComImport>>();
+        auto result = promise->get_future();
+        auto archives = fetch_player_archives(username);
+        rouen::helpers::scheduler()->submit([promise, archives = std::make_shared<decltype(archives)>(std::move(archives))](std::stop_token) {
+            ChessComApiClient client;
+            ChessComImport imported;
+            auto [listed, listing] = archives->get();
+            std::vector<std::string> months;
+            if (!listed || !client.process_archives_response(listing, months)) {
+                imported.error = listed ? "Error parsing archives response" : listing;
+                promise->set_value(std::move(imported));
+                return;
             }
-        });
+            
+            imported.months = months.size();
+            std::vector<std::future<std::pair<bool, std::string>>> bodies;
+            bodies.reserve(months.size());
+            for (auto const& month : months) {
+                if (auto stored = ChessComArchiveStore::instance().get(month)) {
+                    bodies.push_back(ready(std::move(*stored)));
+                } else {
+                    bodies.push_back(fetch_async(month, true));
+                    ++imported.months_fetched;
+                }
+            }
+            
+            for (size_t i = 0; i < bodies.size(); ++i) {
+                auto [ok, body] = bodies[i].get();
+                std::vector<ChessGameArchive> games;
+                if (!ok || !client.process_games_response(body, games)) {
+                    CHESS_API_WARN_FMT("Skipping archive {}: {}", months[i], ok ? "unreadable" : body);
+                    imported.error = ok ? "Error parsing games response" : body;
+                    continue;
+                }
+                imported.games.insert(imported.games.end(), std::make_move_iterator(games.begin()), std::make_move_iterator(games.end()));
+            }
+            std::sort(imported.games.begin(), imported.games.end(), [](const ChessGameArchive& a, const ChessGameArchive& b) {
+                return a.end_time > b.end_time;
+            });
+            imported.success = !imported.games.empty() || imported.error.empty();
+            CHESS_API_INFO_FMT("Imported {} games from {} months ({} fetched)", imported.games.size(), imported.months, imported.months_fetched);
+            promise->set_value(std::move(imported));
+        }, rouen::helpers::task_priority::background);
+        return result;
     }
     
     // Process archive response and convert to vector of archive URLs
@@ -328,6 +372,35 @@ public:
         // Fix common issues with Chess.com PGN format
         return fix_chess_com_pgn(clean_pgn);
     }
+
+private:
+    static std::future<std::pair<bool, std::string>> ready(std::string body) {
+        std::promise<std::pair<bool, std::string>> done;
+        done.set_value(std::make_pair(true, std::move(body)));
+        return done.get_future();
+    }
+    
+    // Runs on the shared HTTP engine; the future holds the body, or the error message.
+    // A conditional GET: unchanged responses cost the server a 304. An archive response
+    // of a closed month is also put in the archive store.
+    static std::future<std::pair<bool, std::string>> fetch_async(std::string url, bool archive = false) {
+        auto promise = std::make_shared<std::promise<std::pair<bool, std::string>>>();
+        auto result = promise->get_future();
+        http::request req;
+        req.url = url;
+        req.cached = true;
+        http::engine::instance().submit(std::move(req), [promise, archive, url = std::move(url)](http::response response) {
+            if (response.ok()) {
+                if (archive) {
+                    ChessComArchiveStore::instance().put(url, response.body);
+                }
+                promise->set_value(std::make_pair(true, std::move(response.body)));
+            } else {
+                promise->set_value(std::make_pair(false, std::move(response.error)));
+            }
+        });
+        return result;
+    }
 };
 
 } // namespace chess
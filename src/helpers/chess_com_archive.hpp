@@ -0,0 +1,86 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// 3. All other includes
+#include "debug.hpp"
+#include "sqlite.hpp"
+
+namespace rouen {
+namespace chess {
+
+/**
+ * Chess.com monthly archives that can no longer change. A month's games are final once the
+ * month is over, so its response is kept here for good (unlike the HTTP cache, which drops
+ * what goes unused and revalidates what it keeps) and is never asked for again. Only the
+ * month in progress goes to the server, as a conditional request.
+ */
+class ChessComArchiveStore {
+public:
+    static ChessComArchiveStore& instance() {
+        static ChessComArchiveStore store{"chess_com.db"};
+        return store;
+    }
+
+    ChessComArchiveStore(const ChessComArchiveStore&) = delete;
+    ChessComArchiveStore& operator=(const ChessComArchiveStore&) = delete;
+
+    // The stored response of a closed month's archive URL
+    std::optional<std::string> get(const std::string& archive_url) {
+        std::optional<std::string> found;
+        try {
+            db_.for_each<std::string_view>("SELECT body FROM chess_com_month WHERE url = ?",
+                [&found](std::string_view body) { found.emplace(body); }, key(archive_url));
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Chess.com archive store: cannot read {}: {}", archive_url, e.what());
+        }
+        return found;
+    }
+
+    // Keeps the response of an archive URL if its month is over
+    void put(const std::string& archive_url, const std::string& body) {
+        if (!is_closed(archive_url)) {
+            return;
+        }
+        try {
+            db_.exec("INSERT OR REPLACE INTO chess_com_month (url, body) VALUES (?, ?)", nullptr, key(archive_url), body);
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Chess.com archive store: cannot store {}: {}", archive_url, e.what());
+        }
+    }
+
+    // Whether an archive URL (".../games/2024/05") is of a month that ended over a day ago
+    // (games are filed by UTC end time, and may be a little late to show up)
+    static bool is_closed(std::string_view archive_url) {
+        if (archive_url.size() < 7) {
+            return false;
+        }
+        auto const month = archive_url.substr(archive_url.size() - 7);     // "2024/05"
+        std::chrono::year_month_day const today {std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now() - std::chrono::hours{24})};
+        auto const current = std::format("{:04}/{:02}", static_cast<int>(today.year()), static_cast<unsigned>(today.month()));
+        return month < std::string_view{current};
+    }
+
+private:
+    explicit ChessComArchiveStore(const std::string& path) : db_{path} {
+        db_.ensure_table("chess_com_month", "url TEXT PRIMARY KEY, body TEXT");
+    }
+
+    // Usernames in archive URLs come in whatever case they were asked for
+    static std::string key(std::string url) {
+        std::transform(url.begin(), url.end(), url.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return url;
+    }
+
+    hosting::db::sqlite db_;
+};
+
+} // namespace chess
+} // namespace rouen
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "debug.hpp"
+#include "process_helper.hpp"
+
+namespace ProcessHelper {
+    // A path whose changes make a cached result stale
+    struct CacheWatch {
+        std::string path;
+        bool recursive {false};     // the directory and everything below it, except .git
+    };
+
+    /**
+     * Results of read-only commands (git status, git log, git branch, ...) kept per
+     * (cwd, argv) until something they depend on changes. Each result names the paths it
+     * depends on; on Linux inotify watches those and drops the result on any change, so an
+     * unchanged repository is answered without a fork. Results that couldn't be fully
+     * watched (no inotify, or past ROUEN_COMMAND_CACHE_WATCHES watches, 8192 by default)
+     * only live for a couple of seconds, and nothing lives past ROUEN_COMMAND_CACHE_SECONDS
+     * (300). Concurrent asks for the same command share one run.
+     */
+    class CommandCache {
+    public:
+        static constexpr size_t tree_watch_limit = 2048;    // directories per recursive watch
+        static constexpr auto unwatched_lifetime = std::chrono::seconds{2};
+
+        static CommandCache &instance() {
+            static CommandCache cache;
+            return cache;
+        }
+
+        // What a git command in the repository depends on: HEAD, the index, refs and the worktree.
+        // Run it with GIT_OPTIONAL_LOCKS=0, or git status refreshing the index undoes its own entry
+        static std::vector<CacheWatch> gitWatches(std::string const &repo) {
+            auto const git_dir = std::filesystem::path{repo} / ".git";
+            return {{git_dir.string(), false}, {(git_dir / "refs").string(), true}, {repo, true}};
+        }
+
+        // options.cwd and options.env are part of the key; callbacks don't apply
+        std::shared_future<ProcessResult> run(std::vector<std::string> argv, ProcessOptions options, std::vector<CacheWatch> const &watches) {
+            auto key = options.cwd;
+            for (auto const &[name, value] : options.env) {
+                key += '\0' + name + '=' + value;
+            }
+            for (auto const &arg : argv) {
+                key += '\0';
+                key += arg;
+            }
+            auto const now = std::chrono::steady_clock::now();
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (auto pos = entries_.find(key); pos != entries_.end()) {
+                if (now < pos->second.expires) {
+                    return pos->second.result;
+                }
+                forget(pos);
+            }
+
+            // Watched before it starts, so no change it could miss goes unnoticed
+            entry fresh;
+            bool watched = false;
+#ifdef __linux__
+            watched = inotify_fd_ >= 0;
+            for (auto const &watch : watches) {
+                watched &= add_watches(watch, key, fresh.watches);
+            }
+#endif
+            options.on_stdout = nullptr;
+            options.on_stderr = nullptr;
+            fresh.result = runAsync(std::move(argv), std::move(options));
+            fresh.expires = now + (watched ? max_lifetime_ : std::chrono::seconds{unwatched_lifetime});
+            auto result = fresh.result;
+            entries_.insert_or_assign(std::move(key), std::move(fresh));
+            return result;
+        }
+
+        // Everything for commands run in cwd, or every result
+        void invalidate(std::string const &cwd = {}) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto pos = entries_.begin(); pos != entries_.end();) {
+                auto const current = pos++;
+                if (cwd.empty() || current->first.starts_with(cwd + '\0')) {
+                    forget(current);
+                }
+            }
+        }
+
+        ~CommandCache() {
+            thread_.request_stop();
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+#ifdef __linux__
+            if (inotify_fd_ >= 0) {
+                close(inotify_fd_);
+            }
+#endif
+        }
+
+        CommandCache(CommandCache const &) = delete;
+        CommandCache &operator=(CommandCache const &) = delete;
+
+    private:
+        struct entry {
+            std::shared_future<ProcessResult> result;
+            std::chrono::steady_clock::time_point expires;
+            std::vector<int> watches;       // inotify descriptors it is listed under
+        };
+
+        struct watch_info {
+            std::string path;
+            bool in_tree {false};           // part of a recursive watch: new subdirectories join it
+            std::unordered_set<std::string> dependents;     // entry keys
+        };
+
+        CommandCache() {
+            auto const seconds = std::getenv("ROUEN_COMMAND_CACHE_SECONDS");
+            auto const watches = std::getenv("ROUEN_COMMAND_CACHE_WATCHES");
+            max_lifetime_ = std::chrono::seconds{seconds ? std::strtol(seconds, nullptr, 10) : 300};
+            max_watches_ = watches ? std::strtoul(watches, nullptr, 10) : 8192;
+#ifdef __linux__
+            inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (inotify_fd_ < 0) {
+                PROCESS_ERROR("inotify unavailable; cached command results expire after two seconds");
+            } else {
+                thread_ = std::jthread{[this](std::stop_token stoken) { watch_loop(stoken); }};
+            }
+#endif
+        }
+
+        // Under mutex_
+        void forget(std::unordered_map<std::string, entry>::iterator pos) {
+            for (int wd : pos->second.watches) {
+                if (auto watch = watches_.find(wd); watch != watches_.end()) {
+                    watch->second.dependents.erase(pos->first);
+                }
+            }
+            entries_.erase(pos);
+        }
+
+#ifdef __linux__
+        static constexpr uint32_t watch_mask = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE
+            | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+        // Under mutex_; -1 when it can't be watched
+        int watch_one(std::string const &path, bool in_tree) {
+            if (auto known = paths_.find(path); known != paths_.end()) {
+                return known->second;
+            }
+            if (watches_.size() >= max_watches_) {
+                return -1;
+            }
+            int const wd = inotify_add_watch(inotify_fd_, path.c_str(), watch_mask | IN_ONLYDIR);
+            if (wd < 0) {
+                return -1;
+            }
+            auto &info = watches_[wd];
+            info.path = path;
+            info.in_tree |= in_tree;
+            paths_[path] = wd;
+            return wd;
+        }
+
+        // Under mutex_; false when part of it went unwatched
+        bool add_watches(CacheWatch const &watch, std::string const &key, std::vector<int> &wds) {
+            auto depend = [&](int wd) {
+                if (wd < 0) {
+                    return false;
+                }
+                watches_[wd].dependents.insert(key);
+                wds.push_back(wd);
+                return true;
+            };
+            if (!depend(watch_one(watch.path, watch.recursive))) {
+                return false;
+            }
+            if (!watch.recursive) {
+                return true;
+            }
+
+            std::error_code ec;
+            size_t count = 1;
+            auto pos = std::filesystem::recursive_directory_iterator(watch.path,
+                std::filesystem::directory_options::skip_permission_denied, ec);
+            for (; !ec && pos != std::filesystem::recursive_directory_iterator(); pos.increment(ec)) {
+                if (!pos->is_directory(ec) || pos->is_symlink(ec)) {
+                    continue;
+                }
+                if (pos->path().filename() == ".git") {
+                    pos.disable_recursion_pending();
+                    continue;
+                }
+                if (++count > tree_watch_limit || !depend(watch_one(pos->path().string(), true))) {
+                    return false;
+                }
+            }
+            return !ec;
+        }
+
+        void watch_loop(std::stop_token stoken) {
+            alignas(inotify_event) char buffer[16 * 1024];
+            pollfd pfd {inotify_fd_, POLLIN, 0};
+            while (!stoken.stop_requested()) {
+                // The timeout only bounds how long shutdown waits
+                if (poll(&pfd, 1, 250) <= 0) {
+                    continue;
+                }
+                auto const n = read(inotify_fd_, buffer, sizeof(buffer));
+                if (n <= 0) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (char const *at = buffer; at < buffer + n;) {
+                    auto const *event = reinterpret_cast<inotify_event const *>(at);
+                    at += sizeof(inotify_event) + event->len;
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        // Changes were lost: nothing can be trusted
+                        for (auto pos = entries_.begin(); pos != entries_.end();) {
+                            forget(pos++);
+                        }
+                        continue;
+                    }
+                    auto watch = watches_.find(event->wd);
+                    if (watch == watches_.end()) {
+                        continue;
+                    }
+                    // Listed under this watch: stale now
+                    auto const dependents = std::move(watch->second.dependents);
+                    watch->second.dependents.clear();
+                    for (auto const &key : dependents) {
+                        if (auto pos = entries_.find(key); pos != entries_.end()) {
+                            forget(pos);
+                        }
+                    }
+                    if (event->mask & IN_IGNORED) {
+                        paths_.erase(watch->second.path);
+                        watches_.erase(watch);
+                    } else if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && (event->mask & IN_ISDIR)
+                               && watch->second.in_tree && event->len > 0 && std::string_view{event->name} != ".git") {
+                        watch_one(watch->second.path + '/' + event->name, true);
+                    }
+                }
+            }
+        }
+
+        int inotify_fd_ {-1};
+#endif
+        std::mutex mutex_;      // guards entries_, watches_ and paths_
+        std::unordered_map<std::string, entry> entries_;
+        std::unordered_map<int, watch_info> watches_;
+        std::unordered_map<std::string, int> paths_;
+        std::chrono::seconds max_lifetime_ {300};
+        size_t max_watches_ {8192};
+        std::jthread thread_;
+    };
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// 3. All other includes
+#include "debug.hpp"
+#include "process_helper.hpp"
+
+extern char **environ;
+
+namespace rouen::helpers {
+
+// What a running command reports: its output as it comes, then once how it ended
+struct command_event {
+    enum class kind { output, exited };
+
+    kind type {kind::output};
+    std::string_view output {};     // output: the bytes read since the last event, valid during the call
+    int exit_code {0};              // exited: the exit status, -1 when a signal ended it
+    int signal {0};                 // exited: that signal
+    bool cancelled {false};         // exited: after cancel()
+};
+
+using command_sink = std::function<void(command_event const &)>;
+
+class command_run;
+
+// The "run_command" service in the registrar
+using run_command_fn = std::function<std::unique_ptr<command_run>(std::string const &, command_sink)>;
+
+/**
+ * A shell command run in its own process group with stdout and stderr on one pipe, read
+ * in large chunks on its own thread (commands can stream for as long as a build takes, so
+ * they don't hold a scheduler worker). The sink sees each chunk once, as a view of the
+ * read buffer, and a final exited event. cancel() sends SIGTERM to the whole group and
+ * SIGKILL if it is still there after a grace period; destruction cancels and waits, so a
+ * sink may capture its owner.
+ */
+class command_run {
+public:
+    static constexpr size_t read_chunk = 64 * 1024;
+    static constexpr auto kill_grace = std::chrono::seconds{3};
+
+    command_run(std::string const &cmd, command_sink sink) : sink_{std::move(sink)} {
+        int fds[2];
+        if (!ProcessHelper::open_pipe(fds)) {
+            SYS_ERROR_FMT("Could not create a pipe for: {}", cmd);
+            finish_now();
+            return;
+        }
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+        posix_spawnattr_setpgroup(&attr, 0);
+
+        char const *argv[] = {"/bin/sh", "-c", cmd.c_str(), nullptr};
+        auto const rc = posix_spawn(&pid_, "/bin/sh", &actions, &attr, const_cast<char *const *>(argv), environ);
+        posix_spawnattr_destroy(&attr);
+        posix_spawn_file_actions_destroy(&actions);
+        close(fds[1]);
+        if (rc != 0) {
+            SYS_ERROR_FMT("Could not start {}: {}", cmd, std::strerror(rc));
+            close(fds[0]);
+            pid_ = 0;
+            finish_now();
+            return;
+        }
+
+        running_.store(true, std::memory_order_release);
+        thread_ = std::jthread{[this, fd = fds[0]](std::stop_token stoken) { read_until_exit(stoken, fd); }};
+    }
+
+    ~command_run() = default;   // thread_ goes first: stop, then join
+
+    command_run(command_run const &) = delete;
+    command_run &operator=(command_run const &) = delete;
+
+    void cancel() { thread_.request_stop(); }
+
+    [[nodiscard]] bool running() const { return running_.load(std::memory_order_acquire); }
+    [[nodiscard]] pid_t pid() const { return pid_; }
+
+private:
+    void finish_now() {
+        command_event const event {.type = command_event::kind::exited, .exit_code = 127};
+        if (sink_) {
+            sink_(event);
+        }
+    }
+
+    void read_until_exit(std::stop_token const &stoken, int fd) {
+        std::vector<char> buffer(read_chunk);
+        pollfd pfd {fd, POLLIN, 0};
+        std::chrono::steady_clock::time_point terminated;
+        bool signalled = false;
+
+        while (true) {
+            if (stoken.stop_requested()) {
+                auto const now = std::chrono::steady_clock::now();
+                if (!signalled) {
+                    kill(-pid_, SIGTERM);
+                    terminated = now;
+                    signalled = true;
+                } else if (now - terminated > kill_grace) {
+                    kill(-pid_, SIGKILL);
+                }
+            }
+            // The timeout only bounds how long a cancel waits to be noticed
+            auto const ready = poll(&pfd, 1, 100);
+            if (ready < 0 && errno != EINTR) {
+                break;
+            }
+            if (ready <= 0) {
+                continue;
+            }
+            auto const n = read(fd, buffer.data(), buffer.size());
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            if (sink_) {
+                command_event const event {.type = command_event::kind::output,
+                                           .output = std::string_view{buffer.data(), static_cast<size_t>(n)}};
+                sink_(event);
+            }
+        }
+        close(fd);
+
+        int status = 0;
+        while (waitpid(pid_, &status, 0) < 0 && errno == EINTR) {
+        }
+        command_event event {.type = command_event::kind::exited, .cancelled = signalled};
+        if (WIFEXITED(status)) {
+            event.exit_code = WEXITSTATUS(status);
+        } else if (WIFSIGNALED(status)) {
+            event.exit_code = -1;
+            event.signal = WTERMSIG(status);
+        }
+        running_.store(false, std::memory_order_release);
+        if (sink_) {
+            sink_(event);
+        }
+    }
+
+    command_sink sink_;
+    pid_t pid_ {0};
+    std::atomic<bool> running_ {false};
+    std::jthread thread_;
+};
+
+} // namespace rouen::helpers
@@ -11,6 +11,11 @@
     #include <mach/mach.h>
     #include <mach/mach_host.h>
     #include <mach/vm_statistics.h>
+    #include <libproc.h>
+    #include <mach/mach_time.h>
+    #include <algorithm>
+    #include <string>
+    #include <vector>
 
     // Define a sysinfo struct similar to Linux's for macOS
     struct sysinfo {
@@ -96,4 +101,38 @@
         
         return 0;
     }
-#endif // __APPLE__
\ No newline at end of file
+    namespace rouen::helpers::compat {
+        // One process as libproc reports it, for the process table
+        struct process_sample {
+            int pid;
+            std::string name;
+            uint64_t cpu_ns;    // user + system time
+            uint64_t rss;       // bytes
+        };
+
+        inline std::vector<process_sample> list_processes() {
+            std::vector<process_sample> processes;
+            int const count = proc_listallpids(nullptr, 0);
+            if (count <= 0) {
+                return processes;
+            }
+            std::vector<pid_t> pids(static_cast<size_t>(count) + 64);
+            int const listed = proc_listallpids(pids.data(), static_cast<int>(pids.size() * sizeof(pid_t)));
+            processes.reserve(static_cast<size_t>(std::max(listed, 0)));
+            // Task times are in Mach absolute time units, nanoseconds only on Intel
+            mach_timebase_info_data_t timebase {1, 1};
+            mach_timebase_info(&timebase);
+            for (int i = 0; i < listed; ++i) {
+                proc_taskinfo task;
+                if (pids[i] == 0 || proc_pidinfo(pids[i], PROC_PIDTASKINFO, 0, &task, sizeof(task)) != sizeof(task)) {
+                    continue;   // gone, or not ours to look at
+                }
+                char name[2 * MAXCOMLEN + 1] = {};
+                proc_name(pids[i], name, sizeof(name));
+                processes.push_back({pids[i], name, (task.pti_total_user + task.pti_total_system) * timebase.numer / timebase.denom,
+                                     task.pti_resident_size});
+            }
+            return processes;
+        }
+    }
+#endif // __APPLE__
@@ -0,0 +1,60 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "../registrar.hpp"
+#include "sqlite.hpp"
+#include "write_behind.hpp"
+
+namespace rouen::helpers {
+
+    /**
+     * Replies to deterministic model calls (email analyses, article summaries), registered as
+     * "completion_cache" and kept in completions.db under the content key cppgpt computes for
+     * sendMessageCached: the same model, instructions and input never go to the API twice.
+     * Lookups read the database, so the cache costs no memory; new replies are written behind.
+     */
+    class completion_cache {
+    public:
+        explicit completion_cache(std::string const& db_path = "completions.db") : db_{db_path} {
+            db_.ensure_table("completion", "key TEXT PRIMARY KEY, reply TEXT NOT NULL, created INTEGER NOT NULL");
+        }
+
+        // The registered cache, or nullptr where none is (e.g. the bench)
+        static std::shared_ptr<completion_cache> shared() {
+            auto& handle = registrar::cached<completion_cache, "completion_cache">();
+            return handle ? handle.get() : nullptr;
+        }
+
+        std::optional<std::string> get(std::string const& key) {
+            writes_.flush();    // a reply set a moment ago counts
+            std::optional<std::string> reply;
+            db_.for_each_readonly<std::string>("SELECT reply FROM completion WHERE key = ?", [&reply](std::string text) {
+                reply = std::move(text);
+            }, key);
+            return reply;
+        }
+
+        void set(std::string const& key, std::string const& reply) {
+            auto const created = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            writes_.put(key, [key, reply, created = static_cast<int64_t>(created)](hosting::db::sqlite& db) {
+                db.exec("INSERT OR REPLACE INTO completion (key, reply, created) VALUES (?, ?, ?)", {}, key, reply, created);
+            });
+        }
+
+    private:
+        hosting::db::sqlite db_;
+        hosting::db::write_behind writes_ {db_};
+    };
+
+}
@@ -1,8 +1,13 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <format>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <vector>
@@ -63,6 +68,28 @@ namespace ignacionr
         std::vector<Message> messages;
         float temperature;
     };
+
+    // The same request asking for server-sent events, one chunk per few tokens
+    struct StreamPayload {
+        std::string model;
+        std::vector<Message> messages;
+        float temperature;
+        bool stream = true;
+    };
+
+    // What a streamed chunk carries; the rest of it (id, usage...) is skipped
+    struct ChatCompletionDelta {
+        std::optional<std::string> content;
+    };
+
+    struct ChatCompletionChunkChoice {
+        int index = 0;
+        ChatCompletionDelta delta;
+    };
+
+    struct ChatCompletionChunk {
+        std::vector<ChatCompletionChunkChoice> choices;
+    };
 }
 
 // Define glaze schema for all structures
@@ -145,18 +172,126 @@ struct glz::meta<ignacionr::Payload> {
     );
 };
 
+template <>
+struct glz::meta<ignacionr::StreamPayload> {
+    using T = ignacionr::StreamPayload;
+    static constexpr auto value = object(
+        "model", &T::model,
+        "messages", &T::messages,
+        "temperature", &T::temperature,
+        "stream", &T::stream
+    );
+};
+
+template <>
+struct glz::meta<ignacionr::ChatCompletionDelta> {
+    using T = ignacionr::ChatCompletionDelta;
+    static constexpr auto value = object(
+        "content", &T::content
+    );
+};
+
+template <>
+struct glz::meta<ignacionr::ChatCompletionChunkChoice> {
+    using T = ignacionr::ChatCompletionChunkChoice;
+    static constexpr auto value = object(
+        "index", &T::index,
+        "delta", &T::delta
+    );
+};
+
+template <>
+struct glz::meta<ignacionr::ChatCompletionChunk> {
+    using T = ignacionr::ChatCompletionChunk;
+    static constexpr auto value = object(
+        "choices", &T::choices
+    );
+};
+
 namespace ignacionr
 {
+    // The body of a streamed completion, "data: {json}" events split anywhere across chunks
+    // and ending with "data: [DONE]", turned into the pieces of text they carry
+    class completion_stream
+    {
+    public:
+        // on_delta(text) for each piece completed by `chunk`; false once on_delta returns false
+        bool feed(std::string_view chunk, auto &&on_delta)
+        {
+            pending_.append(chunk);
+            size_t start = 0;
+            bool reading = true;
+            for (size_t end; reading && !done_ && (end = pending_.find('\n', start)) != std::string::npos; start = end + 1) {
+                std::string_view line{pending_.data() + start, end - start};
+                if (line.ends_with('\r')) {
+                    line.remove_suffix(1);
+                }
+                if (!line.starts_with("data:")) {
+                    continue;   // blank separators, comments, event names
+                }
+                line.remove_prefix(5);
+                if (line.starts_with(' ')) {
+                    line.remove_prefix(1);
+                }
+                if (line == "[DONE]") {
+                    done_ = true;
+                    break;
+                }
+                ChatCompletionChunk event;
+                if (glz::read<glz::opts{.error_on_unknown_keys = false}>(event, line)) {
+                    continue;
+                }
+                if (event.choices.empty() || !event.choices[0].delta.content || event.choices[0].delta.content->empty()) {
+                    continue;
+                }
+                auto const &text = *event.choices[0].delta.content;
+                reply_ += text;
+                reading = on_delta(std::string_view{text});
+            }
+            pending_.erase(0, std::min(start, pending_.size()));
+            return reading;
+        }
+
+        // "data: [DONE]" arrived
+        [[nodiscard]] bool done() const { return done_; }
+
+        [[nodiscard]] std::string const &reply() const { return reply_; }
+
+    private:
+        std::string pending_;   // the start of a line still arriving
+        std::string reply_;
+        bool done_ = false;
+    };
+
     class cppgpt
     {
     public:
         static constexpr auto open_ai_base = "https://api.openai.com/v1/";
         static constexpr auto groq_base = "https://api.groq.com/openai/v1";
         static constexpr auto grok_base = "https://api.x.ai/v1";
+        // Tokens of history sent with each message unless set_token_budget() says otherwise
+        static constexpr size_t default_token_budget = 16000;
+
         cppgpt(const std::string &api_key, const std::string &base_url) : api_key_(api_key), base_url_{base_url} {}
 
         cppgpt new_conversation() {
-            return cppgpt(api_key_, base_url_);
+            cppgpt fresh(api_key_, base_url_);
+            fresh.token_budget_ = token_budget_;
+            return fresh;
+        }
+
+        // Before each message goes out, the oldest turns are dropped until the conversation fits
+        // `tokens` (as estimate_tokens() counts them). Instructions (system messages) are
+        // pinned, and so is the message being sent.
+        void set_token_budget(size_t tokens)
+        {
+            token_budget_ = tokens;
+        }
+
+        // Roughly four characters a token, plus a few for each message's framing
+        static size_t estimate_tokens(std::string_view text)
+        {
+            return (text.size() + 3) / 4 + 4;
         }
 
         void add_instructions(std::string_view instructions, std::string_view role = "system")
@@ -174,7 +309,7 @@ namespace ignacionr
         {
             wait_min_time();
             // Append the new message to the conversation history
-            conversation.push_back({std::string(role), std::string(message)});
+            push_message(role, message);
 
             // Prepare the API request payload
             Payload payload{
@@ -211,6 +346,100 @@ namespace ignacionr
             return response;
         }
 
+        // sendMessage for deterministic calls (analyses, summaries): a reply already given to the
+        // same model and temperature, after the same conversation (for a fresh one, the same
+        // instructions) and to the same message comes from `cache` rather than the API. `cache`
+        // is pointer-like, null for none, with get(key) -> std::optional<std::string> and
+        // set(key, reply). Returns the reply's text.
+        std::string sendMessageCached(
+            std::string_view message,
+            auto do_post,
+            auto cache,
+            std::string_view role = "user",
+            std::string_view model = "grok-2-latest",
+            float temperature = 0.45f)
+        {
+            std::string key;
+            if (cache) {
+                key = content_key(model, temperature, role, message);
+                if (auto hit = cache->get(key)) {
+                    push_message(role, message);
+                    conversation.push_back({"assistant", *hit});
+                    return std::move(*hit);
+                }
+            }
+            auto response = sendMessage(message, do_post, role, model, temperature);
+            if (response.choices.empty()) {
+                throw std::runtime_error("Empty reply");
+            }
+            auto reply = std::move(response.choices[0].message.content);
+            if (cache) {
+                cache->set(key, reply);
+            }
+            return reply;
+        }
+
+        // Like sendMessage, but the reply arrives as server-sent events: on_delta gets each
+        // piece of text as it comes and returns false to stop reading. do_post_stream(url, body,
+        // header_client, on_chunk) POSTs and hands every chunk of the body to on_chunk, which
+        // returns false once the transfer should be aborted. Returns the whole reply, which
+        // joins the conversation only if reading wasn't stopped.
+        std::string sendMessageStream(
+            std::string_view message,
+            auto do_post_stream,
+            auto on_delta,
+            std::string_view role = "user",
+            std::string_view model = "grok-2-latest",
+            float temperature = 0.45f)
+        {
+            wait_min_time();
+            push_message(role, message);
+            auto const url = std::format("{}/chat/completions", base_url_);
+            auto const body = stream_body(model, temperature);
+
+            completion_stream stream;
+            bool stopped = false;
+            std::function<bool(std::string_view)> on_chunk = [&](std::string_view chunk) {
+                stopped = !stream.feed(chunk, on_delta);
+                return !stopped;
+            };
+            do_post_stream(url, body, [this](auto header_setter){ stream_headers(header_setter); }, on_chunk);
+
+            finish_stream(stream.reply(), !stopped);
+            return stream.reply();
+        }
+
+        // sendMessageStream without a thread waiting on the transfer. submit_stream(url, body,
+        // header_client, on_chunk, on_finished) starts the POST and returns at once (an engine
+        // transfer, say, which this returns to cancel it with); on_chunk gets the body as it
+        // arrives and returns false to abort, and on_finished(error) ends it, with an empty error
+        // on success. on_delta(text) and then on_done(reply, error) are called from those, on the
+        // transport's thread. One stream at a time per conversation.
+        auto startMessageStream(
+            std::string_view message,
+            auto submit_stream,
+            auto on_delta,
+            auto on_done,
+            std::string_view role = "user",
+            std::string_view model = "grok-2-latest",
+            float temperature = 0.45f)
+        {
+            wait_min_time();
+            push_message(role, message);
+            auto const url = std::format("{}/chat/completions", base_url_);
+            auto const body = stream_body(model, temperature);
+
+            auto stream = std::make_shared<completion_stream>();
+            std::function<bool(std::string_view)> on_chunk = [stream, on_delta](std::string_view chunk) mutable {
+                return stream->feed(chunk, on_delta);
+            };
+            std::function<void(std::string const &)> on_finished = [this, stream, on_done](std::string const &error) mutable {
+                finish_stream(stream->reply(), error.empty());
+                on_done(stream->reply(), error);
+            };
+            return submit_stream(url, body, [this](auto header_setter){ stream_headers(header_setter); }, on_chunk, on_finished);
+        }
+
         void clear()
         {
             conversation.clear();
@@ -225,6 +454,86 @@ namespace ignacionr
         std::string api_key_;            // Your OpenAI API key
         std::vector<Message> conversation; // To keep track of the conversation history
         std::string const base_url_;
+        size_t token_budget_ = default_token_budget;
+
+        void push_message(std::string_view role, std::string_view message)
+        {
+            conversation.push_back({std::string(role), std::string(message)});
+            fit_budget();
+        }
+
+        // Drops the oldest unpinned messages until the conversation fits token_budget_
+        void fit_budget()
+        {
+            size_t tokens = 0;
+            for (auto const &m : conversation) {
+                tokens += estimate_tokens(m.content);
+            }
+            auto pos = conversation.begin();
+            while (tokens > token_budget_ && pos != conversation.end() - 1) {
+                if (pos->role == "system") {
+                    ++pos;
+                    continue;
+                }
+                tokens -= estimate_tokens(pos->content);
+                pos = conversation.erase(pos);
+            }
+        }
+
+        // FNV-1a over everything the reply depends on, each field prefixed with its length so
+        // no two splits of the same bytes collide, and the number of bytes hashed
+        std::string content_key(std::string_view model, float temperature, std::string_view role, std::string_view message) const
+        {
+            uint64_t hash = 14695981039346656037ull;
+            uint64_t bytes = 0;
+            auto const mix = [&hash, &bytes](std::string_view text) {
+                auto const length = std::format("{}:", text.size());
+                for (auto const part : {std::string_view{length}, text}) {
+                    for (auto const c : part) {
+                        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+                    }
+                    bytes += part.size();
+                }
+            };
+            mix(model);
+            mix(std::format("{}", temperature));
+            for (auto const &m : conversation) {
+                mix(m.role);
+                mix(m.content);
+            }
+            mix(role);
+            mix(message);
+            return std::format("{:016x}-{}", hash, bytes);
+        }
+
+        std::string stream_body(std::string_view model, float temperature) const {
+            StreamPayload payload{
+                std::string(model),
+                conversation,
+                temperature
+            };
+            std::string body;
+            auto error = glz::write_json(payload, body);
+            if (error) {
+                throw std::runtime_error("Failed to serialize payload: " + glz::format_error(error));
+            }
+            return body;
+        }
+
+        void stream_headers(auto header_setter) const {
+            header_setter("Authorization: Bearer " + api_key_);
+            header_setter("Content-Type: application/json");
+            header_setter("Accept: text/event-stream");
+        }
+
+        // A reply cut short leaves the conversation as it was before the message
+        void finish_stream(std::string const &reply, bool complete) {
+            if (complete) {
+                conversation.push_back({"assistant", reply});
+            } else if (!conversation.empty()) {
+                conversation.pop_back();
+            }
+        }
 
         static std::chrono::system_clock::duration min_time_between_requests() {
             return std::chrono::seconds(1);
@@ -0,0 +1,301 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <sqlite3.h>
+
+// 3. All other includes
+#include "debug.hpp"
+#include "redraw.hpp"
+#include "sqlite.hpp"
+#include "task_scheduler.hpp"
+
+namespace hosting::db
+{
+    // What the last pass did to one database, as shown by the dbrepair card
+    struct maintenance_result
+    {
+        std::string path;
+        std::string name;
+        std::chrono::system_clock::time_point finished;
+        double seconds {0};
+        bool ok {false};
+        std::string error;
+        std::string auto_vacuum;        // none, full or incremental
+        int64_t bytes_before {0};       // database plus its WAL
+        int64_t bytes_after {0};
+        int64_t pages_freed {0};        // by incremental vacuum
+        int64_t free_pages {0};         // left on the free list, i.e. what a VACUUM would reclaim
+        int64_t page_size {0};
+        bool checkpoint_busy {false};   // a reader kept the WAL from being truncated
+        bool vacuumed {false};          // full VACUUM, on request
+
+        [[nodiscard]] int64_t reclaimed() const { return bytes_before - bytes_after; }
+    };
+
+    /**
+     * Background upkeep of every *.db in the working directory (rss.db, rss_images.db,
+     * email_metadata.db, travel.db, ...). While the app is idle (no input for
+     * ROUEN_DB_IDLE_SECONDS, 300 by default, and nothing queued on the task scheduler) and
+     * the last pass is ROUEN_DB_MAINTENANCE_MINUTES (360) old, each database gets a bounded
+     * ANALYZE, PRAGMA optimize, an incremental vacuum in small steps when auto_vacuum is
+     * incremental, and a TRUNCATE checkpoint of its WAL. Input stops a pass between steps.
+     * Databases in auto_vacuum none only reclaim space with a full VACUUM, which also turns
+     * them incremental and locks them meanwhile; that runs only when asked for.
+     */
+    class maintenance
+    {
+    public:
+        static maintenance &instance()
+        {
+            static maintenance service;
+            return service;
+        }
+
+        void start()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (thread_.joinable()) {
+                return;
+            }
+            auto const minutes = std::getenv("ROUEN_DB_MAINTENANCE_MINUTES");
+            auto const idle = std::getenv("ROUEN_DB_IDLE_SECONDS");
+            interval_ = std::chrono::minutes{minutes ? std::strtol(minutes, nullptr, 10) : 360};
+            idle_after_ = std::chrono::seconds{idle ? std::strtol(idle, nullptr, 10) : 300};
+            note_activity();
+            thread_ = std::jthread{[this](std::stop_token stoken) { run(stoken); }};
+        }
+
+        // Before the registrar and the scheduler go away
+        void stop()
+        {
+            thread_.request_stop();
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+        }
+
+        ~maintenance() { stop(); }
+
+        maintenance(maintenance const &) = delete;
+        maintenance &operator=(maintenance const &) = delete;
+
+        // User input; postpones and interrupts idle passes. Main thread, every event
+        void note_activity()
+        {
+            last_activity_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+
+        // A pass over every database now, idle or not
+        void run_now() { request({}); }
+
+        // A full VACUUM of one database, switching it to incremental auto_vacuum
+        void vacuum(std::string const &path) { request(path); }
+
+        [[nodiscard]] bool running() const { return running_.load(std::memory_order_acquire); }
+
+        [[nodiscard]] std::vector<maintenance_result> results() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return results_;
+        }
+
+        [[nodiscard]] std::chrono::system_clock::time_point last_pass() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return last_pass_;
+        }
+
+    private:
+        static constexpr int analysis_limit = 1000;         // rows sampled per index by ANALYZE
+        static constexpr int vacuum_step_pages = 2048;      // per incremental_vacuum, each a short write lock
+
+        maintenance() = default;
+
+        void request(std::string path)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                requests_.push_back(std::move(path));
+            }
+            wake_.notify_one();
+        }
+
+        bool idle() const
+        {
+            auto const last = std::chrono::steady_clock::time_point{
+                std::chrono::steady_clock::duration{last_activity_.load(std::memory_order_relaxed)}};
+            return std::chrono::steady_clock::now() - last >= idle_after_ && rouen::helpers::scheduler()->pending() == 0;
+        }
+
+        void run(std::stop_token stoken)
+        {
+            auto next_pass = std::chrono::steady_clock::now() + idle_after_;
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stoken.stop_requested()) {
+                // Idleness is polled: it begins when nothing happens, which wakes nobody
+                wake_.wait_for(lock, stoken, std::chrono::seconds{30}, [this] { return !requests_.empty(); });
+                if (stoken.stop_requested()) {
+                    break;
+                }
+                std::deque<std::string> requests;
+                requests.swap(requests_);
+                lock.unlock();
+
+                bool const scheduled = requests.empty() && std::chrono::steady_clock::now() >= next_pass && idle();
+                for (auto const &path : requests) {
+                    pass(stoken, path, false);
+                }
+                if (scheduled && pass(stoken, {}, true)) {
+                    next_pass = std::chrono::steady_clock::now() + interval_;
+                }
+                lock.lock();
+            }
+        }
+
+        // All databases, or the one to VACUUM; false when input or shutdown cut it short
+        bool pass(std::stop_token const &stoken, std::string const &vacuum_path, bool while_idle)
+        {
+            std::vector<std::string> paths;
+            if (!vacuum_path.empty()) {
+                paths.push_back(vacuum_path);
+            } else {
+                std::error_code ec;
+                for (auto const &entry : std::filesystem::directory_iterator(".", ec)) {
+                    if (entry.is_regular_file() && entry.path().extension() == ".db") {
+                        paths.push_back(entry.path().string());
+                    }
+                }
+                std::ranges::sort(paths);
+            }
+
+            running_.store(true, std::memory_order_release);
+            rouen::helpers::request_redraw();
+            bool complete = true;
+            for (auto const &path : paths) {
+                if (stoken.stop_requested() || (while_idle && !idle())) {
+                    DB_INFO("Database maintenance interrupted");
+                    complete = false;
+                    break;
+                }
+                store(maintain(path, !vacuum_path.empty(), [&] { return stoken.stop_requested() || (while_idle && !idle()); }));
+            }
+            if (complete && vacuum_path.empty()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                last_pass_ = std::chrono::system_clock::now();
+            }
+            running_.store(false, std::memory_order_release);
+            rouen::helpers::request_redraw();
+            return complete;
+        }
+
+        void store(maintenance_result result)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto pos = std::ranges::find(results_, result.path, &maintenance_result::path);
+            if (pos != results_.end()) {
+                *pos = std::move(result);
+            } else {
+                results_.push_back(std::move(result));
+            }
+        }
+
+        static int64_t size_on_disk(std::string const &path)
+        {
+            std::error_code ec;
+            int64_t total = 0;
+            for (auto const &file : {path, path + "-wal"}) {
+                auto const size = std::filesystem::file_size(file, ec);
+                total += ec ? 0 : static_cast<int64_t>(size);
+            }
+            return total;
+        }
+
+        static int64_t pragma_int(sqlite &db, std::string const &pragma)
+        {
+            int64_t value = 0;
+            db.for_each<int64_t>("PRAGMA " + pragma, [&value](int64_t v) { value = v; });
+            return value;
+        }
+
+        static maintenance_result maintain(std::string const &path, bool full_vacuum, auto interrupted)
+        {
+            maintenance_result result;
+            result.path = path;
+            result.name = std::filesystem::path{path}.filename().string();
+            result.bytes_before = size_on_disk(path);
+            auto const started = std::chrono::steady_clock::now();
+            try {
+                sqlite db{path};
+                result.page_size = pragma_int(db, "page_size");
+                auto const mode = pragma_int(db, "auto_vacuum");
+                if (full_vacuum) {
+                    DB_INFO_FMT("Vacuuming {} ({} free pages)", path, pragma_int(db, "freelist_count"));
+                    db.exec("PRAGMA auto_vacuum = INCREMENTAL");
+                    db.exec("VACUUM");
+                    result.vacuumed = true;
+                }
+
+                // Statistics for the query planner; the limit keeps it short on large tables
+                db.exec(std::format("PRAGMA analysis_limit = {}", analysis_limit));
+                db.exec("ANALYZE");
+                db.exec("PRAGMA optimize");
+
+                result.auto_vacuum = pragma_int(db, "auto_vacuum") == 2 ? "incremental" : mode == 1 ? "full" : "none";
+                if (result.auto_vacuum == "incremental") {
+                    for (auto free = pragma_int(db, "freelist_count"); free > 0 && !interrupted();) {
+                        db.exec(std::format("PRAGMA incremental_vacuum({})", vacuum_step_pages));
+                        auto const left = pragma_int(db, "freelist_count");
+                        result.pages_freed += free - left;
+                        if (left >= free) {
+                            break;
+                        }
+                        free = left;
+                    }
+                }
+                result.free_pages = pragma_int(db, "freelist_count");
+
+                // Columns: busy, frames in the log, frames checkpointed
+                db.exec("PRAGMA wal_checkpoint(TRUNCATE)", [&result](sqlite3_stmt *stmt) {
+                    result.checkpoint_busy = sqlite3_column_int(stmt, 0) != 0;
+                });
+                result.ok = true;
+            } catch (const std::exception &e) {
+                result.error = e.what();
+                DB_ERROR_FMT("Maintenance of {} failed: {}", path, e.what());
+            }
+            result.bytes_after = size_on_disk(path);
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+            result.finished = std::chrono::system_clock::now();
+            DB_INFO_FMT("Maintained {} in {:.1f}s, {} bytes reclaimed", path, result.seconds, result.reclaimed());
+            return result;
+        }
+
+        mutable std::mutex mutex_;                      // guards requests_, results_ and last_pass_
+        std::deque<std::string> requests_;              // "" for a pass, else a path to VACUUM
+        std::vector<maintenance_result> results_;
+        std::chrono::system_clock::time_point last_pass_;
+        std::condition_variable_any wake_;
+        std::atomic<std::chrono::steady_clock::rep> last_activity_ {0};
+        std::atomic<bool> running_ {false};
+        std::chrono::milliseconds interval_ {std::chrono::minutes{360}};
+        std::chrono::milliseconds idle_after_ {std::chrono::seconds{300}};
+        std::jthread thread_;
+    };
+}
@@ -11,7 +11,7 @@
 // None in this file
 
 // 3. All other includes
-// None in this file
+#include "logger.hpp"
 
 // Define logging levels
 #define LOG_LEVEL_NONE 0
@@ -32,15 +32,12 @@
 #endif
 #endif
 
-// Convenience macro for component logging
+// Convenience macro for component logging.
+// ROUEN_LOG_LEVEL is the compile-time ceiling; below it the logger filters per component at
+// runtime, and the message is only built when it will be written. Output is asynchronous.
 #define LOG_COMPONENT(component, level, message) \
-    if (level <= ROUEN_LOG_LEVEL) { \
-        std::cerr << "[" << component << "][" << \
-        (level == LOG_LEVEL_ERROR ? "ERROR" : \
-         level == LOG_LEVEL_WARN ? "WARN" : \
-         level == LOG_LEVEL_INFO ? "INFO" : \
-         level == LOG_LEVEL_DEBUG ? "DEBUG" : "TRACE") \
-        << "] " << message << std::endl; \
+    if (level <= ROUEN_LOG_LEVEL && ::rouen::helpers::logger::instance().enabled(component, level)) { \
+        ::rouen::helpers::logger::instance().write(component, level, ::rouen::helpers::log_message(message)); \
     }
 
 // Component-specific logging macros
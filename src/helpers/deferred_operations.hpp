@@ -1,43 +1,97 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <deque>
 #include <functional>
-#include <queue>
+#include <iterator>
 #include <mutex>
 #include <memory>
 #include <SDL.h>
 #include "./imgui_include.hpp"
 #include "backends/imgui_impl_sdl2.h"
 #include "backends/imgui_impl_sdlrenderer2.h"
+#include "redraw.hpp"
 
-// A service that queues operations to be executed after the ImGui frame is completed
+// A service that queues operations to be executed after the ImGui frame is completed.
+//
+// Producers (any thread) only touch the incoming lanes under the mutex; the main thread
+// swaps them out and runs the operations without holding the lock, so a slow operation
+// never blocks queue() and an operation may queue further operations.
 class deferred_operations {
 public:
     using operation = std::function<void()>;
-    
-    // Add an operation to the queue
-    void queue(operation op) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        operations_.push(std::move(op));
+    using clock = std::chrono::steady_clock;
+
+    // Lanes drain in order: input-driven work always runs in full, the rest within the budget
+    enum class lane : size_t {
+        input = 0,   // direct response to a user action (opening a card from the menu)
+        normal = 1,
+        bulk = 2     // restores, texture uploads and other work that can spread over frames
+    };
+
+    static constexpr std::chrono::milliseconds default_budget {8};
+
+    // Add an operation to the queue and wake the main loop so it runs promptly
+    void queue(operation op, lane l = lane::normal) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            incoming_[static_cast<size_t>(l)].push_back(std::move(op));
+        }
+        rouen::helpers::request_redraw();
     }
-    
-    // Process all queued operations
-    void process_queue(SDL_Renderer* /*renderer*/) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        while (!operations_.empty()) {            
-            // Execute the operation
-            operations_.front()();
-            operations_.pop();
+
+    // Run queued operations until the frame budget is spent; whatever is left
+    // stays queued, in order, for the next frame. Main thread only.
+    void process_queue(SDL_Renderer* /*renderer*/, clock::duration budget = default_budget) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < lane_count; ++i) {
+                auto& from = incoming_[i];
+                auto& to = ready_[i];
+                std::move(from.begin(), from.end(), std::back_inserter(to));
+                from.clear();
+            }
+        }
+
+        auto const deadline = clock::now() + budget;
+        bool ran_any = false;
+        for (size_t i = 0; i < lane_count; ++i) {
+            auto& ops = ready_[i];
+            bool const unbounded = i == static_cast<size_t>(lane::input);
+            while (!ops.empty()) {
+                // Always make progress: at least one operation per call
+                if (!unbounded && ran_any && clock::now() >= deadline) {
+                    return;
+                }
+                auto op = std::move(ops.front());
+                ops.pop_front();
+                op();
+                ran_any = true;
+            }
         }
     }
-    
-    // Check if there are any operations in the queue
+
+    // Check if there are any operations in the queue (main thread only)
     bool has_operations() const {
+        for (auto const& ops : ready_) {
+            if (!ops.empty()) {
+                return true;
+            }
+        }
         std::lock_guard<std::mutex> lock(mutex_);
-        return !operations_.empty();
+        for (auto const& ops : incoming_) {
+            if (!ops.empty()) {
+                return true;
+            }
+        }
+        return false;
     }
-    
+
 private:
-    std::queue<operation> operations_;
+    static constexpr size_t lane_count = 3;
+
+    std::array<std::deque<operation>, lane_count> incoming_;  // guarded by mutex_
+    std::array<std::deque<operation>, lane_count> ready_;     // main thread only
     mutable std::mutex mutex_;
-};
\ No newline at end of file
+};
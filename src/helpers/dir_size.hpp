@@ -0,0 +1,259 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <dirent.h>
+#include <fcntl.h>
+#include <sqlite3.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 3. All other includes
+#include "debug.hpp"
+#include "redraw.hpp"
+#include "sqlite.hpp"
+#include "task_scheduler.hpp"
+#include "write_behind.hpp"
+
+namespace rouen::helpers {
+
+/**
+ * Recursive directory sizes, like `du -x`: the disk space (allocated blocks) and file count
+ * below a directory, staying on its file system and not following symlinks. One background
+ * scheduler task per directory, each listing it with fdopendir and fstatat on the directory's
+ * descriptor; totals grow as directories are counted and are final once every subtree is in.
+ *
+ * What a directory holds itself (bytes, files, subdirectory names) is kept in dir_sizes.db
+ * under its device and inode, together with its mtime and the last total below it. While the
+ * mtime is unchanged a walk takes the directory's row instead of listing it again, so only
+ * directories do still get opened; and the last total is shown right away meanwhile. Files
+ * growing in place don't touch their directory's mtime: measure(..., true) lists everything.
+ */
+class dir_sizes {
+public:
+    // One measurement under way (or done); read from any thread
+    struct measurement {
+        std::atomic<uint64_t> bytes {0};
+        std::atomic<uint64_t> files {0};
+        std::atomic<bool> done {false};
+        std::atomic<int64_t> last_bytes {-1};   // the previous total from the cache, when there is one
+    };
+
+    static dir_sizes &instance() {
+        static dir_sizes sizes {"dir_sizes.db"};
+        return sizes;
+    }
+
+    dir_sizes(dir_sizes const &) = delete;
+    dir_sizes &operator=(dir_sizes const &) = delete;
+
+    // Starts measuring `path`, all of it on workers; a stop drops the walk (what was counted
+    // so far stays cached). A symlink measures as empty
+    std::shared_ptr<measurement> measure(std::string const &path, std::stop_source stop, bool rescan = false) {
+        auto result = std::make_shared<measurement>();
+        visit(std::make_shared<walk_state>(result, std::move(stop), rescan), std::make_shared<node>(path, nullptr));
+        return result;
+    }
+
+    static std::string human(uint64_t bytes) {
+        if (bytes < 1024) {
+            return std::format("{} B", bytes);
+        }
+        constexpr char const *units[] = {"KB", "MB", "GB", "TB", "PB"};
+        auto value = static_cast<double>(bytes) / 1024.0;
+        size_t unit = 0;
+        while (value >= 1024.0 && unit + 1 < std::size(units)) {
+            value /= 1024.0;
+            ++unit;
+        }
+        return std::format("{:.1f} {}", value, units[unit]);
+    }
+
+private:
+    struct row {
+        int64_t mtime_ns {0};
+        uint64_t own_bytes {0};
+        uint64_t own_files {0};
+        std::vector<std::string> subdirs;
+        int64_t total_bytes {-1};
+        int64_t total_files {-1};
+    };
+
+    // A directory of the walk; completes once it and every directory below it are counted
+    struct node {
+        node(std::string path, std::shared_ptr<node> parent) : path(std::move(path)), parent(std::move(parent)) {}
+
+        std::string path;
+        std::shared_ptr<node> parent;
+        dev_t dev {0};
+        ino_t ino {0};
+        row own;
+        std::atomic<uint64_t> bytes {0};        // own plus finished subtrees
+        std::atomic<uint64_t> files {0};
+        std::atomic<size_t> pending {1};        // itself, plus a count per subdirectory queued
+    };
+
+    struct walk_state {
+        walk_state(std::shared_ptr<measurement> result, std::stop_source stop, bool rescan)
+            : result(std::move(result)), stop(std::move(stop)), rescan(rescan) {}
+
+        std::shared_ptr<measurement> result;
+        dev_t device {0};       // the root's, set before anything below it is queued
+        std::stop_source stop;
+        bool rescan;
+    };
+
+    explicit dir_sizes(std::string const &path) : db_{path} {
+        db_.ensure_table("dir_size",
+            "dev INTEGER, ino INTEGER, mtime INTEGER, own_bytes INTEGER, own_files INTEGER, subdirs TEXT, "
+            "total_bytes INTEGER, total_files INTEGER, PRIMARY KEY (dev, ino)");
+    }
+
+    std::optional<row> lookup(dev_t dev, ino_t ino) {
+        std::optional<row> found;
+        try {
+            db_.for_each<int64_t, int64_t, int64_t, std::string_view, int64_t, int64_t>(
+                "SELECT mtime, own_bytes, own_files, subdirs, total_bytes, total_files FROM dir_size WHERE dev = ? AND ino = ?",
+                [&found](int64_t mtime, int64_t own_bytes, int64_t own_files, std::string_view subdirs, int64_t total_bytes, int64_t total_files) {
+                    row r {mtime, static_cast<uint64_t>(own_bytes), static_cast<uint64_t>(own_files), {}, total_bytes, total_files};
+                    while (!subdirs.empty()) {
+                        auto const end = subdirs.find('\n');
+                        r.subdirs.emplace_back(subdirs.substr(0, end));
+                        subdirs.remove_prefix(end == std::string_view::npos ? subdirs.size() : end + 1);
+                    }
+                    found = std::move(r);
+                }, static_cast<int64_t>(dev), static_cast<int64_t>(ino));
+        } catch (std::exception const &e) {
+            DB_ERROR_FMT("Directory size lookup failed: {}", e.what());
+        }
+        return found;
+    }
+
+    void store(node const &n) {
+        std::string subdirs;
+        for (auto const &name : n.own.subdirs) {
+            if (!subdirs.empty()) {
+                subdirs += '\n';
+            }
+            subdirs += name;
+        }
+        auto const key = std::format("{}:{}", n.dev, n.ino);
+        writes_.put(key, [dev = static_cast<int64_t>(n.dev), ino = static_cast<int64_t>(n.ino), own = n.own,
+                          subdirs = std::move(subdirs), bytes = static_cast<int64_t>(n.bytes.load()),
+                          files = static_cast<int64_t>(n.files.load())](hosting::db::sqlite &db) {
+            db.exec("INSERT OR REPLACE INTO dir_size (dev, ino, mtime, own_bytes, own_files, subdirs, total_bytes, total_files) "
+                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?)", nullptr, dev, ino, own.mtime_ns, static_cast<int64_t>(own.own_bytes),
+                    static_cast<int64_t>(own.own_files), subdirs, bytes, files);
+        });
+    }
+
+    void visit(std::shared_ptr<walk_state> const &walk, std::shared_ptr<node> n) {
+        scheduler()->submit([this, walk, n = std::move(n)](std::stop_token stoken) {
+            if (!stoken.stop_requested()) {
+                count_directory(walk, n);
+            }
+        }, task_priority::background, walk->stop);
+    }
+
+    void count_directory(std::shared_ptr<walk_state> const &walk, std::shared_ptr<node> const &n) {
+        auto const fd = ::open(n->path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        struct stat st {};
+        bool const root = !n->parent;
+        if (fd >= 0 && root && ::fstat(fd, &st) == 0) {
+            walk->device = st.st_dev;
+        }
+        if (fd < 0 || ::fstat(fd, &st) != 0 || st.st_dev != walk->device) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            finish(walk, n);      // unreadable, or another file system: counts as empty
+            return;
+        }
+        n->dev = st.st_dev;
+        n->ino = st.st_ino;
+        auto const mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+
+        auto cached = root || !walk->rescan ? lookup(st.st_dev, st.st_ino) : std::nullopt;
+        if (root && cached && cached->total_bytes >= 0) {
+            walk->result->last_bytes = cached->total_bytes;
+        }
+        if (walk->rescan) {
+            cached.reset();
+        }
+        if (cached && cached->mtime_ns == mtime_ns) {
+            ::close(fd);
+            n->own = std::move(*cached);
+        } else {
+            n->own = row {};
+            n->own.mtime_ns = mtime_ns;
+            if (auto *dir = ::fdopendir(fd)) {      // owns fd from here on
+                while (auto const *item = ::readdir(dir)) {
+                    std::string_view const name {item->d_name};
+                    if (name == "." || name == "..") {
+                        continue;
+                    }
+                    struct stat child {};
+                    if (::fstatat(fd, item->d_name, &child, AT_SYMLINK_NOFOLLOW) != 0) {
+                        continue;
+                    }
+                    if (S_ISDIR(child.st_mode)) {
+                        n->own.subdirs.emplace_back(name);
+                    } else {
+                        n->own.own_bytes += static_cast<uint64_t>(child.st_blocks) * 512;
+                        ++n->own.own_files;
+                    }
+                }
+                ::closedir(dir);
+            } else {
+                ::close(fd);
+            }
+        }
+
+        n->bytes += n->own.own_bytes;
+        n->files += n->own.own_files;
+        walk->result->bytes += n->own.own_bytes;
+        walk->result->files += n->own.own_files;
+        request_redraw();
+
+        n->pending += n->own.subdirs.size();
+        for (auto const &name : n->own.subdirs) {
+            visit(walk, std::make_shared<node>(n->path + '/' + name, n));
+        }
+        finish(walk, n);
+    }
+
+    // One part of n is counted; the last one stores it and hands its total to the parent
+    void finish(std::shared_ptr<walk_state> const &walk, std::shared_ptr<node> const &n) {
+        if (n->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        if (n->ino != 0) {
+            store(*n);
+        }
+        if (auto const &parent = n->parent) {
+            parent->bytes += n->bytes.load();
+            parent->files += n->files.load();
+            finish(walk, parent);
+        } else {
+            walk->result->done = true;
+            request_redraw();
+        }
+    }
+
+    hosting::db::sqlite db_;
+    hosting::db::write_behind writes_ {db_};
+};
+
+} // namespace rouen::helpers
@@ -0,0 +1,180 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// 3. All other includes
+#include "debug.hpp"
+
+namespace rouen::helpers {
+
+/**
+ * Tells subscribers when a directory's entries change: one inotify descriptor and one thread
+ * for the whole application, any number of subscriptions per directory. Only the directory
+ * itself is watched, not what is below it. The callback runs on the watch thread and only
+ * says something changed (a burst of changes may come as many calls), so it should just mark
+ * the listing stale; it may not subscribe or unsubscribe. Without inotify subscriptions never
+ * fire, and owners refresh by hand.
+ */
+class dir_watch {
+public:
+    // Held by the subscriber; dropping it ends the subscription
+    class subscription {
+    public:
+        ~subscription() { dir_watch::instance().remove(id_); }
+
+        subscription(subscription const &) = delete;
+        subscription &operator=(subscription const &) = delete;
+
+        // Whether changes will be reported at all
+        [[nodiscard]] bool active() const { return active_; }
+
+    private:
+        friend class dir_watch;
+        subscription(size_t id, bool active) : id_{id}, active_{active} {}
+
+        size_t id_;
+        bool active_;
+    };
+
+    static dir_watch &instance() {
+        static dir_watch watch;
+        return watch;
+    }
+
+    std::unique_ptr<subscription> subscribe(std::string const &path, std::function<void()> on_change) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto const id = ++last_id_;
+        int wd = -1;
+#ifdef __linux__
+        if (fd_ >= 0) {
+            wd = inotify_add_watch(fd_, path.c_str(), watch_mask);
+            if (wd < 0) {
+                SYS_WARN_FMT("Not watching {} for changes", path);
+            }
+        }
+#endif
+        if (wd >= 0) {
+            watchers_[wd].emplace_back(id, std::move(on_change));
+            ids_[id] = wd;
+        }
+        return std::unique_ptr<subscription>(new subscription(id, wd >= 0));
+    }
+
+    ~dir_watch() {
+        thread_.request_stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+#ifdef __linux__
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+#endif
+    }
+
+    dir_watch(dir_watch const &) = delete;
+    dir_watch &operator=(dir_watch const &) = delete;
+
+private:
+    using watcher = std::pair<size_t, std::function<void()>>;
+
+    dir_watch() {
+#ifdef __linux__
+        fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd_ < 0) {
+            SYS_WARN("inotify unavailable; directory listings refresh by hand only");
+        } else {
+            thread_ = std::jthread{[this](std::stop_token stoken) { watch_loop(stoken); }};
+        }
+#endif
+    }
+
+    void remove(size_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto const pos = ids_.find(id);
+        if (pos == ids_.end()) {
+            return;
+        }
+        auto const wd = pos->second;
+        ids_.erase(pos);
+        auto &list = watchers_[wd];
+        std::erase_if(list, [id](watcher const &w) { return w.first == id; });
+        if (list.empty()) {
+            watchers_.erase(wd);
+#ifdef __linux__
+            // Every subscription to a path shares its descriptor: it goes with the last one
+            inotify_rm_watch(fd_, wd);
+#endif
+        }
+    }
+
+#ifdef __linux__
+    static constexpr uint32_t watch_mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY
+        | IN_ATTRIB | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+    void watch_loop(std::stop_token stoken) {
+        alignas(inotify_event) char buffer[16 * 1024];
+        pollfd pfd {fd_, POLLIN, 0};
+        while (!stoken.stop_requested()) {
+            // The timeout only bounds how long shutdown waits
+            if (poll(&pfd, 1, 250) <= 0) {
+                continue;
+            }
+            auto const n = read(fd_, buffer, sizeof(buffer));
+            if (n <= 0) {
+                continue;
+            }
+            // Each descriptor once per read, however many events it had
+            std::vector<int> changed;
+            for (char const *at = buffer; at < buffer + n;) {
+                auto const *event = reinterpret_cast<inotify_event const *>(at);
+                at += sizeof(inotify_event) + event->len;
+                if (event->mask & IN_Q_OVERFLOW) {
+                    changed.clear();
+                    changed.push_back(-1);  // events were lost: everyone looks again
+                    break;
+                }
+                if (std::find(changed.begin(), changed.end(), event->wd) == changed.end()) {
+                    changed.push_back(event->wd);
+                }
+            }
+            if (changed.empty()) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto const &[wd, list] : watchers_) {
+                if (changed.front() == -1 || std::find(changed.begin(), changed.end(), wd) != changed.end()) {
+                    for (auto const &[id, on_change] : list) {
+                        on_change();
+                    }
+                }
+            }
+        }
+    }
+
+    int fd_ {-1};
+#endif
+    std::mutex mutex_;      // guards watchers_ and ids_; held while callbacks run
+    std::unordered_map<int, std::vector<watcher>> watchers_;
+    std::unordered_map<size_t, int> ids_;
+    size_t last_id_ {0};
+    std::jthread thread_;
+};
+
+} // namespace rouen::helpers
@@ -3,12 +3,15 @@
 #include <string>
 #include <format>
 #include <cstdlib>
+#include <map>
+#include <memory>
 #include <vector>
 #include <optional>
 #include <sstream>
 
 #include <glaze/glaze.hpp>
 
+#include "completion_cache.hpp"
 #include "cppgpt.hpp"
 #include "fetch.hpp"
 #include "api_keys.hpp"
@@ -19,7 +22,7 @@ namespace mail {
     class EmailMetadataAnalyzer {
     public:
         EmailMetadataAnalyzer(const std::string& db_path = "email_metadata.db") 
-            : repository_(db_path) {}
+            : repository_(MetadataRepository::open(db_path)) {}
 
         // Analyze email content and generate metadata using Grok AI
         std::string generate_metadata(const std::string& email_content) {
@@ -28,7 +31,7 @@ namespace mail {
                 std::string email_id = extract_email_id(email_content);
                 
                 // First check if we already have metadata for this email
-                auto existing = repository_.get(email_id);
+                auto existing = repository_->get(email_id);
                 if (existing) {
                     // We already have metadata for this email, return it
                     std::string json_result;
@@ -50,7 +53,7 @@ namespace mail {
                     metadata.summary = "Email metadata could not be processed. Grok API key not provided.";
                     
                     // Store the basic metadata
-                    repository_.store(metadata);
+                    repository_->store(metadata);
                     
                     std::string json_result;
                     auto write_res = glz::write_json(metadata, json_result);
@@ -64,16 +67,8 @@ namespace mail {
                 ignacionr::cppgpt gpt(api_key, ignacionr::cppgpt::grok_base);
                 
                 // Add system instructions for the AI
-                gpt.add_instructions(
-                    "You are an email analyzer. Your task is to analyze the email content and extract metadata. "
-                    "Determine the urgency level (0-2, where 0 is not urgent, 1 is moderate, 2 is highly urgent), "
-                    "categorize the email (work, personal, updates, promotions, etc.), "
-                    "create a concise summary of the content, suggest relevant tags, and identify potential actions with links. "
-                    "For actions, identify any URLs or actions the user might want to take based on the email content (e.g., 'Register' -> event registration URL). "
-                    "Respond only with a valid JSON object with the following keys: "
-                    "urgency (number), category (string), summary (string), tags (array of strings), "
-                    "action_links (object with action names as keys and URLs as values)."
-                );
+                gpt.add_instructions(std::format("{}Respond only with a valid JSON object with the following keys: {}",
+                    analysis_instructions, analysis_keys));
                 
                 // Prepare the message with the email content
                 // Truncate if needed to avoid excessive token usage
@@ -82,18 +77,16 @@ namespace mail {
                     truncated_content = truncated_content.substr(0, 20000) + "... [content truncated]";
                 }
                 
-                // Send the message to the Grok model
-                auto response = gpt.sendMessage(truncated_content, 
+                // Send the message to the Grok model, unless this same email was analyzed before
+                std::string ai_reply = gpt.sendMessageCached(truncated_content, 
                     [this](const std::string& url, const std::string& data, auto header_client) {
                         return fetcher_.post(url, data, header_client);
                     }, 
+                    rouen::helpers::completion_cache::shared(),
                     "user", 
                     "grok-2-latest"  // Use Grok's model
                 );
                 
-                // Extract the AI's response from the structured response
-                std::string ai_reply = response.choices[0].message.content;
-                
                 // Attempt to parse the AI's JSON response
                 EmailMetadata metadata;
                 
@@ -118,7 +111,7 @@ namespace mail {
                     fallback.tags = {"error", "unprocessed"};
                     
                     // Store the fallback metadata
-                    repository_.store(fallback);
+                    repository_->store(fallback);
                     
                     std::string json_result;
                     auto write_res = glz::write_json(fallback, json_result);
@@ -132,7 +125,7 @@ namespace mail {
                 metadata.id = email_id;
                 
                 // Store the metadata in the repository
-                repository_.store(metadata);
+                repository_->store(metadata);
                 
                 // Serialize the metadata back to JSON using Glaze
                 std::string json_result;
@@ -159,7 +152,7 @@ namespace mail {
                 error_metadata.tags = {"error"};
                 
                 // Store the error metadata
-                repository_.store(error_metadata);
+                repository_->store(error_metadata);
                 
                 std::string json_result;
                 auto write_res = glz::write_json(error_metadata, json_result);
@@ -170,27 +163,124 @@ namespace mail {
             }
         }
         
+        // Emails up to this size are analyzed together, several to a request
+        static constexpr size_t batch_max_emails = 8;
+        static constexpr size_t batch_email_chars = 4000;
+
+        // Metadata JSON for each of `emails`, in the same order. Those already in the repository
+        // are taken from it; small ones go to the model together in one request, keyed so the
+        // reply says which analysis is whose, and anything the batch reply misses or the larger
+        // emails go one by one through generate_metadata()
+        std::vector<std::string> generate_metadata_batch(const std::vector<std::string>& emails) {
+            std::vector<std::string> results(emails.size());
+            std::vector<size_t> batch;
+            for (size_t i = 0; i < emails.size(); ++i) {
+                if (auto existing = repository_->get(extract_email_id(emails[i]))) {
+                    results[i] = to_json(*existing);
+                } else if (emails[i].size() <= batch_email_chars && batch.size() < batch_max_emails) {
+                    batch.push_back(i);
+                }
+            }
+
+            std::string api_key = rouen::helpers::ApiKeys::get_grok_api_key();
+            if (batch.size() > 1 && !api_key.empty()) {
+                try {
+                    ignacionr::cppgpt gpt(api_key, ignacionr::cppgpt::grok_base);
+                    gpt.add_instructions(std::format(
+                        "{}You get several emails, each after a line 'Email <key>:'. Respond only with a valid JSON object "
+                        "with each key as a member, its value being an object with the following keys: {}",
+                        analysis_instructions, analysis_keys));
+                    std::string request;
+                    for (auto i : batch) {
+                        request += std::format("Email m{}:\n{}\n\n", i, emails[i]);
+                    }
+                    std::string ai_reply = gpt.sendMessageCached(request,
+                        [this](const std::string& url, const std::string& data, auto header_client) {
+                            return fetcher_.post(url, data, header_client);
+                        },
+                        rouen::helpers::completion_cache::shared(),
+                        "user",
+                        "grok-2-latest"
+                    );
+                    size_t json_start = ai_reply.find('{');
+                    size_t json_end = ai_reply.rfind('}');
+                    if (json_start != std::string::npos && json_end != std::string::npos) {
+                        ai_reply = ai_reply.substr(json_start, json_end + 1 - json_start);
+                    }
+                    std::map<std::string, EmailMetadata> replies;
+                    if (auto error = glz::read<glz::opts{.error_on_unknown_keys = false}>(replies, ai_reply)) {
+                        "notify"_sfn(std::format("Warning: Invalid batch JSON response from Grok: {}", glz::format_error(error)));
+                    }
+                    for (auto i : batch) {
+                        auto reply = replies.find(std::format("m{}", i));
+                        if (reply == replies.end()) {
+                            continue;
+                        }
+                        reply->second.id = extract_email_id(emails[i]);
+                        repository_->store(reply->second);
+                        results[i] = to_json(reply->second);
+                    }
+                } catch (const std::exception& e) {
+                    "notify"_sfn(std::format("Batched email analysis failed: {}", e.what()));
+                }
+            }
+
+            for (size_t i = 0; i < emails.size(); ++i) {
+                if (results[i].empty()) {
+                    results[i] = generate_metadata(emails[i]);
+                }
+            }
+            return results;
+        }
+
+        // The metadata already stored for the message these headers belong to, as JSON
+        std::optional<std::string> stored_metadata(const std::string& header) {
+            auto existing = repository_->get(extract_email_id(header + "\r\n\r\n"));
+            if (!existing) {
+                return std::nullopt;
+            }
+            return to_json(*existing);
+        }
+
         // Get metadata from repository by ID
         std::optional<EmailMetadata> get_metadata(const std::string& email_id) {
-            return repository_.get(email_id);
+            return repository_->get(email_id);
         }
         
         // Get recent email metadata
         std::vector<EmailMetadata> get_recent(int limit = 20) {
-            return repository_.get_recent(limit);
+            return repository_->get_recent(limit);
         }
         
         // Get email metadata by category
         std::vector<EmailMetadata> get_by_category(const std::string& category) {
-            return repository_.get_by_category(category);
+            return repository_->get_by_category(category);
         }
         
         // Get email metadata by tag
         std::vector<EmailMetadata> get_by_tag(const std::string& tag) {
-            return repository_.get_by_tag(tag);
+            return repository_->get_by_tag(tag);
         }
 
     private:
+        static constexpr auto analysis_instructions =
+            "You are an email analyzer. Your task is to analyze the email content and extract metadata. "
+            "Determine the urgency level (0-2, where 0 is not urgent, 1 is moderate, 2 is highly urgent), "
+            "categorize the email (work, personal, updates, promotions, etc.), "
+            "create a concise summary of the content, suggest relevant tags, and identify potential actions with links. "
+            "For actions, identify any URLs or actions the user might want to take based on the email content (e.g., 'Register' -> event registration URL). ";
+        static constexpr auto analysis_keys =
+            "urgency (number), category (string), summary (string), tags (array of strings), "
+            "action_links (object with action names as keys and URLs as values).";
+
+        static std::string to_json(const EmailMetadata& metadata) {
+            std::string json_result;
+            if (auto write_res = glz::write_json(metadata, json_result)) {
+                "notify"_sfn(std::format("JSON serialization error: {}", glz::format_error(write_res)));
+            }
+            return json_result;
+        }
+
         // Extract email unique ID from headers
         std::string extract_email_id(const std::string& email_content) {
             // Common header fields that contain unique IDs
@@ -279,6 +369,6 @@ namespace mail {
         }
 
         http::fetch fetcher_;
-        MetadataRepository repository_;
+        std::shared_ptr<MetadataRepository> repository_;
     };
 }
@@ -1,14 +1,36 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 #include <curl/curl.h>
 #include <sstream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <functional>
+#include <thread>
+#include <unordered_map>
 
 #include "debug.hpp"
+#include "http_buffer.hpp"
+#include "http_cache.hpp"
+#include "http_telemetry.hpp"
+#include "memory_accounting.hpp"
+#include "rate_limiter.hpp"
+#include "task_scheduler.hpp"
+#include "trace.hpp"
 
 #define HTTP_ERROR(message) LOG_COMPONENT("HTTP", LOG_LEVEL_ERROR, message)
 #define HTTP_ERROR_FMT(fmt, ...) HTTP_ERROR(debug::format_log(fmt, __VA_ARGS__))
@@ -21,157 +43,1198 @@
 
 namespace http {
 
-// CURL RAII wrapper
-class curl_handle {
+// "scheme://host:port" part of a URL, used to group reusable connections
+inline std::string host_key(std::string_view url) {
+    auto const scheme_end = url.find("://");
+    auto const host_start = scheme_end == std::string_view::npos ? 0 : scheme_end + 3;
+    auto const host_end = url.find_first_of("/?#", host_start);
+    return std::string{url.substr(0, host_end)};
+}
+
+/**
+ * Process-wide libcurl state shared by every fetch.
+ *
+ * Easy handles are kept per host after use: curl_easy_reset() clears their options but
+ * keeps their live connections, so the next request to that host skips TCP and TLS
+ * setup. The share object adds a common DNS cache and TLS session cache on top, so even
+ * a fresh handle resumes sessions instead of doing full handshakes.
+ *
+ * Connections themselves are not put in the share: libcurl does not support using a
+ * shared connection cache from several threads at once, and fetch is called from many.
+ */
+class connection_pool {
 public:
-    curl_handle() : handle(curl_easy_init()) {
+    static constexpr size_t max_idle_per_host = 8;
+
+    // An easy handle checked out of the pool; goes back to it (reset) when destroyed
+    class lease {
+    public:
+        lease(connection_pool& pool, std::string key, CURL* handle)
+            : pool_(&pool), key_(std::move(key)), handle_(handle) {}
+        lease(lease&& other) noexcept
+            : pool_(other.pool_), key_(std::move(other.key_)), handle_(other.handle_) {
+            other.handle_ = nullptr;
+        }
+        lease(lease const&) = delete;
+        lease& operator=(lease const&) = delete;
+        lease& operator=(lease&&) = delete;
+        ~lease() {
+            if (handle_) {
+                pool_->release(key_, handle_);
+            }
+        }
+
+        CURL* get() const { return handle_; }
+
+    private:
+        connection_pool* pool_;
+        std::string key_;
+        CURL* handle_;
+    };
+
+    static connection_pool& instance() {
+        static connection_pool pool;
+        return pool;
+    }
+
+    lease acquire(std::string_view url) {
+        auto key = host_key(url);
+        CURL* handle = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& idle = idle_[key];
+            if (!idle.empty()) {
+                handle = idle.back();
+                idle.pop_back();
+            }
+        }
         if (!handle) {
-            throw std::runtime_error("Failed to initialize CURL");
+            handle = curl_easy_init();
+            if (!handle) {
+                throw std::runtime_error("Failed to initialize CURL");
+            }
+            HTTP_DEBUG_FMT("New connection handle for {}", key);
+        }
+        curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        return lease{*this, std::move(key), handle};
+    }
+
+    connection_pool(connection_pool const&) = delete;
+    connection_pool& operator=(connection_pool const&) = delete;
+
+private:
+    connection_pool() {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        HTTP_INFO("CURL globally initialized");
+        share_ = curl_share_init();
+        curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lock_share);
+        curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlock_share);
+        curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    ~connection_pool() {
+        for (auto& [key, idle] : idle_) {
+            for (auto* handle : idle) {
+                curl_easy_cleanup(handle);
+            }
         }
+        curl_share_cleanup(share_);
     }
-    
-    ~curl_handle() {
-        if (handle) {
-            curl_easy_cleanup(handle);
+
+    void release(std::string const& key, CURL* handle) {
+        curl_easy_reset(handle);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& idle = idle_[key];
+            if (idle.size() < max_idle_per_host) {
+                idle.push_back(handle);
+                return;
+            }
         }
+        curl_easy_cleanup(handle);
+    }
+
+    static void lock_share(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+        static_cast<connection_pool*>(userptr)->share_locks_[static_cast<size_t>(data) % share_locks_size].lock();
     }
-    
-    // No copying
-    curl_handle(const curl_handle&) = delete;
-    curl_handle& operator=(const curl_handle&) = delete;
-    
-    // Access the underlying handle
-    CURL* get() { return handle; }
-    
+
+    static void unlock_share(CURL*, curl_lock_data data, void* userptr) {
+        static_cast<connection_pool*>(userptr)->share_locks_[static_cast<size_t>(data) % share_locks_size].unlock();
+    }
+
+    static constexpr size_t share_locks_size = CURL_LOCK_DATA_LAST;
+
+    CURLSH* share_ {nullptr};
+    std::array<std::mutex, share_locks_size> share_locks_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::vector<CURL*>> idle_;
+};
+
+// Owns a curl header list
+class header_list {
+public:
+    header_list() = default;
+    header_list(header_list const&) = delete;
+    header_list& operator=(header_list const&) = delete;
+    ~header_list() {
+        if (list_) {
+            curl_slist_free_all(list_);
+        }
+    }
+
+    void append(std::string const& header) {
+        list_ = curl_slist_append(list_, header.c_str());
+    }
+
+    curl_slist* get() const { return list_; }
+
 private:
-    CURL* handle;
+    curl_slist* list_ {nullptr};
 };
 
-// Default callback function for CURL to write data
-static size_t write_callback(char* contents, size_t size, size_t nmemb, void* userp) {
-    size_t real_size = size * nmemb;
-    std::string* response = static_cast<std::string*>(userp);
-    response->append(contents, real_size);
-    return real_size;
+/**
+ * Receives a response body chunk by chunk as it arrives, e.g. to feed a streaming parser
+ * without holding the whole body. With the engine, it is called on the I/O thread.
+ */
+class body_sink {
+public:
+    virtual ~body_sink() = default;
+
+    // Called before the first chunk when the server sent a Content-Length. With a
+    // compressed transfer this is the compressed size, so treat it as a lower bound.
+    virtual void expect(size_t /*content_length*/) {}
+
+    // Return false to abort the transfer
+    virtual bool write(std::string_view chunk) = 0;
+};
+
+// Collects the body into a string, reserved up front from Content-Length
+class string_sink : public body_sink {
+public:
+    explicit string_sink(std::string& out) : out_(out) {}
+
+    void expect(size_t content_length) override {
+        out_.reserve(out_.size() + content_length);
+    }
+
+    bool write(std::string_view chunk) override {
+        out_.append(chunk);
+        return true;
+    }
+
+private:
+    std::string& out_;
+};
+
+// Hands each chunk to a callable, for bodies read as they arrive (server-sent events)
+class callback_sink : public body_sink {
+public:
+    explicit callback_sink(std::function<bool(std::string_view)> on_chunk) : on_chunk_(std::move(on_chunk)) {}
+
+    bool write(std::string_view chunk) override {
+        return on_chunk_(chunk);
+    }
+
+private:
+    std::function<bool(std::string_view)> on_chunk_;
+};
+
+// Collects the body into an http::buffer. Chunks never move once filled: the first is
+// sized from Content-Length, and a body outgrowing it continues in a new chunk.
+class buffer_sink : public body_sink {
+public:
+    static constexpr size_t min_chunk = 64 * 1024;
+    static constexpr size_t max_chunk = 1024 * 1024;
+
+    void expect(size_t content_length) override {
+        if (chunks_.empty()) {
+            chunks_.emplace_back().reserve(content_length);
+        }
+    }
+
+    bool write(std::string_view chunk) override {
+        if (chunks_.empty() || chunks_.back().capacity() - chunks_.back().size() < chunk.size()) {
+            if (!chunks_.empty() && chunks_.back().empty()) {
+                chunks_.pop_back();
+            }
+            chunks_.emplace_back().reserve(std::max(next_, chunk.size()));
+            next_ = std::min(next_ * 2, max_chunk);
+        }
+        chunks_.back().append(chunk);
+        return true;
+    }
+
+    // The body so far; the sink starts over empty
+    [[nodiscard]] buffer take() {
+        next_ = min_chunk;
+        return buffer{std::exchange(chunks_, {})};
+    }
+
+private:
+    std::vector<std::string> chunks_;
+    size_t next_ {min_chunk};
+};
+
+// Content-Length of the transfer in progress, 0 if unknown
+inline size_t content_length(CURL* curl) {
+    curl_off_t length = -1;
+    if (curl && curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) == CURLE_OK && length > 0) {
+        return static_cast<size_t>(length);
+    }
+    return 0;
+}
+
+// CURLOPT_WRITEFUNCTION adapter feeding a body_sink
+struct sink_writer {
+    CURL* curl {nullptr};
+    body_sink* sink {nullptr};
+    bool started {false};
+
+    static size_t write(void* data, size_t size, size_t nmemb, void* userp) {
+        auto self = static_cast<sink_writer*>(userp);
+        if (!self->started) {
+            self->started = true;
+            if (auto const length = content_length(self->curl)) {
+                self->sink->expect(length);
+            }
+        }
+        return self->sink->write({static_cast<char*>(data), size * nmemb}) ? size * nmemb : 0;
+    }
+};
+
+// Phase timings and sizes of a finished transfer, for the telemetry
+inline transfer_sample sample_transfer(CURL* curl, CURLcode code, long status) {
+    auto info = [curl](CURLINFO what) -> uint64_t {
+        curl_off_t value = 0;
+        return curl_easy_getinfo(curl, what, &value) == CURLE_OK && value > 0 ? static_cast<uint64_t>(value) : 0;
+    };
+    auto since = [](uint64_t end, uint64_t start) { return end > start ? end - start : 0; };
+    transfer_sample t;
+    t.status = status;
+    t.failed = code != CURLE_OK || status >= 400;
+    auto const dns = info(CURLINFO_NAMELOOKUP_TIME_T);
+    auto const connect = info(CURLINFO_CONNECT_TIME_T);
+    auto const tls = info(CURLINFO_APPCONNECT_TIME_T);
+    t.dns_us = dns;
+    t.connect_us = since(connect, dns);
+    t.tls_us = tls ? since(tls, connect) : 0;
+    t.ttfb_us = info(CURLINFO_STARTTRANSFER_TIME_T);
+    t.total_us = info(CURLINFO_TOTAL_TIME_T);
+    t.bytes_in = info(CURLINFO_SIZE_DOWNLOAD_T);
+    t.bytes_out = info(CURLINFO_SIZE_UPLOAD_T);
+    long version = 0;
+    curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &version);
+    t.http2 = version == CURL_HTTP_VERSION_2_0 || version == CURL_HTTP_VERSION_3;
+    return t;
+}
+
+// A finished transfer as a span of the trace, ending now; the URL without its scheme is the detail
+inline void trace_transfer(std::string_view url, transfer_sample const& t) {
+    using rouen::helpers::trace;
+    if (!trace::enabled()) {
+        return;
+    }
+    if (auto const scheme = url.find("://"); scheme != std::string_view::npos) {
+        url.remove_prefix(scheme + 3);
+    }
+    auto const end = trace::clock::now();
+    trace::async("HTTP", "fetch", end - std::chrono::microseconds{t.total_us}, end, url);
+}
+
+// A request's headers as one string, one per line
+inline std::string joined_headers(curl_slist const* headers) {
+    std::string result;
+    for (auto h = headers; h; h = h->next) {
+        result += h->data;
+        result += '\n';
+    }
+    return result;
 }
 
-// HTTP client to fetch data from URLs with configurable timeout
+/**
+ * Conditional-request bookkeeping for one cached GET: sends the stored validators,
+ * records the new ones and answers a 304 with the stored body.
+ */
+class cache_session {
+public:
+    using WriteCallback = size_t (*)(void*, size_t, size_t, void*);
+
+    // Looks the response up on the calling thread
+    cache_session(std::string const& url, curl_slist const* headers)
+        : url_(url), key_(response_cache::key(url, joined_headers(headers))), stored_(response_cache::instance().lookup(key_)) {}
+
+    // With the response looked up already, elsewhere
+    cache_session(std::string url, std::string key, std::optional<response_cache::entry> stored)
+        : url_(std::move(url)), key_(std::move(key)), stored_(std::move(stored)) {}
+
+    cache_session(cache_session const&) = delete;
+    cache_session& operator=(cache_session const&) = delete;
+
+    // Within the host's TTL the stored body is the answer; no request needed
+    [[nodiscard]] bool fresh() const {
+        return stored_ && response_cache::instance().fresh(*stored_, url_);
+    }
+
+    void add_validators(header_list& headers) const {
+        if (!stored_) {
+            return;
+        }
+        if (!stored_->etag.empty()) {
+            headers.append("If-None-Match: " + stored_->etag);
+        }
+        if (!stored_->last_modified.empty()) {
+            headers.append("If-Modified-Since: " + stored_->last_modified);
+        }
+    }
+
+    // Where the body goes: to `forward` if set, else into *body
+    void set_writer(WriteCallback forward, void* forward_data, std::string* body) {
+        forward_ = forward;
+        forward_data_ = forward_data;
+        body_ = body;
+    }
+
+    // Routes the transfer's headers and body through the session
+    void attach(CURL* curl) {
+        curl_ = curl;
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, on_header);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, this);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, on_write);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+    }
+
+    // Hands the stored body to the writer, as if it had just been downloaded
+    void deliver_stored() {
+        auto& body = stored_->body;
+        if (forward_) {
+            forward_(body.data(), 1, body.size(), forward_data_);
+        } else if (body_) {
+            *body_ = std::move(body);   // delivered once, nothing reads it afterwards
+        }
+    }
+
+    // After the transfer: stores a new response, or answers a 304 from the cache
+    // (unless `deliver` is false: the caller already has the unchanged body)
+    void complete(long status, bool deliver = true) {
+        auto& cache = response_cache::instance();
+        if (status == 304 && stored_) {
+            HTTP_DEBUG_FMT("Not modified, serving cached {}", url_);
+            cache.touch(key_);
+            if (deliver) {
+                deliver_stored();
+            }
+        } else if (status == 200 && (!etag_.empty() || !last_modified_.empty() || cache.ttl(url_).count() > 0)) {
+            cache.store(key_, etag_, last_modified_, forward_ ? copy_ : *body_);
+        }
+    }
+
+private:
+    static size_t on_header(char* data, size_t size, size_t nitems, void* userp) {
+        auto self = static_cast<cache_session*>(userp);
+        std::string_view line{data, size * nitems};
+        auto const colon = line.find(':');
+        if (colon != std::string_view::npos) {
+            auto name = line.substr(0, colon);
+            auto value = line.substr(colon + 1);
+            auto const first = value.find_first_not_of(" \t");
+            auto const last = value.find_last_not_of(" \t\r\n");
+            value = first == std::string_view::npos ? std::string_view{} : value.substr(first, last - first + 1);
+            auto is = [name](std::string_view expected) {
+                return name.size() == expected.size() &&
+                    std::equal(name.begin(), name.end(), expected.begin(), [](char a, char b) {
+                        return std::tolower(static_cast<unsigned char>(a)) == b;
+                    });
+            };
+            if (is("etag")) {
+                self->etag_ = value;
+            } else if (is("last-modified")) {
+                self->last_modified_ = value;
+            }
+        }
+        return size * nitems;
+    }
+
+    static size_t on_write(char* data, size_t size, size_t nmemb, void* userp) {
+        auto self = static_cast<cache_session*>(userp);
+        if (self->forward_) {
+            self->copy_.append(data, size * nmemb);
+            return self->forward_(data, size, nmemb, self->forward_data_);
+        }
+        if (self->body_->empty()) {
+            self->body_->reserve(content_length(self->curl_));
+        }
+        self->body_->append(data, size * nmemb);
+        return size * nmemb;
+    }
+
+    std::string url_;
+    std::string key_;
+    std::optional<response_cache::entry> stored_;
+    std::string etag_;
+    std::string last_modified_;
+    std::string copy_;                  // what a custom writer was given, for storing
+    WriteCallback forward_ {nullptr};
+    void* forward_data_ {nullptr};
+    std::string* body_ {nullptr};
+    CURL* curl_ {nullptr};
+};
+
+/**
+ * One HTTP request for the engine. A body makes it a POST.
+ * With `sink` (or the older `write` callback) set the response body streams there instead
+ * of into response::body; it is then called on the engine's I/O thread.
+ */
+struct request {
+    using WriteCallback = size_t (*)(void*, size_t, size_t, void*);
+
+    std::string url;
+    std::vector<std::string> headers {};
+    std::optional<std::string> body {};
+    long timeout {30};             // seconds
+    long connect_timeout {10};     // seconds
+    WriteCallback write {nullptr};
+    void* write_data {nullptr};
+    body_sink* sink {nullptr};     // must outlive the transfer
+    bool cached {false};           // GET through the response_cache (see http_cache.hpp)
+    bool skip_unchanged {false};   // with cached: complete with status 304 and no body when unchanged
+    bool coalesce {true};          // may share an identical GET already in flight (single_flight)
+    bool adaptive_timeout {false}; // `timeout` is only the ceiling; see telemetry::timeout_for()
+    // GETs only: if nothing arrived after this long, a second identical request races the first
+    // and the first good response wins. A write target then receives the winner's body at the end.
+    std::chrono::milliseconds hedge_after {0};
+    // GETs only: the body from this byte on (a Range request), sent uncompressed so byte
+    // offsets stay meaningful. A server ignoring the range fails the transfer with status 200.
+    std::optional<uint64_t> range_from {};
+    uint64_t max_recv_speed {0};   // bytes per second for this transfer, 0 for no limit
+};
+
+struct response {
+    long status {0};
+    std::string body;
+    std::string error;  // empty on success; HTTP status >= 400 counts as an error
+    std::string link {};    // the Link header, for APIs that paginate with it
+
+    [[nodiscard]] bool ok() const { return error.empty(); }
+};
+
+/**
+ * Single-flight registry: concurrent GETs for the same URL and headers (auth included)
+ * share one transfer, blocking fetch and engine alike. The first caller leads and
+ * lands the response; everyone who joined meanwhile gets a copy.
+ */
+class single_flight {
+public:
+    // nullopt: the leader gave up (cancelled), the waiter performs its own request
+    using waiter = std::function<void(std::optional<response>)>;
+
+    static single_flight& instance() {
+        static single_flight registry;
+        return registry;
+    }
+
+    static std::string key(std::string_view url, curl_slist const* headers) {
+        std::string result{"GET "};
+        result += url;
+        result += '\n';
+        result += joined_headers(headers);
+        return result;
+    }
+
+    // True if the caller leads and must land() or abandon(); otherwise `w` gets the result
+    bool join(std::string const& key, waiter w) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [pos, leader] = flights_.try_emplace(key);
+        if (!leader) {
+            pos->second.push_back(std::move(w));
+        }
+        return leader;
+    }
+
+    void land(std::string const& key, response const& r) {
+        for (auto& w : take(key)) {
+            w(r);
+        }
+    }
+
+    void abandon(std::string const& key) {
+        for (auto& w : take(key)) {
+            w(std::nullopt);
+        }
+    }
+
+private:
+    std::vector<waiter> take(std::string const& key) {
+        std::vector<waiter> waiters;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto pos = flights_.find(key); pos != flights_.end()) {
+            waiters = std::move(pos->second);
+            flights_.erase(pos);
+        }
+        if (!waiters.empty()) {
+            HTTP_DEBUG_FMT("Sharing one response among {} extra requests", waiters.size());
+        }
+        return waiters;
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::vector<waiter>> flights_;
+};
+
+/**
+ * Runs any number of transfers concurrently on a single I/O thread with curl_multi.
+ *
+ * Completion callbacks run on the I/O thread and must stay short: hand parsing or
+ * database work to the task scheduler. Handles come from the connection_pool, so
+ * transfers share DNS, TLS sessions and idle connections with the blocking fetch.
+ */
+class engine {
+    struct state;
+
+public:
+    using callback = std::function<void(response)>;
+
+    static constexpr long max_host_connections = 8;
+
+    // Handle to a submitted transfer
+    class transfer {
+    public:
+        transfer() = default;
+        explicit transfer(std::shared_ptr<state> s) : state_(std::move(s)) {}
+
+        // After cancel() returns the completion callback has run or never will
+        void cancel() {
+            if (state_) {
+                engine::instance().cancel(state_);
+            }
+        }
+
+        [[nodiscard]] bool done() const {
+            return state_ && state_->done.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::shared_ptr<state> state_;
+    };
+
+    // co_await engine::instance().co_fetch(req); resumes on the I/O thread
+    class awaitable {
+    public:
+        explicit awaitable(request req) : request_(std::move(req)) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            engine::instance().submit(std::move(request_), [this, handle](response r) {
+                response_ = std::move(r);
+                handle.resume();
+            });
+        }
+
+        response await_resume() { return std::move(response_); }
+
+    private:
+        request request_;
+        response response_;
+    };
+
+    static engine& instance() {
+        static engine e;
+        return e;
+    }
+
+    transfer submit(request req, callback on_done) {
+        auto s = std::make_shared<state>();
+        s->req = std::move(req);
+        s->on_done = std::move(on_done);
+        if (s->req.hedge_after.count() > 0 && !s->req.body) {
+            post([this, s]() { start_hedged(s); });
+            return transfer{s};
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            incoming_.push_back(s);
+        }
+        curl_multi_wakeup(multi_);
+        return transfer{s};
+    }
+
+    // The body as a future; failures surface as std::runtime_error like fetch's
+    std::future<std::string> get(request req) {
+        auto promise = std::make_shared<std::promise<std::string>>();
+        auto result = promise->get_future();
+        submit(std::move(req), [promise](response r) {
+            if (r.ok()) {
+                promise->set_value(std::move(r.body));
+            } else {
+                promise->set_exception(std::make_exception_ptr(std::runtime_error(r.error)));
+            }
+        });
+        return result;
+    }
+
+    // GET into a chunked buffer that parsers and caches can share without copying
+    std::future<buffer> download(request req) {
+        auto sink = std::make_shared<buffer_sink>();
+        auto promise = std::make_shared<std::promise<buffer>>();
+        auto result = promise->get_future();
+        req.sink = sink.get();
+        submit(std::move(req), [sink, promise](response r) {
+            if (r.ok()) {
+                promise->set_value(sink->take());
+            } else {
+                promise->set_exception(std::make_exception_ptr(std::runtime_error(r.error)));
+            }
+        });
+        return result;
+    }
+
+    awaitable co_fetch(request req) {
+        return awaitable{std::move(req)};
+    }
+
+    engine(engine const&) = delete;
+    engine& operator=(engine const&) = delete;
+
+private:
+    struct state {
+        request req;
+        callback on_done;
+        std::optional<connection_pool::lease> handle;
+        header_list headers;
+        std::optional<cache_session> cache;
+        std::string body;
+        string_sink collect {body};
+        sink_writer writer;
+        request::WriteCallback forward {nullptr};   // custom write target, if any
+        void* forward_data {nullptr};
+        std::string flight;             // single_flight key when the request may be shared
+        bool leads {false};
+        std::string host;               // rate_limiter key
+        bool admitted {false};          // holds a rate_limiter slot
+        int retries {0};
+        std::vector<std::shared_ptr<state>> attempts;  // a hedged request's racing transfers
+        int outstanding {0};            // attempts not finished yet
+        bool hedge {false};             // a racing attempt: wants its own connection
+        std::mutex completion;          // held while on_done runs
+        std::atomic<bool> cancelled {false};
+        std::atomic<bool> done {false};
+    };
+
+    engine() {
+        connection_pool::instance();  // constructed first so they outlive the engine
+        response_cache::instance();
+        multi_ = curl_multi_init();
+        curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+        curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        io_thread_ = std::jthread([this](std::stop_token stoken) {
+            rouen::helpers::memory::scope memory_tag{"http"};
+            rouen::helpers::trace::name_thread("http");
+            run(stoken);
+        });
+    }
+
+    ~engine() {
+        io_thread_.request_stop();
+        curl_multi_wakeup(multi_);
+        io_thread_.join();
+        for (auto& [easy, s] : active_) {
+            curl_multi_remove_handle(multi_, easy);
+        }
+        active_.clear();
+        curl_multi_cleanup(multi_);
+    }
+
+    void cancel(std::shared_ptr<state> const& s) {
+        s->cancelled.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cancelled_.push_back(s);
+        }
+        curl_multi_wakeup(multi_);
+        if (std::this_thread::get_id() != io_thread_.get_id()) {
+            // Wait out a callback that may be running right now
+            std::lock_guard<std::mutex> lock(s->completion);
+        }
+    }
+
+    // `proxy` never touches curl itself: it runs attempts and completes with the first good one
+    void start_hedged(std::shared_ptr<state> const& proxy) {
+        if (proxy->cancelled.load(std::memory_order_acquire)) {
+            return;
+        }
+        auto attempt = proxy->req;
+        attempt.write = nullptr;     // each attempt buffers; the winner is replayed below
+        attempt.write_data = nullptr;
+        attempt.sink = nullptr;
+        attempt.coalesce = false;    // an identical in-flight GET would just be joined
+        attempt.hedge_after = std::chrono::milliseconds{0};
+        auto launch_attempt = [this, proxy, attempt]() {
+            auto a = std::make_shared<state>();
+            a->req = attempt;
+            a->hedge = !proxy->attempts.empty();
+            a->on_done = [this, proxy, winner = a.get()](response r) { settle_hedged(proxy, winner, std::move(r)); };
+            proxy->attempts.push_back(a);
+            ++proxy->outstanding;
+            start(a);
+        };
+        launch_attempt();
+        post_at(rate_limiter::clock::now() + proxy->req.hedge_after, [this, proxy, launch_attempt]() {
+            if (!proxy->done.load(std::memory_order_acquire) && !proxy->cancelled.load(std::memory_order_acquire)) {
+                HTTP_DEBUG_FMT("No response after {} ms, hedging GET {}", proxy->req.hedge_after.count(), proxy->req.url);
+                launch_attempt();
+            }
+        });
+    }
+
+    // Runs as `winner`'s completion callback, i.e. under its completion lock
+    void settle_hedged(std::shared_ptr<state> const& proxy, state const* winner, response r) {
+        --proxy->outstanding;
+        if (proxy->done.load(std::memory_order_acquire)) {
+            return;
+        }
+        // An error only counts once nothing else is racing
+        if (!r.ok() && proxy->outstanding > 0) {
+            return;
+        }
+        for (auto const& a : proxy->attempts) {
+            if (a.get() != winner && !a->done.load(std::memory_order_acquire)) {
+                a->cancelled.store(true, std::memory_order_release);
+                drop(a);
+            }
+        }
+        if (r.ok() && r.status != 304 && (proxy->req.sink || proxy->req.write)) {
+            auto const size = r.body.size();
+            bool accepted = true;
+            if (proxy->req.sink) {
+                proxy->req.sink->expect(size);
+                accepted = proxy->req.sink->write(r.body);
+            } else {
+                accepted = proxy->req.write(r.body.data(), 1, size, proxy->req.write_data) == size;
+            }
+            r.body.clear();
+            if (!accepted) {
+                r.error = "Write target rejected the response";
+            }
+        }
+        complete(proxy, std::move(r));
+    }
+
+    void start(std::shared_ptr<state> const& s) {
+        for (auto const& header : s->req.headers) {
+            s->headers.append(header);
+        }
+        s->host = rate_limiter::host_name(s->req.url);
+        // Only plain GETs into response::body can be shared
+        if (s->req.coalesce && !s->req.body && !s->req.write && !s->req.sink && !s->req.skip_unchanged) {
+            s->flight = single_flight::key(s->req.url, s->headers.get());
+        }
+        launch(s);
+    }
+
+    // From any thread: run `task` on the I/O thread
+    void post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        curl_multi_wakeup(multi_);
+    }
+
+    // I/O thread only: run `task` at `when`
+    void post_at(rate_limiter::clock::time_point when, std::function<void()> task) {
+        timers_.emplace(when, std::move(task));
+    }
+
+    void launch(std::shared_ptr<state> const& s) {
+        if (!s->flight.empty()) {
+            s->leads = single_flight::instance().join(s->flight, [this, s](std::optional<response> r) {
+                post([this, s, r = std::move(r)]() mutable {
+                    if (s->cancelled.load(std::memory_order_acquire)) {
+                        return;
+                    }
+                    if (r) {
+                        complete(s, std::move(*r));
+                    } else {
+                        launch(s);
+                    }
+                });
+            });
+            if (!s->leads) {
+                HTTP_DEBUG_FMT("Joining in-flight GET {}", s->req.url);
+                return;
+            }
+        }
+        s->forward = s->req.write;
+        s->forward_data = s->req.write_data;
+        if (s->req.sink) {
+            s->writer.sink = s->req.sink;
+            s->forward = &sink_writer::write;
+            s->forward_data = &s->writer;
+        }
+        if (s->req.cached && !s->req.body) {
+            look_up(s);
+            return;
+        }
+        admit(s);
+    }
+
+    // The stored response is read on the task_scheduler, not on the I/O thread; the request
+    // comes back here with it
+    void look_up(std::shared_ptr<state> const& s) {
+        auto key = response_cache::key(s->req.url, joined_headers(s->headers.get()));
+        auto const scheduler = rouen::helpers::scheduler();
+        if (!scheduler) {
+            auto stored = response_cache::instance().lookup(key);
+            serve_or_admit(s, std::move(key), std::move(stored));
+            return;
+        }
+        scheduler->submit([this, s, key = std::move(key)](std::stop_token) mutable {
+            auto stored = response_cache::instance().lookup(key);
+            post([this, s, key = std::move(key), stored = std::move(stored)]() mutable {
+                if (!s->cancelled.load(std::memory_order_acquire)) {
+                    serve_or_admit(s, std::move(key), std::move(stored));
+                }
+            });
+        }, rouen::helpers::task_priority::high);
+    }
+
+    void serve_or_admit(std::shared_ptr<state> const& s, std::string key, std::optional<response_cache::entry> stored) {
+        s->cache.emplace(s->req.url, std::move(key), std::move(stored));
+        s->cache->set_writer(s->forward, s->forward_data, &s->body);
+        if (s->cache->fresh()) {
+            HTTP_DEBUG_FMT("Serving {} from cache", s->req.url);
+            if (s->req.skip_unchanged) {
+                complete(s, response{304, {}, {}});
+                return;
+            }
+            s->cache->deliver_stored();
+            complete(s, response{200, std::move(s->body), {}});
+            return;
+        }
+        s->cache->add_validators(s->headers);
+        admit(s);
+    }
+
+    // Starts the transfer once the host's rate_limiter allows it; until then it waits
+    // in the host's queue, in submission order
+    void admit(std::shared_ptr<state> const& s) {
+        if (auto pos = waiting_.find(s->host); pos != waiting_.end()) {
+            pos->second.queue.push_back(s);
+            return;
+        }
+        auto const wait = rate_limiter::instance().try_acquire(s->host);
+        if (wait > rate_limiter::clock::duration::zero()) {
+            auto& w = waiting_[s->host];
+            w.queue.push_back(s);
+            w.retry = rate_limiter::clock::now() + wait;
+            return;
+        }
+        open(s);
+    }
+
+    // Starts queued requests whose host allows them by now
+    void drain_waiting() {
+        auto& limiter = rate_limiter::instance();
+        auto const now = rate_limiter::clock::now();
+        for (auto pos = waiting_.begin(); pos != waiting_.end();) {
+            auto& [host, w] = *pos;
+            while (!w.queue.empty() && w.retry <= now) {
+                if (w.queue.front()->cancelled.load(std::memory_order_acquire)) {
+                    w.queue.pop_front();
+                    continue;
+                }
+                auto const wait = limiter.try_acquire(host);
+                if (wait > rate_limiter::clock::duration::zero()) {
+                    w.retry = now + wait;
+                    break;
+                }
+                auto s = std::move(w.queue.front());
+                w.queue.pop_front();
+                open(s);
+            }
+            pos = w.queue.empty() ? waiting_.erase(pos) : std::next(pos);
+        }
+    }
+
+    // Holds a rate_limiter slot from here until release_slot()
+    void open(std::shared_ptr<state> const& s) {
+        s->admitted = true;
+        try {
+            s->handle.emplace(connection_pool::instance().acquire(s->req.url));
+        } catch (const std::exception& e) {
+            release_slot(s);
+            complete(s, response{0, {}, e.what()});
+            return;
+        }
+        CURL* curl = s->handle->get();
+        s->writer.curl = curl;
+        curl_easy_setopt(curl, CURLOPT_URL, s->req.url.c_str());
+        if (s->req.body) {
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, s->req.body->c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(s->req.body->length()));
+        }
+        if (s->cache) {
+            s->cache->attach(curl);
+        } else if (s->forward) {
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, s->forward);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, s->forward_data);
+        } else {
+            s->writer.sink = &s->collect;
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &sink_writer::write);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &s->writer);
+        }
+        if (s->req.range_from && !s->req.body) {
+            curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, static_cast<curl_off_t>(*s->req.range_from));
+        } else {
+            curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");  // every encoding libcurl was built with
+        }
+        if (s->req.max_recv_speed > 0) {
+            curl_easy_setopt(curl, CURLOPT_MAX_RECV_SPEED_LARGE, static_cast<curl_off_t>(s->req.max_recv_speed));
+        }
+        auto const timeout = s->req.adaptive_timeout ? telemetry::instance().timeout_for(s->host, s->req.timeout)
+                                                     : s->req.timeout;
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, s->req.connect_timeout);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
+        curl_easy_setopt(curl, CURLOPT_USERAGENT, "Rouen-HTTP/1.0");
+        // HTTP/2 where TLS negotiates it, HTTP/1.1 otherwise. PIPEWAIT makes a transfer wait for
+        // a connection being set up to the host so it can multiplex there instead of opening its own.
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, s->hedge ? 0L : 1L);
+        if (s->hedge) {
+            curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);  // not behind the slow attempt
+        }
+        if (s->headers.get()) {
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, s->headers.get());
+        }
+        HTTP_INFO_FMT("{} {} (async)", s->req.body ? "POST" : "GET", s->req.url);
+        active_.emplace(curl, s);
+        curl_multi_add_handle(multi_, curl);
+    }
+
+    void finish(CURL* easy, CURLcode code) {
+        auto pos = active_.find(easy);
+        if (pos == active_.end()) {
+            return;
+        }
+        auto s = pos->second;
+        active_.erase(pos);
+        curl_multi_remove_handle(multi_, easy);
+
+        response r;
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &r.status);
+        if (curl_header* link = nullptr; curl_easy_header(easy, "Link", 0, CURLH_HEADER, -1, &link) == CURLHE_OK) {
+            r.link = link->value;
+        }
+        curl_off_t retry_after = 0;
+        curl_easy_getinfo(easy, CURLINFO_RETRY_AFTER, &retry_after);
+        auto const penalty = code == CURLE_OK ? rate_limiter::penalty(r.status, retry_after, s->retries)
+                                              : std::chrono::seconds{0};
+        release_slot(s, penalty);
+        auto const retry = penalty.count() > 0 && !s->forward && s->retries < rate_limiter::max_retries;
+        auto sample = sample_transfer(easy, code, r.status);
+        sample.retried = retry;
+        telemetry::instance().record(s->host, sample);
+        trace_transfer(s->req.url, sample);
+        // Throttled: queue it again behind the host's back-off, if nothing has seen the body yet
+        if (retry) {
+            ++s->retries;
+            HTTP_WARN_FMT("HTTP {} from {}, retrying in {}s ({}/{})", r.status, s->req.url, penalty.count(),
+                          s->retries, rate_limiter::max_retries);
+            s->body.clear();
+            s->writer.started = false;
+            s->handle.reset();
+            admit(s);
+            return;
+        }
+        if (code != CURLE_OK) {
+            r.error = std::string("CURL request failed: ") + curl_easy_strerror(code);
+            HTTP_ERROR_FMT("{} ({})", r.error, s->req.url);
+        } else if (r.status >= 400) {
+            r.error = "HTTP error " + std::to_string(r.status);
+            HTTP_ERROR_FMT("HTTP error: {} ({})", r.status, s->req.url);
+        } else {
+            if (s->cache) {
+                s->cache->complete(r.status, !s->req.skip_unchanged);
+            }
+            HTTP_INFO_FMT("Fetched {} bytes from {}", s->body.size(), s->req.url);
+        }
+        r.body = std::move(s->body);
+        s->handle.reset();  // back to the pool before the callback may submit more
+        complete(s, std::move(r));
+    }
+
+    void release_slot(std::shared_ptr<state> const& s, std::chrono::seconds penalty = std::chrono::seconds{0}) {
+        if (s->admitted) {
+            s->admitted = false;
+            rate_limiter::instance().release(s->host, penalty);
+        }
+    }
+
+    void complete(std::shared_ptr<state> const& s, response r) {
+        if (s->leads) {
+            s->leads = false;
+            single_flight::instance().land(s->flight, r);
+        }
+        std::lock_guard<std::mutex> lock(s->completion);
+        if (!s->cancelled.load(std::memory_order_acquire) && s->on_done) {
+            try {
+                s->on_done(std::move(r));
+            } catch (const std::exception& e) {
+                HTTP_ERROR_FMT("Completion callback for {} threw: {}", s->req.url, e.what());
+            }
+        }
+        s->on_done = nullptr;
+        s->done.store(true, std::memory_order_release);
+    }
+
+    // I/O thread: stops a transfer (and a hedged request's attempts) for good
+    void drop(std::shared_ptr<state> const& s) {
+        for (auto const& a : s->attempts) {
+            a->cancelled.store(true, std::memory_order_release);
+            drop(a);
+        }
+        if (s->handle) {
+            CURL* easy = s->handle->get();
+            if (active_.erase(easy)) {
+                curl_multi_remove_handle(multi_, easy);
+                HTTP_DEBUG_FMT("Cancelled {}", s->req.url);
+            }
+            s->handle.reset();
+        }
+        release_slot(s);
+        if (s->leads) {
+            s->leads = false;
+            single_flight::instance().abandon(s->flight);
+        }
+        // Only now can nothing call into the transfer's write target any more
+        std::lock_guard<std::mutex> lock(s->completion);
+        s->on_done = nullptr;
+        s->done.store(true, std::memory_order_release);
+    }
+
+    void run(std::stop_token stoken) {
+        while (!stoken.stop_requested()) {
+            std::deque<std::shared_ptr<state>> incoming;
+            std::vector<std::shared_ptr<state>> cancelled;
+            std::vector<std::function<void()>> tasks;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                incoming.swap(incoming_);
+                cancelled.swap(cancelled_);
+                tasks.swap(tasks_);
+            }
+            for (auto& s : incoming) {
+                if (!s->cancelled.load(std::memory_order_acquire)) {
+                    start(s);
+                }
+            }
+            for (auto& task : tasks) {
+                task();
+            }
+            for (auto& s : cancelled) {
+                drop(s);
+            }
+
+            auto const due = rate_limiter::clock::now();
+            while (!timers_.empty() && timers_.begin()->first <= due) {
+                auto task = std::move(timers_.begin()->second);
+                timers_.erase(timers_.begin());
+                task();
+            }
+
+            drain_waiting();
+
+            int running = 0;
+            curl_multi_perform(multi_, &running);
+            int queued = 0;
+            while (CURLMsg* msg = curl_multi_info_read(multi_, &queued)) {
+                if (msg->msg == CURLMSG_DONE) {
+                    finish(msg->easy_handle, msg->data.result);
+                }
+            }
+            // Wake up for the earliest queued request, if that comes before the usual second
+            auto const now = rate_limiter::clock::now();
+            long long timeout_ms = 1000;
+            for (auto const& [_, w] : waiting_) {
+                auto const until = std::chrono::duration_cast<std::chrono::milliseconds>(w.retry - now).count();
+                timeout_ms = std::clamp<long long>(until + 1, 0, timeout_ms);
+            }
+            if (!timers_.empty()) {
+                auto const until = std::chrono::duration_cast<std::chrono::milliseconds>(timers_.begin()->first - now).count();
+                timeout_ms = std::clamp<long long>(until + 1, 0, timeout_ms);
+            }
+            curl_multi_poll(multi_, nullptr, 0, static_cast<int>(timeout_ms), nullptr);
+        }
+    }
+
+    CURLM* multi_ {nullptr};
+    std::mutex mutex_;
+    std::deque<std::shared_ptr<state>> incoming_;
+    std::vector<std::shared_ptr<state>> cancelled_;
+    std::vector<std::function<void()>> tasks_;
+    struct waiting_host {
+        std::deque<std::shared_ptr<state>> queue;
+        rate_limiter::clock::time_point retry;  // when to ask the rate_limiter again
+    };
+    std::unordered_map<std::string, waiting_host> waiting_;  // I/O thread only
+    std::multimap<rate_limiter::clock::time_point, std::function<void()>> timers_;  // I/O thread only
+    std::unordered_map<CURL*, std::shared_ptr<state>> active_;  // I/O thread only
+    std::jthread io_thread_;
+};
+
+// HTTP client to fetch data from URLs with configurable timeout.
+// Instances are cheap: connections, DNS and TLS sessions live in the connection_pool.
 class fetch {
 public:
     // Use void* for content pointer to match how it's used in the codebase
     using WriteCallback = size_t (*)(void*, size_t, size_t, void*);
-    
+
     // Function type for header setup (used by existing code)
     using HeaderSetter = std::function<void(const std::string&)>;
-    
+
     // Constructor with default timeout
     fetch() : timeout_(30), connect_timeout_(10) {
-        // Initialize CURL globally if not already initialized
-        static bool curl_initialized = false;
-        if (!curl_initialized) {
-            curl_global_init(CURL_GLOBAL_DEFAULT);
-            curl_initialized = true;
-            HTTP_INFO("CURL globally initialized");
-        }
+        connection_pool::instance();
     }
-    
+
     // Constructor with custom timeout
     explicit fetch(long timeout) : timeout_(timeout), connect_timeout_(timeout > 10 ? 10 : timeout) {
-        // Initialize CURL globally if not already initialized
-        static bool curl_initialized = false;
-        if (!curl_initialized) {
-            curl_global_init(CURL_GLOBAL_DEFAULT);
-            curl_initialized = true;
-            HTTP_INFO("CURL globally initialized");
-        }
-        
-        HTTP_INFO_FMT("Created fetch client with timeout: {}s", timeout);
+        connection_pool::instance();
+        HTTP_DEBUG_FMT("Created fetch client with timeout: {}s", timeout);
+    }
+
+    // GET requests made by this client go through the response_cache (ETag / Last-Modified)
+    fetch& cached(bool enabled = true) {
+        use_cache_ = enabled;
+        return *this;
     }
-    
+
+    // The timeout becomes a ceiling: hosts that usually answer fast get a shorter one
+    fetch& adaptive(bool enabled = true) {
+        adaptive_timeout_ = enabled;
+        return *this;
+    }
+
     // Basic GET request with vector of headers
     std::string operator()(
-        const std::string& url, 
+        const std::string& url,
         const std::vector<std::string>& headers = {},
         WriteCallback custom_callback = nullptr,
         void* custom_data = nullptr
     ) {
-        try {
-            // Create a CURL handle
-            curl_handle handle;
-            
-            // Response string to store the result (if using default callback)
-            std::string response;
-            
-            // Set URL
-            curl_easy_setopt(handle.get(), CURLOPT_URL, url.c_str());
-            
-            // Set write function and data
-            if (custom_callback && custom_data) {
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, custom_callback);
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, custom_data);
-            } else {
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, write_callback);
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, &response);
-            }
-            
-            // Set timeouts
-            curl_easy_setopt(handle.get(), CURLOPT_TIMEOUT, timeout_);
-            curl_easy_setopt(handle.get(), CURLOPT_CONNECTTIMEOUT, connect_timeout_);
-            
-            // Enable automatic redirect following
-            curl_easy_setopt(handle.get(), CURLOPT_FOLLOWLOCATION, 1L);
-            curl_easy_setopt(handle.get(), CURLOPT_MAXREDIRS, 10L);
-            
-            // Set user agent
-            curl_easy_setopt(handle.get(), CURLOPT_USERAGENT, "Rouen-HTTP/1.0");
-            
-            // Add custom headers if provided
-            struct curl_slist* curl_headers = nullptr;
-            if (!headers.empty()) {
-                for (const auto& header : headers) {
-                    curl_headers = curl_slist_append(curl_headers, header.c_str());
-                }
-                curl_easy_setopt(handle.get(), CURLOPT_HTTPHEADER, curl_headers);
-            }
-            
-            // Perform the request
-            HTTP_INFO_FMT("Fetching URL: {}", url);
-            CURLcode res = curl_easy_perform(handle.get());
-            
-            // Clean up headers if set
-            if (curl_headers) {
-                curl_slist_free_all(curl_headers);
-            }
-            
-            // Check for errors
-            if (res != CURLE_OK) {
-                HTTP_ERROR_FMT("CURL request failed: {}", curl_easy_strerror(res));
-                throw std::runtime_error(std::string("CURL request failed: ") + curl_easy_strerror(res));
-            }
-            
-            // Check HTTP status code
-            long http_code = 0;
-            curl_easy_getinfo(handle.get(), CURLINFO_RESPONSE_CODE, &http_code);
-            
-            if (http_code >= 400) {
-                HTTP_ERROR_FMT("HTTP error: {} ({})", http_code, url);
-                throw std::runtime_error("HTTP error " + std::to_string(http_code));
-            }
-            
-            // Only log response size if we're using our internal response string
-            if (!custom_callback) {
-                HTTP_INFO_FMT("Fetched {} bytes from {}", response.size(), url);
-            } else {
-                HTTP_INFO_FMT("Fetched data from {} using custom callback", url);
-            }
-            
-            return response;
-        } catch (const std::exception& e) {
-            HTTP_ERROR_FMT("Exception during fetch: {}", e.what());
-            throw;
+        header_list list;
+        for (const auto& header : headers) {
+            list.append(header);
         }
+        return perform(url, nullptr, list, custom_callback, custom_data);
     }
-    
+
     // GET with lambda for header setup (used by existing code)
     template<typename F>
     std::string operator()(
@@ -180,177 +1243,26 @@ public:
         WriteCallback custom_callback = nullptr,
         void* custom_data = nullptr
     ) {
-        try {
-            // Create a CURL handle
-            curl_handle handle;
-            
-            // Response string to store the result (if using default callback)
-            std::string response;
-            
-            // Set URL
-            curl_easy_setopt(handle.get(), CURLOPT_URL, url.c_str());
-            
-            // Set write function and data
-            if (custom_callback && custom_data) {
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, custom_callback);
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, custom_data);
-            } else {
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, write_callback);
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, &response);
-            }
-            
-            // Set timeouts
-            curl_easy_setopt(handle.get(), CURLOPT_TIMEOUT, timeout_);
-            curl_easy_setopt(handle.get(), CURLOPT_CONNECTTIMEOUT, connect_timeout_);
-            
-            // Enable automatic redirect following
-            curl_easy_setopt(handle.get(), CURLOPT_FOLLOWLOCATION, 1L);
-            curl_easy_setopt(handle.get(), CURLOPT_MAXREDIRS, 10L);
-            
-            // Set user agent
-            curl_easy_setopt(handle.get(), CURLOPT_USERAGENT, "Rouen-HTTP/1.0");
-            
-            // Setup headers using the provided setter
-            struct curl_slist* curl_headers = nullptr;
-            auto header_appender = [&curl_headers](const std::string& header) {
-                curl_headers = curl_slist_append(curl_headers, header.c_str());
-            };
-            
-            // Call the header setter with our header_appender function
-            header_setter(header_appender);
-            
-            if (curl_headers) {
-                curl_easy_setopt(handle.get(), CURLOPT_HTTPHEADER, curl_headers);
-            }
-            
-            // Perform the request
-            HTTP_INFO_FMT("Fetching URL: {}", url);
-            CURLcode res = curl_easy_perform(handle.get());
-            
-            // Clean up headers if set
-            if (curl_headers) {
-                curl_slist_free_all(curl_headers);
-            }
-            
-            // Check for errors
-            if (res != CURLE_OK) {
-                HTTP_ERROR_FMT("CURL request failed: {}", curl_easy_strerror(res));
-                throw std::runtime_error(std::string("CURL request failed: ") + curl_easy_strerror(res));
-            }
-            
-            // Check HTTP status code
-            long http_code = 0;
-            curl_easy_getinfo(handle.get(), CURLINFO_RESPONSE_CODE, &http_code);
-            
-            if (http_code >= 400) {
-                HTTP_ERROR_FMT("HTTP error: {} ({})", http_code, url);
-                throw std::runtime_error("HTTP error " + std::to_string(http_code));
-            }
-            
-            // Only log response size if we're using our internal response string
-            if (!custom_callback) {
-                HTTP_INFO_FMT("Fetched {} bytes from {}", response.size(), url);
-            } else {
-                HTTP_INFO_FMT("Fetched data from {} using custom callback", url);
-            }
-            
-            return response;
-        } catch (const std::exception& e) {
-            HTTP_ERROR_FMT("Exception during fetch: {}", e.what());
-            throw;
-        }
+        header_list list;
+        header_setter([&list](const std::string& header) { list.append(header); });
+        return perform(url, nullptr, list, custom_callback, custom_data);
     }
-    
+
     // Basic POST request with vector of headers
     std::string post(
-        const std::string& url, 
+        const std::string& url,
         const std::string& data,
         const std::vector<std::string>& headers = {},
         WriteCallback custom_callback = nullptr,
         void* custom_data = nullptr
     ) {
-        try {
-            // Create a CURL handle
-            curl_handle handle;
-            
-            // Response string to store the result (if using default callback)
-            std::string response;
-            
-            // Set URL
-            curl_easy_setopt(handle.get(), CURLOPT_URL, url.c_str());
-            
-            // Set POST method and data
-            curl_easy_setopt(handle.get(), CURLOPT_POST, 1L);
-            curl_easy_setopt(handle.get(), CURLOPT_POSTFIELDS, data.c_str());
-            curl_easy_setopt(handle.get(), CURLOPT_POSTFIELDSIZE, data.length());
-            
-            // Set write function and data
-            if (custom_callback && custom_data) {
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, custom_callback);
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, custom_data);
-            } else {
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, write_callback);
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, &response);
-            }
-            
-            // Set timeouts
-            curl_easy_setopt(handle.get(), CURLOPT_TIMEOUT, timeout_);
-            curl_easy_setopt(handle.get(), CURLOPT_CONNECTTIMEOUT, connect_timeout_);
-            
-            // Enable automatic redirect following
-            curl_easy_setopt(handle.get(), CURLOPT_FOLLOWLOCATION, 1L);
-            curl_easy_setopt(handle.get(), CURLOPT_MAXREDIRS, 10L);
-            
-            // Set user agent
-            curl_easy_setopt(handle.get(), CURLOPT_USERAGENT, "Rouen-HTTP/1.0");
-            
-            // Add custom headers if provided
-            struct curl_slist* curl_headers = nullptr;
-            if (!headers.empty()) {
-                for (const auto& header : headers) {
-                    curl_headers = curl_slist_append(curl_headers, header.c_str());
-                }
-                curl_easy_setopt(handle.get(), CURLOPT_HTTPHEADER, curl_headers);
-            }
-            
-            // Perform the request
-            HTTP_INFO_FMT("Posting to URL: {}", url);
-            CURLcode res = curl_easy_perform(handle.get());
-            
-            // Clean up headers if set
-            if (curl_headers) {
-                curl_slist_free_all(curl_headers);
-            }
-            
-            // Check for errors
-            if (res != CURLE_OK) {
-                HTTP_ERROR_FMT("CURL POST request failed: {}", curl_easy_strerror(res));
-                throw std::runtime_error(std::string("CURL POST request failed: ") + curl_easy_strerror(res));
-            }
-            
-            // Check HTTP status code
-            long http_code = 0;
-            curl_easy_getinfo(handle.get(), CURLINFO_RESPONSE_CODE, &http_code);
-            
-            if (http_code >= 400) {
-                HTTP_ERROR_FMT("HTTP error: {} ({})", http_code, url);
-                throw std::runtime_error("HTTP error " + std::to_string(http_code));
-            }
-            
-            // Only log response size if we're using our internal response string
-            if (!custom_callback) {
-                HTTP_INFO_FMT("Posted {} bytes, received {} bytes from {}", data.size(), response.size(), url);
-            } else {
-                HTTP_INFO_FMT("Posted {} bytes to {} using custom callback", data.size(), url);
-            }
-            
-            return response;
-        } catch (const std::exception& e) {
-            HTTP_ERROR_FMT("Exception during POST: {}", e.what());
-            throw;
+        header_list list;
+        for (const auto& header : headers) {
+            list.append(header);
         }
+        return perform(url, &data, list, custom_callback, custom_data);
     }
-    
+
     // POST with lambda for header setup (used by existing code)
     template<typename F>
     std::string post(
@@ -360,95 +1272,245 @@ public:
         WriteCallback custom_callback = nullptr,
         void* custom_data = nullptr
     ) {
+        header_list list;
+        header_setter([&list](const std::string& header) { list.append(header); });
+        return perform(url, &data, list, custom_callback, custom_data);
+    }
+
+    // GET streaming the body into `sink` as it arrives instead of returning it
+    void stream(const std::string& url, body_sink& sink, const std::vector<std::string>& headers = {}) {
+        header_list list;
+        for (const auto& header : headers) {
+            list.append(header);
+        }
+        perform(url, nullptr, list, nullptr, nullptr, &sink);
+    }
+
+    // POST streaming the response into `sink` as it arrives; sink returning false aborts it
+    template<typename F>
+    void post_stream(const std::string& url, const std::string& data, F header_setter, body_sink& sink) {
+        header_list list;
+        header_setter([&list](const std::string& header) { list.append(header); });
+        perform(url, &data, list, nullptr, nullptr, &sink);
+    }
+
+    // GET into a chunked, shareable buffer (see http_buffer.hpp)
+    buffer download(const std::string& url, const std::vector<std::string>& headers = {}) {
+        buffer_sink sink;
+        stream(url, sink, headers);
+        return sink.take();
+    }
+
+    // Non-blocking GET on the shared engine; no thread waits on the network
+    std::future<std::string> async(const std::string& url, const std::vector<std::string>& headers = {}) {
+        return engine::instance().get(make_request(url, headers));
+    }
+
+    // Non-blocking POST on the shared engine
+    std::future<std::string> post_async(const std::string& url, const std::string& data,
+                                        const std::vector<std::string>& headers = {}) {
+        auto req = make_request(url, headers);
+        req.body = data;
+        return engine::instance().get(std::move(req));
+    }
+
+    // A request carrying this client's timeouts, for engine::submit()
+    request make_request(const std::string& url, const std::vector<std::string>& headers = {}) const {
+        request req;
+        req.url = url;
+        req.headers = headers;
+        req.timeout = timeout_;
+        req.connect_timeout = connect_timeout_;
+        req.cached = use_cache_;
+        req.adaptive_timeout = adaptive_timeout_;
+        return req;
+    }
+
+private:
+    // Plain GETs into the returned string join an identical request already in flight
+    std::string perform(
+        const std::string& url,
+        const std::string* post_data,
+        header_list& headers,
+        WriteCallback custom_callback,
+        void* custom_data,
+        body_sink* sink = nullptr
+    ) {
+        if (post_data || (custom_callback && custom_data) || sink) {
+            return execute(url, post_data, headers, custom_callback, custom_data, sink);
+        }
+        auto const flight = single_flight::key(url, headers.get());
+        std::promise<std::optional<response>> shared;
+        auto result = shared.get_future();
+        auto& flights = single_flight::instance();
+        if (!flights.join(flight, [&shared](std::optional<response> r) { shared.set_value(std::move(r)); })) {
+            HTTP_DEBUG_FMT("Joining in-flight GET {}", url);
+            if (auto r = result.get()) {
+                if (!r->ok()) {
+                    throw std::runtime_error(r->error);
+                }
+                return std::move(r->body);
+            }
+            return execute(url, nullptr, headers, nullptr, nullptr, nullptr);
+        }
+        try {
+            auto body = execute(url, nullptr, headers, nullptr, nullptr, nullptr);
+            flights.land(flight, response{200, body, {}});
+            return body;
+        } catch (const std::exception& e) {
+            flights.land(flight, response{0, {}, e.what()});
+            throw;
+        }
+    }
+
+    // One request on a pooled handle; post_data == nullptr means GET
+    std::string execute(
+        const std::string& url,
+        const std::string* post_data,
+        header_list& headers,
+        WriteCallback custom_callback,
+        void* custom_data,
+        body_sink* sink
+    ) {
+        char const* const verb = post_data ? "POST" : "GET";
+        if (!(custom_callback && custom_data)) {
+            custom_callback = nullptr;
+        }
         try {
-            // Create a CURL handle
-            curl_handle handle;
-            
             // Response string to store the result (if using default callback)
             std::string response;
-            
+            string_sink collect{response};
+            sink_writer writer{nullptr, sink, false};
+            if (sink) {
+                custom_callback = &sink_writer::write;
+                custom_data = &writer;
+            }
+
+            std::optional<cache_session> cache;
+            if (use_cache_ && !post_data) {
+                cache.emplace(url, headers.get());
+                if (cache->fresh()) {
+                    HTTP_DEBUG_FMT("Serving {} from cache", url);
+                    cache->set_writer(custom_callback, custom_data, &response);
+                    cache->deliver_stored();
+                    return response;
+                }
+                cache->add_validators(headers);
+            }
+
+            auto handle = connection_pool::instance().acquire(url);
+            CURL* curl = handle.get();
+            writer.curl = curl;
+
             // Set URL
-            curl_easy_setopt(handle.get(), CURLOPT_URL, url.c_str());
-            
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+
             // Set POST method and data
-            curl_easy_setopt(handle.get(), CURLOPT_POST, 1L);
-            curl_easy_setopt(handle.get(), CURLOPT_POSTFIELDS, data.c_str());
-            curl_easy_setopt(handle.get(), CURLOPT_POSTFIELDSIZE, data.length());
-            
+            if (post_data) {
+                curl_easy_setopt(curl, CURLOPT_POST, 1L);
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_data->c_str());
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(post_data->length()));
+            }
+
             // Set write function and data
-            if (custom_callback && custom_data) {
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, custom_callback);
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, custom_data);
+            if (cache) {
+                cache->set_writer(custom_callback, custom_data, &response);
+                cache->attach(curl);
+            } else if (custom_callback) {
+                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, custom_callback);
+                curl_easy_setopt(curl, CURLOPT_WRITEDATA, custom_data);
             } else {
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, write_callback);
-                curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, &response);
+                writer.sink = &collect;
+                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &sink_writer::write);
+                curl_easy_setopt(curl, CURLOPT_WRITEDATA, &writer);
             }
-            
+
+            // Let the server compress: gzip, br, zstd... whatever this libcurl supports
+            curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+
             // Set timeouts
-            curl_easy_setopt(handle.get(), CURLOPT_TIMEOUT, timeout_);
-            curl_easy_setopt(handle.get(), CURLOPT_CONNECTTIMEOUT, connect_timeout_);
-            
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT,
+                adaptive_timeout_ ? telemetry::instance().timeout_for(rate_limiter::host_name(url), timeout_) : timeout_);
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, connect_timeout_);
+
             // Enable automatic redirect following
-            curl_easy_setopt(handle.get(), CURLOPT_FOLLOWLOCATION, 1L);
-            curl_easy_setopt(handle.get(), CURLOPT_MAXREDIRS, 10L);
-            
+            curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
+
             // Set user agent
-            curl_easy_setopt(handle.get(), CURLOPT_USERAGENT, "Rouen-HTTP/1.0");
-            
-            // Setup headers using the provided setter
-            struct curl_slist* curl_headers = nullptr;
-            auto header_appender = [&curl_headers](const std::string& header) {
-                curl_headers = curl_slist_append(curl_headers, header.c_str());
-            };
-            
-            // Call the header setter with our header_appender function
-            header_setter(header_appender);
-            
-            if (curl_headers) {
-                curl_easy_setopt(handle.get(), CURLOPT_HTTPHEADER, curl_headers);
-            }
-            
-            // Perform the request
-            HTTP_INFO_FMT("Posting to URL: {}", url);
-            CURLcode res = curl_easy_perform(handle.get());
-            
-            // Clean up headers if set
-            if (curl_headers) {
-                curl_slist_free_all(curl_headers);
-            }
-            
+            curl_easy_setopt(curl, CURLOPT_USERAGENT, "Rouen-HTTP/1.0");
+
+            // HTTP/2 where the server offers it over TLS, HTTP/1.1 otherwise
+            curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+
+            if (headers.get()) {
+                curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers.get());
+            }
+
+            // Perform the request, waiting for the host's rate_limiter and retrying when throttled
+            auto& limiter = rate_limiter::instance();
+            auto const host = rate_limiter::host_name(url);
+            CURLcode res = CURLE_OK;
+            long http_code = 0;
+            for (int attempt = 0;; ++attempt) {
+                limiter.acquire(host);
+                HTTP_INFO_FMT("{} {}", verb, url);
+                res = curl_easy_perform(curl);
+                curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+                curl_off_t retry_after = 0;
+                curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retry_after);
+                auto const penalty = res == CURLE_OK ? rate_limiter::penalty(http_code, retry_after, attempt)
+                                                     : std::chrono::seconds{0};
+                limiter.release(host, penalty);
+                // Only a body nobody else has seen yet can be thrown away and fetched again
+                auto const retry = penalty.count() > 0 && !custom_callback && attempt < rate_limiter::max_retries;
+                auto sample = sample_transfer(curl, res, http_code);
+                sample.retried = retry;
+                telemetry::instance().record(host, sample);
+                trace_transfer(url, sample);
+                if (!retry) {
+                    break;
+                }
+                HTTP_WARN_FMT("HTTP {} from {}, retrying in {}s ({}/{})", http_code, url, penalty.count(),
+                              attempt + 1, rate_limiter::max_retries);
+                response.clear();
+                writer.started = false;
+            }
+
             // Check for errors
             if (res != CURLE_OK) {
-                HTTP_ERROR_FMT("CURL POST request failed: {}", curl_easy_strerror(res));
-                throw std::runtime_error(std::string("CURL POST request failed: ") + curl_easy_strerror(res));
+                HTTP_ERROR_FMT("CURL {} request failed: {}", verb, curl_easy_strerror(res));
+                throw std::runtime_error(std::string("CURL request failed: ") + curl_easy_strerror(res));
             }
-            
+
             // Check HTTP status code
-            long http_code = 0;
-            curl_easy_getinfo(handle.get(), CURLINFO_RESPONSE_CODE, &http_code);
-            
             if (http_code >= 400) {
                 HTTP_ERROR_FMT("HTTP error: {} ({})", http_code, url);
                 throw std::runtime_error("HTTP error " + std::to_string(http_code));
             }
-            
+
+            if (cache) {
+                cache->complete(http_code);
+            }
+
             // Only log response size if we're using our internal response string
             if (!custom_callback) {
-                HTTP_INFO_FMT("Posted {} bytes, received {} bytes from {}", data.size(), response.size(), url);
+                HTTP_INFO_FMT("Fetched {} bytes from {}", response.size(), url);
             } else {
-                HTTP_INFO_FMT("Posted {} bytes to {} using custom callback", data.size(), url);
+                HTTP_INFO_FMT("Fetched data from {} using custom callback", url);
             }
-            
+
             return response;
         } catch (const std::exception& e) {
-            HTTP_ERROR_FMT("Exception during POST: {}", e.what());
+            HTTP_ERROR_FMT("Exception during {}: {}", verb, e.what());
             throw;
         }
     }
-    
-private:
+
     long timeout_;        // Request timeout in seconds
     long connect_timeout_; // Connection timeout in seconds
+    bool use_cache_ {false};
+    bool adaptive_timeout_ {false};
 };
 
-} // namespace http
\ No newline at end of file
+} // namespace http
@@ -0,0 +1,457 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "debug.hpp"
+#include "dir_watch.hpp"
+#include "redraw.hpp"
+#include "task_scheduler.hpp"
+
+namespace rouen::helpers {
+
+/**
+ * Every path below a root, for finding files by fuzzy subsequence as you type. Built in the
+ * background with one scheduler task per directory, and kept current one directory at a time:
+ * each indexed directory is watched (up to ROUEN_FILE_INDEX_WATCHES, 4096) and only the ones
+ * that change are listed again. Paths are stored per directory in one arena, with a lowercase
+ * twin the matcher runs on and a bitmask of the characters in each path, so most candidates
+ * are rejected with one AND and the rest are walked with memchr (vectorized in libc).
+ * Searches are split across the scheduler's workers. Symlinks aren't followed; .git,
+ * node_modules and a few caches aren't entered. ROUEN_FILE_INDEX_MAX caps the paths (2M).
+ */
+class file_index : public std::enable_shared_from_this<file_index> {
+public:
+    struct hit {
+        std::string path;       // relative to the root
+        bool is_directory {false};
+        int score {0};
+    };
+
+    using hits_fn = std::function<void(std::vector<hit>)>;
+
+    static std::shared_ptr<file_index> build(std::filesystem::path root) {
+        auto index = std::shared_ptr<file_index>(new file_index(std::move(root)));
+        index->pending_.fetch_add(1, std::memory_order_relaxed);    // held until the root is queued
+        index->visit("");
+        index->finish_one();
+        return index;
+    }
+
+    ~file_index() { stop_.request_stop(); }
+
+    file_index(file_index const &) = delete;
+    file_index &operator=(file_index const &) = delete;
+
+    [[nodiscard]] std::filesystem::path const &root() const { return root_; }
+
+    // Done with the first build; searches before that see what is in so far
+    [[nodiscard]] bool ready() const { return ready_.load(std::memory_order_acquire); }
+
+    [[nodiscard]] size_t size() const { return paths_.load(std::memory_order_relaxed); }
+
+    /**
+     * The best `limit` paths for the query, best first, handed to on_done on a scheduler
+     * worker. Case is ignored. A search whose stop is requested never calls back.
+     */
+    void search(std::string const &query, size_t limit, std::stop_source stop, hits_fn on_done) {
+        auto const chunks = snapshot();
+        auto const needle = lowercase(query);
+        auto const mask = char_mask(needle);
+
+        // Slices of about the same number of paths, one per worker
+        auto const workers = std::max<size_t>(scheduler_->worker_count(), 1);
+        size_t total = 0;
+        for (auto const &c : *chunks) {
+            total += c->entries.size();
+        }
+        auto const per_slice = std::max<size_t>(total / workers + 1, 4096);
+        std::vector<std::pair<size_t, size_t>> slices;
+        for (size_t begin = 0, count = 0, i = 0; i < chunks->size(); ++i) {
+            count += (*chunks)[i]->entries.size();
+            if (count >= per_slice || i + 1 == chunks->size()) {
+                slices.emplace_back(begin, i + 1);
+                begin = i + 1;
+                count = 0;
+            }
+        }
+
+        struct gather {
+            std::mutex mutex;
+            std::vector<hit> hits;
+            std::atomic<size_t> remaining;
+            hits_fn on_done;
+        };
+        auto shared = std::make_shared<gather>();
+        shared->remaining = slices.size();
+        shared->on_done = std::move(on_done);
+        auto finish = [shared, limit]() {
+            std::sort(shared->hits.begin(), shared->hits.end(), better);
+            if (shared->hits.size() > limit) {
+                shared->hits.resize(limit);
+            }
+            shared->on_done(std::move(shared->hits));
+        };
+        if (slices.empty()) {
+            finish();
+            return;
+        }
+        for (auto const &[begin, end] : slices) {
+            scheduler_->submit([chunks, needle, mask, limit, shared, finish, begin, end](std::stop_token stoken) {
+                std::vector<hit> found;
+                for (size_t i = begin; i < end && !stoken.stop_requested(); ++i) {
+                    match_chunk(*(*chunks)[i], needle, mask, found);
+                    if (found.size() > 4 * limit) {
+                        trim(found, limit);
+                    }
+                }
+                trim(found, limit);
+                {
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    shared->hits.insert(shared->hits.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+                }
+                if (shared->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 && !stoken.stop_requested()) {
+                    finish();
+                }
+            }, task_priority::high, stop);
+        }
+    }
+
+    // Score of a lowercase needle as a subsequence of a path, or -1; name_at is where its last
+    // component starts. Matches at word starts, in a row and in the file name count for more
+    static int fuzzy_score(std::string_view needle, std::string_view lower, std::string_view text, size_t name_at) {
+        if (needle.empty()) {
+            return 0;
+        }
+        auto const from_name = align(needle, lower, text, name_at);
+        // Only worth a second look when all of it didn't fit in the name
+        auto const anywhere = from_name >= 0 ? from_name : align(needle, lower, text, 0);
+        if (anywhere < 0) {
+            return -1;
+        }
+        return anywhere - static_cast<int>(text.size() / 8);
+    }
+
+private:
+    struct entry {
+        uint32_t offset;        // in the chunk's arenas
+        uint16_t length;
+        uint16_t name_at;       // where the last path component starts
+        uint64_t mask;          // char_mask of the path
+        bool is_directory;
+    };
+
+    // One directory's entries: their relative paths back to back, and lowercase beside them
+    struct chunk {
+        std::string text;
+        std::string lower;
+        std::vector<entry> entries;
+    };
+
+    using chunk_list = std::vector<std::shared_ptr<chunk const>>;
+
+    explicit file_index(std::filesystem::path root)
+        : root_(std::move(root)), scheduler_(rouen::helpers::scheduler()), dirty_(std::make_shared<dirty_list>()) {
+        auto const max_paths = std::getenv("ROUEN_FILE_INDEX_MAX");
+        auto const max_watches = std::getenv("ROUEN_FILE_INDEX_WATCHES");
+        max_paths_ = max_paths ? std::strtoull(max_paths, nullptr, 10) : 2'000'000;
+        max_watches_ = max_watches ? std::strtoull(max_watches, nullptr, 10) : 4096;
+    }
+
+    // What changed since the last refresh. Kept apart from the index so a watch callback never
+    // holds the index alive: destroying it there would unsubscribe from inside dir_watch
+    struct dirty_list {
+        std::mutex mutex;
+        std::unordered_set<std::string> dirs;
+        bool scheduled {false};
+    };
+
+    static bool skipped(std::string_view name) {
+        return name == ".git" || name == "node_modules" || name == "__pycache__" || name == ".cache"
+            || name == ".venv" || name == ".mypy_cache";
+    }
+
+    static std::string lowercase(std::string_view text) {
+        std::string out(text);
+        for (auto &c : out) {
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        return out;
+    }
+
+    // A bit per letter and digit, one for everything else; lowercase input
+    static uint64_t char_mask(std::string_view lower) {
+        uint64_t mask = 0;
+        for (char c : lower) {
+            if (c >= 'a' && c <= 'z') {
+                mask |= uint64_t{1} << (c - 'a');
+            } else if (c >= '0' && c <= '9') {
+                mask |= uint64_t{1} << (26 + c - '0');
+            } else {
+                mask |= uint64_t{1} << 36;
+            }
+        }
+        return mask;
+    }
+
+    static bool boundary(char before, char at) {
+        return before == '/' || before == '_' || before == '-' || before == '.' || before == ' '
+            || (before >= 'a' && before <= 'z' && at >= 'A' && at <= 'Z');
+    }
+
+    // Leftmost match from `start`, each character found with memchr; its score or -1
+    static int align(std::string_view needle, std::string_view lower, std::string_view text, size_t start) {
+        int score = 0;
+        long previous = -2;
+        bool const in_name = start > 0;
+        size_t at = start;
+        for (char c : needle) {
+            auto const found = at < lower.size() ? static_cast<char const *>(std::memchr(lower.data() + at, c, lower.size() - at)) : nullptr;
+            if (!found) {
+                return -1;
+            }
+            auto const i = static_cast<long>(found - lower.data());
+            score += 16;
+            if (i == 0 || boundary(text[i - 1], text[i])) {
+                score += 24;
+            }
+            if (i == previous + 1) {
+                score += 16;
+            } else if (previous >= 0) {
+                score -= static_cast<int>(std::min<long>(i - previous - 1, 12));
+            }
+            if (in_name) {
+                score += 8;     // the whole match is in the file name
+            }
+            previous = i;
+            at = static_cast<size_t>(i) + 1;
+        }
+        return score;
+    }
+
+    static bool better(hit const &a, hit const &b) {
+        return a.score != b.score ? a.score > b.score : a.path.size() != b.path.size() ? a.path.size() < b.path.size() : a.path < b.path;
+    }
+
+    static void trim(std::vector<hit> &found, size_t limit) {
+        if (found.size() > limit) {
+            std::nth_element(found.begin(), found.begin() + static_cast<long>(limit), found.end(), better);
+            found.resize(limit);
+        }
+    }
+
+    static void match_chunk(chunk const &c, std::string_view needle, uint64_t mask, std::vector<hit> &found) {
+        for (auto const &e : c.entries) {
+            if ((mask & ~e.mask) != 0) {
+                continue;
+            }
+            std::string_view const lower {c.lower.data() + e.offset, e.length};
+            std::string_view const text {c.text.data() + e.offset, e.length};
+            if (auto const score = fuzzy_score(needle, lower, text, e.name_at); score >= 0) {
+                found.push_back({std::string(text), e.is_directory, score});
+            }
+        }
+    }
+
+    std::shared_ptr<chunk_list const> snapshot() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!snapshot_) {
+            auto list = std::make_shared<chunk_list>();
+            list->reserve(chunks_.size());
+            for (auto const &[dir, c] : chunks_) {
+                list->push_back(c);
+            }
+            snapshot_ = std::move(list);
+        }
+        return snapshot_;
+    }
+
+    void visit(std::string dir) {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        scheduler_->submit([self = shared_from_this(), dir = std::move(dir)](std::stop_token stoken) {
+            if (!stoken.stop_requested()) {
+                self->index_directory(dir, true);
+            }
+            self->finish_one();
+        }, task_priority::background, stop_);
+    }
+
+    void finish_one() {
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1 && !ready_.exchange(true)) {
+            SYS_INFO_FMT("Indexed {} paths under {}", size(), root_.string());
+            request_redraw();
+        }
+    }
+
+    // Lists one directory (relative to the root) into its chunk; with `descend`, directories
+    // not indexed yet are queued too
+    void index_directory(std::string const &dir, bool descend) {
+        auto fresh = std::make_shared<chunk>();
+        std::vector<std::string> subdirs;
+        std::error_code ec;
+        std::filesystem::directory_iterator pos(dir.empty() ? root_ : root_ / dir, ec);
+        for (; !ec && pos != std::filesystem::directory_iterator(); pos.increment(ec)) {
+            if (paths_.load(std::memory_order_relaxed) + fresh->entries.size() >= max_paths_) {
+                break;
+            }
+            auto const name = pos->path().filename().string();
+            std::error_code type_ec;
+            bool const is_directory = !pos->is_symlink(type_ec) && pos->is_directory(type_ec);
+            if (is_directory && skipped(name)) {
+                continue;
+            }
+            auto const path = dir.empty() ? name : dir + '/' + name;
+            if (path.size() > UINT16_MAX) {
+                continue;
+            }
+            entry e {static_cast<uint32_t>(fresh->text.size()), static_cast<uint16_t>(path.size()),
+                     static_cast<uint16_t>(path.size() - name.size()), 0, is_directory};
+            fresh->text += path;
+            fresh->lower += lowercase(path);
+            e.mask = char_mask(std::string_view{fresh->lower}.substr(e.offset));
+            fresh->entries.push_back(e);
+            if (is_directory) {
+                subdirs.push_back(path);
+            }
+        }
+
+        // Subscribed with no lock held, as dir_watch calls back under its own; an empty slot
+        // claims the directory meanwhile
+        std::unique_ptr<dir_watch::subscription> watch;
+        bool claimed = false;
+        if (!ec || !fresh->entries.empty()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (watches_.load(std::memory_order_relaxed) < max_watches_ && !subscriptions_.contains(dir)) {
+                subscriptions_.emplace(dir, nullptr);
+                watches_.fetch_add(1, std::memory_order_relaxed);
+                claimed = true;
+            }
+        }
+        if (claimed) {
+            watch = dir_watch::instance().subscribe((dir.empty() ? root_ : root_ / dir).string(),
+                [dirty = dirty_, weak = weak_from_this(), dir]() { mark_dirty(dirty, weak, dir); });
+        }
+
+        std::vector<std::string> queue;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto &slot = chunks_[dir];
+            auto const before = slot ? slot->entries.size() : 0;
+            paths_.fetch_add(fresh->entries.size(), std::memory_order_relaxed);
+            paths_.fetch_sub(before, std::memory_order_relaxed);
+            slot = std::move(fresh);
+            snapshot_.reset();
+            if (auto pos = subscriptions_.find(dir); watch && pos != subscriptions_.end()) {
+                pos->second = std::move(watch);
+            }
+            if (descend) {
+                for (auto &subdir : subdirs) {
+                    if (!chunks_.contains(subdir)) {
+                        queue.push_back(std::move(subdir));
+                    }
+                }
+            }
+        }
+        for (auto &subdir : queue) {
+            visit(std::move(subdir));
+        }
+    }
+
+    // On the dir_watch thread: note the directory and make sure a refresh is coming
+    static void mark_dirty(std::shared_ptr<dirty_list> const &dirty, std::weak_ptr<file_index> const &weak, std::string const &dir) {
+        {
+            std::lock_guard<std::mutex> lock(dirty->mutex);
+            dirty->dirs.insert(dir);
+            if (dirty->scheduled) {
+                return;
+            }
+            dirty->scheduled = true;
+        }
+        rouen::helpers::scheduler()->submit([dirty, weak](std::stop_token) {
+            if (auto const self = weak.lock()) {
+                self->refresh();
+            }
+        }, task_priority::background);
+    }
+
+    // Lists again what changed; directories gone take everything below them along
+    void refresh() {
+        std::unordered_set<std::string> dirs;
+        {
+            std::lock_guard<std::mutex> lock(dirty_->mutex);
+            dirs.swap(dirty_->dirs);
+            dirty_->scheduled = false;
+        }
+        for (auto const &dir : dirs) {
+            std::error_code ec;
+            if (std::filesystem::is_directory(dir.empty() ? root_ : root_ / dir, ec)) {
+                index_directory(dir, true);
+                continue;
+            }
+            std::vector<std::unique_ptr<dir_watch::subscription>> dropped;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto const prefix = dir + '/';
+                std::erase_if(chunks_, [&](auto const &item) {
+                    if (item.first != dir && !item.first.starts_with(prefix)) {
+                        return false;
+                    }
+                    paths_.fetch_sub(item.second->entries.size(), std::memory_order_relaxed);
+                    return true;
+                });
+                // Not erase_if: its predicate only sees the entries as const, and the watches move out
+                for (auto pos = subscriptions_.begin(); pos != subscriptions_.end();) {
+                    if (pos->first != dir && !pos->first.starts_with(prefix)) {
+                        ++pos;
+                        continue;
+                    }
+                    dropped.push_back(std::move(pos->second));
+                    watches_.fetch_sub(1, std::memory_order_relaxed);
+                    pos = subscriptions_.erase(pos);
+                }
+                snapshot_.reset();
+            }
+            // dropped unsubscribes here, with no lock held
+        }
+        request_redraw();
+    }
+
+    std::filesystem::path const root_;
+    std::shared_ptr<task_scheduler> scheduler_;
+    std::shared_ptr<dirty_list> dirty_;
+    std::stop_source stop_;
+    size_t max_paths_ {2'000'000};
+    size_t max_watches_ {4096};
+    std::atomic<size_t> pending_ {0};
+    std::atomic<size_t> paths_ {0};
+    std::atomic<size_t> watches_ {0};
+    std::atomic<bool> ready_ {false};
+    std::mutex mutex_;      // guards chunks_, subscriptions_ and snapshot_
+    std::unordered_map<std::string, std::shared_ptr<chunk const>> chunks_;
+    std::unordered_map<std::string, std::unique_ptr<dir_watch::subscription>> subscriptions_;
+    std::shared_ptr<chunk_list const> snapshot_;
+};
+
+} // namespace rouen::helpers
@@ -0,0 +1,121 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+// None in this file
+
+namespace rouen::helpers {
+
+/**
+ * Rolling per-card render timings, keyed by card URI.
+ *
+ * The deck records one sample per card per frame, and marks the cards it culled so they
+ * keep their entry (with the timings of when they were last drawn); readers (the profiler
+ * card, sysinfo) take a snapshot with percentiles computed over the last window.
+ * Registered in the registrar as "frame_profiler".
+ */
+class frame_profiler {
+public:
+    using clock = std::chrono::steady_clock;
+    static constexpr size_t window_size = 240;  // ~4 seconds of frames at 60 fps
+
+    struct stats {
+        double p50_ms {0.0};
+        double p99_ms {0.0};
+        double worst_ms {0.0};      // worst frame since the entry was created or reset
+        double last_ms {0.0};
+        size_t samples {0};
+        bool culled {false};        // out of view: not drawn in the last frame
+    };
+
+    void record(std::string const& uri, clock::duration elapsed) {
+        auto const ms = std::chrono::duration<double, std::milli>(elapsed).count();
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& entry = entries_[uri];
+        entry.ring[entry.next] = ms;
+        entry.next = (entry.next + 1) % window_size;
+        entry.count = std::min(entry.count + 1, window_size);
+        entry.worst = std::max(entry.worst, ms);
+        entry.last = ms;
+        entry.last_seen = frame_;
+        entry.culled = false;
+    }
+
+    // The card was out of view this frame: nothing to time, but it keeps its entry
+    void mark_culled(std::string const& uri) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& entry = entries_[uri];
+        entry.last_seen = frame_;
+        entry.culled = true;
+    }
+
+    // Marks the end of a deck frame; entries not seen for a while are dropped
+    void end_frame() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++frame_;
+        std::erase_if(entries_, [this](auto const& kv) {
+            return frame_ - kv.second.last_seen > window_size;
+        });
+    }
+
+    [[nodiscard]] std::vector<std::pair<std::string, stats>> snapshot() const {
+        std::vector<std::pair<std::string, stats>> result;
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.reserve(entries_.size());
+        std::vector<double> sorted;
+        for (auto const& [uri, entry] : entries_) {
+            sorted.assign(entry.ring.begin(), entry.ring.begin() + static_cast<std::ptrdiff_t>(entry.count));
+            std::sort(sorted.begin(), sorted.end());
+            stats s;
+            s.samples = entry.count;
+            s.worst_ms = entry.worst;
+            s.last_ms = entry.last;
+            s.culled = entry.culled;
+            if (!sorted.empty()) {
+                s.p50_ms = percentile(sorted, 0.50);
+                s.p99_ms = percentile(sorted, 0.99);
+            }
+            result.emplace_back(uri, s);
+        }
+        return result;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+private:
+    struct entry_t {
+        std::array<double, window_size> ring {};
+        size_t next {0};
+        size_t count {0};
+        double worst {0.0};
+        double last {0.0};
+        size_t last_seen {0};
+        bool culled {false};
+    };
+
+    static double percentile(std::vector<double> const& sorted, double p) {
+        auto const idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(idx, sorted.size() - 1)];
+    }
+
+    std::unordered_map<std::string, entry_t> entries_;
+    size_t frame_ {0};
+    mutable std::mutex mutex_;
+};
+
+} // namespace rouen::helpers
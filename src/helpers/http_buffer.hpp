@@ -0,0 +1,135 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+// None in this file
+
+namespace http {
+
+/**
+ * Immutable, reference-counted response body made of one or more chunks.
+ *
+ * Copies share the bytes. Bodies fill chunk by chunk as they download (see
+ * buffer_sink in fetch.hpp), so growing never moves what already arrived; when the
+ * server sent a Content-Length the whole body usually lands in a single chunk.
+ * Consumers that can read piecewise (file writers, SDL_RWops) walk the chunks;
+ * view() hands out contiguous bytes for parsers and joins the chunks at most once.
+ */
+class buffer {
+public:
+    buffer() = default;
+
+    // Takes over an already downloaded body without copying it
+    explicit buffer(std::string body) {
+        if (!body.empty()) {
+            auto s = std::make_shared<storage>();
+            s->size = body.size();
+            s->chunks.push_back(std::move(body));
+            storage_ = std::move(s);
+        }
+    }
+
+    explicit buffer(std::vector<std::string> chunks) {
+        std::erase_if(chunks, [](auto const& chunk) { return chunk.empty(); });
+        if (!chunks.empty()) {
+            auto s = std::make_shared<storage>();
+            for (auto const& chunk : chunks) {
+                s->size += chunk.size();
+            }
+            s->chunks = std::move(chunks);
+            storage_ = std::move(s);
+        }
+    }
+
+    [[nodiscard]] size_t size() const { return storage_ ? storage_->size : 0; }
+    [[nodiscard]] bool empty() const { return size() == 0; }
+    [[nodiscard]] size_t chunk_count() const { return storage_ ? storage_->chunks.size() : 0; }
+
+    [[nodiscard]] std::string_view chunk(size_t index) const {
+        return storage_->chunks[index];
+    }
+
+    template <typename F>
+    void for_each_chunk(F&& f) const {
+        if (storage_) {
+            for (auto const& c : storage_->chunks) {
+                f(std::string_view{c});
+            }
+        }
+    }
+
+    // Copies up to `count` bytes starting at `offset` into `out`; returns how many were copied
+    size_t read(size_t offset, char* out, size_t count) const {
+        size_t copied = 0;
+        size_t start = 0;
+        for (size_t i = 0; i < chunk_count() && copied < count; ++i) {
+            auto const c = chunk(i);
+            if (offset < start + c.size()) {
+                auto const from = offset > start ? offset - start : 0;
+                auto const n = std::min(c.size() - from, count - copied);
+                std::copy_n(c.data() + from, n, out + copied);
+                copied += n;
+                offset += n;
+            }
+            start += c.size();
+        }
+        return copied;
+    }
+
+    // Contiguous bytes, valid as long as any copy of this buffer lives. A single-chunk body
+    // is returned as it is; otherwise the chunks are joined once and the join is kept.
+    [[nodiscard]] std::string_view view() const {
+        if (!storage_) {
+            return {};
+        }
+        if (storage_->chunks.size() == 1) {
+            return storage_->chunks.front();
+        }
+        std::call_once(storage_->join_once, [s = storage_.get()]() {
+            s->joined.reserve(s->size);
+            for (auto const& c : s->chunks) {
+                s->joined += c;
+            }
+        });
+        return storage_->joined;
+    }
+
+    // Moves the bytes into a string: free for a single chunk nobody else shares
+    [[nodiscard]] std::string release() && {
+        if (!storage_) {
+            return {};
+        }
+        if (storage_.use_count() == 1 && storage_->chunks.size() == 1) {
+            auto body = std::move(storage_->chunks.front());
+            storage_.reset();
+            return body;
+        }
+        auto body = std::string{view()};
+        storage_.reset();
+        return body;
+    }
+
+private:
+    struct storage {
+        std::vector<std::string> chunks;
+        size_t size {0};
+        std::once_flag join_once;
+        std::string joined;
+    };
+
+    std::shared_ptr<storage> storage_;
+};
+
+} // namespace http
@@ -0,0 +1,197 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "debug.hpp"
+#include "sqlite.hpp"
+#include "write_behind.hpp"
+
+namespace http {
+
+/**
+ * On-disk store of GET responses and their validators (ETag / Last-Modified), used by
+ * fetch and the engine for requests that opt in with `cached`.
+ *
+ * A stored response is revalidated with If-None-Match / If-Modified-Since and a 304 is
+ * answered from here. Hosts can get a TTL during which the stored body is served without
+ * asking the server at all: set_ttl(), or ROUEN_HTTP_TTL="api.chess.com=3600,host=secs".
+ *
+ * lookup() reads on one of the database's readers and is meant for worker threads (the
+ * engine asks the task_scheduler before a request goes to its I/O thread). store() and
+ * touch() only queue the write for a write_behind, so they are cheap anywhere; until it is
+ * flushed lookup() answers from the queued response.
+ */
+class response_cache {
+public:
+    using clock = std::chrono::system_clock;
+
+    static constexpr auto max_age = std::chrono::hours(24 * 30);  // entries unused longer are dropped
+
+    struct entry {
+        std::string etag;
+        std::string last_modified;
+        std::string body;
+        clock::time_point stored;
+    };
+
+    static response_cache& instance() {
+        static response_cache cache{"http_cache.db"};
+        return cache;
+    }
+
+    // Requests differing only in headers (e.g. another account's token) are different entries
+    static std::string key(std::string_view url, std::string_view joined_headers) {
+        return joined_headers.empty() ? std::string{url}
+                                      : std::format("{}#{:x}", url, std::hash<std::string_view>{}(joined_headers));
+    }
+
+    std::optional<entry> lookup(std::string const& key) {
+        {
+            std::lock_guard<std::mutex> lock(unflushed_mutex_);
+            if (auto pos = unflushed_.find(key); pos != unflushed_.end()) {
+                return *pos->second;
+            }
+        }
+        std::optional<entry> result;
+        try {
+            db_.for_each_readonly<std::string, std::string, std::string, long long>(
+                "SELECT etag, last_modified, body, stored FROM http_cache WHERE key = ?",
+                [&result](std::string etag, std::string last_modified, std::string body, long long stored) {
+                    result = entry{std::move(etag), std::move(last_modified), std::move(body),
+                                   clock::time_point{std::chrono::seconds{stored}}};
+                }, key);
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("HTTP cache lookup failed: {}", e.what());
+        }
+        return result;
+    }
+
+    void store(std::string const& key, std::string const& etag, std::string const& last_modified, std::string const& body) {
+        queue(key, std::make_shared<entry const>(entry{etag, last_modified, body, clock::now()}));
+    }
+
+    // The server confirmed the stored body (304): restart its TTL
+    void touch(std::string const& key) {
+        {
+            // A response still queued is queued again with the new time, not replaced by the update
+            std::unique_lock<std::mutex> lock(unflushed_mutex_);
+            if (auto pos = unflushed_.find(key); pos != unflushed_.end()) {
+                auto touched = std::make_shared<entry const>(entry{pos->second->etag, pos->second->last_modified,
+                                                                   pos->second->body, clock::now()});
+                lock.unlock();
+                queue(key, std::move(touched));
+                return;
+            }
+        }
+        writes_.put(key, [key, stored = now_seconds()](hosting::db::sqlite& db) {
+            db.exec("UPDATE http_cache SET stored = ? WHERE key = ?", nullptr, stored, key);
+        });
+    }
+
+    void set_ttl(std::string host, std::chrono::seconds ttl) {
+        std::lock_guard<std::mutex> lock(ttl_mutex_);
+        ttl_[std::move(host)] = ttl;
+    }
+
+    [[nodiscard]] std::chrono::seconds ttl(std::string_view url) const {
+        auto const scheme_end = url.find("://");
+        auto const host_start = scheme_end == std::string_view::npos ? 0 : scheme_end + 3;
+        auto const host = url.substr(host_start, url.find_first_of(":/?#", host_start) - host_start);
+        std::lock_guard<std::mutex> lock(ttl_mutex_);
+        auto pos = ttl_.find(std::string{host});
+        return pos == ttl_.end() ? std::chrono::seconds{0} : pos->second;
+    }
+
+    // Within the host's TTL the entry can be used without revalidation
+    [[nodiscard]] bool fresh(entry const& e, std::string_view url) const {
+        auto const t = ttl(url);
+        return t.count() > 0 && clock::now() - e.stored < t;
+    }
+
+    void clear() {
+        writes_.flush();
+        try {
+            db_.exec("DELETE FROM http_cache");
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("HTTP cache clear failed: {}", e.what());
+        }
+    }
+
+private:
+    explicit response_cache(std::string const& path) : db_{path} {
+        db_.ensure_table("http_cache",
+            "key TEXT PRIMARY KEY, etag TEXT, last_modified TEXT, body BLOB, stored INTEGER");
+        try {
+            auto const cutoff = now_seconds() - std::chrono::duration_cast<std::chrono::seconds>(max_age).count();
+            db_.exec("DELETE FROM http_cache WHERE stored < ?", nullptr, cutoff);
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("HTTP cache pruning failed: {}", e.what());
+        }
+        if (char const* spec = std::getenv("ROUEN_HTTP_TTL")) {
+            parse_ttl_spec(spec);
+        }
+        writes_.on_flushed([this](std::vector<std::string> const& keys) {
+            std::lock_guard<std::mutex> lock(unflushed_mutex_);
+            for (auto const& key : keys) {
+                unflushed_.erase(key);
+            }
+        });
+    }
+
+    void queue(std::string const& key, std::shared_ptr<entry const> e) {
+        {
+            std::lock_guard<std::mutex> lock(unflushed_mutex_);
+            unflushed_[key] = e;
+        }
+        writes_.put(key, [key, e = std::move(e)](hosting::db::sqlite& db) {
+            db.exec("INSERT OR REPLACE INTO http_cache (key, etag, last_modified, body, stored) VALUES (?, ?, ?, ?, ?)",
+                nullptr, key, e->etag, e->last_modified, e->body,
+                std::chrono::duration_cast<std::chrono::seconds>(e->stored.time_since_epoch()).count());
+        });
+    }
+
+    void parse_ttl_spec(std::string_view spec) {
+        while (!spec.empty()) {
+            auto const comma = spec.find(',');
+            auto const item = spec.substr(0, comma);
+            spec = comma == std::string_view::npos ? std::string_view{} : spec.substr(comma + 1);
+            auto const eq = item.find('=');
+            if (eq == std::string_view::npos) {
+                continue;
+            }
+            try {
+                set_ttl(std::string{item.substr(0, eq)}, std::chrono::seconds{std::stol(std::string{item.substr(eq + 1)})});
+            } catch (const std::exception&) {
+                DB_WARN_FMT("Ignoring invalid ROUEN_HTTP_TTL entry: {}", item);
+            }
+        }
+    }
+
+    static long long now_seconds() {
+        return std::chrono::duration_cast<std::chrono::seconds>(clock::now().time_since_epoch()).count();
+    }
+
+    hosting::db::sqlite db_;
+    mutable std::mutex ttl_mutex_;
+    std::unordered_map<std::string, std::chrono::seconds> ttl_;
+    std::mutex unflushed_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<entry const>> unflushed_;   // queued, not written yet
+    hosting::db::write_behind writes_ {db_};    // after what its flushes touch: destroyed (and flushed) first
+};
+
+} // namespace http
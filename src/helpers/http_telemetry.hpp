@@ -0,0 +1,280 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <glaze/glaze.hpp>
+
+// 3. All other includes
+// None in this file
+
+namespace http {
+
+// Timings of one finished transfer, in microseconds; phases a reused connection skipped are 0
+struct transfer_sample {
+    long status {0};
+    bool failed {false};        // transport error or HTTP status >= 400
+    bool retried {false};       // throttled and queued again
+    bool http2 {false};         // HTTP/2 or later, i.e. multiplexed
+    uint64_t dns_us {0};
+    uint64_t connect_us {0};
+    uint64_t tls_us {0};
+    uint64_t ttfb_us {0};       // from start to the first response byte
+    uint64_t total_us {0};
+    uint64_t bytes_in {0};      // as received, i.e. compressed
+    uint64_t bytes_out {0};
+};
+
+// Aggregates for one host, as returned by telemetry::snapshot()
+struct host_stats {
+    std::string host;
+    uint64_t requests {0};
+    uint64_t failures {0};
+    uint64_t retries {0};
+    uint64_t http2 {0};         // requests carried over multiplexed HTTP/2+ connections
+    uint64_t bytes_in {0};
+    uint64_t bytes_out {0};
+    std::array<uint64_t, 6> status_classes {};  // [0] no response, [1]..[5] 1xx..5xx
+    double dns_ms {0};          // averages
+    double connect_ms {0};
+    double tls_ms {0};
+    double ttfb_ms {0};
+    double total_ms {0};
+    double p50_ms {0};          // estimated from the latency histogram
+    double p99_ms {0};
+};
+
+} // namespace http
+
+template <>
+struct glz::meta<http::host_stats> {
+    using T = http::host_stats;
+    static constexpr auto value = object(
+        "host", &T::host,
+        "requests", &T::requests,
+        "failures", &T::failures,
+        "retries", &T::retries,
+        "http2", &T::http2,
+        "bytes_in", &T::bytes_in,
+        "bytes_out", &T::bytes_out,
+        "status_classes", &T::status_classes,
+        "dns_ms", &T::dns_ms,
+        "connect_ms", &T::connect_ms,
+        "tls_ms", &T::tls_ms,
+        "ttfb_ms", &T::ttfb_ms,
+        "total_ms", &T::total_ms,
+        "p50_ms", &T::p50_ms,
+        "p99_ms", &T::p99_ms
+    );
+};
+
+namespace http {
+
+/**
+ * Per-host HTTP metrics fed by fetch and the engine after every transfer.
+ *
+ * Recording is a handful of relaxed atomic increments on the host's counters; the map
+ * lock is only taken to find them. Total latency goes into a power-of-two histogram
+ * (bucket i holds [2^(i-1), 2^i) ms), from which snapshot() estimates percentiles.
+ */
+class telemetry {
+public:
+    static constexpr size_t latency_buckets = 18;  // the last one collects everything over ~65 s
+
+    // Adaptive timeouts: p99 x timeout_factor once a host has timeout_min_samples, never below timeout_floor
+    static constexpr double timeout_factor = 4.0;
+    static constexpr uint64_t timeout_min_samples = 10;
+    static constexpr long timeout_floor = 5;       // seconds
+
+    static telemetry& instance() {
+        static telemetry metrics;
+        return metrics;
+    }
+
+    void record(std::string_view host, transfer_sample const& t) {
+        if (host.empty()) {
+            return;  // file:// and the like
+        }
+        auto& c = counters_for(host);
+        auto add = [](std::atomic<uint64_t>& counter, uint64_t value) {
+            counter.fetch_add(value, std::memory_order_relaxed);
+        };
+        add(c.requests, 1);
+        add(c.failures, t.failed ? 1 : 0);
+        add(c.retries, t.retried ? 1 : 0);
+        add(c.http2, t.http2 ? 1 : 0);
+        add(c.bytes_in, t.bytes_in);
+        add(c.bytes_out, t.bytes_out);
+        add(c.status_classes[t.status >= 100 && t.status < 600 ? static_cast<size_t>(t.status / 100) : 0], 1);
+        add(c.dns_us, t.dns_us);
+        add(c.connect_us, t.connect_us);
+        add(c.tls_us, t.tls_us);
+        add(c.ttfb_us, t.ttfb_us);
+        add(c.total_us, t.total_us);
+        add(c.latency[bucket(t.total_us / 1000)], 1);
+    }
+
+    [[nodiscard]] std::vector<host_stats> snapshot() const {
+        std::vector<host_stats> result;
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.reserve(hosts_.size());
+        for (auto const& [host, c] : hosts_) {
+            auto load = [](std::atomic<uint64_t> const& counter) {
+                return counter.load(std::memory_order_relaxed);
+            };
+            host_stats s;
+            s.host = host;
+            s.requests = load(c->requests);
+            s.failures = load(c->failures);
+            s.retries = load(c->retries);
+            s.http2 = load(c->http2);
+            s.bytes_in = load(c->bytes_in);
+            s.bytes_out = load(c->bytes_out);
+            for (size_t i = 0; i < s.status_classes.size(); ++i) {
+                s.status_classes[i] = load(c->status_classes[i]);
+            }
+            if (s.requests > 0) {
+                auto const n = static_cast<double>(s.requests) * 1000.0;
+                s.dns_ms = static_cast<double>(load(c->dns_us)) / n;
+                s.connect_ms = static_cast<double>(load(c->connect_us)) / n;
+                s.tls_ms = static_cast<double>(load(c->tls_us)) / n;
+                s.ttfb_ms = static_cast<double>(load(c->ttfb_us)) / n;
+                s.total_ms = static_cast<double>(load(c->total_us)) / n;
+            }
+            std::array<uint64_t, latency_buckets> histogram {};
+            for (size_t i = 0; i < latency_buckets; ++i) {
+                histogram[i] = load(c->latency[i]);
+            }
+            s.p50_ms = percentile(histogram, 0.50);
+            s.p99_ms = percentile(histogram, 0.99);
+            result.push_back(std::move(s));
+        }
+        return result;
+    }
+
+    // Timeout in seconds for the next request to `host`: a generous multiple of what the
+    // host usually takes, capped at the caller's `ceiling`, so a dead server fails fast
+    [[nodiscard]] long timeout_for(std::string_view host, long ceiling) const {
+        std::array<uint64_t, latency_buckets> histogram {};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto pos = hosts_.find(std::string{host});
+            if (pos == hosts_.end()) {
+                return ceiling;
+            }
+            for (size_t i = 0; i < latency_buckets; ++i) {
+                histogram[i] = pos->second->latency[i].load(std::memory_order_relaxed);
+            }
+        }
+        uint64_t samples = 0;
+        for (auto count : histogram) {
+            samples += count;
+        }
+        if (samples < timeout_min_samples) {
+            return ceiling;
+        }
+        auto const adaptive = static_cast<long>(percentile(histogram, 0.99) * timeout_factor / 1000.0) + 1;
+        return std::min(ceiling, std::max(timeout_floor, adaptive));
+    }
+
+    [[nodiscard]] std::string to_json() const {
+        std::string json;
+        auto ec = glz::write_json(snapshot(), json);
+        if (ec) {
+            return "[]";
+        }
+        return json;
+    }
+
+    // Counters restart from zero; hosts already seen stay listed
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [_, c] : hosts_) {
+            c->clear();
+        }
+    }
+
+private:
+    struct counters {
+        std::atomic<uint64_t> requests {0};
+        std::atomic<uint64_t> failures {0};
+        std::atomic<uint64_t> retries {0};
+        std::atomic<uint64_t> http2 {0};
+        std::atomic<uint64_t> bytes_in {0};
+        std::atomic<uint64_t> bytes_out {0};
+        std::array<std::atomic<uint64_t>, 6> status_classes {};
+        std::atomic<uint64_t> dns_us {0};
+        std::atomic<uint64_t> connect_us {0};
+        std::atomic<uint64_t> tls_us {0};
+        std::atomic<uint64_t> ttfb_us {0};
+        std::atomic<uint64_t> total_us {0};
+        std::array<std::atomic<uint64_t>, latency_buckets> latency {};
+
+        // In place: recorders may hold a reference
+        void clear() {
+            for (auto* counter : {&requests, &failures, &retries, &http2, &bytes_in, &bytes_out,
+                                  &dns_us, &connect_us, &tls_us, &ttfb_us, &total_us}) {
+                counter->store(0, std::memory_order_relaxed);
+            }
+            for (auto& counter : status_classes) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+            for (auto& counter : latency) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    telemetry() = default;
+
+    counters& counters_for(std::string_view host) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& c = hosts_[std::string{host}];
+        if (!c) {
+            c = std::make_unique<counters>();
+        }
+        return *c;
+    }
+
+    static size_t bucket(uint64_t ms) {
+        return std::min(static_cast<size_t>(std::bit_width(ms)), latency_buckets - 1);
+    }
+
+    // Upper edge of the bucket holding the p-th sample
+    static double percentile(std::array<uint64_t, latency_buckets> const& histogram, double p) {
+        uint64_t total = 0;
+        for (auto count : histogram) {
+            total += count;
+        }
+        if (total == 0) {
+            return 0;
+        }
+        auto const rank = static_cast<uint64_t>(p * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < latency_buckets; ++i) {
+            seen += histogram[i];
+            if (seen >= rank) {
+                return static_cast<double>(uint64_t{1} << i);
+            }
+        }
+        return static_cast<double>(uint64_t{1} << (latency_buckets - 1));
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<counters>> hosts_;
+};
+
+} // namespace http
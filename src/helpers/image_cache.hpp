@@ -1,16 +1,37 @@
 #pragma once
 
+#include <atomic>
+#include <format>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include <optional>
 #include <mutex>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <fstream>
 #include <SDL.h>
+#include <SDL_image.h>
 
+#include "../registrar.hpp"
+#include "deferred_operations.hpp"
 #include "fetch.hpp"
+#include "image_pack.hpp"
+#include "memory_accounting.hpp"
+#include "redraw.hpp"
 #include "sqlite.hpp"
+#include "startup_timeline.hpp"
+#include "task_scheduler.hpp"
+#include "texture_atlas.hpp"
 #include "texture_helper.hpp"
+#include "write_behind.hpp"
 
 namespace helpers {
 
@@ -22,9 +43,142 @@ namespace helpers {
  * 2. Storing image data in SQLite database
  * 3. Retrieving cached images when available
  * 4. Loading images as SDL textures for rendering
+ * 5. Loading textures and downscaled thumbnails off the UI thread (requestTexture, requestThumbnail)
+ *
+ * With ROUEN_IMAGE_PACK=1 new images go to one memory-mapped ImagePack in the cache directory
+ * instead of a file each; images already cached as files are still read from them.
  */
-class ImageCache {
+class ImageCache : public std::enable_shared_from_this<ImageCache> {
 public:
+    /**
+     * Handle to an image requestTexture() or requestThumbnail() is loading. It is pending
+     * until the texture has been uploaded on the main thread, or until the image turns out
+     * not to load. texture() is for the main thread; the texture goes with the last reference.
+     * Images that fit texture_atlas::max_side go into the shared atlas instead of a texture
+     * of their own: draw with textureId(), uv0() and uv1(), which cover both cases.
+     */
+    class AsyncTexture {
+    public:
+        enum class State { pending, ready, failed };
+
+        AsyncTexture() = default;
+        AsyncTexture(AsyncTexture const&) = delete;
+        AsyncTexture& operator=(AsyncTexture const&) = delete;
+
+        ~AsyncTexture() {
+            if (texture_) {
+                SDL_DestroyTexture(texture_);
+            }
+        }
+
+        [[nodiscard]] State state() const { return state_.load(std::memory_order_acquire); }
+        [[nodiscard]] bool ready() const { return state() == State::ready; }
+        [[nodiscard]] SDL_Texture* texture() const { return texture_; }   // null when in the atlas
+        [[nodiscard]] ImTextureID textureId() const {
+            return region_ ? region_->texture : reinterpret_cast<ImTextureID>(texture_);
+        }
+        [[nodiscard]] ImVec2 uv0() const { return region_ ? region_->uv0 : ImVec2{0.0f, 0.0f}; }
+        [[nodiscard]] ImVec2 uv1() const { return region_ ? region_->uv1 : ImVec2{1.0f, 1.0f}; }
+        [[nodiscard]] int width() const { return width_; }
+        [[nodiscard]] int height() const { return height_; }
+        // What the texture takes in video memory, as RGBA; atlas pages are accounted for apart
+        [[nodiscard]] size_t bytes() const { return texture_ ? static_cast<size_t>(width_) * height_ * 4 : 0; }
+
+    private:
+        friend class ImageCache;
+        std::atomic<State> state_ {State::pending};
+        SDL_Texture* texture_ {nullptr};
+        std::shared_ptr<rouen::helpers::texture_atlas::region> region_;
+        int width_ {0};
+        int height_ {0};
+    };
+
+    /**
+     * The textures kept in memory, shared by every ImageCache and keyed by URL and size:
+     * requesting an image that is resident (or still loading) hands out the same handle.
+     * Past the byte budget the least recently requested textures nobody else holds are
+     * dropped; the budget is ROUEN_TEXTURE_BUDGET_MB (128 by default). Main thread only,
+     * like the textures themselves.
+     */
+    class TextureMemory {
+    public:
+        static TextureMemory& instance() {
+            static TextureMemory memory;
+            return memory;
+        }
+
+        // The handle for `key`, now the most recently used; null if not resident or it failed
+        std::shared_ptr<AsyncTexture> find(const std::string& key) {
+            auto pos = index_.find(key);
+            if (pos == index_.end()) {
+                return nullptr;
+            }
+            if (pos->second->second->state() == AsyncTexture::State::failed) {
+                lru_.erase(pos->second);
+                index_.erase(pos);
+                return nullptr;     // asked for again: it gets another try
+            }
+            lru_.splice(lru_.begin(), lru_, pos->second);
+            return pos->second->second;
+        }
+
+        void insert(const std::string& key, std::shared_ptr<AsyncTexture> handle) {
+            if (auto pos = index_.find(key); pos != index_.end()) {
+                lru_.erase(pos->second);
+                index_.erase(pos);
+            }
+            lru_.emplace_front(key, std::move(handle));
+            index_.emplace(key, lru_.begin());
+            trim();
+        }
+
+        // Drops idle textures, least recently used first, until the ones left fit the budget
+        void trim() {
+            size_t total = 0;
+            for (auto const& [key, handle] : lru_) {
+                total += handle->bytes();
+            }
+            for (auto pos = lru_.end(); total > budget_ && pos != lru_.begin();) {
+                --pos;
+                if (pos->second.use_count() > 1) {
+                    continue;   // on screen somewhere: freeing it here would free nothing
+                }
+                total -= pos->second->bytes();
+                index_.erase(pos->first);
+                pos = lru_.erase(pos);
+            }
+            bytes_ = total;
+        }
+
+        void setBudget(size_t bytes) {
+            budget_ = bytes;
+            trim();
+        }
+
+        // Lets go of every texture; before the renderer they belong to is destroyed
+        void clear() {
+            index_.clear();
+            lru_.clear();
+            bytes_ = 0;
+        }
+
+        [[nodiscard]] size_t budget() const { return budget_; }
+        // Resident texture bytes as of the last trim()
+        [[nodiscard]] size_t bytes() const { return bytes_; }
+
+    private:
+        TextureMemory() {
+            auto const spec = std::getenv("ROUEN_TEXTURE_BUDGET_MB");
+            budget_ = (spec ? static_cast<size_t>(std::strtoull(spec, nullptr, 10)) : size_t{128}) << 20;
+        }
+
+        std::list<std::pair<std::string, std::shared_ptr<AsyncTexture>>> lru_;   // most recent first
+        std::unordered_map<std::string, decltype(lru_)::iterator> index_;
+        size_t budget_ {0};
+        size_t bytes_ {0};
+        rouen::helpers::memory::report report_ {"image textures", [this] { return bytes_; }};
+    };
+
     /**
      * Constructor - initializes the database connection and ensures tables exist
      * 
@@ -50,10 +204,24 @@ public:
             "last_accessed TEXT DEFAULT (datetime('now'))"
         );
         
-        // Cleanup expired images if expiry_days > 0
+        // Cleanup expired images if expiry_days > 0; off the UI thread, once per database per run
         if (expiry_days_ > 0) {
-            cleanupExpiredImages();
+            scheduleCleanup(db_path, expiry_days_);
         }
+
+        if (auto const spec = std::getenv("ROUEN_IMAGE_PACK"); spec && std::string_view{spec} != "0") {
+            pack_ = ImagePack::open(db_path, cache_dir_);
+            if (pack_) {
+                pack_->scheduleMaintenance(expiry_days_);
+                writes_.on_flushed([pack = pack_](std::vector<std::string> const& urls) {
+                    pack->touch(std::unordered_set<std::string>{urls.begin(), urls.end()});
+                });
+            }
+        }
+    }
+
+    ~ImageCache() {
+        flushLastAccessed();
     }
     
     /**
@@ -64,13 +232,22 @@ public:
      * @param width Output parameter for image width
      * @param height Output parameter for image height
      * @param force_download Force download even if cached
-     * @return SDL_Texture pointer if successful, nullptr if failed
+     * @return SDL_Texture pointer if successful, nullptr if failed; the caller destroys it.
+     *         Not kept in TextureMemory: prefer requestTexture(), which shares textures
      */
     SDL_Texture* getTexture(SDL_Renderer* renderer, const std::string& url, 
                           int& width, int& height, bool force_download = false) {
         
         // Try to get the image from cache if not forcing download
         if (!force_download) {
+            if (SDL_Surface* surface = loadPacked(url); surface) {
+                updateLastAccessed(url);
+                width = surface->w;
+                height = surface->h;
+                SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+                SDL_FreeSurface(surface);
+                return texture;
+            }
             auto cached_path = getImageFromCache(url, width, height);
             if (cached_path) {
                 // Update the last accessed time
@@ -83,53 +260,46 @@ public:
         
         // Image not in cache or forcing download, download it
         try {
-            // Generate a filename based on URL hash
-            auto url_hash = std::hash<std::string>{}(url);
-            std::string final_path = std::filesystem::path(cache_dir_) / (std::to_string(url_hash) + ".img");
-            std::string temp_path = final_path + ".tmp";
-            
-            // Create file for writing
-            FILE* fp = fopen(temp_path.c_str(), "wb");
-            if (!fp) {
-                return nullptr;
-            }
-            
-            // Set up callback to write to file
-            auto write_callback = [](void* ptr, size_t size, size_t nmemb, void* stream) -> size_t {
-                return fwrite(ptr, size, nmemb, (FILE*)stream);
-            };
-            
-            // Download the image
-            fetcher_(url, {}, write_callback, fp);
-            
-            // Close the file
-            fclose(fp);
-            
-            // Load the image to get dimensions
-            SDL_Texture* texture = TextureHelper::loadTextureFromFile(renderer, temp_path.c_str(), width, height);
+            // Download the image; concurrent requests for the same URL share one transfer
+            auto const image = http::buffer{fetcher_(url)};
             
+            // Decode straight from memory, then keep the bytes on disk for next time
+            SDL_Texture* texture = TextureHelper::loadTextureFromBuffer(renderer, image, url.c_str(), width, height);
             if (texture) {
-                // Move the temporary file to its final location
-                if (std::filesystem::exists(final_path)) {
-                    std::filesystem::remove(final_path);
-                }
-                std::filesystem::rename(temp_path, final_path);
-                
-                // Store info in cache
-                storeImageInCache(url, final_path, width, height);
-                
-                return texture;
+                storeOriginal(url, image, width, height);
             }
-            
-            // Cleanup temp file on failure
-            std::filesystem::remove(temp_path);
-            return nullptr;
+            return texture;
         }
         catch (const std::exception& e) {
             return nullptr;
         }
     }
     
+    /**
+     * getTexture() without blocking the caller: returns at once with a pending handle.
+     * Downloading (on the shared HTTP engine) and decoding (on the task scheduler) happen in
+     * the background; the texture is created on the main thread through deferred_operations.
+     * Shares its cache entries with getTexture(). The cache must be owned by a std::shared_ptr.
+     * Requests for an image already in TextureMemory get the same handle, without any I/O.
+     */
+    std::shared_ptr<AsyncTexture> requestTexture(SDL_Renderer* renderer, const std::string& url) {
+        return request(renderer, url, 0, 0);
+    }
+
+    /**
+     * requestTexture() scaled down to fit max_width x max_height, for images shown much
+     * smaller than they are (podcast covers run to 3000 px): downscaling happens on the worker
+     * and the thumbnail is kept in the cache as a PNG, under the URL and size.
+     */
+    std::shared_ptr<AsyncTexture> requestThumbnail(SDL_Renderer* renderer, const std::string& url, int max_width, int max_height) {
+        if (max_width <= 0 || max_height <= 0) {
+            auto failed = std::make_shared<AsyncTexture>();
+            failed->state_ = AsyncTexture::State::failed;
+            return failed;
+        }
+        return request(renderer, url, max_width, max_height);
+    }
+
     /**
      * Clears the entire image cache
      */
@@ -156,6 +326,11 @@ public:
         // Delete all records from the table
         db_.exec("DELETE FROM image_cache");
         
+        if (pack_) {
+            pack_->clear();
+            pack_->compactIfWorthIt();
+        }
+
         // Vacuum the database to reclaim space
         db_.exec("VACUUM");
     }
@@ -186,9 +361,204 @@ public:
         // Delete the record
         sql = "DELETE FROM image_cache WHERE url = ?";
         db_.exec(sql, {}, url);
+
+        if (pack_) {
+            pack_->remove(url);
+        }
     }
 
 private:
+    // Cache entry of an image: its URL, plus the size for a thumbnail (max_width 0: full size)
+    static std::string cacheKey(const std::string& url, int max_width, int max_height) {
+        return max_width > 0 ? std::format("{}#thumbnail={}x{}", url, max_width, max_height) : url;
+    }
+
+    // A handle, then the cache lookup (or the download) on the scheduler
+    std::shared_ptr<AsyncTexture> request(SDL_Renderer* renderer, const std::string& url, int max_width, int max_height) {
+        auto const key = cacheKey(url, max_width, max_height);
+        if (auto resident = TextureMemory::instance().find(key); resident) {
+            updateLastAccessed(key);
+            return resident;
+        }
+        auto handle = std::make_shared<AsyncTexture>();
+        if (!renderer || url.empty()) {
+            handle->state_ = AsyncTexture::State::failed;
+            return handle;
+        }
+        TextureMemory::instance().insert(key, handle);
+        std::weak_ptr<AsyncTexture> target = handle;
+        rouen::helpers::scheduler()->submit([self = shared_from_this(), renderer, url, max_width, max_height, target](std::stop_token) {
+            if (target.expired()) {
+                return;
+            }
+            auto const key = cacheKey(url, max_width, max_height);
+            if (SDL_Surface* surface = self->loadPacked(key); surface) {
+                self->updateLastAccessed(key);
+                upload(renderer, surface, target);
+                return;
+            }
+            int width = 0, height = 0;
+            if (auto cached_path = self->getImageFromCache(key, width, height); cached_path) {
+                if (SDL_Surface* surface = IMG_Load(cached_path->c_str()); surface) {
+                    self->updateLastAccessed(key);
+                    upload(renderer, surface, target);
+                    return;
+                }
+            }
+            self->download(renderer, url, max_width, max_height, target);
+        }, rouen::helpers::task_priority::normal);
+        return handle;
+    }
+
+    // The engine's completion callback only hands the body on: decoding runs on the scheduler
+    void download(SDL_Renderer* renderer, const std::string& url, int max_width, int max_height,
+                  std::weak_ptr<AsyncTexture> target) {
+        auto sink = std::make_shared<http::buffer_sink>();
+        auto request = fetcher_.make_request(url);
+        request.sink = sink.get();
+        http::engine::instance().submit(std::move(request),
+            [self = shared_from_this(), sink, renderer, url, max_width, max_height, target](http::response response) {
+                if (!response.ok()) {
+                    TEXTURE_ERROR_FMT("Failed to download image {}: {}", url, response.error);
+                    fail(target);
+                    return;
+                }
+                rouen::helpers::scheduler()->submit([self, image = sink->take(), renderer, url, max_width, max_height, target](std::stop_token) {
+                    if (target.expired()) {
+                        return;
+                    }
+                    SDL_Surface* surface = TextureHelper::decodeSurface(image, url.c_str());
+                    if (!surface) {
+                        fail(target);
+                        return;
+                    }
+                    if (max_width > 0) {
+                        surface = TextureHelper::downscaleSurface(surface, max_width, max_height);
+                        self->storeThumbnail(cacheKey(url, max_width, max_height), surface);
+                    } else {
+                        self->storeOriginal(url, image, surface->w, surface->h);
+                    }
+                    upload(renderer, surface, target);
+                }, rouen::helpers::task_priority::normal);
+            });
+    }
+
+    // The image stored under `key` in the pack, decoded from the mapping; null if not packed
+    SDL_Surface* loadPacked(const std::string& key) {
+        if (!pack_) {
+            return nullptr;
+        }
+        auto blob = pack_->find(key);
+        if (!blob) {
+            return nullptr;
+        }
+        SDL_Surface* surface = TextureHelper::decodeSurface(blob->data, blob->size, key.c_str());
+        if (!surface) {
+            pack_->remove(key);     // torn by a crash mid-append: fetched again
+        }
+        return surface;
+    }
+
+    // Keeps the downloaded bytes on disk for next time and records them under `url`
+    bool storeOriginal(const std::string& url, http::buffer const& image, int width, int height) {
+        if (pack_) {
+            return pack_->append(url, image, width, height);
+        }
+        // Generate a filename based on URL hash
+        auto url_hash = std::hash<std::string>{}(url);
+        std::string final_path = std::filesystem::path(cache_dir_) / (std::to_string(url_hash) + ".img");
+        // Per-call temp file: items showing the same image may download it at the same time
+        static std::atomic<unsigned> download_count {0};
+        std::string temp_path = final_path + "." + std::to_string(download_count++) + ".tmp";
+        
+        FILE* fp = fopen(temp_path.c_str(), "wb");
+        if (!fp) {
+            return false;
+        }
+        bool written = true;
+        image.for_each_chunk([&](std::string_view chunk) {
+            written = written && fwrite(chunk.data(), 1, chunk.size(), fp) == chunk.size();
+        });
+        written = fclose(fp) == 0 && written;
+        
+        // Move the temporary file to its final location (another download may have just done so)
+        std::error_code ec;
+        if (written) {
+            std::filesystem::remove(final_path, ec);
+            std::filesystem::rename(temp_path, final_path, ec);
+        }
+        if (!written || ec) {
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+        
+        // Store info in cache
+        return storeImageInCache(url, final_path, width, height);
+    }
+
+    // Writes a thumbnail next to the other cached images and records it
+    void storeThumbnail(const std::string& key, SDL_Surface* surface) {
+        if (pack_) {
+            if (auto png = TextureHelper::encodePNG(surface); !png.empty()) {
+                pack_->append(key, png, surface->w, surface->h);
+            }
+            return;
+        }
+        auto key_hash = std::hash<std::string>{}(key);
+        std::string final_path = std::filesystem::path(cache_dir_) / (std::to_string(key_hash) + ".png");
+        static std::atomic<unsigned> write_count {0};
+        std::string temp_path = final_path + "." + std::to_string(write_count++) + ".tmp";
+        std::error_code ec;
+        if (IMG_SavePNG(surface, temp_path.c_str()) != 0) {
+            TEXTURE_ERROR_FMT("Failed to save thumbnail {}: {}", temp_path, IMG_GetError());
+            std::filesystem::remove(temp_path, ec);
+            return;
+        }
+        std::filesystem::rename(temp_path, final_path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_path, ec);
+            return;
+        }
+        storeImageInCache(key, final_path, surface->w, surface->h);
+    }
+
+    static void fail(std::weak_ptr<AsyncTexture> const& target) {
+        if (auto handle = target.lock(); handle) {
+            handle->state_.store(AsyncTexture::State::failed, std::memory_order_release);
+            rouen::helpers::request_redraw();
+        }
+    }
+
+    // The texture is made from the surface on the main thread, between frames
+    static void upload(SDL_Renderer* renderer, SDL_Surface* surface, std::weak_ptr<AsyncTexture> target) {
+        std::shared_ptr<deferred_operations> deferred;
+        try {
+            deferred = registrar::get<deferred_operations>("deferred_ops");
+        } catch (...) {
+            SDL_FreeSurface(surface);
+            fail(target);
+            return;
+        }
+        deferred->queue([renderer, surface, target] {
+            if (auto handle = target.lock(); handle && !handle->texture_ && !handle->region_) {
+                handle->region_ = rouen::helpers::texture_atlas::instance().add(renderer, surface);
+                if (!handle->region_) {
+                    handle->texture_ = SDL_CreateTextureFromSurface(renderer, surface);
+                }
+                if (handle->texture_ || handle->region_) {
+                    handle->width_ = surface->w;
+                    handle->height_ = surface->h;
+                    handle->state_.store(AsyncTexture::State::ready, std::memory_order_release);
+                    TextureMemory::instance().trim();
+                } else {
+                    TEXTURE_ERROR_FMT("Failed to create texture: {}", SDL_GetError());
+                    handle->state_.store(AsyncTexture::State::failed, std::memory_order_release);
+                }
+            }
+            SDL_FreeSurface(surface);
+        }, deferred_operations::lane::bulk);
+    }
+
     /**
      * Attempts to retrieve an image from the cache
      * 
@@ -248,35 +618,64 @@ private:
     }
     
     /**
-     * Updates the last accessed timestamp for a cached image
+     * Marks a cached image as used. Only expiry reads last_accessed, so the writes are
+     * queued and made together in the background, at most every flush_interval (and on
+     * destruction).
      * 
      * @param url URL of the image to update
      */
     void updateLastAccessed(const std::string& url) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        std::string sql = "UPDATE image_cache SET last_accessed = datetime('now') WHERE url = ?";
-        db_.exec(sql, {}, url);
+        writes_.put(url, [url](hosting::db::sqlite& db) {
+            db.exec("UPDATE image_cache SET last_accessed = datetime('now') WHERE url = ?", {}, url);
+        });
+    }
+
+    // Writes the queued last_accessed updates now
+    void flushLastAccessed() {
+        writes_.flush();
     }
     
     /**
      * Deletes expired images from the cache
      */
     void cleanupExpiredImages() {
-        if (expiry_days_ <= 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cleanupExpiredImages(db_, expiry_days_);
+    }
+
+    /**
+     * Runs cleanupExpiredImages on the task scheduler with its own connection.
+     * Several caches can share one database; only the first one asks for the cleanup.
+     */
+    static void scheduleCleanup(const std::string& db_path, int expiry_days) {
+        static std::mutex scheduled_mutex;
+        static std::set<std::string> scheduled;
+        {
+            std::lock_guard<std::mutex> lock(scheduled_mutex);
+            if (!scheduled.insert(db_path).second) {
+                return;
+            }
+        }
+        rouen::helpers::scheduler()->submit([db_path, expiry_days](std::stop_token) {
+            rouen::helpers::startup_timeline::scope timing{"image_cache_cleanup"};
+            hosting::db::sqlite db{db_path};
+            cleanupExpiredImages(db, expiry_days);
+        }, rouen::helpers::task_priority::background);
+    }
+
+    static void cleanupExpiredImages(hosting::db::sqlite& db, int expiry_days) {
+        if (expiry_days <= 0) {
             return;
         }
         
-        std::lock_guard<std::mutex> lock(mutex_);
-        
         // Get expired file paths first
         std::vector<std::string> expired_files;
         std::string sql = std::format(
             "SELECT file_path FROM image_cache WHERE last_accessed < datetime('now', '-{} days')",
-            expiry_days_
+            expiry_days
         );
         
-        db_.exec(sql, [&expired_files](sqlite3_stmt* stmt) {
+        db.exec(sql, [&expired_files](sqlite3_stmt* stmt) {
             const char* path = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
             if (path) {
                 expired_files.push_back(path);
@@ -293,9 +692,9 @@ private:
         // Delete records from database
         sql = std::format(
             "DELETE FROM image_cache WHERE last_accessed < datetime('now', '-{} days')",
-            expiry_days_
+            expiry_days
         );
-        db_.exec(sql);
+        db.exec(sql);
     }
     
     /**
@@ -318,11 +717,15 @@ private:
     }
 
 private:
+    static constexpr std::chrono::seconds flush_interval {60};
+
     hosting::db::sqlite db_;
     std::string cache_dir_;
     int expiry_days_;
     http::fetch fetcher_;
+    std::shared_ptr<ImagePack> pack_;               // null unless ROUEN_IMAGE_PACK is set
     std::mutex mutex_;
+    hosting::db::write_behind writes_ {db_, flush_interval};   // last_accessed updates
 };
 
 } // namespace helpers
\ No newline at end of file
@@ -0,0 +1,425 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "http_buffer.hpp"
+#include "sqlite.hpp"
+#include "task_scheduler.hpp"
+#include "texture_helper.hpp"
+
+namespace helpers {
+
+/**
+ * ImagePack - the image cache's images appended to one file instead of a file each
+ *
+ * Images go to the end of `<dir>/images.<generation>.pack`, and the `image_pack` table
+ * records where each one is. Reads come from a read-only mapping of the file, so decoding
+ * needs no open, read or close. Replacing or expiring an image only drops its row: the
+ * bytes become dead space, and compact() copies the live images into the next generation
+ * once dead space is most of the file. The generation switches in the same transaction as
+ * the offsets, so a crash at any point leaves a pack that matches its index.
+ *
+ * Thread-safe. Not available on Windows, where open() returns null.
+ */
+class ImagePack : public std::enable_shared_from_this<ImagePack> {
+public:
+    // A read-only view of the pack; the bytes stay valid while the mapping is held
+    struct Mapping {
+        void const* base {nullptr};
+        size_t size {0};
+
+        Mapping() = default;
+        Mapping(Mapping const&) = delete;
+        Mapping& operator=(Mapping const&) = delete;
+        ~Mapping() {
+#ifndef _WIN32
+            if (base) {
+                munmap(const_cast<void*>(base), size);
+            }
+#endif
+        }
+    };
+
+    struct Blob {
+        std::shared_ptr<Mapping const> mapping;
+        void const* data {nullptr};
+        size_t size {0};
+        int width {0};
+        int height {0};
+    };
+
+    // The pack in `dir`, shared by every cache using it: there is one writer per file
+    static std::shared_ptr<ImagePack> open(const std::string& db_path, const std::string& dir) {
+#ifdef _WIN32
+        return nullptr;
+#else
+        static std::mutex open_mutex;
+        static std::map<std::string, std::weak_ptr<ImagePack>> open_packs;
+        std::lock_guard<std::mutex> lock(open_mutex);
+        if (auto pack = open_packs[dir].lock(); pack) {
+            return pack;
+        }
+        try {
+            auto pack = std::shared_ptr<ImagePack>(new ImagePack(db_path, dir));
+            if (pack->fd_ < 0) {
+                return nullptr;
+            }
+            open_packs[dir] = pack;
+            return pack;
+        } catch (const std::exception& e) {
+            TEXTURE_ERROR_FMT("Cannot open image pack in {}: {}", dir, e.what());
+            return nullptr;
+        }
+#endif
+    }
+
+    ~ImagePack() {
+#ifndef _WIN32
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+#endif
+    }
+
+    ImagePack(ImagePack const&) = delete;
+    ImagePack& operator=(ImagePack const&) = delete;
+
+    // Where the image stored under `key` is, mapped; nullopt if it is not in the pack
+    std::optional<Blob> find(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::optional<Blob> result;
+        int64_t offset = -1;
+        int64_t length = 0;
+        int width = 0, height = 0;
+        db_.exec("SELECT pack_offset, pack_length, width, height FROM image_pack WHERE url = ?", [&](sqlite3_stmt* stmt) {
+            offset = sqlite3_column_int64(stmt, 0);
+            length = sqlite3_column_int64(stmt, 1);
+            width = sqlite3_column_int(stmt, 2);
+            height = sqlite3_column_int(stmt, 3);
+        }, key);
+        if (offset < 0 || length <= 0 || static_cast<uint64_t>(offset + length) > end_) {
+            return result;
+        }
+        if (!mapping_ || static_cast<uint64_t>(offset + length) > mapping_->size) {
+            remap();
+            if (!mapping_ || static_cast<uint64_t>(offset + length) > mapping_->size) {
+                return result;
+            }
+        }
+        result = Blob{mapping_, static_cast<char const*>(mapping_->base) + offset, static_cast<size_t>(length), width, height};
+        return result;
+    }
+
+    // Appends the image and points `key` at it; what `key` pointed at before becomes dead space
+    bool append(const std::string& key, http::buffer const& image, int width, int height) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto const offset = end_;
+        bool written = true;
+        image.for_each_chunk([&](std::string_view chunk) {
+            written = written && write_locked(chunk);
+        });
+        return written && record_locked(key, offset, width, height);
+    }
+
+    bool append(const std::string& key, std::string_view image, int width, int height) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto const offset = end_;
+        return write_locked(image) && record_locked(key, offset, width, height);
+    }
+
+    void remove(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        db_.exec("DELETE FROM image_pack WHERE url = ?", {}, key);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        db_.exec("DELETE FROM image_pack");
+    }
+
+    // Records that the images were used, in one transaction
+    void touch(std::unordered_set<std::string> const& keys) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        try {
+            db_.exec("BEGIN");
+            auto update = db_.prepare("UPDATE image_pack SET last_accessed = datetime('now') WHERE url = ?");
+            for (auto const& key : keys) {
+                update.run({}, key);
+            }
+            db_.exec("COMMIT");
+        } catch (const std::exception& e) {
+            TEXTURE_ERROR_FMT("Failed to record packed image accesses: {}", e.what());
+            rollback();
+        }
+    }
+
+    // Forgets images unused for `days`, then compacts on the scheduler if that is worth it; once per pack
+    void scheduleMaintenance(int days) {
+        if (maintenance_scheduled_.exchange(true)) {
+            return;
+        }
+        rouen::helpers::scheduler()->submit([self = shared_from_this(), days](std::stop_token) {
+            if (days > 0) {
+                std::lock_guard<std::mutex> lock(self->mutex_);
+                self->db_.exec(std::format("DELETE FROM image_pack WHERE last_accessed < datetime('now', '-{} days')", days));
+            }
+            self->compactIfWorthIt();
+        }, rouen::helpers::task_priority::background);
+    }
+
+    // Compacts when dead space is over half of a pack of at least min_compact_bytes
+    void compactIfWorthIt() {
+        uint64_t live = 0;
+        uint64_t total = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            db_.exec("SELECT COALESCE(SUM(pack_length), 0) FROM image_pack", [&live](sqlite3_stmt* stmt) {
+                live = static_cast<uint64_t>(sqlite3_column_int64(stmt, 0));
+            });
+            total = end_;
+        }
+        if (total >= min_compact_bytes && live < total / 2) {
+            compact();
+        }
+    }
+
+    /**
+     * Copies the live images, in file order, into the next generation and switches to it.
+     * Holds the pack for the duration; meant for the scheduler's background lane.
+     */
+    void compact() {
+#ifndef _WIN32
+        std::lock_guard<std::mutex> lock(mutex_);
+        remap();
+        struct entry {
+            std::string key;
+            int64_t from;
+            int64_t length;
+            int64_t to;
+        };
+        std::vector<entry> entries;
+        db_.exec("SELECT url, pack_offset, pack_length FROM image_pack ORDER BY pack_offset", [&entries](sqlite3_stmt* stmt) {
+            auto key = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            entries.push_back({key ? key : "", sqlite3_column_int64(stmt, 1), sqlite3_column_int64(stmt, 2), 0});
+        });
+
+        auto const next = generation_ + 1;
+        auto const next_path = packPath(next);
+        int const out = ::open(next_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (out < 0) {
+            TEXTURE_ERROR_FMT("Cannot create {}", next_path);
+            return;
+        }
+        uint64_t written = 0;
+        bool ok = true;
+        for (auto& e : entries) {
+            if (!mapping_ || static_cast<uint64_t>(e.from + e.length) > mapping_->size) {
+                e.to = -1;  // points past what was written: dropped
+                continue;
+            }
+            std::string_view bytes {static_cast<char const*>(mapping_->base) + e.from, static_cast<size_t>(e.length)};
+            if (!writeAll(out, bytes, written)) {
+                ok = false;
+                break;
+            }
+            e.to = static_cast<int64_t>(written);
+            written += bytes.size();
+        }
+        ok = ok && ::fsync(out) == 0;
+        ::close(out);
+
+        std::error_code ec;
+        if (ok) {
+            try {
+                db_.exec("BEGIN IMMEDIATE");
+                auto move = db_.prepare("UPDATE image_pack SET pack_offset = ? WHERE url = ?");
+                auto drop = db_.prepare("DELETE FROM image_pack WHERE url = ?");
+                for (auto const& e : entries) {
+                    if (e.to >= 0) {
+                        move.run({}, e.to, e.key);
+                    } else {
+                        drop.run({}, e.key);
+                    }
+                }
+                db_.exec("UPDATE image_pack_file SET generation = ?", {}, next);
+                db_.exec("COMMIT");
+            } catch (const std::exception& e) {
+                TEXTURE_ERROR_FMT("Failed to switch image pack: {}", e.what());
+                rollback();
+                ok = false;
+            }
+        }
+        if (!ok) {
+            std::filesystem::remove(next_path, ec);
+            return;
+        }
+
+        auto const previous = packPath(generation_);
+        ::close(fd_);
+        fd_ = -1;
+        mapping_.reset();   // blobs still out keep the old file's mapping alive
+        generation_ = next;
+        openFile();
+        std::filesystem::remove(previous, ec);
+        TEXTURE_INFO_FMT("Image pack compacted: {} images, {} bytes", entries.size(), written);
+#endif
+    }
+
+    // Bytes in the pack, live or dead
+    [[nodiscard]] uint64_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return end_;
+    }
+
+private:
+    static constexpr uint64_t min_compact_bytes = 16ull << 20;
+
+    ImagePack(const std::string& db_path, const std::string& dir) : db_{db_path}, dir_{dir} {
+        std::filesystem::create_directories(dir_);
+        db_.ensure_table("image_pack",
+            "url TEXT PRIMARY KEY, "
+            "pack_offset INTEGER, "
+            "pack_length INTEGER, "
+            "width INTEGER, "
+            "height INTEGER, "
+            "last_accessed TEXT DEFAULT (datetime('now'))"
+        );
+        db_.ensure_table("image_pack_file", "generation INTEGER");
+        std::optional<int64_t> generation;
+        db_.exec("SELECT generation FROM image_pack_file", [&generation](sqlite3_stmt* stmt) {
+            generation = sqlite3_column_int64(stmt, 0);
+        });
+        if (!generation) {
+            db_.exec("INSERT INTO image_pack_file (generation) VALUES (0)");
+            generation = 0;
+        }
+        generation_ = *generation;
+        removeStaleGenerations();
+        openFile();
+    }
+
+    std::string packPath(int64_t generation) const {
+        return (std::filesystem::path(dir_) / std::format("images.{}.pack", generation)).string();
+    }
+
+    // A compaction that did not get to switch leaves its file behind
+    void removeStaleGenerations() {
+        std::error_code ec;
+        auto const current = std::filesystem::path(packPath(generation_)).filename().string();
+        for (auto const& item : std::filesystem::directory_iterator(dir_, ec)) {
+            auto const name = item.path().filename().string();
+            if (name.starts_with("images.") && name.ends_with(".pack") && name != current) {
+                std::filesystem::remove(item.path(), ec);
+            }
+        }
+    }
+
+    void openFile() {
+#ifndef _WIN32
+        auto const path = packPath(generation_);
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            TEXTURE_ERROR_FMT("Cannot open image pack {}", path);
+            end_ = 0;
+            return;
+        }
+        auto const end = ::lseek(fd_, 0, SEEK_END);
+        end_ = end > 0 ? static_cast<uint64_t>(end) : 0;
+#endif
+    }
+
+    // Caller holds mutex_; maps the whole file as it is now
+    void remap() {
+#ifndef _WIN32
+        if (fd_ < 0 || end_ == 0) {
+            return;
+        }
+        void* base = ::mmap(nullptr, end_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (base == MAP_FAILED) {
+            TEXTURE_ERROR_FMT("Cannot map image pack ({} bytes)", end_);
+            return;
+        }
+        auto mapping = std::make_shared<Mapping>();
+        mapping->base = base;
+        mapping->size = end_;
+        mapping_ = std::move(mapping);
+#endif
+    }
+
+    static bool writeAll(int fd, std::string_view bytes, uint64_t offset) {
+#ifndef _WIN32
+        while (!bytes.empty()) {
+            auto const n = ::pwrite(fd, bytes.data(), bytes.size(), static_cast<off_t>(offset));
+            if (n <= 0) {
+                return false;
+            }
+            bytes.remove_prefix(static_cast<size_t>(n));
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Caller holds mutex_
+    bool write_locked(std::string_view bytes) {
+        if (fd_ < 0 || !writeAll(fd_, bytes, end_)) {
+            return false;
+        }
+        end_ += bytes.size();
+        return true;
+    }
+
+    // Caller holds mutex_; `offset` is where the image written since starts
+    bool record_locked(const std::string& key, uint64_t offset, int width, int height) {
+        auto const length = static_cast<int64_t>(end_ - offset);
+        if (length <= 0) {
+            return false;
+        }
+        try {
+            db_.exec("INSERT OR REPLACE INTO image_pack (url, pack_offset, pack_length, width, height, last_accessed) "
+                     "VALUES (?, ?, ?, ?, ?, datetime('now'))",
+                     {}, key, static_cast<int64_t>(offset), length, width, height);
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    void rollback() {
+        try {
+            db_.exec("ROLLBACK");
+        } catch (...) {
+            // Ignore rollback errors
+        }
+    }
+
+    hosting::db::sqlite db_;
+    std::string dir_;
+    mutable std::mutex mutex_;
+    int fd_ {-1};
+    int64_t generation_ {0};
+    uint64_t end_ {0};                              // bytes in the file
+    std::shared_ptr<Mapping const> mapping_;        // of the first mapping_->size bytes
+    std::atomic<bool> maintenance_scheduled_ {false};
+};
+
+} // namespace helpers
@@ -0,0 +1,244 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "../registrar.hpp"
+#include "sqlite_keyvalue.hpp"
+
+namespace rouen::helpers {
+
+    // Something the launcher can open: `uri` goes to create_card
+    struct launch_target {
+        std::string label;
+        std::string uri;
+    };
+
+    /**
+     * Everything the menu launcher can open, registered as "launcher_index". Sources (the
+     * built-in cards, repositories, stations, feeds, Jira projects...) publish their targets
+     * under their own name whenever their list changes; every URI opened is counted, with when,
+     * so targets rank by frecency and the ones no source lists still show as recent.
+     * The index is an immutable snapshot, lowercased once when a source publishes; rank()
+     * runs over it only when the query changes.
+     */
+    class launcher_index {
+    public:
+        struct entry {
+            launch_target target;
+            std::string source;
+            std::string key;        // label, lowercased
+            std::string uri_key;    // uri, lowercased
+            float frecency;
+        };
+
+        struct match {
+            uint32_t entry;
+            int score;
+        };
+
+        using snapshot = std::vector<entry>;
+
+        explicit launcher_index(std::string const& db_path = "launcher.db") : launches_db_{db_path} {
+            launches_db_.scan_level(launch_prefix, [this](char const* key) {
+                if (auto value = launches_db_.get(key)) {
+                    launches_.emplace(std::string{key + launch_prefix.size()}, parse_launch(*value));
+                }
+            });
+            rebuild();
+        }
+
+        // The registered index, or nullptr where none is (e.g. the bench)
+        static std::shared_ptr<launcher_index> shared() {
+            auto& handle = registrar::cached<launcher_index, "launcher_index">();
+            return handle ? handle.get() : nullptr;
+        }
+
+        // Replaces whatever `source` published before
+        void publish(std::string const& source, std::vector<launch_target> targets) {
+            std::lock_guard lock(mutex_);
+            sources_[source] = std::move(targets);
+            rebuild();
+        }
+
+        // Counts a launch of `uri` now
+        void launched(std::string const& uri) {
+            std::lock_guard lock(mutex_);
+            auto& launch = launches_[uri];
+            ++launch.count;
+            launch.last = now();
+            launches_db_.set(std::string{launch_prefix} + uri, std::format("{} {}", launch.count, launch.last));
+            rebuild();
+        }
+
+        [[nodiscard]] std::shared_ptr<snapshot const> entries() const {
+            std::lock_guard lock(mutex_);
+            return entries_;
+        }
+
+        /**
+         * The entries matching `query` best first, at most `limit` of them. Each query
+         * character must appear in order in the label (or, scoring less, in the uri); the match
+         * quality decides, and frecency breaks near ties.
+         */
+        static std::vector<match> rank(snapshot const& entries, std::string_view query, size_t limit) {
+            std::string const needle = lowercase(query);
+            std::vector<match> matches;
+            for (uint32_t i = 0; i < entries.size(); ++i) {
+                auto const& e = entries[i];
+                auto score = fuzzy_score(e.key, needle);
+                if (auto const in_uri = fuzzy_score(e.uri_key, needle); in_uri >= 0) {
+                    score = std::max(score, in_uri / 2);
+                }
+                if (score >= 0) {
+                    matches.push_back({i, score + static_cast<int>(8.0f * std::log2(1.0f + e.frecency))});
+                }
+            }
+            auto const better = [&entries](match const& a, match const& b) {
+                if (a.score != b.score) {
+                    return a.score > b.score;
+                }
+                return entries[a.entry].key.size() < entries[b.entry].key.size();
+            };
+            if (matches.size() > limit) {
+                std::partial_sort(matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(limit), matches.end(), better);
+                matches.resize(limit);
+            } else {
+                std::sort(matches.begin(), matches.end(), better);
+            }
+            return matches;
+        }
+
+        /**
+         * How well lowercase `needle` matches lowercase `text` as a subsequence, or -1 when it
+         * doesn't. A contiguous run scores best, more so at the start or at a word start;
+         * otherwise characters landing on word starts or right after the previous one earn
+         * bonuses, and the gaps between them cost.
+         */
+        static int fuzzy_score(std::string_view text, std::string_view needle) {
+            if (needle.empty()) {
+                return 0;
+            }
+            if (auto const at = text.find(needle); at != std::string_view::npos) {
+                auto score = 100 + 16 * static_cast<int>(needle.size());
+                if (at == 0) {
+                    score += 60;
+                } else if (word_start(text, at)) {
+                    score += 30;
+                }
+                if (text.size() == needle.size()) {
+                    score += 40;
+                }
+                return score - static_cast<int>(std::min<size_t>(text.size() - needle.size(), 30));
+            }
+            int score = 0;
+            size_t from = 0;
+            size_t previous = std::string_view::npos;
+            for (auto const c : needle) {
+                auto const at = text.find(c, from);
+                if (at == std::string_view::npos) {
+                    return -1;
+                }
+                score += 16;
+                if (word_start(text, at)) {
+                    score += 10;
+                }
+                if (previous != std::string_view::npos && at == previous + 1) {
+                    score += 12;
+                } else if (previous != std::string_view::npos) {
+                    score -= static_cast<int>(std::min<size_t>(at - previous - 1, 8));
+                }
+                previous = at;
+                from = at + 1;
+            }
+            return score;
+        }
+
+        static std::string lowercase(std::string_view text) {
+            std::string lower{text};
+            std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return lower;
+        }
+
+    private:
+        static constexpr std::string_view launch_prefix {"launch:"};
+
+        struct launch {
+            uint32_t count {0};
+            int64_t last {0};      // seconds since the epoch
+        };
+
+        static int64_t now() {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        static launch parse_launch(std::string const& value) {
+            launch parsed;
+            if (auto const space = value.find(' '); space != std::string::npos) {
+                parsed.count = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+                parsed.last = std::strtoll(value.c_str() + space + 1, nullptr, 10);
+            }
+            return parsed;
+        }
+
+        // Launches weighted by how recent the last one was, in the buckets browsers use
+        static float frecency(launch const& l, int64_t at) {
+            auto const days = (at - l.last) / 86400;
+            float const weight = days < 4 ? 1.0f : days < 14 ? 0.7f : days < 31 ? 0.5f : days < 90 ? 0.3f : 0.1f;
+            return static_cast<float>(l.count) * weight;
+        }
+
+        static bool word_start(std::string_view text, size_t at) {
+            return at == 0 || !std::isalnum(static_cast<unsigned char>(text[at - 1]));
+        }
+
+        // Under mutex_; a target listed by several sources shows once, as the first lists it
+        void rebuild() {
+            auto const at = now();
+            auto fresh = std::make_shared<snapshot>();
+            std::unordered_set<std::string_view> seen;
+            for (auto const& [source, targets] : sources_) {
+                for (auto const& target : targets) {
+                    if (!seen.insert(target.uri).second) {
+                        continue;
+                    }
+                    auto const pos = launches_.find(target.uri);
+                    fresh->push_back({target, source, lowercase(target.label), lowercase(target.uri),
+                                      pos == launches_.end() ? 0.0f : frecency(pos->second, at)});
+                }
+            }
+            for (auto const& [uri, l] : launches_) {
+                if (!seen.contains(uri)) {
+                    auto const key = lowercase(uri);
+                    fresh->push_back({{uri, uri}, "recent", key, key, frecency(l, at)});
+                }
+            }
+            entries_ = std::move(fresh);
+        }
+
+        mutable std::mutex mutex_;
+        std::map<std::string, std::vector<launch_target>> sources_;
+        std::unordered_map<std::string, launch> launches_;
+        std::shared_ptr<snapshot const> entries_;
+        hosting::db::sqlite_keyval launches_db_;
+    };
+
+}
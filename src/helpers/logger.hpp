@@ -0,0 +1,456 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+// None in this file
+
+namespace rouen::helpers {
+
+/**
+ * Asynchronous logger behind LOG_COMPONENT.
+ *
+ * Callers format the message and push it into their own thread's ring (single producer,
+ * single consumer, no locks); a background thread drains all rings every few
+ * milliseconds, orders the records by time and writes them out in one batch.
+ *
+ * Levels are filtered at runtime per component, on top of the ROUEN_LOG_LEVEL
+ * compile-time ceiling. The initial setup can come from the environment:
+ *   ROUEN_LOG="*=info,RSS=trace,SQLITE=warn"   levels per component ("*" is the default)
+ *   ROUEN_LOG_FILE=/tmp/rouen.log              write there instead of stderr
+ *   ROUEN_LOG_FORMAT=json                      one JSON object per line
+ */
+class logger {
+public:
+    using clock = std::chrono::system_clock;
+
+    enum class output_format { text, json };
+
+    static constexpr int level_none = 0;
+    static constexpr int level_error = 1;
+    static constexpr int level_trace = 5;
+    static constexpr size_t max_components = 64;
+
+    // Never destroyed: threads and static destructors may log during shutdown.
+    // At exit the background thread is stopped and later records are written synchronously.
+    static logger& instance() {
+        static logger* const l = [] {
+            auto* created = new logger();
+            std::atexit([] { instance().shutdown(); });
+            return created;
+        }();
+        return *l;
+    }
+
+    static char const* level_name(int level) {
+        switch (level) {
+            case 0: return "NONE";
+            case 1: return "ERROR";
+            case 2: return "WARN";
+            case 3: return "INFO";
+            case 4: return "DEBUG";
+            default: return "TRACE";
+        }
+    }
+
+    static int parse_level(std::string_view name) {
+        for (int l = level_none; l <= level_trace; ++l) {
+            std::string_view const candidate {level_name(l)};
+            if (candidate.size() == name.size() &&
+                std::equal(candidate.begin(), candidate.end(), name.begin(),
+                    [](char a, char b) { return a == std::toupper(static_cast<unsigned char>(b)); })) {
+                return l;
+            }
+        }
+        return -1;
+    }
+
+    // Hot path: a scan of the component table, pointer comparison first
+    [[nodiscard]] bool enabled(char const* component, int level) {
+        auto& c = find_or_add(component);
+        auto const limit = c.level.load(std::memory_order_relaxed);
+        return level <= (limit >= 0 ? limit : default_level_.load(std::memory_order_relaxed));
+    }
+
+    void write(char const* component, int level, std::string message) {
+        record r {clock::now(), component, level, thread_tag(), std::move(message)};
+        if (stopped_.load(std::memory_order_acquire)) {
+            write_batch_sync(&r, 1);
+            return;
+        }
+        auto& buf = local_ring();
+        if (!buf.push(std::move(r))) {
+            if (level == level_error) {
+                // Errors are never dropped; take the slow path
+                write_batch_sync(&r, 1);
+            } else {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        // Errors go out promptly; a half-full ring means a burst the timer won't keep up with
+        if (level == level_error || buf.size() >= ring::capacity / 2) {
+            wake_.notify_one();
+        }
+    }
+
+    // "*" sets the default for components without their own level; -1 clears an override
+    void set_level(std::string_view component, int level) {
+        if (component == "*") {
+            default_level_.store(std::clamp(level, level_none, level_trace), std::memory_order_relaxed);
+            return;
+        }
+        find_or_add_named(component).level.store(std::clamp(level, -1, level_trace), std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] int default_level() const {
+        return default_level_.load(std::memory_order_relaxed);
+    }
+
+    // Components seen so far with their own level (-1 = follows the default)
+    [[nodiscard]] std::vector<std::pair<std::string, int>> components() const {
+        std::vector<std::pair<std::string, int>> result;
+        auto const count = component_count_.load(std::memory_order_acquire);
+        result.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            result.emplace_back(components_[i].name, components_[i].level.load(std::memory_order_relaxed));
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    void set_format(output_format format) {
+        format_.store(format, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] output_format format() const {
+        return format_.load(std::memory_order_relaxed);
+    }
+
+    // Redirect output to a file (appending); an empty path goes back to stderr
+    bool set_output_file(std::string const& path) {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        FILE* next = stderr;
+        if (!path.empty()) {
+            next = std::fopen(path.c_str(), "a");
+            if (!next) {
+                return false;
+            }
+        }
+        if (output_ != stderr) {
+            std::fclose(output_);
+        }
+        output_ = next;
+        return true;
+    }
+
+    [[nodiscard]] size_t dropped() const {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    // Write out everything queued so far (any thread)
+    void flush() {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        drain();
+    }
+
+    void shutdown() {
+        if (stopped_.exchange(true)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (flusher_.joinable()) {
+            flusher_.join();
+        }
+        flush();
+    }
+
+private:
+    struct record {
+        clock::time_point when;
+        char const* component {nullptr};
+        int level {0};
+        uint32_t thread {0};
+        std::string message;
+    };
+
+    // Single-producer (owning thread) / single-consumer (drain) ring
+    struct ring {
+        static constexpr size_t capacity = 4096;
+
+        bool push(record&& r) {
+            auto const h = head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) >= capacity) {
+                return false;
+            }
+            slots[h % capacity] = std::move(r);
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        void drain_into(std::vector<record>& out) {
+            auto t = tail.load(std::memory_order_relaxed);
+            auto const h = head.load(std::memory_order_acquire);
+            for (; t < h; ++t) {
+                out.push_back(std::move(slots[t % capacity]));
+            }
+            tail.store(h, std::memory_order_release);
+        }
+
+        [[nodiscard]] size_t size() const {
+            return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] bool empty() const {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+
+        std::array<record, capacity> slots;
+        std::atomic<size_t> head {0};
+        std::atomic<size_t> tail {0};
+        std::atomic<bool> retired {false};   // owning thread has exited
+    };
+
+    struct component_entry {
+        std::atomic<char const*> literal {nullptr};
+        std::string name;                    // written once, before component_count_ is published
+        std::atomic<int> level {-1};
+    };
+
+    logger() {
+        apply_environment();
+        flusher_ = std::thread([this] { run_flusher(); });
+    }
+
+    void apply_environment() {
+        if (char const* spec = std::getenv("ROUEN_LOG")) {
+            std::string_view rest {spec};
+            while (!rest.empty()) {
+                auto const comma = rest.find(',');
+                auto item = rest.substr(0, comma);
+                rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+                auto const eq = item.find('=');
+                if (eq == std::string_view::npos) {
+                    continue;
+                }
+                auto const level = parse_level(item.substr(eq + 1));
+                if (level >= 0) {
+                    set_level(item.substr(0, eq), level);
+                }
+            }
+        }
+        if (char const* path = std::getenv("ROUEN_LOG_FILE")) {
+            set_output_file(path);
+        }
+        if (char const* fmt = std::getenv("ROUEN_LOG_FORMAT"); fmt && std::string_view{fmt} == "json") {
+            set_format(output_format::json);
+        }
+    }
+
+    component_entry& find_or_add(char const* component) {
+        auto const count = component_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            if (components_[i].literal.load(std::memory_order_relaxed) == component) {
+                return components_[i];
+            }
+        }
+        auto& entry = find_or_add_named(component);
+        entry.literal.store(component, std::memory_order_relaxed);
+        return entry;
+    }
+
+    component_entry& find_or_add_named(std::string_view component) {
+        auto const count = component_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            if (components_[i].name == component) {
+                return components_[i];
+            }
+        }
+        std::lock_guard<std::mutex> lock(components_mutex_);
+        auto const locked_count = component_count_.load(std::memory_order_relaxed);
+        for (size_t i = count; i < locked_count; ++i) {
+            if (components_[i].name == component) {
+                return components_[i];
+            }
+        }
+        if (locked_count == max_components) {
+            return components_[max_components - 1];  // shares the last slot rather than failing
+        }
+        components_[locked_count].name = std::string{component};
+        component_count_.store(locked_count + 1, std::memory_order_release);
+        return components_[locked_count];
+    }
+
+    static uint32_t thread_tag() {
+        thread_local uint32_t const tag =
+            static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        return tag;
+    }
+
+    ring& local_ring() {
+        struct owner {
+            explicit owner(logger& l) : r(std::make_shared<ring>()) {
+                std::lock_guard<std::mutex> lock(l.rings_mutex_);
+                l.rings_.push_back(r);
+            }
+            ~owner() { r->retired.store(true, std::memory_order_release); }
+            std::shared_ptr<ring> r;
+        };
+        thread_local owner local {*this};
+        return *local.r;
+    }
+
+    void run_flusher() {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        while (!stopping_) {
+            wake_.wait_for(lock, std::chrono::milliseconds(50));
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+    // Caller holds drain_mutex_
+    void drain() {
+        std::vector<std::shared_ptr<ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            rings = rings_;
+        }
+        batch_.clear();
+        for (auto const& r : rings) {
+            r->drain_into(batch_);
+        }
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            std::erase_if(rings_, [](auto const& r) { return r->retired.load(std::memory_order_acquire) && r->empty(); });
+        }
+        std::stable_sort(batch_.begin(), batch_.end(), [](auto const& a, auto const& b) { return a.when < b.when; });
+        if (auto const dropped = dropped_.exchange(0, std::memory_order_relaxed); dropped > 0) {
+            batch_.push_back({clock::now(), "LOG", 2, thread_tag(), std::to_string(dropped) + " messages dropped (ring full)"});
+        }
+        if (!batch_.empty()) {
+            write_batch_sync(batch_.data(), batch_.size());
+        }
+    }
+
+    void write_batch_sync(record const* records, size_t count) {
+        std::string out;
+        auto const json = format() == output_format::json;
+        for (size_t i = 0; i < count; ++i) {
+            json ? append_json(out, records[i]) : append_text(out, records[i]);
+        }
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        std::fwrite(out.data(), 1, out.size(), output_);
+        std::fflush(output_);
+    }
+
+    static void append_text(std::string& out, record const& r) {
+        out += '[';
+        out += r.component;
+        out += "][";
+        out += level_name(r.level);
+        out += "] ";
+        out += r.message;
+        out += '\n';
+    }
+
+    static void append_json(std::string& out, record const& r) {
+        auto const us = std::chrono::duration_cast<std::chrono::microseconds>(r.when.time_since_epoch()).count();
+        out += "{\"ts_us\":";
+        out += std::to_string(us);
+        out += ",\"thread\":";
+        out += std::to_string(r.thread);
+        out += ",\"component\":";
+        append_json_string(out, r.component);
+        out += ",\"level\":\"";
+        out += level_name(r.level);
+        out += "\",\"message\":";
+        append_json_string(out, r.message);
+        out += "}\n";
+    }
+
+    static void append_json_string(std::string& out, std::string_view s) {
+        out += '"';
+        for (char c : s) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char buf[8];
+                        std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                        out += buf;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    std::array<component_entry, max_components> components_;
+    std::atomic<size_t> component_count_ {0};
+    std::mutex components_mutex_;
+
+    std::vector<std::shared_ptr<ring>> rings_;   // guarded by rings_mutex_
+    std::mutex rings_mutex_;
+    std::mutex drain_mutex_;
+    std::vector<record> batch_;                  // guarded by drain_mutex_
+
+    std::mutex output_mutex_;
+    FILE* output_ {stderr};                      // guarded by output_mutex_
+    std::atomic<output_format> format_ {output_format::text};
+
+    std::atomic<int> default_level_ {level_trace};
+    std::atomic<size_t> dropped_ {0};
+    std::atomic<bool> stopped_ {false};
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ {false};                      // guarded by wake_mutex_
+    std::thread flusher_;
+};
+
+// Turn whatever was passed to a log macro into the record's text
+template <typename T>
+std::string log_message(T&& message) {
+    if constexpr (std::is_convertible_v<T, std::string_view>) {
+        return std::string{std::string_view{message}};
+    } else {
+        std::ostringstream stream;
+        stream << message;
+        return std::move(stream).str();
+    }
+}
+
+} // namespace rouen::helpers
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <chrono>
 #include <filesystem>
+#include <functional>
 #include <thread>
 #include <mutex>
 #include <atomic>
@@ -13,311 +14,64 @@
 
 #include "./imgui_include.hpp"
 #include "../registrar.hpp"
-#include "mpv_socket.hpp"
+#include "mpv_process.hpp"
+#include "redraw.hpp"
 #include "../../external/IconsMaterialDesign.h" // Add this line to include Material Design Icons
 
 struct media_player {
     struct item {
         std::string url;
-        int player_pid{0};
-        bool is_playing{false};
-        mpv_socket_helper mpv_socket;
+        std::atomic<bool> is_playing{false};
+        mpv_process* process{&mpv_process::playback()};
+        uint64_t session{0};
+        // Kept current by mpv's property-change events, written on the IPC reader thread
         std::atomic<double> position{0.0};
         std::atomic<double> duration{0.0};
-        std::thread position_thread;
-        std::atomic<bool> thread_running{false};
-        std::mutex data_mutex;  // Add mutex to protect data access
+        std::atomic<bool> paused{false};
+        std::mutex data_mutex;  // guards stream_title
+        std::string stream_title;
 
         item() = default;
+        explicit item(mpv_process& owner) : process{&owner} {}
         
         ~item() {
             stopMedia();
         }
 
-        bool checkMediaStatus() {
-            if (player_pid <= 0) return false;
-            
-            std::string command = "ps -p " + std::to_string(player_pid) + " > /dev/null 2>&1 && echo 1 || echo 0";
-            FILE* pipe = popen(command.c_str(), "r");
-            std::string result = "";
-            
-            if (pipe) {
-                char buffer[128];
-                while (!feof(pipe)) {
-                    if (fgets(buffer, 128, pipe) != nullptr)
-                        result += buffer;
-                }
-                pclose(pipe);
-            }
-            
-            // Trim whitespace
-            result.erase(0, result.find_first_not_of(" \n\r\t"));
-            result.erase(result.find_last_not_of(" \n\r\t") + 1);
-            
-            is_playing = (result == "1");
+        // mpv reports the end of playback itself (end-file, or its socket closing): nothing to poll
+        bool checkMediaStatus() const {
             return is_playing;
         }
         
         void stopMedia() {
-            // Stop the position tracking thread if it's running
-            if (thread_running) {
-                thread_running = false;
-                if (position_thread.joinable()) {
-                    position_thread.join();
-                }
-            }
-            
-            // Close socket via helper
-            mpv_socket.close_socket();
-            
-            if (player_pid > 0) {
-                // Kill the process using the stored PID
-                if (kill(player_pid, SIGTERM) == -1) {
-                    perror("Failed to terminate process");
-                }
-                player_pid = 0;
-                is_playing = false;
-            }
+            // After this no more events reach us
+            process->stop(session);
+            session = 0;
+            is_playing = false;
             
             // Reset playback info
             position = 0.0;
             duration = 0.0;
+            paused = false;
+            std::lock_guard<std::mutex> lock(data_mutex);
+            stream_title.clear();
         }
-        
-        // Start a thread to periodically update position information
-        void startPositionTracking() {
-            // Stop any existing thread
-            if (thread_running) {
-                thread_running = false;
-                if (position_thread.joinable()) {
-                    position_thread.join();
-                }
-            }
-            
-            thread_running = true;
-            position_thread = std::thread([this]() {
-                // Keep track of consecutive errors
-                int consecutive_errors = 0;
-                
-                // Store persistent duration value - we only need to get it once reliably
-                double persistent_duration = 0.0;
-                bool duration_initialized = false;
-                
-                while (thread_running) {
-                    bool is_running = false;
-                    
-                    // First check if the player is still running
-                    if (player_pid > 0) {
-                        is_running = checkMediaStatus();
-                        if (!is_running) {
-                            // Player has stopped
-                            mpv_socket.close_socket();
-                            is_playing = false;
-                            std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                            continue;
-                        }
-                    } else {
-                        // No valid PID, can't continue
-                        is_playing = false;
-                        mpv_socket.close_socket();
-                        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                        continue;
-                    }
-                    
-                    // Only proceed if socket is valid
-                    if (mpv_socket.is_connected()) {
-                        // First, if duration is not initialized yet, get it
-                        if (!duration_initialized || persistent_duration <= 0) {
-                            // Request duration only
-                            if (mpv_socket.send_command("{\"command\":[\"get_property\",\"duration\"],\"request_id\":2}\n")) {
-                                // Wait for response
-                                std::this_thread::sleep_for(std::chrono::milliseconds(200));
-                                
-                                // Get the duration response
-                                char buffer[4096];
-                                memset(buffer, 0, sizeof(buffer));
-                                
-                                if (mpv_socket.receive_response(buffer, sizeof(buffer))) {
-                                    std::string response(buffer);
-                                    
-                                    // Only look for duration response
-                                    if (response.find("\"request_id\":2") != std::string::npos) {
-                                        size_t pos = response.find("\"data\":");
-                                        if (pos != std::string::npos) {
-                                            std::string value = response.substr(pos + 7);
-                                            size_t end = value.find_first_of(",}");
-                                            if (end != std::string::npos) {
-                                                try {
-                                                    double dur_value = std::stod(value.substr(0, end));
-                                                    if (dur_value > 0) {
-                                                        persistent_duration = dur_value;
-                                                        duration_initialized = true;
-                                                        
-                                                        // Update shared duration once we have a good value
-                                                        std::lock_guard<std::mutex> lock(data_mutex);
-                                                        duration = persistent_duration;
-                                                    }
-                                                } catch (...) {
-                                                    // Error parsing, ignore
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            
-                            // If we couldn't get the duration, wait and try again
-                            if (!duration_initialized) {
-                                std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                                continue;
-                            }
-                        }
-                        
-                        // Now separately request playback position
-                        if (mpv_socket.send_command("{\"command\":[\"get_property\",\"playback-time\"],\"request_id\":1}\n")) {
-                            // Wait for response
-                            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                            
-                            // Process position response
-                            char buffer[4096];
-                            memset(buffer, 0, sizeof(buffer));
-                            
-                            double current_position = 0.0;
-                            bool position_updated = false;
-                            
-                            if (mpv_socket.receive_response(buffer, sizeof(buffer))) {
-                                std::string response(buffer);
-                                
-                                // Check for playback end events
-                                if (response.find("\"event\":\"end-file\"") != std::string::npos || 
-                                    response.find("\"event\":\"idle\"") != std::string::npos) {
-                                    // Playback has ended
-                                    is_playing = false;
-                                    mpv_socket.close_socket();
-                                    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                                    continue;
-                                }
-                                
-                                // Look for position response only
-                                if (response.find("\"request_id\":1") != std::string::npos) {
-                                    size_t pos = response.find("\"data\":");
-                                    if (pos != std::string::npos) {
-                                        std::string value = response.substr(pos + 7);
-                                        size_t end = value.find_first_of(",}");
-                                        if (end != std::string::npos) {
-                                            try {
-                                                current_position = std::stod(value.substr(0, end));
-                                                position_updated = true;
-                                            } catch (...) {
-                                                // Error parsing, ignore
-                                            }
-                                        }
-                                    }
-                                }
-                            } else {
-                                // Failed to receive response
-                                consecutive_errors++;
-                                if (consecutive_errors > 5) {
-                                    mpv_socket.close_socket();
-                                    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                                    continue;
-                                }
-                            }
-                            
-                            // Update position if we got a valid value
-                            if (position_updated) {
-                                std::lock_guard<std::mutex> lock(data_mutex);
-                                position = current_position;
-                                
-                                // Always reassert the persistent duration to make sure it doesn't get overwritten
-                                if (duration_initialized && persistent_duration > 0) {
-                                    duration = persistent_duration;
-                                }
-                                
-                                // Check if we've reached the end of playback
-                                if (current_position >= persistent_duration - 0.5 && persistent_duration > 0) {
-                                    is_playing = false;
-                                    mpv_socket.close_socket();
-                                    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                                    continue;
-                                }
-                            } else {
-                                consecutive_errors++;
-                                if (consecutive_errors > 5) {
-                                    mpv_socket.close_socket();
-                                    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                                    continue;
-                                }
-                            }
-                        } else {
-                            // Failed to send command
-                            consecutive_errors++;
-                            if (consecutive_errors > 5) {
-                                mpv_socket.close_socket();
-                            }
-                        }
-                    }
-                    
-                    // Reset error counter on success
-                    if (mpv_socket.is_connected()) {
-                        consecutive_errors = 0;
-                    }
-                    
-                    // Sleep between updates
-                    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-                }
-            });
+
+        std::string streamTitle() {
+            std::lock_guard<std::mutex> lock(data_mutex);
+            return stream_title;
         }
-        
-        bool playMedia() {
-            try {
-                // Stop any current playback
-                stopMedia();
-                
-                // Create a unique socket path using the helper
-                std::string socket_path = mpv_socket.create_socket_path();
-                
-                // Build the command to play the media
-                // Use mpv with JSON IPC socket for position reporting
-                std::string command = "nohup mpv --no-video --really-quiet --input-ipc-server=" + socket_path + " \"" + url + "\" > /dev/null 2>&1 & echo $!";
-                
-                // Execute the command and get the PID
-                std::string result = "";
-                FILE* pipe = popen(command.c_str(), "r");
-                if (pipe) {
-                    char buffer[128];
-                    while (!feof(pipe)) {
-                        if (fgets(buffer, 128, pipe) != nullptr)
-                            result += buffer;
-                    }
-                    pclose(pipe);
-                }
-                
-                // Trim whitespace
-                result.erase(0, result.find_first_not_of(" \n\r\t"));
-                result.erase(result.find_last_not_of(" \n\r\t") + 1);
-                
-                // Store the process ID for later termination
-                try {
-                    player_pid = std::stoi(result);
-                    is_playing = true;
-                    
-                    // Initialize the socket connection and start position tracking
-                    if (mpv_socket.init_socket(socket_path)) {
-                        startPositionTracking();
-                    }
-                    
-                    return true;
-                } catch (...) {
-                    player_pid = 0;
-                    is_playing = false;
-                    return false;
-                }
-            } catch (const std::exception& e) {
-                player_pid = 0;
+
+        // Loads `url` into the shared mpv, replacing whatever it was playing
+        bool playMedia(bool loop = false) {
+            stopMedia();
+            is_playing = true;
+            session = process->load(url, loop, [this](mpv_message const& message) { onEvent(message); });
+            if (session == 0) {
                 is_playing = false;
                 return false;
             }
+            return true;
         }
         
         // Format time in MM:SS format
@@ -329,16 +83,54 @@ struct media_player {
         
         // Seek to a specific position in the media
         bool seekTo(auto position_seconds) {
-            if (!is_playing || !mpv_socket.is_connected()) {
-                return false;
+            return is_playing && process->command(session, std::format("\"set_property\",\"playback-time\",{:.2f}", static_cast<double>(position_seconds)));
+        }
+
+        bool togglePause() {
+            return is_playing && process->command(session, "\"cycle\",\"pause\"");
+        }
+
+    private:
+        // On the IPC reader thread
+        void onEvent(mpv_message const& message) {
+            auto const event = message.raw("event");
+            // end-file for our own file: the one being replaced is filtered out by mpv_process
+            if (event == "\"end-file\"" || event == "\"shutdown\"") {
+                is_playing = false;
+                rouen::helpers::request_redraw();
+                return;
+            }
+            if (event != "\"property-change\"") {
+                return;
+            }
+            switch (static_cast<int>(message.number("id").value_or(0))) {
+                case mpv_process::observed_time_pos:
+                    // Null while nothing is loaded: keep the last value rather than flashing back to zero
+                    if (auto const value = message.number("data")) {
+                        position = *value;
+                    }
+                    break;
+                case mpv_process::observed_duration:
+                    if (auto const value = message.number("data")) {
+                        duration = *value;
+                    }
+                    break;
+                case mpv_process::observed_pause:
+                    paused = message.boolean("data");
+                    break;
+                case mpv_process::observed_metadata: {
+                    auto title = message.string("data", "icy-title");
+                    if (title.empty()) {
+                        title = message.string("data", "title");
+                    }
+                    std::lock_guard<std::mutex> lock(data_mutex);
+                    stream_title = std::move(title);
+                    rouen::helpers::request_redraw();
+                    break;
+                }
+                default:
+                    break;
             }
-            
-            // Format the seek command with the target position
-            std::string seek_cmd = std::format("{{\"command\":[\"set_property\",\"playback-time\",{:.2f}],\"request_id\":3}}\n", 
-                                              position_seconds);
-            
-            // Send the seek command to mpv
-            return mpv_socket.send_command(seek_cmd);
         }
     };
 
@@ -349,42 +141,55 @@ struct media_player {
         return items_;
     }
 
+    // Cards showing a player tick once a second while this holds, for its position
+    static bool anyPlaying() {
+        for (auto const &[k,v]: items()) {
+            if (v.is_playing) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     static void stopAll() {
         for (auto &[k,v]: items()) {
             v.stopMedia();
         }
     }
 
-    static void player(std::string_view url, auto info_color, std::string_view title = "Media") noexcept {
+    // `source`, when given, is asked what mpv should open as playback starts (e.g. a downloaded copy of `url`)
+    static void player(std::string_view url, auto info_color, std::string_view title = "Media",
+                       std::function<std::string(std::string_view)> const& source = {}) noexcept {
         ImGui::PushID(url.data());
         try {
             auto &item {items()[ImGui::GetID("MediaPlayer")]};
             item.url = url;
-            // Check if media is currently playing
-            if (item.player_pid > 0) {
-                item.checkMediaStatus(); // Update playback status
-            }
             
             if (item.is_playing) {
                 ImGui::TextUnformatted(title.data());
-                // Get safe copies of position and duration values with mutex protection
-                double current_pos, current_dur;
-                {
-                    std::lock_guard<std::mutex> lock(item.data_mutex);
-                    current_pos = item.position;
-                    current_dur = item.duration;
-                }
+                double const current_pos = item.position;
+                double const current_dur = item.duration;
                 
                 if (current_pos > 0 && current_dur > 0) {
                     // Format and display playback time
-                    ImGui::TextColored(info_color, "Playing: %s / %s", 
+                    ImGui::TextColored(info_color, "%s: %s / %s", item.paused ? "Paused" : "Playing",
                         item.formatTime(current_pos).c_str(),
                         item.formatTime(current_dur).c_str());
+                } else if (current_pos > 0) {
+                    // A live stream: no duration, only the time listened
+                    ImGui::TextColored(info_color, "%s: %s", item.paused ? "Paused" : "Live", item.formatTime(current_pos).c_str());
+                }
+                if (auto const stream_title = item.streamTitle(); !stream_title.empty()) {
+                    ImGui::TextWrapped("%s", stream_title.c_str());
                 }
                 // Stop button with Material Design icon instead of Unicode square
                 if (ImGui::Button(std::format(" {} ", ICON_MD_STOP).c_str())) {
                     item.stopMedia();
                 }
+                ImGui::SameLine();
+                if (ImGui::Button(std::format(" {} ", item.paused ? ICON_MD_PLAY_ARROW : ICON_MD_PAUSE).c_str())) {
+                    item.togglePause();
+                }
                 // Show playback position if available
                 ImGui::SameLine();
                 if (current_dur > 0) {
@@ -422,6 +227,9 @@ struct media_player {
                 // Play button with Material Design icon instead of Unicode triangle
                 if (ImGui::Button(std::format(" {} {}", ICON_MD_PLAY_ARROW, title).c_str(), ImVec2(-1, 0))) {
                     stopAll();
+                    if (source) {
+                        item.url = source(url);
+                    }
                     item.playMedia();
                 }
                 // Restore default style
@@ -439,38 +247,14 @@ struct media_player {
 namespace media_player_alarm_helper {
     // Shared alarm item for all alarm sound helpers
     static media_player::item& alarm_item_instance() {
-        static media_player::item alarm_item;
+        static media_player::item alarm_item {mpv_process::effects()};
         return alarm_item;
     }
     // Play a local sound file in a loop (for alarm repeat)
     static void play_sound_loop(std::string_view file_path) {
         auto& alarm_item = alarm_item_instance();
         alarm_item.url = file_path;
-        alarm_item.stopMedia(); // Stop any previous sound
-        // Set loop property for mpv
-        std::string command = "nohup mpv --no-video --loop=inf --really-quiet --input-ipc-server=" + alarm_item.mpv_socket.create_socket_path() + " \"" + std::string(file_path) + "\" > /dev/null 2>&1 & echo $!";
-        FILE* pipe = popen(command.c_str(), "r");
-        std::string result = "";
-        if (pipe) {
-            char buffer[128];
-            while (!feof(pipe)) {
-                if (fgets(buffer, 128, pipe) != nullptr)
-                    result += buffer;
-            }
-            pclose(pipe);
-        }
-        result.erase(0, result.find_first_not_of(" \n\r\t"));
-        result.erase(result.find_last_not_of(" \n\r\t") + 1);
-        try {
-            alarm_item.player_pid = std::stoi(result);
-            alarm_item.is_playing = true;
-            if (alarm_item.mpv_socket.init_socket(alarm_item.mpv_socket.get_socket_path())) {
-                alarm_item.startPositionTracking();
-            }
-        } catch (...) {
-            alarm_item.player_pid = 0;
-            alarm_item.is_playing = false;
-        }
+        alarm_item.playMedia(true);
     }
     static void stop_sound_loop() {
         auto& alarm_item = alarm_item_instance();
@@ -0,0 +1,82 @@
+// The global operator new and delete behind helpers/memory_accounting.hpp. With
+// ROUEN_MEMORY_TAGS set each block carries a header saying its size and the tag it was
+// charged to; otherwise they are plain malloc and free. The aligned forms are left to the
+// standard library and go uncounted.
+
+// 1. Standard includes in alphabetic order
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "memory_accounting.hpp"
+
+namespace {
+
+    namespace memory = rouen::helpers::memory;
+
+    // Keeps the block as aligned as malloc made it
+    struct alignas(alignof(std::max_align_t)) header {
+        size_t size;
+        memory::tag_t tag;
+    };
+
+    void* allocate(size_t size) noexcept {
+        if (size == 0) {
+            size = 1;
+        }
+        if (!memory::enabled()) {
+            return std::malloc(size);
+        }
+        auto* block = static_cast<header*>(std::malloc(sizeof(header) + size));
+        if (!block) {
+            return nullptr;
+        }
+        block->size = size;
+        block->tag = memory::current();
+        memory::charge(block->tag, size);
+        return block + 1;
+    }
+
+    void release(void* p) noexcept {
+        if (!p) {
+            return;
+        }
+        if (!memory::enabled()) {
+            std::free(p);
+            return;
+        }
+        auto* block = static_cast<header*>(p) - 1;
+        memory::credit(block->tag, block->size);
+        std::free(block);
+    }
+
+    void* allocate_or_throw(size_t size) {
+        while (true) {
+            if (auto* p = allocate(size)) {
+                return p;
+            }
+            if (auto handler = std::get_new_handler()) {
+                handler();
+            } else {
+                throw std::bad_alloc{};
+            }
+        }
+    }
+
+}
+
+void* operator new(size_t size) { return allocate_or_throw(size); }
+void* operator new[](size_t size) { return allocate_or_throw(size); }
+void* operator new(size_t size, std::nothrow_t const&) noexcept { return allocate(size); }
+void* operator new[](size_t size, std::nothrow_t const&) noexcept { return allocate(size); }
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { release(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept { release(p); }
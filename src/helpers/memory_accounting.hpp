@@ -0,0 +1,232 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+// None in this file
+
+namespace rouen::helpers::memory {
+
+    /**
+     * Opt-in heap accounting, shown by the `memory` card. With ROUEN_MEMORY_TAGS=1 the global
+     * operator new (memory_accounting.cpp) charges every allocation to the tag the allocating
+     * thread has set, and its delete credits the same tag back, so each tag has live bytes, a
+     * peak and an allocation count. The deck tags each card's render with the card's kind,
+     * scheduler tasks carry the tag of whoever submitted them, and hosts tag their threads.
+     * Untagged allocations count under "untagged". Without the variable new is plain malloc.
+     *
+     * Caches add what they know they hold through reports (see report below), which are read
+     * on the UI thread whether or not tagging is on.
+     */
+
+    constexpr size_t max_tags = 256;
+    using tag_t = uint16_t;
+
+    struct counters {
+        std::atomic<int64_t> live {0};
+        std::atomic<int64_t> peak {0};
+        std::atomic<uint64_t> allocations {0};
+    };
+
+    // Decided once, before the first allocation, and never changed: a block must be freed
+    // the way it was allocated
+    inline bool enabled() {
+        static bool const on = [] {
+            auto const spec = std::getenv("ROUEN_MEMORY_TAGS");
+            return spec && *spec && *spec != '0';
+        }();
+        return on;
+    }
+
+    // Constant-initialized, so operator new can use them before anything else is constructed
+    inline counters tag_counters[max_tags] {};
+    inline thread_local tag_t current_tag {0};
+
+    inline tag_t current() {
+        return current_tag;
+    }
+
+    // Called by operator new / delete; nothing here allocates
+    inline void charge(tag_t tag, size_t bytes) {
+        auto& c = tag_counters[tag];
+        auto const live = c.live.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+        c.allocations.fetch_add(1, std::memory_order_relaxed);
+        for (auto peak = c.peak.load(std::memory_order_relaxed);
+             live > peak && !c.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed);) {
+        }
+    }
+
+    inline void credit(tag_t tag, size_t bytes) {
+        tag_counters[tag].live.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    namespace detail {
+        struct tag_names {
+            std::shared_mutex mutex;
+            std::unordered_map<std::string, tag_t> ids;
+            std::vector<std::string> names {"untagged"};
+        };
+
+        inline tag_names& names() {
+            static tag_names instance;
+            return instance;
+        }
+    }
+
+    // The tag for `name`, made on first use; past max_tags the last one is shared by the rest
+    inline tag_t tag_id(std::string_view name) {
+        auto& n = detail::names();
+        {
+            std::shared_lock lock(n.mutex);
+            if (auto pos = n.ids.find(std::string{name}); pos != n.ids.end()) {
+                return pos->second;
+            }
+        }
+        std::unique_lock lock(n.mutex);
+        if (auto pos = n.ids.find(std::string{name}); pos != n.ids.end()) {
+            return pos->second;
+        }
+        tag_t id = max_tags - 1;
+        if (n.names.size() < max_tags - 1) {
+            id = static_cast<tag_t>(n.names.size());
+            n.names.emplace_back(name);
+        } else if (n.names.size() == max_tags - 1) {
+            n.names.emplace_back("other tags");
+        }
+        n.ids.emplace(std::string{name}, id);
+        return id;
+    }
+
+    // Charges this thread's allocations to `tag` until it goes out of scope
+    class scope {
+    public:
+        explicit scope(tag_t tag) : previous_(current_tag) {
+            current_tag = tag;
+        }
+
+        explicit scope(std::string_view name) : scope(enabled() ? tag_id(name) : tag_t{0}) {}
+
+        ~scope() {
+            current_tag = previous_;
+        }
+
+        scope(scope const&) = delete;
+        scope& operator=(scope const&) = delete;
+
+    private:
+        tag_t previous_;
+    };
+
+    struct usage {
+        std::string name;
+        int64_t live;
+        int64_t peak;
+        uint64_t allocations;
+    };
+
+    // Every tag that has allocated, most live bytes first
+    inline std::vector<usage> tag_usage() {
+        std::vector<usage> result;
+        auto& n = detail::names();
+        std::shared_lock lock(n.mutex);
+        for (size_t i = 0; i < n.names.size(); ++i) {
+            auto const& c = tag_counters[i];
+            if (auto const allocations = c.allocations.load(std::memory_order_relaxed); allocations > 0) {
+                result.push_back({n.names[i], c.live.load(std::memory_order_relaxed), c.peak.load(std::memory_order_relaxed), allocations});
+            }
+        }
+        std::sort(result.begin(), result.end(), [](auto const& a, auto const& b) { return a.live > b.live; });
+        return result;
+    }
+
+    /**
+     * Sizes a cache reports for itself. The function is called on the UI thread, with an
+     * emit(name, bytes) to call for each thing it holds; entries with the same name add up.
+     * Reporting stops when the report is destroyed, so a cache keeps it as a member.
+     */
+    class report {
+    public:
+        using emit_fn = std::function<void(std::string_view, size_t)>;
+        using report_fn = std::function<void(emit_fn const&)>;
+
+        report() = default;
+
+        explicit report(report_fn fn) {
+            auto& r = registry();
+            std::lock_guard lock(r.mutex);
+            id_ = ++r.last_id;
+            r.reports.emplace(id_, std::move(fn));
+        }
+
+        // One number under one name
+        report(std::string name, std::function<size_t()> bytes)
+            : report([name = std::move(name), bytes = std::move(bytes)](emit_fn const& emit) { emit(name, bytes()); }) {}
+
+        ~report() {
+            if (id_) {
+                auto& r = registry();
+                std::lock_guard lock(r.mutex);
+                r.reports.erase(id_);
+            }
+        }
+
+        report(report const&) = delete;
+        report& operator=(report const&) = delete;
+
+        // Every report's entries, totalled by name, with the highest total seen so far as the peak
+        static std::vector<usage> collect() {
+            auto& r = registry();
+            std::lock_guard lock(r.mutex);
+            std::map<std::string, int64_t, std::less<>> totals;
+            emit_fn const emit = [&totals](std::string_view name, size_t bytes) {
+                auto pos = totals.find(name);
+                if (pos == totals.end()) {
+                    pos = totals.emplace(std::string{name}, 0).first;
+                }
+                pos->second += static_cast<int64_t>(bytes);
+            };
+            for (auto const& [id, fn] : r.reports) {
+                fn(emit);
+            }
+            std::vector<usage> result;
+            for (auto const& [name, live] : totals) {
+                auto& peak = r.peaks[name];
+                peak = std::max(peak, live);
+                result.push_back({name, live, peak, 0});
+            }
+            std::sort(result.begin(), result.end(), [](auto const& a, auto const& b) { return a.live > b.live; });
+            return result;
+        }
+
+    private:
+        struct registry_state {
+            std::mutex mutex;
+            uint64_t last_id {0};
+            std::map<uint64_t, report_fn> reports;
+            std::map<std::string, int64_t, std::less<>> peaks;
+        };
+
+        static registry_state& registry() {
+            static registry_state instance;
+            return instance;
+        }
+
+        uint64_t id_ {0};
+    };
+
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "mpv_socket.hpp"
+
+extern char **environ;
+
+/**
+ * A long-lived idle mpv (--idle=yes) driven over one mpv_ipc connection. Playing something is
+ * a "loadfile <url> replace" on the running process, so switching stations or episodes costs
+ * no process start, audio device setup or socket handshake. Spawned ahead of use with start()
+ * and respawned on the next load() if it dies.
+ *
+ * One thing plays at a time: load() opens a session and the previous one ends, its handler
+ * told with an end-file event. Events reach the current session's handler only, and only
+ * from its own start-file on, so the end-file and last positions of the file being replaced
+ * never reach the new one. When mpv goes away the current session gets a "shutdown" event,
+ * as if mpv had sent it.
+ */
+class mpv_process {
+public:
+    using event_handler = std::function<void(mpv_message const&)>;
+
+    // observe_property ids, set up once per connection
+    enum : int { observed_time_pos = 1, observed_duration, observed_pause, observed_metadata };
+
+    // Radio and podcasts
+    static mpv_process& playback() {
+        static mpv_process process;
+        return process;
+    }
+
+    // Alarm and timer sounds, so they can ring over whatever is playing
+    static mpv_process& effects() {
+        static mpv_process process;
+        return process;
+    }
+
+    mpv_process() = default;
+
+    ~mpv_process() {
+        std::lock_guard lock(process_mutex_);
+        if (ipc_.is_connected()) {
+            ipc_.command("\"quit\"");
+        }
+        ipc_.close();
+        reap(true);
+    }
+
+    mpv_process(const mpv_process&) = delete;
+    mpv_process& operator=(const mpv_process&) = delete;
+
+    // Spawns and connects mpv unless it is already running
+    bool start() {
+        std::lock_guard lock(process_mutex_);
+        return ensure_running();
+    }
+
+    // Replaces whatever plays with `url`; 0 when mpv cannot be started
+    uint64_t load(std::string_view url, bool loop, event_handler on_event) {
+        std::lock_guard lock(process_mutex_);
+        if (!ensure_running()) {
+            return 0;
+        }
+        uint64_t session = 0;
+        {
+            std::lock_guard handlers(handler_mutex_);
+            if (handler_) {
+                // The session being replaced ends here; its own end-file is filtered out below
+                handler_(mpv_message{R"({"event":"end-file","reason":"stop"})"});
+            }
+            session = ++session_;
+            handler_ = std::move(on_event);
+            started_ = false;
+        }
+        ipc_.command(std::format("\"set_property\",\"loop-file\",\"{}\"", loop ? "inf" : "no"));
+        ipc_.command("\"set_property\",\"pause\",false");
+        if (!ipc_.command(std::format("\"loadfile\",{},\"replace\"", quote(url)))) {
+            release(session);
+            return 0;
+        }
+        return session;
+    }
+
+    // Stops playback if `session` is still the current one
+    void stop(uint64_t session) {
+        if (!release(session)) {
+            return;
+        }
+        std::lock_guard lock(process_mutex_);
+        ipc_.command("\"stop\"");
+    }
+
+    // Sends a command on behalf of `session`, unless something else has been loaded since
+    bool command(uint64_t session, std::string_view args) {
+        {
+            std::lock_guard handlers(handler_mutex_);
+            if (session == 0 || session != session_ || !handler_) {
+                return false;
+            }
+        }
+        std::lock_guard lock(process_mutex_);
+        return ipc_.command(args);
+    }
+
+private:
+    bool release(uint64_t session) {
+        std::lock_guard handlers(handler_mutex_);
+        if (session == 0 || session != session_ || !handler_) {
+            return false;
+        }
+        handler_ = nullptr;
+        return true;
+    }
+
+    // With process_mutex_ held
+    bool ensure_running() {
+        if (ipc_.is_connected()) {
+            return true;
+        }
+        // Gone (or never started): clear up after the old one and start afresh
+        ipc_.close();
+        reap(true);
+
+        auto const socket_path = mpv_ipc::unique_socket_path();
+        auto const ipc_option = "--input-ipc-server=" + socket_path;
+        // posix_spawn, like ProcessHelper: no copy of our address space, and none of our
+        // descriptors (sockets, databases) leak into a process that outlives most of them
+        posix_spawn_file_actions_t actions;
+        posix_spawnattr_t attributes;
+        ::posix_spawn_file_actions_init(&actions);
+        ::posix_spawnattr_init(&attributes);
+        for (int const fd : {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO}) {
+            ::posix_spawn_file_actions_addopen(&actions, fd, "/dev/null", O_RDWR, 0);
+        }
+#if defined(POSIX_SPAWN_CLOEXEC_DEFAULT)
+        ::posix_spawnattr_setflags(&attributes, POSIX_SPAWN_CLOEXEC_DEFAULT);
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 34))
+        ::posix_spawn_file_actions_addclosefrom_np(&actions, STDERR_FILENO + 1);
+#endif
+        char const* const argv[] {"mpv", "--idle=yes", "--no-video", "--no-terminal", "--really-quiet", ipc_option.c_str(), nullptr};
+        pid_t pid = 0;
+        int const error = ::posix_spawnp(&pid, "mpv", &actions, &attributes, const_cast<char* const*>(argv), environ);
+        ::posix_spawnattr_destroy(&attributes);
+        ::posix_spawn_file_actions_destroy(&actions);
+        if (error != 0) {
+            MPV_ERROR_FMT("Cannot start mpv: {}", std::strerror(error));
+            return false;
+        }
+        pid_ = pid;
+
+        if (!ipc_.connect(socket_path, [this](mpv_message const& message) { on_event(message); }, [this] { on_closed(); })) {
+            reap(true);
+            return false;
+        }
+        ipc_.observe(observed_time_pos, "time-pos");
+        ipc_.observe(observed_duration, "duration");
+        ipc_.observe(observed_pause, "pause");
+        ipc_.observe(observed_metadata, "metadata");
+        MPV_INFO_FMT("mpv ready (pid {})", pid_);
+        return true;
+    }
+
+    // Collects the exited process; with `force`, one still running is terminated first
+    void reap(bool force) {
+        if (pid_ <= 0) {
+            return;
+        }
+        if (::waitpid(pid_, nullptr, WNOHANG) == 0 && force) {
+            ::kill(pid_, SIGTERM);
+            for (int i = 0; i < 50 && ::waitpid(pid_, nullptr, WNOHANG) == 0; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            }
+            if (::kill(pid_, 0) == 0) {
+                ::kill(pid_, SIGKILL);
+                ::waitpid(pid_, nullptr, 0);
+            }
+        }
+        pid_ = 0;
+    }
+
+    // On the IPC reader thread
+    void on_event(mpv_message const& message) {
+        std::lock_guard handlers(handler_mutex_);
+        if (!handler_) {
+            return;
+        }
+        if (message.raw("event") == "\"start-file\"") {
+            started_ = true;
+        }
+        if (started_) {
+            handler_(message);
+        }
+    }
+
+    void on_closed() {
+        std::lock_guard handlers(handler_mutex_);
+        if (handler_) {
+            handler_(mpv_message{R"({"event":"shutdown"})"});
+            handler_ = nullptr;
+        }
+    }
+
+    static std::string quote(std::string_view text) {
+        std::string quoted {"\""};
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted.push_back('\\');
+            }
+            quoted.push_back(c);
+        }
+        quoted.push_back('"');
+        return quoted;
+    }
+
+    std::mutex process_mutex_;      // spawning, the connection and the commands sent on it
+    std::mutex handler_mutex_;      // the session; taken by the reader thread, never while it is joined
+    pid_t pid_ {0};
+    mpv_ipc ipc_;
+    uint64_t session_ {0};
+    event_handler handler_;
+    bool started_ {false};
+};
@@ -1,9 +1,17 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
+#include <format>
+#include <functional>
+#include <mutex>
+#include <optional>
 #include <thread>
+#include <unordered_map>
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
@@ -23,160 +31,352 @@
 #define MPV_DEBUG_FMT(fmt, ...) MPV_DEBUG(debug::format_log(fmt, __VA_ARGS__))
 #define MPV_TRACE_FMT(fmt, ...) MPV_TRACE(debug::format_log(fmt, __VA_ARGS__))
 
-// Helper class to handle MPV player interaction via socket
-class mpv_socket_helper {
+/**
+ * One line mpv sent over IPC: a flat JSON object, an event ({"event":"property-change",
+ * "id":1,"name":"time-pos","data":12.5}) or a reply ({"request_id":3,"error":"success",
+ * "data":...}). Fields are found by scanning the line, nested values skipped whole; nothing
+ * is allocated unless a string is asked for.
+ */
+class mpv_message {
+public:
+    explicit mpv_message(std::string_view line) : line_(line) {}
+
+    // A top-level field's JSON text, empty when absent
+    std::string_view raw(std::string_view key) const {
+        return raw_in(line_, key);
+    }
+
+    std::optional<double> number(std::string_view key) const {
+        auto const value = raw(key);
+        if (value.empty() || !(value[0] == '-' || (value[0] >= '0' && value[0] <= '9'))) {
+            return std::nullopt;
+        }
+        char buffer[64];
+        auto const n = std::min(value.size(), sizeof(buffer) - 1);
+        std::memcpy(buffer, value.data(), n);
+        buffer[n] = '\0';
+        return std::strtod(buffer, nullptr);
+    }
+
+    bool boolean(std::string_view key) const {
+        return raw(key) == "true";
+    }
+
+    std::string string(std::string_view key) const {
+        return unquote(raw(key));
+    }
+
+    // A field of an object field, e.g. ("data", "icy-title") in a metadata change
+    std::string string(std::string_view object, std::string_view key) const {
+        return unquote(raw_in(raw(object), key));
+    }
+
 private:
-    int socket_fd{-1};
-    std::string socket_path;
+    static size_t skip_space(std::string_view text, size_t at) {
+        while (at < text.size() && (text[at] == ' ' || text[at] == '\t' || text[at] == '\r' || text[at] == '\n')) {
+            ++at;
+        }
+        return at;
+    }
 
-public:
-    mpv_socket_helper() = default;
-    ~mpv_socket_helper() {
-        close_socket();
-    }
-
-    void close_socket() {
-        if (socket_fd >= 0) {
-            close(socket_fd);
-            socket_fd = -1;
-        }
-        
-        // Remove socket file if it exists
-        if (!socket_path.empty() && std::filesystem::exists(socket_path)) {
-            std::filesystem::remove(socket_path);
-        }
-    }
-    
-    std::string create_socket_path() {
-        // Create a unique socket path in /tmp
-        auto now = std::chrono::system_clock::now().time_since_epoch();
-        auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
-        socket_path = "/tmp/mpv-socket-" + std::to_string(millis);
-        return socket_path;
-    }
-    
-    bool init_socket(const std::string& path) {
-        socket_path = path;
-        
-        // Create socket
-        socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-        if (socket_fd == -1) {
-            MPV_ERROR_FMT("Socket creation failed: {}", std::strerror(errno));
-            return false;
+    // Past the value starting at `at`
+    static size_t skip_value(std::string_view text, size_t at) {
+        if (at >= text.size()) {
+            return at;
         }
-        
-        // Connect to the socket
-        struct sockaddr_un addr;
-        memset(&addr, 0, sizeof(addr));
-        addr.sun_family = AF_UNIX;
-        strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
-        
-        // Wait for the socket to become available (mpv needs a moment to create it)
-        for (int i = 0; i < 50; i++) {  // Wait up to 5 seconds max
-            if (std::filesystem::exists(socket_path)) {
-                break;
+        if (text[at] == '"') {
+            for (++at; at < text.size(); ++at) {
+                if (text[at] == '\\') {
+                    ++at;
+                } else if (text[at] == '"') {
+                    return at + 1;
+                }
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            return at;
         }
-        
-        // Check if socket exists
-        if (!std::filesystem::exists(socket_path)) {
-            MPV_ERROR("Socket file does not exist");
-            close(socket_fd);
-            socket_fd = -1;
-            return false;
+        if (text[at] == '{' || text[at] == '[') {
+            int depth = 0;
+            for (; at < text.size(); ++at) {
+                char const c = text[at];
+                if (c == '"') {
+                    at = skip_value(text, at) - 1;
+                } else if (c == '{' || c == '[') {
+                    ++depth;
+                } else if ((c == '}' || c == ']') && --depth == 0) {
+                    return at + 1;
+                }
+            }
+            return at;
         }
-        
-        // Connect to socket
-        if (connect(socket_fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
-            MPV_ERROR_FMT("Connection failed: {}", std::strerror(errno));
-            close(socket_fd);
-            socket_fd = -1;
-            return false;
+        while (at < text.size() && text[at] != ',' && text[at] != '}' && text[at] != ']') {
+            ++at;
         }
-        
-        MPV_INFO_FMT("Successfully connected to MPV socket at {}", socket_path);
-        return true;
+        return at;
     }
-    
-    bool send_command(const std::string& command) {
-        // First check if the socket is valid
-        if (socket_fd < 0) return false;
-        
-        // Send the command with MSG_NOSIGNAL to prevent SIGPIPE signals
-        ssize_t bytes_sent = send(socket_fd, command.c_str(), command.length(), MSG_NOSIGNAL);
-        if (bytes_sent != static_cast<ssize_t>(command.length())) {
-            // Handle send error
-            if (bytes_sent < 0) {
-                // Check specifically for broken pipe error
-                if (errno == EPIPE) {
-                    // MPV process has likely terminated
-                    MPV_ERROR("Socket send error: broken pipe (MPV process likely terminated)");
-                } else {
-                    MPV_ERROR_FMT("Socket send error: {}", std::strerror(errno));
+
+    static std::string_view raw_in(std::string_view object, std::string_view key) {
+        size_t at = skip_space(object, 0);
+        if (at >= object.size() || object[at] != '{') {
+            return {};
+        }
+        ++at;
+        while (at < object.size()) {
+            at = skip_space(object, at);
+            if (at >= object.size() || object[at] != '"') {
+                return {};
+            }
+            auto const key_end = skip_value(object, at);
+            auto const name = object.substr(at + 1, key_end - at - 2);
+            at = skip_space(object, key_end);
+            if (at >= object.size() || object[at] != ':') {
+                return {};
+            }
+            at = skip_space(object, at + 1);
+            auto const value_end = skip_value(object, at);
+            if (name == key) {
+                auto value = object.substr(at, value_end - at);
+                while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+                    value.remove_suffix(1);
                 }
-            } else {
-                MPV_WARN_FMT("Partial data sent: {} of {} bytes", bytes_sent, command.length());
+                return value;
+            }
+            at = skip_space(object, value_end);
+            if (at < object.size() && object[at] == ',') {
+                ++at;
             }
-            // Close the socket on error
-            close(socket_fd);
-            socket_fd = -1;
-            return false;
         }
-        
-        MPV_DEBUG_FMT("Command sent: {}", command);
-        return true;
+        return {};
+    }
+
+    // A JSON string's text; mpv escapes quotes, backslashes and control characters only
+    static std::string unquote(std::string_view value) {
+        std::string text;
+        if (value.size() < 2 || value.front() != '"') {
+            return text;
+        }
+        value = value.substr(1, value.size() - 2);
+        text.reserve(value.size());
+        for (size_t i = 0; i < value.size(); ++i) {
+            if (value[i] != '\\' || i + 1 == value.size()) {
+                text.push_back(value[i]);
+                continue;
+            }
+            switch (char const c = value[++i]) {
+                case 'n': text.push_back('\n'); break;
+                case 't': text.push_back('\t'); break;
+                case 'r': text.push_back('\r'); break;
+                case 'u': {
+                    unsigned code = 0;
+                    for (size_t k = 0; k < 4 && i + 1 < value.size(); ++k) {
+                        char const h = value[++i];
+                        code = code * 16 + static_cast<unsigned>(h <= '9' ? h - '0' : (h | 0x20) - 'a' + 10);
+                    }
+                    if (code < 0x80) {
+                        text.push_back(static_cast<char>(code));
+                    } else if (code < 0x800) {
+                        text.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                        text.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                    } else {
+                        text.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                        text.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                        text.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                    }
+                    break;
+                }
+                default: text.push_back(c); break;
+            }
+        }
+        return text;
+    }
+
+    std::string_view line_;
+};
+
+/**
+ * An mpv JSON IPC connection with one reader thread: it blocks in poll() on the socket and
+ * hands each line to the event handler or, for replies, to the handler registered with the
+ * command's request_id. Properties are watched with observe(), so positions and metadata
+ * arrive when they change instead of being asked for. Commands can be sent from any thread.
+ * Handlers run on the reader thread and must not call close().
+ */
+class mpv_ipc {
+public:
+    using event_handler = std::function<void(mpv_message const&)>;
+    using reply_handler = std::function<void(mpv_message const&)>;
+    // Called once when mpv goes away (the socket closes) or close() is called
+    using closed_handler = std::function<void()>;
+
+    mpv_ipc() = default;
+    ~mpv_ipc() {
+        close();
+    }
+
+    mpv_ipc(const mpv_ipc&) = delete;
+    mpv_ipc& operator=(const mpv_ipc&) = delete;
+
+    // A fresh path for mpv's --input-ipc-server
+    static std::string unique_socket_path() {
+        auto const millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return std::format("/tmp/mpv-socket-{}-{}", getpid(), millis);
     }
-    
-    bool receive_response(char* buffer, size_t buffer_size, int timeout_ms = 200) {
-        if (socket_fd < 0) return false;
-        
-        fd_set readfds;
-        struct timeval tv;
-        
-        FD_ZERO(&readfds);
-        FD_SET(socket_fd, &readfds);
-        
-        tv.tv_sec = 0;
-        tv.tv_usec = timeout_ms * 1000; // Convert to microseconds
-        
-        int select_result = select(socket_fd + 1, &readfds, NULL, NULL, &tv);
-        if (select_result > 0) {
-            ssize_t bytes_read = recv(socket_fd, buffer, buffer_size - 1, 0);
-            if (bytes_read > 0) {
-                buffer[bytes_read] = '\0';
-                MPV_TRACE_FMT("Received {} bytes from socket", bytes_read);
-                return true;
-            } else if (bytes_read == 0) {
-                // Socket closed
-                MPV_WARN("Socket connection closed by MPV");
-                close(socket_fd);
-                socket_fd = -1;
+
+    // Connects to mpv's --input-ipc-server socket, retrying while mpv starts up
+    bool connect(const std::string& path, event_handler on_event, closed_handler on_closed = {},
+                 std::chrono::milliseconds wait = std::chrono::seconds{5}) {
+        close();
+        sockaddr_un addr {};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        auto const deadline = std::chrono::steady_clock::now() + wait;
+        int fd = -1;
+        for (;;) {
+            fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                MPV_ERROR_FMT("Socket creation failed: {}", std::strerror(errno));
                 return false;
-            } else if (bytes_read < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-                // Socket error
-                MPV_ERROR_FMT("Socket receive error: {}", std::strerror(errno));
-                close(socket_fd);
-                socket_fd = -1;
+            }
+            if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+                break;
+            }
+            ::close(fd);
+            fd = -1;
+            if (std::chrono::steady_clock::now() >= deadline) {
+                MPV_ERROR_FMT("Cannot connect to the MPV socket at {}: {}", path, std::strerror(errno));
                 return false;
             }
-        } else if (select_result < 0) {
-            MPV_ERROR_FMT("Socket select error: {}", std::strerror(errno));
-            return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            fd_ = fd;
+            path_ = path;
+        }
+        on_event_ = std::move(on_event);
+        on_closed_ = std::move(on_closed);
+        reader_ = std::thread([this, fd] { read_loop(fd); });
+        MPV_INFO_FMT("Connected to MPV socket at {}", path);
+        return true;
+    }
+
+    // Disconnects and removes the socket file; mpv itself is left alone
+    void close() {
+        {
+            std::lock_guard lock(mutex_);
+            if (fd_ >= 0) {
+                // Wakes the reader, which then sees the end of the stream
+                ::shutdown(fd_, SHUT_RDWR);
+            }
+        }
+        if (reader_.joinable()) {
+            reader_.join();
+        }
+        if (!path_.empty()) {
+            std::error_code ignored;
+            std::filesystem::remove(path_, ignored);
+            path_.clear();
         }
-        // Timeout occurred
-        return false;
     }
-    
+
     bool is_connected() const {
-        return socket_fd >= 0;
+        std::lock_guard lock(mutex_);
+        return fd_ >= 0;
     }
-    
-    int get_socket_fd() const {
-        return socket_fd;
+
+    // Sends {"command":[<args>],"request_id":N}; `on_reply`, if given, gets mpv's answer
+    bool command(std::string_view args, reply_handler on_reply = {}) {
+        std::lock_guard lock(mutex_);
+        if (fd_ < 0) {
+            return false;
+        }
+        auto const id = ++next_request_;
+        if (on_reply) {
+            pending_.emplace(id, std::move(on_reply));
+        }
+        auto const line = std::format("{{\"command\":[{}],\"request_id\":{}}}\n", args, id);
+        if (::send(fd_, line.data(), line.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(line.size())) {
+            MPV_WARN_FMT("Cannot send to MPV: {}", std::strerror(errno));
+            pending_.erase(id);
+            return false;
+        }
+        MPV_TRACE_FMT("Command sent: {}", line);
+        return true;
     }
-    
-    const std::string& get_socket_path() const {
-        return socket_path;
+
+    // Property changes come as "property-change" events carrying `id`
+    bool observe(int id, std::string_view property) {
+        return command(std::format("\"observe_property\",{},\"{}\"", id, property));
     }
-};
\ No newline at end of file
+
+private:
+    void read_loop(int fd) {
+        std::string pending;
+        char buffer[8192];
+        for (;;) {
+            pollfd pfd {fd, POLLIN, 0};
+            if (::poll(&pfd, 1, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            auto const n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+                    continue;
+                }
+                break;
+            }
+            pending.append(buffer, static_cast<size_t>(n));
+            size_t start = 0;
+            for (auto end = pending.find('\n'); end != std::string::npos; end = pending.find('\n', start)) {
+                dispatch(std::string_view{pending}.substr(start, end - start));
+                start = end + 1;
+            }
+            pending.erase(0, start);
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            ::close(fd_);
+            fd_ = -1;
+            pending_.clear();
+        }
+        MPV_DEBUG("MPV connection closed");
+        if (on_closed_) {
+            on_closed_();
+        }
+    }
+
+    void dispatch(std::string_view line) {
+        mpv_message const message {line};
+        if (auto const id = message.number("request_id"); id && message.raw("event").empty()) {
+            reply_handler reply;
+            {
+                std::lock_guard lock(mutex_);
+                if (auto pos = pending_.find(static_cast<int64_t>(*id)); pos != pending_.end()) {
+                    reply = std::move(pos->second);
+                    pending_.erase(pos);
+                }
+            }
+            if (reply) {
+                reply(message);
+            }
+            return;
+        }
+        if (on_event_) {
+            on_event_(message);
+        }
+    }
+
+    mutable std::mutex mutex_;          // guards fd_, next_request_ and pending_; one writer at a time
+    int fd_ {-1};
+    int64_t next_request_ {0};
+    std::string path_;
+    std::unordered_map<int64_t, reply_handler> pending_;
+    event_handler on_event_;
+    closed_handler on_closed_;
+    std::thread reader_;
+};
@@ -0,0 +1,774 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <sstream>
+#include <stop_token>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/in_systm.h>
+#include <netinet/ip.h>
+#include <netinet/ip_icmp.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#endif
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// 3. All other includes
+#include "debug.hpp"
+
+namespace rouen::helpers {
+
+// What one connect() found out
+enum class probe_status : std::uint8_t {
+    open,           // accepted
+    closed,         // refused: nothing listens there, but the host answered
+    unreachable,    // no route, or the host is known to be down
+    timed_out,      // no answer in time
+};
+
+struct probe_target {
+    std::uint32_t address {0};      // IPv4, host byte order
+    std::uint16_t port {0};
+};
+
+struct probe_result {
+    probe_target target;
+    probe_status status {probe_status::timed_out};
+    std::chrono::microseconds rtt {0};
+    std::string banner;             // what an open port's service sent first, when asked for
+};
+
+struct probe_options {
+    size_t concurrency {2048};                      // connects in flight, within the descriptor limit
+    std::chrono::milliseconds timeout {500};
+    size_t per_host {0};                            // initial connects in flight per host; 0 for no limit
+    size_t per_host_max {512};
+    bool banner {false};                            // read what open ports say first
+    std::chrono::milliseconds banner_timeout {1000};
+};
+
+/**
+ * Deadlines rounded up to a tick, in a ring of per-tick slots as long as the longest timeout:
+ * adding and expiring are O(1) whatever the number of entries. Entries are never removed;
+ * whoever expires them tells a stale one (finished meanwhile) by its key.
+ */
+class timeout_wheel {
+public:
+    using clock = std::chrono::steady_clock;
+
+    timeout_wheel(std::chrono::milliseconds tick, std::chrono::milliseconds span)
+        : tick_{std::max(tick, std::chrono::milliseconds{1})},
+          slots_(static_cast<size_t>(span / tick_) + 2),
+          now_tick_{ticks(clock::now())} {}
+
+    void add(std::uint64_t key, clock::time_point deadline) {
+        auto const last = now_tick_ + slots_.size() - 1;
+        auto const at = std::clamp(ticks(deadline) + 1, now_tick_ + 1, last);
+        slots_[at % slots_.size()].push_back(key);
+    }
+
+    // Every key whose tick has passed, oldest first
+    template <typename F>
+    void expire(clock::time_point now, F &&expired) {
+        auto const target = ticks(now);
+        // After a long stall every slot is due once
+        if (target - now_tick_ > slots_.size()) {
+            now_tick_ = target - slots_.size();
+        }
+        while (now_tick_ < target) {
+            ++now_tick_;
+            auto &slot = slots_[now_tick_ % slots_.size()];
+            for (auto key : slot) {
+                expired(key);
+            }
+            slot.clear();
+        }
+    }
+
+    [[nodiscard]] std::chrono::milliseconds tick() const { return tick_; }
+
+private:
+    [[nodiscard]] std::uint64_t ticks(clock::time_point at) const {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(at.time_since_epoch()) / tick_);
+    }
+
+    std::chrono::milliseconds tick_;
+    std::vector<std::vector<std::uint64_t>> slots_;
+    std::uint64_t now_tick_;
+};
+
+// A non-blocking, close-on-exec IPv4 socket that raises no SIGPIPE; -1 if none can be had
+inline int open_probe_socket(int type, int protocol) {
+#ifdef __linux__
+    return socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+#else
+    int const fd = socket(AF_INET, type, protocol);
+    if (fd >= 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        int const on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    }
+    return fd;
+#endif
+}
+
+/**
+ * Readiness of many non-blocking sockets, each known by a 64-bit key: epoll on Linux, kqueue
+ * on macOS and the BSDs. A socket is watched either for writing (a connect finishing) or for
+ * reading, and stops being watched when it is closed.
+ */
+class socket_events {
+public:
+    enum class direction : std::uint8_t { write, read };
+
+    socket_events() {
+#ifdef __linux__
+        fd_ = epoll_create1(EPOLL_CLOEXEC);
+#else
+        fd_ = kqueue();
+        if (fd_ >= 0) {
+            fcntl(fd_, F_SETFD, FD_CLOEXEC);
+        }
+#endif
+    }
+
+    ~socket_events() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    socket_events(socket_events const &) = delete;
+    socket_events &operator=(socket_events const &) = delete;
+
+    [[nodiscard]] bool valid() const { return fd_ >= 0; }
+
+    void add(int fd, std::uint64_t key, direction dir) {
+#ifdef __linux__
+        epoll_event event = epoll_for(key, dir);
+        epoll_ctl(fd_, EPOLL_CTL_ADD, fd, &event);
+#else
+        struct kevent change {};
+        EV_SET(&change, static_cast<uintptr_t>(fd), filter_for(dir), EV_ADD, 0, 0, udata_for(key));
+        kevent(fd_, &change, 1, nullptr, 0, nullptr);
+#endif
+    }
+
+    // Watches a socket added for `from` for `to` instead, under a new key
+    void change(int fd, std::uint64_t key, direction from, direction to) {
+#ifdef __linux__
+        (void)from;
+        epoll_event event = epoll_for(key, to);
+        epoll_ctl(fd_, EPOLL_CTL_MOD, fd, &event);
+#else
+        struct kevent changes[2] {};
+        EV_SET(&changes[0], static_cast<uintptr_t>(fd), filter_for(from), EV_DELETE, 0, 0, nullptr);
+        EV_SET(&changes[1], static_cast<uintptr_t>(fd), filter_for(to), EV_ADD, 0, 0, udata_for(key));
+        kevent(fd_, changes, 2, nullptr, 0, nullptr);
+#endif
+    }
+
+    void remove(int fd) {
+#ifdef __linux__
+        epoll_ctl(fd_, EPOLL_CTL_DEL, fd, nullptr);
+#else
+        (void)fd;       // closing the socket drops its filters
+#endif
+    }
+
+    // The keys of the sockets that became ready within `timeout`; false on an error other than EINTR
+    bool wait(std::vector<std::uint64_t> &ready, std::chrono::milliseconds timeout) {
+        ready.clear();
+#ifdef __linux__
+        auto const n = epoll_wait(fd_, events_.data(), static_cast<int>(events_.size()), static_cast<int>(timeout.count()));
+        for (int i = 0; i < n; ++i) {
+            ready.push_back(events_[static_cast<size_t>(i)].data.u64);
+        }
+#else
+        auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        timespec const wait_for {static_cast<time_t>(seconds.count()), static_cast<long>(std::chrono::nanoseconds{timeout - seconds}.count())};
+        auto const n = kevent(fd_, nullptr, 0, events_.data(), static_cast<int>(events_.size()), &wait_for);
+        for (int i = 0; i < n; ++i) {
+            ready.push_back(static_cast<std::uint64_t>(reinterpret_cast<uintptr_t>(events_[static_cast<size_t>(i)].udata)));
+        }
+#endif
+        return n >= 0 || errno == EINTR;
+    }
+
+private:
+#ifdef __linux__
+    static epoll_event epoll_for(std::uint64_t key, direction dir) {
+        epoll_event event {};
+        event.events = dir == direction::write ? EPOLLOUT | EPOLLERR | EPOLLHUP : EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP;
+        event.data.u64 = key;
+        return event;
+    }
+
+    std::vector<epoll_event> events_ = std::vector<epoll_event>(256);
+#else
+    static short filter_for(direction dir) {
+        return dir == direction::write ? EVFILT_WRITE : EVFILT_READ;
+    }
+
+    static void *udata_for(std::uint64_t key) {
+        static_assert(sizeof(void *) >= sizeof(std::uint64_t), "kqueue keys travel in udata");
+        return reinterpret_cast<void *>(static_cast<uintptr_t>(key));
+    }
+
+    std::vector<struct kevent> events_ = std::vector<struct kevent>(256);
+#endif
+
+    int fd_ {-1};
+};
+
+/**
+ * TCP connect probes, thousands at once from one thread: non-blocking connect()s watched by
+ * socket_events, timed out by a timeout_wheel. Targets are pulled from the caller as slots free up,
+ * so a sweep can skip what earlier answers made pointless; results go to the sink on the
+ * prober's thread as they come. Sockets close with an RST (zero linger), so a /16 sweep
+ * leaves no TIME_WAIT behind.
+ *
+ * With a per-host window, each host gets at most that many connects at once: the window grows
+ * by one with every answer and shrinks by a quarter when a host that has answered before lets
+ * probes time out (it is dropping, likely rate limiting), never below a few. Targets over
+ * their host's window wait, in order, while other hosts' probes go out; a host that turns out
+ * unreachable has its waiting targets reported as such without being tried.
+ */
+class tcp_prober {
+public:
+    using clock = std::chrono::steady_clock;
+    using target_source = std::function<std::optional<probe_target>()>;
+    using result_sink = std::function<void(probe_result const &)>;
+
+    explicit tcp_prober(probe_options options) : options_{options} {
+        // A few descriptors stay for everything else the app does
+        rlimit limit {};
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+            auto const room = limit.rlim_cur > 256 ? static_cast<size_t>(limit.rlim_cur) - 128 : static_cast<size_t>(limit.rlim_cur) / 2;
+            options_.concurrency = std::min(options_.concurrency, room);
+        }
+        options_.concurrency = std::max<size_t>(options_.concurrency, 1);
+    }
+
+    // Until the source runs dry and every probe has its answer, or until stopped
+    void run(target_source const &next, result_sink const &sink, std::stop_token stop) {
+        socket_events events;
+        if (!events.valid()) {
+            SYS_ERROR_FMT("Cannot watch sockets for readiness: {}", std::strerror(errno));
+            return;
+        }
+        attempts_.assign(options_.concurrency, {});
+        free_.clear();
+        for (auto i = options_.concurrency; i > 0; --i) {
+            free_.push_back(static_cast<std::uint32_t>(i - 1));
+        }
+        hosts_.clear();
+        ready_.clear();
+        waiting_ = 0;
+        auto const longest = options_.banner ? options_.timeout + options_.banner_timeout : options_.timeout;
+        timeout_wheel wheel {std::max(options_.timeout / 64, std::chrono::milliseconds{2}), longest};
+        std::optional<probe_target> held;       // taken but not started yet: no socket could be had
+        bool exhausted = false;
+        size_t limit = options_.concurrency;
+        std::vector<std::uint64_t> ready;
+
+        while (!stop.stop_requested()) {
+            while (in_flight() < limit) {
+                std::optional<probe_target> target;
+                if (held) {
+                    target = held;
+                    held.reset();
+                    reserve(target->address);
+                } else if (!(target = take_ready())) {
+                    // Past this many waiting targets the source waits for the windows to open
+                    if (exhausted || waiting_ >= max_waiting) {
+                        break;
+                    }
+                    target = next();
+                    if (!target) {
+                        exhausted = true;
+                        break;
+                    }
+                    if (!admit(*target)) {
+                        continue;
+                    }
+                }
+                if (!start(events, wheel, *target, sink)) {
+                    release(target->address);
+                    if (in_flight() == 0) {
+                        // Nothing to wait for: no socket can be had at all
+                        report(*target, probe_status::unreachable, std::chrono::microseconds{0}, {}, sink);
+                        continue;
+                    }
+                    // Out of descriptors or local ports: wait for some to come back
+                    held = target;
+                    limit = std::max<size_t>(in_flight(), 1);
+                    break;
+                }
+            }
+            if (exhausted && in_flight() == 0 && waiting_ == 0 && !held) {
+                break;
+            }
+
+            if (!events.wait(ready, wheel.tick())) {
+                SYS_ERROR_FMT("Waiting for socket readiness failed: {}", std::strerror(errno));
+                break;
+            }
+            auto const now = clock::now();
+            for (auto const key : ready) {
+                if (!current(key)) {
+                    continue;
+                }
+                auto const slot = slot_of(key);
+                if (attempts_[slot].reading) {
+                    finish(events, slot, probe_status::open, now, read_banner(attempts_[slot].fd), sink);
+                    continue;
+                }
+                int error = 0;
+                socklen_t len = sizeof(error);
+                getsockopt(attempts_[slot].fd, SOL_SOCKET, SO_ERROR, &error, &len);
+                if (error == 0 && options_.banner) {
+                    await_banner(events, wheel, slot, now);
+                    continue;
+                }
+                finish(events, slot, status_of(error), now, {}, sink);
+            }
+            wheel.expire(now, [&](std::uint64_t key) {
+                if (current(key)) {
+                    auto const slot = slot_of(key);
+                    // A service that says nothing first is still open
+                    finish(events, slot, attempts_[slot].reading ? probe_status::open : probe_status::timed_out, now, {}, sink);
+                }
+            });
+            if (held) {
+                limit = options_.concurrency;
+            }
+        }
+
+        for (std::uint32_t slot = 0; slot < attempts_.size(); ++slot) {
+            if (attempts_[slot].fd >= 0) {
+                close_now(attempts_[slot].fd);
+                attempts_[slot].fd = -1;
+            }
+        }
+    }
+
+private:
+    struct attempt {
+        int fd {-1};
+        std::uint32_t generation {0};
+        probe_target target;
+        clock::time_point started;
+        clock::time_point connected;
+        bool reading {false};       // connected, waiting for the service to speak
+    };
+
+    struct host_state {
+        std::uint32_t in_flight {0};
+        double window {0};
+        bool answered {false};
+        bool queued {false};        // in ready_
+        std::deque<std::uint16_t> waiting;
+    };
+
+    static constexpr size_t max_waiting = 1 << 16;
+    static constexpr double min_window = 4;
+
+    static std::uint32_t slot_of(std::uint64_t key) { return static_cast<std::uint32_t>(key); }
+
+    static probe_status status_of(int error) {
+        switch (error) {
+            case 0: return probe_status::open;
+            case ECONNREFUSED: return probe_status::closed;
+            case EHOSTUNREACH:
+            case ENETUNREACH:
+            case EHOSTDOWN: return probe_status::unreachable;
+            default: return probe_status::timed_out;
+        }
+    }
+
+    // Close with an RST rather than a FIN and TIME_WAIT
+    static void close_now(int fd) {
+        linger const abort {1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+        close(fd);
+    }
+
+    [[nodiscard]] size_t in_flight() const { return options_.concurrency - free_.size(); }
+
+    [[nodiscard]] bool current(std::uint64_t key) const {
+        auto const &a = attempts_[slot_of(key)];
+        return a.fd >= 0 && a.generation == static_cast<std::uint32_t>(key >> 32);
+    }
+
+    // Takes a slot in a new target's host window, or leaves the target waiting behind the others
+    bool admit(probe_target const &target) {
+        if (options_.per_host == 0) {
+            return true;
+        }
+        auto &host = hosts_[target.address];
+        if (host.window == 0) {
+            host.window = static_cast<double>(options_.per_host);
+        }
+        if (host.waiting.empty() && host.in_flight < static_cast<std::uint32_t>(host.window)) {
+            ++host.in_flight;
+            return true;
+        }
+        host.waiting.push_back(target.port);
+        ++waiting_;
+        return false;
+    }
+
+    void reserve(std::uint32_t address) {
+        if (options_.per_host != 0) {
+            ++hosts_[address].in_flight;
+        }
+    }
+
+    void release(std::uint32_t address) {
+        if (options_.per_host != 0) {
+            --hosts_[address].in_flight;
+        }
+    }
+
+    // The next waiting target whose host has room again
+    std::optional<probe_target> take_ready() {
+        while (!ready_.empty()) {
+            auto const address = ready_.front();
+            auto &host = hosts_[address];
+            if (host.waiting.empty() || host.in_flight >= static_cast<std::uint32_t>(host.window)) {
+                host.queued = false;
+                ready_.pop_front();
+                continue;
+            }
+            probe_target const target {address, host.waiting.front()};
+            host.waiting.pop_front();
+            --waiting_;
+            ++host.in_flight;
+            return target;
+        }
+        return std::nullopt;
+    }
+
+    // false when no socket could be had; any other outcome is reported
+    bool start(socket_events &events, timeout_wheel &wheel, probe_target const &target, result_sink const &sink) {
+        int const fd = open_probe_socket(SOCK_STREAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(target.port);
+        addr.sin_addr.s_addr = htonl(target.address);
+        auto const started = clock::now();
+        if (connect(fd, reinterpret_cast<sockaddr const *>(&addr), sizeof(addr)) == 0 || errno != EINPROGRESS) {
+            auto const error = errno;
+            close_now(fd);
+            if (error == EADDRNOTAVAIL || error == EAGAIN) {
+                return false;
+            }
+            release(target.address);
+            report(target, status_of(error), std::chrono::microseconds{0}, {}, sink);
+            return true;
+        }
+
+        auto const slot = free_.back();
+        free_.pop_back();
+        auto &a = attempts_[slot];
+        a.fd = fd;
+        ++a.generation;
+        a.target = target;
+        a.started = started;
+        a.reading = false;
+        auto const key = (static_cast<std::uint64_t>(a.generation) << 32) | slot;
+        events.add(fd, key, socket_events::direction::write);
+        wheel.add(key, started + options_.timeout);
+        return true;
+    }
+
+    // Connected: keep the socket until the service speaks or banner_timeout passes
+    void await_banner(socket_events &events, timeout_wheel &wheel, std::uint32_t slot, clock::time_point now) {
+        auto &a = attempts_[slot];
+        a.reading = true;
+        a.connected = now;
+        ++a.generation;         // the connect deadline goes stale
+        auto const key = (static_cast<std::uint64_t>(a.generation) << 32) | slot;
+        events.change(a.fd, key, socket_events::direction::write, socket_events::direction::read);
+        wheel.add(key, now + options_.banner_timeout);
+        // Web servers wait to be asked
+        switch (a.target.port) {
+            case 80: case 8000: case 8008: case 8080: case 8888: {
+                static constexpr char request[] = "HEAD / HTTP/1.0\r\n\r\n";
+                (void)send(a.fd, request, sizeof(request) - 1, MSG_NOSIGNAL);
+                break;
+            }
+            default: break;
+        }
+    }
+
+    // The first line the service sent, printable characters only
+    static std::string read_banner(int fd) {
+        char buffer[512];
+        auto const n = recv(fd, buffer, sizeof(buffer), 0);
+        std::string banner;
+        for (ssize_t i = 0; i < n && buffer[i] != '\n' && buffer[i] != '\r'; ++i) {
+            auto const c = static_cast<unsigned char>(buffer[i]);
+            banner.push_back(c >= 0x20 && c < 0x7F ? static_cast<char>(c) : '.');
+        }
+        return banner;
+    }
+
+    void finish(socket_events &events, std::uint32_t slot, probe_status status, clock::time_point now, std::string banner, result_sink const &sink) {
+        auto &a = attempts_[slot];
+        events.remove(a.fd);
+        close_now(a.fd);
+        a.fd = -1;
+        free_.push_back(slot);
+        release(a.target.address);
+        auto const answered_at = a.reading ? a.connected : now;
+        report(a.target, status, std::chrono::duration_cast<std::chrono::microseconds>(answered_at - a.started), std::move(banner), sink);
+    }
+
+    // Hands the result over, and lets it steer the host's window
+    void report(probe_target const &target, probe_status status, std::chrono::microseconds rtt, std::string banner, result_sink const &sink) {
+        if (options_.per_host != 0) {
+            auto &host = hosts_[target.address];
+            switch (status) {
+                case probe_status::open:
+                case probe_status::closed:
+                    host.answered = true;
+                    host.window = std::min(host.window + 1, static_cast<double>(options_.per_host_max));
+                    break;
+                case probe_status::timed_out:
+                    if (host.answered) {
+                        host.window = std::max(host.window * 0.75, min_window);
+                    }
+                    break;
+                case probe_status::unreachable:
+                    // Whatever waits for this host would only find that out again
+                    for (auto port : host.waiting) {
+                        sink({{target.address, port}, probe_status::unreachable, std::chrono::microseconds{0}, {}});
+                    }
+                    waiting_ -= host.waiting.size();
+                    host.waiting.clear();
+                    break;
+            }
+            if (!host.waiting.empty() && !host.queued) {
+                host.queued = true;
+                ready_.push_back(target.address);
+            }
+        }
+        sink({target, status, rtt, std::move(banner)});
+    }
+
+    probe_options options_;
+    std::vector<attempt> attempts_;
+    std::vector<std::uint32_t> free_;
+    std::unordered_map<std::uint32_t, host_state> hosts_;
+    std::deque<std::uint32_t> ready_;       // hosts with targets waiting, oldest first
+    size_t waiting_ {0};
+};
+
+/**
+ * ICMP echo to many hosts from one socket: a datagram ICMP socket where
+ * net.ipv4.ping_group_range lets us have one, a raw socket with CAP_NET_RAW otherwise,
+ * nothing (available() is false) without either. Requests go out paced, up to `concurrency`
+ * per tick, and replies are matched by source address, so a host that answers twice
+ * is reported once.
+ */
+class icmp_prober {
+public:
+    using clock = std::chrono::steady_clock;
+    using address_source = std::function<std::optional<std::uint32_t>()>;
+    using reply_sink = std::function<void(std::uint32_t address, std::chrono::microseconds rtt)>;
+
+    explicit icmp_prober(probe_options options) : options_{options} {
+        fd_ = open_probe_socket(SOCK_DGRAM, IPPROTO_ICMP);
+        if (fd_ < 0) {
+            fd_ = open_probe_socket(SOCK_RAW, IPPROTO_ICMP);
+            raw_ = fd_ >= 0;
+        }
+#ifndef __linux__
+        // Outside Linux a datagram ICMP socket reads like a raw one
+        raw_ = fd_ >= 0;
+#endif
+        if (fd_ >= 0) {
+            // Replies to a burst arrive together
+            int const buffer = 4 << 20;
+            setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+        }
+    }
+
+    ~icmp_prober() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    icmp_prober(icmp_prober const &) = delete;
+    icmp_prober &operator=(icmp_prober const &) = delete;
+
+    [[nodiscard]] bool available() const { return fd_ >= 0; }
+
+    // Until every address was asked and the last one's timeout has passed, or until stopped
+    void run(address_source const &next, reply_sink const &sink, std::stop_token stop) {
+        if (fd_ < 0) {
+            return;
+        }
+        std::unordered_map<std::uint32_t, clock::time_point> sent;     // awaiting a reply
+        auto const identifier = static_cast<std::uint16_t>(getpid());
+        std::uint16_t sequence = 0;
+        auto const tick = std::chrono::milliseconds{10};
+        bool exhausted = false;
+        auto last_sent = clock::now();
+
+        while (!stop.stop_requested()) {
+            for (size_t burst = 0; !exhausted && burst < options_.concurrency; ++burst) {
+                auto const address = next();
+                if (!address) {
+                    exhausted = true;
+                    break;
+                }
+                if (send_echo(*address, identifier, sequence++)) {
+                    last_sent = clock::now();
+                    sent.emplace(*address, last_sent);
+                }
+            }
+            if (exhausted && (sent.empty() || clock::now() - last_sent > options_.timeout)) {
+                break;
+            }
+            pollfd pfd {fd_, POLLIN, 0};
+            if (poll(&pfd, 1, static_cast<int>(tick.count())) > 0) {
+                receive(identifier, sent, sink);
+            }
+        }
+    }
+
+private:
+    // The ICMP echo header, spelled out: Linux and the BSDs name its fields differently
+    struct echo_header {
+        std::uint8_t type;
+        std::uint8_t code;
+        std::uint16_t checksum;
+        std::uint16_t id;
+        std::uint16_t sequence;
+    };
+
+    static std::uint16_t checksum(void const *data, size_t size) {
+        auto const *bytes = static_cast<std::uint8_t const *>(data);
+        std::uint32_t sum = 0;
+        for (size_t i = 0; i + 1 < size; i += 2) {
+            sum += static_cast<std::uint32_t>(bytes[i] << 8 | bytes[i + 1]);
+        }
+        if (size % 2) {
+            sum += static_cast<std::uint32_t>(bytes[size - 1] << 8);
+        }
+        while (sum >> 16) {
+            sum = (sum & 0xFFFF) + (sum >> 16);
+        }
+        return htons(static_cast<std::uint16_t>(~sum));
+    }
+
+    bool send_echo(std::uint32_t address, std::uint16_t identifier, std::uint16_t sequence) {
+        echo_header header {};
+        header.type = ICMP_ECHO;
+        header.id = htons(identifier);      // a datagram socket on Linux puts its own
+        header.sequence = htons(sequence);
+        header.checksum = checksum(&header, sizeof(header));
+        sockaddr_in to {};
+        to.sin_family = AF_INET;
+        to.sin_addr.s_addr = htonl(address);
+        return sendto(fd_, &header, sizeof(header), 0, reinterpret_cast<sockaddr const *>(&to), sizeof(to)) == static_cast<ssize_t>(sizeof(header));
+    }
+
+    void receive(std::uint16_t identifier, std::unordered_map<std::uint32_t, clock::time_point> &sent, reply_sink const &sink) {
+        char buffer[512];
+        sockaddr_in from {};
+        socklen_t from_len = sizeof(from);
+        ssize_t n;
+        while ((n = recvfrom(fd_, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr *>(&from), &from_len)) > 0) {
+            size_t offset = 0;
+            if (raw_) {
+                // Raw sockets see the IP header (its length in the low nibble of the first byte),
+                // and every ICMP message the host gets
+                offset = static_cast<size_t>(static_cast<unsigned char>(buffer[0]) & 0x0F) * 4;
+            }
+            if (static_cast<size_t>(n) < offset + sizeof(echo_header)) {
+                continue;
+            }
+            echo_header header;
+            std::memcpy(&header, buffer + offset, sizeof(header));
+            if (header.type != ICMP_ECHOREPLY || (raw_ && ntohs(header.id) != identifier)) {
+                continue;
+            }
+            auto const address = ntohl(from.sin_addr.s_addr);
+            if (auto pos = sent.find(address); pos != sent.end()) {
+                sink(address, std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - pos->second));
+                sent.erase(pos);
+            }
+            from_len = sizeof(from);
+        }
+    }
+
+    probe_options options_;
+    int fd_ {-1};
+    bool raw_ {false};         // replies come with their IP header, and other processes' echoes among them
+};
+
+// A host the kernel has resolved on a local link
+struct neighbor {
+    std::uint32_t address {0};      // host byte order
+    std::string mac;
+    std::string device;
+};
+
+/**
+ * The complete entries of the kernel's ARP table (/proc/net/arp): hosts that answered an ARP
+ * request lately, whatever they do with TCP and ICMP. Reading it costs nothing; right after a
+ * sweep it lists every host on the link the sweep reached. Empty outside Linux.
+ */
+inline std::vector<neighbor> read_neighbors() {
+    std::vector<neighbor> found;
+#ifdef __linux__
+    std::ifstream arp {"/proc/net/arp"};
+    std::string line;
+    std::getline(arp, line);        // the header
+    while (std::getline(arp, line)) {
+        std::istringstream fields {line};
+        std::string ip, hw_type, flags, mac, mask, device;
+        if (!(fields >> ip >> hw_type >> flags >> mac >> mask >> device)) {
+            continue;
+        }
+        in_addr addr {};
+        // ATF_COM: resolved (an incomplete entry is a host that did not answer)
+        if ((std::strtoul(flags.c_str(), nullptr, 16) & 0x2) == 0 || inet_pton(AF_INET, ip.c_str(), &addr) != 1) {
+            continue;
+        }
+        found.push_back({ntohl(addr.s_addr), std::move(mac), std::move(device)});
+    }
+#endif
+    return found;
+}
+
+} // namespace rouen::helpers
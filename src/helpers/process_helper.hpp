@@ -1,58 +1,550 @@
 #pragma once
 
-#include <string>
-#include <array>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <functional>
+#include <future>
 #include <memory>
-#include <sstream>
-#include <cstdio>
-#include <iostream>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "debug.hpp"
+#include "trace.hpp"
 
 // Add process-specific logging macros
 #define PROCESS_ERROR(message) LOG_COMPONENT("PROCESS", LOG_LEVEL_ERROR, message)
 #define PROCESS_ERROR_FMT(fmt, ...) PROCESS_ERROR(debug::format_log(fmt, __VA_ARGS__))
 
+extern char **environ;
+
 namespace ProcessHelper {
+    // A close-on-exec pipe, both ends non-blocking too when asked; false with errno set if none
+    inline bool open_pipe(int fds[2], bool nonblocking = false) {
+#ifdef __linux__
+        return pipe2(fds, O_CLOEXEC | (nonblocking ? O_NONBLOCK : 0)) == 0;
+#else
+        if (pipe(fds) != 0) {
+            return false;
+        }
+        for (int i = 0; i < 2; ++i) {
+            fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+            if (nonblocking) {
+                fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+            }
+        }
+        return true;
+#endif
+    }
+
+    /**
+     * How to run a process. Without callbacks its stdout and stderr are collected into the
+     * result; with one, that stream goes to it chunk by chunk instead, on the process
+     * thread, so it must be quick (copy, queue, invalidate a card).
+     */
+    struct ProcessOptions {
+        std::string cwd;                                            // empty: ours
+        std::vector<std::pair<std::string, std::string>> env;       // added to ours, replacing equal names
+        std::chrono::milliseconds timeout {0};                      // 0: none; else SIGKILL when it passes
+        std::function<void(std::string_view)> on_stdout;
+        std::function<void(std::string_view)> on_stderr;
+        bool keep_stdin {false};                                    // a pipe for write() instead of /dev/null
+    };
+
+    struct ProcessResult {
+        int exit_code {-1};         // -1 when it didn't exit on its own
+        int signal {0};             // the signal that ended it
+        bool timed_out {false};
+        std::string out;            // unless on_stdout was given
+        std::string err;            // unless on_stderr was given
+        std::string error;          // why it could not be started
+
+        [[nodiscard]] bool ok() const { return exit_code == 0; }
+    };
+
+    class ProcessRunner;
+
+    // A started (or queued) process; its result is ready once it has exited and been reaped
+    class Process {
+    public:
+        // SIGTERM by default, to its whole process group; before it starts it simply won't
+        void kill(int sig = SIGTERM) {
+            kill_signal_.store(sig, std::memory_order_release);
+            wake_();
+        }
+
+        /**
+         * Sends text to its stdin (with keep_stdin), blocking while the pipe is full; false once
+         * it has exited. Text written before it starts waits in a queue and goes first.
+         */
+        bool write(std::string_view text) {
+            std::lock_guard<std::mutex> lock(in_mutex_);
+            if (in_closed_) {
+                return false;
+            }
+            if (in_fd_ < 0) {
+                pending_in_.append(text);
+                return true;
+            }
+            return write_all(text);
+        }
+
+        [[nodiscard]] pid_t pid() const { return pid_.load(std::memory_order_acquire); }
+        [[nodiscard]] bool finished() const { return finished_.load(std::memory_order_acquire); }
+        [[nodiscard]] std::shared_future<ProcessResult> const &result() const { return future_; }
+
+    private:
+        friend class ProcessRunner;
+
+        // in_mutex_ held. A child that exited gets EPIPE here rather than a SIGPIPE for the app:
+        // the signal is blocked on this thread for the write and a pending one is taken back
+        bool write_all(std::string_view text) {
+            sigset_t pipe_signal;
+            sigset_t previous;
+            sigemptyset(&pipe_signal);
+            sigaddset(&pipe_signal, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &pipe_signal, &previous);
+            bool ok = true;
+            while (!text.empty()) {
+                auto const n = ::write(in_fd_, text.data(), text.size());
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    if (errno == EPIPE) {
+                        timespec const now {0, 0};
+                        sigtimedwait(&pipe_signal, nullptr, &now);
+                    }
+                    ok = false;
+                    break;
+                }
+                text.remove_prefix(static_cast<size_t>(n));
+            }
+            pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+            return ok;
+        }
+
+        void open_stdin(int fd) {
+            std::lock_guard<std::mutex> lock(in_mutex_);
+            in_fd_ = fd;
+            if (!pending_in_.empty()) {
+                write_all(pending_in_);
+                pending_in_.clear();
+            }
+        }
+
+        void close_stdin() {
+            std::lock_guard<std::mutex> lock(in_mutex_);
+            if (in_fd_ >= 0) {
+                close(in_fd_);
+                in_fd_ = -1;
+            }
+            in_closed_ = true;
+        }
+
+        std::vector<std::string> argv_;
+        ProcessOptions options_;
+        std::promise<ProcessResult> promise_;
+        std::shared_future<ProcessResult> future_ {promise_.get_future().share()};
+        std::function<void()> wake_;
+        std::atomic<pid_t> pid_ {0};
+        std::atomic<int> kill_signal_ {0};
+        std::atomic<bool> finished_ {false};
+        std::mutex in_mutex_;       // guards the stdin pipe, written from any thread
+        int in_fd_ {-1};
+        bool in_closed_ {false};
+        std::string pending_in_;
+
+        // The runner's thread only
+        ProcessResult result_;
+        int out_fd_ {-1};
+        int err_fd_ {-1};
+        std::chrono::steady_clock::time_point deadline_ {std::chrono::steady_clock::time_point::max()};
+        std::chrono::steady_clock::time_point started_ {};
+    };
+
+    /**
+     * Runs processes with posix_spawn, without a shell unless asked for one: no fork of our
+     * address space, a working directory of their own (no "cd dir &&"), their own process
+     * group and separate stdout and stderr pipes. One thread polls every pipe and reaps every
+     * child, however many run; at most ROUEN_PROCESS_MAX (twice the cores by default) run at
+     * once and the rest queue, so scanning hundreds of repositories doesn't fork them all.
+     */
+    class ProcessRunner {
+    public:
+        static ProcessRunner &instance() {
+            static ProcessRunner runner;
+            return runner;
+        }
+
+        std::shared_ptr<Process> spawn(std::vector<std::string> argv, ProcessOptions options) {
+            auto process = std::make_shared<Process>();
+            process->argv_ = std::move(argv);
+            process->options_ = std::move(options);
+            process->wake_ = [this] { wake(); };
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queued_.push_back(process);
+            }
+            wake();
+            return process;
+        }
+
+        ~ProcessRunner() {
+            thread_.request_stop();
+            wake();
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+            close(wake_fds_[0]);
+            close(wake_fds_[1]);
+        }
+
+        ProcessRunner(ProcessRunner const &) = delete;
+        ProcessRunner &operator=(ProcessRunner const &) = delete;
+
+    private:
+        static constexpr size_t read_chunk = 64 * 1024;
+
+        ProcessRunner() {
+            if (!open_pipe(wake_fds_, true)) {
+                PROCESS_ERROR_FMT("Could not create the process runner's wake pipe: {}", std::strerror(errno));
+            }
+            auto const spec = std::getenv("ROUEN_PROCESS_MAX");
+            auto const max = spec ? std::strtoul(spec, nullptr, 10) : 0;
+            max_running_ = max > 0 ? max : std::max(2u, std::thread::hardware_concurrency() * 2);
+            thread_ = std::jthread{[this](std::stop_token stoken) {
+                rouen::helpers::trace::name_thread("processes");
+                run(stoken);
+            }};
+        }
+
+        void wake() {
+            char const byte = 1;
+            [[maybe_unused]] auto const n = write(wake_fds_[1], &byte, 1);
+        }
+
+        static void complete(Process &process) {
+            if (process.started_ != std::chrono::steady_clock::time_point{} && rouen::helpers::trace::enabled()) {
+                std::string command;
+                for (auto const &arg : process.argv_) {
+                    command += command.empty() ? arg : ' ' + arg;
+                }
+                rouen::helpers::trace::async("PROCESS", "process", process.started_, std::chrono::steady_clock::now(), command);
+            }
+            process.close_stdin();
+            process.finished_.store(true, std::memory_order_release);
+            process.promise_.set_value(std::move(process.result_));
+        }
+
+        static std::vector<std::string> environment(ProcessOptions const &options) {
+            std::vector<std::string> entries;
+            for (char **entry = environ; entry && *entry; ++entry) {
+                std::string_view const text {*entry};
+                auto const name = text.substr(0, text.find('='));
+                auto const replaced = std::ranges::any_of(options.env, [&](auto const &var) { return var.first == name; });
+                if (!replaced) {
+                    entries.emplace_back(text);
+                }
+            }
+            for (auto const &[name, value] : options.env) {
+                entries.push_back(name + '=' + value);
+            }
+            return entries;
+        }
+
+        // false, with result_.error set, when it could not be started
+        static bool start(Process &process) {
+            if (process.argv_.empty()) {
+                process.result_.error = "Nothing to run";
+                return false;
+            }
+            int out[2] {-1, -1};
+            int err[2] {-1, -1};
+            int in[2] {-1, -1};
+            if (!open_pipe(out) || !open_pipe(err) || (process.options_.keep_stdin && !open_pipe(in))) {
+                process.result_.error = std::format("pipe: {}", std::strerror(errno));
+                for (int fd : {out[0], out[1], err[0], err[1], in[0], in[1]}) {
+                    if (fd >= 0) {
+                        close(fd);
+                    }
+                }
+                return false;
+            }
+
+            posix_spawn_file_actions_t actions;
+            posix_spawn_file_actions_init(&actions);
+            if (process.options_.keep_stdin) {
+                posix_spawn_file_actions_adddup2(&actions, in[0], STDIN_FILENO);
+            } else {
+                posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+            }
+            posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+            posix_spawn_file_actions_adddup2(&actions, err[1], STDERR_FILENO);
+            if (!process.options_.cwd.empty()) {
+                posix_spawn_file_actions_addchdir_np(&actions, process.options_.cwd.c_str());
+            }
+            posix_spawnattr_t attr;
+            posix_spawnattr_init(&attr);
+            posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+            posix_spawnattr_setpgroup(&attr, 0);
+
+            std::vector<char *> argv;
+            for (auto &arg : process.argv_) {
+                argv.push_back(arg.data());
+            }
+            argv.push_back(nullptr);
+            auto env_entries = environment(process.options_);
+            std::vector<char *> envp;
+            for (auto &entry : env_entries) {
+                envp.push_back(entry.data());
+            }
+            envp.push_back(nullptr);
+
+            pid_t pid = 0;
+            auto const rc = posix_spawnp(&pid, argv[0], &actions, &attr, argv.data(), envp.data());
+            posix_spawnattr_destroy(&attr);
+            posix_spawn_file_actions_destroy(&actions);
+            close(out[1]);
+            close(err[1]);
+            if (in[0] >= 0) {
+                close(in[0]);
+            }
+            if (rc != 0) {
+                close(out[0]);
+                close(err[0]);
+                if (in[1] >= 0) {
+                    close(in[1]);
+                }
+                process.result_.error = std::format("{}: {}", process.argv_.front(), std::strerror(rc));
+                return false;
+            }
+
+            fcntl(out[0], F_SETFL, O_NONBLOCK);
+            fcntl(err[0], F_SETFL, O_NONBLOCK);
+            process.out_fd_ = out[0];
+            process.err_fd_ = err[0];
+            if (in[1] >= 0) {
+                process.open_stdin(in[1]);
+            }
+            if (process.options_.timeout.count() > 0) {
+                process.deadline_ = std::chrono::steady_clock::now() + process.options_.timeout;
+            }
+            process.started_ = std::chrono::steady_clock::now();
+            process.pid_.store(pid, std::memory_order_release);
+            return true;
+        }
+
+        // Everything available on one pipe; closes it at end of file
+        void drain(Process &process, int &fd, bool is_stdout) {
+            while (fd >= 0) {
+                auto const n = read(fd, buffer_.data(), buffer_.size());
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    return;
+                }
+                if (n <= 0) {
+                    close(fd);
+                    fd = -1;
+                    return;
+                }
+                std::string_view const chunk {buffer_.data(), static_cast<size_t>(n)};
+                auto const &sink = is_stdout ? process.options_.on_stdout : process.options_.on_stderr;
+                if (sink) {
+                    sink(chunk);
+                } else {
+                    (is_stdout ? process.result_.out : process.result_.err).append(chunk);
+                }
+            }
+        }
+
+        static bool reap(Process &process, bool wait) {
+            int status = 0;
+            pid_t done;
+            while ((done = waitpid(process.pid(), &status, wait ? 0 : WNOHANG)) < 0 && errno == EINTR) {
+            }
+            if (done == 0) {
+                return false;
+            }
+            if (done > 0 && WIFEXITED(status)) {
+                process.result_.exit_code = WEXITSTATUS(status);
+            } else if (done > 0 && WIFSIGNALED(status)) {
+                process.result_.signal = WTERMSIG(status);
+            }
+            return true;
+        }
+
+        void run(std::stop_token stoken) {
+            std::vector<std::shared_ptr<Process>> running;
+            std::vector<pollfd> fds;
+            while (!stoken.stop_requested()) {
+                // Start what fits, drop what was killed while it waited
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    for (auto pos = queued_.begin(); pos != queued_.end();) {
+                        auto &process = **pos;
+                        if (auto const sig = process.kill_signal_.load(std::memory_order_acquire)) {
+                            process.result_.signal = sig;
+                            complete(process);
+                            pos = queued_.erase(pos);
+                        } else if (running.size() < max_running_) {
+                            if (start(process)) {
+                                running.push_back(std::move(*pos));
+                            } else {
+                                PROCESS_ERROR_FMT("Could not start a process: {}", process.result_.error);
+                                complete(process);
+                            }
+                            pos = queued_.erase(pos);
+                        } else {
+                            ++pos;
+                        }
+                    }
+                }
+
+                // Signals and deadlines
+                auto const now = std::chrono::steady_clock::now();
+                auto next_deadline = std::chrono::steady_clock::time_point::max();
+                bool reaping = false;
+                for (auto &process : running) {
+                    if (auto const sig = process->kill_signal_.exchange(0, std::memory_order_acq_rel)) {
+                        ::kill(-process->pid(), sig);
+                    }
+                    if (now >= process->deadline_ && !process->result_.timed_out) {
+                        process->result_.timed_out = true;
+                        ::kill(-process->pid(), SIGKILL);
+                    }
+                    if (!process->result_.timed_out) {
+                        next_deadline = std::min(next_deadline, process->deadline_);
+                    }
+                    reaping |= process->out_fd_ < 0 && process->err_fd_ < 0;
+                }
+
+                fds.clear();
+                fds.push_back({wake_fds_[0], POLLIN, 0});
+                for (auto &process : running) {
+                    for (int fd : {process->out_fd_, process->err_fd_}) {
+                        if (fd >= 0) {
+                            fds.push_back({fd, POLLIN, 0});
+                        }
+                    }
+                }
+                // A child that closed its pipes may still be running: look again shortly
+                int timeout = reaping ? 20 : -1;
+                if (next_deadline != std::chrono::steady_clock::time_point::max()) {
+                    auto const until = static_cast<int>(std::max<int64_t>(0,
+                        std::chrono::ceil<std::chrono::milliseconds>(next_deadline - now).count()));
+                    timeout = timeout < 0 ? until : std::min(timeout, until);
+                }
+                if (poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR) {
+                    PROCESS_ERROR_FMT("poll failed: {}", std::strerror(errno));
+                }
+                if (fds.front().revents) {
+                    char bytes[64];
+                    while (read(wake_fds_[0], bytes, sizeof(bytes)) > 0) {
+                    }
+                }
+
+                for (auto &process : running) {
+                    drain(*process, process->out_fd_, true);
+                    drain(*process, process->err_fd_, false);
+                }
+                std::erase_if(running, [](auto const &process) {
+                    if (process->out_fd_ >= 0 || process->err_fd_ >= 0 || !reap(*process, false)) {
+                        return false;
+                    }
+                    complete(*process);
+                    return true;
+                });
+            }
+
+            // Shutting down: nothing outlives the app
+            for (auto &process : running) {
+                ::kill(-process->pid(), SIGKILL);
+                for (int *fd : {&process->out_fd_, &process->err_fd_}) {
+                    if (*fd >= 0) {
+                        close(*fd);
+                        *fd = -1;
+                    }
+                }
+                reap(*process, true);
+                complete(*process);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &process : queued_) {
+                process->result_.error = "Shutting down";
+                complete(*process);
+            }
+            queued_.clear();
+        }
+
+        int wake_fds_[2] {-1, -1};
+        size_t max_running_ {2};
+        std::mutex mutex_;                                  // guards queued_
+        std::deque<std::shared_ptr<Process>> queued_;
+        std::vector<char> buffer_ = std::vector<char>(read_chunk);   // the runner's thread only
+        std::jthread thread_;
+    };
+
+    /**
+     * Start argv[0] (looked up in PATH) with the rest as its arguments; no shell is involved.
+     * The handle kills it and holds its result.
+     */
+    inline std::shared_ptr<Process> spawn(std::vector<std::string> argv, ProcessOptions options = {}) {
+        return ProcessRunner::instance().spawn(std::move(argv), std::move(options));
+    }
+
+    inline std::shared_future<ProcessResult> runAsync(std::vector<std::string> argv, ProcessOptions options = {}) {
+        return spawn(std::move(argv), std::move(options))->result();
+    }
+
+    // Blocking; for worker threads
+    inline ProcessResult run(std::vector<std::string> argv, ProcessOptions options = {}) {
+        return runAsync(std::move(argv), std::move(options)).get();
+    }
+
     /**
      * Execute a command and return its output as a string
-     * 
-     * @param command The command to execute
+     *
+     * @param command The command to execute, through /bin/sh
      * @return The command output as a string, empty string if failed
      */
     inline std::string executeCommand(const std::string& command) {
-        // Create a custom deleter to avoid attributes warning
-        auto pipeDeleter = [](FILE* pipe) {
-            if (pipe) {
-                pclose(pipe);
-            }
-        };
-        
-        // Open a pipe to read the command output using the custom deleter
-        std::unique_ptr<FILE, decltype(pipeDeleter)> pipe(popen(command.c_str(), "r"), pipeDeleter);
-        if (!pipe) {
+        auto result = run({"/bin/sh", "-c", command});
+        if (!result.error.empty()) {
             PROCESS_ERROR_FMT("Error executing command: {}", command);
-            return "";
-        }
-        
-        // Read the output
-        std::array<char, 128> buffer;
-        std::stringstream output;
-        while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr) {
-            output << buffer.data();
         }
-        
-        return output.str();
+        return std::move(result.out);
     }
-    
+
     /**
      * Execute a command in a specific directory and return its output
-     * 
+     *
      * @param directory The directory to execute the command in
-     * @param command The command to execute
+     * @param command The command to execute, through /bin/sh
      * @return The command output as a string, empty string if failed
      */
     inline std::string executeCommandInDirectory(const std::string& directory, const std::string& command) {
-        std::string fullCommand = "cd \"" + directory + "\" && " + command;
-        return executeCommand(fullCommand);
+        ProcessOptions options;
+        options.cwd = directory;
+        return std::move(run({"/bin/sh", "-c", command}, std::move(options)).out);
     }
-}
\ No newline at end of file
+}
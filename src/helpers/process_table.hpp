@@ -0,0 +1,264 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include "compat/sysinfo.hpp"
+#else
+#include <dirent.h>
+#endif
+
+// 3. All other includes
+#include "system_sampler.hpp"
+
+namespace rouen::helpers {
+
+struct process_info {
+    int pid {0};
+    std::string name;
+    char state {'?'};
+    float cpu_percent {0};      // of one CPU, since the previous sample
+    uint64_t rss {0};           // bytes
+};
+
+/**
+ * Every process with its CPU share and resident size, sampled on a background thread. On
+ * Linux each process's /proc/<pid>/stat stays open between samples (up to a quarter of the
+ * descriptor limit; the rest are opened per read) and is pread into a stack buffer: a
+ * refresh is one getdents pass plus one read per process, with no allocation for the ones
+ * already known. CPU% is the difference of the utime+stime counters between samples; a
+ * descriptor whose process has gone fails to read, and a reused pid starts over. On macOS the
+ * same numbers come from libproc, through compat/sysinfo.hpp.
+ *
+ * Runs while someone holds it: shared() hands out the running table.
+ */
+class process_table {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static std::shared_ptr<process_table> shared() {
+        static std::mutex mutex;
+        static std::weak_ptr<process_table> current;
+        std::lock_guard lock(mutex);
+        auto table = current.lock();
+        if (!table) {
+            table = std::make_shared<process_table>();
+            current = table;
+        }
+        return table;
+    }
+
+    process_table() {
+#ifndef __APPLE__
+        ticks_per_second_ = std::max(1L, sysconf(_SC_CLK_TCK));
+        page_size_ = static_cast<uint64_t>(std::max(1L, sysconf(_SC_PAGESIZE)));
+        rlimit limit {};
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+            max_open_ = static_cast<size_t>(limit.rlim_cur) / 4;
+        }
+#endif
+        thread_ = std::jthread([this](std::stop_token stop) { run(stop); });
+    }
+
+    ~process_table() {
+        // The sampler uses the directory handle: it stops first
+        thread_.request_stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+#ifndef __APPLE__
+        if (proc_) {
+            ::closedir(proc_);
+        }
+#endif
+    }
+
+    process_table(const process_table&) = delete;
+    process_table& operator=(const process_table&) = delete;
+
+    void set_interval(std::chrono::milliseconds interval) {
+        interval_ms_ = static_cast<int>(interval.count());
+        wake_.notify_all();
+    }
+
+    // The latest sample, shared until the next one replaces it; compare generation() to tell
+    std::shared_ptr<const std::vector<process_info>> snapshot() const {
+        std::lock_guard lock(snapshot_mutex_);
+        return snapshot_;
+    }
+
+    [[nodiscard]] uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+private:
+    struct tracked {
+        proc_file stat;             // closed past max_open_
+        uint64_t cpu_time {0};      // clock ticks on Linux, nanoseconds on macOS
+        uint64_t seen {0};
+        std::string name;
+    };
+
+    void run(std::stop_token stop) {
+        std::mutex mutex;
+        std::unique_lock lock(mutex);
+        while (!stop.stop_requested()) {
+            sample();
+            auto const interval = interval_ms_.load();
+            wake_.wait_for(lock, stop, std::chrono::milliseconds{interval}, [&] { return interval_ms_.load() != interval; });
+        }
+    }
+
+    void sample() {
+        auto const now = clock::now();
+        auto const elapsed = std::chrono::duration<double>(now - previous_).count();
+        previous_ = now;
+        ++pass_;
+        auto next = std::make_shared<std::vector<process_info>>();
+        next->reserve(processes_.size() + 16);
+
+#ifdef __APPLE__
+        for (auto const& p : compat::list_processes()) {
+            auto [pos, added] = processes_.try_emplace(p.pid);
+            auto& entry = pos->second;
+            auto const delta = added || p.cpu_ns < entry.cpu_time ? 0 : p.cpu_ns - entry.cpu_time;
+            entry.cpu_time = p.cpu_ns;
+            entry.seen = pass_;
+            auto const cpu = elapsed > 0 && !added ? static_cast<float>(100.0 * static_cast<double>(delta) / 1e9 / elapsed) : 0.0f;
+            next->push_back({p.pid, p.name, 'R', cpu, p.rss});
+        }
+#else
+        if (!proc_) {
+            proc_ = ::opendir("/proc");
+            if (!proc_) {
+                return;
+            }
+        }
+        ::rewinddir(proc_);
+        std::array<char, 1024> buffer;
+        while (auto* entry = ::readdir(proc_)) {
+            auto const* name = entry->d_name;
+            if (name[0] < '1' || name[0] > '9') {
+                continue;
+            }
+            int pid = 0;
+            for (auto const* c = name; *c >= '0' && *c <= '9'; ++c) {
+                pid = pid * 10 + (*c - '0');
+            }
+            auto [pos, added] = processes_.try_emplace(pid);
+            auto& process = pos->second;
+            auto text = read_stat(pid, process, buffer);
+            if (!added && text.empty()) {
+                // Gone, or a new process under the same pid: read it afresh
+                forget(process);
+                process = tracked{};
+                added = true;
+                text = read_stat(pid, process, buffer);
+            }
+            // "pid (comm) state ppid ..." where comm may hold spaces and parentheses
+            auto const open = text.find('(');
+            auto const close = text.rfind(')');
+            if (open == std::string_view::npos || close == std::string_view::npos || close + 2 >= text.size()) {
+                forget(process);
+                processes_.erase(pos);
+                continue;
+            }
+            auto const comm = text.substr(open + 1, close - open - 1);
+            if (process.name != comm) {
+                process.name.assign(comm);      // set once, or after an exec()
+            }
+            char const state = text[close + 2];
+            auto fields = text.substr(close + 3);
+            // ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt, then utime stime
+            for (int skip = 0; skip < 10; ++skip) {
+                next_number(fields);
+            }
+            auto const cpu_time = next_number(fields) + next_number(fields);
+            // cutime cstime priority nice num_threads itrealvalue starttime vsize, then rss (pages)
+            for (int skip = 0; skip < 8; ++skip) {
+                next_number(fields);
+            }
+            auto const rss = next_number(fields) * page_size_;
+
+            auto const delta = added || cpu_time < process.cpu_time ? 0 : cpu_time - process.cpu_time;
+            process.cpu_time = cpu_time;
+            process.seen = pass_;
+            auto const cpu = elapsed > 0 && !added
+                ? static_cast<float>(100.0 * static_cast<double>(delta) / static_cast<double>(ticks_per_second_) / elapsed)
+                : 0.0f;
+            next->push_back({pid, process.name, state, cpu, rss});
+        }
+#endif
+        for (auto pos = processes_.begin(); pos != processes_.end();) {
+            if (pos->second.seen == pass_) {
+                ++pos;
+            } else {
+                forget(pos->second);
+                pos = processes_.erase(pos);
+            }
+        }
+        {
+            std::lock_guard lock(snapshot_mutex_);
+            snapshot_ = std::move(next);
+        }
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+
+#ifndef __APPLE__
+    // The process's stat line; empty when it has exited
+    std::string_view read_stat(int pid, tracked& process, std::array<char, 1024>& buffer) {
+        if (process.stat.is_open()) {
+            return process.stat.read(buffer);
+        }
+        auto const path = std::format("/proc/{}/stat", pid);
+        proc_file stat {path.c_str()};
+        auto const text = stat.read(buffer);
+        if (open_ < max_open_ && !text.empty()) {
+            process.stat = std::move(stat);
+            ++open_;
+        }
+        return text;
+    }
+
+    DIR* proc_ {nullptr};
+    long ticks_per_second_ {100};
+    uint64_t page_size_ {4096};
+    size_t max_open_ {256};
+#endif
+
+    void forget(tracked& process) {
+        if (process.stat.is_open()) {
+            --open_;
+        }
+    }
+
+    std::unordered_map<int, tracked> processes_;        // the sampling thread's
+    size_t open_ {0};                                   // stat files kept open
+    uint64_t pass_ {0};
+    clock::time_point previous_ {clock::now()};
+    std::atomic<int> interval_ms_ {1000};
+    mutable std::mutex snapshot_mutex_;
+    std::shared_ptr<const std::vector<process_info>> snapshot_ = std::make_shared<std::vector<process_info>>();
+    std::atomic<uint64_t> generation_ {0};
+    std::condition_variable_any wake_;
+    std::jthread thread_;
+};
+
+} // namespace rouen::helpers
@@ -0,0 +1,167 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "../registrar.hpp"
+
+namespace http {
+
+// Outbound limits for one host, registered as registrar::add<http::host_limit>("api.github.com", …).
+// A key also covers its subdomains ("atlassian.net" applies to every Jira cloud site); "*" is the default.
+struct host_limit {
+    double rate {0};              // requests per second, 0 = unlimited
+    double burst {1};             // requests that may start back to back after an idle period
+    size_t max_in_flight {0};     // concurrent requests, 0 = unlimited
+};
+
+/**
+ * Per-host token bucket and concurrency cap in front of every fetch and engine transfer.
+ *
+ * Requests over the limit are not failed: the engine defers them and the blocking fetch
+ * sleeps until they may go. A 429 or 503 carrying Retry-After holds the whole host back
+ * for that long, so the requests queued behind it do not earn more penalties.
+ */
+class rate_limiter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr auto in_flight_poll = std::chrono::milliseconds(50);
+    static constexpr int max_retries = 3;   // throttled requests queued again before failing
+
+    static rate_limiter& instance() {
+        static rate_limiter limiter;
+        return limiter;
+    }
+
+    // Host part of a URL, without scheme, port or path
+    static std::string host_name(std::string_view url) {
+        auto const scheme_end = url.find("://");
+        auto const host_start = scheme_end == std::string_view::npos ? 0 : scheme_end + 3;
+        return std::string{url.substr(host_start, url.find_first_of(":/?#", host_start) - host_start)};
+    }
+
+    // Zero when a request to `host` may start now (it then holds a slot until release());
+    // otherwise how long to wait before asking again
+    [[nodiscard]] clock::duration try_acquire(std::string const& host) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& b = bucket_for(host);
+        auto const now = clock::now();
+        if (now < b.blocked_until) {
+            return b.blocked_until - now;
+        }
+        if (b.limit.max_in_flight && b.in_flight >= b.limit.max_in_flight) {
+            return in_flight_poll;
+        }
+        if (b.limit.rate > 0) {
+            auto const elapsed = std::chrono::duration<double>(now - b.refilled).count();
+            b.tokens = std::min(std::max(b.limit.burst, 1.0), b.tokens + elapsed * b.limit.rate);
+            b.refilled = now;
+            if (b.tokens < 1) {
+                return std::chrono::duration_cast<clock::duration>(
+                    std::chrono::duration<double>((1 - b.tokens) / b.limit.rate));
+            }
+            b.tokens -= 1;
+        }
+        ++b.in_flight;
+        return clock::duration::zero();
+    }
+
+    // Blocking try_acquire(), for the synchronous fetch
+    void acquire(std::string const& host) {
+        for (auto wait = try_acquire(host); wait > clock::duration::zero(); wait = try_acquire(host)) {
+            std::this_thread::sleep_for(wait);
+        }
+    }
+
+    // How long a throttling answer holds the host back; zero if it is not throttling.
+    // A 429 without Retry-After backs off exponentially with the attempt.
+    static std::chrono::seconds penalty(long status, long long retry_after, int attempt) {
+        if (status == 429) {
+            return std::chrono::seconds{retry_after > 0 ? retry_after : 1LL << std::min(attempt, 5)};
+        }
+        if (status == 503 && retry_after > 0) {
+            return std::chrono::seconds{retry_after};
+        }
+        return std::chrono::seconds{0};
+    }
+
+    // Ends a request started by try_acquire(). A non-zero retry_after (the server's
+    // Retry-After on a 429/503) blocks the host for that long.
+    void release(std::string const& host, std::chrono::seconds retry_after = std::chrono::seconds{0}) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& b = bucket_for(host);
+        if (b.in_flight) {
+            --b.in_flight;
+        }
+        if (retry_after.count() > 0) {
+            b.blocked_until = std::max(b.blocked_until, clock::now() + retry_after);
+            b.tokens = 0;
+        }
+    }
+
+private:
+    struct bucket {
+        host_limit limit;
+        double tokens {0};
+        clock::time_point refilled {};
+        clock::time_point blocked_until {};
+        size_t in_flight {0};
+        uint64_t generation {0};    // registrar generation the limit was resolved at
+    };
+
+    rate_limiter() = default;
+
+    bucket& bucket_for(std::string const& host) {
+        auto [pos, added] = buckets_.try_emplace(host);
+        auto& b = pos->second;
+        auto const generation = registrar::generation();
+        if (added || b.generation != generation) {
+            b.limit = configured(host);
+            b.generation = generation;
+            if (added) {
+                b.tokens = std::max(b.limit.burst, 1.0);
+                b.refilled = clock::now();
+            }
+        }
+        return b;
+    }
+
+    // The most specific registered limit: "a.b.com" before "b.com", then "*"
+    static host_limit configured(std::string_view host) {
+        host_limit result;
+        size_t best = 0;                // length of the best matching key; "*" counts as 0
+        registrar::all<host_limit>([&](std::string const& key, std::shared_ptr<host_limit> limit) {
+            if (!limit) {
+                return;
+            }
+            auto const matches = key == host ||
+                (host.size() > key.size() && host.ends_with(key) && host[host.size() - key.size() - 1] == '.');
+            if (matches && key.size() > best) {
+                result = *limit;
+                best = key.size();
+            } else if (key == "*" && !best) {
+                result = *limit;
+            }
+        });
+        return result;
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, bucket> buckets_;
+};
+
+} // namespace http
@@ -0,0 +1,49 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <atomic>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <SDL.h>
+
+// 3. All other includes
+// None in this file
+
+namespace rouen::helpers {
+
+    // SDL user event used to wake the main loop when something asks for a repaint.
+    // SDL_RegisterEvents is thread-safe, so the first caller (any thread) allocates it.
+    inline Uint32 redraw_event_type() {
+        static Uint32 const type = SDL_RegisterEvents(1);
+        return type;
+    }
+
+    // Set while a redraw event sits in the SDL queue so bursts collapse into one event
+    inline std::atomic<bool>& redraw_pending() {
+        static std::atomic<bool> pending{false};
+        return pending;
+    }
+
+    // Ask the main loop to render another frame. Safe to call from any thread.
+    inline void request_redraw() {
+        if (redraw_pending().exchange(true)) {
+            return;
+        }
+        auto const type = redraw_event_type();
+        if (type == static_cast<Uint32>(-1)) {
+            redraw_pending() = false;
+            return;
+        }
+        SDL_Event event{};
+        event.type = type;
+        if (SDL_PushEvent(&event) < 1) {
+            redraw_pending() = false;
+        }
+    }
+
+    // Called by the main loop once the redraw event has been consumed
+    inline void redraw_consumed() {
+        redraw_pending() = false;
+    }
+
+} // namespace rouen::helpers
@@ -0,0 +1,130 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+// None in this file
+
+namespace rouen::helpers {
+
+/**
+ * Terminal scrollback: the text of every line in one byte arena used as a ring, and a ring
+ * of {offset, length, tag} beside it. Appending never allocates once both are sized; the
+ * oldest lines are dropped when either the line count or the arena is full. A line's text is
+ * kept contiguous (one that would straddle the arena's end starts over at the front), so
+ * line(i) is a string_view into the arena, valid until the next append or clear.
+ *
+ * Limits come from ROUEN_TERMINAL_SCROLLBACK (lines, 100000) and
+ * ROUEN_TERMINAL_SCROLLBACK_MB (arena, 64). Not synchronized: the owner locks.
+ */
+class scrollback_buffer {
+public:
+    struct line_ref {
+        std::string_view text;
+        uint8_t tag;
+    };
+
+    scrollback_buffer() : scrollback_buffer(env_or("ROUEN_TERMINAL_SCROLLBACK", 100000),
+                                            env_or("ROUEN_TERMINAL_SCROLLBACK_MB", 64) << 20) {}
+
+    scrollback_buffer(size_t max_lines, size_t arena_bytes)
+        : arena_size_(std::max<size_t>(arena_bytes, 4096))
+        , arena_(std::make_unique_for_overwrite<char[]>(arena_size_))    // untouched pages stay uncommitted
+        , lines_(std::max<size_t>(max_lines, 1))
+    {}
+
+    void append(std::string_view text, uint8_t tag) {
+        // A line longer than the whole arena keeps its end, like a terminal would show
+        if (text.size() > arena_size_) {
+            text.remove_prefix(text.size() - arena_size_);
+        }
+        auto const capacity = static_cast<uint64_t>(arena_size_);
+        uint64_t start = head_;
+        if (start % capacity + text.size() > capacity) {
+            start += capacity - start % capacity;   // wrap to the front rather than split the text
+        }
+        auto const end = start + text.size();
+
+        // Room in the arena: drop lines whose bytes the new text would overwrite
+        while (count_ > 0 && (count_ == lines_.size() || oldest().offset + capacity < end)) {
+            drop_oldest();
+        }
+        if (!text.empty()) {
+            std::memcpy(arena_.get() + start % capacity, text.data(), text.size());
+            touched_ = std::max<uint64_t>(touched_, start % capacity + text.size());
+        }
+        lines_[(first_index_ + count_) % lines_.size()] = entry{start, static_cast<uint32_t>(text.size()), tag};
+        ++count_;
+        head_ = end;
+    }
+
+    void clear() {
+        dropped_ += count_;
+        count_ = 0;
+        first_index_ = 0;
+        head_ = 0;
+    }
+
+    // Lines held, oldest first
+    [[nodiscard]] size_t size() const { return count_; }
+    [[nodiscard]] bool empty() const { return count_ == 0; }
+    [[nodiscard]] size_t max_lines() const { return lines_.size(); }
+
+    // Memory in use: the arena as far as it has been written, and the line index
+    [[nodiscard]] size_t bytes() const {
+        return static_cast<size_t>(touched_) + lines_.size() * sizeof(entry);
+    }
+
+    // Lines dropped off the front since construction; line i is line number dropped() + i overall
+    [[nodiscard]] uint64_t dropped() const { return dropped_; }
+
+    [[nodiscard]] line_ref line(size_t i) const {
+        auto const& e = lines_[(first_index_ + i) % lines_.size()];
+        return {std::string_view{arena_.get() + e.offset % arena_size_, e.length}, e.tag};
+    }
+
+    [[nodiscard]] line_ref back() const { return line(count_ - 1); }
+
+private:
+    struct entry {
+        uint64_t offset {0};    // in bytes ever appended, arena position modulo its size
+        uint32_t length {0};
+        uint8_t tag {0};
+    };
+
+    static size_t env_or(char const* name, size_t fallback) {
+        auto const spec = std::getenv(name);
+        auto const value = spec ? std::strtoull(spec, nullptr, 10) : 0;
+        return value > 0 ? static_cast<size_t>(value) : fallback;
+    }
+
+    [[nodiscard]] entry const& oldest() const { return lines_[first_index_]; }
+
+    void drop_oldest() {
+        first_index_ = (first_index_ + 1) % lines_.size();
+        --count_;
+        ++dropped_;
+    }
+
+    size_t arena_size_;
+    std::unique_ptr<char[]> arena_;
+    std::vector<entry> lines_;      // ring of count_ entries from first_index_
+    size_t first_index_ {0};
+    size_t count_ {0};
+    uint64_t head_ {0};             // where the next text goes
+    uint64_t dropped_ {0};
+    uint64_t touched_ {0};          // arena bytes ever written to, so committed
+};
+
+} // namespace rouen::helpers
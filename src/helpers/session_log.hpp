@@ -0,0 +1,310 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 2. Libraries used in the project, in alphabetic order
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// 3. All other includes
+#include "debug.hpp"
+
+namespace rouen::helpers {
+
+/**
+ * First occurrence of `needle` in [begin, end), or nullptr; ASCII case folding unless
+ * match_case. With SSE2 it tests 16 positions at a time for the needle's first and last
+ * byte together and only compares the rest where both match, which on ordinary text is
+ * almost never, so it runs at close to memory speed.
+ */
+inline char const* find_bytes(char const* begin, char const* end, std::string_view needle, bool match_case) {
+    auto const n = needle.size();
+    if (n == 0) {
+        return begin;
+    }
+    if (static_cast<size_t>(end - begin) < n) {
+        return nullptr;
+    }
+    auto const fold = [match_case](unsigned char c) { return match_case ? c : static_cast<unsigned char>(std::tolower(c)); };
+    auto const equal = [&](char const* at) {
+        if (match_case) {
+            return std::memcmp(at, needle.data(), n) == 0;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (fold(static_cast<unsigned char>(at[i])) != fold(static_cast<unsigned char>(needle[i]))) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    char const* const last_start = end - n;     // the last position a match can begin at
+    char const* at = begin;
+#if defined(__SSE2__)
+    auto const first = static_cast<unsigned char>(needle.front());
+    auto const last = static_cast<unsigned char>(needle.back());
+    auto const first_lo = _mm_set1_epi8(static_cast<char>(fold(first)));
+    auto const first_up = _mm_set1_epi8(static_cast<char>(match_case ? first : std::toupper(first)));
+    auto const last_lo = _mm_set1_epi8(static_cast<char>(fold(last)));
+    auto const last_up = _mm_set1_epi8(static_cast<char>(match_case ? last : std::toupper(last)));
+    for (; at + 16 <= last_start + 1; at += 16) {
+        auto const heads = _mm_loadu_si128(reinterpret_cast<__m128i const*>(at));
+        auto const tails = _mm_loadu_si128(reinterpret_cast<__m128i const*>(at + n - 1));
+        auto const both = _mm_and_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(heads, first_lo), _mm_cmpeq_epi8(heads, first_up)),
+            _mm_or_si128(_mm_cmpeq_epi8(tails, last_lo), _mm_cmpeq_epi8(tails, last_up)));
+        for (auto mask = static_cast<unsigned>(_mm_movemask_epi8(both)); mask != 0; mask &= mask - 1) {
+            auto const candidate = at + __builtin_ctz(mask);
+            if (equal(candidate)) {
+                return candidate;
+            }
+        }
+    }
+#endif
+    for (; at <= last_start; ++at) {
+        if (equal(at)) {
+            return at;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Append-only record of a terminal session: the text of every line in a file mapped into
+ * memory, '\n' after each, and one tag byte per line beside it. The mapping reserves the
+ * file's largest size (ROUEN_TERMINAL_LOG_MAX_MB, 4096) up front and the file grows under
+ * it, so it never moves and readers need no lock against appends. A background thread
+ * indexes line ends as text arrives; find() searches the whole history with find_bytes.
+ * Set ROUEN_TERMINAL_LOG_DIR to keep one file per terminal there.
+ */
+class session_log {
+public:
+    struct match {
+        uint64_t line;          // counted from the first line appended
+        uint32_t column;        // in bytes
+    };
+
+    static constexpr size_t grow_step = 64ull << 20;
+
+    // A log in ROUEN_TERMINAL_LOG_DIR, or none when unset or it can't be created
+    static std::unique_ptr<session_log> open_from_env(std::string_view name) {
+        auto const dir = std::getenv("ROUEN_TERMINAL_LOG_DIR");
+        if (!dir || !*dir) {
+            return nullptr;
+        }
+        auto const max_mb = std::getenv("ROUEN_TERMINAL_LOG_MAX_MB");
+        auto const max_bytes = (max_mb ? std::strtoull(max_mb, nullptr, 10) : 4096) << 20;
+        try {
+            std::filesystem::create_directories(dir);
+            auto const stamp = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            auto const path = std::filesystem::path{dir} / std::format("{}-{}-{}.log", name, stamp, getpid());
+            return std::make_unique<session_log>(path, max_bytes > 0 ? max_bytes : grow_step);
+        } catch (std::exception const& e) {
+            SYS_ERROR_FMT("No terminal session log in {}: {}", dir, e.what());
+            return nullptr;
+        }
+    }
+
+    session_log(std::filesystem::path path, size_t max_bytes) : path_(std::move(path)), capacity_(max_bytes) {
+        fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), path_.string());
+        }
+        // Address space only; pages exist as the file grows under it
+        void* map = mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) {
+            auto const error = errno;
+            ::close(fd_);
+            throw std::system_error(error, std::generic_category(), "mmap " + path_.string());
+        }
+        data_ = static_cast<char*>(map);
+        indexer_ = std::jthread{[this](std::stop_token stoken) { index_loop(stoken); }};
+    }
+
+    ~session_log() {
+        indexer_.request_stop();
+        wake_.notify_all();
+        if (indexer_.joinable()) {
+            indexer_.join();
+        }
+        munmap(data_, capacity_);
+        // Down from the last grow step to what was written
+        [[maybe_unused]] auto const rc = ftruncate(fd_, static_cast<off_t>(committed_.load()));
+        ::close(fd_);
+    }
+
+    session_log(session_log const&) = delete;
+    session_log& operator=(session_log const&) = delete;
+
+    // One line; newlines inside it become spaces so line numbers match the scrollback's.
+    // Appends come from one writer at a time (the terminal's output lock)
+    void append(std::string_view text, uint8_t tag) {
+        auto const at = committed_.load(std::memory_order_relaxed);
+        if (full_ || at + text.size() + 1 > capacity_) {
+            if (!full_) {
+                SYS_WARN_FMT("Terminal session log {} is full at {} MiB; later output isn't logged", path_.string(), capacity_ >> 20);
+                full_ = true;
+            }
+            return;
+        }
+        if (at + text.size() + 1 > file_size_) {
+            auto const size = std::min(capacity_, std::max(file_size_ + grow_step, at + text.size() + 1));
+            if (ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+                SYS_ERROR_FMT("Could not grow {}: {}", path_.string(), std::strerror(errno));
+                full_ = true;
+                return;
+            }
+            file_size_ = size;
+        }
+        char* const target = data_ + at;
+        std::memcpy(target, text.data(), text.size());
+        for (char* nl = target; (nl = static_cast<char*>(std::memchr(nl, '\n', static_cast<size_t>(target + text.size() - nl)))); ++nl) {
+            *nl = ' ';
+        }
+        target[text.size()] = '\n';
+        {
+            std::unique_lock lock(index_mutex_);
+            tags_.push_back(tag);
+        }
+        committed_.store(at + text.size() + 1, std::memory_order_release);
+        wake_.notify_one();
+    }
+
+    [[nodiscard]] std::filesystem::path const& path() const { return path_; }
+    [[nodiscard]] uint64_t bytes() const { return committed_.load(std::memory_order_acquire); }
+
+    // Lines indexed so far; the indexer keeps up within a few milliseconds
+    [[nodiscard]] uint64_t lines() const {
+        std::shared_lock lock(index_mutex_);
+        return line_ends_.size();
+    }
+
+    // Line i's text and tag, once indexed; the view stays valid as long as the log
+    [[nodiscard]] std::pair<std::string_view, uint8_t> line(uint64_t i) const {
+        std::shared_lock lock(index_mutex_);
+        if (i >= line_ends_.size()) {
+            return {{}, 0};
+        }
+        auto const start = i == 0 ? 0 : line_ends_[i - 1] + 1;
+        return {std::string_view{data_ + start, line_ends_[i] - start}, i < tags_.size() ? tags_[i] : uint8_t{0}};
+    }
+
+    /**
+     * Every match in the history up to now, in order, at most `limit`; stops early when
+     * asked to. Runs on a worker, not the UI thread: appends carry on meanwhile.
+     */
+    std::vector<match> find(std::string_view needle, bool match_case, size_t limit, std::stop_token const& stoken = {}) {
+        std::vector<match> matches;
+        if (needle.empty() || needle.find('\n') != std::string_view::npos) {
+            return matches;
+        }
+        catch_up();
+        auto const end = committed_.load(std::memory_order_acquire);
+
+        // Searched in slices, so a cancel or the limit doesn't wait for the whole log
+        constexpr size_t slice = 16u << 20;
+        std::vector<uint64_t> offsets;
+        for (uint64_t from = 0; from < end && offsets.size() < limit && !stoken.stop_requested();) {
+            auto const to = std::min<uint64_t>(end, from + slice + needle.size() - 1);
+            for (char const* at = data_ + from; offsets.size() < limit;) {
+                at = find_bytes(at, data_ + to, needle, match_case);
+                if (!at) {
+                    break;
+                }
+                offsets.push_back(static_cast<uint64_t>(at - data_));
+                at += needle.size();
+            }
+            from = std::max<uint64_t>(from + slice, offsets.empty() ? 0 : offsets.back() + needle.size());
+        }
+
+        std::shared_lock lock(index_mutex_);
+        matches.reserve(offsets.size());
+        for (auto offset : offsets) {
+            auto const line = static_cast<uint64_t>(std::ranges::upper_bound(line_ends_, offset) - line_ends_.begin());
+            if (line >= line_ends_.size()) {
+                break;
+            }
+            auto const start = line == 0 ? 0 : line_ends_[line - 1] + 1;
+            matches.push_back({line, static_cast<uint32_t>(offset - start)});
+        }
+        return matches;
+    }
+
+private:
+    // Index line ends up to what is committed now
+    void catch_up() {
+        std::lock_guard<std::mutex> scanning(scan_mutex_);
+        auto const end = committed_.load(std::memory_order_acquire);
+        std::vector<uint64_t> ends;
+        for (auto at = indexed_; at < end;) {
+            auto const* nl = static_cast<char const*>(std::memchr(data_ + at, '\n', end - at));
+            if (!nl) {
+                break;  // can't happen: every append ends in one
+            }
+            ends.push_back(static_cast<uint64_t>(nl - data_));
+            at = ends.back() + 1;
+        }
+        indexed_ = end;
+        if (!ends.empty()) {
+            std::unique_lock lock(index_mutex_);
+            line_ends_.insert(line_ends_.end(), ends.begin(), ends.end());
+        }
+    }
+
+    void index_loop(std::stop_token stoken) {
+        std::mutex mutex;
+        std::unique_lock lock(mutex);
+        while (!stoken.stop_requested()) {
+            // Batches whatever arrived meanwhile; a bursty build then costs one scan per wake
+            wake_.wait_for(lock, stoken, std::chrono::milliseconds{50}, [this] {
+                return committed_.load(std::memory_order_acquire) != indexed_seen_;
+            });
+            indexed_seen_ = committed_.load(std::memory_order_acquire);
+            catch_up();
+        }
+    }
+
+    std::filesystem::path path_;
+    size_t capacity_;
+    int fd_ {-1};
+    char* data_ {nullptr};
+    size_t file_size_ {0};                          // the writer's
+    bool full_ {false};                             // the writer's
+    std::atomic<uint64_t> committed_ {0};           // bytes appended; readers never look past it
+
+    std::mutex scan_mutex_;                         // one catch_up at a time
+    uint64_t indexed_ {0};                          // under scan_mutex_
+    uint64_t indexed_seen_ {0};                     // the indexer's
+    mutable std::shared_mutex index_mutex_;         // guards line_ends_ and tags_
+    std::vector<uint64_t> line_ends_;               // offset of each line's '\n'
+    std::vector<uint8_t> tags_;
+    std::condition_variable_any wake_;
+    std::jthread indexer_;
+};
+
+} // namespace rouen::helpers
@@ -1,60 +1,242 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
 #include <format>
 #include <functional>
+#include <memory>
 #include <string>
 #include <stdexcept>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <chrono>
+#include <cstdint>
+#include <exception>
 #include <iostream>
+#include <list>
+#include <unordered_map>
+#include <vector>
 
 #include <sqlite3.h>
 #include "debug.hpp"
+#include "sqlite_profiler.hpp"
+#include "trace.hpp"
 
 namespace hosting::db
 {
+    class catalog;
+
+    // One writer connection plus, once WAL is on, up to ROUEN_SQLITE_READERS (2 by default)
+    // read-only ones opened as reads overlap. for_each_readonly() and query_readonly() go to a
+    // reader, so a long scan and a background write no longer wait on each other, except on
+    // the thread that has a transaction open on the writer, which must see its own changes.
+    // Everything else is serialized on the writer.
     struct sqlite
     {
+        friend class catalog;
+
         sqlite(const std::string &path) : db_path_(path)
         {
             DB_INFO_FMT("Opening SQLite database: {}", path);
-            
+
             // Use a more robust connection mode that allows better concurrency
             int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
-            
-            if (sqlite3_open_v2(path.c_str(), &db_, flags, nullptr) != SQLITE_OK)
+
+            if (sqlite3_open_v2(path.c_str(), &writer_.handle, flags, nullptr) != SQLITE_OK)
             {
                 DB_WARN_FMT("Failed to open DB, creating it: {}", path);
                 // create the database then
                 createDatabase(path.c_str());
             }
-            
+            sqlite3_busy_timeout(writer_.handle, busy_timeout_ms);
+            if (path != ":memory:" && !path.empty()) {
+                remember(path);
+            }
+
             // Configure SQLite for better performance and concurrency
             try {
                 DB_DEBUG_FMT("Setting SQLite PRAGMA settings for: {}", path);
-                exec("PRAGMA journal_mode = WAL");       // Write-ahead logging for better concurrency
+                exec("PRAGMA auto_vacuum = INCREMENTAL");    // Takes on new files only; lets maintenance give space back
+                std::string journal_mode;
+                exec("PRAGMA journal_mode = WAL", [&journal_mode](sqlite3_stmt *stmt) {   // Write-ahead logging for better concurrency
+                    auto mode = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+                    journal_mode = mode ? mode : "";
+                });
                 exec("PRAGMA synchronous = NORMAL");     // Balance between safety and performance
-                exec("PRAGMA cache_size = 10000");       // Larger cache (in pages)
-                exec("PRAGMA temp_store = MEMORY");      // Store temp tables in memory
-                exec("PRAGMA mmap_size = 30000000");     // Memory-mapped I/O (30MB)
+                configure(writer_.handle);
                 DB_DEBUG_FMT("SQLite PRAGMA settings complete for: {}", path);
+
+                // Readers only help when they can read alongside the writer, and see the same database
+                if (journal_mode == "wal" && path != ":memory:" && !path.empty()) {
+                    auto const spec = std::getenv("ROUEN_SQLITE_READERS");
+                    max_readers_ = spec ? static_cast<size_t>(std::strtoul(spec, nullptr, 10)) : size_t{2};
+                    readers_.reserve(max_readers_);
+                }
             } catch (const std::exception& e) {
                 DB_ERROR_FMT("Error setting PRAGMA for {}: {}", path, e.what());
             }
+
+            auto &live = instances();
+            std::lock_guard<std::mutex> lock(live.mutex);
+            live.open.push_back(this);
         }
 
         ~sqlite() {
             DB_INFO_FMT("Closing SQLite database: {}", db_path_);
+            {
+                auto &live = instances();
+                std::lock_guard<std::mutex> lock(live.mutex);
+                std::erase(live.open, this);
+            }
             close();
         }
 
+        /**
+         * Runs `swap` while every sqlite in the process open on `path` is closed, holding their
+         * locks so whoever uses them waits, then opens them again on whatever file is there by
+         * then: the way to replace a database file under the app. Catalog connections that
+         * have the file attached are locked too, and detach it until the swap is over. Refuses, running nothing,
+         * when one of them has a transaction open or a prepare()d statement out, or stays busy
+         * for `patience`; `why` then says which. An exception from `swap` is rethrown once the
+         * connections are open again.
+         */
+        static bool while_closed(std::string const &path, std::function<void()> const &swap, std::string &why,
+                                 std::chrono::milliseconds patience = std::chrono::seconds{5})
+        {
+            std::vector<sqlite *> owners;
+            std::vector<std::pair<sqlite *, std::string>> attachers;   // a catalog connection and the schema the file is under
+            std::vector<std::unique_lock<std::mutex>> locks;
+            auto const give_up = std::chrono::steady_clock::now() + patience;
+            while (true) {
+                {
+                    // Held while the owners are locked, so none of them can be destroyed meanwhile;
+                    // past that a destructor waits on the locks taken here
+                    auto &live = instances();
+                    std::lock_guard<std::mutex> registry(live.mutex);
+                    owners.clear();
+                    attachers.clear();
+                    for (auto *db : live.open) {
+                        std::error_code ec;
+                        if (db->db_path_ != ":memory:" && std::filesystem::equivalent(db->db_path_, path, ec)) {
+                            owners.push_back(db);
+                        }
+                        for (auto const &[schema, file] : db->attached_) {
+                            if (std::filesystem::equivalent(file, path, ec)) {
+                                attachers.emplace_back(db, schema);
+                            }
+                        }
+                    }
+                    // Only try_lock: a caller's thread may hold one of these already
+                    bool all = true;
+                    for (auto *db : owners) {
+                        all = all && lock_all(*db, locks);
+                    }
+                    for (size_t i = 0; i < attachers.size(); ++i) {
+                        auto *db = attachers[i].first;
+                        bool const locked = std::any_of(attachers.begin(), attachers.begin() + static_cast<std::ptrdiff_t>(i),
+                                                        [db](auto const &earlier) { return earlier.first == db; });
+                        all = all && (locked || lock_all(*db, locks));
+                    }
+                    if (all) {
+                        break;
+                    }
+                    locks.clear();
+                }
+                if (std::chrono::steady_clock::now() >= give_up) {
+                    why = "the database stayed busy";
+                    return false;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds{10});
+            }
+
+            std::vector<sqlite *> involved = owners;
+            for (auto const &[db, schema] : attachers) {
+                involved.push_back(db);
+            }
+            for (auto *db : involved) {
+                if (sqlite3_get_autocommit(db->writer_.handle) == 0) {
+                    why = "a transaction is open on it";
+                    return false;
+                }
+                size_t statements = 0;
+                for (auto *stmt = sqlite3_next_stmt(db->writer_.handle, nullptr); stmt; stmt = sqlite3_next_stmt(db->writer_.handle, stmt)) {
+                    ++statements;
+                }
+                if (statements > db->writer_.cached.size()) {
+                    why = "a prepared statement is still out on it";
+                    return false;
+                }
+            }
+
+            // Detached before anything is closed, so a schema that will not let go leaves everything as it was
+            for (size_t i = 0; i < attachers.size(); ++i) {
+                auto const &[db, schema] = attachers[i];
+                if (sqlite3_exec(db->writer_.handle, std::format("DETACH DATABASE {}", schema).c_str(), nullptr, nullptr, nullptr) != SQLITE_OK) {
+                    why = std::format("a catalog connection could not detach it: {}", sqlite3_errmsg(db->writer_.handle));
+                    for (size_t j = 0; j < i; ++j) {
+                        if (!attachers[j].first->attach_locked(path, attachers[j].second).empty()) {
+                            forget_attached(*attachers[j].first, attachers[j].second);
+                        }
+                    }
+                    return false;
+                }
+            }
+
+            DB_INFO_FMT("Closing {} connection(s) to {} to replace the file", owners.size(), path);
+            for (auto *db : owners) {
+                for (auto &reader : db->readers_) {
+                    reader->close();
+                }
+                db->readers_.clear();       // opened again on demand, up to max_readers_
+                db->writer_.close();
+            }
+            std::exception_ptr failed;
+            try {
+                swap();
+            } catch (...) {
+                failed = std::current_exception();
+            }
+            for (auto *db : owners) {
+                db->reopen_writer_locked();
+            }
+            for (auto const &[db, schema] : attachers) {
+                if (auto const error = db->attach_locked(path, schema); !error.empty()) {
+                    DB_WARN_FMT("Could not attach {} as {} again: {}", path, schema, error);
+                    forget_attached(*db, schema);
+                }
+            }
+            locks.clear();
+            if (failed) {
+                std::rethrow_exception(failed);
+            }
+            return true;
+        }
+
         void ensure_table(std::string_view table, std::string_view fields)
         {
             std::string sql = std::format("CREATE TABLE IF NOT EXISTS {} ({})", table, fields);
             exec(sql);
         }
 
+        // Adds a column to an existing table unless it is already there
+        void ensure_column(std::string_view table, std::string_view column, std::string_view type)
+        {
+            bool exists = false;
+            exec(std::format("PRAGMA table_info({})", table), [&exists, column](sqlite3_stmt *stmt) {
+                auto name = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+                exists = exists || (name && column == name);
+            });
+            if (!exists) {
+                exec(std::format("ALTER TABLE {} ADD COLUMN {} {}", table, column, type));
+            }
+        }
+
         void drop_table(std::string_view table)
         {
             std::string sql = std::format("DROP TABLE IF EXISTS {}", table);
@@ -64,48 +246,48 @@ namespace hosting::db
         void createDatabase(const char *dbName)
         {
             int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
-            auto rc = sqlite3_open_v2(dbName, &db_, flags, nullptr);
+            auto rc = sqlite3_open_v2(dbName, &writer_.handle, flags, nullptr);
             if (rc)
             {
                 throw std::runtime_error(std::format("Can't open database: {} - {}",
-                    sqlite3_errmsg(db_), dbName));
+                    sqlite3_errmsg(writer_.handle), dbName));
             }
         }
 
         void close()
         {
             DB_DEBUG_FMT("Acquiring lock to close DB: {}", db_path_);
-            std::lock_guard<std::mutex> lock(mutex_);
-            DB_DEBUG_FMT("Lock acquired, closing DB: {}", db_path_);
-            if (db_)
             {
-                sqlite3_close(db_);
-                db_ = nullptr;
+                std::lock_guard<std::mutex> pool(pool_mutex_);
+                for (auto &reader : readers_) {
+                    std::lock_guard<std::mutex> lock(reader->mutex);
+                    reader->close();
+                }
+                readers_.clear();
+                max_readers_ = 0;
             }
+            std::lock_guard<std::mutex> lock(writer_.mutex);
+            DB_DEBUG_FMT("Lock acquired, closing DB: {}", db_path_);
+            writer_.close();
             DB_DEBUG_FMT("DB closed: {}", db_path_);
         }
 
         void exec(const std::string &sql) {
             DB_TRACE_FMT("Acquiring lock for exec SQL on DB {}: {}...", db_path_, sql.substr(0, 40));
-            std::lock_guard<std::mutex> lock(mutex_);
+            auto const queued = query_profiler::clock::now();
+            std::lock_guard<std::mutex> lock(writer_.mutex);
             DB_TRACE_FMT("Lock acquired, executing SQL on {}", db_path_);
-            
-            // Retry logic for busy database (5 retries with increasing backoff)
-            int retries = 0;
-            int rc;
-            while (retries < 5) {
-                rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, nullptr);
-                if (rc != SQLITE_BUSY && rc != SQLITE_LOCKED) break;
-                
-                DB_WARN_FMT("Database {} busy/locked, retry attempt {}", db_path_, retries+1);
-                // Exponential backoff
-                std::this_thread::sleep_for(std::chrono::milliseconds(50 * (1 << retries)));
-                retries++;
-            }
-            
+
+            // Busy waits happen in SQLite's busy handler (another process holding the lock)
+            auto const started = query_profiler::clock::now();
+            bool const was_autocommit = sqlite3_get_autocommit(writer_.handle) != 0;
+            int rc = sqlite3_exec(writer_.handle, sql.c_str(), nullptr, nullptr, nullptr);
+            track_transaction(was_autocommit);
+            profile(sql, queued, started, 0);
+
             if (rc != SQLITE_OK)
             {
-                std::string error_msg = std::format("SQL error on {}: {}", db_path_, sqlite3_errmsg(db_));
+                std::string error_msg = std::format("SQL error on {}: {}", db_path_, sqlite3_errmsg(writer_.handle));
                 DB_ERROR(error_msg);
                 throw std::runtime_error(error_msg);
             }
@@ -114,84 +296,574 @@ namespace hosting::db
 
         using stmt_callback_t = std::function<void(sqlite3_stmt *)>;
 
-        // a variadic version of exec with callback
+        // a variadic version of exec with callback; arguments are bound in place, not copied,
+        // since they outlive the statement. The statement is compiled on first use and kept
+        // in a small per-connection LRU keyed by its SQL, so hot queries skip the prepare
         template <typename... Args>
-        void exec(const std::string &sql, stmt_callback_t callback, Args... args) {
+        void exec(const std::string &sql, stmt_callback_t callback, Args const&... args) {
+            run(sql, callback, args...);
+        }
+
+        /**
+         * Runs `sql` and calls sink(columns...) for every row, each column read as the type
+         * it is given as, with no std::function in between:
+         *   integral types, bool, floating point    the column's value (0 when NULL)
+         *   std::string                             a copy of the text ("" when NULL)
+         *   std::string_view, char const*           the text in place, valid only during the call
+         *                                           ("" or nullptr when NULL)
+         *   std::optional<T>                        nullopt when NULL, else as T
+         * A sink that returns bool stops the query by returning false.
+         *
+         *   db.for_each<long long, std::string_view>("SELECT id, url FROM feed", [](long long id, std::string_view url) { ... });
+         */
+        template <typename... Columns, typename Sink, typename... Args>
+        void for_each(const std::string &sql, Sink &&sink, Args const&... args) {
+            run(sql, row_sink<Columns...>(sink), args...);
+        }
+
+        // for_each() on a read-only connection, for reads that should not wait on writes (long
+        // scans, lookups from the UI). It runs on the writer when there are no readers (not in
+        // WAL, or ROUEN_SQLITE_READERS=0) and on the thread with a transaction open there.
+        // A write in `sql` fails: the readers are opened read-only
+        template <typename... Columns, typename Sink, typename... Args>
+        void for_each_readonly(const std::string &sql, Sink &&sink, Args const&... args) {
+            read(sql, row_sink<Columns...>(sink), args...);
+        }
+
+        // Every row of `sql` as a tuple of owned values (see for_each for the column types)
+        template <typename... Columns, typename... Args>
+        std::vector<std::tuple<Columns...>> query(const std::string &sql, Args const&... args) {
+            static_assert(((!std::is_same_v<Columns, std::string_view> && !std::is_same_v<Columns, char const *>) && ...),
+                          "query() keeps rows past the statement; read text columns as std::string, or use for_each");
+            std::vector<std::tuple<Columns...>> rows;
+            for_each<Columns...>(sql, [&rows](Columns... values) {
+                rows.emplace_back(std::move(values)...);
+            }, args...);
+            return rows;
+        }
+
+        // query() on a read-only connection (see for_each_readonly)
+        template <typename... Columns, typename... Args>
+        std::vector<std::tuple<Columns...>> query_readonly(const std::string &sql, Args const&... args) {
+            static_assert(((!std::is_same_v<Columns, std::string_view> && !std::is_same_v<Columns, char const *>) && ...),
+                          "query_readonly() keeps rows past the statement; read text columns as std::string, or use for_each_readonly");
+            std::vector<std::tuple<Columns...>> rows;
+            for_each_readonly<Columns...>(sql, [&rows](Columns... values) {
+                rows.emplace_back(std::move(values)...);
+            }, args...);
+            return rows;
+        }
+
+        // A statement compiled once and run many times, e.g. once per row of a batch. It runs
+        // on the writer, inside whatever transaction is open there (or one it opens itself)
+        class statement
+        {
+        public:
+            statement(sqlite &db, const std::string &sql) : db_(&db), sql_(sql)
+            {
+                std::lock_guard<std::mutex> lock(db.writer_.mutex);
+                stmt_ = db.prepare_locked(db.writer_.handle, sql);
+            }
+
+            ~statement()
+            {
+                if (stmt_) {
+                    sqlite3_finalize(stmt_);
+                }
+            }
+
+            statement(statement &&other) noexcept : db_(other.db_), sql_(std::move(other.sql_)), stmt_(std::exchange(other.stmt_, nullptr)) {}
+            statement(statement const &) = delete;
+            statement &operator=(statement const &) = delete;
+
+            template <typename... Args>
+            void run(stmt_callback_t callback, Args const&... args)
+            {
+                auto const queued = query_profiler::clock::now();
+                std::lock_guard<std::mutex> lock(db_->writer_.mutex);
+                auto const started = query_profiler::clock::now();
+                bool const was_autocommit = sqlite3_get_autocommit(db_->writer_.handle) != 0;
+                uint64_t rows = 0;
+                try {
+                    rows = db_->bind_and_step(db_->writer_.handle, stmt_, callback, args...);
+                } catch (...) {
+                    sqlite::reset(stmt_);
+                    db_->track_transaction(was_autocommit);
+                    db_->profile(sql_, queued, started, rows);
+                    throw;
+                }
+                sqlite::reset(stmt_);
+                db_->track_transaction(was_autocommit);
+                db_->profile(sql_, queued, started, rows);
+            }
+
+        private:
+            sqlite *db_;
+            std::string sql_;
+            sqlite3_stmt *stmt_ {nullptr};
+        };
+
+        statement prepare(const std::string &sql)
+        {
+            return statement{*this, sql};
+        }
+
+        // Every database file opened so far, in opening order, and a count bumped as files are added (see catalog)
+        static std::pair<std::vector<std::string>, uint64_t> opened_files()
+        {
+            auto &known = known_files();
+            std::lock_guard<std::mutex> lock(known.mutex);
+            return {known.paths, known.generation};
+        }
+
+        long long last_insert_rowid() const {
+            std::lock_guard<std::mutex> lock(writer_.mutex);
+            return sqlite3_last_insert_rowid(writer_.handle);
+        }
+
+    private:
+        static constexpr size_t statement_cache_size = 64;
+        static constexpr int busy_timeout_ms = 5000;
+
+        // A handle, its lock and its compiled statements
+        struct connection
+        {
+            sqlite3 *handle {nullptr};
+            std::mutex mutex;
+            std::list<std::pair<std::string, sqlite3_stmt *>> cached;     // most recently used first
+            std::unordered_map<std::string, std::list<std::pair<std::string, sqlite3_stmt *>>::iterator> index;
+
+            // Caller holds mutex
+            void close()
+            {
+                for (auto &[sql, stmt] : cached) {
+                    sqlite3_finalize(stmt);
+                }
+                cached.clear();
+                index.clear();
+                if (handle) {
+                    sqlite3_close(handle);
+                    handle = nullptr;
+                }
+            }
+        };
+
+        struct instance_list
+        {
+            std::mutex mutex;
+            std::vector<sqlite *> open;
+        };
+
+        // Every sqlite alive, for while_closed()
+        static instance_list &instances()
+        {
+            static instance_list list;
+            return list;
+        }
+
+        struct file_list
+        {
+            std::mutex mutex;
+            std::vector<std::string> paths;
+            uint64_t generation {0};
+        };
+
+        static file_list &known_files()
+        {
+            static file_list files;
+            return files;
+        }
+
+        static void remember(std::string const &path)
+        {
+            auto &known = known_files();
+            std::lock_guard<std::mutex> lock(known.mutex);
+            if (std::find(known.paths.begin(), known.paths.end(), path) == known.paths.end()) {
+                known.paths.push_back(path);
+                ++known.generation;
+            }
+        }
+
+        // For catalog: ATTACHes `path` as `schema` and lists it where while_closed() looks
+        bool attach(std::string const &path, std::string const &schema, std::string &why)
+        {
+            std::lock_guard<std::mutex> lock(writer_.mutex);
+            why = attach_locked(path, schema);
+            if (!why.empty()) {
+                return false;
+            }
+            auto &live = instances();
+            std::lock_guard<std::mutex> registry(live.mutex);
+            attached_.emplace_back(schema, path);
+            return true;
+        }
+
+        // What is attached, as (schema, file)
+        std::vector<std::pair<std::string, std::string>> attachments() const
+        {
+            auto &live = instances();
+            std::lock_guard<std::mutex> registry(live.mutex);
+            return attached_;
+        }
+
+        // Caller holds writer_.mutex; the reason it failed, empty if it did not
+        std::string attach_locked(std::string const &path, std::string const &schema)
+        {
+            // ? can't stand for the schema name, only for the file
+            auto const sql = std::format("ATTACH DATABASE ? AS {}", schema);
+            sqlite3_stmt *stmt = nullptr;
+            int rc = sqlite3_prepare_v2(writer_.handle, sql.c_str(), -1, &stmt, nullptr);
+            if (rc == SQLITE_OK) {
+                sqlite3_bind_text(stmt, 1, path.c_str(), -1, SQLITE_TRANSIENT);
+                rc = sqlite3_step(stmt);
+            }
+            std::string error = rc == SQLITE_OK || rc == SQLITE_DONE ? std::string{} : sqlite3_errmsg(writer_.handle);
+            sqlite3_finalize(stmt);
+            if (error.empty()) {
+                auto const budget = cache_budget_kib();
+                auto const pages = budget > 0 ? std::format("-{}", budget) : std::string{"10000"};
+                sqlite3_exec(writer_.handle, std::format("PRAGMA {}.cache_size = {}", schema, pages).c_str(), nullptr, nullptr, nullptr);
+            }
+            return error;
+        }
+
+        // A schema while_closed() could not attach again: the catalog tries it afresh on its next use
+        static void forget_attached(sqlite &db, std::string const &schema)
+        {
+            {
+                auto &live = instances();
+                std::lock_guard<std::mutex> registry(live.mutex);
+                std::erase_if(db.attached_, [&schema](auto const &entry) { return entry.first == schema; });
+            }
+            auto &known = known_files();
+            std::lock_guard<std::mutex> lock(known.mutex);
+            ++known.generation;
+        }
+
+        // Adds the locks of `db`'s pool, readers and writer to `locks` if it can have them all now
+        static bool lock_all(sqlite &db, std::vector<std::unique_lock<std::mutex>> &locks)
+        {
+            std::unique_lock<std::mutex> pool(db.pool_mutex_, std::try_to_lock);
+            if (!pool.owns_lock()) {
+                return false;
+            }
+            locks.push_back(std::move(pool));
+            for (auto &reader : db.readers_) {
+                std::unique_lock<std::mutex> lock(reader->mutex, std::try_to_lock);
+                if (!lock.owns_lock()) {
+                    return false;
+                }
+                locks.push_back(std::move(lock));
+            }
+            std::unique_lock<std::mutex> writer(db.writer_.mutex, std::try_to_lock);
+            if (!writer.owns_lock()) {
+                return false;
+            }
+            locks.push_back(std::move(writer));
+            return true;
+        }
+
+        // Caller holds writer_.mutex; the writer as the constructor sets it up, on the file now at db_path_
+        void reopen_writer_locked()
+        {
+            int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX;
+            if (sqlite3_open_v2(db_path_.c_str(), &writer_.handle, flags, nullptr) != SQLITE_OK) {
+                DB_ERROR_FMT("Failed to reopen {}: {}", db_path_, writer_.handle ? sqlite3_errmsg(writer_.handle) : "out of memory");
+                return;
+            }
+            sqlite3_busy_timeout(writer_.handle, busy_timeout_ms);
+            sqlite3_exec(writer_.handle, "PRAGMA journal_mode = WAL", nullptr, nullptr, nullptr);
+            sqlite3_exec(writer_.handle, "PRAGMA synchronous = NORMAL", nullptr, nullptr, nullptr);
+            configure(writer_.handle);
+            transaction_owner_.store(std::thread::id{}, std::memory_order_relaxed);
+        }
+
+        // ROUEN_SQLITE_CACHE_MB: one page-cache budget for the process instead of 10000 pages
+        // per connection. Set as SQLite's soft heap limit, past which every connection's
+        // cache gives pages back; a single connection may still use all of the budget
+        static int64_t cache_budget_kib()
+        {
+            static int64_t const budget = [] {
+                auto const spec = std::getenv("ROUEN_SQLITE_CACHE_MB");
+                auto const mb = spec ? std::strtoll(spec, nullptr, 10) : 0;
+                if (mb > 0) {
+                    sqlite3_soft_heap_limit64(mb << 20);
+                    DB_INFO_FMT("SQLite page cache budget: {} MB", mb);
+                }
+                return mb > 0 ? mb << 10 : int64_t{0};
+            }();
+            return budget;
+        }
+
+        static void configure(sqlite3 *handle)
+        {
+            if (auto const budget = cache_budget_kib(); budget > 0) {
+                sqlite3_exec(handle, std::format("PRAGMA cache_size = -{}", budget).c_str(), nullptr, nullptr, nullptr);
+            } else {
+                sqlite3_exec(handle, "PRAGMA cache_size = 10000", nullptr, nullptr, nullptr);  // Larger cache (in pages)
+            }
+            sqlite3_exec(handle, "PRAGMA temp_store = MEMORY", nullptr, nullptr, nullptr);     // Store temp tables in memory
+            sqlite3_exec(handle, "PRAGMA mmap_size = 30000000", nullptr, nullptr, nullptr);    // Memory-mapped I/O (30MB)
+        }
+
+        // Caller holds writer_.mutex, after anything that ran on the writer: notes which thread
+        // a transaction opened there (BEGIN, in whichever way it ran) belongs to
+        void track_transaction(bool was_autocommit)
+        {
+            bool const autocommit = sqlite3_get_autocommit(writer_.handle) != 0;
+            if (autocommit) {
+                transaction_owner_.store(std::thread::id{}, std::memory_order_relaxed);
+            } else if (was_autocommit) {
+                transaction_owner_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+            }
+        }
+
+        // A locked reader, or none when the read must (or may as well) run on the writer:
+        // a free reader first, a new one while under the limit, else waits for one in turn
+        std::pair<connection *, std::unique_lock<std::mutex>> acquire_reader()
+        {
+            if (transaction_owner_.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+                return {};
+            }
+            connection *wait_for = nullptr;
+            {
+                std::lock_guard<std::mutex> pool(pool_mutex_);
+                if (max_readers_ == 0) {
+                    return {};
+                }
+                for (auto &reader : readers_) {
+                    std::unique_lock<std::mutex> lock(reader->mutex, std::try_to_lock);
+                    if (lock.owns_lock()) {
+                        return {reader.get(), std::move(lock)};
+                    }
+                }
+                if (readers_.size() < max_readers_) {
+                    if (auto reader = open_reader(); reader) {
+                        std::unique_lock<std::mutex> lock(reader->mutex);
+                        auto *opened = reader.get();
+                        readers_.push_back(std::move(reader));
+                        return {opened, std::move(lock)};
+                    }
+                    max_readers_ = readers_.size();     // do with the ones there are
+                    if (readers_.empty()) {
+                        return {};
+                    }
+                }
+                wait_for = readers_[next_reader_++ % readers_.size()].get();
+            }
+            return {wait_for, std::unique_lock<std::mutex>(wait_for->mutex)};
+        }
+
+        std::unique_ptr<connection> open_reader()
+        {
+            auto reader = std::make_unique<connection>();
+            int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX;
+            if (sqlite3_open_v2(db_path_.c_str(), &reader->handle, flags, nullptr) != SQLITE_OK) {
+                DB_WARN_FMT("Failed to open read connection on {}: {}", db_path_,
+                    reader->handle ? sqlite3_errmsg(reader->handle) : "out of memory");
+                reader->close();
+                return nullptr;
+            }
+            sqlite3_busy_timeout(reader->handle, busy_timeout_ms);
+            configure(reader->handle);
+            DB_DEBUG_FMT("Opened read connection {} on {}", readers_.size() + 1, db_path_);
+            return reader;
+        }
+
+        // Binds and steps `sql` on the writer
+        template <typename Callback, typename... Args>
+        void run(const std::string &sql, Callback const &callback, Args const&... args) {
             DB_TRACE_FMT("Acquiring lock for exec SQL with callback on DB {}: {}...", db_path_, sql.substr(0, 40));
-            std::lock_guard<std::mutex> lock(mutex_);
+            auto const queued = query_profiler::clock::now();
+            std::unique_lock<std::mutex> lock(writer_.mutex);
+            step_locked(writer_, sql, queued, callback, args...);
+        }
+
+        // Binds and steps `sql` on a reader when it can go to one, else on the writer
+        template <typename Callback, typename... Args>
+        void read(const std::string &sql, Callback const &callback, Args const&... args) {
+            DB_TRACE_FMT("Acquiring a reader for SQL on DB {}: {}...", db_path_, sql.substr(0, 40));
+            auto const queued = query_profiler::clock::now();
+            auto [target, lock] = acquire_reader();
+            if (!target) {
+                target = &writer_;
+                lock = std::unique_lock<std::mutex>(writer_.mutex);
+            }
+            step_locked(*target, sql, queued, callback, args...);
+        }
+
+        // Caller holds target's mutex; on the writer, also keeps track of the transaction
+        template <typename Callback, typename... Args>
+        void step_locked(connection &target, const std::string &sql, query_profiler::clock::time_point queued,
+                         Callback const &callback, Args const&... args) {
             DB_TRACE_FMT("Lock acquired, preparing statement for SQL on {}", db_path_);
-            
+            auto const started = query_profiler::clock::now();
+            bool const on_writer = &target == &writer_;
+            bool const was_autocommit = sqlite3_get_autocommit(target.handle) != 0;
+            sqlite3_stmt *stmt = cached_locked(target, sql);
+
+            uint64_t rows = 0;
+            try {
+                rows = bind_and_step(target.handle, stmt, callback, args...);
+            } catch (...) {
+                reset(stmt);
+                if (on_writer) {
+                    track_transaction(was_autocommit);
+                }
+                profile(sql, queued, started, rows);
+                throw;
+            }
+            reset(stmt);
+            if (on_writer) {
+                track_transaction(was_autocommit);
+            }
+            profile(sql, queued, started, rows);
+            DB_TRACE_FMT("SQL execution with callback complete on {}", db_path_);
+        }
+
+        // A sink(columns...) as a statement callback (see for_each)
+        template <typename... Columns, typename Sink>
+        static auto row_sink(Sink &sink)
+        {
+            return [&sink](sqlite3_stmt *stmt) {
+                return [&]<size_t... I>(std::index_sequence<I...>) {
+                    return sink(column<Columns>(stmt, static_cast<int>(I))...);
+                }(std::index_sequence_for<Columns...>{});
+            };
+        }
+
+        template <typename T>
+        struct is_optional : std::false_type {};
+        template <typename T>
+        struct is_optional<std::optional<T>> : std::true_type {};
+
+        template <typename T>
+        static T column(sqlite3_stmt *stmt, int index)
+        {
+            if constexpr (is_optional<T>::value) {
+                if (sqlite3_column_type(stmt, index) == SQLITE_NULL) {
+                    return std::nullopt;
+                }
+                return column<typename T::value_type>(stmt, index);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                return sqlite3_column_int(stmt, index) != 0;
+            } else if constexpr (std::is_integral_v<T>) {
+                if constexpr (sizeof(T) <= sizeof(int)) {
+                    return static_cast<T>(sqlite3_column_int(stmt, index));
+                } else {
+                    return static_cast<T>(sqlite3_column_int64(stmt, index));
+                }
+            } else if constexpr (std::is_floating_point_v<T>) {
+                return static_cast<T>(sqlite3_column_double(stmt, index));
+            } else if constexpr (std::is_same_v<T, char const *>) {
+                return reinterpret_cast<char const *>(sqlite3_column_text(stmt, index));
+            } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+                // The text first: asking for it can convert the value, and with it its length
+                auto text = reinterpret_cast<char const *>(sqlite3_column_text(stmt, index));
+                if (!text) {
+                    return T{};
+                }
+                return T{text, static_cast<size_t>(sqlite3_column_bytes(stmt, index))};
+            } else {
+                static_assert(sizeof(T) != sizeof(T), "Unsupported column type");
+            }
+        }
+
+        // Ready for the next run; the bindings pointed into the last run's arguments
+        static void reset(sqlite3_stmt *stmt)
+        {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+
+        // Caller holds the connection's mutex; the cached statement for `sql`, prepared on a
+        // miss. The least recently used one is finalized once the cache is full
+        sqlite3_stmt *cached_locked(connection &target, const std::string &sql)
+        {
+            if (auto pos = target.index.find(sql); pos != target.index.end()) {
+                target.cached.splice(target.cached.begin(), target.cached, pos->second);
+                return pos->second->second;
+            }
+            sqlite3_stmt *stmt = prepare_locked(target.handle, sql);
+            if (target.cached.size() >= statement_cache_size) {
+                sqlite3_finalize(target.cached.back().second);
+                target.index.erase(target.cached.back().first);
+                target.cached.pop_back();
+            }
+            target.cached.emplace_front(sql, stmt);
+            target.index.emplace(sql, target.cached.begin());
+            return stmt;
+        }
+
+        // Caller holds the connection's mutex
+        sqlite3_stmt *prepare_locked(sqlite3 *handle, const std::string &sql)
+        {
             sqlite3_stmt *stmt = nullptr;
-            int prepare_retries = 0;
-            int prepare_rc;
-            
-            // Retry prepare if database is busy
-            while (prepare_retries < 5) {
-                prepare_rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
-                if (prepare_rc != SQLITE_BUSY && prepare_rc != SQLITE_LOCKED) break;
-                
-                DB_WARN_FMT("Database {} busy/locked during prepare, retry attempt {}", db_path_, prepare_retries+1);
-                std::this_thread::sleep_for(std::chrono::milliseconds(50 * (1 << prepare_retries)));
-                prepare_retries++;
-            }
-            
-            if (prepare_rc != SQLITE_OK) {
-                std::string error_msg = std::format("Failed to prepare statement on {}: {}", db_path_, sqlite3_errmsg(db_));
+            if (sqlite3_prepare_v2(handle, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+                std::string error_msg = std::format("Failed to prepare statement on {}: {}", db_path_, sqlite3_errmsg(handle));
                 DB_ERROR(error_msg);
                 throw std::runtime_error(error_msg);
             }
+            return stmt;
+        }
 
-            try {
-                int index = 1;
-                (bind_param(stmt, index++, args), ...);
-
-                int step_retries = 0;
-                int step_rc;
-                
-                while (true) {
-                    step_retries = 0;
-                    while (step_retries < 5) {
-                        step_rc = sqlite3_step(stmt);
-                        if (step_rc != SQLITE_BUSY && step_rc != SQLITE_LOCKED) break;
-                        
-                        DB_WARN_FMT("Database {} busy/locked during step, retry attempt {}", db_path_, step_retries+1);
-                        std::this_thread::sleep_for(std::chrono::milliseconds(50 * (1 << step_retries)));
-                        step_retries++;
+        // Caller holds the connection's mutex; binds the arguments and steps through every row,
+        // or until a callback that returns bool returns false. The rows stepped
+        template <typename Callback, typename... Args>
+        uint64_t bind_and_step(sqlite3 *handle, sqlite3_stmt *stmt, Callback const &callback, Args const&... args)
+        {
+            int index = 1;
+            (bind_param(stmt, index++, args), ...);
+
+            int step_rc;
+            uint64_t rows = 0;
+            while (true) {
+                step_rc = sqlite3_step(stmt);
+                if (step_rc != SQLITE_ROW) {
+                    break;
+                }
+                ++rows;
+                if constexpr (std::is_same_v<Callback, stmt_callback_t>) {
+                    if (!callback) {
+                        break;
                     }
-                    
-                    if (step_rc == SQLITE_ROW && callback) {
-                        callback(stmt);
-                    } else {
+                    callback(stmt);
+                } else if constexpr (std::is_same_v<std::invoke_result_t<Callback const &, sqlite3_stmt *>, bool>) {
+                    if (!callback(stmt)) {
                         break;
                     }
+                } else {
+                    callback(stmt);
                 }
-                
-                if (step_rc != SQLITE_DONE && step_rc != SQLITE_ROW && step_rc != SQLITE_OK) {
-                    std::string error_msg = std::format("SQL error during step on {}: {}", db_path_, sqlite3_errmsg(db_));
-                    DB_ERROR(error_msg);
-                    throw std::runtime_error(error_msg);
-                }
-            } catch (...) {
-                sqlite3_finalize(stmt);
-                throw;
             }
 
-            if (sqlite3_finalize(stmt) != SQLITE_OK) {
-                std::string error_msg = std::format("SQL error during finalize on {}: {}", db_path_, sqlite3_errmsg(db_));
+            if (step_rc != SQLITE_DONE && step_rc != SQLITE_ROW && step_rc != SQLITE_OK) {
+                std::string error_msg = std::format("SQL error during step on {}: {}", db_path_, sqlite3_errmsg(handle));
                 DB_ERROR(error_msg);
                 throw std::runtime_error(error_msg);
             }
-            DB_TRACE_FMT("SQL execution with callback complete on {}", db_path_);
+            return rows;
         }
 
-        long long last_insert_rowid() const {
-            std::lock_guard<std::mutex> lock(mutex_);
-            return sqlite3_last_insert_rowid(db_);
+        // Times for the profiler: `queued` when the lock was asked for, `started` once held
+        void profile(std::string const &sql, query_profiler::clock::time_point queued, query_profiler::clock::time_point started, uint64_t rows) const
+        {
+            auto const now = query_profiler::clock::now();
+            auto const &profiler = query_profiler::shared();
+            if (profiler->enabled()) {
+                profiler->record(db_path_, sql, started - queued, now - started, rows);
+            }
+            if (rouen::helpers::trace::enabled()) {
+                // Waits under a tenth of a millisecond would only clutter the trace
+                if (started - queued > std::chrono::microseconds{100}) {
+                    rouen::helpers::trace::complete("SQLITE", "lock wait", queued, started, db_path_);
+                }
+                rouen::helpers::trace::complete("SQLITE", "sql", started, now, sql);
+            }
         }
-        
-    private:
+
         template <typename T>
-        void bind_param(sqlite3_stmt *stmt, int index, T value) {
+        void bind_param(sqlite3_stmt *stmt, int index, T const& value) {
             if constexpr (std::is_integral_v<T>) {
                 if constexpr (sizeof(T) <= sizeof(int)) {
                     sqlite3_bind_int(stmt, index, value);
@@ -201,13 +873,13 @@ namespace hosting::db
             } else if constexpr (std::is_floating_point_v<T>) {
                 sqlite3_bind_double(stmt, index, value);
             } else if constexpr (std::is_same_v<T, std::string>) {
-                sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+                sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
             } else if constexpr (std::is_same_v<T, std::string_view>) {
                 // Handle null or empty string_view specially
                 if (value.data() == nullptr || value.empty()) {
                     sqlite3_bind_null(stmt, index);
                 } else {
-                    sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+                    sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
                 }
             } else {
                 // Fix always_false implementation to properly trigger a compile-time error
@@ -215,8 +887,13 @@ namespace hosting::db
             }
         }
 
-        sqlite3 *db_ {nullptr};
-        mutable std::mutex mutex_;  // Protect concurrent access
+        mutable connection writer_;
+        std::atomic<std::thread::id> transaction_owner_ {};
+        std::mutex pool_mutex_;                              // guards readers_ and its limits
+        std::vector<std::unique_ptr<connection>> readers_;
+        size_t max_readers_ {0};
+        size_t next_reader_ {0};
         std::string db_path_;       // Keep path for debug info
+        std::vector<std::pair<std::string, std::string>> attached_;   // (schema, file) a catalog ATTACHed; guarded by instances().mutex
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <sqlite3.h>
+
+// 3. All other includes
+#include "debug.hpp"
+#include "sqlite.hpp"
+
+namespace hosting::db
+{
+    /**
+     * One connection per thread with every database the app has opened ATTACHed to it under
+     * the stem of its file name (rss, rss_images, travel, email_metadata, ...), for queries
+     * across subsystems:
+     *
+     *   if (catalog::has("email_metadata")) {
+     *       catalog::connection().for_each<std::string_view, std::string_view>(
+     *           "SELECT i.title, m.subject FROM rss.feed_item i JOIN email_metadata.emails m ON ...", sink);
+     *   }
+     *
+     * The connection is a plain sqlite on ":memory:", so typed rows, the statement cache and
+     * the profiler come with it; files opened after it was made are attached on its next use.
+     * It is meant for reads: writes belong to the subsystem's own sqlite and write-behind.
+     * sqlite::while_closed() detaches a file from every catalog while it is replaced.
+     *
+     * SQLite caps how many databases one connection can attach (SQLITE_MAX_ATTACHED, 10
+     * unless it was built with more); the limit is raised as far as the build allows, and
+     * files past it stay out with an error in the log. has() is how a query finds out.
+     *
+     * Together with ROUEN_SQLITE_READERS=0 (no per-file read pool) and ROUEN_SQLITE_CACHE_MB
+     * (one page-cache budget) it is the consolidated mode: one read connection per thread
+     * instead of one per file and thread.
+     */
+    class catalog
+    {
+    public:
+        static sqlite &connection()
+        {
+            thread_local catalog mine;
+            mine.attach_new();
+            return *mine.db_;
+        }
+
+        // Whether this thread's connection has `schema` attached
+        static bool has(std::string_view schema)
+        {
+            auto const attached = connection().attachments();
+            return std::any_of(attached.begin(), attached.end(), [schema](auto const &entry) { return entry.first == schema; });
+        }
+
+        // The schema name a file is attached under, unless another file took it first
+        static std::string alias_of(std::string const &path)
+        {
+            std::string alias;
+            for (char c : std::filesystem::path{path}.stem().string()) {
+                alias += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+            }
+            if (alias.empty() || std::isdigit(static_cast<unsigned char>(alias.front()))) {
+                alias.insert(alias.begin(), '_');
+            }
+            return alias;
+        }
+
+    private:
+        catalog() : db_(std::make_unique<sqlite>(":memory:"))
+        {
+            // Asking for more than the build allows gets what it allows
+            std::lock_guard<std::mutex> lock(db_->writer_.mutex);
+            sqlite3_limit(db_->writer_.handle, SQLITE_LIMIT_ATTACHED, 125);
+            limit_ = static_cast<size_t>(std::max(0, sqlite3_limit(db_->writer_.handle, SQLITE_LIMIT_ATTACHED, -1)));
+        }
+
+        void attach_new()
+        {
+            auto [paths, generation] = sqlite::opened_files();
+            if (generation == generation_) {
+                return;
+            }
+            generation_ = generation;
+            auto attached = db_->attachments();
+            for (auto const &path : paths) {
+                auto const known = std::any_of(attached.begin(), attached.end(), [&path](auto const &entry) { return entry.second == path; });
+                if (known || left_out_.contains(path)) {
+                    continue;
+                }
+                if (attached.size() >= limit_) {
+                    DB_ERROR_FMT("Not attaching {}: SQLite allows {} attached databases per connection", path, limit_);
+                    left_out_.insert(path);
+                    continue;
+                }
+                auto const base = alias_of(path);
+                auto alias = base;
+                for (int n = 2; std::any_of(attached.begin(), attached.end(), [&alias](auto const &entry) { return entry.first == alias; }); ++n) {
+                    alias = std::format("{}_{}", base, n);
+                }
+                std::string why;
+                if (!db_->attach(path, alias, why)) {
+                    DB_WARN_FMT("Could not attach {} as {}: {}", path, alias, why);
+                    left_out_.insert(path);
+                    continue;
+                }
+                DB_DEBUG_FMT("Attached {} as {}", path, alias);
+                attached.emplace_back(std::move(alias), path);
+            }
+        }
+
+        std::unique_ptr<sqlite> db_;
+        std::unordered_set<std::string> left_out_;      // past the limit or failed: not tried again
+        size_t limit_ {0};
+        uint64_t generation_ {0};
+    };
+}
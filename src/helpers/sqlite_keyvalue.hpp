@@ -1,31 +1,94 @@
 #pragma once
 
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
 #include "sqlite.hpp"
-#include "../../structural/key_value.hpp"
+#include "write_behind.hpp"
 
 namespace hosting::db {
+    // Settings-style store: every pair is loaded once and served from memory (reads are hash
+    // lookups, fine every frame); set() updates memory at once and queues the row for the
+    // background write-behind. Keys are kept ordered beside the map for scan_level prefixes.
     struct sqlite_keyval {
         sqlite_keyval(const std::string &path) : db_{path} {
             // ensure the table exists
             db_.ensure_table("keyval", "key TEXT PRIMARY KEY, value TEXT");
+            db_.for_each<std::string, std::string>("SELECT key, value FROM keyval", [this](std::string key, std::string value) {
+                auto [pos, inserted] = values_.emplace(std::move(key), std::move(value));
+                keys_.insert(pos->first);
+            });
+        }
+
+        std::optional<std::string> get(std::string_view key) const {
+            std::shared_lock lock {mutex_};
+            if (auto pos = values_.find(key); pos != values_.end()) {
+                return pos->second;
+            }
+            return std::nullopt;
         }
 
+        // The last value set for a key in a burst is the one written
         void set(std::string const &key, std::optional<std::string> const &value) {
+            {
+                std::unique_lock lock {mutex_};
+                if (value) {
+                    auto [pos, inserted] = values_.insert_or_assign(key, *value);
+                    if (inserted) {
+                        keys_.insert(pos->first);
+                    }
+                } else if (auto pos = values_.find(key); pos != values_.end()) {
+                    keys_.erase(pos->first);
+                    values_.erase(pos);
+                }
+            }
             if (value) {
-                db_.exec(std::format("INSERT OR REPLACE INTO keyval (key, value) VALUES ('{}', '{}')", key, *value));
+                writes_.put(key, [key, value = *value](sqlite &db) {
+                    db.exec("INSERT OR REPLACE INTO keyval (key, value) VALUES (?, ?)", {}, key, value);
+                });
             }
             else {
-                db_.exec(std::format("DELETE FROM keyval WHERE key = '{}'", key));
+                writes_.put(key, [key](sqlite &db) {
+                    db.exec("DELETE FROM keyval WHERE key = ?", {}, key);
+                });
             }
         }
 
+        // sink(key) for every key starting with name_base, in order
         void scan_level(std::string_view name_base, auto sink) {
-            db_.exec(std::format("SELECT key FROM keyval WHERE key LIKE '{}%'", name_base), [&sink](int, char **data, char **columns) {
-                sink(data[0]);
-                return 0;
-            });
+            std::vector<std::string> keys;
+            {
+                std::shared_lock lock {mutex_};
+                for (auto pos = keys_.lower_bound(name_base); pos != keys_.end() && pos->starts_with(name_base); ++pos) {
+                    keys.emplace_back(*pos);
+                }
+            }
+            for (auto const &key : keys) {
+                sink(key.c_str());
+            }
+        }
+
+        // Writes what set() queued; for shutdown
+        void flush() {
+            writes_.flush();
         }
     private:
+        struct string_hash {
+            using is_transparent = void;
+            size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+        };
+
         sqlite db_;
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<std::string, std::string, string_hash, std::equal_to<>> values_;
+        std::set<std::string_view, std::less<>> keys_;      // views of values_' keys, whose nodes never move
+        write_behind writes_ {db_};
     };
 }
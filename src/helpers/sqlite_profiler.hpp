@@ -0,0 +1,247 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <sqlite3.h>
+
+// 3. All other includes
+// None in this file
+
+namespace hosting::db
+{
+    /**
+     * Timings of every statement run through hosting::db::sqlite, all databases together,
+     * registered in the registrar as "sqlite_profiler". Per normalized statement (literals
+     * replaced by ?, whitespace collapsed) it sums calls, rows stepped, wall time and the
+     * time spent waiting for the connection's lock; the slowest single runs are kept apart
+     * with their SQL as run, for explain(). ROUEN_SQLITE_PROFILE=0 turns recording off.
+     */
+    class query_profiler
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+        static constexpr size_t slowest_size = 20;
+        static constexpr size_t max_statements = 2048;     // distinct statements before it starts over
+
+        struct stats
+        {
+            std::string database;
+            std::string sql;            // normalized
+            uint64_t calls {0};
+            uint64_t rows {0};
+            double total_ms {0};
+            double max_ms {0};
+            double lock_wait_ms {0};    // total
+            double max_lock_wait_ms {0};
+        };
+
+        struct slow_query
+        {
+            std::string database;
+            std::string sql;            // as run, for explain()
+            double wall_ms {0};
+            double lock_wait_ms {0};
+            uint64_t rows {0};
+            std::chrono::system_clock::time_point when;
+        };
+
+        // The one every connection records into; never destroyed, since static databases
+        // still flush their writes after function-local statics are gone
+        static std::shared_ptr<query_profiler> const &shared()
+        {
+            static auto const *profiler = new std::shared_ptr<query_profiler>(std::make_shared<query_profiler>());
+            return *profiler;
+        }
+
+        query_profiler()
+        {
+            auto const spec = std::getenv("ROUEN_SQLITE_PROFILE");
+            enabled_.store(!spec || std::string_view{spec} != "0", std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+        void enable(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+
+        // `lock_wait` until the connection was ours, `wall` from then until the last step
+        void record(std::string const &database, std::string const &sql, clock::duration lock_wait, clock::duration wall, uint64_t rows)
+        {
+            auto const wall_ms = std::chrono::duration<double, std::milli>(wall).count();
+            auto const wait_ms = std::chrono::duration<double, std::milli>(lock_wait).count();
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // Literal SQL is normalized once; later runs of the same text find it directly
+            auto &seen = seen_[database];
+            auto raw = seen.find(sql);
+            if (raw == seen.end()) {
+                auto normalized = database + '\n' + normalize(sql);
+                if (statements_.size() >= max_statements && !statements_.contains(normalized)) {
+                    statements_.clear();
+                    for (auto &[name, texts] : seen_) {
+                        texts.clear();
+                    }
+                }
+                auto [pos, inserted] = statements_.try_emplace(std::move(normalized));
+                if (inserted) {
+                    pos->second.database = database;
+                    pos->second.sql = pos->first.substr(database.size() + 1);
+                }
+                raw = seen.emplace(sql, &pos->second).first;
+            }
+            auto &entry = *raw->second;
+            ++entry.calls;
+            entry.rows += rows;
+            entry.total_ms += wall_ms;
+            entry.max_ms = std::max(entry.max_ms, wall_ms);
+            entry.lock_wait_ms += wait_ms;
+            entry.max_lock_wait_ms = std::max(entry.max_lock_wait_ms, wait_ms);
+
+            if (slowest_.size() < slowest_size || wall_ms > slowest_.back().wall_ms) {
+                if (slowest_.size() >= slowest_size) {
+                    slowest_.pop_back();
+                }
+                slow_query sample {database, sql, wall_ms, wait_ms, rows, std::chrono::system_clock::now()};
+                auto at = std::ranges::upper_bound(slowest_, wall_ms, std::greater<>{}, &slow_query::wall_ms);
+                slowest_.insert(at, std::move(sample));
+            }
+        }
+
+        // Every statement, most total time first
+        [[nodiscard]] std::vector<stats> snapshot() const
+        {
+            std::vector<stats> result;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                result.reserve(statements_.size());
+                for (auto const &[key, entry] : statements_) {
+                    result.push_back(entry);
+                }
+            }
+            std::ranges::sort(result, std::greater<>{}, &stats::total_ms);
+            return result;
+        }
+
+        // Slowest first
+        [[nodiscard]] std::vector<slow_query> slowest() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return slowest_;
+        }
+
+        void reset()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            seen_.clear();
+            statements_.clear();
+            slowest_.clear();
+        }
+
+        // The shape of a statement: 'text' and numbers become ?, runs of whitespace one space
+        static std::string normalize(std::string_view sql)
+        {
+            std::string result;
+            result.reserve(sql.size());
+            for (size_t i = 0; i < sql.size(); ++i) {
+                auto const c = static_cast<unsigned char>(sql[i]);
+                if (std::isspace(c)) {
+                    while (i + 1 < sql.size() && std::isspace(static_cast<unsigned char>(sql[i + 1]))) {
+                        ++i;
+                    }
+                    if (!result.empty()) {
+                        result += ' ';
+                    }
+                } else if (c == '\'') {
+                    // '' inside a literal is an escaped quote
+                    for (++i; i < sql.size(); ++i) {
+                        if (sql[i] == '\'' && (i + 1 >= sql.size() || sql[i + 1] != '\'')) {
+                            break;
+                        }
+                        if (sql[i] == '\'') {
+                            ++i;
+                        }
+                    }
+                    result += '?';
+                } else if (std::isdigit(c) && (result.empty() || !(std::isalnum(static_cast<unsigned char>(result.back())) || result.back() == '_'))) {
+                    while (i + 1 < sql.size() && (std::isalnum(static_cast<unsigned char>(sql[i + 1])) || sql[i + 1] == '.')) {
+                        ++i;
+                    }
+                    result += '?';
+                } else {
+                    result += static_cast<char>(c);
+                }
+            }
+            while (!result.empty() && (result.back() == ' ' || result.back() == ';')) {
+                result.pop_back();
+            }
+            return result;
+        }
+
+        /**
+         * EXPLAIN QUERY PLAN of `sql` on its own read-only connection, one line per step,
+         * indented under its parent; parameters count as NULL. The error text when it can't.
+         */
+        static std::string explain(std::string const &database, std::string const &sql)
+        {
+            if (database.empty() || database == ":memory:") {
+                return "In-memory databases can't be explained from outside";
+            }
+            sqlite3 *handle = nullptr;
+            if (sqlite3_open_v2(database.c_str(), &handle, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+                std::string error = std::format("Can't open {}: {}", database, handle ? sqlite3_errmsg(handle) : "out of memory");
+                sqlite3_close(handle);
+                return error;
+            }
+            sqlite3_busy_timeout(handle, 1000);
+
+            std::string plan;
+            sqlite3_stmt *stmt = nullptr;
+            if (sqlite3_prepare_v2(handle, ("EXPLAIN QUERY PLAN " + sql).c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+                plan = std::format("Can't explain: {}", sqlite3_errmsg(handle));
+            } else {
+                // Columns: id, parent, notused, detail
+                std::unordered_map<int, int> depth;
+                while (sqlite3_step(stmt) == SQLITE_ROW) {
+                    auto const id = sqlite3_column_int(stmt, 0);
+                    auto const parent = sqlite3_column_int(stmt, 1);
+                    auto const detail = reinterpret_cast<char const *>(sqlite3_column_text(stmt, 3));
+                    auto const level = parent == 0 ? 0 : depth[parent] + 1;
+                    depth[id] = level;
+                    plan += std::string(static_cast<size_t>(level) * 2, ' ') + (detail ? detail : "") + '\n';
+                }
+                if (plan.empty()) {
+                    plan = "No plan (not a query)\n";
+                }
+            }
+            sqlite3_finalize(stmt);
+            sqlite3_close(handle);
+            return plan;
+        }
+
+    private:
+        struct string_hash
+        {
+            using is_transparent = void;
+            size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+        };
+        using seen_map = std::unordered_map<std::string, stats *, string_hash, std::equal_to<>>;
+
+        std::atomic<bool> enabled_ {true};
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, stats> statements_;         // database '\n' normalized SQL
+        std::unordered_map<std::string, seen_map, string_hash, std::equal_to<>> seen_;   // database -> SQL as run -> its entry
+        std::vector<slow_query> slowest_;                           // slowest first
+    };
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "debug.hpp"
+
+namespace rouen::helpers {
+
+/**
+ * Records the phases of application startup (on any thread) until finish() is called
+ * once the restored layout is fully built.
+ *
+ * finish() logs a one-line summary; with ROUEN_STARTUP_TRACE=<file> it also writes the
+ * phases in Chrome trace format, viewable in chrome://tracing or ui.perfetto.dev.
+ */
+class startup_timeline {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct phase {
+        std::string name;
+        uint32_t thread {0};
+        clock::duration start {};   // since process start
+        clock::duration duration {};
+    };
+
+    // Times the enclosing scope as one phase
+    class scope {
+    public:
+        explicit scope(std::string name) : name_(std::move(name)), start_(clock::now()) {}
+        ~scope() { instance().record(std::move(name_), start_, clock::now()); }
+        scope(scope const&) = delete;
+        scope& operator=(scope const&) = delete;
+
+    private:
+        std::string name_;
+        clock::time_point start_;
+    };
+
+    static startup_timeline& instance() {
+        static startup_timeline timeline;
+        return timeline;
+    }
+
+    void record(std::string name, clock::time_point start, clock::time_point end) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) {
+            return;
+        }
+        phases_.push_back({std::move(name), thread_tag(), start - origin_, end - start});
+    }
+
+    // A zero-length marker (e.g. "first_frame")
+    void mark(std::string name) {
+        auto const now = clock::now();
+        record(std::move(name), now, now);
+    }
+
+    [[nodiscard]] bool finished() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return finished_;
+    }
+
+    void finish() {
+        std::vector<phase> phases;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (finished_) {
+                return;
+            }
+            finished_ = true;
+            phases = phases_;
+        }
+        auto const total = std::chrono::duration<double, std::milli>(clock::now() - origin_).count();
+        SYS_INFO_FMT("Startup finished in {:.1f} ms ({} phases)", total, phases.size());
+        if (char const* path = std::getenv("ROUEN_STARTUP_TRACE")) {
+            write_trace(path, phases);
+        }
+    }
+
+    [[nodiscard]] std::vector<phase> phases() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return phases_;
+    }
+
+    static bool write_trace(std::string const& path, std::vector<phase> const& phases) {
+        std::ofstream out(path);
+        if (!out) {
+            SYS_ERROR_FMT("Cannot write startup trace to {}", path);
+            return false;
+        }
+        auto us = [](clock::duration d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+        auto escaped = [](std::string const& s) {
+            std::string result;
+            for (char c : s) {
+                if (c == '"' || c == '\\') {
+                    result += '\\';
+                }
+                result += c;
+            }
+            return result;
+        };
+        out << "{\"traceEvents\":[";
+        for (size_t i = 0; i < phases.size(); ++i) {
+            auto const& p = phases[i];
+            out << (i ? "," : "") << "{\"name\":\"" << escaped(p.name) << "\",\"cat\":\"startup\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << p.thread << ",\"ts\":" << us(p.start) << ",\"dur\":" << us(p.duration) << "}";
+        }
+        out << "]}\n";
+        SYS_INFO_FMT("Startup trace written to {}", path);
+        return true;
+    }
+
+private:
+    startup_timeline() = default;
+
+    static uint32_t thread_tag() {
+        return static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    }
+
+    mutable std::mutex mutex_;
+    clock::time_point origin_ {clock::now()};
+    std::vector<phase> phases_;
+    bool finished_ {false};
+};
+
+} // namespace rouen::helpers
@@ -0,0 +1,431 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <sys/mount.h>
+#include "compat/sysinfo.hpp"
+#else
+#include <dirent.h>
+#include <sys/statvfs.h>
+#include <sys/sysinfo.h>
+#endif
+
+// 3. All other includes
+// None in this file
+
+namespace rouen::helpers {
+
+/**
+ * The last `capacity` values of one metric. One thread pushes, any number read: every value
+ * is an atomic, and the count is published after the value, so a reader never waits and
+ * never sees a half-written sample (at worst, the oldest one it copies is a newer value when
+ * the writer laps it mid-copy).
+ */
+template <size_t capacity>
+class sample_ring {
+public:
+    void push(float value) {
+        auto const n = count_.load(std::memory_order_relaxed);
+        values_[n % capacity].store(value, std::memory_order_relaxed);
+        count_.store(n + 1, std::memory_order_release);
+    }
+
+    [[nodiscard]] float latest() const {
+        auto const n = count_.load(std::memory_order_acquire);
+        return n == 0 ? 0.0f : values_[(n - 1) % capacity].load(std::memory_order_relaxed);
+    }
+
+    // Oldest first, into `out`; returns how many
+    size_t copy(std::array<float, capacity>& out) const {
+        auto const n = count_.load(std::memory_order_acquire);
+        auto const size = static_cast<size_t>(std::min<uint64_t>(n, capacity));
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = values_[(n - size + i) % capacity].load(std::memory_order_relaxed);
+        }
+        return size;
+    }
+
+private:
+    std::array<std::atomic<float>, capacity> values_ {};
+    std::atomic<uint64_t> count_ {0};
+};
+
+/**
+ * A /proc (or /sys) file opened once and re-read with pread() from offset 0: the kernel
+ * regenerates it on every read, so sampling costs one syscall and no allocation.
+ */
+class proc_file {
+public:
+    proc_file() = default;
+    explicit proc_file(const char* path) : fd_{::open(path, O_RDONLY | O_CLOEXEC)} {}
+    ~proc_file() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+    proc_file(proc_file&& other) noexcept : fd_{other.fd_} { other.fd_ = -1; }
+    proc_file& operator=(proc_file&& other) noexcept {
+        std::swap(fd_, other.fd_);
+        return *this;
+    }
+    proc_file(const proc_file&) = delete;
+    proc_file& operator=(const proc_file&) = delete;
+
+    [[nodiscard]] bool is_open() const { return fd_ >= 0; }
+
+    // The file's text, as much as fits in `buffer`
+    template <size_t size>
+    std::string_view read(std::array<char, size>& buffer) const {
+        if (fd_ < 0) {
+            return {};
+        }
+        auto const n = ::pread(fd_, buffer.data(), buffer.size(), 0);
+        return n > 0 ? std::string_view{buffer.data(), static_cast<size_t>(n)} : std::string_view{};
+    }
+
+private:
+    int fd_ {-1};
+};
+
+// Pops the next unsigned decimal off `text`, skipping what comes before it
+inline uint64_t next_number(std::string_view& text) {
+    size_t i = 0;
+    while (i < text.size() && (text[i] < '0' || text[i] > '9')) {
+        if (text[i] == '\n') {
+            text.remove_prefix(i);
+            return 0;       // a line ends first
+        }
+        ++i;
+    }
+    uint64_t value = 0;
+    while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+        value = value * 10 + static_cast<uint64_t>(text[i] - '0');
+        ++i;
+    }
+    text.remove_prefix(i);
+    return value;
+}
+
+// Pops the line at the front of `text`, newline dropped
+inline std::string_view next_line(std::string_view& text) {
+    auto const end = std::min(text.find('\n'), text.size());
+    auto const line = text.substr(0, end);
+    text.remove_prefix(std::min(end + 1, text.size()));
+    return line;
+}
+
+/**
+ * Samples the machine on its own thread, every `interval`: total and per-core CPU, memory,
+ * disk space and I/O, network traffic, into sample_rings the UI reads without locking or
+ * touching a file. Counters (CPU ticks, sectors, bytes) are turned into rates here, between
+ * consecutive samples. One sampler serves every sysinfo card: shared() hands out the running
+ * one, and it stops with the last card holding it.
+ */
+class system_sampler {
+public:
+    static constexpr size_t history = 240;
+    using ring = sample_ring<history>;
+
+    static std::shared_ptr<system_sampler> shared() {
+        static std::mutex mutex;
+        static std::weak_ptr<system_sampler> current;
+        std::lock_guard lock(mutex);
+        auto sampler = current.lock();
+        if (!sampler) {
+            sampler = std::make_shared<system_sampler>();
+            current = sampler;
+        }
+        return sampler;
+    }
+
+    system_sampler() {
+#ifndef __APPLE__
+        // The cpuN lines there are now; CPUs going online later are left out
+        std::array<char, 65536> buffer;
+        auto text = stat_.read(buffer);
+        next_line(text);
+        while (text.starts_with("cpu")) {
+            next_line(text);
+            ++cores_;
+        }
+        whole_disks();
+#endif
+        core_percent_ = std::make_unique<ring[]>(cores_);
+        previous_cores_.resize(cores_);
+        thread_ = std::jthread([this](std::stop_token stop) { run(stop); });
+    }
+
+    system_sampler(const system_sampler&) = delete;
+    system_sampler& operator=(const system_sampler&) = delete;
+
+    void set_interval(std::chrono::milliseconds interval) {
+        interval_ms_ = static_cast<int>(interval.count());
+        wake_.notify_all();
+    }
+    [[nodiscard]] std::chrono::milliseconds interval() const { return std::chrono::milliseconds{interval_ms_.load()}; }
+
+    [[nodiscard]] size_t cores() const { return cores_; }
+
+    // Percent of all CPUs, and of each
+    ring const& cpu_percent() const { return cpu_percent_; }
+    ring const& core_percent(size_t core) const { return core_percent_[core]; }
+
+    // In bytes, and bytes per second
+    ring const& memory_used() const { return memory_used_; }
+    ring const& disk_read() const { return disk_read_; }
+    ring const& disk_written() const { return disk_written_; }
+    ring const& net_received() const { return net_received_; }
+    ring const& net_sent() const { return net_sent_; }
+
+    [[nodiscard]] double memory_total() const { return memory_total_; }
+    [[nodiscard]] double disk_total() const { return disk_total_; }
+    [[nodiscard]] double disk_used() const { return disk_used_; }
+    [[nodiscard]] long uptime() const { return uptime_; }
+    [[nodiscard]] int processes() const { return processes_; }
+
+private:
+    struct cpu_ticks {
+        uint64_t busy {0};
+        uint64_t total {0};
+    };
+
+    void run(std::stop_token stop) {
+        std::mutex mutex;
+        std::unique_lock lock(mutex);
+        while (!stop.stop_requested()) {
+            sample();
+            auto const interval = interval_ms_.load();
+            wake_.wait_for(lock, stop, std::chrono::milliseconds{interval}, [&] { return interval_ms_.load() != interval; });
+        }
+    }
+
+    void sample() {
+        auto const now = std::chrono::steady_clock::now();
+        auto const seconds = first_ ? 0.0 : std::chrono::duration<double>(now - previous_time_).count();
+        previous_time_ = now;
+        [[maybe_unused]] auto rate = [seconds](uint64_t current, uint64_t& previous) {
+            auto const delta = current >= previous ? current - previous : 0;
+            previous = current;
+            return seconds > 0 ? static_cast<float>(static_cast<double>(delta) / seconds) : 0.0f;
+        };
+        auto percent = [](cpu_ticks current, cpu_ticks& previous) {
+            auto const total = current.total - previous.total;
+            auto const busy = current.busy - previous.busy;
+            previous = current;
+            return total > 0 ? static_cast<float>(100.0 * static_cast<double>(busy) / static_cast<double>(total)) : 0.0f;
+        };
+
+#ifdef __APPLE__
+        host_cpu_load_info_data_t load;
+        mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
+        if (host_statistics(mach_host_self(), HOST_CPU_LOAD_INFO, reinterpret_cast<host_info_t>(&load), &count) == KERN_SUCCESS) {
+            cpu_ticks const ticks {
+                static_cast<uint64_t>(load.cpu_ticks[CPU_STATE_USER]) + load.cpu_ticks[CPU_STATE_SYSTEM] + load.cpu_ticks[CPU_STATE_NICE],
+                static_cast<uint64_t>(load.cpu_ticks[CPU_STATE_USER]) + load.cpu_ticks[CPU_STATE_SYSTEM] + load.cpu_ticks[CPU_STATE_NICE] +
+                    load.cpu_ticks[CPU_STATE_IDLE]};
+            auto const value = percent(ticks, previous_cpu_);
+            if (!first_) {
+                cpu_percent_.push(value);
+            }
+        }
+        struct statfs disk;
+        if (statfs("/", &disk) == 0) {
+            disk_total_ = static_cast<double>(disk.f_blocks) * static_cast<double>(disk.f_bsize);
+            disk_used_ = disk_total_ - static_cast<double>(disk.f_bfree) * static_cast<double>(disk.f_bsize);
+        }
+        struct sysinfo info;
+        if (sysinfo(&info) == 0) {
+            memory_total_ = static_cast<double>(info.totalram) * info.mem_unit;
+            memory_used_.push(static_cast<float>(static_cast<double>(info.totalram - info.freeram) * info.mem_unit));
+            uptime_ = info.uptime;
+            processes_ = info.procs;
+        }
+#else
+        std::array<char, 65536> buffer;
+
+        // /proc/stat: "cpu" then "cpuN" lines of user nice system idle iowait irq softirq steal
+        auto text = stat_.read(buffer);
+        for (size_t line = 0; line <= cores_ && text.starts_with("cpu"); ++line) {
+            auto fields = next_line(text);
+            fields.remove_prefix(3);
+            while (!fields.empty() && fields.front() != ' ') {
+                fields.remove_prefix(1);       // the core number
+            }
+            uint64_t value[8] {};
+            for (auto& v : value) {
+                v = next_number(fields);
+            }
+            auto const idle = value[3] + value[4];
+            auto const busy = value[0] + value[1] + value[2] + value[5] + value[6] + value[7];
+            auto const p = percent({busy, busy + idle}, line == 0 ? previous_cpu_ : previous_cores_[line - 1]);
+            if (!first_) {
+                (line == 0 ? cpu_percent_ : core_percent_[line - 1]).push(p);
+            }
+        }
+
+        // /proc/meminfo: what is available counts caches the kernel would give back
+        text = meminfo_.read(buffer);
+        uint64_t total_kb = 0, available_kb = 0;
+        while (!text.empty() && (total_kb == 0 || available_kb == 0)) {
+            auto line = next_line(text);
+            if (line.starts_with("MemTotal:")) {
+                total_kb = next_number(line);
+            } else if (line.starts_with("MemAvailable:")) {
+                available_kb = next_number(line);
+            }
+        }
+        memory_total_ = static_cast<double>(total_kb) * 1024.0;
+        memory_used_.push(static_cast<float>(static_cast<double>(total_kb - std::min(available_kb, total_kb)) * 1024.0));
+
+        // /proc/diskstats: major minor name reads merged sectors_read ms writes merged sectors_written ...
+        text = diskstats_.read(buffer);
+        uint64_t sectors_read = 0, sectors_written = 0;
+        while (!text.empty()) {
+            auto line = next_line(text);
+            next_number(line);
+            next_number(line);
+            while (!line.empty() && line.front() == ' ') {
+                line.remove_prefix(1);
+            }
+            auto const name = line.substr(0, line.find(' '));
+            if (!is_whole_disk(name)) {
+                continue;
+            }
+            line.remove_prefix(name.size());
+            uint64_t field[7];
+            for (auto& f : field) {
+                f = next_number(line);
+            }
+            sectors_read += field[2];
+            sectors_written += field[6];
+        }
+        // Sectors are 512 bytes here, whatever the device's
+        auto const read_rate = rate(sectors_read * 512, previous_read_);
+        auto const write_rate = rate(sectors_written * 512, previous_written_);
+
+        // /proc/net/dev: two header lines, then "iface: rx_bytes packets ... (8 fields) tx_bytes ..."
+        text = netdev_.read(buffer);
+        next_line(text);
+        next_line(text);
+        uint64_t received = 0, sent = 0;
+        while (!text.empty()) {
+            auto line = next_line(text);
+            auto const colon = line.find(':');
+            if (colon == std::string_view::npos) {
+                continue;
+            }
+            auto name = line.substr(0, colon);
+            while (!name.empty() && name.front() == ' ') {
+                name.remove_prefix(1);
+            }
+            if (name == "lo") {
+                continue;
+            }
+            line.remove_prefix(colon + 1);
+            uint64_t field[9];
+            for (auto& f : field) {
+                f = next_number(line);
+            }
+            received += field[0];
+            sent += field[8];
+        }
+        auto const receive_rate = rate(received, previous_received_);
+        auto const send_rate = rate(sent, previous_sent_);
+        if (!first_) {
+            disk_read_.push(read_rate);
+            disk_written_.push(write_rate);
+            net_received_.push(receive_rate);
+            net_sent_.push(send_rate);
+        }
+
+        struct statvfs disk;
+        if (statvfs("/", &disk) == 0) {
+            disk_total_ = static_cast<double>(disk.f_blocks) * static_cast<double>(disk.f_frsize);
+            disk_used_ = disk_total_ - static_cast<double>(disk.f_bfree) * static_cast<double>(disk.f_frsize);
+        }
+        struct sysinfo info;
+        if (sysinfo(&info) == 0) {
+            uptime_ = info.uptime;
+            processes_ = info.procs;
+        }
+#endif
+        first_ = false;
+    }
+
+#ifndef __APPLE__
+    // /sys/block lists whole disks only; partitions would count their I/O twice
+    void whole_disks() {
+        if (auto* dir = ::opendir("/sys/block")) {
+            while (auto* entry = ::readdir(dir)) {
+                std::string_view const name = entry->d_name;
+                if (name.front() != '.' && !name.starts_with("loop") && !name.starts_with("ram")) {
+                    disks_.emplace_back(name);
+                }
+            }
+            ::closedir(dir);
+        }
+    }
+
+    [[nodiscard]] bool is_whole_disk(std::string_view name) const {
+        for (auto const& disk : disks_) {
+            if (disk == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    proc_file stat_ {"/proc/stat"};
+    proc_file meminfo_ {"/proc/meminfo"};
+    proc_file diskstats_ {"/proc/diskstats"};
+    proc_file netdev_ {"/proc/net/dev"};
+    std::vector<std::string> disks_;
+#endif
+
+    size_t cores_ {0};
+    ring cpu_percent_;
+    std::unique_ptr<ring[]> core_percent_;
+    ring memory_used_;
+    ring disk_read_;
+    ring disk_written_;
+    ring net_received_;
+    ring net_sent_;
+    std::atomic<double> memory_total_ {0};
+    std::atomic<double> disk_total_ {0};
+    std::atomic<double> disk_used_ {0};
+    std::atomic<long> uptime_ {0};
+    std::atomic<int> processes_ {0};
+    std::atomic<int> interval_ms_ {1000};
+
+    // The sampling thread's
+    bool first_ {true};
+    std::chrono::steady_clock::time_point previous_time_;
+    cpu_ticks previous_cpu_;
+    std::vector<cpu_ticks> previous_cores_;
+    uint64_t previous_read_ {0};
+    uint64_t previous_written_ {0};
+    uint64_t previous_received_ {0};
+    uint64_t previous_sent_ {0};
+
+    std::condition_variable_any wake_;
+    std::jthread thread_;
+};
+
+} // namespace rouen::helpers
@@ -0,0 +1,247 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <format>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "../registrar.hpp"
+#include "debug.hpp"
+#include "memory_accounting.hpp"
+#include "trace.hpp"
+
+namespace rouen::helpers {
+
+enum class task_priority : size_t {
+    high = 0,       // user is waiting on the result (a click, a card opening)
+    normal = 1,     // regular host refreshes
+    background = 2  // bulk work nobody is looking at yet
+};
+
+/**
+ * Shared work-stealing executor, registered in the registrar as "task_scheduler".
+ *
+ * Each worker owns one deque per priority. Tasks submitted from a worker go to its own
+ * deque (popped LIFO for locality); tasks from other threads are spread round-robin.
+ * Idle workers steal FIFO from the others, always draining higher priorities first.
+ *
+ * Tasks receive a std::stop_token that fires when the returned stop_source is asked
+ * to stop or the scheduler shuts down. Tasks should be bounded: anything that lives
+ * for the lifetime of a card (a tail -f, a reader loop) belongs on its own thread.
+ */
+class task_scheduler {
+public:
+    using task = std::function<void(std::stop_token)>;
+
+    explicit task_scheduler(size_t worker_count = default_worker_count()) {
+        worker_count = std::max<size_t>(worker_count, 1);
+        workers_.reserve(worker_count);
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers_.emplace_back(std::make_unique<worker>());
+        }
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers_[i]->thread = std::thread([this, i] { run_worker(i); });
+        }
+    }
+
+    ~task_scheduler() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stopping_ = true;
+        }
+        // Cancel whatever is queued or running so workers can wind down quickly
+        for (auto& w : workers_) {
+            std::lock_guard<std::mutex> lock(w->mutex);
+            for (auto& lane : w->lanes) {
+                for (auto& e : lane) {
+                    e.stop.request_stop();
+                }
+                lane.clear();
+            }
+            if (w->current) {
+                w->current->request_stop();
+            }
+        }
+        wake_.notify_all();
+        for (auto& w : workers_) {
+            if (w->thread.joinable()) {
+                w->thread.join();
+            }
+        }
+    }
+
+    task_scheduler(task_scheduler const&) = delete;
+    task_scheduler& operator=(task_scheduler const&) = delete;
+
+    static size_t default_worker_count() {
+        auto const hw = std::thread::hardware_concurrency();
+        return hw > 0 ? static_cast<size_t>(hw) : 4;
+    }
+
+    // Queue a task; the returned stop_source cancels it (before start, or cooperatively while running)
+    std::stop_source submit(task t, task_priority priority = task_priority::normal, std::stop_source stop = {}) {
+        auto const lane = static_cast<size_t>(priority);
+        size_t target = current_worker_index();
+        if (target >= workers_.size() || current_scheduler() != this) {
+            target = next_worker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        }
+        {
+            std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+            workers_[target]->lanes[lane].push_back(entry{std::move(t), stop, memory::current()});
+        }
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            ++pending_;
+        }
+        wake_.notify_one();
+        return stop;
+    }
+
+    // Run a callable on the pool and get its result through a future
+    template <typename F>
+    auto async(F&& f, task_priority priority = task_priority::normal) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using result_t = std::invoke_result_t<std::decay_t<F>>;
+        auto job = std::make_shared<std::packaged_task<result_t()>>(std::forward<F>(f));
+        auto result = job->get_future();
+        submit([job](std::stop_token) { (*job)(); }, priority);
+        return result;
+    }
+
+    [[nodiscard]] size_t worker_count() const {
+        return workers_.size();
+    }
+
+    [[nodiscard]] size_t pending() const {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        return pending_;
+    }
+
+private:
+    struct entry {
+        task fn;
+        std::stop_source stop;
+        memory::tag_t memory_tag;   // the submitter's, so the task's allocations count where it came from
+    };
+
+    struct worker {
+        std::mutex mutex;
+        std::array<std::deque<entry>, 3> lanes;
+        std::optional<std::stop_source> current;
+        std::thread thread;
+    };
+
+    static size_t& current_worker_index() {
+        thread_local size_t index = static_cast<size_t>(-1);
+        return index;
+    }
+
+    static task_scheduler*& current_scheduler() {
+        thread_local task_scheduler* scheduler = nullptr;
+        return scheduler;
+    }
+
+    std::optional<entry> take(size_t self) {
+        for (size_t lane = 0; lane < 3; ++lane) {
+            // Own work first, newest first
+            {
+                auto& w = *workers_[self];
+                std::lock_guard<std::mutex> lock(w.mutex);
+                if (!w.lanes[lane].empty()) {
+                    auto e = std::move(w.lanes[lane].back());
+                    w.lanes[lane].pop_back();
+                    return e;
+                }
+            }
+            // Then steal the oldest task of the same priority from a sibling
+            for (size_t offset = 1; offset < workers_.size(); ++offset) {
+                auto& victim = *workers_[(self + offset) % workers_.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.lanes[lane].empty()) {
+                    auto e = std::move(victim.lanes[lane].front());
+                    victim.lanes[lane].pop_front();
+                    return e;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    void run_worker(size_t self) {
+        current_worker_index() = self;
+        current_scheduler() = this;
+        trace::name_thread(std::format("worker {}", self));
+        auto& w = *workers_[self];
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(wake_mutex_);
+                wake_.wait(lock, [this] { return stopping_ || pending_ > 0; });
+                if (stopping_) {
+                    return;
+                }
+            }
+
+            auto e = take(self);
+            if (!e) {
+                continue;   // another worker won the race for it
+            }
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                --pending_;
+            }
+            if (e->stop.stop_requested()) {
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(w.mutex);
+                w.current = e->stop;
+            }
+            try {
+                memory::scope tag{e->memory_tag};
+                TRACE_SPAN("SYSTEM", "task");
+                e->fn(e->stop.get_token());
+            } catch (std::exception const& ex) {
+                SYS_ERROR_FMT("task_scheduler: task threw: {}", ex.what());
+            } catch (...) {
+                SYS_ERROR("task_scheduler: task threw an unknown exception");
+            }
+            {
+                std::lock_guard<std::mutex> lock(w.mutex);
+                w.current.reset();
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<worker>> workers_;
+    std::atomic<size_t> next_worker_ {0};
+    mutable std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    size_t pending_ {0};
+    bool stopping_ {false};
+};
+
+// The application-wide scheduler registered by main()
+inline std::shared_ptr<task_scheduler> scheduler() {
+    return registrar::get<task_scheduler>("task_scheduler");
+}
+
+} // namespace rouen::helpers
@@ -0,0 +1,4 @@
+// imstb_rectpack's implementation, compiled once for every target that packs a texture_atlas.
+// Dear ImGui keeps its own copy static, so texture_atlas.hpp links against this one.
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imstb_rectpack.h>
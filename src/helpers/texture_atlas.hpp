@@ -0,0 +1,295 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+#include "./imgui_include.hpp"
+#include <SDL.h>
+#include <imstb_rectpack.h>     // the implementation is compiled in texture_atlas.cpp
+
+// 3. All other includes
+#include "texture_helper.hpp"
+
+namespace rouen::helpers {
+
+/**
+ * Packs small images (icons, avatars, chess pieces, thumbnails) into a few shared textures,
+ * so a card full of them binds one texture instead of one per image.
+ *
+ * add() copies a surface into a page and hands back a region: the page's ImTextureID and
+ * the image's UV rect. A region lasts as long as its shared_ptr; the space it held is
+ * reclaimed when a page runs full, by packing the regions still alive again (their UVs
+ * change in place) or, once nothing on a page is alive, by starting the page over. A region
+ * that no longer fits after packing moves to a texture of its own, so it never goes blank.
+ * Every page keeps its pixels in memory to be repacked from. Main thread only.
+ */
+class texture_atlas {
+public:
+    static constexpr int page_size = 1024;
+    static constexpr int max_side = 128;    // larger images are better off in their own texture
+    static constexpr size_t max_pages = 4;
+
+    struct region {
+        ImTextureID texture {nullptr};
+        ImVec2 uv0 {0.0f, 0.0f};
+        ImVec2 uv1 {0.0f, 0.0f};
+        int width {0};
+        int height {0};
+        SDL_Texture* standalone {nullptr};      // what `texture` is once a repack left it out
+
+        region() = default;
+        region(region const&) = delete;
+        region& operator=(region const&) = delete;
+        ~region() {
+            if (standalone) {
+                SDL_DestroyTexture(standalone);
+            }
+        }
+    };
+
+    // The atlas of the main renderer
+    static texture_atlas& instance() {
+        static texture_atlas atlas;
+        return atlas;
+    }
+
+    // Pages never move: their packers point into themselves
+    texture_atlas() { pages_.reserve(max_pages); }
+    texture_atlas(texture_atlas const&) = delete;
+    texture_atlas& operator=(texture_atlas const&) = delete;
+
+    ~texture_atlas() { release(); }
+
+    [[nodiscard]] static bool fits(int width, int height) {
+        return width > 0 && height > 0 && width <= max_side && height <= max_side;
+    }
+
+    /**
+     * Copies `surface` into a page. Null when it is too large for the atlas or every page
+     * is taken by live regions; the caller then makes a texture of its own.
+     */
+    std::shared_ptr<region> add(SDL_Renderer* renderer, SDL_Surface* surface) {
+        if (!renderer || !surface || !fits(surface->w, surface->h)) {
+            return nullptr;
+        }
+        SDL_Surface* rgba = surface->format->format == SDL_PIXELFORMAT_RGBA32
+            ? surface : SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+        if (!rgba) {
+            return nullptr;
+        }
+        std::shared_ptr<region> result;
+        if (auto placed = place(renderer, rgba->w, rgba->h); placed.target) {
+            result = std::make_shared<region>();
+            SDL_LockSurface(rgba);
+            blit(*placed.target, placed.x, placed.y, rgba->w, rgba->h,
+                 static_cast<uint8_t const*>(rgba->pixels), rgba->pitch);
+            SDL_UnlockSurface(rgba);
+            placed.target->regions.push_back({result, placed.x, placed.y});
+            locate(*placed.target, *result, placed.x, placed.y, rgba->w, rgba->h);
+            upload(*placed.target, SDL_Rect{placed.x, placed.y, rgba->w, rgba->h});
+        }
+        if (rgba != surface) {
+            SDL_FreeSurface(rgba);
+        }
+        return result;
+    }
+
+    [[nodiscard]] size_t page_count() const { return pages_.size(); }
+
+    // Destroys every page, before the renderer they belong to goes; live regions are left
+    // without a texture
+    void release() {
+        for (auto& p : pages_) {
+            for (auto const& r : p.regions) {
+                if (auto owner = r.owner.lock(); owner) {
+                    owner->texture = nullptr;
+                }
+            }
+            if (p.texture) {
+                SDL_DestroyTexture(p.texture);
+            }
+        }
+        pages_.clear();
+    }
+
+private:
+    static constexpr int padding = 1;      // keeps linear filtering from bleeding neighbours in
+
+    struct placement {
+        std::weak_ptr<region> owner;
+        int x {0};
+        int y {0};
+    };
+
+    struct page {
+        SDL_Texture* texture {nullptr};
+        std::vector<uint8_t> pixels;                // RGBA, page_size x page_size
+        std::vector<placement> regions;
+        stbrp_context packer {};
+        std::vector<stbrp_node> nodes;
+    };
+
+    struct spot {
+        page* target {nullptr};
+        int x {0};
+        int y {0};
+    };
+
+    spot place(SDL_Renderer* renderer, int width, int height) {
+        for (auto& p : pages_) {
+            if (auto at = pack(p, width, height); at.target) {
+                return at;
+            }
+        }
+        // Full: make room on the page the most space has been freed on
+        page* emptiest = nullptr;
+        size_t least_live = SIZE_MAX;
+        for (auto& p : pages_) {
+            if (auto live = live_area(p); live < least_live) {
+                least_live = live;
+                emptiest = &p;
+            }
+        }
+        if (emptiest && least_live < static_cast<size_t>(page_size) * page_size / 2) {
+            repack(renderer, *emptiest);
+            if (auto at = pack(*emptiest, width, height); at.target) {
+                return at;
+            }
+        }
+        if (pages_.size() < max_pages) {
+            if (auto fresh = new_page(renderer); fresh) {
+                return pack(*fresh, width, height);
+            }
+        }
+        return {};
+    }
+
+    spot pack(page& p, int width, int height) {
+        stbrp_rect rect {};
+        rect.w = width + padding;
+        rect.h = height + padding;
+        if (!stbrp_pack_rects(&p.packer, &rect, 1) || !rect.was_packed) {
+            return {};
+        }
+        return {&p, rect.x, rect.y};
+    }
+
+    page* new_page(SDL_Renderer* renderer) {
+        auto texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, page_size, page_size);
+        if (!texture) {
+            TEXTURE_ERROR_FMT("Failed to create atlas page: {}", SDL_GetError());
+            return nullptr;
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        auto& p = pages_.emplace_back();
+        p.texture = texture;
+        p.pixels.assign(static_cast<size_t>(page_size) * page_size * 4, 0);
+        reset_packer(p);
+        upload(p, SDL_Rect{0, 0, page_size, page_size});
+        TEXTURE_INFO_FMT("Atlas page {} created", pages_.size());
+        return &p;
+    }
+
+    static void reset_packer(page& p) {
+        p.nodes.resize(page_size);
+        stbrp_init_target(&p.packer, page_size, page_size, p.nodes.data(), static_cast<int>(p.nodes.size()));
+    }
+
+    static size_t live_area(page& p) {
+        std::erase_if(p.regions, [](placement const& r) { return r.owner.expired(); });
+        size_t area = 0;
+        for (auto const& r : p.regions) {
+            if (auto owner = r.owner.lock(); owner) {
+                area += static_cast<size_t>(owner->width + padding) * static_cast<size_t>(owner->height + padding);
+            }
+        }
+        return area;
+    }
+
+    // Packs the live regions of `p` afresh and moves their pixels along
+    void repack(SDL_Renderer* renderer, page& p) {
+        std::vector<std::pair<std::shared_ptr<region>, placement>> live;
+        for (auto const& r : p.regions) {
+            if (auto owner = r.owner.lock(); owner) {
+                live.emplace_back(std::move(owner), r);
+            }
+        }
+        std::vector<stbrp_rect> rects(live.size());
+        for (size_t i = 0; i < live.size(); ++i) {
+            rects[i].id = static_cast<int>(i);
+            rects[i].w = live[i].first->width + padding;
+            rects[i].h = live[i].first->height + padding;
+        }
+        reset_packer(p);
+        if (!rects.empty()) {
+            stbrp_pack_rects(&p.packer, rects.data(), static_cast<int>(rects.size()));
+        }
+
+        std::vector<uint8_t> pixels(p.pixels.size(), 0);
+        p.regions.clear();
+        for (auto const& rect : rects) {
+            auto& [owner, old] = live[static_cast<size_t>(rect.id)];
+            if (!rect.was_packed) {
+                move_out(renderer, p, *owner, old);     // lost to fragmentation
+                continue;
+            }
+            auto const row = static_cast<size_t>(owner->width) * 4;
+            for (int y = 0; y < owner->height; ++y) {
+                std::memcpy(&pixels[offset(rect.x, rect.y + y)], &p.pixels[offset(old.x, old.y + y)], row);
+            }
+            p.regions.push_back({owner, rect.x, rect.y});
+            locate(p, *owner, rect.x, rect.y, owner->width, owner->height);
+        }
+        p.pixels = std::move(pixels);
+        upload(p, SDL_Rect{0, 0, page_size, page_size});
+        TEXTURE_DEBUG_FMT("Atlas page repacked, {} regions kept", p.regions.size());
+    }
+
+    // Gives `r` a texture of its own with the pixels it has at `at` on `p`
+    static void move_out(SDL_Renderer* renderer, page const& p, region& r, placement const& at) {
+        r.standalone = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, r.width, r.height);
+        if (!r.standalone) {
+            TEXTURE_ERROR_FMT("Failed to move a region out of the atlas: {}", SDL_GetError());
+            r.texture = nullptr;
+            return;
+        }
+        SDL_SetTextureBlendMode(r.standalone, SDL_BLENDMODE_BLEND);
+        SDL_UpdateTexture(r.standalone, nullptr, &p.pixels[offset(at.x, at.y)], page_size * 4);
+        r.texture = reinterpret_cast<ImTextureID>(r.standalone);
+        r.uv0 = ImVec2{0.0f, 0.0f};
+        r.uv1 = ImVec2{1.0f, 1.0f};
+    }
+
+    static size_t offset(int x, int y) {
+        return (static_cast<size_t>(y) * page_size + static_cast<size_t>(x)) * 4;
+    }
+
+    static void blit(page& p, int x, int y, int width, int height, uint8_t const* source, int pitch) {
+        auto const row = static_cast<size_t>(width) * 4;
+        for (int line = 0; line < height; ++line) {
+            std::memcpy(&p.pixels[offset(x, y + line)], source + static_cast<size_t>(line) * static_cast<size_t>(pitch), row);
+        }
+    }
+
+    static void locate(page const& p, region& r, int x, int y, int width, int height) {
+        constexpr float scale = 1.0f / page_size;
+        r.texture = reinterpret_cast<ImTextureID>(p.texture);
+        r.width = width;
+        r.height = height;
+        r.uv0 = ImVec2{static_cast<float>(x) * scale, static_cast<float>(y) * scale};
+        r.uv1 = ImVec2{static_cast<float>(x + width) * scale, static_cast<float>(y + height) * scale};
+    }
+
+    static void upload(page& p, SDL_Rect const& area) {
+        SDL_UpdateTexture(p.texture, &area, &p.pixels[offset(area.x, area.y)], page_size * 4);
+    }
+
+    std::vector<page> pages_;
+};
+
+} // namespace rouen::helpers
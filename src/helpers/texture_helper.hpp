@@ -1,8 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <string>
 #include <SDL.h>
 #include <SDL_image.h>
 #include "debug.hpp"
+#include "http_buffer.hpp"
 
 // Add texture-specific logging macros
 #define TEXTURE_ERROR(message) LOG_COMPONENT("TEXTURE", LOG_LEVEL_ERROR, message)
@@ -48,6 +52,208 @@ namespace TextureHelper {
         return texture;
     }
 
+    // Read-only SDL_RWops over an http::buffer, reading its chunks in place. The RWops keeps
+    // the buffer alive; free it with SDL_RWclose (or let IMG_Load_RW do it).
+    inline SDL_RWops* rwopsFromBuffer(http::buffer const& data) {
+        struct cursor {
+            http::buffer data;
+            Sint64 offset;
+        };
+        auto* rw = SDL_AllocRW();
+        if (!rw) {
+            return nullptr;
+        }
+        rw->type = SDL_RWOPS_UNKNOWN;
+        rw->hidden.unknown.data1 = new cursor{data, 0};
+        rw->size = [](SDL_RWops* self) {
+            return static_cast<Sint64>(static_cast<cursor*>(self->hidden.unknown.data1)->data.size());
+        };
+        rw->seek = [](SDL_RWops* self, Sint64 offset, int whence) -> Sint64 {
+            auto* c = static_cast<cursor*>(self->hidden.unknown.data1);
+            auto const size = static_cast<Sint64>(c->data.size());
+            Sint64 base = whence == RW_SEEK_CUR ? c->offset : whence == RW_SEEK_END ? size : 0;
+            c->offset = std::clamp<Sint64>(base + offset, 0, size);
+            return c->offset;
+        };
+        rw->read = [](SDL_RWops* self, void* ptr, size_t size, size_t maxnum) -> size_t {
+            auto* c = static_cast<cursor*>(self->hidden.unknown.data1);
+            if (size == 0) {
+                return 0;
+            }
+            auto const copied = c->data.read(static_cast<size_t>(c->offset), static_cast<char*>(ptr), size * maxnum);
+            auto const objects = copied / size;
+            c->offset += static_cast<Sint64>(objects * size);   // like SDL's own RWops, stop at whole objects
+            return objects;
+        };
+        rw->write = [](SDL_RWops*, const void*, size_t, size_t) -> size_t { return 0; };
+        rw->close = [](SDL_RWops* self) {
+            delete static_cast<cursor*>(self->hidden.unknown.data1);
+            SDL_FreeRW(self);
+            return 0;
+        };
+        return rw;
+    }
+
+    // Decodes an image straight from a downloaded buffer, without a round trip through a file
+    inline SDL_Texture* loadTextureFromBuffer(SDL_Renderer* renderer, http::buffer const& data, const char* name, int& width, int& height) {
+        if (!renderer) {
+            TEXTURE_ERROR("Cannot load texture: renderer is null");
+            return nullptr;
+        }
+
+        SDL_RWops* rw = rwopsFromBuffer(data);
+        if (!rw) {
+            TEXTURE_ERROR_FMT("Failed to open image {}: {}", name, SDL_GetError());
+            return nullptr;
+        }
+
+        // IMG_Load_RW closes the RWops, releasing its reference to the buffer
+        SDL_Surface* surface = IMG_Load_RW(rw, 1);
+        if (!surface) {
+            TEXTURE_ERROR_FMT("Failed to load image {}: {}", name, IMG_GetError());
+            return nullptr;
+        }
+
+        width = surface->w;
+        height = surface->h;
+
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        SDL_FreeSurface(surface);
+        if (!texture) {
+            TEXTURE_ERROR_FMT("Failed to create texture from {}: {}", name, SDL_GetError());
+            return nullptr;
+        }
+
+        TEXTURE_INFO_FMT("Successfully loaded texture from {} ({}x{})", name, width, height);
+        return texture;
+    }
+
+    // Decodes whatever `rw` reads into an RGBA32 surface and closes it
+    inline SDL_Surface* decodeSurface(SDL_RWops* rw, const char* name) {
+        if (!rw) {
+            TEXTURE_ERROR_FMT("Failed to open image {}: {}", name, SDL_GetError());
+            return nullptr;
+        }
+        SDL_Surface* decoded = IMG_Load_RW(rw, 1);
+        if (!decoded) {
+            TEXTURE_ERROR_FMT("Failed to load image {}: {}", name, IMG_GetError());
+            return nullptr;
+        }
+        SDL_Surface* rgba = SDL_ConvertSurfaceFormat(decoded, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(decoded);
+        if (!rgba) {
+            TEXTURE_ERROR_FMT("Failed to convert image {}: {}", name, SDL_GetError());
+        }
+        return rgba;
+    }
+
+    // Decodes an image from a downloaded buffer into an RGBA32 surface. Touches no renderer,
+    // so it can run on any thread; free the result with SDL_FreeSurface.
+    inline SDL_Surface* decodeSurface(http::buffer const& data, const char* name) {
+        return decodeSurface(rwopsFromBuffer(data), name);
+    }
+
+    // Same, for an image already in memory (e.g. mapped from the image pack), read in place
+    inline SDL_Surface* decodeSurface(void const* data, size_t size, const char* name) {
+        return decodeSurface(SDL_RWFromConstMem(data, static_cast<int>(size)), name);
+    }
+
+    // The surface as a PNG file in memory; empty if it cannot be encoded
+    inline std::string encodePNG(SDL_Surface* surface) {
+        std::string png;
+        auto* rw = SDL_AllocRW();
+        if (!rw) {
+            return png;
+        }
+        rw->type = SDL_RWOPS_UNKNOWN;
+        rw->hidden.unknown.data1 = &png;
+        rw->size = [](SDL_RWops* self) {
+            return static_cast<Sint64>(static_cast<std::string*>(self->hidden.unknown.data1)->size());
+        };
+        rw->seek = [](SDL_RWops* self, Sint64, int) -> Sint64 {
+            return static_cast<Sint64>(static_cast<std::string*>(self->hidden.unknown.data1)->size());
+        };
+        rw->read = [](SDL_RWops*, void*, size_t, size_t) -> size_t { return 0; };
+        rw->write = [](SDL_RWops* self, const void* ptr, size_t size, size_t num) -> size_t {
+            static_cast<std::string*>(self->hidden.unknown.data1)->append(static_cast<char const*>(ptr), size * num);
+            return num;
+        };
+        rw->close = [](SDL_RWops* self) {
+            SDL_FreeRW(self);
+            return 0;
+        };
+        if (IMG_SavePNG_RW(surface, rw, 1) != 0) {
+            TEXTURE_ERROR_FMT("Failed to encode PNG: {}", IMG_GetError());
+            png.clear();
+        }
+        return png;
+    }
+
+    /**
+     * An RGBA32 copy of `source` shrunk to width x height (both no larger than the source).
+     * Each output pixel averages the block of source pixels it covers (weighted by alpha,
+     * so transparent pixels do not darken the edges), which keeps large downscales free of
+     * the aliasing SDL_BlitScaled would give. Leaves `source` alone; null on failure.
+     */
+    inline SDL_Surface* scaledCopy(SDL_Surface* source, int width, int height) {
+        SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!target) {
+            TEXTURE_ERROR_FMT("Failed to create {}x{} surface: {}", width, height, SDL_GetError());
+            return nullptr;
+        }
+
+        SDL_LockSurface(source);
+        auto const* in = static_cast<Uint8 const*>(source->pixels);
+        auto* out = static_cast<Uint8*>(target->pixels);
+        for (int y = 0; y < height; ++y) {
+            int const top = static_cast<int>(static_cast<long long>(y) * source->h / height);
+            int const bottom = std::max(top + 1, static_cast<int>(static_cast<long long>(y + 1) * source->h / height));
+            for (int x = 0; x < width; ++x) {
+                int const left = static_cast<int>(static_cast<long long>(x) * source->w / width);
+                int const right = std::max(left + 1, static_cast<int>(static_cast<long long>(x + 1) * source->w / width));
+                Uint64 r = 0, g = 0, b = 0, a = 0;
+                for (int sy = top; sy < bottom; ++sy) {
+                    auto const* px = in + static_cast<size_t>(sy) * static_cast<size_t>(source->pitch) + static_cast<size_t>(left) * 4;
+                    for (int sx = left; sx < right; ++sx, px += 4) {
+                        r += px[0] * px[3];
+                        g += px[1] * px[3];
+                        b += px[2] * px[3];
+                        a += px[3];
+                    }
+                }
+                auto const count = static_cast<Uint64>(bottom - top) * static_cast<Uint64>(right - left);
+                auto* dst = out + static_cast<size_t>(y) * static_cast<size_t>(target->pitch) + static_cast<size_t>(x) * 4;
+                dst[0] = a ? static_cast<Uint8>(r / a) : 0;
+                dst[1] = a ? static_cast<Uint8>(g / a) : 0;
+                dst[2] = a ? static_cast<Uint8>(b / a) : 0;
+                dst[3] = static_cast<Uint8>(a / count);
+            }
+        }
+        SDL_UnlockSurface(source);
+        return target;
+    }
+
+    /**
+     * Shrinks an RGBA32 surface to fit max_width x max_height, keeping its aspect ratio,
+     * with the box filter of scaledCopy(). Takes ownership of `source`; a surface that
+     * already fits is returned as it is.
+     */
+    inline SDL_Surface* downscaleSurface(SDL_Surface* source, int max_width, int max_height) {
+        if (!source || source->format->format != SDL_PIXELFORMAT_RGBA32 ||
+            (source->w <= max_width && source->h <= max_height)) {
+            return source;
+        }
+        double const scale = std::min(static_cast<double>(max_width) / source->w, static_cast<double>(max_height) / source->h);
+        int const width = std::max(1, static_cast<int>(source->w * scale + 0.5));
+        int const height = std::max(1, static_cast<int>(source->h * scale + 0.5));
+        SDL_Surface* target = scaledCopy(source, width, height);
+        if (!target) {
+            return source;
+        }
+        SDL_FreeSurface(source);
+        return target;
+    }
+
     // Function to create a solid color texture
     inline SDL_Texture* createSolidColorTexture(SDL_Renderer* renderer, int width, int height, Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
         if (!renderer) {
@@ -0,0 +1,378 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "../registrar.hpp"
+#include "trace.hpp"
+
+namespace rouen::helpers {
+
+/**
+ * One-shot and periodic callbacks for cards and hosts, registered as "timer_wheel". The main
+ * loop asks next_deadline() how long it may sleep and calls run_due() when it wakes, so the
+ * callbacks run on the UI thread, on time to the millisecond, and nobody has to raise
+ * requested_fps or keep a thread sleeping just to notice that time has passed. A callback
+ * with real work to do hands it to the scheduler.
+ *
+ * Timers live in a hierarchical wheel of millisecond ticks: four levels of 64 slots cover
+ * about 4.6 hours, a timer moving down a level each time its slot comes round; farther ones
+ * wait in the top level's last slot. Adding and cancelling are O(1), and firing costs nothing
+ * for the empty ticks in between: the wheel jumps from one occupied slot to the next.
+ *
+ * at(), after() and every() return a `timer` that cancels when destroyed, so a card keeps it
+ * as a member and its callbacks never outlive it. They may be called from any thread; one
+ * that is due before the loop would wake calls the `wake` given to the constructor.
+ */
+class timer_wheel : public std::enable_shared_from_this<timer_wheel> {
+public:
+    using clock = std::chrono::steady_clock;
+    using callback = std::function<void()>;
+
+    // Owns one registered timer; destroying, reassigning or cancel()ing it removes the timer
+    class timer {
+    public:
+        timer() = default;
+
+        timer(timer&& other) noexcept : wheel_(std::move(other.wheel_)), id_(std::exchange(other.id_, 0)) {}
+
+        timer& operator=(timer&& other) noexcept {
+            if (this != &other) {
+                cancel();
+                wheel_ = std::move(other.wheel_);
+                id_ = std::exchange(other.id_, 0);
+            }
+            return *this;
+        }
+
+        ~timer() {
+            cancel();
+        }
+
+        timer(timer const&) = delete;
+        timer& operator=(timer const&) = delete;
+
+        // Once this returns the callback is not running on another thread and will not run again
+        void cancel() {
+            if (auto const id = std::exchange(id_, 0); id != 0) {
+                if (auto wheel = wheel_.lock()) {
+                    wheel->cancel(id);
+                }
+            }
+        }
+
+        [[nodiscard]] explicit operator bool() const {
+            return id_ != 0;
+        }
+
+    private:
+        friend class timer_wheel;
+
+        timer(std::weak_ptr<timer_wheel> wheel, uint64_t id) : wheel_(std::move(wheel)), id_(id) {}
+
+        std::weak_ptr<timer_wheel> wheel_;
+        uint64_t id_ {0};
+    };
+
+    explicit timer_wheel(callback wake = {}) : wake_(std::move(wake)) {}
+
+    timer_wheel(timer_wheel const&) = delete;
+    timer_wheel& operator=(timer_wheel const&) = delete;
+
+    [[nodiscard]] timer at(clock::time_point when, callback fn) {
+        return add(when, clock::duration::zero(), std::move(fn));
+    }
+
+    [[nodiscard]] timer after(clock::duration delay, callback fn) {
+        return add(clock::now() + delay, clock::duration::zero(), std::move(fn));
+    }
+
+    // Every `period`, the first time one period from now; runs that were missed (a stalled
+    // loop, a suspended machine) are skipped rather than made up
+    [[nodiscard]] timer every(clock::duration period, callback fn) {
+        period = std::max<clock::duration>(period, std::chrono::milliseconds{1});
+        return add(clock::now() + period, period, std::move(fn));
+    }
+
+    // When the earliest timer is due, if there is one; the main loop sleeps until then
+    [[nodiscard]] std::optional<clock::time_point> next_deadline() {
+        std::lock_guard lock(mutex_);
+        loop_thread_ = std::this_thread::get_id();
+        auto const next = earliest();
+        armed_ = next;
+        if (next == never) {
+            return std::nullopt;
+        }
+        return origin_ + std::chrono::milliseconds{next};
+    }
+
+    // Runs the callbacks due by `now` on the calling thread; returns how many ran
+    size_t run_due(clock::time_point now = clock::now()) {
+        std::vector<uint64_t> due;
+        {
+            std::lock_guard lock(mutex_);
+            loop_thread_ = std::this_thread::get_id();
+            advance(tick_floor(now), due);
+        }
+        if (due.empty()) {
+            return 0;
+        }
+        TRACE_SPAN("SYSTEM", "timers");
+        size_t ran = 0;
+        for (auto const id : due) {
+            callback fn;
+            {
+                std::lock_guard lock(mutex_);
+                auto const pos = entries_.find(id);
+                if (pos == entries_.end()) {
+                    continue;   // cancelled by a callback that ran before it
+                }
+                fn = std::move(pos->second.fn);
+                firing_ = id;
+            }
+            fn();
+            ++ran;
+            {
+                std::lock_guard lock(mutex_);
+                if (auto const pos = entries_.find(id); pos != entries_.end()) {
+                    if (auto const period = pos->second.period; period > 0) {
+                        auto next = pos->second.deadline + period;
+                        if (next <= now_tick_) {
+                            next += (now_tick_ - next) / period * period + period;
+                        }
+                        pos->second.fn = std::move(fn);
+                        place(id, pos->second, next);
+                    } else {
+                        entries_.erase(pos);
+                    }
+                }
+            }
+            fn = nullptr;   // what it captured goes before a cancel() waiting on it returns
+            {
+                std::lock_guard lock(mutex_);
+                firing_ = 0;
+            }
+            fired_.notify_all();
+        }
+        return ran;
+    }
+
+    [[nodiscard]] size_t size() const {
+        std::lock_guard lock(mutex_);
+        return entries_.size();
+    }
+
+private:
+    static constexpr uint64_t slot_bits = 6;
+    static constexpr uint64_t slots = uint64_t{1} << slot_bits;
+    static constexpr uint64_t levels = 4;
+    static constexpr uint64_t span = uint64_t{1} << (slot_bits * levels);     // ticks the wheel covers
+    static constexpr uint64_t never = std::numeric_limits<uint64_t>::max();
+    static constexpr uint8_t unplaced = 0xff;
+
+    struct entry {
+        callback fn;
+        uint64_t deadline {0};      // tick
+        uint64_t period {0};        // ticks; 0 for a one-shot
+        uint8_t level {unplaced};
+        uint8_t slot {0};
+    };
+
+    using bucket = std::vector<uint64_t>;
+
+    static constexpr uint64_t level_shift(uint64_t level) {
+        return slot_bits * level;
+    }
+
+    // Deadlines round up and the present rounds down, so nothing fires early
+    [[nodiscard]] uint64_t tick_ceil(clock::time_point when) const {
+        if (when <= origin_) {
+            return 0;
+        }
+        auto const ms = std::chrono::ceil<std::chrono::milliseconds>(when - origin_).count();
+        return static_cast<uint64_t>(ms);
+    }
+
+    [[nodiscard]] uint64_t tick_floor(clock::time_point when) const {
+        if (when <= origin_) {
+            return 0;
+        }
+        return static_cast<uint64_t>(std::chrono::floor<std::chrono::milliseconds>(when - origin_).count());
+    }
+
+    timer add(clock::time_point when, clock::duration period, callback fn) {
+        bool wake = false;
+        uint64_t id = 0;
+        {
+            std::lock_guard lock(mutex_);
+            id = ++last_id_;
+            auto& e = entries_[id];
+            e.fn = std::move(fn);
+            e.period = static_cast<uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(period).count());
+            place(id, e, tick_ceil(when));
+            // The loop sleeps until armed_: wake it for anything sooner, unless it is the caller
+            if (e.deadline < armed_ && std::this_thread::get_id() != loop_thread_) {
+                armed_ = e.deadline;
+                wake = static_cast<bool>(wake_);
+            }
+        }
+        if (wake) {
+            wake_();
+        }
+        return timer{weak_from_this(), id};
+    }
+
+    void cancel(uint64_t id) {
+        std::unique_lock lock(mutex_);
+        auto const pos = entries_.find(id);
+        if (pos == entries_.end()) {
+            return;
+        }
+        unplace(id, pos->second);
+        entries_.erase(pos);
+        // A callback running elsewhere finishes first; from inside itself there is nothing to wait for
+        if (std::this_thread::get_id() != loop_thread_) {
+            fired_.wait(lock, [this, id] { return firing_ != id; });
+        }
+    }
+
+    // Caller holds mutex_; files the timer in the slot of the tick it is due at, or that of the
+    // level it will move down from
+    void place(uint64_t id, entry& e, uint64_t deadline) {
+        e.deadline = std::max(deadline, now_tick_ + 1);
+        auto const delta = e.deadline - now_tick_;
+        uint64_t level = 0;
+        while (level + 1 < levels && delta >= uint64_t{1} << level_shift(level + 1)) {
+            ++level;
+        }
+        // Farther than the wheel reaches: the top slot that comes round last, to be filed again then
+        auto const filed = delta < span ? e.deadline : now_tick_ + span - 1;
+        e.level = static_cast<uint8_t>(level);
+        e.slot = static_cast<uint8_t>((filed >> level_shift(level)) & (slots - 1));
+        wheel_[level][e.slot].push_back(id);
+    }
+
+    void unplace(uint64_t id, entry& e) {
+        if (e.level == unplaced) {
+            return;
+        }
+        auto& b = wheel_[e.level][e.slot];
+        if (auto const pos = std::find(b.begin(), b.end(), id); pos != b.end()) {
+            *pos = b.back();
+            b.pop_back();
+        }
+        e.level = unplaced;
+    }
+
+    // The next tick that fires a timer or moves some down a level
+    [[nodiscard]] uint64_t next_event() const {
+        auto best = never;
+        for (uint64_t i = 1; i <= slots; ++i) {
+            if (!wheel_[0][(now_tick_ + i) & (slots - 1)].empty()) {
+                best = now_tick_ + i;
+                break;
+            }
+        }
+        for (uint64_t level = 1; level < levels; ++level) {
+            auto const shift = level_shift(level);
+            auto const base = now_tick_ >> shift;
+            for (uint64_t k = 1; k <= slots; ++k) {
+                auto const tick = (base + k) << shift;
+                if (tick >= best) {
+                    break;
+                }
+                if (!wheel_[level][(base + k) & (slots - 1)].empty()) {
+                    best = tick;
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+    // The earliest deadline: the first occupied slot of each level holds that level's soonest,
+    // except at the top, where timers beyond the wheel's reach wait in the last slot
+    [[nodiscard]] uint64_t earliest() const {
+        auto best = never;
+        for (uint64_t level = 0; level < levels; ++level) {
+            auto const shift = level_shift(level);
+            auto const base = now_tick_ >> shift;
+            for (uint64_t k = 1; k <= slots; ++k) {
+                auto const& b = wheel_[level][(base + k) & (slots - 1)];
+                for (auto const id : b) {
+                    best = std::min(best, entries_.at(id).deadline);
+                }
+                if (!b.empty() && level + 1 < levels) {
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+    // Caller holds mutex_; moves time on to `target`, collecting what is due in firing order
+    void advance(uint64_t target, std::vector<uint64_t>& due) {
+        while (now_tick_ < target) {
+            now_tick_ = std::min(next_event(), target);
+            // Higher levels first: what they hand down may be due in this very tick
+            for (uint64_t level = levels - 1; level > 0; --level) {
+                auto const shift = level_shift(level);
+                if ((now_tick_ & ((uint64_t{1} << shift) - 1)) != 0) {
+                    continue;
+                }
+                auto moved = std::exchange(wheel_[level][(now_tick_ >> shift) & (slots - 1)], bucket{});
+                for (auto const id : moved) {
+                    auto& e = entries_.at(id);
+                    e.level = unplaced;
+                    if (e.deadline <= now_tick_) {
+                        due.push_back(id);
+                    } else {
+                        place(id, e, e.deadline);
+                    }
+                }
+            }
+            auto fired = std::exchange(wheel_[0][now_tick_ & (slots - 1)], bucket{});
+            for (auto const id : fired) {
+                entries_.at(id).level = unplaced;
+                due.push_back(id);
+            }
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable fired_;
+    callback wake_;
+    clock::time_point const origin_ {clock::now()};
+    uint64_t now_tick_ {0};         // the last tick advanced to
+    uint64_t armed_ {never};        // the tick the loop last planned to wake at
+    uint64_t last_id_ {0};
+    uint64_t firing_ {0};           // the timer whose callback is running, if any
+    std::thread::id loop_thread_;   // the thread that runs callbacks
+    std::unordered_map<uint64_t, entry> entries_;
+    std::array<std::array<bucket, slots>, levels> wheel_ {};
+};
+
+// The application-wide wheel registered by main(), or nullptr where there is none (the bench)
+inline std::shared_ptr<timer_wheel> timers() {
+    auto& handle = registrar::cached<timer_wheel, "timer_wheel">();
+    return handle ? handle.get() : nullptr;
+}
+
+} // namespace rouen::helpers
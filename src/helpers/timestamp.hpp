@@ -0,0 +1,353 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+// None in this file
+
+namespace timestamp {
+
+using clock = std::chrono::system_clock;
+
+/**
+ * Date/time strings as feeds, mail headers and calendar APIs write them, without streams,
+ * locales or allocations:
+ *
+ *   RFC 822 / 1123 / 2822   "Tue, 14 Apr 2020 18:16:11 +0000", "14 Apr 20 18:16 EST"
+ *   ISO 8601 / RFC 3339     "2024-12-07T06:49:08.123+01:00", "2024-12-07", "20241207T064908Z"
+ *   SQL-ish                 "2024-12-07 06:49:08", "2020/04/14 18:16:11"
+ *   Others seen in feeds    "Apr 14, 2020 18:16:11", "14/04/2020 18:16:11"
+ *
+ * Offsets and zone names (UT, GMT, Z, EST…PDT, military letters) are applied; a time written
+ * without one is read as UTC, which is how the repositories store their timestamps.
+ */
+class parser {
+public:
+    explicit parser(std::string_view text) : text_{text} {}
+
+    std::optional<clock::time_point> operator()() {
+        skip_space();
+        if (alpha()) {
+            // A day name ("Tue,") or a month first ("Apr 14, 2020")
+            auto const word = letters();
+            if (auto const m = month_named(word); m) {
+                return month_first(m);
+            }
+            skip(',');
+            skip_space();
+        }
+        auto const start = pos_;
+        auto const first = number(4);
+        if (!first) {
+            return std::nullopt;
+        }
+        auto const digits = pos_ - start;
+        if (digits == 4 && (peek('-') || peek('/'))) {
+            return year_first(*first);
+        }
+        if (digits == 4 && peek_digit()) {
+            return compact(*first);
+        }
+        if (peek('/') || peek('.')) {
+            return numeric_day_first(*first);
+        }
+        skip_space();
+        return day_first(*first);
+    }
+
+private:
+    // "2024-12-07[T ]06:49:08[.123][Z|+01:00]", also with '/'
+    std::optional<clock::time_point> year_first(int year) {
+        auto const separator = text_[pos_++];
+        auto const month = number(2);
+        if (!month || !skip(separator)) {
+            return std::nullopt;
+        }
+        auto const day = number(2);
+        if (!day) {
+            return std::nullopt;
+        }
+        if ((skip('T') || skip('t') || skip(' ')) && peek_digit()) {
+            return at(year, *month, *day, /*with_zone*/ true);
+        }
+        return date(year, *month, *day, 0);
+    }
+
+    // ISO 8601 basic format: "20241207", "20241207T064908Z"
+    std::optional<clock::time_point> compact(int high) {
+        auto const low = number(4);
+        if (!low) {
+            return std::nullopt;
+        }
+        auto const year = high;
+        auto const month = *low / 100, day = *low % 100;
+        if (!(skip('T') || skip('t'))) {
+            return date(year, month, day, 0);
+        }
+        auto const start = pos_;
+        auto const hms = number(6);
+        if (!hms || pos_ - start != 6) {
+            return std::nullopt;
+        }
+        auto const offset = zone();
+        if (!offset) {
+            return std::nullopt;
+        }
+        return date(year, month, day, (*hms / 10000) * 3600 + (*hms / 100 % 100) * 60 + *hms % 100 - *offset);
+    }
+
+    // "14 Apr 2020 18:16:11 +0000"
+    std::optional<clock::time_point> day_first(int day) {
+        auto const m = month_named(letters());
+        if (!m) {
+            return std::nullopt;
+        }
+        skip_space();
+        auto const year = full_year();
+        if (!year) {
+            return std::nullopt;
+        }
+        return rest(*year, m, day);
+    }
+
+    // "Apr 14, 2020 18:16:11"
+    std::optional<clock::time_point> month_first(int month) {
+        skip_space();
+        auto const day = number(2);
+        if (!day) {
+            return std::nullopt;
+        }
+        skip(',');
+        skip_space();
+        auto const year = full_year();
+        if (!year) {
+            return std::nullopt;
+        }
+        return rest(*year, month, *day);
+    }
+
+    // "14/04/2020", "04/14/2020": day first unless the second field cannot be a month
+    std::optional<clock::time_point> numeric_day_first(int first) {
+        auto const separator = text_[pos_++];
+        auto const second = number(2);
+        if (!second || !skip(separator)) {
+            return std::nullopt;
+        }
+        auto const year = full_year();
+        if (!year) {
+            return std::nullopt;
+        }
+        auto const [day, month] = *second > 12 ? std::pair{*second, first} : std::pair{first, *second};
+        return rest(*year, month, day);
+    }
+
+    // An optional time and zone after the date
+    std::optional<clock::time_point> rest(int year, int month, int day) {
+        skip_space();
+        if (!peek_digit()) {
+            return date(year, month, day, 0);
+        }
+        return at(year, month, day, true);
+    }
+
+    // "HH:MM[:SS[.fraction]]" and, if asked, a zone
+    std::optional<clock::time_point> at(int year, int month, int day, bool with_zone) {
+        auto const hour = number(2);
+        if (!hour || !skip(':')) {
+            return std::nullopt;
+        }
+        auto const minute = number(2);
+        if (!minute) {
+            return std::nullopt;
+        }
+        int second = 0;
+        if (skip(':')) {
+            auto const s = number(2);
+            if (!s) {
+                return std::nullopt;
+            }
+            second = *s;
+            if (skip('.') || skip(',')) {
+                while (peek_digit()) {
+                    ++pos_;     // fractions are dropped
+                }
+            }
+        }
+        auto const offset = with_zone ? zone() : std::optional<int>{0};
+        if (!offset || *hour > 24 || *minute > 59 || second > 60) {
+            return std::nullopt;
+        }
+        return date(year, month, day, *hour * 3600 + *minute * 60 + second - *offset);
+    }
+
+    // Seconds east of UTC; missing or unknown zones count as UTC
+    std::optional<int> zone() {
+        skip_space();
+        if (peek('+') || peek('-')) {
+            auto const sign = text_[pos_++] == '-' ? -1 : 1;
+            auto const start = pos_;
+            auto const hours = number(2);
+            if (!hours || pos_ - start != 2) {
+                return std::nullopt;
+            }
+            skip(':');
+            auto const minutes = peek_digit() ? number(2) : std::optional<int>{0};
+            if (!minutes) {
+                return std::nullopt;
+            }
+            return sign * (*hours * 3600 + *minutes * 60);
+        }
+        if (!alpha()) {
+            return 0;
+        }
+        auto const name = letters();
+        struct named { std::string_view name; int hours; };
+        static constexpr std::array<named, 12> zones {{
+            {"UT", 0}, {"UTC", 0}, {"GMT", 0}, {"Z", 0},
+            {"EST", -5}, {"EDT", -4}, {"CST", -6}, {"CDT", -5}, {"MST", -7}, {"MDT", -6}, {"PST", -8}, {"PDT", -7},
+        }};
+        for (auto const &z : zones) {
+            if (equal_ignoring_case(name, z.name)) {
+                return z.hours * 3600;
+            }
+        }
+        return 0;   // RFC 822 military zones and the like are unreliable: read as UTC
+    }
+
+    std::optional<clock::time_point> date(int year, int month, int day, long long seconds) const {
+        std::chrono::year_month_day const ymd {
+            std::chrono::year{year}, std::chrono::month{static_cast<unsigned>(month)}, std::chrono::day{static_cast<unsigned>(day)}};
+        if (!ymd.ok()) {
+            return std::nullopt;
+        }
+        return clock::time_point{std::chrono::sys_days{ymd}} + std::chrono::seconds{seconds};
+    }
+
+    // Four digits, or two meaning 1950-2049 (RFC 822 allows them)
+    std::optional<int> full_year() {
+        auto const start = pos_;
+        auto const year = number(4);
+        if (!year) {
+            return std::nullopt;
+        }
+        if (pos_ - start == 2) {
+            return *year + (*year < 50 ? 2000 : 1900);
+        }
+        return year;
+    }
+
+    // Up to `max` digits
+    std::optional<int> number(size_t max) {
+        int value = 0;
+        size_t count = 0;
+        while (count < max && peek_digit()) {
+            value = value * 10 + (text_[pos_++] - '0');
+            ++count;
+        }
+        return count ? std::optional<int>{value} : std::nullopt;
+    }
+
+    std::string_view letters() {
+        auto const start = pos_;
+        while (alpha()) {
+            ++pos_;
+        }
+        skip('.');  // "Sept."
+        return text_.substr(start, pos_ - start);
+    }
+
+    static int month_named(std::string_view word) {
+        static constexpr std::array<std::string_view, 12> months {
+            "jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec"};
+        if (word.size() < 3) {
+            return 0;
+        }
+        for (size_t i = 0; i < months.size(); ++i) {
+            if (equal_ignoring_case(word.substr(0, 3), months[i])) {
+                return static_cast<int>(i) + 1;
+            }
+        }
+        return 0;
+    }
+
+    static bool equal_ignoring_case(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if ((a[i] | 0x20) != (b[i] | 0x20)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool alpha() const {
+        return pos_ < text_.size() && ((text_[pos_] | 0x20) >= 'a' && (text_[pos_] | 0x20) <= 'z');
+    }
+    bool peek(char c) const { return pos_ < text_.size() && text_[pos_] == c; }
+    bool peek_digit() const { return pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9'; }
+    bool skip(char c) {
+        if (!peek(c)) {
+            return false;
+        }
+        ++pos_;
+        return true;
+    }
+    void skip_space() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\r' || text_[pos_] == '\n')) {
+            ++pos_;
+        }
+    }
+
+    std::string_view text_;
+    size_t pos_ {0};
+};
+
+inline std::optional<clock::time_point> parse_uncached(std::string_view text) {
+    return parser{text}();
+}
+
+/**
+ * parse_uncached() behind a small per-thread memo: a feed refresh meets the same few
+ * timestamps over and over (every item of a daily digest, the stored pub_date of each row).
+ * Slots are direct-mapped on a hash of the text and hold short strings inline.
+ */
+inline std::optional<clock::time_point> parse(std::string_view text) {
+    struct slot {
+        uint64_t hash {0};
+        uint8_t size {0};
+        std::array<char, 47> text {};
+        std::optional<clock::time_point> result;
+    };
+    if (text.size() > std::tuple_size_v<decltype(slot::text)>) {
+        return parse_uncached(text);
+    }
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : text) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    thread_local std::array<slot, 64> memo;
+    auto &entry = memo[hash % memo.size()];
+    if (entry.hash == hash && entry.size == text.size() && std::string_view{entry.text.data(), entry.size} == text) {
+        return entry.result;
+    }
+    entry.hash = hash;
+    entry.size = static_cast<uint8_t>(text.size());
+    std::copy(text.begin(), text.end(), entry.text.begin());
+    entry.result = parse_uncached(text);
+    return entry.result;
+}
+
+} // namespace timestamp
@@ -0,0 +1,307 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "debug.hpp"
+
+namespace rouen::helpers {
+
+/**
+ * Spans across the UI and worker threads, so "why did the UI hitch when the feeds refreshed"
+ * is one trace file. Each thread records into a ring of its own (a single writer, no locks;
+ * past ring_capacity the oldest spans are overwritten), and dump() writes what the rings hold
+ * in Chrome trace format, which chrome://tracing and ui.perfetto.dev open.
+ *
+ * Recording is off until start(), or from launch with ROUEN_TRACE=<file>, which is written at
+ * exit; while off a span costs one relaxed load. The `profiler` card starts, stops and saves.
+ * Components are the logging ones of debug.hpp (WINDOW, HTTP, SQLITE, PROCESS, RSS, GIT...);
+ * components and names must be string literals, details are copied (and cut at detail_size).
+ */
+class trace {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr size_t ring_capacity = 16384;     // spans kept per thread
+    static constexpr size_t detail_size = 48;
+
+    struct event {
+        char const* component;
+        char const* name;
+        int64_t start_ns;           // since the trace began
+        int64_t duration_ns;
+        uint32_t thread;
+        uint32_t async_id;          // 0: a span on its thread; else one of overlapping operations
+        char detail[detail_size];
+    };
+
+    // Times the enclosing scope, if recording was on when it began
+    class span {
+    public:
+        span(char const* component, char const* name, std::string_view detail = {})
+            : component_(component), name_(name) {
+            if (enabled()) {
+                copy_detail(detail_, detail);
+                start_ = clock::now();
+            }
+        }
+
+        ~span() {
+            if (start_ != clock::time_point{}) {
+                record(component_, name_, start_, clock::now(), std::string_view{detail_}, 0);
+            }
+        }
+
+        span(span const&) = delete;
+        span& operator=(span const&) = delete;
+
+    private:
+        char const* component_;
+        char const* name_;
+        clock::time_point start_ {};
+        char detail_[detail_size] {};
+    };
+
+    [[nodiscard]] static bool enabled() {
+        return state().recording.load(std::memory_order_relaxed);
+    }
+
+    static void start() {
+        state().recording.store(true, std::memory_order_relaxed);
+    }
+
+    static void stop() {
+        state().recording.store(false, std::memory_order_relaxed);
+    }
+
+    // Shows as the track name of the calling thread
+    static void name_thread(std::string name) {
+        auto& s = state();
+        std::lock_guard lock(s.mutex);
+        s.thread_names[thread_id()] = std::move(name);
+    }
+
+    // Something that ran on this thread from `start` to `end`, recorded afterwards
+    static void complete(char const* component, char const* name, clock::time_point start, clock::time_point end,
+                         std::string_view detail = {}) {
+        if (enabled()) {
+            record(component, name, start, end, detail, 0);
+        }
+    }
+
+    // An operation that overlaps others (a transfer, a child process): a track of its own
+    static void async(char const* component, char const* name, clock::time_point start, clock::time_point end,
+                      std::string_view detail = {}) {
+        if (enabled()) {
+            record(component, name, start, end, detail, state().next_async.fetch_add(1, std::memory_order_relaxed));
+        }
+    }
+
+    // Every span the rings hold, oldest first
+    [[nodiscard]] static std::vector<event> snapshot() {
+        std::vector<std::shared_ptr<ring>> rings;
+        {
+            auto& s = state();
+            std::lock_guard lock(s.mutex);
+            rings = s.rings;
+        }
+        std::vector<event> events;
+        for (auto const& r : rings) {
+            // The writer goes on meanwhile: keep only the slots it cannot have reached again
+            auto const before = r->head.load(std::memory_order_acquire);
+            auto const first = before > ring_capacity ? before - ring_capacity : 0;
+            auto const copied = events.size();
+            for (auto i = first; i < before; ++i) {
+                events.push_back(r->events[i % ring_capacity]);
+            }
+            // Slot i is rewritten by write i + ring_capacity, and write `after` may be under way
+            auto const after = r->head.load(std::memory_order_acquire);
+            auto const safe_from = std::max(first, after + 1 > ring_capacity ? after + 1 - ring_capacity : 0);
+            auto const overwritten = std::min(safe_from - first, before - first);
+            events.erase(events.begin() + static_cast<std::ptrdiff_t>(copied),
+                         events.begin() + static_cast<std::ptrdiff_t>(copied + overwritten));
+        }
+        std::sort(events.begin(), events.end(), [](event const& a, event const& b) { return a.start_ns < b.start_ns; });
+        return events;
+    }
+
+    // Writes the spans recorded so far as Chrome trace JSON
+    static bool dump(std::string const& path) {
+        auto const events = snapshot();
+        std::map<uint32_t, std::string> names;
+        {
+            auto& s = state();
+            std::lock_guard lock(s.mutex);
+            names = s.thread_names;
+        }
+        std::ofstream out(path);
+        if (!out) {
+            SYS_ERROR_FMT("Cannot write trace to {}", path);
+            return false;
+        }
+        std::string text {"{\"displayTimeUnit\":\"ms\",\"traceEvents\":["};
+        char const* separator = "";
+        for (auto const& [thread, name] : names) {
+            text += std::format("{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                                separator, thread, escaped(name));
+            separator = ",";
+        }
+        for (auto const& e : events) {
+            auto const ts = static_cast<double>(e.start_ns) / 1000.0;
+            auto const detail = escaped(std::string_view{e.detail});
+            if (e.async_id == 0) {
+                text += std::format("{}{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"detail\":\"{}\"}}}}",
+                                    separator, e.name, e.component, e.thread, ts, static_cast<double>(e.duration_ns) / 1000.0, detail);
+            } else {
+                // Async begin and end, matched by id within the category
+                text += std::format("{}{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"b\",\"id\":{},\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"args\":{{\"detail\":\"{}\"}}}}",
+                                    separator, e.name, e.component, e.async_id, e.thread, ts, detail);
+                text += std::format(",{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"e\",\"id\":{},\"pid\":1,\"tid\":{},\"ts\":{:.3f}}}",
+                                    e.name, e.component, e.async_id, e.thread, static_cast<double>(e.start_ns + e.duration_ns) / 1000.0);
+            }
+            separator = ",";
+        }
+        text += "]}\n";
+        out << text;
+        SYS_INFO_FMT("Trace of {} spans written to {}", events.size(), path);
+        return static_cast<bool>(out);
+    }
+
+    // At exit: the trace ROUEN_TRACE asked for
+    static void write_requested() {
+        if (char const* path = std::getenv("ROUEN_TRACE"); path && *path) {
+            dump(path);
+        }
+    }
+
+private:
+    struct ring {
+        std::atomic<uint64_t> head {0};     // events written so far
+        std::array<event, ring_capacity> events;
+    };
+
+    struct registry {
+        std::atomic<bool> recording {false};
+        std::atomic<uint32_t> next_thread {1};
+        std::atomic<uint32_t> next_async {1};
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ring>> rings;       // never shrinks: a thread's spans outlive it
+        std::vector<std::shared_ptr<ring>> retired;     // rings of exited threads, for the next ones
+        std::map<uint32_t, std::string> thread_names;
+        clock::time_point origin {clock::now()};
+    };
+
+    // Gives the ring back when its thread exits; the spans in it stay until overwritten
+    struct ring_holder {
+        std::shared_ptr<ring> r;
+
+        ~ring_holder() {
+            if (r) {
+                auto& s = state();
+                std::lock_guard lock(s.mutex);
+                s.retired.push_back(std::move(r));
+            }
+        }
+    };
+
+    static registry& state() {
+        // Never destroyed: threads may still end spans during static destruction
+        static registry* const instance = [] {
+            auto* r = new registry;
+            if (char const* path = std::getenv("ROUEN_TRACE"); path && *path) {
+                r->recording.store(true, std::memory_order_relaxed);
+            }
+            return r;
+        }();
+        return *instance;
+    }
+
+    static uint32_t thread_id() {
+        thread_local uint32_t const id = state().next_thread.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    static ring& local_ring() {
+        thread_local ring_holder holder;
+        if (!holder.r) {
+            auto& s = state();
+            std::lock_guard lock(s.mutex);
+            if (!s.retired.empty()) {
+                holder.r = std::move(s.retired.back());
+                s.retired.pop_back();
+            } else {
+                holder.r = std::make_shared<ring>();
+                s.rings.push_back(holder.r);
+            }
+        }
+        return *holder.r;
+    }
+
+    static void copy_detail(char (&to)[detail_size], std::string_view from) {
+        auto n = std::min(from.size(), detail_size - 1);
+        while (n < from.size() && n > 0 && (static_cast<unsigned char>(from[n]) & 0xC0) == 0x80) {
+            --n;    // not in the middle of a UTF-8 sequence
+        }
+        std::copy_n(from.data(), n, to);
+        to[n] = '\0';
+    }
+
+    static void record(char const* component, char const* name, clock::time_point start, clock::time_point end,
+                       std::string_view detail, uint32_t async_id) {
+        auto& r = local_ring();
+        auto const at = r.head.load(std::memory_order_relaxed);
+        auto& e = r.events[at % ring_capacity];
+        e.component = component;
+        e.name = name;
+        e.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - state().origin).count();
+        e.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        e.thread = thread_id();
+        e.async_id = async_id;
+        copy_detail(e.detail, detail);
+        r.head.store(at + 1, std::memory_order_release);
+    }
+
+    static std::string escaped(std::string_view text) {
+        std::string result;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+                result += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                result += std::format("\\u{:04x}", static_cast<unsigned>(c));
+            } else {
+                result += c;
+            }
+        }
+        return result;
+    }
+};
+
+} // namespace rouen::helpers
+
+#define ROUEN_TRACE_CONCAT_(a, b) a##b
+#define ROUEN_TRACE_CONCAT(a, b) ROUEN_TRACE_CONCAT_(a, b)
+
+// Scoped spans: TRACE_SPAN("SQLITE", "vacuum"); TRACE_SPAN_DETAIL("WINDOW", "render", uri)
+#define TRACE_SPAN(component, name) \
+    ::rouen::helpers::trace::span ROUEN_TRACE_CONCAT(trace_span_, __LINE__) {component, name}
+#define TRACE_SPAN_DETAIL(component, name, detail) \
+    ::rouen::helpers::trace::span ROUEN_TRACE_CONCAT(trace_span_, __LINE__) {component, name, detail}
@@ -0,0 +1,365 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <format>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// 3. All other includes
+#include "debug.hpp"
+#include "process_helper.hpp"
+#include "redraw.hpp"
+#include "sqlite.hpp"
+#include "task_scheduler.hpp"
+
+namespace rouen {
+namespace chess {
+
+// One principal variation of a search, scored for white
+struct EngineLine {
+    int multipv = 1;
+    int depth = 0;
+    std::optional<int> centipawns;
+    std::optional<int> mate;        // moves to mate; negative when black mates
+    std::string pv;                 // UCI moves, space separated
+};
+
+// Where a position's search stands: its lines by multipv, best first
+struct EngineAnalysis {
+    std::uint64_t hash = 0;
+    std::vector<EngineLine> lines;
+    bool finished = false;
+};
+
+/**
+ * The best line found for each position analyzed, kept across runs by position hash (the
+ * caller's: the position index's Zobrist hash). A line is only replaced by a deeper one.
+ */
+class EngineEvalCache {
+public:
+    static EngineEvalCache& instance() {
+        static EngineEvalCache cache{"chess_engine.db"};
+        return cache;
+    }
+
+    EngineEvalCache(const EngineEvalCache&) = delete;
+    EngineEvalCache& operator=(const EngineEvalCache&) = delete;
+
+    std::optional<EngineLine> get(std::uint64_t hash) {
+        std::optional<EngineLine> found;
+        try {
+            db_.for_each<int64_t, int64_t, int64_t, std::string_view>(
+                "SELECT depth, score, mate, pv FROM chess_eval WHERE hash = ?",
+                [&found](int64_t depth, int64_t score, int64_t mate, std::string_view pv) {
+                    EngineLine line;
+                    line.depth = static_cast<int>(depth);
+                    if (mate != 0) {
+                        line.mate = static_cast<int>(mate);
+                    } else {
+                        line.centipawns = static_cast<int>(score);
+                    }
+                    line.pv = pv;
+                    found = std::move(line);
+                }, static_cast<int64_t>(hash));
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Engine cache: cannot read a position: {}", e.what());
+        }
+        return found;
+    }
+
+    void put(std::uint64_t hash, const EngineLine& line) {
+        if (line.pv.empty() || (!line.centipawns && !line.mate)) {
+            return;
+        }
+        try {
+            db_.exec("INSERT INTO chess_eval (hash, depth, score, mate, pv) VALUES (?, ?, ?, ?, ?) "
+                     "ON CONFLICT(hash) DO UPDATE SET depth = excluded.depth, score = excluded.score, "
+                     "mate = excluded.mate, pv = excluded.pv WHERE excluded.depth > chess_eval.depth",
+                     nullptr, static_cast<int64_t>(hash), line.depth, line.centipawns.value_or(0), line.mate.value_or(0), line.pv);
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Engine cache: cannot store a position: {}", e.what());
+        }
+    }
+
+private:
+    explicit EngineEvalCache(const std::string& path) : db_{path} {
+        db_.ensure_table("chess_eval", "hash INTEGER PRIMARY KEY, depth INTEGER, score INTEGER, mate INTEGER, pv TEXT");
+    }
+
+    hosting::db::sqlite db_;
+};
+
+/**
+ * A UCI engine (Stockfish unless ROUEN_CHESS_ENGINE names another) kept running and fed
+ * positions as moves from the starting position. analyze() drops whatever the engine was
+ * doing: the old search is stopped and its remaining output ignored, so scrubbing through
+ * a game never waits on the engine. Its lines stream in as "info" arrives (current() is a
+ * copy, and a redraw is asked for); each finished search's best line goes to the cache.
+ */
+class UciEngine {
+public:
+    explicit UciEngine(int multipv = 3, std::string command = default_command())
+        : session_{std::make_shared<session>()} {
+        ProcessHelper::ProcessOptions options;
+        options.keep_stdin = true;
+        options.on_stdout = [session = session_](std::string_view chunk) { session->read(chunk); };
+        process_ = ProcessHelper::spawn({std::move(command)}, std::move(options));
+        send(std::format("uci\nsetoption name MultiPV value {}\nisready\n", multipv));
+    }
+
+    ~UciEngine() {
+        process_->write("stop\nquit\n");
+        process_->kill();
+    }
+
+    UciEngine(const UciEngine&) = delete;
+    UciEngine& operator=(const UciEngine&) = delete;
+
+    static std::string default_command() {
+        auto const* engine = std::getenv("ROUEN_CHESS_ENGINE");
+        return engine && *engine ? engine : "stockfish";
+    }
+
+    // False once the engine has exited, or could not be started (see error())
+    bool running() const { return !process_->finished(); }
+
+    std::string error() const {
+        if (!process_->finished()) {
+            return {};
+        }
+        auto const& result = process_->result().get();
+        return result.error.empty() ? std::format("The engine exited ({})", result.exit_code) : result.error;
+    }
+
+    // Searches a position until the next call (to depth, when given); the cached line shows meanwhile
+    void analyze(std::uint64_t hash, const std::string& moves, bool white_to_move, std::optional<int> depth = std::nullopt) {
+        start(hash, moves, white_to_move, depth);
+    }
+
+    void stop() { send("stop\n"); }
+
+    EngineAnalysis current() const {
+        std::lock_guard lock(session_->mutex);
+        return session_->latest;
+    }
+
+    // Searches a position to a depth and waits for the result; nothing when stopped first. For workers
+    std::optional<EngineAnalysis> search(std::uint64_t hash, const std::string& moves, bool white_to_move, int depth, std::stop_token stoken) {
+        auto const serial = start(hash, moves, white_to_move, depth);
+        std::unique_lock lock(session_->mutex);
+        bool stopping = false;
+        while (session_->finished_serial < serial) {
+            if (stoken.stop_requested() && !stopping) {
+                lock.unlock();
+                stop();
+                lock.lock();
+                stopping = true;
+            }
+            if (!running()) {
+                return std::nullopt;
+            }
+            session_->done.wait_for(lock, std::chrono::milliseconds{200});
+        }
+        if (stopping) {
+            return std::nullopt;
+        }
+        return session_->latest;
+    }
+
+private:
+    // Shared with the output callback, which can outlive the engine
+    struct session {
+        struct search {
+            std::uint64_t serial = 0;
+            bool white_to_move = true;
+            EngineAnalysis analysis;
+        };
+
+        mutable std::mutex mutex;
+        std::condition_variable done;
+        std::deque<search> open;            // asked for and not yet answered by "bestmove", oldest first
+        EngineAnalysis latest;              // of the last search asked for
+        std::uint64_t finished_serial = 0;
+        std::string partial;                // a line not yet complete
+
+        void read(std::string_view chunk) {
+            std::lock_guard lock(mutex);
+            partial.append(chunk);
+            size_t begin = 0;
+            size_t end = 0;
+            while ((end = partial.find('\n', begin)) != std::string::npos) {
+                auto line = std::string_view{partial}.substr(begin, end - begin);
+                if (line.ends_with('\r')) {
+                    line.remove_suffix(1);
+                }
+                handle(line);
+                begin = end + 1;
+            }
+            partial.erase(0, begin);
+        }
+
+        // Output belongs to the oldest open search: the engine answers them in order
+        void handle(std::string_view line) {
+            if (open.empty()) {
+                return;
+            }
+            auto& current = open.front();
+            if (line.starts_with("bestmove")) {
+                current.analysis.finished = true;
+                if (!current.analysis.lines.empty()) {
+                    // Not on the process runner's thread, which serves every process
+                    rouen::helpers::scheduler()->submit([hash = current.analysis.hash, best = current.analysis.lines.front()](std::stop_token) {
+                        EngineEvalCache::instance().put(hash, best);
+                    }, rouen::helpers::task_priority::background);
+                }
+                finished_serial = current.serial;
+                if (open.size() == 1) {
+                    latest.finished = true;
+                    if (!current.analysis.lines.empty()) {
+                        latest.lines = std::move(current.analysis.lines);
+                    }
+                }
+                open.pop_front();
+                done.notify_all();
+                rouen::helpers::request_redraw();
+            } else if (line.starts_with("info ") && line.find(" pv ") != std::string_view::npos) {
+                auto parsed = parse_info(line, current.white_to_move);
+                if (!parsed) {
+                    return;
+                }
+                auto& lines = current.analysis.lines;
+                if (static_cast<size_t>(parsed->multipv) > lines.size()) {
+                    lines.resize(static_cast<size_t>(parsed->multipv));
+                }
+                lines[static_cast<size_t>(parsed->multipv - 1)] = std::move(*parsed);
+                // Only the last search asked for is shown
+                if (open.size() == 1) {
+                    latest.lines = lines;
+                    rouen::helpers::request_redraw();
+                }
+            }
+        }
+    };
+
+    static std::optional<int> number(std::string_view text) {
+        int value = 0;
+        auto const [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc{} ? std::optional<int>{value} : std::nullopt;
+    }
+
+    // "info depth 20 seldepth 28 multipv 1 score cp 31 nodes ... pv e2e4 e7e5 ..."
+    static std::optional<EngineLine> parse_info(std::string_view line, bool white_to_move) {
+        EngineLine parsed;
+        auto next = [&line]() {
+            line.remove_prefix(std::min(line.find_first_not_of(' '), line.size()));
+            auto const end = std::min(line.find(' '), line.size());
+            auto token = line.substr(0, end);
+            line.remove_prefix(end);
+            return token;
+        };
+        for (auto token = next(); !token.empty(); token = next()) {
+            if (token == "depth") {
+                parsed.depth = number(next()).value_or(0);
+            } else if (token == "multipv") {
+                parsed.multipv = std::max(1, number(next()).value_or(1));
+            } else if (token == "score") {
+                auto const kind = next();
+                auto const value = number(next());
+                // Scores are the side to move's
+                auto const sign = white_to_move ? 1 : -1;
+                if (kind == "cp" && value) {
+                    parsed.centipawns = *value * sign;
+                } else if (kind == "mate" && value) {
+                    parsed.mate = *value * sign;
+                }
+            } else if (token == "pv") {
+                line.remove_prefix(std::min(line.find_first_not_of(' '), line.size()));
+                parsed.pv = line;
+                break;
+            }
+        }
+        if (parsed.pv.empty() || (!parsed.centipawns && !parsed.mate)) {
+            return std::nullopt;
+        }
+        return parsed;
+    }
+
+    // Stops the search under way and starts this one
+    std::uint64_t start(std::uint64_t hash, const std::string& moves, bool white_to_move, std::optional<int> depth) {
+        std::lock_guard order(command_mutex_);
+        std::uint64_t serial = 0;
+        bool searching = false;
+        {
+            std::lock_guard lock(session_->mutex);
+            searching = !session_->open.empty();
+            serial = ++serial_;
+            session_->open.push_back({serial, white_to_move, EngineAnalysis{hash}});
+            session_->latest = EngineAnalysis{hash};
+            if (auto cached = EngineEvalCache::instance().get(hash)) {
+                session_->latest.lines.push_back(std::move(*cached));
+            }
+        }
+        send(std::format("{}position startpos{}{}\ngo {}\n", searching ? "stop\n" : "",
+                         moves.empty() ? "" : " moves ", moves, depth ? std::format("depth {}", *depth) : "infinite"));
+        return serial;
+    }
+
+    void send(std::string_view commands) {
+        if (!process_->write(commands)) {
+            CHESS_WARN_FMT("The chess engine did not take: {}", commands);
+        }
+    }
+
+    std::shared_ptr<session> session_;
+    std::shared_ptr<ProcessHelper::Process> process_;
+    std::mutex command_mutex_;      // keeps commands in the order their searches were queued
+    std::uint64_t serial_ = 0;
+};
+
+/**
+ * Analyzes every position of a game to a depth, on a worker with an engine of its own, so
+ * the evaluations are in the cache when the game is stepped through. Positions already
+ * cached that deep are skipped. positions: (hash, moves from the start in UCI), in order.
+ */
+inline void analyze_positions(const std::vector<std::pair<std::uint64_t, std::string>>& positions, int depth,
+                              std::stop_token stop, const std::function<void(size_t)>& progress) {
+    std::unique_ptr<UciEngine> engine;
+    auto& cache = EngineEvalCache::instance();
+    for (size_t i = 0; i < positions.size() && !stop.stop_requested(); ++i) {
+        auto const& [hash, moves] = positions[i];
+        auto cached = cache.get(hash);
+        if (!cached || cached->depth < depth) {
+            if (!engine) {
+                engine = std::make_unique<UciEngine>(1);
+            }
+            // An even number of moves (spaces + 1) leaves white to move
+            auto const plies = moves.empty() ? 0 : std::count(moves.begin(), moves.end(), ' ') + 1;
+            auto result = engine->search(hash, moves, plies % 2 == 0, depth, stop);
+            if (result && !result->lines.empty()) {
+                // Now rather than after the engine's own write, for whoever reads on progress
+                cache.put(hash, result->lines.front());
+            } else if (!engine->running()) {
+                CHESS_ERROR_FMT("Game analysis stopped: {}", engine->error());
+                return;
+            }
+        }
+        progress(i + 1);
+    }
+}
+
+} // namespace chess
+} // namespace rouen
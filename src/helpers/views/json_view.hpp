@@ -1,80 +1,477 @@
 #pragma once
 
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
 #include <string>
+#include <string_view>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
 #include <glaze/json.hpp>
+
+// 3. All other includes
 #include "../imgui_include.hpp"
+#include "../redraw.hpp"
+#include "../session_log.hpp"
+#include "../task_scheduler.hpp"
 
 namespace rouen::helpers::views {
+
+    /**
+     * A JSON document flattened into one node per value, in document order. Keys and scalar
+     * values are views into the source text, kept raw (strings without their quotes but with
+     * their escapes). A container's children follow it; `end` is the index past its subtree.
+     */
+    struct json_tree {
+        enum class kind : uint8_t { object, array, string, number, boolean, null };
+
+        static constexpr uint32_t none = UINT32_MAX;
+
+        struct node {
+            std::string_view key;       // empty for the root and array items
+            std::string_view value;     // scalars only
+            uint32_t parent;
+            uint32_t end;
+            uint32_t children;
+            uint32_t depth;
+            uint32_t index;             // among its parent's children
+            kind type;
+        };
+
+        std::string source;
+        std::vector<node> nodes;
+        std::string error;              // what stopped the parse; the nodes before it are kept
+
+        // Parses without recursion, so nesting depth costs heap, not stack
+        static std::shared_ptr<const json_tree> parse(std::string text, std::stop_token const& stoken = {}) {
+            auto tree = std::make_shared<json_tree>();
+            tree->source = std::move(text);
+            std::string_view const s = tree->source;
+            auto& nodes = tree->nodes;
+            std::vector<uint32_t> open;
+            size_t pos = 0;
+
+            auto const skip_blanks = [&] {
+                while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\n' || s[pos] == '\r')) {
+                    ++pos;
+                }
+            };
+            auto const fail = [&](std::string_view what) {
+                tree->error = std::format("{} at offset {}", what, pos);
+                for (auto i : open) {
+                    nodes[i].end = static_cast<uint32_t>(nodes.size());
+                }
+                return tree;
+            };
+            // The text between the quotes at pos; leaves pos past the closing one
+            auto const read_string = [&](std::string_view& out) {
+                auto const start = ++pos;
+                while (pos < s.size() && s[pos] != '"') {
+                    pos += s[pos] == '\\' ? 2 : 1;
+                }
+                if (pos >= s.size()) {
+                    return false;
+                }
+                out = s.substr(start, pos - start);
+                ++pos;
+                return true;
+            };
+            auto const add = [&](kind type, std::string_view key, std::string_view value) {
+                auto const parent = open.empty() ? none : open.back();
+                auto const index = parent == none ? 0 : nodes[parent].children++;
+                nodes.push_back({key, value, parent, static_cast<uint32_t>(nodes.size() + 1), 0,
+                                 static_cast<uint32_t>(open.size()), index, type});
+                return static_cast<uint32_t>(nodes.size() - 1);
+            };
+
+            std::string_view key;
+            bool expect_key = false;        // next comes "key": inside an object
+            for (;;) {
+                if ((nodes.size() & 4095) == 0 && stoken.stop_requested()) {
+                    return fail("Cancelled");
+                }
+                skip_blanks();
+                if (pos >= s.size()) {
+                    return fail("Unexpected end");
+                }
+
+                // A value, or the close of an empty container right after its open
+                char const c = s[pos];
+                bool closed_empty = false;
+                if (expect_key) {
+                    if (c == '}' && nodes[open.back()].children == 0) {
+                        closed_empty = true;
+                    } else {
+                        if (c != '"' || !read_string(key)) {
+                            return fail("Expected a key");
+                        }
+                        skip_blanks();
+                        if (pos >= s.size() || s[pos] != ':') {
+                            return fail("Expected ':'");
+                        }
+                        ++pos;
+                        expect_key = false;
+                        continue;
+                    }
+                } else if (c == ']' && !open.empty() && nodes[open.back()].type == kind::array && nodes[open.back()].children == 0) {
+                    closed_empty = true;
+                } else if (c == '{' || c == '[') {
+                    open.push_back(add(c == '{' ? kind::object : kind::array, key, {}));
+                    key = {};
+                    ++pos;
+                    expect_key = c == '{';
+                    continue;
+                } else if (c == '"') {
+                    std::string_view value;
+                    if (!read_string(value)) {
+                        return fail("Unterminated string");
+                    }
+                    add(kind::string, key, value);
+                } else if (s.substr(pos, 4) == "true" || s.substr(pos, 4) == "null") {
+                    add(c == 'n' ? kind::null : kind::boolean, key, s.substr(pos, 4));
+                    pos += 4;
+                } else if (s.substr(pos, 5) == "false") {
+                    add(kind::boolean, key, s.substr(pos, 5));
+                    pos += 5;
+                } else if (c == '-' || (c >= '0' && c <= '9')) {
+                    auto const start = pos++;
+                    while (pos < s.size() && (std::isdigit(static_cast<unsigned char>(s[pos])) || s[pos] == '.' ||
+                                              s[pos] == 'e' || s[pos] == 'E' || s[pos] == '+' || s[pos] == '-')) {
+                        ++pos;
+                    }
+                    add(kind::number, key, s.substr(start, pos - start));
+                } else {
+                    return fail("Unexpected character");
+                }
+                key = {};
+
+                // After a value: a comma, or closing brackets
+                for (;;) {
+                    if (closed_empty) {
+                        closed_empty = false;
+                    } else {
+                        skip_blanks();
+                        if (open.empty()) {
+                            if (pos < s.size()) {
+                                return fail("Trailing text");
+                            }
+                            return tree;
+                        }
+                        if (pos >= s.size()) {
+                            return fail("Unexpected end");
+                        }
+                        if (s[pos] == ',') {
+                            ++pos;
+                            expect_key = nodes[open.back()].type == kind::object;
+                            break;
+                        }
+                    }
+                    auto const closer = nodes[open.back()].type == kind::object ? '}' : ']';
+                    if (s[pos] != closer) {
+                        return fail(closer == '}' ? "Expected ',' or '}'" : "Expected ',' or ']'");
+                    }
+                    ++pos;
+                    nodes[open.back()].end = static_cast<uint32_t>(nodes.size());
+                    open.pop_back();
+                }
+            }
+        }
+
+        // Nodes whose key or value contains `needle`, ignoring ASCII case, in document order
+        std::vector<uint32_t> search(std::string_view needle, std::stop_token const& stoken = {}) const {
+            std::vector<uint32_t> hits;
+            auto const contains = [needle](std::string_view text) {
+                return text.size() >= needle.size() &&
+                       rouen::helpers::find_bytes(text.data(), text.data() + text.size(), needle, false) != nullptr;
+            };
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if ((i & 4095) == 0 && stoken.stop_requested()) {
+                    break;
+                }
+                if (contains(nodes[i].key) || contains(nodes[i].value)) {
+                    hits.push_back(static_cast<uint32_t>(i));
+                }
+            }
+            return hits;
+        }
+    };
+
+    /**
+     * Shows one JSON document as a collapsible tree. set() hands the text to the scheduler,
+     * which flattens it into a json_tree; each frame draws only the rows in view, from the
+     * list of nodes whose ancestors are all expanded. Search runs on the scheduler too.
+     */
     class json_view {
     public:
-        void render(const glz::json_t& json, const std::string& label = "") {
+        void set(std::string text) {
+            parse_stop_.request_stop();
+            parse_stop_ = std::stop_source{};
+            auto inbox = inbox_;
+            uint64_t generation = 0;
+            {
+                std::lock_guard lock(inbox->mutex);
+                generation = ++inbox->generation;
+            }
+            rouen::helpers::scheduler()->submit([inbox, generation, text = std::move(text)](std::stop_token stoken) mutable {
+                auto tree = json_tree::parse(std::move(text), stoken);
+                if (stoken.stop_requested()) {
+                    return;
+                }
+                {
+                    std::lock_guard lock(inbox->mutex);
+                    if (generation != inbox->generation) {
+                        return;
+                    }
+                    inbox->tree = std::move(tree);
+                }
+                request_redraw();
+            }, task_priority::normal, parse_stop_);
+        }
+
+        void set(const glz::json_t& json) {
+            std::string text;
+            auto ec = glz::write_json(json, text);
+            if (ec) {
+                text = "null";
+            }
+            set(std::move(text));
+        }
+
+        [[nodiscard]] bool empty() const { return !tree_ && inbox_->generation == 0; }
+
+        void render(const std::string& label = "") {
+            take_results();
             if (!label.empty()) {
                 ImGui::Text("%s:", label.c_str());
                 ImGui::Indent();
             }
-            
-            render_json_node(json);
-            
+
+            if (!tree_) {
+                ImGui::TextDisabled("%s", inbox_->generation == 0 ? "No data" : "Parsing...");
+            } else {
+                if (!tree_->error.empty()) {
+                    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", tree_->error.c_str());
+                }
+                render_search();
+                render_rows();
+            }
+
             if (!label.empty()) {
                 ImGui::Unindent();
             }
         }
-        
+
     private:
-        void render_json_node(const glz::json_t& node) {
-            if (node.is_object()) {
-                if (ImGui::TreeNode("Object")) {
-                    for (const auto& [key, value] : node.get_object()) {
-                        ImGui::Text("%s:", key.c_str());
-                        ImGui::SameLine();
-                        render_json_value(value);
-                    }
-                    ImGui::TreePop();
-                }
-            } else if (node.is_array()) {
-                if (ImGui::TreeNode("Array")) {
-                    int index = 0;
-                    for (const auto& item : node.get_array()) {
-                        ImGui::PushID(index++);
-                        ImGui::Text("[%d]", index-1);
-                        ImGui::SameLine();
-                        render_json_value(item);
-                        ImGui::PopID();
-                    }
-                    ImGui::TreePop();
+        // What the scheduler hands back; shared so a task outliving the view has somewhere to write
+        struct inbox {
+            std::mutex mutex;
+            uint64_t generation {0};                            // of the last set(); written by the UI thread
+            std::shared_ptr<const json_tree> tree;
+            std::optional<std::vector<uint32_t>> matches;
+            uint64_t search {0};                                // the search the matches are for
+        };
+
+        static constexpr size_t shown_bytes = 256;              // of a value; the rest is elided
+        static constexpr int visible_rows = 20;                 // before the view scrolls
+
+        void take_results() {
+            std::lock_guard lock(inbox_->mutex);
+            if (inbox_->tree) {
+                tree_ = std::move(inbox_->tree);
+                expanded_.assign(tree_->nodes.size(), false);
+                if (!expanded_.empty()) {
+                    expanded_[0] = true;
+                }
+                matches_.clear();
+                current_match_ = 0;
+                rebuild_rows();
+                if (search_[0] != '\0') {
+                    start_search();
                 }
-            } else {
-                render_json_value(node);
             }
+            if (inbox_->matches && inbox_->search == search_generation_) {
+                matches_ = std::move(*inbox_->matches);
+                current_match_ = 0;
+                if (!matches_.empty()) {
+                    reveal(matches_.front());
+                }
+            }
+            inbox_->matches.reset();
         }
-        
-        void render_json_value(const glz::json_t& value) {
-            if (value.is_null()) {
-                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "null");
-            } else if (value.is_boolean()) {
-                ImGui::TextColored(ImVec4(0.5f, 0.5f, 1.0f, 1.0f), value.get_boolean() ? "true" : "false");
-            } else if (value.is_number()) {
-                double num = value.get_number();
-                // Check if the number is an integer (no fractional part)
-                if (std::abs(num - static_cast<double>(static_cast<long>(num))) < 1e-10) {
-                    ImGui::TextColored(ImVec4(0.0f, 0.8f, 0.0f, 1.0f), "%ld", static_cast<long>(num));
-                } else {
-                    // Convert to string using a type-safe approach
-                    std::string str = std::to_string(num);
-                    // Limit to max 6 characters plus decimal point to avoid excessive precision
-                    if (str.size() > 7 && str.find('.') != std::string::npos) {
-                        size_t decimal_pos = str.find('.');
-                        str = str.substr(0, decimal_pos + 4); // keep 3 digits after decimal point
-                    }
-                    ImGui::TextColored(ImVec4(0.0f, 0.8f, 0.8f, 1.0f), "%s", str.c_str());
+
+        // Nodes whose ancestors are all expanded, in document order
+        void rebuild_rows() {
+            rows_.clear();
+            auto const& nodes = tree_->nodes;
+            for (uint32_t i = 0; i < nodes.size();) {
+                rows_.push_back(i);
+                auto const container = nodes[i].type == json_tree::kind::object || nodes[i].type == json_tree::kind::array;
+                i = container && expanded_[i] ? i + 1 : nodes[i].end;
+            }
+        }
+
+        void reveal(uint32_t node) {
+            for (auto p = tree_->nodes[node].parent; p != json_tree::none; p = tree_->nodes[p].parent) {
+                expanded_[p] = true;
+            }
+            rebuild_rows();
+            auto const row = std::ranges::lower_bound(rows_, node);
+            if (row != rows_.end() && *row == node) {
+                scroll_to_row_ = static_cast<int>(row - rows_.begin());
+            }
+        }
+
+        void start_search() {
+            search_stop_.request_stop();
+            search_stop_ = std::stop_source{};
+            auto const generation = ++search_generation_;
+            matches_.clear();
+            current_match_ = 0;
+            std::string needle{search_};
+            if (needle.empty()) {
+                return;
+            }
+            rouen::helpers::scheduler()->submit([inbox = inbox_, tree = tree_, generation, needle = std::move(needle)](std::stop_token stoken) {
+                auto hits = tree->search(needle, stoken);
+                if (stoken.stop_requested()) {
+                    return;
+                }
+                {
+                    std::lock_guard lock(inbox->mutex);
+                    inbox->matches = std::move(hits);
+                    inbox->search = generation;
                 }
-            } else if (value.is_string()) {
-                ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.5f, 1.0f), "\"%s\"", value.get_string().c_str());
-            } else if (value.is_object()) {
-                render_json_node(value);
-            } else if (value.is_array()) {
-                render_json_node(value);
+                request_redraw();
+            }, task_priority::normal, search_stop_);
+        }
+
+        void render_search() {
+            ImGui::SetNextItemWidth(200.0f);
+            if (ImGui::InputTextWithHint("##json_search", "Search keys and values", search_, sizeof(search_))) {
+                start_search();
+            }
+            if (search_[0] == '\0') {
+                return;
+            }
+            ImGui::SameLine();
+            if (matches_.empty()) {
+                ImGui::TextDisabled("No matches");
+                return;
             }
+            if (ImGui::SmallButton("<")) {
+                current_match_ = (current_match_ + matches_.size() - 1) % matches_.size();
+                reveal(matches_[current_match_]);
+            }
+            ImGui::SameLine();
+            if (ImGui::SmallButton(">")) {
+                current_match_ = (current_match_ + 1) % matches_.size();
+                reveal(matches_[current_match_]);
+            }
+            ImGui::SameLine();
+            ImGui::Text("%zu of %zu", current_match_ + 1, matches_.size());
+        }
+
+        void render_rows() {
+            auto const line = ImGui::GetTextLineHeightWithSpacing();
+            auto const height = static_cast<float>(std::min<size_t>(rows_.size(), visible_rows)) * line + ImGui::GetStyle().FramePadding.y * 2;
+            if (!ImGui::BeginChild("##json_rows", ImVec2(0, height), true, ImGuiWindowFlags_HorizontalScrollbar)) {
+                ImGui::EndChild();
+                return;
+            }
+            if (scroll_to_row_ >= 0) {
+                ImGui::SetScrollY(static_cast<float>(scroll_to_row_) * line);
+                scroll_to_row_ = -1;
+            }
+
+            auto const current = matches_.empty() ? json_tree::none : matches_[current_match_];
+            bool toggled = false;
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(rows_.size()), line);
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                    auto const i = rows_[static_cast<size_t>(row)];
+                    toggled |= render_row(i, i == current);
+                }
+            }
+            ImGui::EndChild();
+            if (toggled) {
+                rebuild_rows();
+            }
+        }
+
+        // One node's row; true when a container was opened or closed
+        bool render_row(uint32_t i, bool highlighted) {
+            auto const& node = tree_->nodes[i];
+            auto const label = node.parent == json_tree::none ? std::string{"(root)"}
+                             : tree_->nodes[node.parent].type == json_tree::kind::array ? std::format("[{}]", node.index)
+                             : std::string{node.key};
+
+            ImGui::PushID(static_cast<int>(i));
+            ImGui::SetCursorPosX(ImGui::GetCursorPosX() + static_cast<float>(node.depth) * ImGui::GetStyle().IndentSpacing);
+            if (highlighted) {
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.9f, 0.3f, 1.0f));
+            }
+            bool toggled = false;
+            if (node.type == json_tree::kind::object || node.type == json_tree::kind::array) {
+                auto const summary = node.type == json_tree::kind::object ? std::format("{{{}}}", node.children) : std::format("[{}]", node.children);
+                ImGui::SetNextItemOpen(expanded_[i]);
+                auto const open = ImGui::TreeNodeEx("##node", ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanAvailWidth,
+                                                    "%s %s", label.c_str(), summary.c_str());
+                if (open != expanded_[i]) {
+                    expanded_[i] = open;
+                    toggled = true;
+                }
+            } else {
+                ImGui::TreeNodeEx("##node", ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen, "%s:", label.c_str());
+                ImGui::SameLine();
+                render_value(node);
+            }
+            if (highlighted) {
+                ImGui::PopStyleColor();
+            }
+            ImGui::PopID();
+            return toggled;
         }
+
+        static void render_value(json_tree::node const& node) {
+            auto value = node.value.substr(0, shown_bytes);
+            auto const elided = value.size() < node.value.size() ? "..." : "";
+            auto const length = static_cast<int>(value.size());
+            switch (node.type) {
+                case json_tree::kind::null:
+                    ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "null");
+                    break;
+                case json_tree::kind::boolean:
+                    ImGui::TextColored(ImVec4(0.5f, 0.5f, 1.0f, 1.0f), "%.*s", length, value.data());
+                    break;
+                case json_tree::kind::number:
+                    ImGui::TextColored(ImVec4(0.0f, 0.8f, 0.0f, 1.0f), "%.*s", length, value.data());
+                    break;
+                default:
+                    ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.5f, 1.0f), "\"%.*s%s\"", length, value.data(), elided);
+                    break;
+            }
+        }
+
+        std::shared_ptr<inbox> inbox_ {std::make_shared<inbox>()};
+        std::stop_source parse_stop_;
+        std::stop_source search_stop_;
+
+        std::shared_ptr<const json_tree> tree_;
+        std::vector<bool> expanded_;                            // by node
+        std::vector<uint32_t> rows_;                            // nodes on screen, in order
+        int scroll_to_row_ {-1};
+
+        char search_[128] {};
+        uint64_t search_generation_ {0};
+        std::vector<uint32_t> matches_;
+        size_t current_match_ {0};
     };
-}
\ No newline at end of file
+}
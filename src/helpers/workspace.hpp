@@ -0,0 +1,113 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+#include "sqlite_keyvalue.hpp"
+
+namespace rouen::helpers {
+
+    /**
+     * The deck's layout, kept in workspace.db as one row: a line per card, its width and its
+     * URI (cards keep their own settings in the URI). Startup reads that row once; save() only
+     * queues it, and the keyval store's write-behind writes the last layout queued in a burst,
+     * in one transaction, on its own thread. The first run migrates the `cards=` line of the
+     * `[rouen]` section that rouen.ini used to hold.
+     */
+    class workspace {
+    public:
+        struct slot {
+            std::string uri;
+            float width;
+        };
+
+        explicit workspace(std::string const& db_path = "workspace.db") : db_{db_path} {}
+
+        [[nodiscard]] std::vector<slot> load() {
+            if (auto saved = db_.get(layout_key)) {
+                last_saved_ = std::move(*saved);
+                return parse(last_saved_);
+            }
+            return load_legacy();
+        }
+
+        // Queues the layout, unless it is the one last saved
+        void save(std::vector<slot> const& slots) {
+            auto text = serialize(slots);
+            if (text != last_saved_) {
+                db_.set(std::string{layout_key}, text);
+                last_saved_ = std::move(text);
+            }
+        }
+
+        // Writes the queued layout now; for shutdown
+        void flush() {
+            db_.flush();
+        }
+
+    private:
+        static constexpr std::string_view layout_key {"layout"};
+
+        static std::string serialize(std::vector<slot> const& slots) {
+            std::string text;
+            for (auto const& s : slots) {
+                text += std::to_string(s.width);
+                text += ' ';
+                text += s.uri;
+                text += '\n';
+            }
+            return text;
+        }
+
+        static std::vector<slot> parse(std::string_view text) {
+            std::vector<slot> slots;
+            while (!text.empty()) {
+                auto const end = text.find('\n');
+                auto const line = text.substr(0, end);
+                if (auto const space = line.find(' '); space != std::string_view::npos && space + 1 < line.size()) {
+                    std::string const width{line.substr(0, space)};
+                    slots.push_back({std::string{line.substr(space + 1)}, std::strtof(width.c_str(), nullptr)});
+                }
+                text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+            }
+            return slots;
+        }
+
+        // The URIs rouen.ini held before, with no widths (0: the card's own)
+        static std::vector<slot> load_legacy() {
+            std::vector<slot> slots;
+            std::ifstream ini_file("rouen.ini");
+            std::string line;
+            bool in_rouen_section = false;
+            while (std::getline(ini_file, line)) {
+                if (!line.empty() && line[0] == '[') {
+                    in_rouen_section = line == "[rouen]";
+                } else if (in_rouen_section && line.starts_with("cards=")) {
+                    std::string_view uris{line};
+                    uris.remove_prefix(6);
+                    while (!uris.empty()) {
+                        auto const end = uris.find(';');
+                        if (auto const uri = uris.substr(0, end); !uri.empty()) {
+                            slots.push_back({std::string{uri}, 0.0f});
+                        }
+                        uris.remove_prefix(end == std::string_view::npos ? uris.size() : end + 1);
+                    }
+                    break;
+                }
+            }
+            return slots;
+        }
+
+        hosting::db::sqlite_keyval db_;
+        std::string last_saved_;
+    };
+
+}
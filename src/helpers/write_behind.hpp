@@ -0,0 +1,159 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "debug.hpp"
+#include "sqlite.hpp"
+
+namespace hosting::db
+{
+    /**
+     * Writes to one database, made later and together. put() queues a write under a key; a
+     * later write with the same key replaces it (the last update of a row is the one that
+     * counts, a delete supersedes an update). A background thread makes the queued writes in
+     * one transaction every `interval`, or as soon as `max_pending` keys wait; flush() does it
+     * right away and returns once they are in. Readers that must see their own writes flush
+     * first. Destruction flushes.
+     */
+    class write_behind
+    {
+    public:
+        using write_t = std::function<void(sqlite &)>;
+        // Called on the flushing thread with the keys just written, e.g. to mirror them elsewhere
+        using flushed_t = std::function<void(std::vector<std::string> const &)>;
+
+        explicit write_behind(sqlite &db, std::chrono::milliseconds interval = std::chrono::seconds{2}, size_t max_pending = 256)
+            : db_(db), interval_(interval), max_pending_(max_pending)
+        {
+            thread_ = std::jthread{[this](std::stop_token stoken) { run(stoken); }};
+        }
+
+        ~write_behind()
+        {
+            thread_.request_stop();
+            thread_.join();
+            flush();
+        }
+
+        write_behind(write_behind const &) = delete;
+        write_behind &operator=(write_behind const &) = delete;
+
+        void on_flushed(flushed_t callback)
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            flushed_ = std::move(callback);
+        }
+
+        void put(std::string key, write_t write)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (auto pos = index_.find(key); pos != index_.end()) {
+                    pending_[pos->second].second = std::move(write);
+                    return;
+                }
+                index_.emplace(key, pending_.size());
+                pending_.emplace_back(std::move(key), std::move(write));
+            }
+            wake_.notify_one();     // the first write starts the timer, a full queue goes now
+        }
+
+        // Writes everything queued so far, on the calling thread
+        void flush()
+        {
+            std::lock_guard<std::mutex> flushing(flush_mutex_);
+            std::vector<std::pair<std::string, write_t>> batch;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                batch.swap(pending_);
+                index_.clear();
+            }
+            if (batch.empty()) {
+                return;
+            }
+
+            bool in_transaction = true;
+            try {
+                db_.exec("BEGIN IMMEDIATE");
+            } catch (const std::exception &e) {
+                // Another transaction is open on the connection: the writes go in one by one
+                DB_WARN_FMT("Write-behind could not start its transaction, writing {} rows unbatched: {}", batch.size(), e.what());
+                in_transaction = false;
+            }
+            // One failed write does not take the others down with it
+            for (auto &[key, write] : batch) {
+                try {
+                    write(db_);
+                } catch (const std::exception &e) {
+                    DB_ERROR_FMT("Write-behind write for {} failed: {}", key, e.what());
+                }
+            }
+            try {
+                if (in_transaction) {
+                    db_.exec("COMMIT");
+                }
+            } catch (const std::exception &e) {
+                DB_ERROR_FMT("Write-behind commit of {} writes failed: {}", batch.size(), e.what());
+                try {
+                    db_.exec("ROLLBACK");
+                } catch (...) {
+                    // Ignore rollback errors
+                }
+                return;
+            }
+            DB_TRACE_FMT("Write-behind flushed {} writes", batch.size());
+
+            if (flushed_) {
+                std::vector<std::string> keys;
+                keys.reserve(batch.size());
+                for (auto &[key, write] : batch) {
+                    keys.push_back(std::move(key));
+                }
+                flushed_(keys);
+            }
+        }
+
+        [[nodiscard]] size_t pending() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return pending_.size();
+        }
+
+    private:
+        void run(std::stop_token stoken)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stoken.stop_requested()) {
+                // Idle until something is queued, then give the batch `interval` to fill up
+                wake_.wait(lock, stoken, [this] { return !pending_.empty(); });
+                if (stoken.stop_requested()) {
+                    break;
+                }
+                wake_.wait_for(lock, stoken, interval_, [this] { return pending_.size() >= max_pending_; });
+                lock.unlock();
+                flush();
+                lock.lock();
+            }
+        }
+
+        sqlite &db_;
+        std::chrono::milliseconds interval_;
+        size_t max_pending_;
+        mutable std::mutex mutex_;                               // guards pending_ and index_
+        std::vector<std::pair<std::string, write_t>> pending_;   // in the order first queued
+        std::unordered_map<std::string, size_t> index_;          // key -> position in pending_
+        std::condition_variable_any wake_;
+        std::mutex flush_mutex_;                                 // one flush at a time; guards flushed_
+        flushed_t flushed_;
+        std::jthread thread_;
+    };
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+// 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 2. Libraries used in the project, in alphabetic order
+// None in this file
+
+// 3. All other includes
+// None in this file
+
+namespace xml {
+
+/**
+ * Cuts an XML document arriving in chunks into complete elements at one depth.
+ *
+ * Only the element being collected is kept: markup before it is scanned once and dropped,
+ * so a document is tokenized in a single pass whatever its size or the chunk sizes.
+ * Each element is handed out as text (e.g. "<item>…</item>") for a DOM parser to read.
+ * The depth is chosen from the root element's name once it has been seen; 0 hands out nothing.
+ */
+class element_stream {
+public:
+    using depth_for = size_t (*)(std::string_view root);
+
+    explicit element_stream(depth_for depth) : depth_for_(depth) {}
+
+    // Appends a chunk; `on_element(std::string_view)` is called for every element it completes
+    template <typename F>
+    void write(std::string_view chunk, F&& on_element) {
+        if (done_) {
+            return;
+        }
+        pending_.append(chunk);
+        while (!done_) {
+            auto const open = pending_.find('<', scan_);
+            if (open == std::string::npos) {
+                scan_ = pending_.size();
+                break;
+            }
+            auto const close = markup_end(open);
+            if (close == std::string::npos) {
+                scan_ = open;   // incomplete, wait for the next chunk
+                break;
+            }
+            resume_ = 0;
+            scan_ = close;
+            markup(open, close, on_element);
+        }
+        compact();
+    }
+
+    [[nodiscard]] std::string_view root() const { return root_; }
+
+    // The root element has closed
+    [[nodiscard]] bool done() const { return done_; }
+
+private:
+    static auto constexpr npos = std::string::npos;
+
+    // One past the '>' ending the markup that starts at `open`, npos if it has not all arrived
+    size_t markup_end(size_t open) {
+        auto const available = std::string_view{pending_}.substr(open);
+        for (std::string_view prefix : {std::string_view{"<!--"}, std::string_view{"<![CDATA["}}) {
+            if (available.size() < prefix.size() && prefix.starts_with(available)) {
+                return npos;
+            }
+        }
+        if (available.starts_with("<!--")) {
+            return terminated(open, 4, "-->");
+        }
+        if (available.starts_with("<![CDATA[")) {
+            return terminated(open, 9, "]]>");
+        }
+        if (available.starts_with("<?")) {
+            return terminated(open, 2, "?>");
+        }
+        // Tags and declarations: the first '>' outside quotes (and, for a DOCTYPE, brackets)
+        char quote = 0;
+        int brackets = 0;
+        for (size_t i = open + 1; i < pending_.size(); ++i) {
+            auto const c = pending_[i];
+            if (quote) {
+                quote = c == quote ? 0 : quote;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '[') {
+                ++brackets;
+            } else if (c == ']') {
+                --brackets;
+            } else if (c == '>' && brackets <= 0) {
+                return i + 1;
+            }
+        }
+        return npos;
+    }
+
+    // Comments, CDATA and processing instructions can be long: searches resume where the last chunk ended
+    size_t terminated(size_t open, size_t prefix, std::string_view terminator) {
+        auto const from = std::max(open + prefix, resume_);
+        auto const pos = pending_.find(terminator, from);
+        if (pos == npos) {
+            resume_ = std::max(open + prefix, pending_.size() - std::min(pending_.size(), terminator.size() - 1));
+            return npos;
+        }
+        return pos + terminator.size();
+    }
+
+    template <typename F>
+    void markup(size_t open, size_t close, F& on_element) {
+        auto const tag = std::string_view{pending_}.substr(open, close - open);
+        if (tag.starts_with("<!") || tag.starts_with("<?")) {
+            return;     // comments, CDATA, declarations: not structure
+        }
+        if (tag.starts_with("</")) {
+            if (!open_.empty()) {
+                open_.pop_back();
+            }
+            if (collecting_ && open_.size() == depth_) {
+                collecting_ = false;
+                on_element(std::string_view{pending_}.substr(start_, close - start_));
+            }
+            done_ = open_.empty();
+            return;
+        }
+        auto const name = tag.substr(1, tag.find_first_of(" \t\r\n/>", 1) - 1);
+        auto const self_closing = tag.ends_with("/>");
+        if (open_.empty()) {
+            root_ = name;
+            depth_ = depth_for_(name);
+        }
+        if (depth_ && !collecting_ && open_.size() == depth_) {
+            if (self_closing) {
+                on_element(tag);
+            } else {
+                collecting_ = true;
+                start_ = open;
+            }
+        }
+        if (!self_closing) {
+            open_.emplace_back(name);
+        } else if (open_.empty()) {
+            done_ = true;
+        }
+    }
+
+    // Drops what has been scanned and is not part of the element being collected
+    void compact() {
+        auto const keep = collecting_ ? start_ : scan_;
+        if (keep == 0) {
+            return;
+        }
+        pending_.erase(0, keep);
+        scan_ -= keep;
+        start_ = collecting_ ? 0 : start_;
+        resume_ = resume_ > keep ? resume_ - keep : 0;
+    }
+
+    depth_for depth_for_;
+    std::string pending_;
+    size_t scan_ {0};            // where to look for the next '<'
+    size_t resume_ {0};          // where an unfinished terminator search continues
+    size_t start_ {0};           // start of the element being collected
+    size_t depth_ {0};
+    bool collecting_ {false};
+    bool done_ {false};
+    std::string root_;
+    std::vector<std::string> open_;
+};
+
+} // namespace xml
@@ -2,19 +2,29 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
 #include <ctime>
+#include <deque>
+#include <format>
 #include <functional>
-#include <iomanip>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <thread>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <iterator>
 
 // Include our compatibility layer for C++20/23 features
 #include "../helpers/compat/compat.hpp"
@@ -22,8 +32,18 @@
 #include "../registrar.hpp"
 #include "../helpers/fetch.hpp"
 #include "../helpers/debug.hpp"
+#include "../helpers/launcher_index.hpp"
+#include "../helpers/memory_accounting.hpp"
+#include "../helpers/redraw.hpp"
+#include "../helpers/startup_timeline.hpp"
+#include "../helpers/task_scheduler.hpp"
+#include "../helpers/timestamp.hpp"
+#include "../models/rss/episodes.hpp"
 #include "../models/rss/feed.hpp"
+#include "../models/rss/opml.hpp"
+#include "../models/rss/schedule.hpp"
 #include "../models/rss/sqliterepo.hpp"
+#include "../models/rss/summarizer.hpp"
 
 namespace rouen::hosts {
 
@@ -46,6 +66,13 @@ public:
         std::chrono::system_clock::time_point publish_date;
     };
 
+    // An item matching a search, with the part of its description that matched
+    struct SearchHit {
+        long long feed_id;
+        FeedItem item;
+        std::string snippet;
+    };
+
     // Feed information structure
     struct FeedInfo {
         long long id;
@@ -60,10 +87,43 @@ public:
     RSSHost() 
         : repo_("rss.db")
     {
-        RSS_INFO("RSSHost constructor starting...");
-        // Load existing feeds but defer loading items until they're needed
+        // Scanning the repository, importing podcasts.txt and the refresh all run in the
+        // background so the card asking for the host can show up immediately.
+        // feeds() fills in as the scan progresses; loading() tells the UI it is still going.
+        fetch_thread_ = std::jthread([this](std::stop_token stoken) {
+            rouen::helpers::memory::scope memory_tag{"host:rss"};
+            {
+                rouen::helpers::startup_timeline::scope timing{"rss_host_scan"};
+                loadFeeds();
+                // This must happen AFTER loading existing feeds so we can properly check for duplicates
+                loadPodcastsFromFile();
+                loadSchedule();
+                episodes_.load();
+            }
+            loading_.store(false, std::memory_order_release);
+            publishFeeds();
+            RSS_INFO("RSSHost starting feed refresh...");
+            refreshWorker(stoken);
+        });
+    }
+
+    // True until the feeds saved in the repository are known
+    [[nodiscard]] bool loading() const {
+        return loading_.load(std::memory_order_acquire);
+    }
+
+    ~RSSHost() {
+        RSS_INFO("RSSHost destructor starting...");
+        fetch_thread_.request_stop();
+        RSS_INFO("RSSHost destructor completed");
+    }
+
+    /**
+     * Load feed metadata from the repository; items are loaded on demand.
+     * Returns the feed URLs found.
+     */
+    std::vector<std::string> loadFeeds() {
         std::vector<std::string> urls;
-        
         try {
             RSS_INFO("RSSHost scanning feeds from repository...");
             repo_.scan_feeds([this, &urls](long long feed_id, const char* url, const char* title, const char* image_url) {
@@ -76,31 +136,14 @@ public:
                 feed_ptr->set_image(image_url ? image_url : "");
                 feed_ptr->repo_id = feed_id;
                 
-                // Don't load items here - they'll be loaded on demand
-                // Just record the feed metadata
                 std::lock_guard<std::mutex> feeds_lock(feeds_mutex_);
                 feeds_.emplace_back(feed_ptr);
                 urls.emplace_back(url ? url : "");
-                RSS_DEBUG_FMT("Added feed ID={} to collection (deferred loading)", feed_id);
             });
         } catch (const std::exception& e) {
             RSS_ERROR_FMT("Exception during RSSHost feed scanning: {}", e.what());
         }
-        
-        // Load podcasts from podcasts.txt file if it exists
-        // This must happen AFTER loading existing feeds so we can properly check for duplicates
-        loadPodcastsFromFile();
-        
-        // Refresh feeds (this will happen in a background thread)
-        RSS_INFO("RSSHost starting feed refresh in background thread...");
-        refreshFeeds(std::move(urls));
-        RSS_INFO("RSSHost constructor completed");
-    }
-
-    ~RSSHost() {
-        RSS_INFO("RSSHost destructor starting...");
-        fetch_thread_.request_stop();
-        RSS_INFO("RSSHost destructor completed");
+        return urls;
     }
 
     /**
@@ -147,11 +190,23 @@ public:
                                });
         
         if (pos != feeds_.end()) {
+            schedule_.forget((*pos)->source_link);
             feeds_.erase(pos);
             repo_.delete_feed(url);
+            publishFeedsLocked();
         }
     }
 
+    /**
+     * Bumped whenever a refresh stores new or changed items for the feed, so views can
+     * reload only the feeds that actually changed
+     */
+    uint64_t feedRevision(long long feed_id) const {
+        std::lock_guard<std::mutex> lock(revisions_mutex_);
+        auto pos = revisions_.find(feed_id);
+        return pos == revisions_.end() ? 0 : pos->second;
+    }
+
     /**
      * Get feed information by ID
      */
@@ -180,11 +235,7 @@ public:
         
         repo_.scan_items(feed_id, [&items](const char* link, const char* enclosure, const char* title, 
                                          const char* description, const char* pub_date, const char* image_url) {
-            // Parse the date string
-            std::tm tm = {};
-            std::istringstream ss(pub_date);
-            ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-            auto publish_date = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+            auto publish_date = storedDate(pub_date);
             
             // Create and store the item
             FeedItem item{
@@ -207,20 +258,120 @@ public:
         return items;
     }
     
+    /**
+     * Items of all feeds matching `query`, best match first, `limit` at a time from `offset`.
+     * Ask for the next page with offset += the size of the last one; a short page is the last.
+     */
+    std::vector<SearchHit> searchItems(std::string_view query, size_t offset, size_t limit = SEARCH_PAGE_SIZE) {
+        std::vector<SearchHit> hits;
+        hits.reserve(limit);
+        repo_.search_items(query, limit, offset, [&hits](long long feed_id, const char* link, const char* enclosure,
+                                                         const char* title, const char* snippet, const char* pub_date,
+                                                         const char* image_url) {
+            hits.push_back(SearchHit{
+                .feed_id = feed_id,
+                .item = FeedItem{
+                    .title = title,
+                    .description = {},
+                    .link = link,
+                    .enclosure = enclosure,
+                    .image_url = image_url,
+                    .publish_date = storedDate(pub_date)
+                },
+                .snippet = snippet
+            });
+        });
+        return hits;
+    }
+
+    // Whether searchItems() can find anything (the SQLite build has FTS5)
+    [[nodiscard]] bool canSearch() const {
+        return repo_.searchable();
+    }
+
+    static constexpr size_t SEARCH_PAGE_SIZE = 50;
+
+    // Where a page of feed items ends; a default-constructed cursor starts at the newest item
+    struct ItemCursor {
+        std::string pub_date;
+        std::string link;
+    };
+
+    /**
+     * The next `limit` items of a feed after `cursor`, newest first, and moves the cursor past them.
+     * A page shorter than `limit` is the last. Descriptions hold only their first
+     * ITEM_PREVIEW_LENGTH characters; getFeedItem() has the whole item.
+     */
+    std::vector<FeedItem> getFeedItemsPage(long long feed_id, ItemCursor& cursor, size_t limit) {
+        std::vector<FeedItem> items;
+        items.reserve(limit);
+        repo_.scan_items_page(feed_id, cursor.pub_date, cursor.link, limit, ITEM_PREVIEW_LENGTH,
+                              [&items, &cursor](const char* link, const char* enclosure, const char* title,
+                                                const char* description, const char* pub_date, const char* image_url) {
+            items.push_back(FeedItem{
+                .title = title,
+                .description = description,
+                .link = link,
+                .enclosure = enclosure,
+                .image_url = image_url,
+                .publish_date = storedDate(pub_date)
+            });
+            cursor.pub_date = pub_date;
+            cursor.link = link;
+        });
+        return items;
+    }
+
+    static constexpr size_t ITEM_PREVIEW_LENGTH = 200;
+
+    /**
+     * The summary of an item's article. Never blocks: an unknown one is queued and reported
+     * pending, and the UI is repainted once it has arrived.
+     */
+    media::rss::summarizer::status itemSummary(std::string const& link) {
+        return summarizer_.request(link);
+    }
+
+    // Asks again for a summary that failed
+    media::rss::summarizer::status retrySummary(std::string const& link) {
+        return summarizer_.retry(link);
+    }
+
+    [[nodiscard]] static bool canSummarize() {
+        return media::rss::summarizer::available();
+    }
+
+    /**
+     * Summarizes the newest items of a feed ahead of time, when ROUEN_RSS_PREFETCH_SUMMARIES
+     * sets how many (none by default: every summary is a paid model call)
+     */
+    void prefetchSummaries(long long feed_id) {
+        static size_t const count = [] {
+            auto const spec = std::getenv("ROUEN_RSS_PREFETCH_SUMMARIES");
+            return spec ? static_cast<size_t>(std::strtoul(spec, nullptr, 10)) : size_t{0};
+        }();
+        if (count == 0 || !canSummarize()) {
+            return;
+        }
+        ItemCursor cursor;
+        std::vector<std::string> links;
+        for (auto const& item : getFeedItemsPage(feed_id, cursor, count)) {
+            links.push_back(item.link);
+        }
+        summarizer_.prefetch(links);
+    }
+
     /**
      * Get a specific item from a feed by its link
      */
     std::optional<FeedItem> getFeedItem(long long feed_id, const std::string& item_link) {
         std::optional<FeedItem> result;
         
-        repo_.scan_items(feed_id, [&result, &item_link](const char* link, const char* enclosure, const char* title, 
+        // Looked up by key: search results can point past the newest items scan_items() returns
+        repo_.scan_item(feed_id, item_link, [&result, &item_link](const char* link, const char* enclosure, const char* title, 
                                                      const char* description, const char* pub_date, const char* image_url) {
             if (link && item_link == link) {
-                // Parse the date string
-                std::tm tm = {};
-                std::istringstream ss(pub_date);
-                ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-                auto publish_date = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+                auto publish_date = storedDate(pub_date);
                 
                 result = FeedItem{
                     .title = title ? title : "",
@@ -237,110 +388,86 @@ public:
     }
 
     /**
-     * Load podcasts from a file if it exists and directly add them to the database
-     * This checks for a podcasts.txt file in the current directory
-     * and adds any RSS feed URLs found in the file
+     * Subscribe to every feed an OPML document or a plain list of URLs names (see
+     * media::rss::parse_subscriptions). Feeds already known are skipped, the new ones are
+     * stored in one transaction, and their first fetch goes through the refresh worker like
+     * any other, so a large import never holds more than its usual transfers in flight.
+     * Returns how many feeds were added.
      */
-    void loadPodcastsFromFile() {
-        RSS_WARN("Checking for podcasts.txt file...");
-        const std::string filename = "podcasts.txt";
-        
-        // Check if file exists before attempting to read
-        if (!std::filesystem::exists(filename)) {
-            RSS_WARN("podcasts.txt file not found, skipping");
-            return;
-        }
-        
-        // Get absolute path for better debugging
-        std::filesystem::path abs_path = std::filesystem::absolute(filename);
-        RSS_WARN_FMT("Reading podcasts from {} file (absolute path: {})", filename, abs_path.string());
-        
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            RSS_ERROR_FMT("Failed to open {} file", filename);
-            return;
-        }
-        
-        // Read the file line by line
-        std::string line;
-        std::vector<std::string> podcast_urls;
-        int line_count = 0;
-        int added_count = 0;
-        
-        while (std::getline(file, line)) {
-            line_count++;
-            
-            // Skip empty lines and comments
-            if (line.empty() || line[0] == '#') {
-                RSS_DEBUG_FMT("Line {}: Skipping comment or empty line", line_count);
-                continue;
+    size_t importFeeds(std::string_view document) {
+        auto subscriptions = media::rss::parse_subscriptions(document);
+        std::vector<std::pair<std::string, std::string>> fresh;
+        {
+            std::unordered_set<std::string_view> known;
+            std::lock_guard<std::mutex> feeds_lock(feeds_mutex_);
+            known.reserve(feeds_.size() * 2 + subscriptions.size());
+            for (auto const& feed : feeds_) {
+                known.insert(feed->source_link);
+                known.insert(feed->feed_link);
             }
-            
-            // Trim whitespace
-            line.erase(0, line.find_first_not_of(" \t"));
-            if (!line.empty() && line.find_last_not_of(" \t") != std::string::npos) {
-                line.erase(line.find_last_not_of(" \t") + 1);
+            for (auto& subscription : subscriptions) {
+                if (known.insert(subscription.url).second) {
+                    auto title = subscription.title.empty() ? subscription.url : std::move(subscription.title);
+                    fresh.emplace_back(subscription.url, std::move(title));
+                }
             }
-            
-            if (!line.empty()) {
-                podcast_urls.push_back(line);
-                RSS_WARN_FMT("Line {}: Found podcast URL: {}", line_count, line);
+        }
+        RSS_INFO_FMT("Importing {} feeds ({} listed)", fresh.size(), subscriptions.size());
+        if (fresh.empty()) {
+            return 0;
+        }
+
+        auto const ids = repo_.insert_feeds(fresh);
+        std::vector<std::shared_ptr<media::rss::feed>> added;
+        added.reserve(fresh.size());
+        for (size_t i = 0; i < fresh.size(); ++i) {
+            if (ids[i] <= 0) {
+                continue;   // stored meanwhile (the startup scan may still be filling feeds_)
             }
+            // Minimal feed representation for the UI until the first fetch fills it in
+            auto feed_ptr = std::make_shared<media::rss::feed>();
+            feed_ptr->feed_title = std::move(fresh[i].second);
+            feed_ptr->source_link = fresh[i].first;
+            feed_ptr->feed_link = fresh[i].first;
+            feed_ptr->repo_id = ids[i];
+            schedule_.add(fresh[i].first, {}, {}, std::chrono::seconds{0});
+            added.push_back(std::move(feed_ptr));
         }
-        
-        RSS_WARN_FMT("Found {} URLs in podcasts.txt", podcast_urls.size());
-        
-        if (podcast_urls.empty()) {
-            RSS_WARN_FMT("No valid podcast URLs found in {}", filename);
-            return;
+        {
+            std::lock_guard<std::mutex> feeds_lock(feeds_mutex_);
+            feeds_.insert(feeds_.end(), added.begin(), added.end());
+            publishFeedsLocked();
         }
-        
-        RSS_WARN_FMT("Processing {} podcasts from {}", podcast_urls.size(), filename);
-        
-        // Directly process each URL and add it to the database
-        for (const auto& url : podcast_urls) {
-            // First check if this URL already exists in the repository
-            bool exists = false;
-            {
-                std::lock_guard<std::mutex> feeds_lock(feeds_mutex_);
-                for (const auto& feed : feeds_) {
-                    if (feed->source_link == url || feed->feed_link == url) {
-                        RSS_WARN_FMT("Podcast already exists: {}", url);
-                        exists = true;
-                        break;
-                    }
-                }
+        announce_.store(true, std::memory_order_release);
+        return added.size();
+    }
+
+    // importFeeds() with the contents of a file; 0 when it cannot be read
+    size_t importFile(std::filesystem::path const& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            RSS_ERROR_FMT("Failed to open {}", path.string());
+            return 0;
+        }
+        std::string document{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+        return importFeeds(document);
+    }
+
+    /**
+     * Subscribe to the feeds listed in podcasts.txt or podcasts.opml, if either is in the
+     * current directory
+     */
+    void loadPodcastsFromFile() {
+        for (auto const* filename : {"podcasts.txt", "podcasts.opml"}) {
+            if (!std::filesystem::exists(filename)) {
+                RSS_DEBUG_FMT("{} not found, skipping", filename);
+                continue;
             }
-            
-            if (!exists) {
-                RSS_WARN_FMT("Adding new podcast URL to database: {}", url);
-                // Directly add to database with default values
-                long long feed_id = repo_.upsert_feed(url, url, "");
-                
-                if (feed_id > 0) {
-                    // Create minimal feed representation for the UI
-                    auto feed_ptr = std::make_shared<media::rss::feed>();
-                    feed_ptr->feed_title = url;  // Use URL as title initially
-                    feed_ptr->source_link = url;
-                    feed_ptr->feed_link = url;
-                    feed_ptr->repo_id = feed_id;
-                    
-                    // Add to in-memory collection
-                    std::lock_guard<std::mutex> feeds_lock(feeds_mutex_);
-                    feeds_.emplace_back(feed_ptr);
-                    added_count++;
-                    RSS_WARN_FMT("Added feed ID={} to database and memory", feed_id);
-                } else {
-                    RSS_ERROR_FMT("Failed to add podcast to database: {}", url);
-                }
+            RSS_INFO_FMT("Reading podcasts from {}", std::filesystem::absolute(filename).string());
+            if (auto const added = importFile(filename); added > 0) {
+                "notify"_sfn(std::format("Added {} new podcasts from {}", added, filename));
             }
         }
-        
-        RSS_WARN_FMT("Directly added {} new podcasts from {}", added_count, filename);
-        
-        if (added_count > 0) {
-            "notify"_sfn(std::format("Added {} new podcasts from {}", added_count, filename));
-        }
     }
 
     /**
@@ -385,7 +512,41 @@ public:
         }
     }
 
+    /**
+     * What to play for an enclosure: the downloaded copy when there is one, else the URL.
+     * Call it as playback starts; it counts as a use for the episode cache's LRU order.
+     */
+    std::string episodeSource(std::string const& enclosure) {
+        if (auto local = episodes_.local_file(enclosure); local) {
+            return local->string();
+        }
+        return enclosure;
+    }
+
 private:
+    static constexpr int FEED_HEDGE_AFTER_MS = 5000;
+
+    // The feeds as the launcher's "feeds", each opening its own card
+    void publishFeeds() {
+        std::lock_guard<std::mutex> feeds_lock(feeds_mutex_);
+        publishFeedsLocked();
+    }
+
+    void publishFeedsLocked() {
+        rouen::helpers::request_redraw();
+        auto launcher = rouen::helpers::launcher_index::shared();
+        if (!launcher) {
+            return;
+        }
+        std::vector<rouen::helpers::launch_target> targets;
+        targets.reserve(feeds_.size());
+        for (auto const& feed : feeds_) {
+            targets.push_back({feed->feed_title.empty() ? feed->source_link : feed->feed_title,
+                               std::format("rss-feed:{}", feed->repo_id)});
+        }
+        launcher->publish("feeds", std::move(targets));
+    }
+
     // Callback for the HTTP fetch operation
     static size_t writeCallback(void* contents, size_t size, size_t nmemb, void* userp) {
         auto parser = static_cast<media::rss::feed*>(userp);
@@ -393,106 +554,235 @@ private:
         return size * nmemb;
     }
 
-    // Refresh feeds in a background thread with performance improvements
+    // Fetch these feeds as soon as the refresh worker has a free slot, and report the outcome
     void refreshFeeds(std::vector<std::string> urls) {
-        // Define how many feeds to process in parallel
-        const int BATCH_SIZE = 5;
+        for (auto const& url : urls) {
+            schedule_.refresh_now(url);
+        }
+        announce_.store(true, std::memory_order_release);
+    }
+
+    // Every known feed gets a timer; those never fetched before (or without saved history) are due now
+    void loadSchedule() {
+        auto from_epoch = [](long long seconds) {
+            return media::rss::schedule::clock::time_point{std::chrono::seconds{seconds}};
+        };
+        repo_.scan_schedule([this, &from_epoch](const char* url, long long checked, long long changed, long long interval) {
+            schedule_.add(url, from_epoch(checked), from_epoch(changed), std::chrono::seconds{interval});
+        });
+        std::lock_guard<std::mutex> feeds_lock(feeds_mutex_);
+        for (auto const& feed : feeds_) {
+            if (!feed->source_link.empty()) {
+                schedule_.add(feed->source_link, {}, {}, std::chrono::seconds{0});
+            }
+        }
+    }
+
+    // A feed download running on the shared HTTP engine, parsed as the data streams in
+    struct pending_feed {
+        std::string url;
+        std::shared_ptr<media::rss::feed> feed;
+        std::future<http::response> result;  // body-less: the parser consumed it
+        http::engine::transfer transfer;
+        media::rss::schedule::clock::time_point started;
+    };
+
+    // Indices of finished downloads, in completion order
+    struct finished_queue {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<size_t> indices;
+
+        void push(size_t index) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                indices.push_back(index);
+            }
+            ready.notify_one();
+        }
+
+        std::optional<size_t> pop(std::chrono::milliseconds wait) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!ready.wait_for(lock, wait, [this]() { return !indices.empty(); })) {
+                return std::nullopt;
+            }
+            auto index = indices.front();
+            indices.pop_front();
+            return index;
+        }
+    };
+
+    // `stored`: the feed is already in the repository, so an unchanged response can be skipped.
+    // `on_done` runs on the engine's I/O thread once `result` is ready.
+    static pending_feed startFeedFetch(std::string const& url, bool stored, std::function<void()> on_done = {}) {
+        pending_feed pending;
+        pending.url = url;
+        pending.started = media::rss::schedule::clock::now();
+        pending.feed = std::make_shared<media::rss::feed>();
+        pending.feed->source_link = url;
+        auto done = std::make_shared<std::promise<http::response>>();
+        pending.result = done->get_future();
+
+        auto req = http::fetch{60}.adaptive().make_request(url, { // 60s is only the ceiling for large feeds
+            "User-Agent: Rouen RSS Reader/1.0",
+            "Accept: application/rss+xml, application/xml, text/xml, */*"
+        });
+        req.write = writeCallback;
+        req.write_data = pending.feed.get();
+        // Revalidate with the stored ETag / Last-Modified; unchanged feeds skip parsing and storing
+        req.cached = true;
+        req.skip_unchanged = stored;
+        // A feed server that has not answered by then gets a second request racing the first
+        req.hedge_after = std::chrono::milliseconds(FEED_HEDGE_AFTER_MS);
+        // The callback keeps the parser alive until the engine is done writing into it
+        pending.transfer = http::engine::instance().submit(std::move(req),
+            [done, feed = pending.feed, on_done = std::move(on_done)](http::response response) {
+                done->set_value(std::move(response));
+                if (on_done) {
+                    on_done();
+                }
+            });
+        return pending;
+    }
+
+    bool isStored(std::string const& url) {
+        std::lock_guard<std::mutex> lock(feeds_mutex_);
+        return std::any_of(feeds_.begin(), feeds_.end(), [&url](auto const& f) {
+            return f->source_link == url;
+        });
+    }
+
+    // Runs until the host goes away, fetching each feed when the schedule says it is due
+    void refreshWorker(std::stop_token stoken) {
+        // Downloads kept running at once; each finished one is replaced right away,
+        // so a slow feed only holds its own slot
+        const size_t MAX_IN_FLIGHT = 16;
         
-        fetch_thread_ = std::jthread([this, urls = std::move(urls)] (std::stop_token stoken) {
-            auto quit_job = [stoken]() -> bool {
-                return "quitting"_fnb() || stoken.stop_requested();
-            };
+        auto quit_job = [stoken]() -> bool {
+            return "quitting"_fnb() || stoken.stop_requested();
+        };
+        
+        // Refreshes come in bursts; only those started at launch or by adding feeds are announced
+        int success_count = 0;
+        int error_count = 0;
+        size_t processed = 0;
+        size_t started = 0;
+        bool announce = false;
+        
+        auto finished = std::make_shared<finished_queue>();
+        std::unordered_map<size_t, pending_feed> in_flight;
+        size_t next = 0;
+        while (!quit_job()) {
+            // Top up the window with whatever is due; no thread waits on the network for any of them
+            if (in_flight.size() < MAX_IN_FLIGHT) {
+                for (auto const& url : schedule_.take_due(media::rss::schedule::clock::now(), MAX_IN_FLIGHT - in_flight.size())) {
+                    announce = announce_.exchange(false, std::memory_order_acq_rel) || announce;
+                    RSS_INFO_FMT("Starting to process feed: {}", url);
+                    in_flight.emplace(next, startFeedFetch(url, isStored(url),
+                        [finished, index = next]() { finished->push(index); }));
+                    ++next;
+                    ++started;
+                }
+            }
             
-            // Track successful feeds for notification purposes
-            int success_count = 0;
-            int error_count = 0;
+            // Wake up now and then to notice quitting and feeds coming due
+            auto const index = finished->pop(std::chrono::milliseconds(200));
+            if (!index) {
+                continue;
+            }
+            auto node = in_flight.extract(*index);
+            auto& pending = node.mapped();
+            ++processed;
             
-            // Process feeds in batches to balance performance
-            for (size_t i = 0; i < urls.size(); i += BATCH_SIZE) {
-                // Create a batch of worker threads
-                std::vector<std::jthread> workers;
-                std::mutex results_mutex;
-                std::vector<std::shared_ptr<media::rss::feed>> batch_results;
-                
-                // Process up to BATCH_SIZE feeds in parallel
-                size_t end = std::min(i + BATCH_SIZE, urls.size());
-                
-                for (size_t j = i; j < end; ++j) {
-                    if (quit_job()) break;
-                    
-                    workers.emplace_back([this, &urls, j, &results_mutex, &batch_results, &success_count, 
-                                         &error_count, &quit_job](std::stop_token worker_stoken) {
-                        // Create a composite quit check that includes the worker thread's stop token
-                        auto worker_quit = [worker_stoken, &quit_job]() -> bool {
-                            return quit_job() || worker_stoken.stop_requested();
-                        };
-                        
-                        try {
-                            // Only attempt to add the feed if we're not quitting
-                            if (!worker_quit()) {
-                                RSS_INFO_FMT("Starting to process feed: {}", urls[j]);
-                                auto feed_ptr = addFeedSync(urls[j], worker_quit);
-                                
-                                if (feed_ptr) {
-                                    RSS_INFO_FMT("Successfully fetched and processed feed: {}", urls[j]);
-                                    std::lock_guard<std::mutex> lock(results_mutex);
-                                    batch_results.push_back(feed_ptr);
-                                    ++success_count;
-                                    
-                                    // Update the UI periodically to show progress
-                                    if (success_count % 5 == 0) {
-                                        "notify"_sfn(std::format("Progress: {} RSS feeds loaded so far...", success_count));
-                                    }
-                                }
-                            }
-                        } catch (const std::exception& e) {
-                            RSS_ERROR_FMT("Failed to add feed {}: {}", urls[j], e.what());
-                            "notify"_sfn(std::format("Failed to add feed {}", urls[j]));
-                            
-                            std::lock_guard<std::mutex> lock(results_mutex);
-                            ++error_count;
-                        } catch (...) {
-                            RSS_ERROR_FMT("Failed to add feed {} with unknown error", urls[j]);
-                            
-                            std::lock_guard<std::mutex> lock(results_mutex);
-                            ++error_count;
-                        }
-                    });
-                }
-                
-                // Wait for all workers in this batch to complete
-                for (auto& worker : workers) {
-                    worker.join();
+            media::rss::schedule::outcome outcome;
+            auto const response = pending.result.get();
+            if (!response.ok()) {
+                RSS_ERROR_FMT("Failed to add feed {}: {}", pending.url, response.error);
+                if (announce) {
+                    "notify"_sfn(std::format("Failed to add feed {}", pending.url));
                 }
-                
-                if (quit_job()) break;
-                
-                // If we've processed at least 10 feeds, notify the user of the current progress
-                if (i + BATCH_SIZE >= 10 && success_count > 0) {
-                    "notify"_sfn(std::format("Loaded {} out of {} RSS feeds so far...", 
-                                             success_count, urls.size()));
+                ++error_count;
+            }
+            else if (response.status == 304) {
+                RSS_DEBUG_FMT("Feed unchanged: {}", pending.url);
+                outcome.ok = true;
+                ++success_count;
+            }
+            else {
+                try {
+                    RSS_INFO_FMT("Successfully fetched feed: {} - Title: {}", pending.url, pending.feed->feed_title);
+                    storeFeed(pending.url, pending.feed);
+                    RSS_INFO_FMT("Successfully fetched and processed feed: {}", pending.url);
+                    outcome.ok = true;
+                    outcome.modified = true;
+                    outcome.declared = pending.feed->declared_interval();
+                    for (auto const& item : pending.feed->items) {
+                        outcome.item_dates.push_back(item.updated);
+                    }
+                    ++success_count;
+                    
+                    // Update the UI periodically to show progress
+                    if (announce && success_count % 5 == 0) {
+                        "notify"_sfn(std::format("Progress: {} RSS feeds loaded so far...", success_count));
+                    }
+                } catch (const std::exception& e) {
+                    RSS_ERROR_FMT("Failed to add feed {}: {}", pending.url, e.what());
+                    if (announce) {
+                        "notify"_sfn(std::format("Failed to add feed {}", pending.url));
+                    }
+                    ++error_count;
                 }
             }
             
-            // Final notification
-            if (success_count > 0) {
-                "notify"_sfn(std::format("Successfully loaded {} RSS feeds. Restart the RSS card to see all feeds.", success_count));
+            if (auto const planned = schedule_.completed(pending.url, outcome, pending.started); planned) {
+                auto epoch = [](media::rss::schedule::clock::time_point t) -> long long {
+                    return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+                };
+                repo_.save_schedule(pending.url, epoch(planned->checked), epoch(planned->changed), planned->interval.count());
+                RSS_DEBUG_FMT("Next check of {} in about {} min", pending.url, planned->interval.count() / 60);
             }
             
-            if (error_count > 0) {
-                "notify"_sfn(std::format("{} feeds failed to load. Check the logs for details.", error_count));
+            // Every ten feeds, notify the user of the current progress
+            if (announce && processed % 10 == 0 && success_count > 0) {
+                "notify"_sfn(std::format("Loaded {} out of {} RSS feeds so far...", 
+                                         success_count, started));
             }
-        });
+            
+            if (in_flight.empty()) {
+                RSS_INFO_FMT("Feed refresh done: {} fetched, {} failed", success_count, error_count);
+                if (announce && success_count > 0) {
+                    "notify"_sfn(std::format("Successfully loaded {} RSS feeds. Restart the RSS card to see all feeds.", success_count));
+                }
+                if (announce && error_count > 0) {
+                    "notify"_sfn(std::format("{} feeds failed to load. Check the logs for details.", error_count));
+                }
+                success_count = 0;
+                error_count = 0;
+                processed = 0;
+                started = 0;
+            }
+        }
+        
+        for (auto& [_, pending] : in_flight) {
+            pending.transfer.cancel();
+        }
     }
 
     // Synchronously add a feed
     std::shared_ptr<media::rss::feed> addFeedSync(std::string_view url, auto quitting) {
-        try {
-            // Download and parse the feed
-            auto feed_ptr = std::make_shared<media::rss::feed>(getFeed(url));
-            
-            if (quitting()) return nullptr;
+        // Download and parse the feed
+        auto feed_ptr = std::make_shared<media::rss::feed>(getFeed(url));
+        
+        if (quitting()) return nullptr;
+
+        return storeFeed(url, std::move(feed_ptr));
+    }
 
+    // Merge a downloaded feed into feeds_ and persist it. Items stay resident without their
+    // descriptions: those are read back from the repository when a view needs them
+    std::shared_ptr<media::rss::feed> storeFeed(std::string_view url, std::shared_ptr<media::rss::feed> feed_ptr) {
+        try {
+            auto const fetched = feed_ptr;  // what was just parsed, descriptions included
             std::lock_guard<std::mutex> feeds_lock(feeds_mutex_);
             auto& feeds = feeds_;
             
@@ -503,7 +793,8 @@ private:
                                   });
                                   
             // Add or merge with existing feed
-            if (pos != feeds.end()) {
+            bool const added = pos == feeds.end();
+            if (!added) {
                 // Update the existing feed
                 feed_ptr->repo_id = (*pos)->repo_id;
                 (*pos)->feed_title = feed_ptr->feed_title;
@@ -518,7 +809,9 @@ private:
                                                   return i.link == ourlink;
                                               });
                     if (item_pos == (*pos)->items.end()) {
-                        (*pos)->items.emplace_back(item);
+                        auto& kept = (*pos)->items.emplace_back(item);
+                        kept.description.clear();
+                        kept.description.shrink_to_fit();
                     }
                 }
                 feed_ptr = *pos;
@@ -528,12 +821,15 @@ private:
             
             // Update the repository with feed info
             feed_ptr->repo_id = repo_.upsert_feed(url, feed_ptr->feed_title, feed_ptr->image_url());
+            if (added) {
+                publishFeedsLocked();
+            }
             
             // Prepare items for batch insert
             std::vector<std::tuple<std::string, std::string, std::string, std::string, std::string, std::string>> items_batch;
-            items_batch.reserve(feed_ptr->items.size());
+            items_batch.reserve(fetched->items.size());
             
-            for (auto const& item : feed_ptr->items) {
+            for (auto const& item : fetched->items) {
                 // Format the date time
                 auto const pub_date = std::format("{:%F %T}", item.updated, item.updated);
                 
@@ -548,18 +844,37 @@ private:
                 );
             }
             
-            // Perform batch insert for better performance
-            if (!items_batch.empty()) {
-                repo_.batch_upsert_items(feed_ptr->repo_id, items_batch);
+            // Only new or edited items are written
+            auto const counts = repo_.batch_upsert_items(feed_ptr->repo_id, items_batch);
+            RSS_DEBUG_FMT("Stored {}: {} new, {} updated, {} unchanged items",
+                          url, counts.inserted, counts.updated, counts.unchanged);
+            if (fetched == feed_ptr) {
+                for (auto& item : feed_ptr->items) {
+                    item.description.clear();
+                    item.description.shrink_to_fit();
+                }
+            }
+            
+            // Not on a feed's first fetch: its back catalogue is not new
+            if (counts.inserted > 0 && counts.updated + counts.unchanged > 0) {
+                prefetchEpisodes(*fetched, counts.inserted);
             }
             
-            // Sort the feeds from the latest updated to the oldest
-            std::sort(feeds.begin(), feeds.end(),
-                    [](auto const& lhs, auto const& rhs) {
-                        return lhs->items.empty() ? false : 
-                              (rhs->items.empty() ? true : 
-                                lhs->items.front().updated > rhs->items.front().updated);
-                    });
+            if (counts.changed()) {
+                {
+                    std::lock_guard<std::mutex> revisions_lock(revisions_mutex_);
+                    ++revisions_[feed_ptr->repo_id];
+                }
+                rouen::helpers::request_redraw();
+                
+                // Sort the feeds from the latest updated to the oldest
+                std::sort(feeds.begin(), feeds.end(),
+                        [](auto const& lhs, auto const& rhs) {
+                            return lhs->items.empty() ? false : 
+                                  (rhs->items.empty() ? true : 
+                                    lhs->items.front().updated > rhs->items.front().updated);
+                        });
+            }
                     
             return feed_ptr;
         } catch (const std::exception& e) {
@@ -574,6 +889,7 @@ private:
         try {
             RSS_INFO_FMT("Starting feed fetch for URL: {}", url);
             http::fetch fetch{60}; // Increase timeout for large feeds
+            fetch.cached();
             media::rss::feed parser;
             parser.source_link = url;
             
@@ -593,12 +909,66 @@ private:
     }
 
 private:
+    /**
+     * Downloads the enclosures of the newest items of a feed that just got `fresh` new ones:
+     * at most ROUEN_RSS_PREFETCH_EPISODES of them (2 by default, 0 turns prefetching off)
+     */
+    void prefetchEpisodes(media::rss::feed const& fetched, size_t fresh) {
+        static size_t const per_feed = [] {
+            auto const spec = std::getenv("ROUEN_RSS_PREFETCH_EPISODES");
+            return spec ? static_cast<size_t>(std::strtoul(spec, nullptr, 10)) : size_t{2};
+        }();
+        std::vector<media::rss::feed::item const*> newest;
+        for (auto const& item : fetched.items) {
+            if (!item.enclosure.empty()) {
+                newest.push_back(&item);
+            }
+        }
+        auto const count = std::min({per_feed, fresh, newest.size()});
+        if (count == 0) {
+            return;
+        }
+        std::partial_sort(newest.begin(), newest.begin() + static_cast<std::ptrdiff_t>(count), newest.end(),
+                          [](auto const* lhs, auto const* rhs) { return lhs->updated > rhs->updated; });
+        std::vector<std::string> urls;
+        for (size_t i = 0; i < count; ++i) {
+            urls.push_back(newest[i]->enclosure);
+        }
+        episodes_.prefetch(urls);
+    }
+
+    // Disk budget and bandwidth of the episode downloads, from ROUEN_RSS_EPISODE_CACHE_MB
+    // (2048 by default) and ROUEN_RSS_EPISODE_RATE_KB, in KiB/s (1024 by default, 0 for no cap)
+    static media::rss::episodes::limits episodeLimits() {
+        auto setting = [](char const* name, uint64_t fallback) {
+            auto const spec = std::getenv(name);
+            return spec ? static_cast<uint64_t>(std::strtoull(spec, nullptr, 10)) : fallback;
+        };
+        return {
+            .max_bytes = setting("ROUEN_RSS_EPISODE_CACHE_MB", 2048) << 20,
+            .max_rate = setting("ROUEN_RSS_EPISODE_RATE_KB", 1024) << 10,
+        };
+    }
+
+    // pub_date as storeFeed() writes it ("%F %T" in UTC)
+    static std::chrono::system_clock::time_point storedDate(const char* pub_date) {
+        return timestamp::parse(pub_date ? pub_date : "").value_or(std::chrono::system_clock::time_point{});
+    }
+
     // Thread-safe collection of feeds using mutex instead of atomic
     std::vector<std::shared_ptr<media::rss::feed>> feeds_;
     std::mutex feeds_mutex_;
     
-    std::jthread fetch_thread_;
+    // The repository must outlive the fetch thread, which is joined first on destruction
     media::rss::sqliterepo repo_;
+    media::rss::schedule schedule_;
+    media::rss::summarizer summarizer_ {repo_, [] { rouen::helpers::request_redraw(); }};
+    media::rss::episodes episodes_ {repo_, "cache/episodes", episodeLimits()};
+    std::unordered_map<long long, uint64_t> revisions_;    // feedRevision()
+    mutable std::mutex revisions_mutex_;
+    std::atomic<bool> loading_ {true};
+    std::atomic<bool> announce_ {true};     // report the next refresh burst to the user
+    std::jthread fetch_thread_;
 };
 
 } // namespace rouen::hosts
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -11,11 +13,22 @@
 #include "../models/travel/plan.hpp"
 #include "../models/travel/sqliterepo.hpp"
 #include "../helpers/debug.hpp" // Add debug header
+#include "../helpers/memory_accounting.hpp"
+#include "../helpers/redraw.hpp"
 
 namespace rouen::hosts {
 
+/**
+ * Travel plans for the travel cards. The plan list is an immutable snapshot: plans() hands
+ * out the current one by pointer and every change builds a new list (sharing the untouched
+ * plans) and swaps it in, so readers never lock or copy. An edit reloads just the plan it
+ * touched and tells the subscribers which plan changed.
+ */
 class TravelHost {
 public:
+    using plan_ptr = std::shared_ptr<const media::travel::plan>;
+    using plan_list = std::vector<plan_ptr>;
+
     TravelHost() 
         : repo_("travel.db"),
           initialized_(false),
@@ -24,6 +37,7 @@ public:
         
         // Start initialization in a separate thread to avoid blocking
         std::thread init_thread([this] {
+            rouen::helpers::memory::scope memory_tag{"host:travel"};
             initialize_async();
         });
         init_thread.detach(); // Let it run independently
@@ -53,42 +67,30 @@ public:
             }
             
             // Create a temporary vector to hold plans
-            std::vector<std::shared_ptr<media::travel::plan>> new_plans;
+            plan_list new_plans;
             
             // Load the plans from the database
             DB_INFO("TravelHost: Loading plans from database asynchronously");
             
-            // Try to catch any specific issues during the scan_plans call
+            // Plans and destinations in one pass each
             try {
-                repo_.scan_plans([this, &new_plans](long long id, const char* , const char* , 
-                                 const char* , const char* ) {
-                    DB_INFO_FMT("TravelHost: Loading plan {} from database", id);
-                    
-                    try {
-                        auto plan = std::make_shared<media::travel::plan>();
-                        if (repo_.get_plan(id, *plan)) {
-                            new_plans.push_back(plan);
-                        } else {
-                            DB_WARN_FMT("TravelHost: Failed to load plan {} details", id);
-                        }
-                    } catch (const std::exception& e) {
-                        DB_ERROR_FMT("TravelHost: Exception loading plan {}: {}", id, e.what());
-                    }
-                });
+                for (auto& plan : repo_.load_plans()) {
+                    new_plans.push_back(std::make_shared<media::travel::plan>(std::move(plan)));
+                }
                 
-                DB_INFO_FMT("TravelHost: Loaded {} plans during scan", new_plans.size());
+                DB_INFO_FMT("TravelHost: Loaded {} plans", new_plans.size());
             } catch (const std::exception& e) {
-                DB_ERROR_FMT("TravelHost: Exception during scan_plans: {}", e.what());
+                DB_ERROR_FMT("TravelHost: Exception loading plans: {}", e.what());
             }
             
-            // Update the travel plans vector
+            // Publish the loaded plans
+            auto const count = new_plans.size();
             {
-                std::lock_guard<std::mutex> lock(plans_mutex_);
-                travel_plans_ = std::move(new_plans);
-                DB_INFO_FMT("TravelHost: Updated travel_plans_ to contain {} plans", travel_plans_.size());
+                std::lock_guard<std::mutex> lock(write_mutex_);
+                plans_.store(std::make_shared<const plan_list>(std::move(new_plans)));
             }
             
-            DB_INFO_FMT("TravelHost: Async initialization complete, loaded {} plans", travel_plans_.size());
+            DB_INFO_FMT("TravelHost: Async initialization complete, loaded {} plans", count);
             initialized_.store(true);
         } catch (const std::exception& e) {
             DB_ERROR_FMT("TravelHost: Exception during async initialization: {}", e.what());
@@ -102,6 +104,7 @@ public:
         
         // Always mark initialization as done to prevent deadlocks
         initializing_.store(false);
+        rouen::helpers::request_redraw();   // cards waiting on initialized() show the plans
     }
 
     // Create a new travel plan
@@ -128,11 +131,7 @@ public:
         
         plan.id = repo_.upsert_plan(plan);
         
-        // Refresh our cached plans
-        std::thread refresh_thread([this] {
-            refresh();
-        });
-        refresh_thread.detach();
+        reloadPlan(plan.id);
         
         return plan.id;
     }
@@ -174,11 +173,7 @@ public:
         
         repo_.upsert_plan(plan);
         
-        // Refresh plans in background
-        std::thread refresh_thread([this] {
-            refresh();
-        });
-        refresh_thread.detach();
+        reloadPlan(plan_id);
         
         return true;
     }
@@ -213,11 +208,7 @@ public:
         
         repo_.upsert_plan(plan);
         
-        // Refresh plans in background
-        std::thread refresh_thread([this] {
-            refresh();
-        });
-        refresh_thread.detach();
+        reloadPlan(plan_id);
         
         return true;
     }
@@ -231,30 +222,19 @@ public:
         
         repo_.delete_plan(plan_id);
         
-        // Refresh plans in background
-        std::thread refresh_thread([this] {
-            refresh();
-        });
-        refresh_thread.detach();
+        reloadPlan(plan_id);
         
         return true;
     }
 
-    // Get a specific travel plan by ID
-    std::shared_ptr<media::travel::plan> getPlan(long long plan_id) {
-        DB_INFO_FMT("TravelHost: Getting plan {}", plan_id);
-        
-        // Make sure we're initialized
-        ensure_initialized();
-        
+    // Get a specific travel plan by ID; one not loaded yet is read from the database
+    plan_ptr getPlan(long long plan_id) {
         try {
-            std::lock_guard<std::mutex> lock(plans_mutex_);
-            
-            auto it = std::find_if(travel_plans_.begin(), travel_plans_.end(), 
+            auto const current = plans_.load();
+            auto it = std::find_if(current->begin(), current->end(), 
                 [plan_id](const auto& plan) { return plan->id == plan_id; });
             
-            if (it != travel_plans_.end()) {
-                DB_INFO_FMT("TravelHost: Found plan {} in cache", plan_id);
+            if (it != current->end()) {
                 return *it;
             }
             
@@ -273,21 +253,27 @@ public:
         }
     }
 
-    // Get all travel plans
-    std::vector<std::shared_ptr<media::travel::plan>> plans() {
-        DB_INFO("TravelHost: Getting all plans");
-        
-        // Make sure we're initialized
-        ensure_initialized();
-        
-        try {
-            std::lock_guard<std::mutex> lock(plans_mutex_);
-            DB_INFO_FMT("TravelHost: Returning {} plans", travel_plans_.size());
-            return travel_plans_; // Return a copy to avoid threading issues
-        } catch (const std::exception& e) {
-            DB_ERROR_FMT("TravelHost: Exception in plans(): {}", e.what());
-            return {};
-        }
+    // The current plan list; empty until the first load. Holding it keeps it unchanged
+    std::shared_ptr<const plan_list> plans() const {
+        return plans_.load();
+    }
+
+    [[nodiscard]] bool initialized() const {
+        return initialized_.load();
+    }
+
+    // `changed` gets the id of every plan created, edited or deleted, on the thread that made
+    // the change; the returned id is for unsubscribe()
+    int subscribe(std::function<void(long long plan_id)> changed) {
+        std::lock_guard<std::mutex> lock(listeners_mutex_);
+        auto const id = next_listener_++;
+        listeners_.emplace(id, std::move(changed));
+        return id;
+    }
+
+    void unsubscribe(int id) {
+        std::lock_guard<std::mutex> lock(listeners_mutex_);
+        listeners_.erase(id);
     }
 
     // Direct update of a plan (used for destination completion toggling)
@@ -299,40 +285,30 @@ public:
         
         repo_.upsert_plan(const_cast<media::travel::plan&>(plan));
         
-        // Refresh plans in background
-        std::thread refresh_thread([this] {
-            refresh();
-        });
-        refresh_thread.detach();
+        reloadPlan(plan.id);
         
         return true;
     }
 
-    // Refresh the travel plans list from the database
+    // Re-read every plan from the database (edits made here only reload their own plan)
     void refresh() {
         DB_INFO("TravelHost: Refreshing plans from database");
         try {
             // Create a temporary vector to hold the new plans
-            std::vector<std::shared_ptr<media::travel::plan>> new_plans;
+            plan_list new_plans;
             
             // Load plans from the database
-            DB_INFO("TravelHost: Loading plans from database for refresh");
-            repo_.scan_plans([this, &new_plans](long long id, const char* , const char* , 
-                             const char* , const char* ) {
-                DB_INFO_FMT("TravelHost: Loading plan {} from database", id);
-                auto plan = std::make_shared<media::travel::plan>();
-                repo_.get_plan(id, *plan);
-                new_plans.push_back(plan);
-            });
+            for (auto& plan : repo_.load_plans()) {
+                new_plans.push_back(std::make_shared<media::travel::plan>(std::move(plan)));
+            }
             
-            // Now acquire the mutex only for the quick vector swap operation
+            auto const count = new_plans.size();
             {
-                std::lock_guard<std::mutex> lock(plans_mutex_);
-                DB_INFO("TravelHost: Acquired lock for swapping plan vectors");
-                travel_plans_.swap(new_plans);
+                std::lock_guard<std::mutex> lock(write_mutex_);
+                plans_.store(std::make_shared<const plan_list>(std::move(new_plans)));
             }
             
-            DB_INFO_FMT("TravelHost: Refresh complete, loaded {} plans", travel_plans_.size());
+            DB_INFO_FMT("TravelHost: Refresh complete, loaded {} plans", count);
         } catch (const std::exception& e) {
             DB_ERROR_FMT("TravelHost: Exception in refresh: {}", e.what());
         }
@@ -365,6 +341,49 @@ public:
     }
 
 private:
+    // Reads one plan back after an edit and swaps in a list with it replaced, added or (when it
+    // is gone from the database) removed; the other plans are shared with the previous list
+    void reloadPlan(long long plan_id) {
+        std::shared_ptr<media::travel::plan> fresh = std::make_shared<media::travel::plan>();
+        try {
+            if (!repo_.get_plan(plan_id, *fresh)) {
+                fresh.reset();
+            }
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("TravelHost: Exception reloading plan {}: {}", plan_id, e.what());
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            auto next = std::make_shared<plan_list>(*plans_.load());
+            auto it = std::find_if(next->begin(), next->end(), [plan_id](const auto& plan) { return plan->id == plan_id; });
+            if (it != next->end()) {
+                if (fresh) {
+                    *it = std::move(fresh);
+                } else {
+                    next->erase(it);
+                }
+            } else if (fresh) {
+                next->push_back(std::move(fresh));
+            }
+            plans_.store(std::move(next));
+        }
+        notify(plan_id);
+    }
+
+    void notify(long long plan_id) {
+        std::vector<std::function<void(long long)>> listeners;
+        {
+            std::lock_guard<std::mutex> lock(listeners_mutex_);
+            for (auto const& [id, listener] : listeners_) {
+                listeners.push_back(listener);
+            }
+        }
+        for (auto const& listener : listeners) {
+            listener(plan_id);
+        }
+    }
+
     // Helper method to ensure we're initialized
     void ensure_initialized() {
         if (!initialized_.load()) {
@@ -400,9 +419,8 @@ private:
                 // Try one final direct initialization as a fallback
                 try {
                     DB_INFO("TravelHost: Attempting direct initialization as fallback");
-                    std::vector<std::shared_ptr<media::travel::plan>> empty_plans;
-                    std::lock_guard<std::mutex> lock(plans_mutex_);
-                    travel_plans_ = std::move(empty_plans);
+                    std::lock_guard<std::mutex> lock(write_mutex_);
+                    plans_.store(std::make_shared<const plan_list>());
                 } catch (const std::exception& e) {
                     DB_ERROR_FMT("TravelHost: Fallback initialization failed: {}", e.what());
                 }
@@ -411,8 +429,11 @@ private:
     }
 
     media::travel::sqliterepo repo_;
-    std::vector<std::shared_ptr<media::travel::plan>> travel_plans_;
-    std::mutex plans_mutex_;
+    std::atomic<std::shared_ptr<const plan_list>> plans_ {std::make_shared<const plan_list>()};
+    std::mutex write_mutex_;           // serializes the read-modify-swap of plans_
+    std::mutex listeners_mutex_;
+    std::map<int, std::function<void(long long)>> listeners_;
+    int next_listener_ {0};
     std::atomic<bool> initialized_;    // Indicates if initial loading is complete
     std::atomic<bool> initializing_;   // Indicates if initialization is in progress
 };
@@ -2,17 +2,25 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 #include <optional>
 #include <glaze/glaze.hpp>
 
 #include "../helpers/fetch.hpp"
 #include "../helpers/debug.hpp"
+#include "../helpers/memory_accounting.hpp"
+#include "../helpers/redraw.hpp"
+#include "../helpers/sqlite.hpp"
+#include "../helpers/task_scheduler.hpp"
+#include "../helpers/timer_wheel.hpp"
 
 namespace rouen::hosts {
 
@@ -107,103 +115,84 @@ namespace weather {
         std::vector<ForecastItem> list;
         Location city;
     };
+
+    // One location's data as last fetched; replaced whole, never modified in place
+    struct snapshot {
+        std::optional<CurrentWeather> current;
+        std::optional<Forecast> forecast;
+        std::chrono::system_clock::time_point fetched_at {};
+    };
 }
 
 /**
  * Weather Host Controller
  * 
  * This class acts as a controller for weather data, managing the communication
- * between the UI (cards) and the OpenWeather API.
- * It provides methods for fetching current weather and forecast data.
+ * between the UI (cards) and the OpenWeather API. One host serves every weather card:
+ * each location has its own snapshot, swapped whole when new data has been parsed, so a
+ * card only ever copies a pointer and never waits on the network.
+ *
+ * Snapshots are kept in weather_cache.db with the time they were fetched; a location
+ * fetched less than `ttl` ago (even in a previous run) is drawn from there without a
+ * request. Every location that is due is fetched in the same cycle, concurrently on the
+ * HTTP engine, each with its own failure backoff; a timer starts the cycle when the next
+ * location falls due, so cards drawing the weather never check the time for it.
  */
-class WeatherHost {
+class WeatherHost : public std::enable_shared_from_this<WeatherHost> {
 public:
-    /**
-     * Constructor initializes the Weather host with a system runner
-     */
-    WeatherHost() 
-        : last_update_time_(std::chrono::steady_clock::now() - std::chrono::hours(2)), // Force initial update
-          consecutive_failures_(0),
-          backoff_minutes_(0)
+    static constexpr auto ttl = std::chrono::minutes(30);
+    // A location no card has asked for in this long is no longer refreshed
+    static constexpr auto idle_after = std::chrono::hours(1);
+
+    explicit WeatherHost(const std::string& cache_path = "weather_cache.db")
+        : cache_{cache_path}
     {
         WEATHER_INFO("WeatherHost: Initializing");
         
         // Get the API key from the environment variable
-        api_key_ = std::getenv("OPENWEATHER_KEY");
+        if (auto const key = std::getenv("OPENWEATHER_KEY")) {
+            api_key_ = key;
+        }
         if (api_key_.empty()) {
             WEATHER_ERROR("WeatherHost: OpenWeather API key not found in environment variables");
-        } else {
-            WEATHER_INFO_FMT("WeatherHost: Using OpenWeather API key: {}", api_key_);
-        }
-        
-        // Default location - can be improved with geolocation
-        location_ = "Paris,fr";
-    }
-
-    /**
-     * Set the location for weather data
-     */
-    void setLocation(std::string_view location) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (location_ != location) {
-            location_ = location;
-            // Invalidate current data to force refresh on next request
-            current_weather_.reset();
-            forecast_.reset();
         }
-    }
 
-    /**
-     * Get the current location
-     */
-    std::string getLocation() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return location_;
+        cache_.ensure_table("weather", "location TEXT PRIMARY KEY, current TEXT, forecast TEXT, fetched_at INTEGER");
     }
 
     /**
-     * Check if the weather data needs to be updated
+     * The latest data for `location` (never null, possibly still empty). A location in use
+     * is refreshed by the timer; one new or back from idle starts the refresh of whatever is
+     * due, without waiting for it
      */
-    bool needsUpdate() const {
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::minutes>(now - last_update_time_).count();
-        
-        // If we're in a backoff period due to previous failures, respect it
-        if (consecutive_failures_ > 0 && elapsed < backoff_minutes_) {
-            WEATHER_INFO_FMT("WeatherHost: Skipping update due to backoff period ({} min remaining)", 
-                        backoff_minutes_ - elapsed);
-            return false;
+    std::shared_ptr<const weather::snapshot> getWeather(const std::string& location) {
+        std::shared_ptr<const weather::snapshot> data;
+        bool newly_used = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& entry = entryFor(location);
+            auto const now = std::chrono::system_clock::now();
+            newly_used = now - entry.last_used >= idle_after;
+            entry.last_used = now;
+            data = entry.data;
         }
-        
-        // Update weather every 30 minutes, or if we don't have data yet
-        return elapsed >= 30 || !current_weather_ || !forecast_;
-    }
-
-    /**
-     * Get the current weather data
-     */
-    const std::optional<weather::CurrentWeather> &getCurrentWeather() {
-        updateWeatherIfNeeded();
-        
-        std::lock_guard<std::mutex> lock(mutex_);
-        return current_weather_;
-    }
-
-    /**
-     * Get the weather forecast data
-     */
-    std::optional<weather::Forecast> getForecast() {
-        updateWeatherIfNeeded();
-        
-        std::lock_guard<std::mutex> lock(mutex_);
-        return forecast_;
+        if (newly_used) {
+            refreshDue();
+        }
+        return data;
     }
 
     /**
-     * Force a refresh of the weather data
+     * Fetch `location` again now, whatever its age
      */
-    void refreshWeather() {
-        fetchWeatherData();
+    void refreshWeather(const std::string& location) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& entry = entryFor(location);
+            entry.due = {};
+            entry.last_used = std::chrono::system_clock::now();
+        }
+        refreshDue();
     }
 
     /**
@@ -224,141 +213,240 @@ public:
     }
 
 private:
+    struct location_entry {
+        std::shared_ptr<const weather::snapshot> data {std::make_shared<weather::snapshot>()};
+        std::chrono::system_clock::time_point due {};          // next fetch, after ttl or a backoff
+        std::chrono::system_clock::time_point last_used {};
+        int consecutive_failures {0};
+        int backoff_minutes {0};
+        bool fetching {false};
+    };
+
+    // Caller holds mutex_; a location seen for the first time starts from the disk cache
+    location_entry& entryFor(const std::string& location) {
+        auto [it, inserted] = entries_.try_emplace(location);
+        if (inserted) {
+            loadCached(location, it->second);
+        }
+        return it->second;
+    }
+
+    void loadCached(const std::string& location, location_entry& entry) {
+        try {
+            cache_.for_each<std::string, std::string, int64_t>(
+                "SELECT current, forecast, fetched_at FROM weather WHERE location = ?",
+                [&entry](std::string current, std::string forecast, int64_t fetched_at) {
+                    auto data = std::make_shared<weather::snapshot>();
+                    data->current = parse<weather::CurrentWeather>(current, "cached current weather");
+                    data->forecast = parse<weather::Forecast>(forecast, "cached forecast");
+                    data->fetched_at = std::chrono::system_clock::time_point{std::chrono::seconds{fetched_at}};
+                    if (data->current && data->forecast) {
+                        entry.due = data->fetched_at + ttl;
+                    }
+                    entry.data = std::move(data);
+                },
+                location);
+        } catch (const std::exception& e) {
+            WEATHER_ERROR_FMT("WeatherHost: Cannot read the cache for {}: {}", location, e.what());
+        }
+    }
+
     /**
-     * Update weather data if needed
+     * Start fetching every location that is due and still in use
      */
-    void updateWeatherIfNeeded() {
-        if (needsUpdate()) {
-            fetchWeatherData();
+    void refreshDue() {
+        if (api_key_.empty()) {
+            return;
+        }
+        std::vector<std::string> due;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto const now = std::chrono::system_clock::now();
+            for (auto& [location, entry] : entries_) {
+                if (!entry.fetching && entry.due <= now && now - entry.last_used < idle_after) {
+                    entry.fetching = true;
+                    due.push_back(location);
+                }
+            }
         }
+        for (auto const& location : due) {
+            fetchWeatherData(location);
+        }
+        scheduleRefresh();
     }
 
     /**
-     * Fetch weather data from the OpenWeather API
+     * Set the timer for the next location in use to fall due; those being fetched set it
+     * again once their data is in
      */
-    void fetchWeatherData() {
-        if (api_key_.empty()) {
+    void scheduleRefresh() {
+        auto const timers = rouen::helpers::timers();
+        if (api_key_.empty() || !timers) {
             return;
         }
-        
-        last_update_time_ = std::chrono::steady_clock::now();
-        
+        std::optional<std::chrono::system_clock::time_point> next;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto const now = std::chrono::system_clock::now();
+            for (auto const& [location, entry] : entries_) {
+                if (!entry.fetching && now - entry.last_used < idle_after && (!next || entry.due < *next)) {
+                    next = entry.due;
+                }
+            }
+        }
+        if (!next) {
+            return;
+        }
+        auto const delay = std::chrono::duration_cast<rouen::helpers::timer_wheel::clock::duration>(*next - std::chrono::system_clock::now());
+        auto timer = timers->after(delay, [weak = weak_from_this()]() {
+            if (auto self = weak.lock()) {
+                self->refreshDue();
+            }
+        });
+        // The timer it replaces is cancelled outside the lock: its callback may be taking it
+        rouen::helpers::timer_wheel::timer previous;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            previous = std::exchange(refresh_timer_, std::move(timer));
+        }
+    }
+
+    /**
+     * Fetch one location's current weather and forecast from the OpenWeather API
+     */
+    void fetchWeatherData(const std::string& location) {
         // Current weather URL
         std::string current_url = std::format(
             "https://api.openweathermap.org/data/2.5/weather?q={}&appid={}&units=metric",
-            location_, api_key_
+            location, api_key_
         );
         
         // Forecast URL
         std::string forecast_url = std::format(
             "https://api.openweathermap.org/data/2.5/forecast?q={}&appid={}&units=metric&cnt=5",
-            location_, api_key_
+            location, api_key_
         );
         
-        // Flag to track success of both API calls
-        std::atomic<bool> current_success = false;
-        std::atomic<bool> forecast_success = false;
-        
-        // Temporary storage for thread results
-        std::string current_data;
-        std::string forecast_data;
-        
-        // Fetch current weather
-        std::thread current_thread([current_url, &current_data, &current_success]() {
-            try {
-                http::fetch fetcher(60); // Increase timeout for potential delays
-                current_data = fetcher(current_url);
-                current_success = true;
-                WEATHER_INFO("WeatherHost: Fetched current weather data");
-            } catch (const std::exception& e) {
-                WEATHER_ERROR_FMT("WeatherHost: Failed to fetch current weather: {}", e.what());
-            }
-        });
-        
-        // Fetch forecast
-        std::thread forecast_thread([forecast_url, &forecast_data, &forecast_success]() {
-            try {
-                http::fetch fetcher(60); // Increase timeout for potential delays
-                forecast_data = fetcher(forecast_url);
-                forecast_success = true;
-                WEATHER_INFO("WeatherHost: Fetched forecast data");
-            } catch (const std::exception& e) {
-                WEATHER_ERROR_FMT("WeatherHost: Failed to fetch forecast: {}", e.what());
-            }
-        });
-        
-        // Wait for both threads to complete
-        current_thread.join();
-        forecast_thread.join();
-        
-        // Process results and update backoff state
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        // Parse current weather if fetch was successful
-        if (current_success) {
-            try {
-                weather::CurrentWeather data;
-                auto error = glz::read<glz::opts{.error_on_unknown_keys=false}>(data, current_data);
-                if (error) {
-                    WEATHER_ERROR_FMT("WeatherHost: Error parsing current weather data: {}", 
-                                glz::format_error(error));
-                    current_success = false;
+        // Fetch current weather and forecast concurrently on the shared HTTP engine;
+        // the results are applied on the scheduler once both have arrived
+        struct pending_results {
+            std::optional<std::string> current;
+            std::optional<std::string> forecast;
+            std::atomic<int> remaining {2};
+        };
+        auto results = std::make_shared<pending_results>();
+        auto fetch_json = [weak = weak_from_this(), results, location](std::string url, char const* what,
+                                                                     std::optional<std::string> pending_results::* slot) {
+            auto req = http::fetch{60}.cached().make_request(url); // Increase timeout for potential delays
+            http::engine::instance().submit(std::move(req), [weak, results, location, what, slot](http::response response) {
+                if (response.ok()) {
+                    WEATHER_INFO_FMT("WeatherHost: Fetched {} data for {}", what, location);
+                    (*results).*slot = std::move(response.body);
                 } else {
-                    current_weather_ = std::move(data);
+                    WEATHER_ERROR_FMT("WeatherHost: Failed to fetch {} for {}: {}", what, location, response.error);
                 }
-            } catch (const std::exception& e) {
-                WEATHER_ERROR_FMT("WeatherHost: Exception parsing current weather data: {}", e.what());
-                current_success = false;
+                if (results->remaining.fetch_sub(1) != 1) {
+                    return;
+                }
+                if (auto self = weak.lock()) {
+                    rouen::helpers::scheduler()->submit([self, results, location](std::stop_token) {
+                        rouen::helpers::memory::scope memory_tag{"host:weather"};
+                        self->applyWeatherData(location, std::move(results->current), std::move(results->forecast));
+                    });
+                }
+            });
+        };
+        fetch_json(current_url, "current weather", &pending_results::current);
+        fetch_json(forecast_url, "forecast", &pending_results::forecast);
+    }
+
+    template <typename T>
+    static std::optional<T> parse(const std::string& json, char const* what) {
+        if (json.empty()) {
+            return std::nullopt;
+        }
+        try {
+            T data;
+            auto error = glz::read<glz::opts{.error_on_unknown_keys=false}>(data, json);
+            if (error) {
+                WEATHER_ERROR_FMT("WeatherHost: Error parsing {} data: {}", what, glz::format_error(error, json));
+                return std::nullopt;
             }
+            return data;
+        } catch (const std::exception& e) {
+            WEATHER_ERROR_FMT("WeatherHost: Exception parsing {} data: {}", what, e.what());
+            return std::nullopt;
         }
-        
-        // Parse forecast if fetch was successful
-        if (forecast_success) {
+    }
+
+    /**
+     * Parse fetched weather data off the UI thread, swap the location's snapshot and update
+     * its backoff state
+     */
+    void applyWeatherData(const std::string& location, std::optional<std::string> current_result, std::optional<std::string> forecast_result) {
+        auto current = current_result ? parse<weather::CurrentWeather>(*current_result, "current weather") : std::nullopt;
+        auto forecast = forecast_result ? parse<weather::Forecast>(*forecast_result, "forecast") : std::nullopt;
+        bool const success = current && forecast;
+        auto const now = std::chrono::system_clock::now();
+
+        if (success) {
             try {
-                weather::Forecast data;
-                auto error = glz::read<glz::opts{.error_on_unknown_keys=false}>(data, forecast_data);
-                if (error) {
-                    WEATHER_ERROR_FMT("WeatherHost: Error parsing forecast data: {}", 
-                                glz::format_error(error));
-                    forecast_success = false;
-                } else {
-                    forecast_ = std::move(data);
-                }
+                cache_.exec("INSERT OR REPLACE INTO weather (location, current, forecast, fetched_at) VALUES (?, ?, ?, ?)",
+                            nullptr, location, *current_result, *forecast_result,
+                            std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count());
             } catch (const std::exception& e) {
-                WEATHER_ERROR_FMT("WeatherHost: Exception parsing forecast data: {}", e.what());
-                forecast_success = false;
+                WEATHER_ERROR_FMT("WeatherHost: Cannot cache weather for {}: {}", location, e.what());
             }
         }
-        
-        // Update backoff state based on success or failure
-        if (current_success && forecast_success) {
-            // Successfully fetched both - reset backoff
-            if (consecutive_failures_ > 0) {
-                WEATHER_INFO("WeatherHost: API calls successful, resetting backoff");
-                consecutive_failures_ = 0;
-                backoff_minutes_ = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& entry = entries_[location];
+            entry.fetching = false;
+
+            // What failed keeps its previous data rather than going blank
+            if (current || forecast) {
+                auto data = std::make_shared<weather::snapshot>(*entry.data);
+                if (current) {
+                    data->current = std::move(current);
+                }
+                if (forecast) {
+                    data->forecast = std::move(forecast);
+                }
+                data->fetched_at = now;
+                entry.data = std::move(data);
+            }
+
+            // Update backoff state based on success or failure
+            if (success) {
+                // Successfully fetched both - reset backoff
+                if (entry.consecutive_failures > 0) {
+                    WEATHER_INFO_FMT("WeatherHost: API calls for {} successful, resetting backoff", location);
+                    entry.consecutive_failures = 0;
+                    entry.backoff_minutes = 0;
+                }
+                entry.due = now + ttl;
+            } else {
+                // At least one API call failed - increase backoff
+                entry.consecutive_failures++;
+                
+                // Exponential backoff: 5, 10, 20, 40, 60, 60, ... minutes (capped at 60)
+                entry.backoff_minutes = std::min(entry.consecutive_failures < 2 ? 5 : entry.backoff_minutes * 2, 60);
+                entry.due = now + std::chrono::minutes(entry.backoff_minutes);
+                
+                WEATHER_WARN_FMT("WeatherHost: API call(s) for {} failed, increased backoff to {} minutes after {} consecutive failures", 
+                           location, entry.backoff_minutes, entry.consecutive_failures);
             }
-            // The weather name is available for card classes to use
-        } else {
-            // At least one API call failed - increase backoff
-            consecutive_failures_++;
-            
-            // Exponential backoff: 5, 10, 20, 40, 60, 60, ... minutes (capped at 60)
-            backoff_minutes_ = std::min(consecutive_failures_ < 2 ? 5 : backoff_minutes_ * 2, 60);
-            
-            WEATHER_WARN_FMT("WeatherHost: API call(s) failed, increased backoff to {} minutes after {} consecutive failures", 
-                       backoff_minutes_, consecutive_failures_);
         }
+        scheduleRefresh();
+        rouen::helpers::request_redraw();
     }
 
-    mutable std::mutex mutex_;
+    mutable std::mutex mutex_;      // entries_
     std::string api_key_;
-    std::string location_;
-    std::optional<weather::CurrentWeather> current_weather_;
-    std::optional<weather::Forecast> forecast_;
-    std::chrono::steady_clock::time_point last_update_time_;
-    int consecutive_failures_;
-    int backoff_minutes_;
+    std::map<std::string, location_entry> entries_;
+    rouen::helpers::timer_wheel::timer refresh_timer_;     // mutex_; at the next location's `due`
+    hosting::db::sqlite cache_;
 };
 
 } // namespace rouen::hosts
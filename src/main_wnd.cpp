@@ -1,18 +1,30 @@
 // 1. Standard includes in alphabetic order
-// None in this file's top section
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <optional>
 
 // 2. Libraries used in the project, in alphabetic order
 // Include ImGui wrapper first which handles all ImGui related headers
 #include "helpers/imgui_include.hpp"
 
 // Add STB implementation defines
-#define STB_RECT_PACK_IMPLEMENTATION
 #define STB_TRUETYPE_IMPLEMENTATION
 
 // 3. All other includes
 #include "cards/interface/deck.hpp"
 #include "fonts.hpp"
+#include "helpers/audio_engine.hpp"
+#include "helpers/db_maintenance.hpp"
 #include "helpers/debug.hpp"
+#include "helpers/image_cache.hpp"
+#include "helpers/redraw.hpp"
+#include "helpers/startup_timeline.hpp"
+#include "helpers/texture_atlas.hpp"
+#include "helpers/task_scheduler.hpp"
+#include "helpers/timer_wheel.hpp"
+#include "helpers/trace.hpp"
 #include "main_wnd.hpp"
 
 main_wnd::main_wnd() 
@@ -22,6 +34,7 @@ main_wnd::main_wnd()
     , m_done(false)
     , m_immediate(false)
     , m_requested_fps(1)
+    , m_settle_frames(0)
 {
     // register an extractor for keystrokes
     registrar::add<std::function<std::string()>>(
@@ -38,6 +51,7 @@ main_wnd::main_wnd()
 
 main_wnd::~main_wnd() {
     // Cleanup
+    hosting::db::maintenance::instance().stop();
     ImGui_ImplSDLRenderer2_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
@@ -48,6 +62,12 @@ main_wnd::~main_wnd() {
     // Remove the keystrokes extractor
     registrar::remove<std::function<std::string()>>("keystrokes");
 
+    // Textures still held (resident images, atlas pages, the snapshot target) belong to the
+    // renderer and must go before it
+    helpers::ImageCache::TextureMemory::instance().clear();
+    rouen::helpers::texture_atlas::instance().release();
+    rouen::helpers::snapshot_service::instance().shutdown();
+
     if (m_renderer) {
         SDL_DestroyRenderer(m_renderer);
     }
@@ -61,7 +81,36 @@ main_wnd::~main_wnd() {
 }
 
 bool main_wnd::initialize() {
+    // The font atlas is rasterized on a worker while SDL brings up the window; it must be
+    // finished before ImGui (or its context) is touched again on this thread
+    std::future<void> atlas_built;
+    struct atlas_wait {
+        std::future<void>& f;
+        ~atlas_wait() { if (f.valid()) f.wait(); }
+    } atlas_guard {atlas_built};
+
     try {
+        // Initialize ImGui
+        {
+            rouen::helpers::startup_timeline::scope timing{"imgui_fonts"};
+            IMGUI_CHECKVERSION();
+            ImGui::CreateContext();
+            ImGuiIO& io = ImGui::GetIO();
+            (void)io;
+
+            // Enable keyboard and mouse controls
+            io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+            io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
+
+            rouen::fonts::setup();
+            atlas_built = rouen::helpers::scheduler()->async([atlas = io.Fonts] {
+                rouen::helpers::startup_timeline::scope build_timing{"font_atlas_build"};
+                rouen::fonts::build_atlas(atlas);
+            }, rouen::helpers::task_priority::high);
+        }
+
+        rouen::helpers::startup_timeline::scope sdl_timing{"sdl_init"};
+
         // Initialize SDL
         if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0) {
             DB_ERROR_FMT("SDL initialization error: {}", SDL_GetError());
@@ -76,6 +125,15 @@ bool main_wnd::initialize() {
             return false;
         }
 
+        // Alarm sounds are decoded off the main thread while the window comes up
+        rouen::helpers::scheduler()->submit([](std::stop_token) {
+            rouen::helpers::startup_timeline::scope audio_timing{"audio_init"};
+            auto& audio = rouen::helpers::audio_engine::instance();
+            if (audio.open()) {
+                audio.preload("alarm", "img/alarm.mp3");
+            }
+        }, rouen::helpers::task_priority::background);
+
         // Create window with SDL
         SDL_WindowFlags window_flags = (SDL_WindowFlags)(SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
         m_window = SDL_CreateWindow(
@@ -120,17 +178,7 @@ bool main_wnd::initialize() {
             }
         ));
 
-        // Initialize ImGui
-        IMGUI_CHECKVERSION();
-        ImGui::CreateContext();
-        ImGuiIO& io = ImGui::GetIO();
-        (void)io;
-
-        // Enable keyboard and mouse controls
-        io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-        io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
-
-        rouen::fonts::setup();
+        atlas_built.wait();
 
         // Setup ImGui style
         setup_dark_theme();
@@ -147,6 +195,9 @@ bool main_wnd::initialize() {
             return false;
         }
 
+        // ANALYZE, vacuum and checkpoints for every database while nobody is using the app
+        hosting::db::maintenance::instance().start();
+
         return true;
     } catch (const std::exception& e) {
         DB_ERROR_FMT("Exception during initialization: {}", e.what());
@@ -189,8 +240,10 @@ bool main_wnd::initialize() {
 
 void main_wnd::run() {
     try {
-        // Create deck
+        // Create deck; saved cards start as placeholders and are built over the next frames
         deck main_deck(m_renderer);
+        bool first_frame = true;
+        rouen::helpers::trace::name_thread("ui");
 
         while (!m_done) {
             try {
@@ -198,6 +251,13 @@ void main_wnd::run() {
                 if (!process_events()) {
                     break;
                 }
+                // From here on: the frame itself, not the wait for events
+                TRACE_SPAN("WINDOW", "frame");
+
+                // Glyphs asked for since the last frame; NewFrame uploads the rebuilt atlas
+                if (rouen::fonts::apply_requested_glyphs()) {
+                    ImGui_ImplSDLRenderer2_DestroyFontsTexture();
+                }
 
                 // Start a new ImGui frame
                 ImGui_ImplSDLRenderer2_NewFrame();
@@ -209,7 +269,12 @@ void main_wnd::run() {
 
                 // Render the deck and get requested fps
                 try {
+                    TRACE_SPAN("WINDOW", "deck");
                     m_requested_fps = main_deck.render().requested_fps;
+                    // Keep the text cursor blinking while an input field is active
+                    if (ImGui::GetIO().WantTextInput) {
+                        m_requested_fps = std::max(m_requested_fps, 4);
+                    }
                 } catch (const std::exception& e) {
                     DB_ERROR_FMT("Error during deck rendering: {}", e.what());
                     // Continue execution rather than crashing
@@ -220,6 +285,8 @@ void main_wnd::run() {
 
                 // Render ImGui
                 ImGui::Render();
+                main_deck.capture_cached_cards(ImGui::GetDrawData());
+                rouen::helpers::snapshot_service::instance().capture(m_renderer, ImGui::GetDrawData());
                 SDL_SetRenderDrawColor(m_renderer, 40, 40, 40, 255);  // Changed to dark gray background
                 SDL_RenderClear(m_renderer);
                 ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData());
@@ -227,7 +294,14 @@ void main_wnd::run() {
                 // Process any deferred operations
                 process_deferred_operations();
                 
-                SDL_RenderPresent(m_renderer);
+                {
+                    TRACE_SPAN("WINDOW", "present");
+                    SDL_RenderPresent(m_renderer);
+                }
+                if (first_frame) {
+                    first_frame = false;
+                    rouen::helpers::startup_timeline::instance().mark("first_frame");
+                }
             } catch (const std::exception& e) {
                 DB_ERROR_FMT("Error in main loop: {}", e.what());
                 // Continue to next iteration rather than crashing
@@ -250,15 +324,40 @@ bool main_wnd::process_events() {
 
         // Poll events
         SDL_Event event;
-        if (!m_immediate) {
-            SDL_WaitEventTimeout(nullptr, 1000/m_requested_fps);
+        auto const timers = rouen::helpers::timers();
+        if (m_immediate) {
+            m_immediate = false;
+        }
+        else if (m_settle_frames > 0) {
+            --m_settle_frames;
         }
         else {
-            m_immediate = false;
+            // Sleep until input, an invalidate(), the next frame an animation asks for or the
+            // next timer, whichever comes first; with none of the last two, until input
+            int timeout_ms = m_requested_fps > 0 ? 1000 / m_requested_fps : -1;
+            if (auto const next = timers ? timers->next_deadline() : std::nullopt) {
+                auto const until = std::chrono::ceil<std::chrono::milliseconds>(*next - std::chrono::steady_clock::now()).count();
+                auto const timer_ms = static_cast<int>(std::clamp<long long>(until, 0, std::numeric_limits<int>::max()));
+                timeout_ms = timeout_ms < 0 ? timer_ms : std::min(timeout_ms, timer_ms);
+            }
+            if (timeout_ms < 0) {
+                SDL_WaitEvent(nullptr);
+            } else if (timeout_ms > 0) {
+                SDL_WaitEventTimeout(nullptr, timeout_ms);
+            }
+        }
+        if (timers) {
+            timers->run_due();
         }
         
         while (SDL_PollEvent(&event)) {
             try {
+                if (event.type == rouen::helpers::redraw_event_type()) {
+                    rouen::helpers::redraw_consumed();
+                    continue;
+                }
+                m_settle_frames = 2;
+                hosting::db::maintenance::instance().note_activity();
                 ImGui_ImplSDL2_ProcessEvent(&event);
                 if (event.type == SDL_QUIT) {
                     m_done = true;
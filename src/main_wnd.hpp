@@ -47,6 +47,7 @@ private:
     bool m_done = false;
     bool m_immediate = false;
     int m_requested_fps = 1;
+    int m_settle_frames = 0;    // extra frames ImGui needs after input to finish hover/popup state
     std::string keystrokes_;
     
     // MainWindow is commented out as it's currently unused
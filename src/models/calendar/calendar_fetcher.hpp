@@ -4,7 +4,9 @@
 #include <vector>
 #include <mutex>
 #include <memory>
+#include <cctype>
 #include <chrono>
+#include <format>
 #include <thread>
 #include <cstdlib>
 #include <functional>
@@ -12,7 +14,10 @@
 #include <glaze/glaze.hpp>
 
 #include "../../helpers/fetch.hpp"
+#include "../../helpers/task_scheduler.hpp"
+#include "../../helpers/timestamp.hpp"
 #include "event.hpp"
+#include "event_store.hpp"
 
 namespace calendar {
     // Define glaze schema for the calendar event components
@@ -75,6 +80,8 @@ namespace calendar {
         std::optional<std::string> updated;
         std::optional<std::string> timeZone;
         std::optional<std::string> accessRole;
+        // Present when the delegate supports incremental sync (the Calendar API's events.list)
+        std::optional<std::string> nextSyncToken;
         // Add defaultReminders field
         std::optional<std::vector<std::map<std::string, std::variant<std::string, int>>>> defaultReminders;
     };
@@ -181,6 +188,7 @@ struct glz::meta<calendar::CalendarResponse> {
         "updated", &T::updated,
         "timeZone", &T::timeZone,
         "accessRole", &T::accessRole,
+        "nextSyncToken", &T::nextSyncToken,
         "defaultReminders", &T::defaultReminders
     );
     
@@ -190,7 +198,7 @@ struct glz::meta<calendar::CalendarResponse> {
 };
 
 namespace calendar {
-    class calendar_fetcher {
+    class calendar_fetcher : public std::enable_shared_from_this<calendar_fetcher> {
     public:
         calendar_fetcher(const std::string& calendar_url = {}) {
             // Get calendar delegate URL from environment if not provided
@@ -211,13 +219,58 @@ namespace calendar {
                 
                 // Parse the JSON response
                 auto data = parse_response(response);
-                return data;
+                last_error_.clear();
+                return std::move(data.updated);
             } catch (const std::exception& e) {
                 last_error_ = e.what();
                 return {};
             }
         }
 
+        // The events as last synced, without touching the network
+        std::vector<event> stored_events() {
+            return event_store::instance().load(calendar_delegate_url_);
+        }
+
+        // Sync without blocking: with a token from the last sync only the changes since then are
+        // asked for, and `done` gets them on a scheduler thread once the store has them. A delegate
+        // that ignores the token answers with every event, which is then taken as a full sync.
+        // On failure `done` is not called and last_error() tells why. Needs shared ownership.
+        http::engine::transfer sync_async(std::function<void(event_changes)> done) {
+            auto token = event_store::instance().sync_token(calendar_delegate_url_);
+            http::request req;
+            req.url = token.empty() ? calendar_delegate_url_ : with_sync_token(calendar_delegate_url_, token);
+            return http::engine::instance().submit(std::move(req), [self = shared_from_this(), done = std::move(done), incremental = !token.empty()](http::response response) mutable {
+                // 410 Gone: the token expired, start over with a full sync
+                if (incremental && response.status == 410) {
+                    event_store::instance().forget_token(self->calendar_delegate_url_);
+                    self->sync_async(std::move(done));
+                    return;
+                }
+                if (!response.ok()) {
+                    std::lock_guard<std::mutex> lock(self->mutex_);
+                    self->last_error_ = response.error;
+                    return;
+                }
+                rouen::helpers::scheduler()->submit([self, done = std::move(done), incremental, body = std::move(response.body)](std::stop_token) {
+                    event_changes changes;
+                    {
+                        std::lock_guard<std::mutex> lock(self->mutex_);
+                        try {
+                            changes = self->parse_response(body);
+                            self->last_error_.clear();
+                        } catch (const std::exception& e) {
+                            self->last_error_ = e.what();
+                            return;
+                        }
+                    }
+                    changes.full = !incremental || changes.sync_token.empty();
+                    event_store::instance().apply(self->calendar_delegate_url_, changes);
+                    done(std::move(changes));
+                }, rouen::helpers::task_priority::normal);
+            });
+        }
+
         // Check if there was an error in the last operation
         bool has_error() const { return !last_error_.empty(); }
         
@@ -229,9 +282,24 @@ namespace calendar {
         std::string last_error_;
         std::mutex mutex_;
         
-        // Parse the calendar JSON response into a vector of events
-        std::vector<event> parse_response(const std::string& json_response) {
-            std::vector<event> events;
+        static std::string with_sync_token(const std::string& url, const std::string& token) {
+            std::string result = url;
+            result += url.find('?') == std::string::npos ? "?syncToken=" : "&syncToken=";
+            for (char c : token) {
+                if (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' || c == '.' || c == '~') {
+                    result += c;
+                } else {
+                    result += std::format("%{:02X}", static_cast<unsigned char>(c));
+                }
+            }
+            return result;
+        }
+
+        // Parse the calendar JSON response into the events it lists; cancelled ones (what an
+        // incremental sync reports for a deletion) go to `removed`
+        event_changes parse_response(const std::string& json_response) {
+            event_changes changes;
+            auto& events = changes.updated;
             
             try {
                 // Parse the JSON using glaze with the defined schemas
@@ -246,8 +314,14 @@ namespace calendar {
                     throw std::runtime_error("Failed to parse JSON response");
                 }
                 
+                changes.sync_token = calendar_data.nextSyncToken.value_or("");
+
                 // Process each event in the response
                 for (const auto& item : calendar_data.items) {
+                    if (item.status && *item.status == "cancelled") {
+                        changes.removed.push_back(item.id);
+                        continue;
+                    }
                     event evt;
                     
                     // Copy the basic properties
@@ -272,6 +346,9 @@ namespace calendar {
                         evt.end = item.end.date;
                     }
                     
+                    evt.start_time = timestamp::parse(evt.start).value_or(std::chrono::system_clock::time_point{});
+                    evt.end_time = timestamp::parse(evt.end).value_or(evt.start_time);
+                    
                     // Creator and organizer
                     evt.creator = item.creator ? item.creator->email : "";
                     evt.organizer = item.organizer ? item.organizer->email : "";
@@ -283,7 +360,7 @@ namespace calendar {
                 throw std::runtime_error(std::string("Failed to parse calendar response: ") + e.what());
             }
             
-            return events;
+            return changes;
         }
     };
 }
\ No newline at end of file
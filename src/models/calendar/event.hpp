@@ -2,6 +2,7 @@
 
 #include <string>
 #include <chrono>
+#include <ctime>
 #include <optional>
 #include <vector>
 
@@ -17,10 +18,30 @@ namespace calendar {
         std::string creator;
         std::string organizer;
         bool all_day = false;
+        // start and end with their UTC offsets applied (see timestamp::parse)
+        std::chrono::system_clock::time_point start_time {};
+        std::chrono::system_clock::time_point end_time {};
         
         // Helper function to format the date/time for display
         std::string format_time() const {
             return all_day ? start.substr(0, 10) : start.substr(0, 16);
         }
+
+        // Where the event starts on the local clock: an event at 23:30-05:00 may be tomorrow here.
+        // All-day events keep the date they were given.
+        std::tm local_start() const {
+            auto const time = std::chrono::system_clock::to_time_t(start_time);
+            return *std::localtime(&time);
+        }
+
+        std::string local_date() const {
+            if (all_day) {
+                return start.substr(0, 10);
+            }
+            auto const tm = local_start();
+            char buffer[11];
+            std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &tm);
+            return buffer;
+        }
     };
 }
\ No newline at end of file
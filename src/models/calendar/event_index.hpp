@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "event.hpp"
+
+namespace calendar {
+    /**
+     * Time lookups over a list of events, built once per sync instead of scanning the list
+     * for every day drawn. Timed events are sorted by start with a running maximum of their
+     * ends, so both "starts in [from, to)" and "overlaps [from, to)" are a binary search plus
+     * the matches. All-day events are looked up by the date they were given, which is how the
+     * card shows them whatever the local offset.
+     *
+     * Positions refer to the vector passed to build(); rebuild whenever it changes.
+     */
+    class event_index {
+    public:
+        using time_point = std::chrono::system_clock::time_point;
+
+        void build(std::vector<event> const& events) {
+            entries_.clear();
+            all_day_.clear();
+            for (size_t i = 0; i < events.size(); ++i) {
+                auto const& evt = events[i];
+                if (evt.all_day) {
+                    all_day_[evt.local_date()].push_back(i);
+                } else {
+                    entries_.push_back({evt.start_time, std::max(evt.end_time, evt.start_time), i});
+                }
+            }
+            std::ranges::stable_sort(entries_, {}, &entry::start);
+            max_end_.resize(entries_.size());
+            time_point running {time_point::min()};
+            for (size_t i = 0; i < entries_.size(); ++i) {
+                running = std::max(running, entries_[i].end);
+                max_end_[i] = running;
+            }
+        }
+
+        // Timed events whose start falls in [from, to), by start
+        std::vector<size_t> starting_in(time_point from, time_point to) const {
+            auto const first = std::ranges::lower_bound(entries_, from, {}, &entry::start);
+            auto const last = std::ranges::lower_bound(entries_, to, {}, &entry::start);
+            std::vector<size_t> result;
+            for (auto it = first; it < last; ++it) {
+                result.push_back(it->position);
+            }
+            return result;
+        }
+
+        // Timed events overlapping [from, to), by start; an event lasting several days is in each
+        std::vector<size_t> overlapping(time_point from, time_point to) const {
+            // Nothing before the first entry whose running end passes `from` can reach it
+            auto const first = static_cast<size_t>(std::ranges::upper_bound(max_end_, from) - max_end_.begin());
+            auto const last = static_cast<size_t>(std::ranges::lower_bound(entries_, to, {}, &entry::start) - entries_.begin());
+            std::vector<size_t> result;
+            for (size_t i = first; i < last; ++i) {
+                if (entries_[i].end > from || entries_[i].start >= from) {
+                    result.push_back(entries_[i].position);
+                }
+            }
+            return result;
+        }
+
+        // All-day events given for `date` (YYYY-MM-DD)
+        std::span<const size_t> all_day(std::string_view date) const {
+            auto const found = all_day_.find(std::string{date});
+            return found == all_day_.end() ? std::span<const size_t>{} : std::span<const size_t>{found->second};
+        }
+
+    private:
+        struct entry {
+            time_point start;
+            time_point end;
+            size_t position;
+        };
+
+        std::vector<entry> entries_;
+        std::vector<time_point> max_end_;   // running maximum of entries_[0..i].end
+        std::unordered_map<std::string, std::vector<size_t>> all_day_;
+    };
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../helpers/debug.hpp"
+#include "../../helpers/sqlite.hpp"
+#include "event.hpp"
+
+namespace calendar {
+    // What one sync brought: the events added or changed, the ids cancelled since the last one,
+    // and the token to ask from next time. A full sync lists every event and replaces the rest.
+    struct event_changes {
+        std::vector<event> updated;
+        std::vector<std::string> removed;
+        std::string sync_token;
+        bool full {false};
+    };
+
+    /**
+     * Every calendar's events as last synced, in calendar.db, so a card draws them at startup
+     * before the network answers and a sync only has to send what changed. Rows are keyed by
+     * the calendar's delegate URL and the event id; the sync token is kept per calendar.
+     */
+    class event_store {
+    public:
+        static event_store& instance() {
+            static event_store store {"calendar.db"};
+            return store;
+        }
+
+        event_store(const event_store&) = delete;
+        event_store& operator=(const event_store&) = delete;
+
+        // The calendar's events by start time
+        std::vector<event> load(std::string_view calendar) {
+            std::vector<event> events;
+            try {
+                db_.for_each_readonly<std::string, std::string, std::string, std::string, std::string, std::string, std::string,
+                             std::string, std::string, int64_t, int64_t, int64_t>(
+                    "SELECT id, summary, description, location, html_link, start, end, creator, organizer, all_day, start_time, end_time "
+                    "FROM event WHERE calendar = ? ORDER BY start_time, id",
+                    [&events](std::string id, std::string summary, std::string description, std::string location, std::string html_link,
+                              std::string start, std::string end, std::string creator, std::string organizer,
+                              int64_t all_day, int64_t start_time, int64_t end_time) {
+                        event evt;
+                        evt.id = std::move(id);
+                        evt.summary = std::move(summary);
+                        evt.description = std::move(description);
+                        evt.location = std::move(location);
+                        evt.htmlLink = std::move(html_link);
+                        evt.start = std::move(start);
+                        evt.end = std::move(end);
+                        evt.creator = std::move(creator);
+                        evt.organizer = std::move(organizer);
+                        evt.all_day = all_day != 0;
+                        evt.start_time = std::chrono::system_clock::time_point{std::chrono::seconds{start_time}};
+                        evt.end_time = std::chrono::system_clock::time_point{std::chrono::seconds{end_time}};
+                        events.push_back(std::move(evt));
+                    },
+                    calendar);
+            } catch (const std::exception& e) {
+                DB_ERROR_FMT("Calendar store: cannot load events: {}", e.what());
+            }
+            return events;
+        }
+
+        // Empty when the calendar has never been synced or its token was dropped
+        std::string sync_token(std::string_view calendar) {
+            std::string token;
+            try {
+                db_.for_each_readonly<std::string>("SELECT sync_token FROM calendar_state WHERE calendar = ?",
+                                          [&token](std::string value) { token = std::move(value); }, calendar);
+            } catch (const std::exception& e) {
+                DB_ERROR_FMT("Calendar store: cannot read sync state: {}", e.what());
+            }
+            return token;
+        }
+
+        // The server no longer accepts the token: the next sync is a full one
+        void forget_token(std::string_view calendar) {
+            try {
+                db_.exec("UPDATE calendar_state SET sync_token = '' WHERE calendar = ?", nullptr, calendar);
+            } catch (const std::exception& e) {
+                DB_ERROR_FMT("Calendar store: cannot reset sync state: {}", e.what());
+            }
+        }
+
+        // One transaction per sync, so a reader sees the calendar before or after it, never half
+        void apply(std::string_view calendar, event_changes const& changes) {
+            auto const synced_at = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            try {
+                db_.exec("BEGIN IMMEDIATE");
+                if (changes.full) {
+                    db_.exec("DELETE FROM event WHERE calendar = ?", nullptr, calendar);
+                }
+                auto upsert = db_.prepare(
+                    "INSERT OR REPLACE INTO event (calendar, id, summary, description, location, html_link, start, end, "
+                    "creator, organizer, all_day, start_time, end_time) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+                for (auto const& evt : changes.updated) {
+                    upsert.run(nullptr, calendar, evt.id, evt.summary, evt.description, evt.location, evt.htmlLink, evt.start, evt.end,
+                               evt.creator, evt.organizer, evt.all_day ? 1 : 0, seconds(evt.start_time), seconds(evt.end_time));
+                }
+                auto remove = db_.prepare("DELETE FROM event WHERE calendar = ? AND id = ?");
+                for (auto const& id : changes.removed) {
+                    remove.run(nullptr, calendar, id);
+                }
+                db_.exec("INSERT OR REPLACE INTO calendar_state (calendar, sync_token, synced_at) VALUES (?, ?, ?)",
+                         nullptr, calendar, changes.sync_token, synced_at);
+                db_.exec("COMMIT");
+            } catch (const std::exception& e) {
+                DB_ERROR_FMT("Calendar store: cannot apply sync: {}", e.what());
+                try {
+                    db_.exec("ROLLBACK");
+                } catch (...) {
+                    // Ignore rollback errors
+                }
+            }
+        }
+
+    private:
+        explicit event_store(const std::string& path) : db_{path} {
+            db_.ensure_table("event",
+                             "calendar TEXT NOT NULL, id TEXT NOT NULL, summary TEXT, description TEXT, location TEXT, "
+                             "html_link TEXT, start TEXT, end TEXT, creator TEXT, organizer TEXT, all_day INTEGER, "
+                             "start_time INTEGER, end_time INTEGER, PRIMARY KEY (calendar, id)");
+            db_.ensure_table("calendar_state", "calendar TEXT PRIMARY KEY, sync_token TEXT, synced_at INTEGER");
+            db_.exec("CREATE INDEX IF NOT EXISTS event_start ON event (calendar, start_time)");
+        }
+
+        static int64_t seconds(std::chrono::system_clock::time_point time) {
+            return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+        }
+
+        hosting::db::sqlite db_;
+    };
+}
@@ -0,0 +1,552 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rouen::models::chess {
+
+/**
+ * A bitboard chess core: a position is twelve 64-bit sets (a bit per square, a1 = 0 up to
+ * h8 = 63, the indexing Board uses), and moves are generated from precomputed attack tables.
+ * Sliding pieces use magic bitboards: the blockers on a square's rays, multiplied by a
+ * number found for that square, index its attack set directly. The magics are searched for
+ * once, on first use, from fixed seeds.
+ *
+ * Moves are made by copy (a position is about a hundred bytes), and a pseudo-legal move is
+ * legal when it leaves its own king unattacked. perft() counts the leaf nodes of the move
+ * tree, the standard check of a generator against published figures.
+ */
+using Bitboard = std::uint64_t;
+
+enum class Color : std::uint8_t { White, Black };
+
+enum class PieceType : std::uint8_t { Pawn, Knight, Bishop, Rook, Queen, King, None };
+
+constexpr Color opponent(Color c) {
+    return c == Color::White ? Color::Black : Color::White;
+}
+
+constexpr Bitboard square_bit(int square) {
+    return Bitboard{1} << square;
+}
+
+// The lowest square of a set, taken out of it
+inline int pop_square(Bitboard& set) {
+    int const square = std::countr_zero(set);
+    set &= set - 1;
+    return square;
+}
+
+// A move in 16 bits: from, to and the piece a pawn promotes to
+class PackedMove {
+public:
+    constexpr PackedMove() = default;
+    constexpr PackedMove(int from, int to, PieceType promotion = PieceType::None)
+        : bits_(static_cast<std::uint16_t>(from | (to << 6) | (static_cast<int>(promotion) << 12))) {}
+
+    constexpr int from() const { return bits_ & 63; }
+    constexpr int to() const { return (bits_ >> 6) & 63; }
+    constexpr PieceType promotion() const { return static_cast<PieceType>(bits_ >> 12); }
+    constexpr bool operator==(const PackedMove&) const = default;
+
+    // In UCI notation: "e2e4", "e7e8q"
+    std::string to_uci() const {
+        std::string uci {
+            static_cast<char>('a' + from() % 8), static_cast<char>('1' + from() / 8),
+            static_cast<char>('a' + to() % 8), static_cast<char>('1' + to() / 8)
+        };
+        if (promotion() != PieceType::None) {
+            uci += "pnbrqk"[static_cast<int>(promotion())];
+        }
+        return uci;
+    }
+
+private:
+    std::uint16_t bits_ = static_cast<std::uint16_t>(static_cast<int>(PieceType::None) << 12);
+};
+
+// The moves of a position; no legal position has more than 218
+class MoveList {
+public:
+    void push(PackedMove move) { moves_[size_++] = move; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const PackedMove* begin() const { return moves_.data(); }
+    const PackedMove* end() const { return moves_.data() + size_; }
+    PackedMove operator[](size_t i) const { return moves_[i]; }
+
+private:
+    std::array<PackedMove, 256> moves_;
+    size_t size_ = 0;
+};
+
+namespace detail {
+    struct Magic {
+        Bitboard mask = 0;          // the blockers that matter: the rays without their last square
+        Bitboard factor = 0;
+        unsigned shift = 0;
+        const Bitboard* attacks = nullptr;
+
+        size_t index(Bitboard occupied) const {
+            return static_cast<size_t>(((occupied & mask) * factor) >> shift);
+        }
+    };
+
+    class AttackTables {
+    public:
+        std::array<Bitboard, 64> knight {};
+        std::array<Bitboard, 64> king {};
+        std::array<std::array<Bitboard, 64>, 2> pawn {};    // the squares a pawn of each color takes on
+        std::array<Magic, 64> bishop;
+        std::array<Magic, 64> rook;
+
+        static const AttackTables& get() {
+            static const AttackTables tables;
+            return tables;
+        }
+
+    private:
+        static constexpr std::array<std::array<int, 2>, 4> bishop_directions {{{1, 1}, {1, -1}, {-1, 1}, {-1, -1}}};
+        static constexpr std::array<std::array<int, 2>, 4> rook_directions {{{1, 0}, {-1, 0}, {0, 1}, {0, -1}}};
+
+        AttackTables() {
+            for (int square = 0; square < 64; ++square) {
+                auto const i = static_cast<size_t>(square);
+                knight[i] = steps(square, {{{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}}});
+                king[i] = steps(square, {{{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}}});
+                pawn[0][i] = steps<2>(square, {{{-1, 1}, {1, 1}}});
+                pawn[1][i] = steps<2>(square, {{{-1, -1}, {1, -1}}});
+            }
+            // 5248 bishop and 102400 rook attack sets, at most
+            sliding_.reserve(5248 + 102400);
+            find_magics(bishop, bishop_directions);
+            find_magics(rook, rook_directions);
+        }
+
+        template <size_t N = 8>
+        static Bitboard steps(int square, std::array<std::array<int, 2>, N> const& deltas) {
+            Bitboard set = 0;
+            for (auto const& [df, dr] : deltas) {
+                int const file = square % 8 + df, rank = square / 8 + dr;
+                if (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+                    set |= square_bit(rank * 8 + file);
+                }
+            }
+            return set;
+        }
+
+        // Ray walking, for building the tables
+        static Bitboard slide(int square, Bitboard occupied, std::array<std::array<int, 2>, 4> const& directions) {
+            Bitboard set = 0;
+            for (auto const& [df, dr] : directions) {
+                for (int file = square % 8 + df, rank = square / 8 + dr; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += df, rank += dr) {
+                    set |= square_bit(rank * 8 + file);
+                    if (occupied & square_bit(rank * 8 + file)) {
+                        break;
+                    }
+                }
+            }
+            return set;
+        }
+
+        void find_magics(std::array<Magic, 64>& magics, std::array<std::array<int, 2>, 4> const& directions) {
+            // xorshift64*, seeded per rank with values known to find every magic quickly
+            static constexpr std::array<std::uint64_t, 8> seeds {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+            std::uint64_t seed = 0;
+            auto random = [&seed] {
+                seed ^= seed >> 12;
+                seed ^= seed << 25;
+                seed ^= seed >> 27;
+                return seed * 2685821657736338717ull;
+            };
+            std::vector<Bitboard> occupancies, reference;
+            std::vector<int> epoch;
+            for (int square = 0; square < 64; ++square) {
+                int const file = square % 8, rank = square / 8;
+                seed = seeds[static_cast<size_t>(rank)];
+                Bitboard const edges = ((0xFFull | 0xFF00000000000000ull) & ~(0xFFull << (rank * 8)))
+                                     | ((0x0101010101010101ull | 0x8080808080808080ull) & ~(0x0101010101010101ull << file));
+                auto& magic = magics[static_cast<size_t>(square)];
+                magic.mask = slide(square, 0, directions) & ~edges;
+                magic.shift = 64 - static_cast<unsigned>(std::popcount(magic.mask));
+
+                // Every subset of the mask (carry-rippler) and its attacks
+                occupancies.clear();
+                reference.clear();
+                Bitboard subset = 0;
+                do {
+                    occupancies.push_back(subset);
+                    reference.push_back(slide(square, subset, directions));
+                    subset = (subset - magic.mask) & magic.mask;
+                } while (subset);
+
+                auto const offset = sliding_.size();
+                sliding_.resize(offset + occupancies.size());
+                epoch.assign(occupancies.size(), 0);
+                for (int attempt = 1;; ++attempt) {
+                    do {
+                        magic.factor = random() & random() & random();
+                    } while (std::popcount((magic.mask * magic.factor) >> 56) < 6);
+                    bool clean = true;
+                    for (size_t i = 0; clean && i < occupancies.size(); ++i) {
+                        auto const slot = magic.index(occupancies[i]);
+                        if (epoch[slot] < attempt) {
+                            epoch[slot] = attempt;
+                            sliding_[offset + slot] = reference[i];
+                        } else if (sliding_[offset + slot] != reference[i]) {
+                            clean = false;
+                        }
+                    }
+                    if (clean) {
+                        break;
+                    }
+                }
+                // reserve() keeps this pointer valid while later squares are added
+                magic.attacks = sliding_.data() + offset;
+            }
+        }
+
+        std::vector<Bitboard> sliding_;
+    };
+}
+
+inline Bitboard bishop_attacks(int square, Bitboard occupied) {
+    auto const& magic = detail::AttackTables::get().bishop[static_cast<size_t>(square)];
+    return magic.attacks[magic.index(occupied)];
+}
+
+inline Bitboard rook_attacks(int square, Bitboard occupied) {
+    auto const& magic = detail::AttackTables::get().rook[static_cast<size_t>(square)];
+    return magic.attacks[magic.index(occupied)];
+}
+
+class BitboardPosition {
+public:
+    static constexpr std::string_view starting_fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    // Castling rights
+    static constexpr std::uint8_t white_king_side = 1, white_queen_side = 2, black_king_side = 4, black_queen_side = 8;
+
+    static BitboardPosition starting() {
+        return *from_fen(starting_fen);
+    }
+
+    // The position a FEN string describes; nullopt if it doesn't parse
+    static std::optional<BitboardPosition> from_fen(std::string_view fen) {
+        BitboardPosition position;
+        auto next_field = [&fen]() {
+            while (!fen.empty() && fen.front() == ' ') {
+                fen.remove_prefix(1);
+            }
+            auto const end = std::min(fen.find(' '), fen.size());
+            auto const field = fen.substr(0, end);
+            fen.remove_prefix(end);
+            return field;
+        };
+
+        int rank = 7, file = 0;
+        for (char c : next_field()) {
+            if (c == '/') {
+                if (file != 8 || --rank < 0) {
+                    return std::nullopt;
+                }
+                file = 0;
+            } else if (c >= '1' && c <= '8') {
+                file += c - '0';
+            } else {
+                auto const type = std::string_view{"pnbrqk"}.find(static_cast<char>(c | 0x20));
+                if (type == std::string_view::npos || file > 7) {
+                    return std::nullopt;
+                }
+                position.put(c >= 'a' ? Color::Black : Color::White, static_cast<PieceType>(type), rank * 8 + file++);
+            }
+        }
+        if (rank != 0 || file != 8) {
+            return std::nullopt;
+        }
+
+        auto const side = next_field();
+        if (side != "w" && side != "b") {
+            return std::nullopt;
+        }
+        position.side_ = side == "w" ? Color::White : Color::Black;
+
+        for (char c : next_field()) {
+            switch (c) {
+                case 'K': position.castling_ |= white_king_side; break;
+                case 'Q': position.castling_ |= white_queen_side; break;
+                case 'k': position.castling_ |= black_king_side; break;
+                case 'q': position.castling_ |= black_queen_side; break;
+                case '-': break;
+                default: return std::nullopt;
+            }
+        }
+
+        if (auto const ep = next_field(); ep.size() == 2 && ep[0] >= 'a' && ep[0] <= 'h' && ep[1] >= '1' && ep[1] <= '8') {
+            position.en_passant_ = (ep[1] - '1') * 8 + (ep[0] - 'a');
+        } else if (ep != "-") {
+            return std::nullopt;
+        }
+
+        if (auto const halfmove = next_field(); !halfmove.empty()) {
+            position.halfmove_clock_ = std::atoi(std::string{halfmove}.c_str());
+        }
+        if (auto const fullmove = next_field(); !fullmove.empty()) {
+            position.fullmove_number_ = std::max(1, std::atoi(std::string{fullmove}.c_str()));
+        }
+        if (std::popcount(position.pieces(Color::White, PieceType::King)) != 1 || std::popcount(position.pieces(Color::Black, PieceType::King)) != 1) {
+            return std::nullopt;
+        }
+        return position;
+    }
+
+    Color side_to_move() const { return side_; }
+    std::uint8_t castling_rights() const { return castling_; }
+    int en_passant_square() const { return en_passant_; }      // -1 if none
+    int halfmove_clock() const { return halfmove_clock_; }
+    int fullmove_number() const { return fullmove_number_; }
+
+    Bitboard pieces(Color color, PieceType type) const { return pieces_[index(color)][static_cast<size_t>(type)]; }
+    Bitboard occupied(Color color) const { return occupied_[index(color)]; }
+    Bitboard occupied() const { return occupied_[0] | occupied_[1]; }
+
+    PieceType type_at(int square) const {
+        auto const color = (occupied_[1] & square_bit(square)) ? 1u : 0u;
+        for (size_t type = 0; type < 6; ++type) {
+            if (pieces_[color][type] & square_bit(square)) {
+                return static_cast<PieceType>(type);
+            }
+        }
+        return PieceType::None;
+    }
+
+    // Whether `by` attacks the square
+    bool attacked(int square, Color by) const {
+        auto const& tables = detail::AttackTables::get();
+        auto const& their = pieces_[index(by)];
+        auto const all = occupied();
+        auto const at = static_cast<size_t>(square);
+        return (tables.pawn[index(opponent(by))][at] & their[0])
+            || (tables.knight[at] & their[1])
+            || (tables.king[at] & their[5])
+            || (bishop_attacks(square, all) & (their[2] | their[4]))
+            || (rook_attacks(square, all) & (their[3] | their[4]));
+    }
+
+    bool in_check() const {
+        return attacked(king_square(side_), opponent(side_));
+    }
+
+    // The position after a move generate_legal_moves() gave
+    BitboardPosition after(PackedMove move) const {
+        BitboardPosition next = *this;
+        auto const us = side_, them = opponent(side_);
+        int const from = move.from(), to = move.to();
+        auto const moving = type_at(from);
+
+        next.halfmove_clock_ = moving == PieceType::Pawn ? 0 : halfmove_clock_ + 1;
+        if (occupied_[index(them)] & square_bit(to)) {
+            next.remove(them, type_at(to), to);
+            next.halfmove_clock_ = 0;
+        }
+        next.remove(us, moving, from);
+        next.put(us, move.promotion() != PieceType::None ? move.promotion() : moving, to);
+
+        next.en_passant_ = -1;
+        if (moving == PieceType::Pawn) {
+            if (to == en_passant_) {
+                next.remove(them, PieceType::Pawn, us == Color::White ? to - 8 : to + 8);
+            } else if (std::abs(to - from) == 16) {
+                next.en_passant_ = (from + to) / 2;
+            }
+        } else if (moving == PieceType::King && std::abs(to - from) == 2) {
+            bool const king_side = to > from;
+            next.remove(us, PieceType::Rook, king_side ? from + 3 : from - 4);
+            next.put(us, PieceType::Rook, king_side ? from + 1 : from - 1);
+        }
+
+        next.castling_ &= static_cast<std::uint8_t>(castling_kept(from) & castling_kept(to));
+        next.side_ = them;
+        if (us == Color::Black) {
+            ++next.fullmove_number_;
+        }
+        return next;
+    }
+
+    // Every legal move
+    MoveList legal_moves() const {
+        MoveList pseudo, legal;
+        generate_pseudo_legal(pseudo);
+        auto const us = side_;
+        for (auto move : pseudo) {
+            auto const next = after(move);
+            if (!next.attacked(next.king_square(us), next.side_)) {
+                legal.push(move);
+            }
+        }
+        return legal;
+    }
+
+    bool is_checkmate() const {
+        return in_check() && legal_moves().empty();
+    }
+
+    bool is_stalemate() const {
+        return !in_check() && legal_moves().empty();
+    }
+
+    // The legal move a UCI string names, if it is one
+    std::optional<PackedMove> find_move(std::string_view uci) const {
+        for (auto move : legal_moves()) {
+            if (move.to_uci() == uci) {
+                return move;
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    static constexpr size_t index(Color color) { return static_cast<size_t>(color); }
+
+    int king_square(Color color) const {
+        return std::countr_zero(pieces(color, PieceType::King));
+    }
+
+    void put(Color color, PieceType type, int square) {
+        pieces_[index(color)][static_cast<size_t>(type)] |= square_bit(square);
+        occupied_[index(color)] |= square_bit(square);
+    }
+
+    void remove(Color color, PieceType type, int square) {
+        pieces_[index(color)][static_cast<size_t>(type)] &= ~square_bit(square);
+        occupied_[index(color)] &= ~square_bit(square);
+    }
+
+    // The rights that survive a move from or to the square
+    static constexpr std::uint8_t castling_kept(int square) {
+        switch (square) {
+            case 0: return static_cast<std::uint8_t>(~white_queen_side);
+            case 4: return static_cast<std::uint8_t>(~(white_king_side | white_queen_side));
+            case 7: return static_cast<std::uint8_t>(~white_king_side);
+            case 56: return static_cast<std::uint8_t>(~black_queen_side);
+            case 60: return static_cast<std::uint8_t>(~(black_king_side | black_queen_side));
+            case 63: return static_cast<std::uint8_t>(~black_king_side);
+            default: return 0xFF;
+        }
+    }
+
+    static void add_promotions(MoveList& moves, int from, int to) {
+        moves.push({from, to, PieceType::Queen});
+        moves.push({from, to, PieceType::Rook});
+        moves.push({from, to, PieceType::Bishop});
+        moves.push({from, to, PieceType::Knight});
+    }
+
+    void generate_pseudo_legal(MoveList& moves) const {
+        auto const& tables = detail::AttackTables::get();
+        auto const us = side_, them = opponent(side_);
+        auto const& ours = pieces_[index(us)];
+        auto const all = occupied(), targets = ~occupied_[index(us)], enemies = occupied_[index(them)];
+        bool const white = us == Color::White;
+        int const forward = white ? 8 : -8;
+        Bitboard const last_rank = white ? 0xFF00000000000000ull : 0xFFull;
+        Bitboard const double_rank = white ? 0xFF000000ull : 0xFF00000000ull;   // where a double push lands
+
+        // Pawns: pushes and captures, promotions on the last rank
+        Bitboard const empty = ~all;
+        Bitboard single = (white ? ours[0] << 8 : ours[0] >> 8) & empty;
+        Bitboard twice = (white ? single << 8 : single >> 8) & empty & double_rank;
+        for (Bitboard set = single; set;) {
+            int const to = pop_square(set);
+            if (square_bit(to) & last_rank) {
+                add_promotions(moves, to - forward, to);
+            } else {
+                moves.push({to - forward, to});
+            }
+        }
+        while (twice) {
+            int const to = pop_square(twice);
+            moves.push({to - 2 * forward, to});
+        }
+        Bitboard const takeable = enemies | (en_passant_ >= 0 ? square_bit(en_passant_) : 0);
+        for (Bitboard pawns = ours[0]; pawns;) {
+            int const from = pop_square(pawns);
+            for (Bitboard set = tables.pawn[index(us)][static_cast<size_t>(from)] & takeable; set;) {
+                int const to = pop_square(set);
+                if (square_bit(to) & last_rank) {
+                    add_promotions(moves, from, to);
+                } else {
+                    moves.push({from, to});
+                }
+            }
+        }
+
+        // Pieces
+        auto add = [&moves](int from, Bitboard set) {
+            while (set) {
+                moves.push({from, pop_square(set)});
+            }
+        };
+        for (Bitboard set = ours[1]; set;) {
+            int const from = pop_square(set);
+            add(from, tables.knight[static_cast<size_t>(from)] & targets);
+        }
+        for (Bitboard set = ours[2] | ours[4]; set;) {
+            int const from = pop_square(set);
+            add(from, bishop_attacks(from, all) & targets);
+        }
+        for (Bitboard set = ours[3] | ours[4]; set;) {
+            int const from = pop_square(set);
+            add(from, rook_attacks(from, all) & targets);
+        }
+        int const king = king_square(us);
+        add(king, tables.king[static_cast<size_t>(king)] & targets);
+
+        // Castling: the rights, empty squares between, and no attacked square on the king's way
+        auto const king_side = white ? white_king_side : black_king_side;
+        auto const queen_side = white ? white_queen_side : black_queen_side;
+        int const home = white ? 4 : 60;
+        if (king == home && (castling_ & (king_side | queen_side)) && !attacked(home, them)) {
+            if ((castling_ & king_side) && !(all & (square_bit(home + 1) | square_bit(home + 2)))
+                && (ours[3] & square_bit(home + 3)) && !attacked(home + 1, them) && !attacked(home + 2, them)) {
+                moves.push({home, home + 2});
+            }
+            if ((castling_ & queen_side) && !(all & (square_bit(home - 1) | square_bit(home - 2) | square_bit(home - 3)))
+                && (ours[3] & square_bit(home - 4)) && !attacked(home - 1, them) && !attacked(home - 2, them)) {
+                moves.push({home, home - 2});
+            }
+        }
+    }
+
+    std::array<std::array<Bitboard, 6>, 2> pieces_ {};
+    std::array<Bitboard, 2> occupied_ {};
+    Color side_ = Color::White;
+    std::uint8_t castling_ = 0;
+    int en_passant_ = -1;
+    int halfmove_clock_ = 0;
+    int fullmove_number_ = 1;
+};
+
+// The number of leaf nodes of the legal move tree `depth` plies deep
+inline std::uint64_t perft(const BitboardPosition& position, int depth) {
+    if (depth <= 0) {
+        return 1;
+    }
+    auto const moves = position.legal_moves();
+    if (depth == 1) {
+        return moves.size();
+    }
+    std::uint64_t nodes = 0;
+    for (auto move : moves) {
+        nodes += perft(position.after(move), depth - 1);
+    }
+    return nodes;
+}
+
+} // namespace rouen::models::chess
@@ -10,10 +10,12 @@
 #include <format>
 #include <algorithm>
 #include <array>
+#include <cstdlib>
 #include <sstream>
 #include <fstream>
 
-#include "../helpers/debug.hpp"
+#include "../../helpers/debug.hpp"
+#include "pgn_reader.hpp"
 
 namespace rouen::models::chess {
 
@@ -80,6 +82,19 @@ struct Move {
     
     // Default constructor
     Move() : from{-1, -1}, to{-1, -1} {}
+
+    // The move as engines take it (e.g., "e2e4", "e1g1", "e7e8q")
+    std::string uci() const {
+        std::string text = from.to_algebraic() + to.to_algebraic();
+        switch (promotion) {
+            case Piece::WhiteQueen: case Piece::BlackQueen: text += 'q'; break;
+            case Piece::WhiteRook: case Piece::BlackRook: text += 'r'; break;
+            case Piece::WhiteBishop: case Piece::BlackBishop: text += 'b'; break;
+            case Piece::WhiteKnight: case Piece::BlackKnight: text += 'n'; break;
+            default: break;
+        }
+        return text;
+    }
 };
 
 // Represents a chess board
@@ -133,38 +148,70 @@ public:
         return pieces[position_to_index(pos)];
     }
     
+    // What apply() changed, for undo() to put back
+    struct change {
+        Piece moved = Piece::None;
+        Piece captured = Piece::None;
+        Position captured_at {-1, -1};  // the destination, or the pawn taken en passant
+        Position rook_from {-1, -1};    // castling
+        Position rook_to {-1, -1};
+    };
+    
     // Apply a move to the board
     void apply_move(const Move& move) {
-        CHESS_TRACE_FMT("apply_move: {} -> {} ({})", move.from.to_algebraic(), move.to.to_algebraic(), move.algebraic);
+        (void)apply(move);
+    }
+    
+    // Apply a move, returning what undo() needs to take it back
+    change apply(const Move& move) {
+        CHESS_TRACE_FMT("apply: {} -> {} ({})", move.from.to_algebraic(), move.to.to_algebraic(), move.algebraic);
+        change done;
         if (!move.from.is_valid() || !move.to.is_valid()) {
             CHESS_WARN_FMT("Invalid move: from={} to={}", 
                          move.from.to_algebraic(), move.to.to_algebraic());
-            return;
+            return done;
         }
         
-        Piece piece = get_piece(move.from);
+        done.moved = get_piece(move.from);
+        done.captured_at = move.to;
+        done.captured = get_piece(move.to);
         
-        // Handle captures
-        if (move.is_capture) {
-            CHESS_INFO_FMT("Capture at {}", move.to.to_algebraic());
+        // A pawn moving diagonally to an empty square takes the pawn beside it
+        bool const pawn = done.moved == Piece::WhitePawn || done.moved == Piece::BlackPawn;
+        if (pawn && move.from.file != move.to.file && done.captured == Piece::None) {
+            done.captured_at = {move.to.file, move.from.rank};
+            done.captured = get_piece(done.captured_at);
+            pieces[position_to_index(done.captured_at)] = Piece::None;
         }
         
-        // Move the piece
-        pieces[position_to_index(move.to)] = piece;
+        // Move the piece, promoted if it is
+        pieces[position_to_index(move.to)] = move.promotion != Piece::None ? move.promotion : done.moved;
         pieces[position_to_index(move.from)] = Piece::None;
         
-        // Handle promotion
-        if (move.promotion != Piece::None) {
-            pieces[position_to_index(move.to)] = move.promotion;
-            CHESS_INFO_FMT("Promotion at {} to {}", 
-                         move.to.to_algebraic(), 
-                         get_piece_name(move.promotion));
+        // Castling moves the rook too
+        bool const king = done.moved == Piece::WhiteKing || done.moved == Piece::BlackKing;
+        if (king && (move.is_castle || std::abs(move.to.file - move.from.file) == 2)) {
+            bool const king_side = move.to.file > move.from.file;
+            done.rook_from = {king_side ? 7 : 0, move.from.rank};
+            done.rook_to = {king_side ? 5 : 3, move.from.rank};
+            pieces[position_to_index(done.rook_to)] = get_piece(done.rook_from);
+            pieces[position_to_index(done.rook_from)] = Piece::None;
         }
-        
-        CHESS_INFO_FMT("Move applied: {} from {} to {}", 
-                     get_piece_name(piece),
-                     move.from.to_algebraic(), 
-                     move.to.to_algebraic());
+        return done;
+    }
+    
+    // Take back a move apply() returned `done` for; the last one applied
+    void undo(const Move& move, const change& done) {
+        if (!move.from.is_valid() || !move.to.is_valid()) {
+            return;
+        }
+        if (done.rook_from.is_valid()) {
+            pieces[position_to_index(done.rook_from)] = get_piece(done.rook_to);
+            pieces[position_to_index(done.rook_to)] = Piece::None;
+        }
+        pieces[position_to_index(move.to)] = Piece::None;
+        pieces[position_to_index(done.captured_at)] = done.captured;
+        pieces[position_to_index(move.from)] = done.moved;
     }
     
     // Clear the board
@@ -261,6 +308,9 @@ public:
         board.reset_to_starting_position();
         moves.clear();
         current_move_index = 0;
+        changes.clear();
+        snapshots.assign(1, board);
+        indexed_board = board;
         white_player = "White";
         black_player = "Black";
         event = "Chess Game";
@@ -274,12 +324,14 @@ public:
     // Add a move to the game
     void add_move(const Move& move) {
         moves.push_back(move);
+        index_positions();
         CHESS_INFO_FMT("Move added: {}", move.algebraic);
     }
     
     // Batch add moves to the game
     void add_moves(const std::vector<Move>& new_moves) {
         moves.insert(moves.end(), new_moves.begin(), new_moves.end());
+        index_positions();
         CHESS_INFO_FMT("Added {} moves to the game", new_moves.size());
     }
     
@@ -307,12 +359,18 @@ public:
             return;
         }
         
-        // Reset the board and replay moves up to the specified index
-        board.reset_to_starting_position();
-        
-        for (size_t i = 0; i < move_index; ++i) {
-            CHESS_TRACE_FMT("Applying move {}: {}", i, moves[i].algebraic);
-            board.apply_move(moves[i]);
+        if (move_index == current_move_index + 1) {
+            board.apply(moves[current_move_index]);
+        } else if (move_index + 1 == current_move_index) {
+            board.undo(moves[move_index], changes[move_index]);
+        } else if (move_index != current_move_index) {
+            // From the nearest snapshot at or before it: fewer than snapshot_interval moves
+            auto const snapshot = move_index / snapshot_interval;
+            board = snapshots[snapshot];
+            for (size_t i = snapshot * snapshot_interval; i < move_index; ++i) {
+                CHESS_TRACE_FMT("Applying move {}: {}", i, moves[i].algebraic);
+                board.apply(moves[i]);
+            }
         }
         
         current_move_index = move_index;
@@ -390,6 +448,32 @@ public:
         return !moves.empty();
     }
     
+    // Load one game of a collection; its SAN moves are only resolved now
+    bool load_from_view(const PgnGameView& view) {
+        reset();
+        
+        std::string_view tags = view.tags;
+        while (!tags.empty()) {
+            auto const end = std::min(tags.find('\n'), tags.size());
+            if (auto line = tags.substr(0, end); line.starts_with('[')) {
+                parse_pgn_tag(std::string{line});
+            }
+            tags.remove_prefix(std::min(end + 1, tags.size()));
+        }
+        
+        std::string san;
+        SanTokens tokens {view.movetext};
+        while (auto token = tokens.next()) {
+            san.append(*token);
+            san.push_back(' ');
+        }
+        add_moves(parse_pgn_moves(san));
+        set_position(0);
+        
+        CHESS_INFO_FMT("Loaded game from collection with {} moves", moves.size());
+        return !moves.empty();
+    }
+    
     // Load a game from a PGN file
     bool load_from_pgn_file(const std::string& filepath) {
         try {
@@ -435,9 +519,25 @@ public:
     std::string result;
     
 private:
+    // Plies between two snapshots: what a seek replays at most
+    static constexpr size_t snapshot_interval = 16;
+    
     Board board;
     std::vector<Move> moves;
     size_t current_move_index;
+    std::vector<Board::change> changes;     // per move, to step back over it
+    std::vector<Board> snapshots;           // the board every snapshot_interval plies
+    Board indexed_board;                    // after the last move in changes
+    
+    // Records the changes and snapshots of the moves added since the last call
+    void index_positions() {
+        for (size_t i = changes.size(); i < moves.size(); ++i) {
+            changes.push_back(indexed_board.apply(moves[i]));
+            if ((i + 1) % snapshot_interval == 0) {
+                snapshots.push_back(indexed_board);
+            }
+        }
+    }
     
     // Parse a PGN tag (e.g., [Event "World Championship"])
     void parse_pgn_tag(const std::string& tag_line) {
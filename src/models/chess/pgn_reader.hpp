@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rouen::models::chess {
+
+// A PGN file's bytes, mapped read-only (read into memory where mmap isn't available)
+class PgnFile {
+public:
+    static std::shared_ptr<const PgnFile> open(const std::string& path) {
+        auto file = std::shared_ptr<PgnFile>(new PgnFile);
+#ifndef _WIN32
+        int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* base = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (base != MAP_FAILED) {
+                // Read front to back, once
+                ::madvise(base, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                file->mapped_ = base;
+                file->text_ = {static_cast<const char*>(base), static_cast<size_t>(st.st_size)};
+            }
+        }
+        ::close(fd);
+        if (file->mapped_ || st.st_size == 0) {
+            return file;
+        }
+#endif
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return nullptr;
+        }
+        file->owned_.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+        file->text_ = file->owned_;
+        return file;
+    }
+
+    ~PgnFile() {
+#ifndef _WIN32
+        if (mapped_) {
+            ::munmap(mapped_, text_.size());
+        }
+#endif
+    }
+
+    PgnFile(const PgnFile&) = delete;
+    PgnFile& operator=(const PgnFile&) = delete;
+
+    std::string_view text() const { return text_; }
+
+private:
+    PgnFile() = default;
+
+    void* mapped_ = nullptr;
+    std::string owned_;
+    std::string_view text_;
+};
+
+// One game of a PGN text: views into it, valid while the text is
+struct PgnGameView {
+    std::string_view tags;      // the [Name "value"] lines
+    std::string_view movetext;
+
+    // A tag's value as written (escapes left in); empty if the game has no such tag
+    std::string_view tag(std::string_view name) const {
+        std::string_view rest = tags;
+        while (!rest.empty()) {
+            auto const end = std::min(rest.find('\n'), rest.size());
+            auto line = rest.substr(0, end);
+            rest.remove_prefix(std::min(end + 1, rest.size()));
+            if (line.size() > name.size() + 2 && line[0] == '[' && line.substr(1, name.size()) == name && line[name.size() + 1] == ' ') {
+                auto const open = line.find('"');
+                auto const close = line.rfind('"');
+                return open != std::string_view::npos && close > open ? line.substr(open + 1, close - open - 1) : std::string_view{};
+            }
+        }
+        return {};
+    }
+};
+
+/**
+ * Splits a PGN text into games without copying anything: a game is its tag lines and the
+ * movetext after them, up to the next line starting with '[' outside a comment. Only line
+ * starts and comment delimiters matter, so indexing a file is one pass over its bytes.
+ */
+class PgnReader {
+public:
+    explicit PgnReader(std::string_view text) : text_(text) {
+        if (text_.starts_with("\xEF\xBB\xBF")) {
+            pos_ = 3;
+        }
+    }
+
+    std::optional<PgnGameView> next() {
+        skip_blank_lines();
+        if (pos_ >= text_.size()) {
+            return std::nullopt;
+        }
+        PgnGameView game;
+        auto const tags_begin = pos_;
+        while (pos_ < text_.size() && text_[pos_] == '[') {
+            pos_ = line_end(pos_);
+        }
+        game.tags = text_.substr(tags_begin, pos_ - tags_begin);
+
+        skip_blank_lines();
+        auto const moves_begin = pos_;
+        int comment = 0;
+        while (pos_ < text_.size() && !(comment == 0 && text_[pos_] == '[')) {
+            auto const end = line_end(pos_);
+            for (auto at = pos_; at < end; ++at) {
+                char const c = text_[at];
+                if (c == '{') {
+                    ++comment;
+                } else if (c == '}' && comment > 0) {
+                    --comment;
+                } else if (c == ';' && comment == 0) {
+                    break;      // the rest of the line is a comment
+                }
+            }
+            pos_ = end;
+        }
+        game.movetext = text_.substr(moves_begin, pos_ - moves_begin);
+        return game;
+    }
+
+    // Where the next game starts (or the blank lines before it)
+    size_t offset() const { return pos_; }
+
+private:
+    // Past the line starting at `from`, newline included
+    size_t line_end(size_t from) const {
+        auto const* nl = static_cast<const char*>(std::memchr(text_.data() + from, '\n', text_.size() - from));
+        return nl ? static_cast<size_t>(nl - text_.data()) + 1 : text_.size();
+    }
+
+    void skip_blank_lines() {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+// The SAN moves of a movetext, in order: move numbers, comments, variations, annotation
+// glyphs and the result are skipped
+class SanTokens {
+public:
+    explicit SanTokens(std::string_view movetext) : text_(movetext) {}
+
+    std::optional<std::string_view> next() {
+        while (pos_ < text_.size()) {
+            char const c = text_[pos_];
+            if (std::isspace(static_cast<unsigned char>(c)) || c == ')') {
+                ++pos_;
+            } else if (c == '{') {
+                skip_past('}');
+            } else if (c == ';') {
+                skip_past('\n');
+            } else if (c == '(') {
+                skip_variation();
+            } else if (c == '$' || c == '*') {
+                skip_token();
+            } else {
+                auto token = take_token();
+                // "12." and "12...", possibly glued to the move ("12.e4")
+                if (std::isdigit(static_cast<unsigned char>(token[0])) && !token.starts_with("0-0")) {
+                    auto const dots = token.find('.');
+                    if (dots == std::string_view::npos) {
+                        continue;       // a result ("1-0", "1/2-1/2") or a bare number
+                    }
+                    token.remove_prefix(std::min(token.find_first_not_of('.', dots), token.size()));
+                }
+                while (!token.empty() && (token.back() == '!' || token.back() == '?')) {
+                    token.remove_suffix(1);
+                }
+                if (!token.empty()) {
+                    return token;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    static bool ends_token(char c) {
+        return std::isspace(static_cast<unsigned char>(c)) || c == '{' || c == '(' || c == ')' || c == ';';
+    }
+
+    std::string_view take_token() {
+        auto const begin = pos_;
+        while (pos_ < text_.size() && !ends_token(text_[pos_])) {
+            ++pos_;
+        }
+        return text_.substr(begin, pos_ - begin);
+    }
+
+    void skip_token() {
+        (void)take_token();
+    }
+
+    void skip_past(char c) {
+        auto const end = text_.find(c, pos_ + 1);
+        pos_ = end == std::string_view::npos ? text_.size() : end + 1;
+    }
+
+    // A parenthesized variation, nested ones and comments in it included
+    void skip_variation() {
+        int depth = 0;
+        while (pos_ < text_.size()) {
+            char const c = text_[pos_];
+            if (c == '{') {
+                skip_past('}');
+                continue;
+            }
+            ++pos_;
+            if (c == '(') {
+                ++depth;
+            } else if (c == ')' && --depth == 0) {
+                return;
+            }
+        }
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+};
+
+/**
+ * A PGN file and where each of its games starts. index() runs once, on a worker, and the
+ * games can be listed while it does; a game is only split into tags and moves when asked
+ * for, so a collection of millions costs eight bytes a game until then.
+ */
+class PgnCollection {
+public:
+    explicit PgnCollection(std::shared_ptr<const PgnFile> file) : file_(std::move(file)) {}
+
+    void index(std::stop_token stop) {
+        PgnReader reader {file_->text()};
+        std::vector<std::uint64_t> batch;
+        for (;;) {
+            auto const at = reader.offset();
+            if (!reader.next()) {
+                break;
+            }
+            batch.push_back(at);
+            if (batch.size() == 4096 || stop.stop_requested()) {
+                publish(batch);
+                if (stop.stop_requested()) {
+                    return;
+                }
+            }
+        }
+        publish(batch);
+        indexed_ = true;
+    }
+
+    // Games found so far
+    size_t size() const {
+        std::lock_guard lock(mutex_);
+        return offsets_.size();
+    }
+
+    bool indexed() const { return indexed_; }
+
+    std::optional<PgnGameView> game(size_t i) const {
+        std::uint64_t offset = 0;
+        {
+            std::lock_guard lock(mutex_);
+            if (i >= offsets_.size()) {
+                return std::nullopt;
+            }
+            offset = offsets_[i];
+        }
+        return PgnReader{file_->text().substr(offset)}.next();
+    }
+
+private:
+    void publish(std::vector<std::uint64_t>& batch) {
+        std::lock_guard lock(mutex_);
+        offsets_.insert(offsets_.end(), batch.begin(), batch.end());
+        batch.clear();
+    }
+
+    std::shared_ptr<const PgnFile> file_;
+    mutable std::mutex mutex_;
+    std::vector<std::uint64_t> offsets_;
+    std::atomic<bool> indexed_ {false};
+};
+
+} // namespace rouen::models::chess
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../helpers/debug.hpp"
+#include "../../helpers/sqlite.hpp"
+#include "../../helpers/write_behind.hpp"
+#include "chess.hpp"
+
+namespace rouen::models::chess {
+
+// Zobrist keys: one per piece and square, and one for black to move, from a fixed seed so
+// hashes stored on disk stay valid between runs
+namespace zobrist {
+    constexpr std::uint64_t splitmix(std::uint64_t& state) {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    inline constexpr auto keys = [] {
+        std::array<std::uint64_t, 13 * 64 + 1> k {};
+        std::uint64_t state = 0x5EED5EED5EED5EEDull;
+        for (auto& key : k) {
+            key = splitmix(state);
+        }
+        return k;
+    }();
+
+    // The board has no castling or en passant state: positions differing only in those hash the same
+    inline std::uint64_t hash(const Board& board, bool white_to_move) {
+        std::uint64_t h = white_to_move ? 0 : keys[13 * 64];
+        auto const& squares = board.get_board();
+        for (size_t square = 0; square < squares.size(); ++square) {
+            if (squares[square] != Piece::None) {
+                h ^= keys[static_cast<size_t>(squares[square]) * 64 + square];
+            }
+        }
+        return h;
+    }
+}
+
+/**
+ * Every position reached in the games imported so far, keyed by Zobrist hash: per position,
+ * the games that reached it and the move played next in each. Looking a position up is one
+ * indexed range read, so "how did this go before" is answered as the board changes. Games
+ * are replayed and written by whoever imports them, on a worker, through write_behind.
+ */
+class PositionIndex {
+public:
+    // One move played from a position, over all the games that played it
+    struct MoveStats {
+        std::string move;
+        int games = 0;
+        int white_wins = 0;
+        int draws = 0;
+        int black_wins = 0;
+    };
+
+    static PositionIndex& instance() {
+        static PositionIndex index {"chess_positions.db"};
+        return index;
+    }
+
+    PositionIndex(const PositionIndex&) = delete;
+    PositionIndex& operator=(const PositionIndex&) = delete;
+
+    bool contains(std::string_view source) {
+        bool found = false;
+        try {
+            db_.for_each_readonly<int64_t>("SELECT 1 FROM chess_game WHERE id = ?", [&found](int64_t) { found = true; }, game_id(source));
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Position index: cannot look up {}: {}", source, e.what());
+        }
+        return found;
+    }
+
+    // Indexes a game (once per source, e.g. its URL); run on a worker
+    void add(const std::string& source, const Game& game) {
+        struct entry {
+            std::uint64_t hash;
+            std::string next;
+        };
+        std::vector<entry> entries;
+        auto const& moves = game.get_moves();
+        entries.reserve(moves.size() + 1);
+        Board board;
+        for (size_t ply = 0; ply <= moves.size(); ++ply) {
+            entries.push_back({zobrist::hash(board, ply % 2 == 0), ply < moves.size() ? moves[ply].algebraic : std::string{}});
+            if (ply < moves.size()) {
+                board.apply_move(moves[ply]);
+            }
+        }
+        writes_.put(std::format("game|{}", source),
+            [this, id = game_id(source), white = game.white_player, black = game.black_player, result = game.result, entries = std::move(entries)](hosting::db::sqlite& db) {
+                db.exec("INSERT OR IGNORE INTO chess_game (id, white, black, result) VALUES (?, ?, ?, ?)", nullptr, id, white, black, result);
+                // A position repeated within a game counts once, with the move first played from it
+                for (auto const& e : entries) {
+                    db.exec("INSERT OR IGNORE INTO chess_position (hash, game, next) VALUES (?, ?, ?)",
+                            nullptr, static_cast<int64_t>(e.hash), id, e.next);
+                }
+                ++generation_;
+            });
+    }
+
+    // Changes whenever indexed games are written, so readers know their statistics are stale
+    std::uint64_t generation() const { return generation_; }
+
+    // The moves played from a position, most played first
+    std::vector<MoveStats> moves_from(const Board& board, bool white_to_move) {
+        std::vector<MoveStats> stats;
+        try {
+            db_.for_each_readonly<std::string_view, std::string_view, int64_t>(
+                "SELECT p.next, g.result, COUNT(*) FROM chess_position p JOIN chess_game g ON g.id = p.game "
+                "WHERE p.hash = ? AND p.next != '' GROUP BY p.next, g.result",
+                [&stats](std::string_view move, std::string_view result, int64_t count) {
+                    auto pos = std::find_if(stats.begin(), stats.end(), [move](const MoveStats& s) { return s.move == move; });
+                    if (pos == stats.end()) {
+                        pos = stats.insert(stats.end(), MoveStats{std::string{move}});
+                    }
+                    auto const n = static_cast<int>(count);
+                    pos->games += n;
+                    if (result == "1-0") {
+                        pos->white_wins += n;
+                    } else if (result == "0-1") {
+                        pos->black_wins += n;
+                    } else if (result == "1/2-1/2") {
+                        pos->draws += n;
+                    }
+                }, static_cast<int64_t>(zobrist::hash(board, white_to_move)));
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Position index: cannot read moves: {}", e.what());
+        }
+        std::sort(stats.begin(), stats.end(), [](const MoveStats& a, const MoveStats& b) { return a.games > b.games; });
+        return stats;
+    }
+
+private:
+    explicit PositionIndex(const std::string& path) : db_{path} {
+        db_.ensure_table("chess_game", "id INTEGER PRIMARY KEY, white TEXT, black TEXT, result TEXT");
+        // Clustered by hash: a position's rows are read in one range
+        db_.exec("CREATE TABLE IF NOT EXISTS chess_position (hash INTEGER, game INTEGER, next TEXT, PRIMARY KEY (hash, game)) WITHOUT ROWID");
+    }
+
+    // A stable id for a game's source (FNV-1a)
+    static int64_t game_id(std::string_view source) {
+        std::uint64_t h = 0xCBF29CE484222325ull;
+        for (char c : source) {
+            h = (h ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+        }
+        return static_cast<int64_t>(h);
+    }
+
+    hosting::db::sqlite db_;
+    std::atomic<std::uint64_t> generation_ {0};
+    hosting::db::write_behind writes_ {db_};
+};
+
+} // namespace rouen::models::chess
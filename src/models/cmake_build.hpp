@@ -0,0 +1,345 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <glaze/json.hpp>
+#include "../helpers/debug.hpp"
+
+namespace rouen::models::cmake {
+    // A compiler or CMake message pointing at a line of a file
+    struct diagnostic {
+        enum class severity { error, warning };
+
+        std::string file;
+        int line {0};
+        int column {0};
+        severity level {severity::error};
+        std::string message;
+    };
+
+    /**
+     * Reads a build's output line by line as it streams: Ninja's "[N/M]" and Makefiles'
+     * "[ NN%]" progress, and GCC/Clang style "file:line[:col]: error|warning: message"
+     * diagnostics (notes are left in the log). Relative paths are taken against the build
+     * directory, where the build runs its compilers.
+     */
+    class build_log {
+    public:
+        explicit build_log(std::filesystem::path build_dir = {}) : build_dir_(std::move(build_dir)) {}
+
+        // What the line turned out to be
+        enum class line_kind { plain, progress, error, warning };
+
+        line_kind feed(std::string_view line) {
+            if (parse_progress(line)) {
+                return line_kind::progress;
+            }
+            if (auto found = parse_diagnostic(line)) {
+                auto const kind = found->level == diagnostic::severity::error ? line_kind::error : line_kind::warning;
+                if (kind == line_kind::error) {
+                    ++errors_;
+                } else {
+                    ++warnings_;
+                }
+                // The same header warning is reported once per file including it
+                auto const same = [&found](diagnostic const &d) {
+                    return d.line == found->line && d.column == found->column && d.file == found->file && d.message == found->message;
+                };
+                if (std::none_of(diagnostics_.begin(), diagnostics_.end(), same)) {
+                    diagnostics_.push_back(std::move(*found));
+                }
+                return kind;
+            }
+            return line_kind::plain;
+        }
+
+        // Steps done and known so far (Makefiles report a percentage: out of 100)
+        [[nodiscard]] size_t done() const { return done_; }
+        [[nodiscard]] size_t total() const { return total_; }
+        [[nodiscard]] size_t errors() const { return errors_; }
+        [[nodiscard]] size_t warnings() const { return warnings_; }
+        [[nodiscard]] std::vector<diagnostic> const &diagnostics() const { return diagnostics_; }
+
+    private:
+        bool parse_progress(std::string_view line) {
+            if (line.size() < 4 || line.front() != '[') {
+                return false;
+            }
+            auto const close = line.find(']');
+            if (close == std::string_view::npos) {
+                return false;
+            }
+            auto inside = line.substr(1, close - 1);
+            while (!inside.empty() && inside.front() == ' ') {
+                inside.remove_prefix(1);
+            }
+            size_t first = 0;
+            auto [rest, ec] = std::from_chars(inside.data(), inside.data() + inside.size(), first);
+            if (ec != std::errc{} || rest == inside.data() + inside.size()) {
+                return false;
+            }
+            if (*rest == '/') {
+                size_t second = 0;
+                auto [end, ec2] = std::from_chars(rest + 1, inside.data() + inside.size(), second);
+                if (ec2 != std::errc{} || end != inside.data() + inside.size() || second == 0) {
+                    return false;
+                }
+                done_ = first;
+                total_ = second;
+                return true;
+            }
+            if (*rest == '%' && rest + 1 == inside.data() + inside.size() && first <= 100) {
+                done_ = first;
+                total_ = 100;
+                return true;
+            }
+            return false;
+        }
+
+        std::optional<diagnostic> parse_diagnostic(std::string_view line) const {
+            diagnostic d;
+            std::string_view marker;
+            size_t at = std::string_view::npos;
+            for (auto const candidate : {std::string_view{": fatal error: "}, std::string_view{": error: "}, std::string_view{": warning: "}}) {
+                if (auto const pos = line.find(candidate); pos != std::string_view::npos && pos < at) {
+                    at = pos;
+                    marker = candidate;
+                }
+            }
+            if (at == std::string_view::npos) {
+                return std::nullopt;
+            }
+            d.level = marker == ": warning: " ? diagnostic::severity::warning : diagnostic::severity::error;
+            d.message = std::string{line.substr(at + marker.size())};
+
+            // file:line[:column] before the marker; the file itself may hold colons
+            auto location = line.substr(0, at);
+            int numbers[2] {0, 0};
+            int count = 0;
+            while (count < 2) {
+                auto const colon = location.rfind(':');
+                if (colon == std::string_view::npos) {
+                    break;
+                }
+                int value = 0;
+                auto const digits = location.substr(colon + 1);
+                auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+                if (digits.empty() || ec != std::errc{} || end != digits.data() + digits.size()) {
+                    break;
+                }
+                numbers[count++] = value;
+                location = location.substr(0, colon);
+            }
+            if (count == 0 || location.empty()) {
+                return std::nullopt;
+            }
+            d.line = count == 2 ? numbers[1] : numbers[0];
+            d.column = count == 2 ? numbers[0] : 0;
+            std::filesystem::path file {location};
+            if (file.is_relative() && !build_dir_.empty()) {
+                file = (build_dir_ / file).lexically_normal();
+            }
+            d.file = file.string();
+            return d;
+        }
+
+        std::filesystem::path build_dir_;
+        size_t done_ {0};
+        size_t total_ {0};
+        size_t errors_ {0};
+        size_t warnings_ {0};
+        std::vector<diagnostic> diagnostics_;
+    };
+
+    // The shapes of the file API replies and compile_commands.json, only the parts read here
+    struct file_ref {
+        std::string kind;
+        std::string jsonFile;
+    };
+
+    struct reply_index {
+        std::map<std::string, file_ref> reply;
+    };
+
+    struct codemodel_project {
+        std::string name;
+    };
+
+    struct codemodel_target {
+        std::string name;
+        std::string jsonFile;
+    };
+
+    struct codemodel_configuration {
+        std::string name;
+        std::vector<codemodel_project> projects;
+        std::vector<codemodel_target> targets;
+    };
+
+    struct codemodel {
+        std::vector<codemodel_configuration> configurations;
+    };
+
+    struct target_artifact {
+        std::string path;
+    };
+
+    struct target_reply {
+        std::string name;
+        std::string type;
+        std::vector<target_artifact> artifacts;
+    };
+
+    struct compile_command {
+        std::string directory;
+        std::string file;
+    };
+
+    struct target {
+        std::string name;
+        std::string type;           // EXECUTABLE, STATIC_LIBRARY, UTILITY, ...
+        std::string artifact;       // relative to the build directory, when it builds one
+    };
+
+    /**
+     * What a configured build directory says about its project: name and version from
+     * CMakeCache.txt, targets from the CMake file API (codemodel-v2) and the translation units
+     * from compile_commands.json. request() leaves the query the next configure answers.
+     */
+    struct project {
+        std::string name;
+        std::string version;
+        std::string configuration;
+        std::vector<target> targets;
+        std::vector<std::string> sources;   // from compile_commands.json
+        bool configured {false};            // there is a CMakeCache.txt
+        bool has_codemodel {false};
+
+        static void request(std::filesystem::path const &build_dir) {
+            std::error_code ec;
+            auto const query = build_dir / ".cmake" / "api" / "v1" / "query";
+            std::filesystem::create_directories(query, ec);
+            if (!ec && !std::filesystem::exists(query / "codemodel-v2", ec)) {
+                std::ofstream{query / "codemodel-v2"};
+            }
+        }
+
+        static project load(std::filesystem::path const &build_dir) {
+            project p;
+            p.read_cache(build_dir / "CMakeCache.txt");
+            p.read_codemodel(build_dir / ".cmake" / "api" / "v1" / "reply");
+            p.read_compile_commands(build_dir / "compile_commands.json");
+            return p;
+        }
+
+    private:
+        static constexpr glz::opts lenient {.error_on_unknown_keys = false};
+
+        static std::optional<std::string> slurp(std::filesystem::path const &path) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                return std::nullopt;
+            }
+            std::ostringstream out;
+            out << file.rdbuf();
+            return std::move(out).str();
+        }
+
+        template <typename T>
+        static bool parse(T &value, std::filesystem::path const &path) {
+            auto const text = slurp(path);
+            if (!text) {
+                return false;
+            }
+            if (auto const error = glz::read<lenient>(value, *text)) {
+                SYS_ERROR_FMT("Cannot read {}: {}", path.string(), glz::format_error(error));
+                return false;
+            }
+            return true;
+        }
+
+        void read_cache(std::filesystem::path const &path) {
+            std::ifstream file(path);
+            if (!file) {
+                return;
+            }
+            configured = true;
+            std::string line;
+            while (std::getline(file, line)) {
+                if (line.starts_with("CMAKE_PROJECT_NAME:STATIC=")) {
+                    name = line.substr(line.find('=') + 1);
+                } else if (line.starts_with("CMAKE_PROJECT_VERSION:STATIC=")) {
+                    version = line.substr(line.find('=') + 1);
+                }
+            }
+        }
+
+        void read_codemodel(std::filesystem::path const &reply_dir) {
+            // The newest index is the last one by name
+            std::error_code ec;
+            std::filesystem::path index_path;
+            for (std::filesystem::directory_iterator pos(reply_dir, ec); !ec && pos != std::filesystem::directory_iterator(); pos.increment(ec)) {
+                auto const file = pos->path().filename().string();
+                if (file.starts_with("index-") && file.ends_with(".json") && pos->path() > index_path) {
+                    index_path = pos->path();
+                }
+            }
+            reply_index index;
+            if (index_path.empty() || !parse(index, index_path)) {
+                return;
+            }
+            auto const ref = index.reply.find("codemodel-v2");
+            codemodel model;
+            if (ref == index.reply.end() || ref->second.jsonFile.empty() || !parse(model, reply_dir / ref->second.jsonFile)
+                || model.configurations.empty()) {
+                return;
+            }
+            has_codemodel = true;
+            auto const &config = model.configurations.front();
+            configuration = config.name;
+            if (name.empty() && !config.projects.empty()) {
+                name = config.projects.front().name;
+            }
+            targets.reserve(config.targets.size());
+            for (auto const &t : config.targets) {
+                target_reply detail;
+                target item {t.name, {}, {}};
+                if (parse(detail, reply_dir / t.jsonFile)) {
+                    item.type = detail.type;
+                    if (!detail.artifacts.empty()) {
+                        item.artifact = detail.artifacts.front().path;
+                    }
+                }
+                targets.push_back(std::move(item));
+            }
+            std::sort(targets.begin(), targets.end(), [](auto const &a, auto const &b) { return a.name < b.name; });
+        }
+
+        void read_compile_commands(std::filesystem::path const &path) {
+            std::vector<compile_command> commands;
+            if (!parse(commands, path)) {
+                return;
+            }
+            sources.reserve(commands.size());
+            for (auto const &command : commands) {
+                std::filesystem::path file {command.file};
+                if (file.is_relative()) {
+                    file = std::filesystem::path{command.directory} / file;
+                }
+                sources.push_back(file.lexically_normal().string());
+            }
+            std::sort(sources.begin(), sources.end());
+            sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+        }
+    };
+}
@@ -1,15 +1,29 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
 #include <filesystem>
 #include <format>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <stop_token>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
+#include "../helpers/command_cache.hpp"
 #include "../helpers/process_helper.hpp"
 #include "../helpers/debug.hpp"
+#include "../helpers/redraw.hpp"
+#include "../helpers/task_scheduler.hpp"
+#include "git_scanner.hpp"
 
 namespace rouen::models {
     // Enum class for git repository statuses
@@ -23,89 +37,128 @@ namespace rouen::models {
         Detached
     };
 
+    // What git status --porcelain=v2 says about a repository, counted per kind of change
+    struct GitStatusCounts {
+        size_t staged {0};          // index differs from HEAD
+        size_t modified {0};        // worktree differs from the index
+        size_t untracked {0};
+        size_t conflicted {0};
+        int ahead {0};              // commits the upstream doesn't have
+        int behind {0};             // and the other way around
+        bool has_upstream {false};
+        bool detached {false};
+        std::string branch;
+
+        // The one status a list dot can show: the most serious kind of change wins
+        GitRepoStatus summary() const {
+            if (conflicted > 0) return GitRepoStatus::Conflict;
+            if (staged > 0) return GitRepoStatus::Staged;
+            if (modified > 0) return GitRepoStatus::Modified;
+            if (untracked > 0) return GitRepoStatus::Untracked;
+            if (detached) return GitRepoStatus::Detached;
+            return GitRepoStatus::Clean;
+        }
+    };
+
+    // One entry of git log
+    struct GitCommit {
+        std::string hash;
+        std::string short_hash;
+        std::string author;
+        std::string date;
+        std::string subject;
+    };
+
+    // A path git status lists, with its porcelain XY letters ('.' for unchanged)
+    struct GitFileChange {
+        std::string path;
+        char index {'.'};           // against HEAD: staged
+        char worktree {'.'};        // against the index: not staged yet
+        bool untracked {false};
+        bool conflicted {false};
+    };
+
+    enum class GitDiffLineKind : uint8_t {
+        Context,
+        Added,
+        Removed,
+        Hunk,       // @@ -a,b +c,d @@
+        Header      // diff --git, index, ---/+++ and the like
+    };
+
+    // A file's diff split into lines and classified for coloring, done where it was loaded
+    struct GitDiff {
+        struct line {
+            uint32_t offset {0};
+            uint32_t length {0};
+            GitDiffLineKind kind {GitDiffLineKind::Context};
+        };
+
+        std::string text;
+        std::vector<line> lines;
+
+        std::string_view line_text(size_t i) const {
+            return std::string_view{text}.substr(lines[i].offset, lines[i].length);
+        }
+    };
+
     struct git {
+        // The repositories found last time show at once; a new scan and their statuses follow
         git() {
+            if (auto indexed = git_index::load(); !indexed.empty()) {
+                setRepositories(*state_, indexed);
+                checkStatuses(state_, std::move(indexed));
+            }
             scanForRepositories();
         }
 
+        ~git() {
+            state_->stop.request_stop();
+        }
+
+        git(git const &) = delete;
+        git &operator=(git const &) = delete;
+
         /**
          * Scan the filesystem for Git repositories
-         * Searches under the user's HOME directory for .git folders
-         * and populates the repos map with the parent directories and their statuses
+         * Runs in the background under the git_scan_rules roots (the user's HOME by default);
+         * when done the list is replaced, saved as the index for the next start, and the
+         * repositories it hadn't seen before get their statuses checked
          */
         void scanForRepositories() {
-            const char* home = std::getenv("HOME");
-            if (home) {
-                try {
-                    std::filesystem::path homeDir(home);
-                    for (const auto& entry : std::filesystem::recursive_directory_iterator(
-                         homeDir, 
-                         std::filesystem::directory_options::skip_permission_denied)) {
-                        if (entry.is_directory() && entry.path().filename() == ".git") {
-                            std::string repo_path = entry.path().parent_path().string();
-                            repos[repo_path] = GitRepoStatus::Unknown; // Set initial status
-                            
-                            // Query the git status immediately
-                            std::string status_output = ProcessHelper::executeCommandInDirectory(repo_path, "git status");
-                            if (!status_output.empty()) {
-                                updateRepoStatus(repo_path, status_output);
-                            }
-                        }
-                    }
-                    
-                    // Create a sorted list of keys for display
-                    repo_paths.clear();
-                    for (const auto& [path, status] : repos) {
-                        repo_paths.push_back(path);
-                    }
-                    std::sort(repo_paths.begin(), repo_paths.end());
-                    
-                } catch (const std::exception& e) {
-                    GIT_ERROR_FMT("Error scanning for repositories: {}", e.what());
-                }
-            } else {
+            auto rules = git_scan_rules::from_env();
+            if (rules.roots.empty()) {
                 GIT_ERROR("Error: HOME environment variable not set");
+                return;
             }
+            state_->scanning = true;
+            git_scan::start(std::move(rules), state_->stop, [s = state_](std::vector<std::string> found) {
+                auto added = setRepositories(*s, found);
+                git_index::save(found);
+                git_index::publish(found);
+                s->scanning = false;
+                checkStatuses(s, std::move(added));
+                rouen::helpers::request_redraw();
+            });
         }
 
         /**
-         * Update the repository status
+         * Update the repository status from git's machine-readable status, which doesn't
+         * depend on the locale; answered from the command cache while nothing changed
          * 
          * @param repo_path Repository path string
-         * @param status_output Optional git status command output (if already available)
          * @return true if successful, false if failed
          */
-        bool updateRepoStatus(const std::string& repo_path, const std::string& status_output = "") {
-            if (repo_path.empty() || repos.find(repo_path) == repos.end()) {
+        bool updateRepoStatus(const std::string& repo_path) {
+            if (repo_path.empty() || !hasRepo(repo_path)) {
                 return false;
             }
             
-            std::string output = status_output;
-            if (output.empty()) {
-                // If no status output provided, get it now
-                output = ProcessHelper::executeCommandInDirectory(repo_path, "git status");
-                if (output.empty()) {
-                    return false;
-                }
-            }
-            
-            // Determine the status based on git status output
-            if (output.find("nothing to commit, working tree clean") != std::string::npos) {
-                repos[repo_path] = GitRepoStatus::Clean;
-            } else if (output.find("Changes to be committed") != std::string::npos) {
-                repos[repo_path] = GitRepoStatus::Staged;
-            } else if (output.find("Untracked files") != std::string::npos) {
-                repos[repo_path] = GitRepoStatus::Untracked;
-            } else if (output.find("modified:") != std::string::npos) {
-                repos[repo_path] = GitRepoStatus::Modified;
-            } else if (output.find("Unmerged paths") != std::string::npos || 
-                    output.find("fix conflicts") != std::string::npos) {
-                repos[repo_path] = GitRepoStatus::Conflict;
-            } else if (output.find("HEAD detached") != std::string::npos) {
-                repos[repo_path] = GitRepoStatus::Detached;
-            } else {
-                repos[repo_path] = GitRepoStatus::Unknown;
+            auto const result = queryStatus(repo_path).get();
+            if (!result.ok()) {
+                return false;
             }
+            setStatus(*state_, repo_path, parseStatus(result.out));
             return true;
         }
 
@@ -116,13 +169,13 @@ namespace rouen::models {
          * @return Status output as string
          */
         std::string getGitStatus(const std::string& repo_path) {
-            if (repo_path.empty() || repos.find(repo_path) == repos.end()) {
+            if (repo_path.empty() || !hasRepo(repo_path)) {
                 return "";
             }
             
-            std::string status = ProcessHelper::executeCommandInDirectory(repo_path, "git status");
+            std::string status = queryGit(repo_path, {"status"}).get().out;
             if (!status.empty()) {
-                updateRepoStatus(repo_path, status);
+                updateRepoStatus(repo_path);
             }
             return status;
         }
@@ -134,7 +187,7 @@ namespace rouen::models {
          * @return true if command was executed
          */
         bool openInVSCode(const std::string& repo_path) {
-            if (repo_path.empty() || repos.find(repo_path) == repos.end()) {
+            if (repo_path.empty() || !hasRepo(repo_path)) {
                 return false;
             }
             
@@ -150,11 +203,11 @@ namespace rouen::models {
          * @return Push output as string
          */
         std::string gitPush(const std::string& repo_path) {
-            if (repo_path.empty() || repos.find(repo_path) == repos.end()) {
+            if (repo_path.empty() || !hasRepo(repo_path)) {
                 return "";
             }
             
-            std::string result = ProcessHelper::executeCommandInDirectory(repo_path, "git push");
+            std::string result = runGit(repo_path, {"push"}).get().out;
             // Update status after push
             if (!result.empty()) {
                 updateRepoStatus(repo_path);
@@ -162,23 +215,43 @@ namespace rouen::models {
             return result;
         }
 
-        // Getters
-        const std::map<std::string, GitRepoStatus>& getRepos() const { 
-            return repos; 
+        // Getters; the scan and the status checks update these from the scheduler, so they copy
+        std::map<std::string, GitRepoStatus> getRepos() const { 
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            return state_->repos; 
+        }
+        
+        std::vector<std::string> getRepoPaths() const { 
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            return state_->repo_paths; 
         }
         
-        const std::vector<std::string>& getRepoPaths() const { 
-            return repo_paths; 
+        bool hasRepo(const std::string& repo_path) const {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            return state_->repos.contains(repo_path);
         }
         
         GitRepoStatus getRepoStatus(const std::string& repo_path) const {
-            auto it = repos.find(repo_path);
-            if (it != repos.end()) {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            auto it = state_->repos.find(repo_path);
+            if (it != state_->repos.end()) {
                 return it->second;
             }
             return GitRepoStatus::Unknown;
         }
         
+        // The counts behind getRepoStatus, as of the last check; all zero before one
+        GitStatusCounts getStatusCounts(const std::string& repo_path) const {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            auto it = state_->counts.find(repo_path);
+            return it != state_->counts.end() ? it->second : GitStatusCounts{};
+        }
+        
+        // A scan is still going; the list may grow or shrink when it ends
+        bool isScanning() const {
+            return state_->scanning.load(std::memory_order_relaxed);
+        }
+        
         /**
          * Check if the current branch is ahead of its remote tracking branch
          * 
@@ -186,24 +259,317 @@ namespace rouen::models {
          * @return true if branch is ahead, false otherwise
          */
         bool isBranchAhead(const std::string& repo_path) {
-            if (repo_path.empty() || repos.find(repo_path) == repos.end()) {
-                return false;
-            }
-            
-            // Get git status with porcelain format for easier parsing
-            std::string status = ProcessHelper::executeCommandInDirectory(repo_path, "git status -sb");
-            if (status.empty()) {
+            if (repo_path.empty() || !hasRepo(repo_path)) {
                 return false;
             }
             
-            // Look for "[ahead" in the first line, which indicates branch is ahead
-            size_t newline = status.find('\n');
-            std::string firstLine = newline != std::string::npos ? status.substr(0, newline) : status;
-            return firstLine.find("[ahead") != std::string::npos;
+            auto const result = queryStatus(repo_path).get();
+            return result.ok() && parseStatus(result.out).ahead > 0;
+        }
+
+        /**
+         * History, loaded a page at a time so long ones show at once. on_done gets the page
+         * (fewer than count commits once the history runs out) on a scheduler worker
+         */
+        void loadCommits(const std::string& repo_path, size_t skip, size_t count,
+                         std::function<void(std::vector<GitCommit>)> on_done, std::stop_source stop = {}) {
+            rouen::helpers::scheduler()->submit([repo_path, skip, count, on_done = std::move(on_done)](std::stop_token stoken) {
+                // Fields split by \x1f, commits by \x1e: neither shows up in names or subjects
+                auto const result = queryGit(repo_path, {"log", "--date=short", std::format("--skip={}", skip),
+                    std::format("--max-count={}", count), "--format=%H%x1f%h%x1f%an%x1f%ad%x1f%s%x1e"}).get();
+                if (stoken.stop_requested()) {
+                    return;
+                }
+                std::vector<GitCommit> commits;
+                std::string_view rest {result.out};
+                while (!rest.empty()) {
+                    auto const end = rest.find('\x1e');
+                    auto record = rest.substr(0, end);
+                    rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+                    while (!record.empty() && record.front() == '\n') {
+                        record.remove_prefix(1);
+                    }
+                    if (record.empty()) {
+                        continue;
+                    }
+                    std::array<std::string_view, 5> fields;
+                    for (auto& field : fields) {
+                        auto const sep = record.find('\x1f');
+                        field = record.substr(0, sep);
+                        record.remove_prefix(sep == std::string_view::npos ? record.size() : sep + 1);
+                    }
+                    commits.push_back({std::string(fields[0]), std::string(fields[1]), std::string(fields[2]),
+                                       std::string(fields[3]), std::string(fields[4])});
+                }
+                on_done(std::move(commits));
+                rouen::helpers::request_redraw();
+            }, rouen::helpers::task_priority::high, std::move(stop));
+        }
+
+        // git status as the user reads it; the counts are refreshed from the same check
+        void loadStatusText(const std::string& repo_path, std::function<void(std::string)> on_done,
+                            std::stop_source stop = {}) {
+            rouen::helpers::scheduler()->submit([s = state_, repo_path, on_done = std::move(on_done)](std::stop_token stoken) {
+                auto text = queryGit(repo_path, {"status"}).get().out;
+                if (auto const result = queryStatus(repo_path).get(); result.ok()) {
+                    setStatus(*s, repo_path, parseStatus(result.out));
+                }
+                if (!stoken.stop_requested()) {
+                    on_done(std::move(text));
+                    rouen::helpers::request_redraw();
+                }
+            }, rouen::helpers::task_priority::high, std::move(stop));
+        }
+
+        // The paths with changes, from the same status the counts come from
+        void loadChanges(const std::string& repo_path, std::function<void(std::vector<GitFileChange>)> on_done,
+                         std::stop_source stop = {}) {
+            rouen::helpers::scheduler()->submit([repo_path, on_done = std::move(on_done)](std::stop_token stoken) {
+                auto const result = queryStatus(repo_path).get();
+                if (!stoken.stop_requested()) {
+                    on_done(parseChanges(result.out));
+                    rouen::helpers::request_redraw();
+                }
+            }, rouen::helpers::task_priority::high, std::move(stop));
+        }
+
+        // One file's diff, staged part first, classified on the worker that loaded it
+        void loadDiff(const std::string& repo_path, GitFileChange const& change,
+                      std::function<void(std::shared_ptr<GitDiff const>)> on_done, std::stop_source stop = {}) {
+            rouen::helpers::scheduler()->submit([repo_path, change, on_done = std::move(on_done)](std::stop_token stoken) {
+                auto diff = std::make_shared<GitDiff>();
+                if (change.untracked) {
+                    // Exits 1 when there is a difference, which there always is
+                    diff->text = queryGit(repo_path, {"diff", "--no-index", "--", "/dev/null", change.path}).get().out;
+                } else {
+                    if (change.index != '.') {
+                        diff->text = queryGit(repo_path, {"diff", "--cached", "--", change.path}).get().out;
+                    }
+                    if (change.worktree != '.' && !stoken.stop_requested()) {
+                        diff->text += queryGit(repo_path, {"diff", "--", change.path}).get().out;
+                    }
+                }
+                if (stoken.stop_requested()) {
+                    return;
+                }
+                classifyDiff(*diff);
+                on_done(std::move(diff));
+                rouen::helpers::request_redraw();
+            }, rouen::helpers::task_priority::high, std::move(stop));
         }
 
     private:
-        std::map<std::string, GitRepoStatus> repos;
-        std::vector<std::string> repo_paths; // For maintaining sorted order
+        // Shared with the scan and status tasks, which may outlive the model
+        struct state {
+            mutable std::mutex mutex;       // guards repos, counts and repo_paths
+            std::map<std::string, GitRepoStatus> repos;
+            std::map<std::string, GitStatusCounts> counts;
+            std::vector<std::string> repo_paths; // For maintaining sorted order
+            std::atomic<bool> scanning {false};
+            std::stop_source stop;
+        };
+
+        // git status --porcelain=v2 -z --branch: NUL-terminated records, "# branch.*" headers
+        // first, then one record per changed path ("2" records carry the old path in one more)
+        static GitStatusCounts parseStatus(std::string_view output) {
+            GitStatusCounts counts;
+            while (!output.empty()) {
+                auto const end = output.find('\0');
+                auto const record = output.substr(0, end);
+                output.remove_prefix(end == std::string_view::npos ? output.size() : end + 1);
+                if (record.size() < 2) {
+                    continue;
+                }
+                switch (record[0]) {
+                case '#':
+                    if (record.starts_with("# branch.head ")) {
+                        counts.branch = record.substr(14);
+                        counts.detached = counts.branch == "(detached)";
+                    } else if (record.starts_with("# branch.upstream ")) {
+                        counts.has_upstream = true;
+                    } else if (record.starts_with("# branch.ab ")) {
+                        // "# branch.ab +<ahead> -<behind>"
+                        std::sscanf(std::string(record.substr(12)).c_str(), "+%d -%d", &counts.ahead, &counts.behind);
+                    }
+                    break;
+                case '1':
+                case '2':
+                    // "<type> <XY> ...": X is the index against HEAD, Y the worktree against the index
+                    if (record.size() >= 4) {
+                        counts.staged += record[2] != '.';
+                        counts.modified += record[3] != '.';
+                    }
+                    if (record[0] == '2') {
+                        auto const orig_end = output.find('\0');
+                        output.remove_prefix(orig_end == std::string_view::npos ? output.size() : orig_end + 1);
+                    }
+                    break;
+                case 'u':
+                    ++counts.conflicted;
+                    break;
+                case '?':
+                    ++counts.untracked;
+                    break;
+                default:
+                    break;      // "!" ignored files, not asked for
+                }
+            }
+            return counts;
+        }
+
+        static std::vector<GitFileChange> parseChanges(std::string_view output) {
+            std::vector<GitFileChange> changes;
+            auto next = [&output]() {
+                auto const end = output.find('\0');
+                auto const record = output.substr(0, end);
+                output.remove_prefix(end == std::string_view::npos ? output.size() : end + 1);
+                return record;
+            };
+            // The path is the last field: after 8 spaces in "1" records, 9 in "2", 10 in "u"
+            auto path_after = [](std::string_view record, int spaces) {
+                size_t at = 0;
+                for (int i = 0; i < spaces && at != std::string_view::npos; ++i) {
+                    at = record.find(' ', at == 0 ? 0 : at + 1);
+                }
+                return at == std::string_view::npos ? std::string_view{} : record.substr(at + 1);
+            };
+            while (!output.empty()) {
+                auto const record = next();
+                if (record.size() < 3) {
+                    continue;
+                }
+                GitFileChange change;
+                switch (record[0]) {
+                case '1':
+                case '2':
+                    change.index = record[2];
+                    change.worktree = record.size() > 3 ? record[3] : '.';
+                    change.path = path_after(record, record[0] == '1' ? 8 : 9);
+                    if (record[0] == '2') {
+                        next();     // the path it was renamed or copied from
+                    }
+                    break;
+                case 'u':
+                    change.index = record[2];
+                    change.worktree = record.size() > 3 ? record[3] : '.';
+                    change.conflicted = true;
+                    change.path = path_after(record, 10);
+                    break;
+                case '?':
+                    change.untracked = true;
+                    change.path = record.substr(2);
+                    break;
+                default:
+                    continue;
+                }
+                if (!change.path.empty()) {
+                    changes.push_back(std::move(change));
+                }
+            }
+            return changes;
+        }
+
+        static void classifyDiff(GitDiff& diff) {
+            std::string_view const text {diff.text};
+            bool in_hunk = false;
+            for (size_t start = 0; start < text.size();) {
+                auto end = text.find('\n', start);
+                if (end == std::string_view::npos) {
+                    end = text.size();
+                }
+                auto const line = text.substr(start, end - start);
+                auto kind = GitDiffLineKind::Context;
+                if (line.starts_with("diff ")) {
+                    in_hunk = false;
+                    kind = GitDiffLineKind::Header;
+                } else if (line.starts_with("@@")) {
+                    in_hunk = true;
+                    kind = GitDiffLineKind::Hunk;
+                } else if (!in_hunk) {
+                    kind = GitDiffLineKind::Header;
+                } else if (line.starts_with('+')) {
+                    kind = GitDiffLineKind::Added;
+                } else if (line.starts_with('-')) {
+                    kind = GitDiffLineKind::Removed;
+                }
+                diff.lines.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(line.size()), kind});
+                start = end + 1;
+            }
+        }
+
+        static void setStatus(state& s, const std::string& repo_path, GitStatusCounts counts) {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (auto it = s.repos.find(repo_path); it != s.repos.end()) {
+                it->second = counts.summary();
+                s.counts.insert_or_assign(repo_path, std::move(counts));
+            }
+        }
+
+        // Replaces the list, keeping the statuses already known; returns the paths that are new
+        static std::vector<std::string> setRepositories(state& s, std::vector<std::string> const& paths) {
+            std::map<std::string, GitRepoStatus> repos;
+            std::vector<std::string> added;
+            std::lock_guard<std::mutex> lock(s.mutex);
+            for (auto const& path : paths) {
+                auto known = s.repos.find(path);
+                if (known == s.repos.end()) {
+                    added.push_back(path);
+                }
+                repos.emplace(path, known != s.repos.end() ? known->second : GitRepoStatus::Unknown);
+            }
+            s.repos = std::move(repos);
+            std::erase_if(s.counts, [&s](auto const& entry) { return !s.repos.contains(entry.first); });
+            s.repo_paths.clear();
+            for (auto const& [path, status] : s.repos) {
+                s.repo_paths.push_back(path);
+            }
+            return added;
+        }
+
+        // git status for each, after the list is up: all started at once (the process runner
+        // bounds how many run), collected on a background worker
+        static void checkStatuses(std::shared_ptr<state> const& s, std::vector<std::string> paths) {
+            if (paths.empty()) {
+                return;
+            }
+            rouen::helpers::scheduler()->submit([s, paths = std::move(paths)](std::stop_token stoken) {
+                std::vector<std::shared_future<ProcessHelper::ProcessResult>> statuses;
+                statuses.reserve(paths.size());
+                for (auto const& path : paths) {
+                    statuses.push_back(queryStatus(path));
+                }
+                for (size_t i = 0; i < paths.size() && !stoken.stop_requested(); ++i) {
+                    if (auto const& result = statuses[i].get(); result.ok()) {
+                        setStatus(*s, paths[i], parseStatus(result.out));
+                        rouen::helpers::request_redraw();
+                    }
+                }
+            }, rouen::helpers::task_priority::background, s->stop);
+        }
+
+        // git with the arguments, run in the repository without a shell
+        static std::shared_future<ProcessHelper::ProcessResult> runGit(const std::string& repo_path, std::vector<std::string> args) {
+            args.insert(args.begin(), "git");
+            ProcessHelper::ProcessOptions options;
+            options.cwd = repo_path;
+            return ProcessHelper::runAsync(std::move(args), std::move(options));
+        }
+
+        // A read-only git command, answered from the command cache until the repository changes
+        static std::shared_future<ProcessHelper::ProcessResult> queryGit(const std::string& repo_path, std::vector<std::string> args) {
+            args.insert(args.begin(), "git");
+            ProcessHelper::ProcessOptions options;
+            options.cwd = repo_path;
+            options.env = {{"GIT_OPTIONAL_LOCKS", "0"}};
+            return ProcessHelper::CommandCache::instance().run(std::move(args), std::move(options),
+                ProcessHelper::CommandCache::gitWatches(repo_path));
+        }
+
+        // The status the model works from; the one shown to the user is plain git status
+        static std::shared_future<ProcessHelper::ProcessResult> queryStatus(const std::string& repo_path) {
+            return queryGit(repo_path, {"status", "--porcelain=v2", "-z", "--branch"});
+        }
+
+        std::shared_ptr<state> state_ {std::make_shared<state>()};
     };
 }
\ No newline at end of file
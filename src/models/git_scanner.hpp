@@ -0,0 +1,244 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "../helpers/debug.hpp"
+#include "../helpers/launcher_index.hpp"
+#include "../helpers/task_scheduler.hpp"
+
+namespace rouen::models {
+    /**
+     * What the repository scan looks at: the roots (ROUEN_GIT_SCAN_ROOTS, colon separated,
+     * $HOME by default), how deep it goes below them (ROUEN_GIT_SCAN_DEPTH, 8) and which
+     * directories it never enters: dependency and build trees by name, plus whatever
+     * ROUEN_GIT_SCAN_IGNORE lists (colon separated; names, or absolute paths).
+     */
+    struct git_scan_rules {
+        std::vector<std::string> roots;
+        size_t max_depth {8};
+        std::unordered_set<std::string> ignored_names {
+            "node_modules", "bower_components", "vendor", "build", "builds", "dist", "out", "target",
+            "_deps", "__pycache__", ".venv", "venv", ".tox", ".mypy_cache", ".pytest_cache",
+            ".cache", ".npm", ".yarn", ".pnpm-store", ".cargo", ".rustup", ".gradle", ".m2",
+            ".nuget", ".conan", ".conan2", ".vcpkg", ".vscode-server", ".local", ".var", "snap",
+            ".Trash", "Library", ".git"
+        };
+        std::vector<std::string> ignored_paths;
+
+        static git_scan_rules from_env() {
+            git_scan_rules rules;
+            if (auto const roots = std::getenv("ROUEN_GIT_SCAN_ROOTS")) {
+                rules.roots = split(roots);
+            } else if (auto const home = std::getenv("HOME")) {
+                rules.roots.emplace_back(home);
+            }
+            if (auto const depth = std::getenv("ROUEN_GIT_SCAN_DEPTH")) {
+                if (auto const value = std::strtoul(depth, nullptr, 10); value > 0) {
+                    rules.max_depth = value;
+                }
+            }
+            if (auto const ignore = std::getenv("ROUEN_GIT_SCAN_IGNORE")) {
+                for (auto &item : split(ignore)) {
+                    if (item.starts_with('/')) {
+                        rules.ignored_paths.push_back(std::move(item));
+                    } else {
+                        rules.ignored_names.insert(std::move(item));
+                    }
+                }
+            }
+            return rules;
+        }
+
+        [[nodiscard]] bool ignored(std::filesystem::path const &dir) const {
+            auto const name = dir.filename().string();
+            if (ignored_names.contains(name) || name.starts_with("cmake-build-")) {
+                return true;
+            }
+            return !ignored_paths.empty()
+                && std::find(ignored_paths.begin(), ignored_paths.end(), dir.string()) != ignored_paths.end();
+        }
+
+    private:
+        static std::vector<std::string> split(std::string_view list) {
+            std::vector<std::string> items;
+            while (!list.empty()) {
+                auto const colon = list.find(':');
+                if (auto const item = list.substr(0, colon); !item.empty()) {
+                    items.emplace_back(item);
+                }
+                list.remove_prefix(colon == std::string_view::npos ? list.size() : colon + 1);
+            }
+            return items;
+        }
+    };
+
+    /**
+     * Finds git repositories below the roots, one background scheduler task per directory so
+     * the traversal spreads over every worker. Symlinks aren't followed, .git directories aren't
+     * entered, and neither is a directory holding a CMakeCache.txt (a build tree, whatever its
+     * name). on_done gets the repositories, sorted, on whichever worker finished last; a stop
+     * drops the scan without calling it.
+     */
+    class git_scan : public std::enable_shared_from_this<git_scan> {
+    public:
+        using done_fn = std::function<void(std::vector<std::string>)>;
+
+        static void start(git_scan_rules rules, std::stop_source stop, done_fn on_done) {
+            auto scan = std::shared_ptr<git_scan>(new git_scan(std::move(rules), std::move(stop), std::move(on_done)));
+            // Held until every root is queued, so a fast first root can't finish the scan early
+            scan->pending_.fetch_add(1, std::memory_order_relaxed);
+            for (auto const &root : scan->rules_.roots) {
+                scan->visit(root, 0);
+            }
+            scan->finish_one();
+        }
+
+    private:
+        git_scan(git_scan_rules rules, std::stop_source stop, done_fn on_done)
+            : rules_(std::move(rules)), stop_(std::move(stop)), on_done_(std::move(on_done)),
+              scheduler_(rouen::helpers::scheduler()) {}
+
+        void visit(std::filesystem::path dir, size_t depth) {
+            pending_.fetch_add(1, std::memory_order_relaxed);
+            scheduler_->submit([self = shared_from_this(), dir = std::move(dir), depth](std::stop_token stoken) {
+                if (!stoken.stop_requested()) {
+                    self->scan_directory(dir, depth);
+                }
+                self->finish_one();
+            }, rouen::helpers::task_priority::background, stop_);
+        }
+
+        void scan_directory(std::filesystem::path const &dir, size_t depth) {
+            std::error_code ec;
+            std::filesystem::directory_iterator pos(dir, std::filesystem::directory_options::skip_permission_denied, ec);
+            std::vector<std::filesystem::path> subdirs;
+            bool is_repo = false;
+            bool build_tree = false;
+            for (; !ec && pos != std::filesystem::directory_iterator(); pos.increment(ec)) {
+                auto const name = pos->path().filename();
+                if (name == ".git") {
+                    is_repo = true;     // a directory, or a file for worktrees and submodules
+                    continue;
+                }
+                if (name == "CMakeCache.txt") {
+                    build_tree = true;
+                    continue;
+                }
+                // The type comes from the directory listing itself; no stat per entry
+                std::error_code type_ec;
+                if (pos->is_symlink(type_ec) || !pos->is_directory(type_ec)) {
+                    continue;
+                }
+                if (depth < rules_.max_depth && !rules_.ignored(pos->path())) {
+                    subdirs.push_back(pos->path());
+                }
+            }
+            if (is_repo) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                found_.push_back(dir.string());
+            }
+            if (build_tree) {
+                return;
+            }
+            for (auto &subdir : subdirs) {
+                visit(std::move(subdir), depth + 1);
+            }
+        }
+
+        void finish_one() {
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) != 1 || stop_.stop_requested()) {
+                return;
+            }
+            std::vector<std::string> found;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                found.swap(found_);
+            }
+            std::sort(found.begin(), found.end());
+            found.erase(std::unique(found.begin(), found.end()), found.end());
+            GIT_INFO_FMT("Repository scan found {} repositories", found.size());
+            on_done_(std::move(found));
+        }
+
+        git_scan_rules const rules_;
+        std::stop_source stop_;
+        done_fn on_done_;
+        std::shared_ptr<rouen::helpers::task_scheduler> scheduler_;
+        std::atomic<size_t> pending_ {0};
+        std::mutex mutex_;
+        std::vector<std::string> found_;
+    };
+
+    // The repositories the last scan found, one path per line; read at startup so the list
+    // shows before a new scan is done. ROUEN_GIT_INDEX moves it from cache/git_repos.txt
+    struct git_index {
+        static std::filesystem::path path() {
+            if (auto const file = std::getenv("ROUEN_GIT_INDEX")) {
+                return file;
+            }
+            return std::filesystem::path{"cache"} / "git_repos.txt";
+        }
+
+        static std::vector<std::string> load() {
+            std::vector<std::string> repos;
+            std::ifstream file(path());
+            for (std::string line; std::getline(file, line);) {
+                if (!line.empty()) {
+                    repos.push_back(std::move(line));
+                }
+            }
+            return repos;
+        }
+
+        // Written aside and renamed over, so a crash mid-write leaves the old index
+        static void save(std::vector<std::string> const &repos) {
+            auto const target = path();
+            auto const temp = std::filesystem::path{target.string() + ".tmp"};
+            std::error_code ec;
+            if (target.has_parent_path()) {
+                std::filesystem::create_directories(target.parent_path(), ec);
+            }
+            {
+                std::ofstream file(temp, std::ios::trunc);
+                if (!file) {
+                    GIT_ERROR_FMT("Could not write repository index {}", temp.string());
+                    return;
+                }
+                for (auto const &repo : repos) {
+                    file << repo << '\n';
+                }
+            }
+            std::filesystem::rename(temp, target, ec);
+            if (ec) {
+                GIT_ERROR_FMT("Could not replace repository index {}: {}", target.string(), ec.message());
+            }
+        }
+
+        // The repositories as the launcher's "repos", each opening as a directory card
+        static void publish(std::vector<std::string> const &repos) {
+            auto launcher = rouen::helpers::launcher_index::shared();
+            if (!launcher) {
+                return;
+            }
+            std::vector<rouen::helpers::launch_target> targets;
+            targets.reserve(repos.size());
+            for (auto const &repo : repos) {
+                targets.push_back({std::filesystem::path{repo}.filename().string(), "dir:" + repo});
+            }
+            launcher->publish("repos", std::move(targets));
+        }
+    };
+}
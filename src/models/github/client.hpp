@@ -0,0 +1,133 @@
+#pragma once
+
+#include <charconv>
+#include <format>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <glaze/json.hpp>
+#include "../../helpers/fetch.hpp"
+#include "login_host.hpp"
+
+namespace rouen::models::github {
+    /**
+     * GitHub REST calls through the shared HTTP engine. Every GET is conditional: the
+     * response_cache keeps each page on disk with its ETag and sends If-None-Match, and
+     * GitHub's 304s don't count against the rate limit. A listing is read whole: the first
+     * page's Link header names the last page, and the pages in between are asked for at once
+     * (the engine's per-host limit keeps that polite) rather than one after another.
+     */
+    class client {
+    public:
+        static constexpr int page_size = 100;
+
+        explicit client(std::shared_ptr<login_host> login) : login_(std::move(login)) {}
+
+        glz::json_t get(std::string const &url) const {
+            return parse(submit(url).get().body);
+        }
+
+        // A GraphQL query (its JSON body); the response, errors included, once it arrives
+        std::future<http::response> graphql(std::string body) const {
+            return submit("https://api.github.com/graphql", std::move(body));
+        }
+
+        // Every item of a paginated listing, in order; what was read before a failure otherwise
+        glz::json_t::array_t get_all(std::string const &url) const {
+            glz::json_t::array_t items;
+            auto const first = submit(page_url(url, 1)).get();
+            if (!first.ok() || !append(items, first.body)) {
+                return items;
+            }
+            if (auto const last = last_page(first.link); last > 1) {
+                std::vector<std::future<http::response>> pages;
+                pages.reserve(last - 1);
+                for (int page = 2; page <= last; ++page) {
+                    pages.push_back(submit(page_url(url, page)));
+                }
+                for (auto &page : pages) {
+                    auto const r = page.get();
+                    if (!r.ok() || !append(items, r.body)) {
+                        break;
+                    }
+                }
+                return items;
+            }
+            // No Link (a body served from the cache without asking): page while pages are full
+            for (int page = 2, size = static_cast<int>(items.size()); size == page_size * (page - 1); ++page) {
+                auto const r = submit(page_url(url, page)).get();
+                if (!r.ok() || !append(items, r.body)) {
+                    break;
+                }
+                size = static_cast<int>(items.size());
+            }
+            return items;
+        }
+
+    private:
+        // A GET (through the cache), or a POST of `body`
+        std::future<http::response> submit(std::string const &url, std::optional<std::string> body = {}) const {
+            auto request = http::fetch{}.make_request(url, {
+                std::format("Authorization: Bearer {}", login_->personal_token()),
+                "Accept: application/vnd.github+json"
+            });
+            request.cached = !body;
+            request.body = std::move(body);
+            auto promise = std::make_shared<std::promise<http::response>>();
+            auto result = promise->get_future();
+            http::engine::instance().submit(std::move(request), [promise](http::response r) {
+                promise->set_value(std::move(r));
+            });
+            return result;
+        }
+
+        static std::string page_url(std::string const &url, int page) {
+            return std::format("{}{}per_page={}&page={}", url, url.find('?') == std::string::npos ? '?' : '&', page_size, page);
+        }
+
+        // The page number of rel="last" in a Link header, 0 if there is none
+        static int last_page(std::string_view link) {
+            auto const rel = link.find("rel=\"last\"");
+            if (rel == std::string_view::npos) {
+                return 0;
+            }
+            auto const target = link.substr(0, rel);
+            auto const open = target.rfind('<');
+            auto const page = target.find("page=", open == std::string_view::npos ? 0 : open);
+            // "per_page=" ends in "page=" too: take the one not preceded by '_'
+            for (auto at = page; at != std::string_view::npos; at = target.find("page=", at + 1)) {
+                if (at > 0 && target[at - 1] == '_') {
+                    continue;
+                }
+                int last = 0;
+                std::from_chars(target.data() + at + 5, target.data() + target.size(), last);
+                return last;
+            }
+            return 0;
+        }
+
+        static glz::json_t parse(std::string const &body) {
+            glz::json_t result;
+            if (glz::read_json(result, body)) {
+                return glz::json_t{};
+            }
+            return result;
+        }
+
+        static bool append(glz::json_t::array_t &items, std::string const &body) {
+            auto page = parse(body);
+            if (!page.is_array()) {
+                return false;
+            }
+            auto &array = page.get_array();
+            items.insert(items.end(), std::make_move_iterator(array.begin()), std::make_move_iterator(array.end()));
+            return true;
+        }
+
+        std::shared_ptr<login_host> login_;
+    };
+}
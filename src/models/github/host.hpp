@@ -1,15 +1,20 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <format>
 #include <future>
 #include <mutex>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <glaze/json.hpp>
 #include "../../helpers/platform_utils.hpp"
 #include "../../helpers/fetch.hpp"
+#include "client.hpp"
 #include "login_host.hpp"
+#include "repo_summary.hpp"
 #include "../../registrar.hpp"
 
 namespace rouen::models::github {
@@ -17,6 +22,7 @@ namespace rouen::models::github {
         // Renamed from login_host to set_login_host to avoid conflict with type name
         void set_login_host(std::shared_ptr<login_host> host) {
             login_host_ = host;
+            client_ = std::make_shared<client>(host);
         }
 
         glz::json_t const& user() const {
@@ -27,7 +33,7 @@ namespace rouen::models::github {
         }
 
         glz::json_t organizations() const {
-            return fetch("https://api.github.com/user/orgs");
+            return client_->get_all("https://api.github.com/user/orgs");
         }
 
         glz::json_t fetch_user() const {
@@ -35,11 +41,11 @@ namespace rouen::models::github {
         }
 
         glz::json_t org_repos(std::string_view org) const {
-            return fetch(std::format("https://api.github.com/orgs/{}/repos", org));
+            return client_->get_all(std::format("https://api.github.com/orgs/{}/repos", org));
         }
 
         glz::json_t user_repos() const {
-            return fetch_all("https://api.github.com/user/repos");
+            return client_->get_all("https://api.github.com/user/repos");
         }
 
         glz::json_t find_repo(std::string_view full_name) const {
@@ -56,47 +62,29 @@ namespace rouen::models::github {
             return fetch(url_str + "/runs");
         }
 
-        // Updated to match the type used in the fetch.hpp implementation
-        auto header_client() const {
-            // Fix: store the bearer header in a variable before capturing it
-            std::string bearer = std::format("Authorization: Bearer {}", login_host_->personal_token());
-            return [bearer](auto setheader) {
-                setheader(bearer);
-            };
-        }
-
-        std::string fetch_string(const std::string &url) const {
-            http::fetch fetch;
-            auto const source { fetch(url, header_client()) };
-            return source;
-        }
-
-        glz::json_t fetch(const std::string &url) const {
-            std::string json_str = fetch_string(url);
-            glz::json_t result;
-            auto ec = glz::read_json(result, json_str);
-            if (ec) {
-                // Handle error - return empty json object on error
-                return glz::json_t{};
+        // Summaries of `full_names`, a GraphQL query per batch, the batches in flight together
+        std::vector<repo_summary> repo_summaries(std::vector<std::string> const &full_names) const {
+            std::vector<std::future<http::response>> batches;
+            for (size_t start = 0; start < full_names.size(); start += summary_query::batch_size) {
+                auto const names = std::span{full_names}.subspan(start, std::min(summary_query::batch_size, full_names.size() - start));
+                batches.push_back(client_->graphql(summary_query::body(names)));
             }
-            return result;
-        }
-
-        glz::json_t fetch_all(const std::string &url) const {
-            static auto constexpr page_size {100};
-            glz::json_t::array_t result;
-            for (int page = 1; ; ++page) {
-                auto source = fetch(std::format("{}?per_page={}&page={}", url, page_size, page));
-                if (source.empty()) {
-                    break;
-                }
-                auto& source_array = source.get_array();
-                result.insert(result.end(), source_array.begin(), source_array.end());
-                if (source_array.size() < page_size) {
-                    break;
+            std::vector<repo_summary> summaries;
+            for (size_t batch = 0; batch < batches.size(); ++batch) {
+                auto const r = batches[batch].get();
+                if (!r.ok()) {
+                    throw std::runtime_error(std::format("GitHub GraphQL request failed: {}", r.error));
                 }
+                auto const start = batch * summary_query::batch_size;
+                auto const names = std::span{full_names}.subspan(start, std::min(summary_query::batch_size, full_names.size() - start));
+                auto found = summary_query::parse(r.body, names);
+                summaries.insert(summaries.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
             }
-            return result;
+            return summaries;
+        }
+
+        glz::json_t fetch(const std::string &url) const {
+            return client_->get(url);
         }
 
         void open_url(const std::string &url) const {
@@ -106,6 +94,7 @@ namespace rouen::models::github {
         
     private:
         std::shared_ptr<login_host> login_host_;
+        std::shared_ptr<client> client_;
         mutable glz::json_t user_;
     };
 }
\ No newline at end of file
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include <glaze/json.hpp>
+
+namespace rouen::models::github {
+    // What an overview shows of a repository
+    struct repo_summary {
+        std::string full_name;
+        int stars {0};
+        int open_prs {0};
+        int open_issues {0};
+        std::string last_commit_date;
+        std::string last_commit;
+        std::string ci_state;       // the default branch head's checks: SUCCESS, FAILURE, PENDING, ... or empty
+    };
+
+    /**
+     * Summaries of many repositories from one GraphQL query: each repository is an aliased
+     * field (r0, r1, ...) selecting the same fragment, so a batch of them costs one request
+     * instead of four REST calls apiece.
+     */
+    namespace summary_query {
+        // How many repositories one query asks for; well under GraphQL's node limits
+        inline constexpr size_t batch_size = 25;
+
+        namespace wire {
+            struct count {
+                int totalCount {0};
+
+                struct glaze {
+                    using T = count;
+                    static constexpr auto value = glz::object("totalCount", &T::totalCount);
+                };
+            };
+
+            struct rollup {
+                std::string state;
+
+                struct glaze {
+                    using T = rollup;
+                    static constexpr auto value = glz::object("state", &T::state);
+                };
+            };
+
+            struct commit {
+                std::string committedDate;
+                std::string messageHeadline;
+                std::optional<rollup> statusCheckRollup;
+
+                struct glaze {
+                    using T = commit;
+                    static constexpr auto value = glz::object(
+                        "committedDate", &T::committedDate,
+                        "messageHeadline", &T::messageHeadline,
+                        "statusCheckRollup", &T::statusCheckRollup
+                    );
+                };
+            };
+
+            struct branch {
+                std::optional<commit> target;
+
+                struct glaze {
+                    using T = branch;
+                    static constexpr auto value = glz::object("target", &T::target);
+                };
+            };
+
+            struct repository {
+                std::string nameWithOwner;
+                int stargazerCount {0};
+                count pullRequests;
+                count issues;
+                std::optional<branch> defaultBranchRef;
+
+                struct glaze {
+                    using T = repository;
+                    static constexpr auto value = glz::object(
+                        "nameWithOwner", &T::nameWithOwner,
+                        "stargazerCount", &T::stargazerCount,
+                        "pullRequests", &T::pullRequests,
+                        "issues", &T::issues,
+                        "defaultBranchRef", &T::defaultBranchRef
+                    );
+                };
+            };
+
+            struct reply {
+                std::optional<std::map<std::string, std::optional<repository>>> data;
+
+                struct glaze {
+                    using T = reply;
+                    static constexpr auto value = glz::object("data", &T::data);
+                };
+            };
+
+            struct request {
+                std::string query;
+
+                struct glaze {
+                    using T = request;
+                    static constexpr auto value = glz::object("query", &T::query);
+                };
+            };
+        }
+
+        inline std::string alias(size_t index) {
+            return "r" + std::to_string(index);
+        }
+
+        // The JSON body of a query for `names` ("owner/repo"); names without an owner are skipped
+        inline std::string body(std::span<std::string const> names) {
+            std::string query = "query {";
+            for (size_t i = 0; i < names.size(); ++i) {
+                auto const slash = names[i].find('/');
+                if (slash == std::string::npos) {
+                    continue;
+                }
+                // JSON string literals are valid GraphQL ones
+                std::string owner, name;
+                (void)glz::write_json(names[i].substr(0, slash), owner);
+                (void)glz::write_json(names[i].substr(slash + 1), name);
+                query += " " + alias(i) + ": repository(owner: " + owner + ", name: " + name + ") { ...summary }";
+            }
+            query += " }"
+                " fragment summary on Repository {"
+                " nameWithOwner stargazerCount"
+                " pullRequests(states: OPEN) { totalCount }"
+                " issues(states: OPEN) { totalCount }"
+                " defaultBranchRef { target { ... on Commit { committedDate messageHeadline statusCheckRollup { state } } } }"
+                " }";
+            std::string out;
+            (void)glz::write_json(wire::request{std::move(query)}, out);
+            return out;
+        }
+
+        // The summaries in a reply to body(names), in the order of `names`; unreadable or
+        // inaccessible repositories are left out
+        inline std::vector<repo_summary> parse(std::string const &reply_body, std::span<std::string const> names) {
+            std::vector<repo_summary> summaries;
+            wire::reply reply;
+            if (glz::read<glz::opts{.error_on_unknown_keys = false}>(reply, reply_body) || !reply.data) {
+                return summaries;
+            }
+            for (size_t i = 0; i < names.size(); ++i) {
+                auto found = reply.data->find(alias(i));
+                if (found == reply.data->end() || !found->second) {
+                    continue;
+                }
+                auto &repo = *found->second;
+                repo_summary summary;
+                summary.full_name = std::move(repo.nameWithOwner);
+                summary.stars = repo.stargazerCount;
+                summary.open_prs = repo.pullRequests.totalCount;
+                summary.open_issues = repo.issues.totalCount;
+                if (repo.defaultBranchRef && repo.defaultBranchRef->target) {
+                    auto &head = *repo.defaultBranchRef->target;
+                    summary.last_commit_date = std::move(head.committedDate);
+                    summary.last_commit = std::move(head.messageHeadline);
+                    if (head.statusCheckRollup) {
+                        summary.ci_state = std::move(head.statusCheckRollup->state);
+                    }
+                }
+                summaries.push_back(std::move(summary));
+            }
+            return summaries;
+        }
+    }
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <glaze/glaze.hpp>
+
+#include "../helpers/debug.hpp"
+#include "../helpers/sqlite.hpp"
+#include "../helpers/write_behind.hpp"
+#include "jira_model.hpp"
+
+namespace rouen::models {
+
+/**
+ * The issues seen on each Jira connection profile, so a project opens from disk and the
+ * server is only asked what changed: per profile and scope (a project), the local time the
+ * last sync started, for the next one to ask `updated >= "<then>"`, and when the scope was
+ * last reconciled (its keys listed to drop the issues deleted or moved out since). Issues are
+ * kept as a flat JSON row, and written through write_behind so a first sync of thousands is
+ * a few transactions.
+ */
+class jira_issue_cache {
+public:
+    struct sync_state {
+        std::string last_sync;          // in JQL's "yyyy/MM/dd HH:mm", empty before the first
+        int64_t last_reconcile = 0;     // seconds since the epoch
+    };
+
+    static jira_issue_cache& instance() {
+        static jira_issue_cache cache {"jira_issues.db"};
+        return cache;
+    }
+
+    jira_issue_cache(const jira_issue_cache&) = delete;
+    jira_issue_cache& operator=(const jira_issue_cache&) = delete;
+
+    sync_state state(const std::string& profile, const std::string& scope) {
+        sync_state found;
+        try {
+            writes_.flush();
+            db_.for_each_readonly<std::string_view, int64_t>("SELECT last_sync, last_reconcile FROM jira_sync WHERE profile = ? AND scope = ?",
+                [&found](std::string_view last_sync, int64_t last_reconcile) {
+                    found = {std::string{last_sync}, last_reconcile};
+                }, profile, scope);
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Jira cache: cannot read sync state of {}: {}", scope, e.what());
+        }
+        return found;
+    }
+
+    void set_state(const std::string& profile, const std::string& scope, const sync_state& state) {
+        writes_.put(std::format("sync|{}|{}", profile, scope), [profile, scope, state](hosting::db::sqlite& db) {
+            db.exec("INSERT OR REPLACE INTO jira_sync (profile, scope, last_sync, last_reconcile) VALUES (?, ?, ?, ?)",
+                    nullptr, profile, scope, state.last_sync, state.last_reconcile);
+        });
+    }
+
+    void put(const std::string& profile, const jira_issue& issue) {
+        std::string data;
+        if (auto ec = glz::write_json(row::from(issue), data)) {
+            DB_ERROR_FMT("Jira cache: cannot serialize {}: {}", issue.key, glz::format_error(ec));
+            return;
+        }
+        writes_.put(std::format("issue|{}|{}", profile, issue.key),
+            [profile, key = issue.key, project = project_of(issue.key), updated = issue.updated, data = std::move(data)](hosting::db::sqlite& db) {
+                db.exec("INSERT OR REPLACE INTO jira_issue (profile, key, project, updated, data) VALUES (?, ?, ?, ?, ?)",
+                        nullptr, profile, key, project, updated, data);
+            });
+    }
+
+    void remove(const std::string& profile, const std::string& key) {
+        writes_.put(std::format("issue|{}|{}", profile, key), [profile, key](hosting::db::sqlite& db) {
+            db.exec("DELETE FROM jira_issue WHERE profile = ? AND key = ?", nullptr, profile, key);
+        });
+    }
+
+    std::optional<jira_issue> get(const std::string& profile, const std::string& key) {
+        std::optional<jira_issue> found;
+        try {
+            writes_.flush();
+            db_.for_each_readonly<std::string_view>("SELECT data FROM jira_issue WHERE profile = ? AND key = ?",
+                [&found](std::string_view data) { found = parse(data); }, profile, key);
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Jira cache: cannot read {}: {}", key, e.what());
+        }
+        return found;
+    }
+
+    // The project's issues, most recently updated first
+    std::vector<jira_issue> project_issues(const std::string& profile, const std::string& project_key) {
+        std::vector<jira_issue> issues;
+        try {
+            writes_.flush();
+            db_.for_each_readonly<std::string_view>("SELECT data FROM jira_issue WHERE profile = ? AND project = ? ORDER BY updated DESC",
+                [&issues](std::string_view data) {
+                    if (auto issue = parse(data)) {
+                        issues.push_back(std::move(*issue));
+                    }
+                }, profile, project_key);
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Jira cache: cannot read project {}: {}", project_key, e.what());
+        }
+        return issues;
+    }
+
+    std::unordered_set<std::string> project_keys(const std::string& profile, const std::string& project_key) {
+        std::unordered_set<std::string> keys;
+        try {
+            writes_.flush();
+            db_.for_each_readonly<std::string_view>("SELECT key FROM jira_issue WHERE profile = ? AND project = ?",
+                [&keys](std::string_view key) { keys.emplace(key); }, profile, project_key);
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Jira cache: cannot read project {}: {}", project_key, e.what());
+        }
+        return keys;
+    }
+
+    static std::string project_of(const std::string& key) {
+        return key.substr(0, key.find('-'));
+    }
+
+private:
+    // What is kept of an issue
+    struct row {
+        std::string id;
+        std::string key;
+        std::string summary;
+        std::string description;
+        std::string issue_type;
+        std::string issue_type_icon;
+        std::string status;
+        std::string status_category;
+        std::string status_color;
+        std::string assignee_id;
+        std::string assignee;
+        std::string reporter_id;
+        std::string reporter;
+        std::string created;
+        std::string updated;
+        std::vector<std::string> labels;
+
+        struct glaze {
+            using T = row;
+
+            static constexpr auto value = glz::object(
+                "id", &T::id,
+                "key", &T::key,
+                "summary", &T::summary,
+                "description", &T::description,
+                "issue_type", &T::issue_type,
+                "issue_type_icon", &T::issue_type_icon,
+                "status", &T::status,
+                "status_category", &T::status_category,
+                "status_color", &T::status_color,
+                "assignee_id", &T::assignee_id,
+                "assignee", &T::assignee,
+                "reporter_id", &T::reporter_id,
+                "reporter", &T::reporter,
+                "created", &T::created,
+                "updated", &T::updated,
+                "labels", &T::labels
+            );
+        };
+
+        static row from(const jira_issue& issue) {
+            return {issue.id, issue.key, issue.summary, issue.description,
+                    issue.issue_type.name, issue.issue_type.icon_url,
+                    issue.status.name, issue.status.category, issue.status.color,
+                    issue.assignee.account_id, issue.assignee.display_name,
+                    issue.reporter.account_id, issue.reporter.display_name,
+                    issue.created, issue.updated, issue.labels};
+        }
+
+        jira_issue to_issue() && {
+            jira_issue issue;
+            issue.id = std::move(id);
+            issue.key = std::move(key);
+            issue.summary = std::move(summary);
+            issue.description = std::move(description);
+            issue.issue_type.name = std::move(issue_type);
+            issue.issue_type.icon_url = std::move(issue_type_icon);
+            issue.status.name = std::move(status);
+            issue.status.category = std::move(status_category);
+            issue.status.color = std::move(status_color);
+            issue.assignee.account_id = std::move(assignee_id);
+            issue.assignee.display_name = std::move(assignee);
+            issue.reporter.account_id = std::move(reporter_id);
+            issue.reporter.display_name = std::move(reporter);
+            issue.created = std::move(created);
+            issue.updated = std::move(updated);
+            issue.labels = std::move(labels);
+            return issue;
+        }
+    };
+
+    static std::optional<jira_issue> parse(std::string_view data) {
+        row r;
+        if (auto ec = glz::read<glz::opts{.error_on_unknown_keys = false}>(r, data)) {
+            DB_ERROR_FMT("Jira cache: unreadable row: {}", glz::format_error(ec));
+            return std::nullopt;
+        }
+        return std::move(r).to_issue();
+    }
+
+    explicit jira_issue_cache(const std::string& path) : db_{path} {
+        db_.ensure_table("jira_sync",
+            "profile TEXT, scope TEXT, last_sync TEXT, last_reconcile INTEGER, PRIMARY KEY (profile, scope)");
+        db_.ensure_table("jira_issue",
+            "profile TEXT, key TEXT, project TEXT, updated TEXT, data TEXT, PRIMARY KEY (profile, key)");
+        db_.exec("CREATE INDEX IF NOT EXISTS jira_issue_project ON jira_issue (profile, project, updated)");
+    }
+
+    hosting::db::sqlite db_;
+    hosting::db::write_behind writes_ {db_};
+};
+
+} // namespace rouen::models
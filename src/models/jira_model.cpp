@@ -9,10 +9,15 @@
 #include <mutex>
 #include <format>
 #include <regex>
+#include <ctime>
+#include <unordered_set>
 #include "../helpers/fetch.hpp"
 #include "../helpers/api_keys.hpp"
 #include "../helpers/debug.hpp"
 #include "../helpers/platform_utils.hpp"
+#include "../helpers/redraw.hpp"
+#include "../helpers/task_scheduler.hpp"
+#include "jira_cache.hpp"
 
 namespace fs = std::filesystem;
 
@@ -26,22 +31,427 @@ struct jira_server_info {
     std::string server_title;
 };
 
-// Comment structure declaration that's used in implementation but not in header
-struct jira_comment {
+// Priority structure declaration used in implementation but not in header
+struct jira_priority {
+    std::string id;
+    std::string name;
+    std::string icon_url;
+};
+
+// The JSON the server sends, read by glaze as it parses (no DOM in between) and then moved
+// into the model's plain records. Keys not listed here are skipped; absent ones keep their
+// defaults, so a response with only some fields reads fine.
+namespace wire {
+
+static constexpr glz::opts lenient {.error_on_unknown_keys = false};
+
+struct avatar_urls {
+    std::string large;
+    
+    struct glaze {
+        using T = avatar_urls;
+        static constexpr auto value = glz::object("48x48", &T::large);
+    };
+};
+
+struct user {
+    std::string accountId;
+    std::string emailAddress;
+    std::string displayName;
+    avatar_urls avatarUrls;
+    
+    struct glaze {
+        using T = user;
+        static constexpr auto value = glz::object(
+            "accountId", &T::accountId,
+            "emailAddress", &T::emailAddress,
+            "displayName", &T::displayName,
+            "avatarUrls", &T::avatarUrls
+        );
+    };
+    
+    jira_user into() && {
+        return {std::move(accountId), std::move(emailAddress), std::move(displayName), std::move(avatarUrls.large)};
+    }
+};
+
+struct status_category {
+    std::string name;
+    std::string colorName;
+    
+    struct glaze {
+        using T = status_category;
+        static constexpr auto value = glz::object("name", &T::name, "colorName", &T::colorName);
+    };
+};
+
+struct issue_status {
+    std::string id;
+    std::string name;
+    std::optional<std::string> description;
+    status_category statusCategory;
+    
+    struct glaze {
+        using T = issue_status;
+        static constexpr auto value = glz::object(
+            "id", &T::id,
+            "name", &T::name,
+            "description", &T::description,
+            "statusCategory", &T::statusCategory
+        );
+    };
+    
+    jira_status into() && {
+        return {std::move(id), std::move(name), std::move(description).value_or(""),
+                std::move(statusCategory.name), std::move(statusCategory.colorName)};
+    }
+};
+
+struct issue_type {
     std::string id;
-    std::string body;
+    std::string name;
+    std::optional<std::string> description;
+    std::string iconUrl;
+    bool subtask = false;
+    
+    struct glaze {
+        using T = issue_type;
+        static constexpr auto value = glz::object(
+            "id", &T::id,
+            "name", &T::name,
+            "description", &T::description,
+            "iconUrl", &T::iconUrl,
+            "subtask", &T::subtask
+        );
+    };
+    
+    jira_issue_type into() && {
+        return {std::move(id), std::move(name), std::move(description).value_or(""), std::move(iconUrl), subtask};
+    }
+};
+
+std::string rich_text(glz::raw_json const& raw);
+
+struct issue_fields {
+    std::string summary;
+    glz::raw_json description;    // plain text (v2) or an Atlassian Document (v3)
+    issue_type issuetype;
+    issue_status status;
+    std::optional<user> assignee;
+    std::optional<user> reporter;
     std::string created;
     std::string updated;
-    jira_user author;
+    std::optional<std::vector<std::string>> labels;
+    
+    struct glaze {
+        using T = issue_fields;
+        static constexpr auto value = glz::object(
+            "summary", &T::summary,
+            "description", &T::description,
+            "issuetype", &T::issuetype,
+            "status", &T::status,
+            "assignee", &T::assignee,
+            "reporter", &T::reporter,
+            "created", &T::created,
+            "updated", &T::updated,
+            "labels", &T::labels
+        );
+    };
 };
 
-// Priority structure declaration used in implementation but not in header
-struct jira_priority {
+struct issue {
+    std::string id;
+    std::string key;
+    issue_fields fields;
+    
+    struct glaze {
+        using T = issue;
+        static constexpr auto value = glz::object("id", &T::id, "key", &T::key, "fields", &T::fields);
+    };
+    
+    jira_issue into() && {
+        jira_issue out;
+        out.id = std::move(id);
+        out.key = std::move(key);
+        out.summary = std::move(fields.summary);
+        out.description = rich_text(fields.description);
+        out.issue_type = std::move(fields.issuetype).into();
+        out.status = std::move(fields.status).into();
+        if (fields.assignee) {
+            out.assignee = std::move(*fields.assignee).into();
+        }
+        if (fields.reporter) {
+            out.reporter = std::move(*fields.reporter).into();
+        }
+        out.created = std::move(fields.created);
+        out.updated = std::move(fields.updated);
+        out.labels = std::move(fields.labels).value_or(std::vector<std::string>{});
+        return out;
+    }
+};
+
+struct search_result {
+    int startAt = 0;
+    int maxResults = 0;
+    int total = 0;
+    std::vector<issue> issues;
+    
+    struct glaze {
+        using T = search_result;
+        static constexpr auto value = glz::object(
+            "startAt", &T::startAt,
+            "maxResults", &T::maxResults,
+            "total", &T::total,
+            "issues", &T::issues
+        );
+    };
+};
+
+struct project {
     std::string id;
+    std::string key;
     std::string name;
-    std::string icon_url;
+    std::optional<std::string> description;
+    std::optional<user> lead;
+    std::string self;
+    avatar_urls avatarUrls;
+    std::vector<issue_type> issueTypes;
+    
+    struct glaze {
+        using T = project;
+        static constexpr auto value = glz::object(
+            "id", &T::id,
+            "key", &T::key,
+            "name", &T::name,
+            "description", &T::description,
+            "lead", &T::lead,
+            "self", &T::self,
+            "avatarUrls", &T::avatarUrls,
+            "issueTypes", &T::issueTypes
+        );
+    };
+    
+    jira_project into() && {
+        jira_project out;
+        out.id = std::move(id);
+        out.key = std::move(key);
+        out.name = std::move(name);
+        out.description = std::move(description).value_or("");
+        if (lead) {
+            out.lead = std::move(lead->displayName);
+        }
+        out.url = std::move(self);
+        out.avatar_url = std::move(avatarUrls.large);
+        out.issue_types.reserve(issueTypes.size());
+        for (auto& type : issueTypes) {
+            out.issue_types.push_back(std::move(type).into());
+        }
+        return out;
+    }
+};
+
+struct transition {
+    std::string id;
+    std::string name;
+    issue_status to;
+    
+    struct glaze {
+        using T = transition;
+        static constexpr auto value = glz::object("id", &T::id, "name", &T::name, "to", &T::to);
+    };
+};
+
+struct transition_list {
+    std::vector<transition> transitions;
+    
+    struct glaze {
+        using T = transition_list;
+        static constexpr auto value = glz::object("transitions", &T::transitions);
+    };
+};
+
+// An Atlassian Document (API v3 rich text): its text, a line per block
+struct adf_node {
+    std::string type;
+    std::string text;
+    std::vector<adf_node> content;
+    
+    struct glaze {
+        using T = adf_node;
+        static constexpr auto value = glz::object("type", &T::type, "text", &T::text, "content", &T::content);
+    };
+    
+    void append_text(std::string& out) const {
+        if (type == "hardBreak") {
+            out += '\n';
+        }
+        out += text;
+        for (auto const& child : content) {
+            child.append_text(out);
+        }
+        if (type == "paragraph" || type == "heading" || type == "codeBlock" || type == "rule") {
+            out += '\n';
+        }
+    }
+};
+
+// Rich text as API v2 (a string) or v3 (an Atlassian Document) sends it; null reads as empty
+std::string rich_text(glz::raw_json const& raw) {
+    std::string out;
+    auto const& json = raw.str;
+    if (json.empty()) {
+        return out;
+    }
+    if (json.front() == '"') {
+        (void)glz::read_json(out, json);
+    } else if (json.front() == '{') {
+        adf_node document;
+        if (glz::read<lenient>(document, json)) {
+            return "ADF document - view in browser";
+        }
+        document.append_text(out);
+    }
+    return out;
+}
+
+struct comment {
+    std::string id;
+    glz::raw_json body;
+    std::string created;
+    std::string updated;
+    std::optional<user> author;
+    
+    struct glaze {
+        using T = comment;
+        static constexpr auto value = glz::object(
+            "id", &T::id,
+            "body", &T::body,
+            "created", &T::created,
+            "updated", &T::updated,
+            "author", &T::author
+        );
+    };
+};
+
+struct comment_page {
+    std::vector<comment> comments;
+    
+    struct glaze {
+        using T = comment_page;
+        static constexpr auto value = glz::object("comments", &T::comments);
+    };
+};
+
+struct change_item {
+    std::string field;
+    std::optional<std::string> fromString;
+    std::optional<std::string> toString;
+    
+    struct glaze {
+        using T = change_item;
+        static constexpr auto value = glz::object("field", &T::field, "fromString", &T::fromString, "toString", &T::toString);
+    };
+};
+
+struct history {
+    std::optional<user> author;
+    std::string created;
+    std::vector<change_item> items;
+    
+    struct glaze {
+        using T = history;
+        static constexpr auto value = glz::object("author", &T::author, "created", &T::created, "items", &T::items);
+    };
+};
+
+struct changelog {
+    std::vector<history> histories;
+    
+    struct glaze {
+        using T = changelog;
+        static constexpr auto value = glz::object("histories", &T::histories);
+    };
+};
+
+struct detail_fields {
+    glz::raw_json description;
+    comment_page comment;
+    
+    struct glaze {
+        using T = detail_fields;
+        static constexpr auto value = glz::object("description", &T::description, "comment", &T::comment);
+    };
+};
+
+struct issue_details {
+    std::string key;
+    detail_fields fields;
+    wire::changelog changelog;
+    
+    struct glaze {
+        using T = issue_details;
+        static constexpr auto value = glz::object("key", &T::key, "fields", &T::fields, "changelog", &T::changelog);
+    };
+    
+    jira_issue_details into() && {
+        jira_issue_details out;
+        out.key = std::move(key);
+        out.description = rich_text(fields.description);
+        for (auto& c : fields.comment.comments) {
+            out.comments.push_back({std::move(c.id), rich_text(c.body), std::move(c.created), std::move(c.updated),
+                                    c.author ? std::move(*c.author).into() : jira_user{}});
+        }
+        for (auto& h : changelog.histories) {
+            auto const author = h.author ? h.author->displayName : std::string{};
+            for (auto& item : h.items) {
+                out.changes.push_back({author, h.created, std::move(item.field),
+                                       std::move(item.fromString).value_or(""), std::move(item.toString).value_or("")});
+            }
+        }
+        return out;
+    }
 };
 
+struct created_issue {
+    std::string id;
+    std::string key;
+    
+    struct glaze {
+        using T = created_issue;
+        static constexpr auto value = glz::object("id", &T::id, "key", &T::key);
+    };
+};
+
+struct server_info {
+    std::string version;
+    std::string buildNumber;
+    std::string baseUrl;
+    std::string serverTitle;
+    
+    struct glaze {
+        using T = server_info;
+        static constexpr auto value = glz::object(
+            "version", &T::version,
+            "buildNumber", &T::buildNumber,
+            "baseUrl", &T::baseUrl,
+            "serverTitle", &T::serverTitle
+        );
+    };
+};
+
+// `json` read as T; std::nullopt (logged, naming `what`) if it is not one
+template <typename T>
+std::optional<T> read(std::string_view json, std::string_view what) {
+    T value {};
+    if (auto ec = glz::read<lenient>(value, json)) {
+        JIRA_ERROR_FMT("Cannot read JIRA {}: {}", what, glz::format_error(ec));
+        return std::nullopt;
+    }
+    return value;
+}
+
+} // namespace wire
+
 // Static mutex for thread safety with profiles
 static std::mutex profiles_mutex;
 // Flag to track if profiles have been modified
@@ -144,15 +554,11 @@ static jira_server_info get_server_info(const jira_connection_profile& profile)
         std::string response = fetcher(url, headers);
         
         // Parse JSON response
-        auto json_result = glz::read_json<glz::json_t>(response);
-        if (json_result.has_value()) {
-            glz::json_t& json = json_result.value();
-            
-            // Extract server info
-            info.version = json["version"].get<std::string>();
-            info.build_number = json["buildNumber"].get<std::string>();
-            info.base_url = json["baseUrl"].get<std::string>();
-            info.server_title = json["serverTitle"].get<std::string>();
+        if (auto parsed = wire::read<wire::server_info>(response, "server info")) {
+            info.version = std::move(parsed->version);
+            info.build_number = std::move(parsed->buildNumber);
+            info.base_url = std::move(parsed->baseUrl);
+            info.server_title = std::move(parsed->serverTitle);
             
             DB_INFO("JIRA serverInfo request successful");
         }
@@ -218,335 +624,391 @@ std::string jira_model::get_current_profile_name() const {
     return connected_ ? current_profile_.name : "";
 }
 
+// Non-blocking request on the shared HTTP engine; `done` runs on the scheduler with the
+// response body, or std::nullopt when the request failed (already logged)
+void jira_model::on_response(const std::string& endpoint, const std::string& method, const std::string& data,
+                             std::function<void(std::optional<std::string>)> done) {
+    auto request = build_request(endpoint, method, data);
+    auto const url = request.url;
+    http::engine::instance().submit(std::move(request), [url, method, done = std::move(done)](http::response response) mutable {
+        std::optional<std::string> body;
+        if (response.ok()) {
+            DB_INFO_FMT("JIRA API request successful to {}", url);
+            body = std::move(response.body);
+        } else {
+            JIRA_ERROR_FMT("JIRA API {} request to '{}' failed: {}", method.empty() ? "GET" : method, url, response.error);
+        }
+        rouen::helpers::scheduler()->submit([done = std::move(done), body = std::move(body)](std::stop_token) mutable {
+            done(std::move(body));
+            // Cards poll their futures once a frame and otherwise sit idle: give them that frame
+            rouen::helpers::request_redraw();
+        }, rouen::helpers::task_priority::high);
+    });
+}
+
+// Like on_response, with the parsed result delivered through a future; failures yield T{}
+template <typename T, typename Parse>
+std::future<T> jira_model::request_async(const std::string& endpoint, const std::string& method,
+                                         const std::string& data, Parse parse) {
+    auto promise = std::make_shared<std::promise<T>>();
+    auto result = promise->get_future();
+    try {
+        on_response(endpoint, method, data, [promise, parse](std::optional<std::string> response) {
+            promise->set_value(response ? parse(*response) : T{});
+        });
+    } catch (const std::exception& e) {
+        JIRA_ERROR_FMT("JIRA API request to '{}' failed: {}", endpoint, e.what());
+        promise->set_value(T{});
+    }
+    return result;
+}
+
+// Request body for a JQL search
+// The fields a search asks for. Lists show key, summary, status, type and assignee; the
+// description, comments and history of an issue come with its details (get_issue_details)
+static const std::vector<std::string> list_fields {"summary", "status", "issuetype", "assignee", "created", "updated"};
+static const std::vector<std::string> full_fields {"summary", "description", "status", "assignee", "reporter",
+                                                   "issuetype", "created", "updated", "labels"};
+
+static std::string search_payload(const std::string& jql, int start_at, int max_results,
+                                  std::vector<std::string> const& fields = list_fields) {
+    // Construct request payload
+    glz::json_t payload;
+    payload["jql"] = jql;
+    payload["startAt"] = start_at;
+    payload["maxResults"] = max_results;
+    
+    // Create array of fields
+    glz::json_t::array_t fields_array;
+    for (auto const& field : fields) {
+        fields_array.push_back(field);
+    }
+    
+    payload["fields"] = fields_array;
+    
+    std::string json_payload;
+    auto write_error = glz::write_json(payload, json_payload);
+    if (write_error) {
+        throw std::runtime_error(std::format("Failed to serialize JSON payload: {}", glz::format_error(write_error)));
+    }
+    return json_payload;
+}
+
+// Parse a search response; an empty result if it cannot be read
+jira_search_result jira_model::parse_search_result(const std::string& response) {
+    jira_search_result result;
+    if (auto parsed = wire::read<wire::search_result>(response, "search result")) {
+        result.start_at = parsed->startAt;
+        result.max_results = parsed->maxResults;
+        result.total = parsed->total;
+        result.issues.reserve(parsed->issues.size());
+        for (auto& issue : parsed->issues) {
+            result.issues.push_back(std::move(issue).into());
+        }
+    }
+    return result;
+}
+
 // Get projects from JIRA
 std::future<std::vector<jira_project>> jira_model::get_projects() {
-    return std::async(std::launch::async, [this]() {
+    return request_async<std::vector<jira_project>>("project", "GET", "", [](const std::string& response) {
         std::vector<jira_project> projects;
-        
-        try {
-            // Make API request
-            std::string response = make_request("project");
-            
-            // Parse JSON response
-            auto json_result = glz::read_json<std::vector<glz::json_t>>(response);
-            if (json_result.has_value()) {
-                auto& json_array = json_result.value();
-                
-                for (const auto& json : json_array) {
-                    jira_project project;
-                    project.id = json["id"].get<std::string>();
-                    project.key = json["key"].get<std::string>();
-                    project.name = json["name"].get<std::string>();
-                    
-                    // Description might be null
-                    if (json.contains("description") && !json["description"].is_null()) {
-                        project.description = json["description"].get<std::string>();
-                    }
-                    
-                    projects.push_back(project);
-                }
+        if (auto parsed = wire::read<std::vector<wire::project>>(response, "projects")) {
+            projects.reserve(parsed->size());
+            for (auto& project : *parsed) {
+                projects.push_back(std::move(project).into());
             }
-        } catch (const std::exception& e) {
-            DB_ERROR_FMT("Error getting JIRA projects: {}", e.what());
         }
-        
         return projects;
     });
 }
 
 // Get a specific project by key
 std::future<jira_project> jira_model::get_project(const std::string& project_key) {
-    return std::async(std::launch::async, [this, project_key]() {
-        jira_project project;
-        
-        try {
-            // Make API request
-            std::string response = make_request(std::format("project/{}", project_key));
-            
-            // Parse JSON response
-            auto json_result = glz::read_json<glz::json_t>(response);
-            if (json_result.has_value()) {
-                glz::json_t& json = json_result.value();
-                
-                project.id = json["id"].get<std::string>();
-                project.key = json["key"].get<std::string>();
-                project.name = json["name"].get<std::string>();
-                
-                // Description might be null
-                if (json.contains("description") && !json["description"].is_null()) {
-                    project.description = json["description"].get<std::string>();
-                }
-                
-                // Process issue types if available
-                if (json.contains("issueTypes")) {
-                    for (const auto& type_json : json["issueTypes"].get<std::vector<glz::json_t>>()) {
-                        jira_issue_type type;
-                        type.id = type_json["id"].get<std::string>();
-                        type.name = type_json["name"].get<std::string>();
-                        
-                        if (type_json.contains("description") && !type_json["description"].is_null()) {
-                            type.description = type_json["description"].get<std::string>();
-                        }
-                        
-                        if (type_json.contains("iconUrl")) {
-                            type.icon_url = type_json["iconUrl"].get<std::string>();
-                        }
-                        
-                        if (type_json.contains("subtask")) {
-                            type.is_subtask = type_json["subtask"].get<bool>();
-                        }
-                        
-                        project.issue_types.push_back(type);
-                    }
-                }
-            }
-        } catch (const std::exception& e) {
-            DB_ERROR_FMT("Error getting JIRA project: {}", e.what());
-        }
-        
-        return project;
+    return request_async<jira_project>(std::format("project/{}", project_key), "GET", "", [](const std::string& response) {
+        auto parsed = wire::read<wire::project>(response, "project");
+        return parsed ? std::move(*parsed).into() : jira_project{};
     });
 }
 
 // Get issues from a project
 std::future<std::vector<jira_issue>> jira_model::get_issues(const std::string& project_key, int max_results) {
-    return std::async(std::launch::async, [this, project_key, max_results]() {
-        std::vector<jira_issue> issues;
+    auto promise = std::make_shared<std::promise<std::vector<jira_issue>>>();
+    auto issues = promise->get_future();
+    
+    try {
+        // Construct JQL query that includes all issues including backlog items
+        std::string jql = std::format("project = {} ORDER BY updated DESC", project_key);
         
-        try {
-            // Construct JQL query that includes all issues including backlog items
-            std::string jql = std::format("project = {} ORDER BY updated DESC", project_key);
-            
-            // Use search API with JQL
-            auto search_result = search_issues(jql, 0, max_results).get();
+        // Use search API with JQL
+        on_response("search", "POST", search_payload(jql, 0, max_results),
+                    [this, promise, project_key, max_results](std::optional<std::string> response) {
+            auto search_result = response ? parse_search_result(*response) : jira_search_result{};
+            if (!search_result.issues.empty()) {
+                JIRA_INFO_FMT("Retrieved {} issues for project {}", search_result.issues.size(), project_key);
+                promise->set_value(std::move(search_result.issues));
+                return;
+            }
             
             // If no issues found, try with a more explicit query that includes all statuses
-            if (search_result.issues.empty()) {
-                JIRA_INFO_FMT("No issues found with basic query, trying with expanded query for project {}", project_key);
-                jql = std::format("project = {} AND status in (Open, \"In Progress\", Reopened, \"To Do\", Backlog, \"Selected for Development\", New, \"In Review\", Done, Closed) ORDER BY updated DESC", project_key);
-                search_result = search_issues(jql, 0, max_results).get();
+            JIRA_INFO_FMT("No issues found with basic query, trying with expanded query for project {}", project_key);
+            auto expanded_jql = std::format("project = {} AND status in (Open, \"In Progress\", Reopened, \"To Do\", Backlog, \"Selected for Development\", New, \"In Review\", Done, Closed) ORDER BY updated DESC", project_key);
+            try {
+                on_response("search", "POST", search_payload(expanded_jql, 0, max_results),
+                            [promise, project_key](std::optional<std::string> retry) {
+                    auto found = retry ? parse_search_result(*retry).issues : std::vector<jira_issue>{};
+                    JIRA_INFO_FMT("Retrieved {} issues for project {}", found.size(), project_key);
+                    promise->set_value(std::move(found));
+                });
+            } catch (const std::exception& e) {
+                DB_ERROR_FMT("Error getting JIRA issues: {}", e.what());
+                promise->set_value({});
             }
-            
-            issues = search_result.issues;
-            JIRA_INFO_FMT("Retrieved {} issues for project {}", issues.size(), project_key);
-        } catch (const std::exception& e) {
-            DB_ERROR_FMT("Error getting JIRA issues: {}", e.what());
-        }
-        
-        return issues;
-    });
+        });
+    } catch (const std::exception& e) {
+        DB_ERROR_FMT("Error getting JIRA issues: {}", e.what());
+        promise->set_value({});
+    }
+    
+    return issues;
+}
+
+// Parse an issue response; a default issue if it cannot be read
+static jira_issue parse_issue(const std::string& response) {
+    auto parsed = wire::read<wire::issue>(response, "issue");
+    return parsed ? std::move(*parsed).into() : jira_issue{};
 }
 
 // Get details for a specific issue
 std::future<jira_issue> jira_model::get_issue(const std::string& issue_key) {
-    return std::async(std::launch::async, [this, issue_key]() {
-        jira_issue issue;
-        
-        try {
-            // Make API request
-            std::string response = make_request(std::format("issue/{}", issue_key));
-            
-            // Parse JSON response
-            auto json_result = glz::read_json<glz::json_t>(response);
-            if (json_result.has_value()) {
-                glz::json_t& json = json_result.value();
-                
-                // Extract issue details
-                issue.id = json["id"].get<std::string>();
-                issue.key = json["key"].get<std::string>();
-                
-                auto& fields = json["fields"];
-                
-                // Extract basic fields
-                issue.summary = fields["summary"].get<std::string>();
-                
-                // Description might be null
-                if (fields.contains("description") && !fields["description"].is_null()) {
-                    if (fields["description"].is_string()) {
-                        issue.description = fields["description"].get<std::string>();
-                    } else {
-                        // Handle Atlassian Document Format
-                        issue.description = "ADF document - view in browser";
-                    }
-                }
-                
-                // Created and updated dates
-                issue.created = fields["created"].get<std::string>();
-                issue.updated = fields["updated"].get<std::string>();
-                
-                // Status
-                auto& status = fields["status"];
-                issue.status.id = status["id"].get<std::string>();
-                issue.status.name = status["name"].get<std::string>();
-                issue.status.category = status["statusCategory"]["name"].get<std::string>();
-                if (status["statusCategory"].contains("colorName")) {
-                    issue.status.color = status["statusCategory"]["colorName"].get<std::string>();
-                }
-                
-                // Issue type
-                auto& issue_type = fields["issuetype"];
-                issue.issue_type.id = issue_type["id"].get<std::string>();
-                issue.issue_type.name = issue_type["name"].get<std::string>();
-                if (issue_type.contains("iconUrl")) {
-                    issue.issue_type.icon_url = issue_type["iconUrl"].get<std::string>();
-                }
-                if (issue_type.contains("subtask")) {
-                    issue.issue_type.is_subtask = issue_type["subtask"].get<bool>();
-                }
-                if (issue_type.contains("description") && !issue_type["description"].is_null()) {
-                    issue.issue_type.description = issue_type["description"].get<std::string>();
-                }
-                
-                // Assignee (might be null)
-                if (fields.contains("assignee") && !fields["assignee"].is_null()) {
-                    auto& assignee = fields["assignee"];
-                    issue.assignee.account_id = assignee["accountId"].get<std::string>();
-                    issue.assignee.display_name = assignee["displayName"].get<std::string>();
-                    if (assignee.contains("emailAddress")) {
-                        issue.assignee.email = assignee["emailAddress"].get<std::string>();
-                    }
-                    if (assignee.contains("avatarUrls") && 
-                        assignee["avatarUrls"].contains("48x48")) {
-                        issue.assignee.avatar_url = assignee["avatarUrls"]["48x48"].get<std::string>();
-                    }
-                }
-                
-                // Reporter (might be null)
-                if (fields.contains("reporter") && !fields["reporter"].is_null()) {
-                    auto& reporter = fields["reporter"];
-                    issue.reporter.account_id = reporter["accountId"].get<std::string>();
-                    issue.reporter.display_name = reporter["displayName"].get<std::string>();
-                    if (reporter.contains("emailAddress")) {
-                        issue.reporter.email = reporter["emailAddress"].get<std::string>();
-                    }
-                    if (reporter.contains("avatarUrls") && 
-                        reporter["avatarUrls"].contains("48x48")) {
-                        issue.reporter.avatar_url = reporter["avatarUrls"]["48x48"].get<std::string>();
-                    }
-                }
-                
-                // Labels
-                if (fields.contains("labels") && !fields["labels"].is_null()) {
-                    for (const auto& label : fields["labels"].get<std::vector<glz::json_t>>()) {
-                        issue.labels.push_back(label.get<std::string>());
-                    }
-                }
-            }
-        } catch (const std::exception& e) {
-            DB_ERROR_FMT("Error getting JIRA issue: {}", e.what());
+    return request_async<jira_issue>(std::format("issue/{}", issue_key), "GET", "", [profile = cache_profile()](const std::string& response) {
+        auto issue = parse_issue(response);
+        if (!issue.key.empty()) {
+            jira_issue_cache::instance().put(profile, issue);
         }
-        
         return issue;
     });
 }
 
-// Create a new JIRA issue
-std::future<jira_issue> jira_model::create_issue(const jira_issue_create& issue_data) {
-    return std::async(std::launch::async, [this, issue_data]() {
-        jira_issue created_issue;
-        
-        try {
-            // Construct request payload
-            glz::json_t payload;
-            glz::json_t fields;
-            
-            // Set up fields using proper JSON object construction
-            glz::json_t project_obj;
-            project_obj["key"] = issue_data.project_key;
-            fields["project"] = project_obj;
-            
-            fields["summary"] = issue_data.summary;
-            fields["description"] = issue_data.description;
-            
-            glz::json_t issuetype_obj;
-            issuetype_obj["name"] = issue_data.issue_type;
-            fields["issuetype"] = issuetype_obj;
-            
-            // Set assignee if provided
-            if (!issue_data.assignee_account_id.empty()) {
-                glz::json_t assignee_obj;
-                assignee_obj["accountId"] = issue_data.assignee_account_id;
-                fields["assignee"] = assignee_obj;
+// The heavy parts of an issue, for its detail view: description, comments and history
+std::future<jira_issue_details> jira_model::get_issue_details(const std::string& issue_key) {
+    return request_async<jira_issue_details>(std::format("issue/{}?fields=description,comment&expand=changelog", issue_key), "GET", "",
+                                             [](const std::string& response) {
+        auto parsed = wire::read<wire::issue_details>(response, "issue details");
+        return parsed ? std::move(*parsed).into() : jira_issue_details{};
+    });
+}
+
+// What the issue cache files this connection's issues under
+std::string jira_model::cache_profile() const {
+    return std::format("{}|{}", strip_trailing_slash(current_profile_.server_url), current_profile_.username);
+}
+
+std::vector<jira_issue> jira_model::cached_project_issues(const std::string& project_key) const {
+    return jira_issue_cache::instance().project_issues(cache_profile(), project_key);
+}
+
+// A project's issue sync, from page to page of the server's answers
+struct jira_model::project_sync : std::enable_shared_from_this<project_sync> {
+    static constexpr int page_size = 100;
+    static constexpr auto reconcile_every = std::chrono::hours{24};
+    
+    jira_model* model;
+    std::string profile;
+    std::string project_key;
+    jira_issue_cache::sync_state state;
+    std::string started;
+    std::unordered_set<std::string> seen;     // while reconciling
+    std::function<void(std::vector<jira_issue>)> done;
+    
+    void changed(int start_at) {
+        auto jql = std::format("project = \"{}\"", project_key);
+        if (!state.last_sync.empty()) {
+            jql += std::format(" AND updated >= \"{}\"", state.last_sync);
+        }
+        jql += " ORDER BY updated ASC";
+        model->on_response("search", "POST", search_payload(jql, start_at, page_size),
+                           [self = shared_from_this(), start_at](std::optional<std::string> response) {
+            if (!response) {
+                return self->finish();
             }
-            
-            // Set priority if provided
-            if (!issue_data.priority_id.empty()) {
-                glz::json_t priority_obj;
-                priority_obj["id"] = issue_data.priority_id;
-                fields["priority"] = priority_obj;
+            auto page = parse_search_result(*response);
+            auto& cache = jira_issue_cache::instance();
+            for (auto const& issue : page.issues) {
+                cache.put(self->profile, issue);
             }
-            
-            payload["fields"] = fields;
-            
-            std::string json_payload;
-            auto result = glz::write_json(payload, json_payload);
-            if (!result) {
-                throw std::runtime_error("Failed to serialize JSON payload");
+            auto const next = start_at + static_cast<int>(page.issues.size());
+            if (!page.issues.empty() && next < page.total) {
+                return self->changed(next);
             }
+            JIRA_INFO_FMT("Synced {} changed issue(s) of {}", page.total, self->project_key);
+            self->state.last_sync = self->started;
+            auto const now = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            if (now - self->state.last_reconcile < std::chrono::seconds{reconcile_every}.count()) {
+                cache.set_state(self->profile, self->project_key, self->state);
+                return self->finish();
+            }
+            self->reconcile(0);
+        });
+    }
+    
+    // Lists the project's keys (and nothing else) to drop what is gone from it
+    void reconcile(int start_at) {
+        model->on_response("search", "POST",
+                           search_payload(std::format("project = \"{}\"", project_key), start_at, page_size, {"updated"}),
+                           [self = shared_from_this(), start_at](std::optional<std::string> response) {
+            auto& cache = jira_issue_cache::instance();
+            if (!response) {
+                cache.set_state(self->profile, self->project_key, self->state);
+                return self->finish();
+            }
+            auto page = parse_search_result(*response);
+            for (auto& issue : page.issues) {
+                self->seen.insert(std::move(issue.key));
+            }
+            auto const next = start_at + static_cast<int>(page.issues.size());
+            if (!page.issues.empty() && next < page.total) {
+                return self->reconcile(next);
+            }
+            if (static_cast<int>(self->seen.size()) >= page.total) {
+                size_t dropped = 0;
+                for (auto const& key : cache.project_keys(self->profile, self->project_key)) {
+                    if (!self->seen.contains(key)) {
+                        cache.remove(self->profile, key);
+                        ++dropped;
+                    }
+                }
+                JIRA_INFO_FMT("Reconciled {}: {} issue(s) dropped", self->project_key, dropped);
+                self->state.last_reconcile = std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+            }
+            cache.set_state(self->profile, self->project_key, self->state);
+            self->finish();
+        });
+    }
+    
+    void finish() {
+        done(jira_issue_cache::instance().project_issues(profile, project_key));
+    }
+};
+
+// Bring the cached issues of a project up to date with the server; `done` gets them all
+void jira_model::sync_project(const std::string& project_key, std::function<void(std::vector<jira_issue>)> done) {
+    auto sync = std::make_shared<project_sync>();
+    sync->model = this;
+    sync->profile = cache_profile();
+    sync->project_key = project_key;
+    sync->state = jira_issue_cache::instance().state(sync->profile, project_key);
+    sync->done = std::move(done);
+    
+    // JQL compares in the user's time zone to the minute: start from a little before now
+    auto const since = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now() - std::chrono::minutes{5});
+    std::tm local {};
+    if (auto const* tm = std::localtime(&since)) {
+        local = *tm;
+    }
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y/%m/%d %H:%M", &local);
+    sync->started = buffer;
+    
+    try {
+        sync->changed(0);
+    } catch (const std::exception& e) {
+        JIRA_ERROR_FMT("Error syncing JIRA project {}: {}", project_key, e.what());
+        sync->finish();
+    }
+}
+
+// Create a new JIRA issue
+std::future<jira_issue> jira_model::create_issue(const jira_issue_create& issue_data) {
+    auto promise = std::make_shared<std::promise<jira_issue>>();
+    auto created = promise->get_future();
+    
+    try {
+        // Construct request payload
+        glz::json_t payload;
+        glz::json_t fields;
+        
+        // Set up fields using proper JSON object construction
+        glz::json_t project_obj;
+        project_obj["key"] = issue_data.project_key;
+        fields["project"] = project_obj;
+        
+        fields["summary"] = issue_data.summary;
+        fields["description"] = issue_data.description;
+        
+        glz::json_t issuetype_obj;
+        issuetype_obj["name"] = issue_data.issue_type;
+        fields["issuetype"] = issuetype_obj;
+        
+        // Set assignee if provided
+        if (!issue_data.assignee_account_id.empty()) {
+            glz::json_t assignee_obj;
+            assignee_obj["accountId"] = issue_data.assignee_account_id;
+            fields["assignee"] = assignee_obj;
+        }
+        
+        // Set priority if provided
+        if (!issue_data.priority_id.empty()) {
+            glz::json_t priority_obj;
+            priority_obj["id"] = issue_data.priority_id;
+            fields["priority"] = priority_obj;
+        }
+        
+        payload["fields"] = fields;
+        
+        std::string json_payload;
+        auto result = glz::write_json(payload, json_payload);
+        if (!result) {
+            throw std::runtime_error("Failed to serialize JSON payload");
+        }
+        
+        // Make API request
+        on_response("issue", "POST", json_payload, [this, promise](std::optional<std::string> response) {
+            jira_issue created_issue;
             
-            // Make API request
-            std::string response = make_request("issue", "POST", json_payload);
-            
-            // Parse JSON response
-            auto json_result = glz::read_json<glz::json_t>(response);
-            if (json_result.has_value()) {
-                glz::json_t& json = json_result.value();
-                
-                // Extract the created issue key
-                created_issue.id = json["id"].get<std::string>();
-                created_issue.key = json["key"].get<std::string>();
+            try {
+                // Parse JSON response
+                if (response) {
+                    if (auto parsed = wire::read<wire::created_issue>(*response, "created issue")) {
+                        created_issue.id = std::move(parsed->id);
+                        created_issue.key = std::move(parsed->key);
+                    }
+                }
                 
                 // Get full issue details
                 if (!created_issue.key.empty()) {
-                    created_issue = get_issue(created_issue.key).get();
+                    on_response(std::format("issue/{}", created_issue.key), "GET", "",
+                                [promise](std::optional<std::string> details) {
+                        promise->set_value(details ? parse_issue(*details) : jira_issue{});
+                    });
+                    return;
                 }
+            } catch (const std::exception& e) {
+                JIRA_ERROR_FMT("Error creating JIRA issue: {}", e.what());
             }
-        } catch (const std::exception& e) {
-            JIRA_ERROR_FMT("Error creating JIRA issue: {}", e.what());
-        }
-        
-        return created_issue;
-    });
+            
+            promise->set_value(std::move(created_issue));
+        });
+    } catch (const std::exception& e) {
+        JIRA_ERROR_FMT("Error creating JIRA issue: {}", e.what());
+        promise->set_value({});
+    }
+    
+    return created;
 }
 
 // Get available transitions for an issue
 std::future<std::vector<jira_transition>> jira_model::get_transitions(const std::string& issue_key) {
-    return std::async(std::launch::async, [this, issue_key]() {
+    return request_async<std::vector<jira_transition>>(std::format("issue/{}/transitions", issue_key), "GET", "", [](const std::string& response) {
         std::vector<jira_transition> transitions;
-        
-        try {
-            // Make API request
-            std::string response = make_request(std::format("issue/{}/transitions", issue_key));
-            
-            // Parse JSON response
-            auto json_result = glz::read_json<glz::json_t>(response);
-            if (json_result.has_value()) {
-                glz::json_t& json = json_result.value();
-                
-                // Extract transitions
-                for (const auto& transition_json : json["transitions"].get<std::vector<glz::json_t>>()) {
-                    jira_transition transition;
-                    transition.id = transition_json["id"].get<std::string>();
-                    transition.name = transition_json["name"].get<std::string>();
-                    
-                    // Extract to status
-                    auto& to = transition_json["to"];
-                    transition.to_status.id = to["id"].get<std::string>();
-                    transition.to_status.name = to["name"].get<std::string>();
-                    if (to.contains("statusCategory")) {
-                        transition.to_status.category = to["statusCategory"]["name"].get<std::string>();
-                        if (to["statusCategory"].contains("colorName")) {
-                            transition.to_status.color = to["statusCategory"]["colorName"].get<std::string>();
-                        }
-                    }
-                    
-                    transitions.push_back(transition);
-                }
+        if (auto parsed = wire::read<wire::transition_list>(response, "transitions")) {
+            transitions.reserve(parsed->transitions.size());
+            for (auto& transition : parsed->transitions) {
+                transitions.push_back({std::move(transition.id), std::move(transition.name), std::move(transition.to).into()});
             }
-        } catch (const std::exception& e) {
-            JIRA_ERROR_FMT("Error getting JIRA transitions: {}", e.what());
         }
-        
         return transitions;
     });
 }
@@ -577,53 +1039,98 @@ bool jira_model::transition_issue(const std::string& issue_key, const std::strin
 }
 
 // Search for issues using JQL
-std::future<jira_search_result> jira_model::search_issues(const std::string& jql, int start_at, int max_results) {
-    return std::async(std::launch::async, [this, jql, start_at, max_results]() {
-        jira_search_result result;
-        
+std::future<jira_search_result> jira_model::search_issues(const std::string& jql, int start_at, int max_results,
+                                                         jira_projection projection) {
+    try {
+        return request_async<jira_search_result>("search", "POST",
+                                                 search_payload(jql, start_at, max_results,
+                                                                projection == jira_projection::full ? full_fields : list_fields),
+                                                 parse_search_result);
+    } catch (const std::exception& e) {
+        DB_ERROR_FMT("Error searching JIRA issues: {}", e.what());
+        std::promise<jira_search_result> failed;
+        failed.set_value({});
+        return failed.get_future();
+    }
+}
+
+// Start paging through a JQL query
+std::shared_ptr<jira_search_cursor> jira_model::search(std::shared_ptr<jira_model> model, const std::string& jql) {
+    auto cursor = std::make_shared<jira_search_cursor>(std::move(model), jql);
+    cursor->want(0);
+    return cursor;
+}
+
+void jira_search_cursor::want(size_t rows) {
+    std::lock_guard lock(mutex_);
+    wanted_ = std::max(wanted_, rows);
+    fetch_more();
+}
+
+void jira_search_cursor::fetch_more() {
+    while (!stop_.stop_requested() && error_.empty() && in_flight_ < max_in_flight) {
+        if (total_ < 0 ? next_start_ > 0 : next_start_ >= total_) {
+            break;      // the first page (and the total) is still on its way, or all is asked for
+        }
+        if (static_cast<size_t>(next_start_) >= wanted_ + static_cast<size_t>(prefetch_pages * step_)) {
+            break;
+        }
+        auto const start_at = next_start_;
+        next_start_ += step_;
+        ++in_flight_;
         try {
-            // Construct request payload
-            glz::json_t payload;
-            payload["jql"] = jql;
-            payload["startAt"] = start_at;
-            payload["maxResults"] = max_results;
-            
-            // Create array of fields
-            glz::json_t::array_t fields_array;
-            fields_array.push_back("summary");
-            fields_array.push_back("description");
-            fields_array.push_back("status");
-            fields_array.push_back("assignee");
-            fields_array.push_back("reporter");
-            fields_array.push_back("issuetype");
-            fields_array.push_back("created");
-            fields_array.push_back("updated");
-            fields_array.push_back("labels");
-            
-            payload["fields"] = fields_array;
-            
-            std::string json_payload;
-            auto write_error = glz::write_json(payload, json_payload);
-            if (write_error) {
-                throw std::runtime_error(std::format("Failed to serialize JSON payload: {}", glz::format_error(write_error)));
-            }
-            
-            // Make API request
-            std::string response = make_request("search", "POST", json_payload);
-            
-            // Parse JSON response
-            auto result_error = glz::read<glz::opts{.error_on_unknown_keys = false}>(result, response);
+            model_->on_response("search", "POST", search_payload(jql_, start_at, step_),
+                                [weak = weak_from_this(), start_at](std::optional<std::string> response) {
+                if (auto self = weak.lock()) {
+                    self->on_page(start_at, std::move(response));
+                }
+            });
+        } catch (const std::exception& e) {
+            --in_flight_;
+            error_ = std::format("Search error: {}", e.what());
+            JIRA_ERROR_FMT("JQL search error: {}", e.what());
+        }
+    }
+}
 
-            if (result_error) {
-                std::cerr << "Failed to parse search result JSON: " << glz::format_error(result_error) << std::endl;
-                throw std::runtime_error("Failed to parse search result JSON");
+void jira_search_cursor::on_page(int start_at, std::optional<std::string> response) {
+    {
+        std::lock_guard lock(mutex_);
+        --in_flight_;
+        if (stop_.stop_requested()) {
+            return;
+        }
+        if (!response) {
+            error_ = "Search request failed";
+        } else {
+            auto page = jira_model::parse_search_result(*response);
+            if (total_ < 0) {
+                // Servers may give fewer per page than asked: page by what this one gives
+                if (page.max_results > 0 && page.max_results < step_) {
+                    step_ = page.max_results;
+                    next_start_ = start_at + step_;
+                }
             }
-        } catch (const std::exception& e) {
-            DB_ERROR_FMT("Error searching JIRA issues: {}", e.what());
+            total_ = page.total;
+            if (page.issues.empty()) {
+                total_ = std::min(total_, start_at);    // nothing more to be had from here on
+            }
+            auto& cache = jira_issue_cache::instance();
+            auto const profile = model_->cache_profile();
+            for (auto const& issue : page.issues) {
+                cache.put(profile, issue);
+            }
+            early_[start_at] = std::move(page.issues);
+            for (auto next = early_.find(appended_); next != early_.end(); next = early_.find(appended_)) {
+                issues_.insert(issues_.end(), std::make_move_iterator(next->second.begin()),
+                               std::make_move_iterator(next->second.end()));
+                early_.erase(next);
+                appended_ += step_;
+            }
+            fetch_more();
         }
-        
-        return result;
-    });
+    }
+    rouen::helpers::request_redraw();
 }
 
 // Static method to load saved connection profiles
@@ -705,50 +1212,46 @@ std::vector<jira_connection_profile> jira_model::detect_environment_profiles() {
     return environment_profiles;
 }
 
-// Internal method to make JIRA API requests
-std::string jira_model::make_request(const std::string& endpoint, 
-                                   const std::string& method, 
-                                   const std::string& payload) {
+// Build an authenticated JIRA API request
+http::request jira_model::build_request(const std::string& endpoint,
+                                        const std::string& method,
+                                        const std::string& payload) const {
     if (!connected_) {
         throw std::runtime_error("Not connected to JIRA");
     }
     
-    // Don't append /rest/api/X since it's already in the base URL from environment variables
     std::string url = strip_trailing_slash(current_profile_.server_url) + "/" + endpoint;
-    
-    // Log the URL being requested (for debugging)
     DB_INFO_FMT("JIRA API Request: {} {}", method.empty() ? "GET" : method, url);
     
-    // Create authentication string for Basic Auth
-    std::string auth_string = current_profile_.username + ":" + current_profile_.api_token;
-    std::string base64_auth = base64_encode(auth_string);
-    
-    // Create HTTP client
-    http::fetch fetcher;
-    
-    // Set up headers and authentication
-    auto headers = [base64_auth](auto set_header) {
-        set_header("Authorization: Basic " + base64_auth);
-        set_header("Content-Type: application/json");
-        set_header("Accept: application/json");
-    };
+    std::string base64_auth = base64_encode(current_profile_.username + ":" + current_profile_.api_token);
+    auto request = http::fetch{}.make_request(url, {
+        "Authorization: Basic " + base64_auth,
+        "Content-Type: application/json",
+        "Accept: application/json"
+    });
+    if (method == "POST") {
+        request.body = payload;
+    }
+    return request;
+}
+
+// Internal method to make JIRA API requests (blocks the caller until the response arrives)
+std::string jira_model::make_request(const std::string& endpoint, 
+                                   const std::string& method, 
+                                   const std::string& payload) {
+    auto request = build_request(endpoint, method, payload);
+    auto const url = request.url;
     
     // Make the request
-    std::string response;
     try {
-        if (method == "POST") {
-            response = fetcher.post(url, payload, headers);
-        } else {
-            response = fetcher(url, headers);
-        }
+        std::string response = http::engine::instance().get(std::move(request)).get();
         DB_INFO_FMT("JIRA API request successful to {}", url);
+        return response;
     } catch (const std::exception& e) {
         JIRA_ERROR_FMT("JIRA API {} request to '{}' failed: {}", 
                       method.empty() ? "GET" : method, url, e.what());
         throw; // Re-throw to allow the caller to handle it
     }
-    
-    return response;
 }
 
 // Helper to save profiles to disk
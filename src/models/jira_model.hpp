@@ -2,9 +2,13 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <memory>
+#include <functional>
 #include <future>
+#include <mutex>
 #include <optional>
+#include <stop_token>
 #include <unordered_map>
 #include <filesystem>
 #include <fstream>
@@ -54,29 +58,15 @@ struct jira_connection_profile {
     };
 };
 
+// The plain records the cards work with; the server's JSON is read into them by the
+// wire types of jira_model.cpp
+
 // JIRA user representation
 struct jira_user {
     std::string account_id;
     std::string email;
     std::string display_name;
     std::string avatar_url;
-    
-    struct glaze {
-        using T = jira_user;
-        
-        static constexpr auto value = glz::object(
-            "accountId", &T::account_id,
-            "emailAddress", &T::email,
-            "displayName", &T::display_name,
-            "avatarUrls", [](auto& self, auto& value) {
-                // Handle nested avatar URLs if present
-                if (value.contains("48x48")) {
-                    self.avatar_url = value["48x48"].template get<std::string>();
-                }
-                return true;
-            }
-        );
-    };
 };
 
 // JIRA issue type representation
@@ -86,18 +76,6 @@ struct jira_issue_type {
     std::string description;
     std::string icon_url;
     bool is_subtask = false;
-    
-    struct glaze {
-        using T = jira_issue_type;
-        
-        static constexpr auto value = glz::object(
-            "id", &T::id,
-            "name", &T::name,
-            "description", &T::description,
-            "iconUrl", &T::icon_url,
-            "subtask", &T::is_subtask
-        );
-    };
 };
 
 // JIRA status representation
@@ -107,25 +85,6 @@ struct jira_status {
     std::string description;
     std::string category;
     std::string color;
-    
-    struct glaze {
-        using T = jira_status;
-        
-        static constexpr auto value = glz::object(
-            "id", &T::id,
-            "name", &T::name,
-            "description", &T::description,
-            "statusCategory", [](auto& self, auto& value) {
-                if (value.contains("name")) {
-                    self.category = value["name"].template get<std::string>();
-                }
-                if (value.contains("colorName")) {
-                    self.color = value["colorName"].template get<std::string>();
-                }
-                return true;
-            }
-        );
-    };
 };
 
 // JIRA project representation
@@ -138,31 +97,6 @@ struct jira_project {
     std::string url;
     std::string avatar_url;
     std::vector<jira_issue_type> issue_types;
-    
-    struct glaze {
-        using T = jira_project;
-        
-        static constexpr auto value = glz::object(
-            "id", &T::id,
-            "key", &T::key,
-            "name", &T::name,
-            "description", &T::description,
-            "lead", [](auto& self, auto& value) {
-                if (value.contains("displayName")) {
-                    self.lead = value["displayName"].template get<std::string>();
-                }
-                return true;
-            },
-            "self", &T::url,
-            "avatarUrls", [](auto& self, auto& value) {
-                if (value.contains("48x48")) {
-                    self.avatar_url = value["48x48"].template get<std::string>();
-                }
-                return true;
-            },
-            "issueTypes", &T::issue_types
-        );
-    };
 };
 
 // JIRA issue representation
@@ -178,63 +112,37 @@ struct jira_issue {
     std::string created;
     std::string updated;
     std::vector<std::string> labels;
-    
-    struct glaze {
-        using T = jira_issue;
-        
-        static constexpr auto value = glz::object(
-            "id", &T::id,
-            "key", &T::key,
-            "fields", [](auto& self, auto& value) {
-                // Replace glz::is_input with direct property access
-                if (auto it = value.find("summary"); it != value.end()) {
-                    self.summary = it->second.template get<std::string>();
-                }
-                if (auto it = value.find("description"); it != value.end()) {
-                    if (!it->second.is_null()) {
-                        // Handle various description formats (plain text, Atlassian Document Format)
-                        if (it->second.is_string()) {
-                            self.description = it->second.template get<std::string>();
-                        } else if (it->second.is_object()) {
-                            // Try to extract content from Atlassian Document Format
-                            self.description = "ADF document - view in browser";
-                        }
-                    }
-                }
-                if (auto it = value.find("issuetype"); it != value.end()) {
-                    glz::read_json(self.issue_type, it->second);
-                }
-                if (auto it = value.find("status"); it != value.end()) {
-                    glz::read_json(self.status, it->second);
-                }
-                if (auto it = value.find("assignee"); it != value.end()) {
-                    if (!it->second.is_null()) {
-                        glz::read_json(self.assignee, it->second);
-                    }
-                }
-                if (auto it = value.find("reporter"); it != value.end()) {
-                    if (!it->second.is_null()) {
-                        glz::read_json(self.reporter, it->second);
-                    }
-                }
-                if (auto it = value.find("created"); it != value.end()) {
-                    self.created = it->second.template get<std::string>();
-                }
-                if (auto it = value.find("updated"); it != value.end()) {
-                    self.updated = it->second.template get<std::string>();
-                }
-                if (auto it = value.find("labels"); it != value.end()) {
-                    self.labels.clear();
-                    for (const auto& label : it->second) {
-                        self.labels.push_back(label.template get<std::string>());
-                    }
-                }
-                return true;
-            }
-        );
-    };
 };
 
+// A comment on an issue, its body as plain text
+struct jira_comment {
+    std::string id;
+    std::string body;
+    std::string created;
+    std::string updated;
+    jira_user author;
+};
+
+// One field changed in an issue's history
+struct jira_change {
+    std::string author;
+    std::string created;
+    std::string field;
+    std::string from;
+    std::string to;
+};
+
+// What an issue's detail view adds to the list fields, fetched when it opens
+struct jira_issue_details {
+    std::string key;
+    std::string description;
+    std::vector<jira_comment> comments;
+    std::vector<jira_change> changes;      // oldest first
+};
+
+// Which fields a search asks for: what lists show, or everything a jira_issue holds
+enum class jira_projection { list, full };
+
 // Structure for creating new issues
 struct jira_issue_create {
     std::string project_key;
@@ -263,16 +171,6 @@ struct jira_transition {
     std::string id;
     std::string name;
     jira_status to_status;
-    
-    struct glaze {
-        using T = jira_transition;
-        
-        static constexpr auto value = glz::object(
-            "id", &T::id,
-            "name", &T::name,
-            "to", &T::to_status
-        );
-    };
 };
 
 // Search result structure
@@ -281,24 +179,10 @@ struct jira_search_result {
     int max_results = 0;
     int total = 0;
     std::vector<jira_issue> issues;
-    
-    struct glaze {
-        using T = jira_search_result;
-        
-        static constexpr auto value = glz::object(
-            "startAt", &T::start_at,
-            "maxResults", &T::max_results,
-            "total", &T::total,
-            "issues", &T::issues
-        );
-        
-        // Configure options to ignore unknown keys
-        static constexpr auto opt = glz::opts{
-            .error_on_unknown_keys = false
-        };
-    };
 };
 
+class jira_search_cursor;
+
 // JIRA model class to manage API connections and data
 class jira_model {
 public:
@@ -318,15 +202,29 @@ public:
     
     // Issue methods
     std::future<jira_issue> get_issue(const std::string& issue_key);
+    std::future<jira_issue_details> get_issue_details(const std::string& issue_key);
     std::future<std::vector<jira_issue>> get_issues(const std::string& project_key, int max_results = 50);
     std::future<jira_issue> create_issue(const jira_issue_create& issue_data);
+
     std::future<std::vector<jira_transition>> get_transitions(const std::string& issue_key);
     bool transition_issue(const std::string& issue_key, const std::string& transition_id);
     
+    // Local issue cache (see jira_issue_cache): what is on disk now, and a sync with the
+    // server that asks only for what was updated since the last one
+    std::vector<jira_issue> cached_project_issues(const std::string& project_key) const;
+    void sync_project(const std::string& project_key, std::function<void(std::vector<jira_issue>)> done);
+    
     // Search methods
     std::future<jira_search_result> search_issues(const std::string& jql,
                                                  int start_at = 0,
-                                                 int max_results = 50);
+                                                 int max_results = 50,
+                                                 jira_projection projection = jira_projection::list);
+    
+    // Every issue of a JQL query, paged in the background (see jira_search_cursor)
+    static std::shared_ptr<jira_search_cursor> search(std::shared_ptr<jira_model> model, const std::string& jql);
+    
+    // A search response as the server sends it; an empty result if it cannot be read
+    static jira_search_result parse_search_result(const std::string& response);
     
     // Connection profile management
     static std::vector<jira_connection_profile> load_profiles();
@@ -340,17 +238,110 @@ public:
     }
     
 private:
+    friend class jira_search_cursor;
+    struct project_sync;
+    
     // Current connection state
     bool connected_ = false;
     jira_connection_profile current_profile_;
     
+    std::string cache_profile() const;
+    
     // API request helpers
     std::string make_request(const std::string& endpoint, 
                             const std::string& method = "GET",
                             const std::string& data = "");
+    http::request build_request(const std::string& endpoint,
+                                const std::string& method = "GET",
+                                const std::string& data = "") const;
+    void on_response(const std::string& endpoint, const std::string& method, const std::string& data,
+                     std::function<void(std::optional<std::string>)> done);
+    template <typename T, typename Parse>
+    std::future<T> request_async(const std::string& endpoint, const std::string& method,
+                                 const std::string& data, Parse parse);
     
     // Path to stored profiles
     static std::filesystem::path get_profiles_path();
 };
 
-} // namespace rouen::models
\ No newline at end of file
+/**
+ * The issues of a JQL query, as many as the reader gets to. The first page is asked for at
+ * once and the following ones in the background, up to prefetch_pages pages past the last
+ * row the reader wants (want()), at most max_in_flight requests at a time; pages are
+ * appended in order as they arrive. cancel() (the JQL changed) drops whatever is still on
+ * its way. Scrolling through thousands of issues so rarely waits for a page.
+ */
+class jira_search_cursor : public std::enable_shared_from_this<jira_search_cursor> {
+public:
+    static constexpr int page_size = 100;
+    static constexpr int prefetch_pages = 3;
+    static constexpr int max_in_flight = 2;
+    
+    jira_search_cursor(std::shared_ptr<jira_model> model, std::string jql)
+        : model_(std::move(model)), jql_(std::move(jql)) {}
+    
+    ~jira_search_cursor() {
+        stop_.request_stop();
+    }
+    
+    jira_search_cursor(const jira_search_cursor&) = delete;
+    jira_search_cursor& operator=(const jira_search_cursor&) = delete;
+    
+    const std::string& jql() const { return jql_; }
+    
+    // The reader got to `rows`: keep prefetch_pages pages beyond it coming
+    void want(size_t rows);
+    
+    void cancel() {
+        stop_.request_stop();
+    }
+    
+    // Calls f(issues, total) with the issues loaded so far, in query order
+    template <typename F>
+    void read(F&& f) const {
+        std::lock_guard lock(mutex_);
+        f(issues_, total_);
+    }
+    
+    size_t size() const {
+        std::lock_guard lock(mutex_);
+        return issues_.size();
+    }
+    
+    // The query matched that many issues; -1 until the first page is in
+    int total() const {
+        std::lock_guard lock(mutex_);
+        return total_;
+    }
+    
+    bool loading() const {
+        std::lock_guard lock(mutex_);
+        return in_flight_ > 0;
+    }
+    
+    std::string error() const {
+        std::lock_guard lock(mutex_);
+        return error_;
+    }
+    
+private:
+    // Asks for pages while under the caps; called with mutex_ held
+    void fetch_more();
+    void on_page(int start_at, std::optional<std::string> response);
+    
+    std::shared_ptr<jira_model> model_;
+    std::string jql_;
+    std::stop_source stop_;
+    mutable std::mutex mutex_;
+    std::vector<jira_issue> issues_;
+    std::map<int, std::vector<jira_issue>> early_;  // pages that overtook an earlier one, by startAt
+    int total_ = -1;
+    int step_ = page_size;                          // what the server gives per page
+    int next_start_ = 0;                            // of the next page to ask for
+    int appended_ = 0;                              // startAt of the next page to append
+    int in_flight_ = 0;
+    size_t wanted_ = 0;
+    std::string error_;
+};
+
+} // namespace rouen::models
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../helpers/debug.hpp"
+#include "../../helpers/sqlite.hpp"
+#include "../../helpers/write_behind.hpp"
+
+namespace mail {
+    /**
+     * The headers and flags of every message seen, per account and mailbox, so the mail
+     * screen shows a mailbox as soon as it opens and only asks the server what changed.
+     * Rows are keyed by UIDVALIDITY and UID: when the server reports another UIDVALIDITY its
+     * UIDs mean other messages, and reset() drops the old ones. Alongside, the last
+     * HIGHESTMODSEQ, for CONDSTORE servers to send only the flags changed since. Writes go
+     * through write_behind, so a sync of thousands of headers is a few transactions.
+     */
+    class header_store {
+    public:
+        struct stored {
+            long long uid;
+            std::string header;
+            std::string flags;
+        };
+
+        struct mailbox_state {
+            int64_t uidvalidity {0};
+            int64_t highestmodseq {0};
+        };
+
+        static header_store& instance() {
+            static header_store store {"mail_headers.db"};
+            return store;
+        }
+
+        header_store(header_store const&) = delete;
+        header_store& operator=(header_store const&) = delete;
+
+        std::optional<mailbox_state> state(std::string const& account, std::string const& mailbox) {
+            std::optional<mailbox_state> found;
+            try {
+                writes_.flush();
+                db_.for_each_readonly<int64_t, int64_t>("SELECT uidvalidity, highestmodseq FROM mailbox_state WHERE account = ? AND mailbox = ?",
+                    [&found](int64_t uidvalidity, int64_t modseq) { found = mailbox_state{uidvalidity, modseq}; },
+                    account, mailbox);
+            } catch (std::exception const& e) {
+                DB_ERROR_FMT("Mail header store: cannot read state of {}: {}", mailbox, e.what());
+            }
+            return found;
+        }
+
+        // Everything stored under the mailbox's current UIDVALIDITY, in UID order
+        std::vector<stored> load(std::string const& account, std::string const& mailbox) {
+            std::vector<stored> rows;
+            auto const current = state(account, mailbox);
+            if (!current) {
+                return rows;
+            }
+            try {
+                db_.for_each_readonly<int64_t, std::string_view, std::string_view>(
+                    "SELECT uid, header, flags FROM mail_header WHERE account = ? AND mailbox = ? AND uidvalidity = ? ORDER BY uid",
+                    [&rows](int64_t uid, std::string_view header, std::string_view flags) {
+                        rows.push_back({uid, std::string{header}, std::string{flags}});
+                    }, account, mailbox, current->uidvalidity);
+            } catch (std::exception const& e) {
+                DB_ERROR_FMT("Mail header store: cannot load {}: {}", mailbox, e.what());
+            }
+            return rows;
+        }
+
+        // The server's UIDVALIDITY changed (or the mailbox is new here): forget the old UIDs
+        void reset(std::string const& account, std::string const& mailbox, int64_t uidvalidity) {
+            writes_.flush();
+            try {
+                db_.exec("DELETE FROM mail_header WHERE account = ? AND mailbox = ? AND uidvalidity <> ?", nullptr, account, mailbox, uidvalidity);
+                db_.exec("INSERT OR REPLACE INTO mailbox_state (account, mailbox, uidvalidity, highestmodseq) VALUES (?, ?, ?, 0)",
+                    nullptr, account, mailbox, uidvalidity);
+            } catch (std::exception const& e) {
+                DB_ERROR_FMT("Mail header store: cannot reset {}: {}", mailbox, e.what());
+            }
+        }
+
+        void set_modseq(std::string const& account, std::string const& mailbox, int64_t modseq) {
+            writes_.put(std::format("state|{}|{}", account, mailbox), [account, mailbox, modseq](hosting::db::sqlite& db) {
+                db.exec("UPDATE mailbox_state SET highestmodseq = ? WHERE account = ? AND mailbox = ?", nullptr, modseq, account, mailbox);
+            });
+        }
+
+        void put(std::string const& account, std::string const& mailbox, int64_t uidvalidity, long long uid,
+                 std::string_view header, std::string_view flags) {
+            writes_.put(key(account, mailbox, uidvalidity, uid),
+                [account, mailbox, uidvalidity, uid = static_cast<int64_t>(uid), header = std::string{header}, flags = std::string{flags}](hosting::db::sqlite& db) {
+                    db.exec("INSERT OR REPLACE INTO mail_header (account, mailbox, uidvalidity, uid, header, flags) VALUES (?, ?, ?, ?, ?, ?)",
+                        nullptr, account, mailbox, uidvalidity, uid, header, flags);
+                });
+        }
+
+        void set_flags(std::string const& account, std::string const& mailbox, int64_t uidvalidity, long long uid, std::string_view flags) {
+            writes_.put(std::format("{}|flags", key(account, mailbox, uidvalidity, uid)),
+                [account, mailbox, uidvalidity, uid = static_cast<int64_t>(uid), flags = std::string{flags}](hosting::db::sqlite& db) {
+                    db.exec("UPDATE mail_header SET flags = ? WHERE account = ? AND mailbox = ? AND uidvalidity = ? AND uid = ?",
+                        nullptr, flags, account, mailbox, uidvalidity, uid);
+                });
+        }
+
+        void remove(std::string const& account, std::string const& mailbox, int64_t uidvalidity, std::span<long long const> uids) {
+            for (auto const uid : uids) {
+                writes_.put(key(account, mailbox, uidvalidity, uid),
+                    [account, mailbox, uidvalidity, uid = static_cast<int64_t>(uid)](hosting::db::sqlite& db) {
+                        db.exec("DELETE FROM mail_header WHERE account = ? AND mailbox = ? AND uidvalidity = ? AND uid = ?",
+                            nullptr, account, mailbox, uidvalidity, uid);
+                    });
+            }
+        }
+
+    private:
+        explicit header_store(std::string const& path) : db_{path} {
+            db_.ensure_table("mailbox_state",
+                "account TEXT, mailbox TEXT, uidvalidity INTEGER, highestmodseq INTEGER, PRIMARY KEY (account, mailbox)");
+            db_.ensure_table("mail_header",
+                "account TEXT, mailbox TEXT, uidvalidity INTEGER, uid INTEGER, header TEXT, flags TEXT, "
+                "PRIMARY KEY (account, mailbox, uidvalidity, uid)");
+        }
+
+        static std::string key(std::string const& account, std::string const& mailbox, int64_t uidvalidity, long long uid) {
+            return std::format("{}|{}|{}|{}", account, mailbox, uidvalidity, uid);
+        }
+
+        hosting::db::sqlite db_;
+        hosting::db::write_behind writes_ {db_};
+    };
+}
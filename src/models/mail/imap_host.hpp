@@ -1,16 +1,190 @@
 #pragma once
 
+#include <algorithm>
+#include <charconv>
 #include <format>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <thread>
 
 #include <curl/curl.h>
 
+#include "imap_pool.hpp"
+#include "mime.hpp"
+
 namespace mail {
+    /**
+     * Splits the untagged responses of a UID FETCH into messages as the bytes arrive. Each
+     * "* n FETCH (...)" is complete once its parentheses close; literals ({size} then that
+     * many bytes) are skipped whole, so a header holding ")" or a CRLF can't end it early.
+     * For each one the sink gets the UID, the FLAGS list as sent and the first literal.
+     */
+    class fetch_stream {
+    public:
+        using sink_t = std::function<void(long long uid, std::string_view flags, std::string_view literal)>;
+
+        explicit fetch_stream(sink_t sink) : sink_(std::move(sink)) {}
+
+        void feed(std::string_view chunk) {
+            buffer_.append(chunk);
+            size_t consumed = 0;
+            while (consumed < buffer_.size()) {
+                auto const used = take(std::string_view{buffer_}.substr(consumed));
+                if (used == 0) {
+                    break;      // the rest of this response hasn't arrived yet
+                }
+                consumed += used;
+            }
+            buffer_.erase(0, consumed);
+        }
+
+    private:
+        // Bytes used from the front of data: one whole response (or a line that isn't one), 0 for more
+        size_t take(std::string_view data) {
+            auto const eol = data.find("\r\n");
+            if (eol == std::string_view::npos) {
+                return 0;
+            }
+            auto const open = data.find('(');
+            if (!data.starts_with("* ") || open == std::string_view::npos || open > eol
+                || data.substr(0, open).find(" FETCH ") == std::string_view::npos) {
+                return eol + 2;
+            }
+            long long uid = 0;
+            std::string_view flags;
+            std::string_view literal;
+            bool have_literal = false;
+            int depth = 0;
+            size_t pos = open;
+            while (pos < data.size()) {
+                auto const c = data[pos];
+                if (c == '"') {
+                    // A quoted string; backslash escapes the next character
+                    for (++pos; pos < data.size() && data[pos] != '"'; ++pos) {
+                        if (data[pos] == '\\') {
+                            ++pos;
+                        }
+                    }
+                    if (pos >= data.size()) {
+                        return 0;
+                    }
+                    ++pos;
+                } else if (c == '{') {
+                    auto const close = data.find('}', pos);
+                    if (close == std::string_view::npos || close + 3 > data.size()) {
+                        return 0;
+                    }
+                    size_t size = 0;
+                    std::from_chars(data.data() + pos + 1, data.data() + close, size);
+                    auto const start = close + 3;       // past "}\r\n"
+                    if (start + size > data.size()) {
+                        return 0;
+                    }
+                    if (!have_literal) {
+                        literal = data.substr(start, size);
+                        have_literal = true;
+                    }
+                    pos = start + size;
+                } else if (c == '(') {
+                    if (depth == 1 && data.substr(0, pos).ends_with("FLAGS ")) {
+                        auto const close = data.find(')', pos);
+                        if (close == std::string_view::npos) {
+                            return 0;
+                        }
+                        flags = data.substr(pos + 1, close - pos - 1);
+                        pos = close + 1;
+                        continue;
+                    }
+                    ++depth;
+                    ++pos;
+                } else if (c == ')') {
+                    ++pos;
+                    if (--depth == 0) {
+                        auto const end = data.find("\r\n", pos);
+                        if (end == std::string_view::npos) {
+                            return 0;
+                        }
+                        if (uid > 0) {
+                            sink_(uid, flags, literal);
+                        }
+                        return end + 2;
+                    }
+                } else if (depth == 1 && data.substr(pos).starts_with("UID ") && (data[pos - 1] == '(' || data[pos - 1] == ' ')) {
+                    pos += 4;
+                    auto const [end, ec] = std::from_chars(data.data() + pos, data.data() + data.size(), uid);
+                    if (ec != std::errc{}) {
+                        uid = 0;
+                    }
+                    pos = static_cast<size_t>(end - data.data());
+                } else {
+                    ++pos;
+                }
+            }
+            return 0;
+        }
+
+        sink_t sink_;
+        std::string buffer_;
+    };
+
+    /**
+     * Hands on the content of one FETCH BODY[...] literal as its bytes arrive, without ever
+     * holding it: what comes before "{size}\r\n" is buffered until the size is known, then
+     * each chunk goes to the sink as is, and what follows the literal is ignored.
+     */
+    class section_stream {
+    public:
+        using sink_t = std::function<void(std::string_view chunk)>;
+
+        explicit section_stream(sink_t sink) : sink_(std::move(sink)) {}
+
+        void feed(std::string_view chunk) {
+            if (remaining_ == 0 && !done_) {
+                buffer_.append(chunk);
+                auto const body = buffer_.find("BODY[");
+                auto const open = body == std::string::npos ? std::string::npos : buffer_.find('{', body);
+                auto const close = open == std::string::npos ? std::string::npos : buffer_.find("}\r\n", open);
+                if (close == std::string::npos) {
+                    return;
+                }
+                std::from_chars(buffer_.data() + open + 1, buffer_.data() + close, remaining_);
+                done_ = remaining_ == 0;
+                chunk = std::string_view{buffer_}.substr(close + 3);
+                pass(chunk);
+                buffer_.clear();
+                return;
+            }
+            pass(chunk);
+        }
+
+    private:
+        void pass(std::string_view chunk) {
+            if (done_ || remaining_ == 0) {
+                return;
+            }
+            auto const take = std::min(chunk.size(), remaining_);
+            if (take > 0) {
+                sink_(chunk.substr(0, take));
+            }
+            remaining_ -= take;
+            done_ = remaining_ == 0;
+        }
+
+        sink_t sink_;
+        std::string buffer_;
+        size_t remaining_ {0};
+        bool done_ {false};
+    };
+
     class imap_host {
     public:
         imap_host(const std::string& host, const std::string& user, const std::string& password): host_(host), user_(user), password_(password) {
@@ -20,6 +194,7 @@ namespace mail {
             if (!host_.ends_with("/")) {
                 host_ += "/";
             }
+            pool_ = imap_pool::for_account(host_, user_, password_);
             
             // Initialize CURL globally if needed
             static std::once_flag curl_init_flag;
@@ -28,91 +203,308 @@ namespace mail {
             });
         }
 
-        ~imap_host() { 
-            disconnect();
-        }
-        
         std::vector<long long> get_mail_uids() {
-            std::lock_guard lock(mutex_);
-            ensure_connection();
+            return search_uids("UID SEARCH ALL");
+        }
+
+        // UIDs from `first` on: what arrived since the highest UID seen was first - 1
+        std::vector<long long> get_mail_uids_from(long long first) {
+            auto uids = search_uids(std::format("UID SEARCH UID {}:*", first));
+            // "n:*" always matches the highest UID, even when that is below n
+            std::erase_if(uids, [first](long long uid) { return uid < first; });
+            return uids;
+        }
+
+        std::vector<long long> search_uids(std::string const& command) {
+            auto connection = pool_->acquire(imap_pool::lane::sync);
+            auto* curl = connection.get();
             
             std::vector<long long> result;
             std::string single_buffer;
-            auto url = std::format("{}{}/", host_, mailbox_);
-            curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, "UID SEARCH ALL");
-            curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteToString);
-            curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &single_buffer);
-            auto res = curl_easy_perform(curl_);
+            auto url = std::format("{}{}/", host_, mailbox());
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, command.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &single_buffer);
+            auto res = curl_easy_perform(curl);
             if(res != CURLE_OK) {
-                handle_curl_error("get mails failed", res);
+                connection.fail("get mails failed", res);
             }
             // the response will look like * SEARCH 1 2 3 4 5
             if (!single_buffer.starts_with("* SEARCH") || !single_buffer.ends_with("\r\n")) {
                 throw std::runtime_error(std::format("get mails failed: {}", single_buffer));
             }
             std::string_view view(single_buffer.data() + 8, single_buffer.size() - 10); // skip * SEARCH and \r\n
-            if (!view.empty()) { // skip empty results
-                size_t start = 1;
-                for (bool done = false; !done;) {
-                    auto end = view.find(" ", start);
-                    if (end == std::string_view::npos) {
-                        end = view.size();
-                        done = true;
-                    }
-                    result.push_back(std::stoll(std::string(view.substr(start, end - start))));
-                    start = end + 1;
+            for (auto const* pos = view.data(); pos < view.data() + view.size();) {
+                long long uid = 0;
+                auto const [end, ec] = std::from_chars(pos + 1, view.data() + view.size(), uid);   // past the space
+                if (ec != std::errc{}) {
+                    break;
                 }
+                result.push_back(uid);
+                pos = end;
             }
             return result;
         }
 
         std::string get_mail_header(long long uid) {
-            std::lock_guard lock(mutex_);
-            ensure_connection();
+            auto connection = pool_->acquire(imap_pool::lane::bulk);
+            auto* curl = connection.get();
             
             std::string single_buffer;
-            auto url = std::format("{}{}/;UID={};SECTION=HEADER", host_, mailbox_, uid);
-            curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, nullptr);
-            curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteToString);
-            curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &single_buffer);
-            auto res = curl_easy_perform(curl_);
+            auto url = std::format("{}{}/;UID={};SECTION=HEADER", host_, mailbox(), uid);
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, nullptr);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &single_buffer);
+            auto res = curl_easy_perform(curl);
             if(res != CURLE_OK) {
-                handle_curl_error("get mail header failed", res);
+                connection.fail("get mail header failed", res);
             }
             return single_buffer;
         }
 
-        std::string get_mail_body(long long uid) {
+        // UIDs per UID FETCH: a few hundred headers is one round trip and a bounded reply
+        static constexpr size_t header_batch = 500;
+
+        using header_sink_t = std::function<void(long long uid, std::string_view header, std::string_view flags)>;
+
+        /**
+         * Headers (the fields a message reads) and flags of many messages, with one
+         * UID FETCH per header_batch UIDs sent as ranges. The sink sees each message as its
+         * part of the reply arrives, on the calling thread, with the header starting at a
+         * CRLF so message::get_header_field finds its first field too.
+         */
+        void fetch_headers(std::span<long long const> uids, header_sink_t const& sink) {
+            std::vector<long long> sorted(uids.begin(), uids.end());
+            std::sort(sorted.begin(), sorted.end());
+            std::string header;
+            fetch_stream stream {[&sink, &header](long long uid, std::string_view flags, std::string_view literal) {
+                header.assign("\r\n");
+                header.append(literal);
+                sink(uid, header, flags);
+            }};
+
+            auto connection = pool_->acquire(imap_pool::lane::sync);
+            auto* curl = connection.get();
+            auto url = std::format("{}{}/", host_, mailbox());
+            for (size_t first = 0; first < sorted.size(); first += header_batch) {
+                auto const batch = std::span<long long const>{sorted}.subspan(first, std::min(header_batch, sorted.size() - first));
+                auto const cmd = std::format("UID FETCH {} (UID FLAGS BODY.PEEK[HEADER.FIELDS (FROM SUBJECT DATE MESSAGE-ID TO CC REPLY-TO)])",
+                    uid_set(batch));
+                curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, cmd.c_str());
+                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToStream);
+                curl_easy_setopt(curl, CURLOPT_WRITEDATA, &stream);
+                auto res = curl_easy_perform(curl);
+                if (res != CURLE_OK) {
+                    connection.fail("fetch headers failed", res);
+                }
+            }
+        }
+
+        // What the server says about the selected mailbox without selecting it again
+        struct mailbox_status {
+            long long uidvalidity {0};
+            long long uidnext {0};
+            long long highestmodseq {0};    // 0 without CONDSTORE
+        };
+
+        mailbox_status status() {
+            auto const condstore = supports("CONDSTORE");
+            auto connection = pool_->acquire(imap_pool::lane::sync);
+            auto* curl = connection.get();
+            std::string response;
+            auto const cmd = std::format("STATUS \"{}\" (UIDVALIDITY UIDNEXT{})", mailbox(), condstore ? " HIGHESTMODSEQ" : "");
+            curl_easy_setopt(curl, CURLOPT_URL, host_.c_str());
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, cmd.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+            auto res = curl_easy_perform(curl);
+            if (res != CURLE_OK) {
+                connection.fail("mailbox status failed", res);
+            }
+            auto const number = [&response](std::string_view item) {
+                long long value = 0;
+                if (auto const pos = response.find(std::format("{} ", item)); pos != std::string::npos) {
+                    auto const start = response.data() + pos + item.size() + 1;
+                    std::from_chars(start, response.data() + response.size(), value);
+                }
+                return value;
+            };
+            return {number("UIDVALIDITY"), number("UIDNEXT"), number("HIGHESTMODSEQ")};
+        }
+
+        // A capability the server announces, asked once per imap_host
+        bool supports(std::string_view capability) {
             std::lock_guard lock(mutex_);
-            ensure_connection();
-            
-            std::string single_buffer;
-            auto url = std::format("{}{}/;UID={};SECTION=TEXT", host_, mailbox_, uid);
-            curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, nullptr);
-            curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteToString);
-            curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &single_buffer);
-            auto res = curl_easy_perform(curl_);
-            if(res != CURLE_OK) {
-                handle_curl_error("get mail body failed", res);
+            if (capabilities_.empty()) {
+                auto connection = pool_->acquire(imap_pool::lane::sync);
+                auto* curl = connection.get();
+                curl_easy_setopt(curl, CURLOPT_URL, host_.c_str());
+                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "CAPABILITY");
+                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+                curl_easy_setopt(curl, CURLOPT_WRITEDATA, &capabilities_);
+                auto res = curl_easy_perform(curl);
+                if (res != CURLE_OK) {
+                    capabilities_.clear();
+                    connection.fail("capability failed", res);
+                }
+                capabilities_ += ' ';
             }
-            return single_buffer;
+            return capabilities_.find(std::format(" {}", capability)) != std::string::npos;
         }
 
-        void list_mailboxes(auto callback) {
+        using flags_sink_t = std::function<void(long long uid, std::string_view flags)>;
+
+        // CONDSTORE (RFC 7162): the flags of the messages whose mod-sequence passed `modseq`
+        void fetch_flags_changed_since(long long modseq, flags_sink_t const& sink) {
+            fetch_stream stream {[&sink](long long uid, std::string_view flags, std::string_view) { sink(uid, flags); }};
+            auto connection = pool_->acquire(imap_pool::lane::sync);
+            auto* curl = connection.get();
+            auto const url = std::format("{}{}/", host_, mailbox());
+            auto const cmd = std::format("UID FETCH 1:* (UID FLAGS) (CHANGEDSINCE {})", modseq);
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, cmd.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToStream);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &stream);
+            auto res = curl_easy_perform(curl);
+            if (res != CURLE_OK) {
+                connection.fail("fetch changed flags failed", res);
+            }
+        }
+
+        std::string const& host() const { return host_; }
+        std::string const& user() const { return user_; }
+        std::string mailbox() const {
             std::lock_guard lock(mutex_);
-            ensure_connection();
+            return mailbox_;
+        }
+
+        // Sorted UIDs as an IMAP sequence set, runs folded into ranges: 1:4,7,9:12
+        static std::string uid_set(std::span<long long const> sorted) {
+            std::string set;
+            for (size_t i = 0; i < sorted.size();) {
+                auto j = i;
+                while (j + 1 < sorted.size() && sorted[j + 1] == sorted[j] + 1) {
+                    ++j;
+                }
+                if (!set.empty()) {
+                    set += ',';
+                }
+                set += j == i ? std::format("{}", sorted[i]) : std::format("{}:{}", sorted[i], sorted[j]);
+                i = j + 1;
+            }
+            return set;
+        }
+
+        // The MIME parts of a message, read from its BODYSTRUCTURE without fetching any of them
+        std::vector<mime::part> body_structure(long long uid) {
+            auto connection = pool_->acquire(imap_pool::lane::bulk);
+            auto* curl = connection.get();
+            std::string response;
+            auto const url = std::format("{}{}/", host_, mailbox());
+            auto const cmd = std::format("UID FETCH {} (UID BODYSTRUCTURE)", uid);
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, cmd.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+            auto res = curl_easy_perform(curl);
+            if (res != CURLE_OK) {
+                connection.fail("fetch body structure failed", res);
+            }
+            auto const at = response.find("BODYSTRUCTURE ");
+            if (at == std::string::npos) {
+                return {};
+            }
+            return mime::structure_reader::read(std::string_view{response}.substr(at + 14));
+        }
+
+        using chunk_sink_t = std::function<void(std::string_view chunk)>;
+
+        // One part's content, still encoded, streamed to the sink as it arrives; with
+        // `max_bytes`, only that many from its start. BODY.PEEK leaves \Seen alone
+        void fetch_section(long long uid, std::string const& section, size_t max_bytes, chunk_sink_t const& sink) {
+            section_stream stream {sink};
+            auto connection = pool_->acquire(imap_pool::lane::bulk);
+            auto* curl = connection.get();
+            auto const url = std::format("{}{}/", host_, mailbox());
+            auto const cmd = max_bytes > 0
+                ? std::format("UID FETCH {} (BODY.PEEK[{}]<0.{}>)", uid, section, max_bytes)
+                : std::format("UID FETCH {} (BODY.PEEK[{}])", uid, section);
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, cmd.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToSection);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &stream);
+            auto res = curl_easy_perform(curl);
+            if (res != CURLE_OK) {
+                connection.fail("fetch section failed", res);
+            }
+        }
+
+        /**
+         * The text a message reads as, at most `max_chars` of it: only the part worth reading
+         * (plain text, else HTML with the tags dropped) is fetched, partially, and decoded as
+         * it streams. Attachments and the other alternatives never leave the server.
+         */
+        std::string get_text(long long uid, size_t max_chars) {
+            auto const parts = body_structure(uid);
+            auto const* text = mime::text_part(parts);
+            if (!text) {
+                return {};
+            }
+            // Encoded, a character takes up to three bytes (quoted-printable "=XX")
+            auto const max_bytes = text->encoding == "quoted-printable" || text->encoding == "base64" ? max_chars * 3 : max_chars;
+            mime::decoder decode {text->encoding};
+            mime::html_text strip;
+            bool const html = text->subtype == "html";
+            std::string decoded;
+            std::string result;
+            fetch_section(uid, text->section, max_bytes, [&](std::string_view chunk) {
+                if (result.size() >= max_chars) {
+                    return;
+                }
+                decoded.clear();
+                decode.feed(chunk, decoded);
+                if (html) {
+                    strip.feed(decoded, result);
+                } else {
+                    result += decoded;
+                }
+            });
+            if (result.size() > max_chars) {
+                result.resize(max_chars);
+            }
+            return result;
+        }
+
+        // Streams an attachment to `path`, decoded, a chunk at a time
+        void save_part(long long uid, mime::part const& part, std::filesystem::path const& path) {
+            std::ofstream out(path, std::ios::binary);
+            if (!out) {
+                throw std::runtime_error(std::format("cannot write {}", path.string()));
+            }
+            mime::decoder decode {part.encoding};
+            std::string decoded;
+            fetch_section(uid, part.section, 0, [&](std::string_view chunk) {
+                decoded.clear();
+                decode.feed(chunk, decoded);
+                out.write(decoded.data(), static_cast<std::streamsize>(decoded.size()));
+            });
+        }
+
+        void list_mailboxes(auto callback) {
+            auto connection = pool_->acquire(imap_pool::lane::sync);
+            auto* curl = connection.get();
             
-            curl_easy_setopt(curl_, CURLOPT_URL, host_.c_str());
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, "LIST \"\" \"*\"");
-            curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteToString);
+            curl_easy_setopt(curl, CURLOPT_URL, host_.c_str());
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "LIST \"\" \"*\"");
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
             std::string response;
-            curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response);
-            auto res = curl_easy_perform(curl_);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+            auto res = curl_easy_perform(curl);
             if(res != CURLE_OK) {
-                handle_curl_error("list mailboxes failed", res);
+                connection.fail("list mailboxes failed", res);
             }
             
             if (response.empty() || !response.contains("LIST")) {
@@ -139,88 +531,45 @@ namespace mail {
             }
         }
 
+        // Makes sure the account can log in, leaving a connection in the pool for what follows
         void connect() {
-            std::lock_guard lock(mutex_);
-            
-            // Clean up existing connection if any
-            if (curl_ != nullptr) {
-                curl_easy_cleanup(curl_);
-                curl_ = nullptr;
-            }
-            
-            // Initialize a new CURL handle
-            curl_ = curl_easy_init();
-            if (!curl_) {
-                throw std::runtime_error("Failed to initialize CURL");
-            }
-            
-            // Configure CURL with connection options
-            curl_easy_setopt(curl_, CURLOPT_USERNAME, user_.c_str());
-            curl_easy_setopt(curl_, CURLOPT_PASSWORD, password_.c_str());
-            curl_easy_setopt(curl_, CURLOPT_URL, host_.c_str());
-            
-            // Set timeouts to prevent hanging on network issues
-            curl_easy_setopt(curl_, CURLOPT_CONNECTTIMEOUT, 10L);  // 10 seconds connection timeout
-            curl_easy_setopt(curl_, CURLOPT_TIMEOUT, 30L);         // 30 seconds for operation timeout
-            
-            // Enable verbose output for better debugging (only in debug builds)
-            #ifdef DEBUG
-            curl_easy_setopt(curl_, CURLOPT_VERBOSE, 1L);
-            #endif
-            
-            // Check for empty username/password
-            if (user_.empty() || password_.empty()) {
-                throw std::runtime_error("Username or password is empty");
-            }
-            
-            // Test connection
-            auto res = curl_easy_perform(curl_);
-            if (res != CURLE_OK) {
-                handle_curl_error("connect failed", res);
-            }
-            
-            // Mark as connected
-            is_connected_ = true;
+            auto connection = pool_->acquire(imap_pool::lane::sync);
         }
 
+        // Closes the account's idle connections; the next request opens new ones
         void disconnect() {
-            std::lock_guard lock(mutex_);
-            if(curl_) {
-                curl_easy_cleanup(curl_);
-                curl_ = nullptr;
-            }
-            is_connected_ = false;
+            pool_->close_idle();
         }
 
         void delete_message(long long uid) 
         {
-            std::lock_guard lock(mutex_);
-            ensure_connection();
+            auto connection = pool_->acquire(imap_pool::lane::sync);
+            auto* curl = connection.get();
             
             // Construct the IMAP URL for the DELETE operation
-            auto url = std::format("{}{}/;UID={}", host_, mailbox_, uid);
-            curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
+            auto url = std::format("{}{}/;UID={}", host_, mailbox(), uid);
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     
             // First, mark the email as \Deleted
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, std::format("UID STORE {} +FLAGS (\\Deleted)", uid).c_str());
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, std::format("UID STORE {} +FLAGS (\\Deleted)", uid).c_str());
     
             // Prepare response handling
             std::string response;
-            curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteToString);
-            curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
     
             // Execute the request
-            auto res = curl_easy_perform(curl_);
+            auto res = curl_easy_perform(curl);
             if (res != CURLE_OK) {
-                handle_curl_error("Delete message failed", res);
+                connection.fail("Delete message failed", res);
             }
     
             // Now expunge the mailbox to permanently remove deleted messages
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, "EXPUNGE");
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "EXPUNGE");
     
-            res = curl_easy_perform(curl_);
+            res = curl_easy_perform(curl);
             if (res != CURLE_OK) {
-                handle_curl_error("Expunge failed", res);
+                connection.fail("Expunge failed", res);
             }
         }
         
@@ -237,128 +586,106 @@ namespace mail {
                 throw std::runtime_error(std::format("Failed to check mailboxes: {}", e.what()));
             }
             
-            std::lock_guard lock(mutex_);
-            ensure_connection();
+            auto connection = pool_->acquire(imap_pool::lane::sync);
+            auto* curl = connection.get();
             
             if (!mailbox_exists) {
                 // Create the target mailbox if it doesn't exist
                 auto url = host_;
-                curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
+                curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
                 std::string cmd = std::format("CREATE {}", target_mailbox);
-                curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, cmd.c_str());
+                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, cmd.c_str());
                 
                 std::string response;
-                curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteToString);
-                curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response);
+                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+                curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
                 
-                auto res = curl_easy_perform(curl_);
+                auto res = curl_easy_perform(curl);
                 if (res != CURLE_OK) {
-                    handle_curl_error("Create mailbox failed", res);
+                    connection.fail("Create mailbox failed", res);
                 }
             }
 
             // Construct the IMAP URL for the COPY operation
-            auto url = std::format("{}{}/;UID={}", host_, mailbox_, uid);
-            curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
+            auto url = std::format("{}{}/;UID={}", host_, mailbox(), uid);
+            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
             
             // Copy the message to the target mailbox
             std::string cmd = std::format("UID COPY {} {}", uid, target_mailbox);
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, cmd.c_str());
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, cmd.c_str());
             
             // Prepare response handling
             std::string response;
-            curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteToString);
-            curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
             
             // Execute the request
-            auto res = curl_easy_perform(curl_);
+            auto res = curl_easy_perform(curl);
             if (res != CURLE_OK) {
-                handle_curl_error("Move message failed", res);
+                connection.fail("Move message failed", res);
             }
             
             // If copy successful, delete the original message
             // Mark the email as \Deleted
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, std::format("UID STORE {} +FLAGS (\\Deleted)", uid).c_str());
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, std::format("UID STORE {} +FLAGS (\\Deleted)", uid).c_str());
             
-            res = curl_easy_perform(curl_);
+            res = curl_easy_perform(curl);
             if (res != CURLE_OK) {
-                handle_curl_error("Mark for deletion failed", res);
+                connection.fail("Mark for deletion failed", res);
             }
             
             // Now expunge the mailbox to permanently remove deleted messages
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, "EXPUNGE");
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "EXPUNGE");
             
-            res = curl_easy_perform(curl_);
+            res = curl_easy_perform(curl);
             if (res != CURLE_OK) {
-                handle_curl_error("Expunge failed", res);
+                connection.fail("Expunge failed", res);
             }
         }
         
         void select_mailbox(const std::string_view mailbox) {
-            std::lock_guard lock(mutex_);
-            ensure_connection();
+            auto connection = pool_->acquire(imap_pool::lane::sync);
+            auto* curl = connection.get();
             
-            mailbox_ = mailbox;
-            curl_easy_setopt(curl_, CURLOPT_URL, host_.c_str());
-            std::string cmd = std::format("SELECT {}", mailbox_);
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, cmd.c_str());
-            curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteToString);
+            curl_easy_setopt(curl, CURLOPT_URL, host_.c_str());
+            std::string cmd = std::format("SELECT {}", mailbox);
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, cmd.c_str());
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteToString);
             std::string response;
-            curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response);
-            auto res = curl_easy_perform(curl_);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+            auto res = curl_easy_perform(curl);
             if(res != CURLE_OK) {
-                handle_curl_error("select mailbox failed", res);
+                connection.fail("select mailbox failed", res);
             }
             // check if the mailbox is selected
             if (!response.contains("\r\n* OK")) {
                 throw std::runtime_error(std::format("select mailbox failed: {}", response));
             }
+            std::lock_guard lock(mutex_);
+            mailbox_ = mailbox;
         }
         
-        // Check if currently connected
+        // Whether the account has a connection open
         bool is_connected() const {
-            std::lock_guard lock(mutex_);
-            return is_connected_ && curl_ != nullptr;
+            return pool_->open_connections() > 0;
         }
         
     private:
-        // Helper to ensure connection is active before performing operations
-        void ensure_connection() {
-            if (!is_connected_ || curl_ == nullptr) {
-                connect();
-            }
-        }
-        
-        // Helper to handle CURL errors with detailed information
-        void handle_curl_error(const std::string& operation, CURLcode res) {
-            std::string error_msg = std::format("{}: {} ({})", 
-                operation, 
-                curl_easy_strerror(res), 
-                static_cast<int>(res));
-                
-            // Get more detailed error information if available
-            char error_buffer[CURL_ERROR_SIZE] = {0};
-            curl_easy_getinfo(curl_, CURLINFO_PRIVATE, &error_buffer);
-            if (error_buffer[0] != '\0') {
-                error_msg += std::format(" - {}", error_buffer);
-            }
-            
-            // Check if this is a network error that might benefit from reconnection
-            if (res == CURLE_COULDNT_CONNECT || 
-                res == CURLE_OPERATION_TIMEDOUT || 
-                res == CURLE_SSL_CONNECT_ERROR) {
-                // Reset connection state for next attempt
-                is_connected_ = false;
-            }
-            
-            throw std::runtime_error(error_msg);
-        }
-        
         static size_t WriteToVector(void* contents, size_t size, size_t nmemb, std::vector<std::string>* mails) {
             mails->emplace_back(static_cast<char*>(contents), size * nmemb);
             return size * nmemb;
         }
         
+        static size_t WriteToStream(void* contents, size_t size, size_t nmemb, fetch_stream* stream) {
+            stream->feed(std::string_view{static_cast<char*>(contents), size * nmemb});
+            return size * nmemb;
+        }
+
+        static size_t WriteToSection(void* contents, size_t size, size_t nmemb, section_stream* stream) {
+            stream->feed(std::string_view{static_cast<char*>(contents), size * nmemb});
+            return size * nmemb;
+        }
+
         static size_t WriteToString(void* contents, size_t size, size_t nmemb, std::string* str) {
             str->append(static_cast<char*>(contents), size * nmemb);
             return size * nmemb;
@@ -367,10 +694,10 @@ namespace mail {
         std::string host_;
         std::string user_;
         std::string password_;
-        CURL* curl_ {};
+        std::shared_ptr<imap_pool> pool_;
         std::string mailbox_ {"INBOX"};
-        bool is_connected_ {false};
+        std::string capabilities_;      // the CAPABILITY reply, once asked
 
-        mutable std::mutex mutex_;
+        mutable std::mutex mutex_;      // guards mailbox_ and capabilities_
     };
 }
\ No newline at end of file
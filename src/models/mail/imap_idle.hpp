@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <functional>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <curl/curl.h>
+#include <poll.h>
+
+#include "../../helpers/debug.hpp"
+
+namespace mail {
+    /**
+     * A connection of its own per account and mailbox, parked in IMAP IDLE (RFC 2177) so the
+     * server says when mail arrives or goes: on_change gets `exists` for "* n EXISTS" and
+     * `expunged` for "* n EXPUNGE" (and for a reconnect, when anything may have changed).
+     * libcurl has no IDLE, so the connection is opened with CURLOPT_CONNECT_ONLY and spoken
+     * to with curl_easy_send/recv over its TLS. IDLE is renewed before servers drop it
+     * (29 minutes); a lost connection is reopened with a growing delay. It runs on its own
+     * thread, since it waits for as long as the card is open; destruction stops it.
+     */
+    class imap_idle {
+    public:
+        enum class change { exists, expunged };
+        using change_fn = std::function<void(change)>;
+
+        static constexpr auto renew_every = std::chrono::minutes{25};
+        static constexpr auto max_backoff = std::chrono::minutes{5};
+
+        imap_idle(std::string host, std::string user, std::string password, std::string mailbox, change_fn on_change)
+            : host_(std::move(host)), user_(std::move(user)), password_(std::move(password)),
+              mailbox_(std::move(mailbox)), on_change_(std::move(on_change)) {
+            thread_ = std::jthread{[this](std::stop_token stoken) { run(stoken); }};
+        }
+
+        ~imap_idle() {
+            thread_.request_stop();
+        }
+
+        imap_idle(imap_idle const &) = delete;
+        imap_idle &operator=(imap_idle const &) = delete;
+
+        // IDLE is in place: changes are being pushed
+        [[nodiscard]] bool listening() const { return listening_.load(std::memory_order_acquire); }
+
+    private:
+        void run(std::stop_token stoken) {
+            auto backoff = std::chrono::seconds{5};
+            bool reconnecting = false;
+            while (!stoken.stop_requested()) {
+                try {
+                    session(stoken, reconnecting);
+                    backoff = std::chrono::seconds{5};
+                } catch (std::exception const &e) {
+                    listening_ = false;
+                    SYS_WARN_FMT("IMAP IDLE on {} {}: {}", host_, mailbox_, e.what());
+                }
+                close();
+                reconnecting = true;
+                // Sleep in slices so a stop doesn't wait out the backoff
+                for (auto waited = std::chrono::seconds{0}; waited < backoff && !stoken.stop_requested(); waited += std::chrono::seconds{1}) {
+                    std::this_thread::sleep_for(std::chrono::seconds{1});
+                }
+                backoff = std::min<std::chrono::seconds>(backoff * 2, max_backoff);
+            }
+        }
+
+        void session(std::stop_token const &stoken, bool reconnecting) {
+            curl_ = curl_easy_init();
+            if (!curl_) {
+                throw std::runtime_error("Failed to initialize CURL");
+            }
+            curl_easy_setopt(curl_, CURLOPT_URL, host_.c_str());
+            curl_easy_setopt(curl_, CURLOPT_CONNECT_ONLY, 1L);
+            curl_easy_setopt(curl_, CURLOPT_CONNECTTIMEOUT, 10L);
+            if (auto const res = curl_easy_perform(curl_); res != CURLE_OK) {
+                throw std::runtime_error(std::format("connect failed: {}", curl_easy_strerror(res)));
+            }
+            curl_easy_getinfo(curl_, CURLINFO_ACTIVESOCKET, &socket_);
+
+            read_line(stoken, std::chrono::seconds{30});      // the greeting
+            command(stoken, std::format("LOGIN {} {}", quoted(user_), quoted(password_)));
+            command(stoken, std::format("SELECT {}", quoted(mailbox_)));
+            if (reconnecting) {
+                on_change_(change::expunged);   // whatever happened while we were away
+            }
+
+            while (!stoken.stop_requested()) {
+                auto const tag = next_tag();
+                send(std::format("{} IDLE\r\n", tag));
+                if (auto const reply = read_line(stoken, std::chrono::seconds{30}); !reply.starts_with("+")) {
+                    throw std::runtime_error(std::format("IDLE refused: {}", reply));
+                }
+                listening_ = true;
+                auto const renew_at = std::chrono::steady_clock::now() + renew_every;
+                while (!stoken.stop_requested() && std::chrono::steady_clock::now() < renew_at) {
+                    auto const line = read_line(stoken, std::chrono::seconds{1}, true);
+                    if (line.ends_with(" EXISTS")) {
+                        on_change_(change::exists);
+                    } else if (line.ends_with(" EXPUNGE")) {
+                        on_change_(change::expunged);
+                    } else if (line.starts_with("* BYE")) {
+                        throw std::runtime_error(line);
+                    }
+                }
+                send("DONE\r\n");
+                wait_for(stoken, tag);
+            }
+            listening_ = false;
+            send(std::format("{} LOGOUT\r\n", next_tag()));
+        }
+
+        // A command and its tagged OK; anything else throws
+        void command(std::stop_token const &stoken, std::string const &text) {
+            auto const tag = next_tag();
+            send(std::format("{} {}\r\n", tag, text));
+            wait_for(stoken, tag);
+        }
+
+        void wait_for(std::stop_token const &stoken, std::string const &tag) {
+            while (true) {
+                auto const line = read_line(stoken, std::chrono::seconds{30});
+                if (line.empty() && stoken.stop_requested()) {
+                    return;     // closing anyway
+                }
+                if (line.starts_with(tag + " ")) {
+                    if (!line.substr(tag.size() + 1).starts_with("OK")) {
+                        throw std::runtime_error(line.substr(tag.size() + 1));
+                    }
+                    return;
+                }
+            }
+        }
+
+        void send(std::string_view data) {
+            while (!data.empty()) {
+                size_t sent = 0;
+                auto const res = curl_easy_send(curl_, data.data(), data.size(), &sent);
+                if (res == CURLE_AGAIN) {
+                    pollfd pfd {static_cast<int>(socket_), POLLOUT, 0};
+                    ::poll(&pfd, 1, 1000);
+                    continue;
+                }
+                if (res != CURLE_OK) {
+                    throw std::runtime_error(std::format("send failed: {}", curl_easy_strerror(res)));
+                }
+                data.remove_prefix(sent);
+            }
+        }
+
+        // The next line without its CRLF. With `may_time_out`, "" once `timeout` passes quietly
+        std::string read_line(std::stop_token const &stoken, std::chrono::seconds timeout, bool may_time_out = false) {
+            auto const deadline = std::chrono::steady_clock::now() + timeout;
+            while (true) {
+                if (auto const eol = pending_.find("\r\n"); eol != std::string::npos) {
+                    auto line = pending_.substr(0, eol);
+                    pending_.erase(0, eol + 2);
+                    return line;
+                }
+                char buffer[4096];
+                size_t received = 0;
+                auto const res = curl_easy_recv(curl_, buffer, sizeof(buffer), &received);
+                if (res == CURLE_OK && received == 0) {
+                    throw std::runtime_error("connection closed");
+                }
+                if (res == CURLE_OK) {
+                    pending_.append(buffer, received);
+                    continue;
+                }
+                if (res != CURLE_AGAIN) {
+                    throw std::runtime_error(std::format("receive failed: {}", curl_easy_strerror(res)));
+                }
+                if (stoken.stop_requested() || std::chrono::steady_clock::now() >= deadline) {
+                    if (may_time_out || stoken.stop_requested()) {
+                        return {};
+                    }
+                    throw std::runtime_error("timed out");
+                }
+                pollfd pfd {static_cast<int>(socket_), POLLIN, 0};
+                ::poll(&pfd, 1, 250);
+            }
+        }
+
+        void close() {
+            if (curl_) {
+                curl_easy_cleanup(curl_);
+                curl_ = nullptr;
+            }
+            pending_.clear();
+            listening_ = false;
+        }
+
+        std::string next_tag() {
+            return std::format("i{}", ++tag_);
+        }
+
+        static std::string quoted(std::string_view text) {
+            std::string out {"\""};
+            for (auto c : text) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                }
+                out += c;
+            }
+            out += '"';
+            return out;
+        }
+
+        std::string host_;
+        std::string user_;
+        std::string password_;
+        std::string mailbox_;
+        change_fn on_change_;
+        CURL *curl_ {nullptr};
+        curl_socket_t socket_ {CURL_SOCKET_BAD};
+        std::string pending_;       // received, not yet read as lines
+        unsigned tag_ {0};
+        std::atomic<bool> listening_ {false};
+        std::jthread thread_;       // last: stops before the rest goes
+    };
+}
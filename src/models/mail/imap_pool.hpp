@@ -0,0 +1,192 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <curl/curl.h>
+
+namespace mail {
+    /**
+     * The IMAP connections of one account, logged in and kept for whoever asks next. Every
+     * imap_host of the account (a card per mailbox) shares the pool, so their refreshes run
+     * side by side on connections of their own instead of one after another, and libcurl
+     * selects each request's mailbox on whichever connection it gets.
+     *
+     * There are two lanes: `sync` (UID lists, headers, flags, user actions) and `bulk` (bodies,
+     * attachments). Bulk work never takes the last connection the pool could give out, so
+     * a sync always finds one while bodies download. A connection that failed is dropped; one
+     * idle for longer than servers keep them is replaced before use.
+     */
+    class imap_pool {
+    public:
+        enum class lane { sync, bulk };
+
+        static constexpr size_t max_connections = 4;
+        static constexpr auto idle_timeout = std::chrono::minutes{20};
+
+        // A connection lent out; returned to the pool (or dropped, after fail()) on destruction
+        class lease {
+        public:
+            lease(imap_pool& pool, CURL* curl) : pool_(&pool), curl_(curl) {}
+            lease(lease&& other) noexcept : pool_(other.pool_), curl_(other.curl_), broken_(other.broken_) {
+                other.curl_ = nullptr;
+            }
+            lease(lease const&) = delete;
+            lease& operator=(lease const&) = delete;
+            lease& operator=(lease&&) = delete;
+            ~lease() {
+                if (curl_) {
+                    pool_->release(curl_, broken_);
+                }
+            }
+
+            [[nodiscard]] CURL* get() const { return curl_; }
+
+            // Throws for the failed operation; the connection isn't reused
+            [[noreturn]] void fail(std::string const& operation, CURLcode res) {
+                broken_ = true;
+                throw std::runtime_error(std::format("{}: {} ({})", operation, curl_easy_strerror(res), static_cast<int>(res)));
+            }
+
+        private:
+            imap_pool* pool_;
+            CURL* curl_;
+            bool broken_ {false};
+        };
+
+        imap_pool(std::string host, std::string user, std::string password)
+            : host_(std::move(host)), user_(std::move(user)), password_(std::move(password)) {}
+
+        ~imap_pool() {
+            for (auto& idle : idle_) {
+                curl_easy_cleanup(idle.curl);
+            }
+        }
+
+        imap_pool(imap_pool const&) = delete;
+        imap_pool& operator=(imap_pool const&) = delete;
+
+        // The pool of host and user, made on first use and shared while anyone holds it
+        static std::shared_ptr<imap_pool> for_account(std::string const& host, std::string const& user, std::string const& password) {
+            static std::mutex mutex;
+            static std::unordered_map<std::string, std::weak_ptr<imap_pool>> pools;
+            std::lock_guard lock(mutex);
+            auto& slot = pools[std::format("{}|{}", host, user)];
+            if (auto pool = slot.lock()) {
+                return pool;
+            }
+            auto pool = std::make_shared<imap_pool>(host, user, password);
+            slot = pool;
+            return pool;
+        }
+
+        // Waits for a connection of `which` lane, opening one (and logging in) when allowed
+        lease acquire(lane which) {
+            std::unique_lock lock(mutex_);
+            auto const needed = which == lane::bulk ? size_t{2} : size_t{1};
+            available_.wait(lock, [this, needed] { return idle_.size() + (max_connections - open_) >= needed; });
+            CURL* curl = nullptr;
+            if (!idle_.empty()) {
+                auto const idle = idle_.back();
+                idle_.pop_back();
+                if (std::chrono::steady_clock::now() - idle.since < idle_timeout) {
+                    return lease{*this, idle.curl};
+                }
+                curl = idle.curl;       // stale: the server has likely dropped it
+            } else {
+                ++open_;
+            }
+            lock.unlock();
+            if (curl) {
+                curl_easy_cleanup(curl);
+            }
+            try {
+                return lease{*this, open()};
+            } catch (...) {
+                lock.lock();
+                --open_;
+                available_.notify_all();
+                throw;
+            }
+        }
+
+        // Closes the connections nobody is using
+        void close_idle() {
+            std::vector<idle_connection> closing;
+            {
+                std::lock_guard lock(mutex_);
+                closing.swap(idle_);
+                open_ -= closing.size();
+                available_.notify_all();
+            }
+            for (auto& idle : closing) {
+                curl_easy_cleanup(idle.curl);
+            }
+        }
+
+        [[nodiscard]] size_t open_connections() const {
+            std::lock_guard lock(mutex_);
+            return open_;
+        }
+
+    private:
+        struct idle_connection {
+            CURL* curl;
+            std::chrono::steady_clock::time_point since;
+        };
+
+        CURL* open() {
+            if (user_.empty() || password_.empty()) {
+                throw std::runtime_error("Username or password is empty");
+            }
+            auto* curl = curl_easy_init();
+            if (!curl) {
+                throw std::runtime_error("Failed to initialize CURL");
+            }
+            curl_easy_setopt(curl, CURLOPT_USERNAME, user_.c_str());
+            curl_easy_setopt(curl, CURLOPT_PASSWORD, password_.c_str());
+            curl_easy_setopt(curl, CURLOPT_URL, host_.c_str());
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+            // No overall timeout, a large attachment takes what it takes; a stalled one doesn't
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+            curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, 30L);
+            #ifdef DEBUG
+            curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
+            #endif
+            if (auto const res = curl_easy_perform(curl); res != CURLE_OK) {
+                curl_easy_cleanup(curl);
+                throw std::runtime_error(std::format("connect failed: {} ({})", curl_easy_strerror(res), static_cast<int>(res)));
+            }
+            return curl;
+        }
+
+        void release(CURL* curl, bool broken) {
+            {
+                std::lock_guard lock(mutex_);
+                if (!broken) {
+                    idle_.push_back({curl, std::chrono::steady_clock::now()});
+                    available_.notify_all();
+                    return;
+                }
+                --open_;
+                available_.notify_all();
+            }
+            curl_easy_cleanup(curl);
+        }
+
+        std::string host_;
+        std::string user_;
+        std::string password_;
+        mutable std::mutex mutex_;
+        std::condition_variable available_;
+        std::vector<idle_connection> idle_;     // most recently used last
+        size_t open_ {0};                       // idle and lent out
+    };
+}
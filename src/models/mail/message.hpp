@@ -11,6 +11,7 @@
 #include <map>
 #include <glaze/glaze.hpp>
 #include "email_metadata.hpp"
+#include "../../helpers/timestamp.hpp"
 
 namespace mail {
     class message {
@@ -18,11 +19,8 @@ namespace mail {
         message(long long uid, std::string_view header) : uid_{uid}, header_{std::string{header}} {
             title_ = decode_header(get_header_field(header, "Subject"));
             from_ = decode_header(get_header_field(header, "From"));
-            auto date_str = get_header_field(header, "Date");
-            std::tm tm = {};
-            std::istringstream ss{date_str};
-            ss >> std::get_time(&tm, "%a, %d %b %Y %H:%M %z");
-            date_ = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+            // RFC 2822, offset applied; seconds and the day name are optional
+            date_ = timestamp::parse(get_header_field(header, "Date")).value_or(std::chrono::system_clock::time_point{});
         }
 
         static std::string get_header_field(std::string_view header, std::string_view field) {
@@ -203,6 +201,11 @@ namespace mail {
             }
         }
 
+        // The FLAGS list the server sent with the header, e.g. "\Seen \Flagged"
+        void set_flags(std::string_view flags) {
+            seen_ = flags.find("\\Seen") != std::string_view::npos;
+        }
+
         std::string const &metadata() const { return metadata_; }
         std::string const &title() const { return title_; }
         std::string const &from() const { return from_; }
@@ -215,6 +218,7 @@ namespace mail {
         std::set<std::string> const &tags() const { return tags_; }
         const std::map<std::string, std::string>& action_links() const { return action_links_; }
         long long uid() const { return uid_; }
+        bool seen() const { return seen_; }
 
     private:
         long long uid_;
@@ -228,5 +232,6 @@ namespace mail {
         std::set<std::string> tags_;
         std::map<std::string, std::string> action_links_;
         std::chrono::system_clock::time_point date_;
+        bool seen_{true};
     };
 }
\ No newline at end of file
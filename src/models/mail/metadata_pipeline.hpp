@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "../../helpers/email_metadata_analyzer.hpp"
+#include "../../helpers/redraw.hpp"
+#include "../../helpers/task_scheduler.hpp"
+#include "../../registrar.hpp"
+#include "imap_host.hpp"
+#include "message.hpp"
+
+namespace mail {
+    /**
+     * Works out the metadata of the messages on screen, newest first. Messages wait in a queue
+     * ordered by date and at most max_workers background tasks drain it, a batch at a time:
+     * one already in the analyzer's repository is done without its body, the rest have their
+     * text fetched and go to EmailMetadataAnalyzer::generate_metadata_batch(), which packs
+     * the small ones into one model request. Opening a large mailbox so costs a few requests
+     * in flight, not one per message.
+     */
+    class metadata_pipeline {
+    public:
+        static constexpr size_t max_workers = 3;
+        // Of a message's text, what the analysis reads
+        static constexpr size_t text_chars = 16000;
+
+        explicit metadata_pipeline(std::shared_ptr<imap_host> host)
+            : state_(std::make_shared<state>(std::move(host))) {}
+
+        ~metadata_pipeline() {
+            stop_.request_stop();
+        }
+
+        metadata_pipeline(metadata_pipeline const &) = delete;
+        metadata_pipeline &operator=(metadata_pipeline const &) = delete;
+
+        void enqueue(std::shared_ptr<message> msg) {
+            {
+                std::lock_guard lock(state_->mutex);
+                state_->queue.push_back(std::move(msg));
+                std::push_heap(state_->queue.begin(), state_->queue.end(), older);
+                if (state_->workers >= max_workers) {
+                    return;
+                }
+                ++state_->workers;
+            }
+            rouen::helpers::scheduler()->submit([s = state_](std::stop_token stoken) {
+                drain(*s, stoken);
+            }, rouen::helpers::task_priority::background, stop_);
+        }
+
+        // Forgets what is still waiting (another mailbox is shown)
+        void clear() {
+            std::lock_guard lock(state_->mutex);
+            state_->queue.clear();
+        }
+
+        // The metadata of a message already analyzed, without asking anything
+        std::optional<std::string> stored_metadata(std::string const &header) {
+            return state_->analyzer.stored_metadata(header);
+        }
+
+    private:
+        struct state {
+            explicit state(std::shared_ptr<imap_host> host) : host(std::move(host)) {}
+
+            std::shared_ptr<imap_host> host;
+            EmailMetadataAnalyzer analyzer;
+            std::mutex mutex;
+            std::vector<std::shared_ptr<message>> queue;    // a heap, newest on top
+            size_t workers {0};
+        };
+
+        static bool older(std::shared_ptr<message> const &a, std::shared_ptr<message> const &b) {
+            return a->date() < b->date();
+        }
+
+        // Up to a batch of the newest; empty (and one worker less) once the queue is empty
+        static std::vector<std::shared_ptr<message>> take(state &s, std::stop_token const &stoken) {
+            std::lock_guard lock(s.mutex);
+            std::vector<std::shared_ptr<message>> batch;
+            while (!stoken.stop_requested() && !s.queue.empty() && batch.size() < EmailMetadataAnalyzer::batch_max_emails) {
+                std::pop_heap(s.queue.begin(), s.queue.end(), older);
+                batch.push_back(std::move(s.queue.back()));
+                s.queue.pop_back();
+            }
+            if (batch.empty()) {
+                --s.workers;
+            }
+            return batch;
+        }
+
+        static void drain(state &s, std::stop_token const &stoken) {
+            while (true) {
+                auto batch = take(s, stoken);
+                if (batch.empty()) {
+                    return;
+                }
+                std::vector<std::shared_ptr<message>> to_analyze;
+                std::vector<std::string> contents;
+                for (auto &msg : batch) {
+                    if (auto stored = s.analyzer.stored_metadata(msg->header())) {
+                        msg->set_metadata(*stored);
+                        continue;
+                    }
+                    try {
+                        auto body = s.host->get_text(msg->uid(), text_chars);
+                        contents.push_back(std::format("{}\n\n{}", msg->header(), body));
+                        to_analyze.push_back(msg);
+                    } catch (std::exception const &e) {
+                        "notify"_sfn(std::format("Failed to process message UID {}: {}", msg->uid(), e.what()));
+                    }
+                }
+                if (!contents.empty() && !stoken.stop_requested()) {
+                    auto results = s.analyzer.generate_metadata_batch(contents);
+                    for (size_t i = 0; i < to_analyze.size(); ++i) {
+                        to_analyze[i]->set_metadata(results[i]);
+                    }
+                }
+                rouen::helpers::request_redraw();
+            }
+        }
+
+        std::shared_ptr<state> state_;
+        std::stop_source stop_;
+    };
+}
@@ -1,21 +1,41 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <optional>
 #include <format>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <glaze/glaze.hpp>
 
 #include "../../helpers/sqlite.hpp"
+#include "../../helpers/write_behind.hpp"
 #include "email_metadata.hpp"  // Include the EmailMetadata struct definition
 
 namespace mail {
+    /**
+     * Email metadata, kept in SQLite and served from memory. The whole table is read once
+     * when the repository opens, into columns (one vector per field, a row per message) with
+     * the id, category, urgency and tag indexes on top; lookups and filters never query the
+     * database, and store()/remove() update memory right away and SQLite through write_behind.
+     * Every user of a database file shares one repository (open()), so the index is loaded
+     * once and all of them see each other's writes.
+     */
     class MetadataRepository {
     public:
+        static constexpr int max_urgency = 2;
+
         MetadataRepository(const std::string &db_path) : db_{db_path} {
             // Create necessary tables if they don't exist
-            db_.ensure_table("email_metadata", 
+            db_.ensure_table("email_metadata",
                 "id TEXT PRIMARY KEY, "
                 "urgency INTEGER, "
                 "category TEXT, "
@@ -25,9 +45,23 @@ namespace mail {
                 "created_at TEXT DEFAULT (datetime('now')), "
                 "updated_at TEXT DEFAULT (datetime('now'))"
             );
+            load();
+        }
+
+        // The repository of `db_path`, opened on first use and shared while anyone holds it
+        static std::shared_ptr<MetadataRepository> open(const std::string &db_path) {
+            static std::mutex mutex;
+            static std::unordered_map<std::string, std::weak_ptr<MetadataRepository>> opened;
+            std::lock_guard lock(mutex);
+            if (auto existing = opened[db_path].lock()) {
+                return existing;
+            }
+            auto repository = std::make_shared<MetadataRepository>(db_path);
+            opened[db_path] = repository;
+            return repository;
         }
 
-        // Store email metadata in the database (create or update)
+        // Store email metadata (create or update): in memory now, in the database shortly
         bool store(const EmailMetadata& metadata) {
             try {
                 std::string tags_json;
@@ -35,49 +69,35 @@ namespace mail {
                 if (tags_res) {
                     return false;
                 }
-                
+
                 std::string action_links_json;
                 auto action_links_res = glz::write_json(metadata.action_links, action_links_json);
                 if (action_links_res) {
                     return false;
                 }
 
-                // Check if the record already exists
-                bool exists = false;
-                std::string check_sql = "SELECT 1 FROM email_metadata WHERE id = ?";
-                db_.exec(check_sql, [&exists](sqlite3_stmt* ) {
-                    exists = true;
-                }, metadata.id);
+                {
+                    std::unique_lock lock(mutex_);
+                    put_row(metadata);
+                }
 
-                std::string sql;
-                if (exists) {
-                    // Update existing record
-                    sql = "UPDATE email_metadata SET "
-                          "urgency = ?, category = ?, summary = ?, tags = ?, action_links = ?, updated_at = datetime('now') "
-                          "WHERE id = ?";
-                    db_.exec(sql, {}, 
-                        metadata.urgency, 
-                        metadata.category, 
-                        metadata.summary, 
-                        tags_json,
-                        action_links_json,
-                        metadata.id
-                    );
-                } else {
-                    // Insert new record
-                    sql = "INSERT INTO email_metadata "
-                          "(id, urgency, category, summary, tags, action_links) "
-                          "VALUES (?, ?, ?, ?, ?, ?)";
-                    db_.exec(sql, {}, 
-                        metadata.id, 
-                        metadata.urgency, 
-                        metadata.category, 
-                        metadata.summary, 
+                // Queued; a newer analysis of the same message replaces one not written yet
+                writes_.put(metadata.id, [metadata, tags_json = std::move(tags_json), action_links_json = std::move(action_links_json)](hosting::db::sqlite &db) {
+                    db.exec("INSERT INTO email_metadata "
+                            "(id, urgency, category, summary, tags, action_links) "
+                            "VALUES (?, ?, ?, ?, ?, ?) "
+                            "ON CONFLICT(id) DO UPDATE SET "
+                            "urgency = excluded.urgency, category = excluded.category, summary = excluded.summary, "
+                            "tags = excluded.tags, action_links = excluded.action_links, updated_at = datetime('now')", {},
+                        metadata.id,
+                        metadata.urgency,
+                        metadata.category,
+                        metadata.summary,
                         tags_json,
                         action_links_json
                     );
-                }
-                
+                });
+
                 return true;
             } catch (const std::exception& e) {
                 "notify"_sfn(std::format("Failed to store email metadata: {}", e.what()));
@@ -86,207 +106,264 @@ namespace mail {
         }
 
         // Retrieve email metadata by ID
-        std::optional<EmailMetadata> get(const std::string& email_id) {
-            try {
-                std::optional<EmailMetadata> result;
-                
-                std::string sql = "SELECT id, urgency, category, summary, tags, action_links "
-                                  "FROM email_metadata WHERE id = ?";
-                db_.exec(sql, [&result](sqlite3_stmt* stmt) {
-                    EmailMetadata metadata;
-                    metadata.id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-                    metadata.urgency = sqlite3_column_int(stmt, 1);
-                    metadata.category = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-                    metadata.summary = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-                    
-                    // Parse the tags from JSON
-                    const char* tags_json = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-                    if (tags_json && *tags_json) {
-                        auto res = glz::read_json(metadata.tags, tags_json);
-                        if (res) {
-                            // If parsing failed, set a default tag
-                            metadata.tags = {"parse_error"};
-                        }
-                    }
-                    
-                    // Parse the action_links from JSON
-                    const char* action_links_json = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-                    if (action_links_json && *action_links_json) {
-                        auto res = glz::read_json(metadata.action_links, action_links_json);
-                        if (res) {
-                            // If parsing failed, set an empty map
-                            metadata.action_links = {};
-                        }
-                    }
-                    
-                    result = metadata;
-                }, email_id);
-                
-                return result;
-            } catch (const std::exception& e) {
-                "notify"_sfn(std::format("Failed to retrieve email metadata: {}", e.what()));
+        std::optional<EmailMetadata> get(const std::string& email_id) const {
+            std::shared_lock lock(mutex_);
+            auto pos = row_of_.find(email_id);
+            if (pos == row_of_.end()) {
                 return std::nullopt;
             }
+            return row(pos->second);
         }
 
-        // Get emails by category
-        std::vector<EmailMetadata> get_by_category(const std::string& category) {
-            try {
-                std::vector<EmailMetadata> results;
-                
-                std::string sql = "SELECT id, urgency, category, summary, tags, action_links "
-                                  "FROM email_metadata WHERE category = ? "
-                                  "ORDER BY urgency DESC, updated_at DESC";
-                db_.exec(sql, [&results](sqlite3_stmt* stmt) {
-                    EmailMetadata metadata;
-                    metadata.id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-                    metadata.urgency = sqlite3_column_int(stmt, 1);
-                    metadata.category = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-                    metadata.summary = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-                    
-                    // Parse the tags from JSON
-                    const char* tags_json = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-                    if (tags_json && *tags_json) {
-                        auto res = glz::read_json(metadata.tags, tags_json);
-                        if (res) {
-                            // If parsing failed, set a default tag
-                            metadata.tags = {"parse_error"};
-                        }
-                    }
-                    
-                    // Parse the action_links from JSON
-                    const char* action_links_json = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-                    if (action_links_json && *action_links_json) {
-                        auto res = glz::read_json(metadata.action_links, action_links_json);
-                        if (res) {
-                            // If parsing failed, set an empty map
-                            metadata.action_links = {};
-                        }
-                    }
-                    
-                    results.push_back(metadata);
-                }, category);
-                
-                return results;
-            } catch (const std::exception& e) {
-                "notify"_sfn(std::format("Failed to retrieve email metadata by category: {}", e.what()));
+        bool contains(const std::string& email_id) const {
+            std::shared_lock lock(mutex_);
+            return row_of_.contains(email_id);
+        }
+
+        // Get emails by category, most urgent and most recently updated first
+        std::vector<EmailMetadata> get_by_category(const std::string& category) const {
+            std::shared_lock lock(mutex_);
+            auto pos = category_ids_.find(category);
+            if (pos == category_ids_.end()) {
                 return {};
             }
+            std::vector<uint32_t> rows(by_category_[pos->second].begin(), by_category_[pos->second].end());
+            std::sort(rows.begin(), rows.end(), [this](uint32_t a, uint32_t b) {
+                return urgency_[a] != urgency_[b] ? urgency_[a] > urgency_[b] : updated_[a] > updated_[b];
+            });
+            return rows_of(rows);
         }
 
-        // Get emails with a specific tag
-        std::vector<EmailMetadata> get_by_tag(const std::string& tag) {
-            try {
-                std::vector<EmailMetadata> results;
-                
-                // This is a simplified implementation that loads all records and filters in memory
-                // For larger datasets, a more efficient approach would be to use full-text search or a dedicated tags table
-                std::string sql = "SELECT id, urgency, category, summary, tags, action_links FROM email_metadata";
-                db_.exec(sql, [&results, &tag](sqlite3_stmt* stmt) {
-                    // Parse the tags JSON
-                    const char* tags_json = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-                    if (!tags_json || !*tags_json) {
-                        return;
-                    }
-                    
-                    std::vector<std::string> tags;
-                    auto res = glz::read_json(tags, tags_json);
-                    if (res) {
-                        return;
+        // Get emails with a specific tag, most recently updated first
+        std::vector<EmailMetadata> get_by_tag(const std::string& tag) const {
+            std::shared_lock lock(mutex_);
+            auto pos = tag_ids_.find(tag);
+            if (pos == tag_ids_.end()) {
+                return {};
+            }
+            std::vector<uint32_t> rows(by_tag_[pos->second].begin(), by_tag_[pos->second].end());
+            std::sort(rows.begin(), rows.end(), [this](uint32_t a, uint32_t b) { return updated_[a] > updated_[b]; });
+            return rows_of(rows);
+        }
+
+        // Get emails of a given urgency
+        std::vector<EmailMetadata> get_by_urgency(int urgency) const {
+            std::shared_lock lock(mutex_);
+            auto const level = std::clamp(urgency, 0, max_urgency);
+            std::vector<uint32_t> rows(by_urgency_[level].begin(), by_urgency_[level].end());
+            std::sort(rows.begin(), rows.end(), [this](uint32_t a, uint32_t b) { return updated_[a] > updated_[b]; });
+            return rows_of(rows);
+        }
+
+        // Get most recent emails, optionally limited by count
+        std::vector<EmailMetadata> get_recent(int limit = 20) const {
+            std::shared_lock lock(mutex_);
+            std::vector<uint32_t> rows;
+            rows.reserve(row_of_.size());
+            for (auto const& [id, r] : row_of_) {
+                rows.push_back(r);
+            }
+            auto const count = std::min(rows.size(), static_cast<size_t>(std::max(limit, 0)));
+            std::partial_sort(rows.begin(), rows.begin() + count, rows.end(), [this](uint32_t a, uint32_t b) {
+                return created_[a] > created_[b];
+            });
+            rows.resize(count);
+            return rows_of(rows);
+        }
+
+        // The ids with `tag` (any, when empty) and at least `min_urgency`, for filtering
+        std::unordered_set<std::string> ids_matching(const std::string& tag, int min_urgency) const {
+            std::shared_lock lock(mutex_);
+            std::unordered_set<std::string> ids;
+            auto const add_urgent = [&](auto const& rows) {
+                for (auto r : rows) {
+                    if (urgency_[r] >= min_urgency) {
+                        ids.insert(ids_[r]);
                     }
-                    
-                    // Check if the tag is in the list
-                    if (std::find(tags.begin(), tags.end(), tag) != tags.end()) {
-                        EmailMetadata metadata;
-                        metadata.id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-                        metadata.urgency = sqlite3_column_int(stmt, 1);
-                        metadata.category = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-                        metadata.summary = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-                        metadata.tags = tags;
-                        
-                        // Parse the action_links from JSON
-                        const char* action_links_json = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-                        if (action_links_json && *action_links_json) {
-                            auto action_res = glz::read_json(metadata.action_links, action_links_json);
-                            if (action_res) {
-                                // If parsing failed, set an empty map
-                                metadata.action_links = {};
-                            }
-                        }
-                        
-                        results.push_back(metadata);
+                }
+            };
+            if (!tag.empty()) {
+                if (auto pos = tag_ids_.find(tag); pos != tag_ids_.end()) {
+                    add_urgent(by_tag_[pos->second]);
+                }
+                return ids;
+            }
+            for (int level = std::clamp(min_urgency, 0, max_urgency); level <= max_urgency; ++level) {
+                add_urgent(by_urgency_[level]);
+            }
+            return ids;
+        }
+
+        // Every tag in use, with how many emails carry it
+        std::vector<std::pair<std::string, size_t>> tags() const {
+            std::shared_lock lock(mutex_);
+            std::vector<std::pair<std::string, size_t>> result;
+            for (size_t t = 0; t < tag_names_.size(); ++t) {
+                if (!by_tag_[t].empty()) {
+                    result.emplace_back(tag_names_[t], by_tag_[t].size());
+                }
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        // Delete email metadata
+        bool remove(const std::string& email_id) {
+            try {
+                {
+                    std::unique_lock lock(mutex_);
+                    if (auto pos = row_of_.find(email_id); pos != row_of_.end()) {
+                        unindex(pos->second);
+                        free_rows_.push_back(pos->second);
+                        row_of_.erase(pos);
                     }
+                }
+                writes_.put(email_id, [email_id](hosting::db::sqlite &db) {
+                    db.exec("DELETE FROM email_metadata WHERE id = ?", {}, email_id);
                 });
-                
-                return results;
+                return true;
             } catch (const std::exception& e) {
-                "notify"_sfn(std::format("Failed to retrieve email metadata by tag: {}", e.what()));
-                return {};
+                "notify"_sfn(std::format("Failed to delete email metadata: {}", e.what()));
+                return false;
             }
         }
 
-        // Get most recent emails, optionally limited by count
-        std::vector<EmailMetadata> get_recent(int limit = 20) {
+    private:
+        void load() {
             try {
-                std::vector<EmailMetadata> results;
-                
-                std::string sql = std::format(
-                    "SELECT id, urgency, category, summary, tags, action_links "
-                    "FROM email_metadata "
-                    "ORDER BY created_at DESC LIMIT {}",
-                    limit
-                );
-                
-                db_.exec(sql, [&results](sqlite3_stmt* stmt) {
-                    EmailMetadata metadata;
-                    metadata.id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-                    metadata.urgency = sqlite3_column_int(stmt, 1);
-                    metadata.category = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-                    metadata.summary = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-                    
-                    // Parse the tags from JSON
-                    const char* tags_json = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-                    if (tags_json && *tags_json) {
-                        auto res = glz::read_json(metadata.tags, tags_json);
-                        if (res) {
+                std::unique_lock lock(mutex_);
+                db_.for_each_readonly<std::string_view, int64_t, std::string_view, std::string_view, std::string_view, std::string_view>(
+                    "SELECT id, urgency, category, summary, tags, action_links FROM email_metadata ORDER BY created_at, rowid",
+                    [this](std::string_view id, int64_t urgency, std::string_view category, std::string_view summary,
+                           std::string_view tags_json, std::string_view action_links_json) {
+                        EmailMetadata metadata;
+                        metadata.id = std::string{id};
+                        metadata.urgency = static_cast<int>(urgency);
+                        metadata.category = std::string{category};
+                        metadata.summary = std::string{summary};
+                        metadata.tags.clear();
+                        if (!tags_json.empty() && glz::read_json(metadata.tags, tags_json)) {
                             // If parsing failed, set a default tag
                             metadata.tags = {"parse_error"};
                         }
-                    }
-                    
-                    // Parse the action_links from JSON
-                    const char* action_links_json = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-                    if (action_links_json && *action_links_json) {
-                        auto res = glz::read_json(metadata.action_links, action_links_json);
-                        if (res) {
+                        if (!action_links_json.empty() && glz::read_json(metadata.action_links, action_links_json)) {
                             // If parsing failed, set an empty map
                             metadata.action_links = {};
                         }
-                    }
-                    
-                    results.push_back(metadata);
-                });
-                
-                return results;
+                        put_row(metadata);
+                    });
             } catch (const std::exception& e) {
-                "notify"_sfn(std::format("Failed to retrieve recent email metadata: {}", e.what()));
-                return {};
+                "notify"_sfn(std::format("Failed to load email metadata: {}", e.what()));
             }
         }
 
-        // Delete email metadata
-        bool remove(const std::string& email_id) {
-            try {
-                std::string sql = "DELETE FROM email_metadata WHERE id = ?";
-                db_.exec(sql, {}, email_id);
-                return true;
-            } catch (const std::exception& e) {
-                "notify"_sfn(std::format("Failed to delete email metadata: {}", e.what()));
-                return false;
+        static uint32_t intern(std::string const& name, std::unordered_map<std::string, uint32_t>& ids,
+                               std::vector<std::string>& names, std::vector<std::unordered_set<uint32_t>>& index) {
+            auto [pos, added] = ids.try_emplace(name, static_cast<uint32_t>(names.size()));
+            if (added) {
+                names.push_back(name);
+                index.emplace_back();
             }
+            return pos->second;
         }
 
-    private:
+        // Caller holds mutex_ exclusively
+        void put_row(EmailMetadata const& metadata) {
+            uint32_t r;
+            if (auto pos = row_of_.find(metadata.id); pos != row_of_.end()) {
+                r = pos->second;
+                unindex(r);
+            } else {
+                if (!free_rows_.empty()) {
+                    r = free_rows_.back();
+                    free_rows_.pop_back();
+                } else {
+                    r = static_cast<uint32_t>(ids_.size());
+                    ids_.emplace_back();
+                    urgency_.push_back(0);
+                    category_.push_back(0);
+                    summary_.emplace_back();
+                    tags_.emplace_back();
+                    action_links_.emplace_back();
+                    created_.push_back(0);
+                    updated_.push_back(0);
+                }
+                row_of_.emplace(metadata.id, r);
+                created_[r] = ++clock_;
+            }
+            ids_[r] = metadata.id;
+            urgency_[r] = std::clamp(metadata.urgency, 0, max_urgency);
+            category_[r] = intern(metadata.category, category_ids_, category_names_, by_category_);
+            summary_[r] = metadata.summary;
+            tags_[r].clear();
+            for (auto const& tag : metadata.tags) {
+                tags_[r].push_back(intern(tag, tag_ids_, tag_names_, by_tag_));
+            }
+            action_links_[r] = metadata.action_links;
+            updated_[r] = ++clock_;
+
+            by_category_[category_[r]].insert(r);
+            by_urgency_[urgency_[r]].insert(r);
+            for (auto t : tags_[r]) {
+                by_tag_[t].insert(r);
+            }
+        }
+
+        // Caller holds mutex_ exclusively
+        void unindex(uint32_t r) {
+            by_category_[category_[r]].erase(r);
+            by_urgency_[urgency_[r]].erase(r);
+            for (auto t : tags_[r]) {
+                by_tag_[t].erase(r);
+            }
+        }
+
+        EmailMetadata row(uint32_t r) const {
+            EmailMetadata metadata;
+            metadata.id = ids_[r];
+            metadata.urgency = urgency_[r];
+            metadata.category = category_names_[category_[r]];
+            metadata.summary = summary_[r];
+            metadata.tags.clear();
+            for (auto t : tags_[r]) {
+                metadata.tags.push_back(tag_names_[t]);
+            }
+            metadata.action_links = action_links_[r];
+            return metadata;
+        }
+
+        std::vector<EmailMetadata> rows_of(std::vector<uint32_t> const& rows) const {
+            std::vector<EmailMetadata> results;
+            results.reserve(rows.size());
+            for (auto r : rows) {
+                results.push_back(row(r));
+            }
+            return results;
+        }
+
+        mutable std::shared_mutex mutex_;
+        // The columns, one entry per row; rows of removed ids are reused
+        std::vector<std::string> ids_;
+        std::vector<int> urgency_;
+        std::vector<uint32_t> category_;
+        std::vector<std::string> summary_;
+        std::vector<std::vector<uint32_t>> tags_;
+        std::vector<std::map<std::string, std::string>> action_links_;
+        std::vector<uint64_t> created_;     // when each row first appeared, then updated, in store order
+        std::vector<uint64_t> updated_;
+        uint64_t clock_ {0};
+        std::vector<uint32_t> free_rows_;
+        // The indexes
+        std::unordered_map<std::string, uint32_t> row_of_;
+        std::unordered_map<std::string, uint32_t> category_ids_;
+        std::vector<std::string> category_names_;
+        std::vector<std::unordered_set<uint32_t>> by_category_;
+        std::unordered_map<std::string, uint32_t> tag_ids_;
+        std::vector<std::string> tag_names_;
+        std::vector<std::unordered_set<uint32_t>> by_tag_;
+        std::array<std::unordered_set<uint32_t>, max_urgency + 1> by_urgency_;
+
         hosting::db::sqlite db_;
+        hosting::db::write_behind writes_ {db_};
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mail::mime {
+    // A leaf of a message's MIME tree, as BODYSTRUCTURE describes it
+    struct part {
+        std::string section;        // what BODY[...] takes: "1", "2.1", ...
+        std::string type;           // lowercase: "text", "image", ...
+        std::string subtype;        // lowercase: "plain", "html", ...
+        std::map<std::string, std::string> params;     // lowercase names: "charset", "name", ...
+        std::string encoding;       // lowercase: "7bit", "base64", "quoted-printable", ...
+        size_t size {0};            // encoded, in bytes
+        std::string disposition;    // lowercase: "attachment", "inline" or empty
+        std::string filename;
+
+        [[nodiscard]] bool is_attachment() const {
+            return disposition == "attachment" || (!filename.empty() && type != "text");
+        }
+    };
+
+    /**
+     * Decodes a Content-Transfer-Encoding as the bytes arrive: base64 and quoted-printable keep
+     * what a chunk ends in the middle of (a partial quartet, an "=" and its hex digits) for the
+     * next one, so a part is never held whole. Anything else passes through.
+     */
+    class decoder {
+    public:
+        explicit decoder(std::string_view encoding) {
+            if (encoding == "base64") {
+                kind_ = kind::base64;
+            } else if (encoding == "quoted-printable") {
+                kind_ = kind::quoted_printable;
+            }
+        }
+
+        void feed(std::string_view in, std::string &out) {
+            switch (kind_) {
+            case kind::base64: feed_base64(in, out); break;
+            case kind::quoted_printable: feed_quoted_printable(in, out); break;
+            case kind::identity: out.append(in); break;
+            }
+        }
+
+    private:
+        enum class kind { identity, base64, quoted_printable };
+
+        static int base64_value(char c) {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+') return 62;
+            if (c == '/') return 63;
+            return -1;
+        }
+
+        void feed_base64(std::string_view in, std::string &out) {
+            for (auto c : in) {
+                auto const value = base64_value(c);
+                if (value < 0) {
+                    continue;       // line breaks, padding
+                }
+                bits_ = (bits_ << 6) | static_cast<uint32_t>(value);
+                if (++count_ == 4) {
+                    out.push_back(static_cast<char>((bits_ >> 16) & 0xff));
+                    out.push_back(static_cast<char>((bits_ >> 8) & 0xff));
+                    out.push_back(static_cast<char>(bits_ & 0xff));
+                    bits_ = 0;
+                    count_ = 0;
+                }
+            }
+            // A quartet cut short by padding ends the data: flush what it holds
+            if (!in.empty() && in.find('=') != std::string_view::npos && count_ > 1) {
+                bits_ <<= 6 * (4 - count_);
+                out.push_back(static_cast<char>((bits_ >> 16) & 0xff));
+                if (count_ == 3) {
+                    out.push_back(static_cast<char>((bits_ >> 8) & 0xff));
+                }
+                bits_ = 0;
+                count_ = 0;
+            }
+        }
+
+        static int hex_value(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            return -1;
+        }
+
+        void feed_quoted_printable(std::string_view in, std::string &out) {
+            std::string joined;
+            if (!pending_.empty()) {
+                joined = pending_ + std::string{in};
+                in = joined;
+                pending_.clear();
+            }
+            for (size_t i = 0; i < in.size(); ++i) {
+                if (in[i] != '=') {
+                    out.push_back(in[i]);
+                    continue;
+                }
+                if (in.size() - i < 3) {
+                    pending_.assign(in.substr(i));      // "=", "=\r" or "=X": wait for the rest
+                    return;
+                }
+                if (in[i + 1] == '\r' && in[i + 2] == '\n') {
+                    i += 2;         // soft line break
+                } else if (in[i + 1] == '\n') {
+                    i += 1;
+                } else if (auto const high = hex_value(in[i + 1]), low = hex_value(in[i + 2]); high >= 0 && low >= 0) {
+                    out.push_back(static_cast<char>(high * 16 + low));
+                    i += 2;
+                } else {
+                    out.push_back('=');
+                }
+            }
+        }
+
+        kind kind_ {kind::identity};
+        uint32_t bits_ {0};
+        int count_ {0};
+        std::string pending_;
+    };
+
+    // Drops HTML tags from decoded text as it streams, a tag split across chunks included
+    class html_text {
+    public:
+        void feed(std::string_view in, std::string &out) {
+            for (auto c : in) {
+                if (in_tag_) {
+                    in_tag_ = c != '>';
+                } else if (c == '<') {
+                    in_tag_ = true;
+                } else {
+                    out.push_back(c);
+                }
+            }
+        }
+
+    private:
+        bool in_tag_ {false};
+    };
+
+    /**
+     * Reads a BODYSTRUCTURE (RFC 3501 7.4.2) into its leaf parts, numbered the way BODY[...]
+     * wants them; an attached message (message/rfc822) is one leaf. `text` starts at the
+     * opening parenthesis of the structure.
+     */
+    class structure_reader {
+    public:
+        static std::vector<part> read(std::string_view text) {
+            structure_reader reader {text};
+            std::vector<part> parts;
+            if (auto root = reader.value(); root && root->is_list()) {
+                collect(*root, "", parts);
+            }
+            return parts;
+        }
+
+    private:
+        struct node {
+            enum class kind { nil, string, list } what {kind::nil};
+            std::string text;
+            std::vector<node> items;
+
+            [[nodiscard]] bool is_list() const { return what == kind::list; }
+            [[nodiscard]] std::string lower() const {
+                std::string out = text;
+                std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                return out;
+            }
+            [[nodiscard]] node const *at(size_t index) const {
+                return is_list() && index < items.size() ? &items[index] : nullptr;
+            }
+        };
+
+        explicit structure_reader(std::string_view text) : text_(text) {}
+
+        void skip_spaces() {
+            while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\r' || text_[pos_] == '\n')) {
+                ++pos_;
+            }
+        }
+
+        std::optional<node> value() {
+            skip_spaces();
+            if (pos_ >= text_.size()) {
+                return std::nullopt;
+            }
+            node n;
+            auto const c = text_[pos_];
+            if (c == '(') {
+                n.what = node::kind::list;
+                ++pos_;
+                while (true) {
+                    skip_spaces();
+                    if (pos_ >= text_.size()) {
+                        return std::nullopt;
+                    }
+                    if (text_[pos_] == ')') {
+                        ++pos_;
+                        return n;
+                    }
+                    auto item = value();
+                    if (!item) {
+                        return std::nullopt;
+                    }
+                    n.items.push_back(std::move(*item));
+                }
+            }
+            if (c == '"') {
+                n.what = node::kind::string;
+                for (++pos_; pos_ < text_.size() && text_[pos_] != '"'; ++pos_) {
+                    if (text_[pos_] == '\\' && pos_ + 1 < text_.size()) {
+                        ++pos_;
+                    }
+                    n.text.push_back(text_[pos_]);
+                }
+                ++pos_;
+                return n;
+            }
+            if (c == '{') {
+                auto const close = text_.find('}', pos_);
+                size_t size = 0;
+                if (close == std::string_view::npos) {
+                    return std::nullopt;
+                }
+                std::from_chars(text_.data() + pos_ + 1, text_.data() + close, size);
+                pos_ = close + 3;       // past "}\r\n"
+                if (pos_ > text_.size()) {
+                    return std::nullopt;
+                }
+                n.what = node::kind::string;
+                n.text = std::string{text_.substr(pos_, size)};
+                pos_ = std::min(text_.size(), pos_ + size);
+                return n;
+            }
+            auto const end = text_.find_first_of(" ()\r\n", pos_);
+            auto const atom = text_.substr(pos_, end - pos_);
+            pos_ = end == std::string_view::npos ? text_.size() : end;
+            if (atom != "NIL" && atom != "nil") {
+                n.what = node::kind::string;
+                n.text = std::string{atom};
+            }
+            return n;
+        }
+
+        static void collect(node const &body, std::string const &prefix, std::vector<part> &parts) {
+            if (!body.items.empty() && body.items.front().is_list()) {
+                // multipart: the parts, then the subtype and extensions
+                size_t number = 0;
+                for (auto const &item : body.items) {
+                    if (!item.is_list()) {
+                        break;
+                    }
+                    auto const section = prefix.empty() ? std::to_string(++number) : prefix + "." + std::to_string(++number);
+                    collect(item, section, parts);
+                }
+                return;
+            }
+            part p;
+            p.section = prefix.empty() ? "1" : prefix;
+            auto const field = [&body](size_t index) { auto const *n = body.at(index); return n ? n->lower() : std::string{}; };
+            p.type = field(0);
+            p.subtype = field(1);
+            if (auto const *params = body.at(2); params && params->is_list()) {
+                for (size_t i = 0; i + 1 < params->items.size(); i += 2) {
+                    p.params[params->items[i].lower()] = params->items[i + 1].text;
+                }
+            }
+            p.encoding = field(5);
+            auto const size = field(6);
+            std::from_chars(size.data(), size.data() + size.size(), p.size);
+            // Where the disposition is depends on the type's extra basic fields
+            size_t disposition_at = 8;
+            if (p.type == "text") {
+                disposition_at = 9;
+            } else if (p.type == "message" && p.subtype == "rfc822") {
+                disposition_at = 11;
+            }
+            if (auto const *disposition = body.at(disposition_at); disposition && disposition->is_list()) {
+                if (auto const *name = disposition->at(0)) {
+                    p.disposition = name->lower();
+                }
+                if (auto const *params = disposition->at(1); params && params->is_list()) {
+                    for (size_t i = 0; i + 1 < params->items.size(); i += 2) {
+                        if (params->items[i].lower() == "filename") {
+                            p.filename = params->items[i + 1].text;
+                        }
+                    }
+                }
+            }
+            if (p.filename.empty()) {
+                if (auto const name = p.params.find("name"); name != p.params.end()) {
+                    p.filename = name->second;
+                }
+            }
+            parts.push_back(std::move(p));
+        }
+
+        std::string_view text_;
+        size_t pos_ {0};
+    };
+
+    // The part to read a message by: its first plain text body, else its first HTML one
+    inline part const *text_part(std::vector<part> const &parts) {
+        part const *html = nullptr;
+        for (auto const &p : parts) {
+            if (p.type != "text" || p.is_attachment()) {
+                continue;
+            }
+            if (p.subtype == "plain") {
+                return &p;
+            }
+            if (p.subtype == "html" && !html) {
+                html = &p;
+            }
+        }
+        return html;
+    }
+}
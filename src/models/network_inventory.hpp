@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../helpers/debug.hpp"
+#include "../helpers/sqlite.hpp"
+#include "../helpers/write_behind.hpp"
+
+namespace rouen::models {
+
+/**
+ * Every host a subnet scan has found, kept between runs: what it answered on, what it was
+ * called and when it was first and last seen. A rescan starts from here, probing the hosts
+ * known to be up before the rest of the range, and compares what it finds with what was
+ * stored to say what changed. Rows are written through write_behind, so the end of a scan
+ * over a /16 is one transaction.
+ */
+class network_inventory {
+public:
+    struct device {
+        uint32_t address = 0;           // IPv4, host order
+        std::string mac;
+        std::string hostname;
+        std::vector<uint16_t> open_ports;
+        uint8_t seen_by = 0;            // how it was last found, as the scanner's source bits
+        bool online = false;            // whether the last complete scan found it
+        int64_t first_seen = 0;         // seconds since the epoch
+        int64_t last_seen = 0;
+    };
+
+    static network_inventory& instance() {
+        static network_inventory inventory {"network_devices.db"};
+        return inventory;
+    }
+
+    network_inventory(const network_inventory&) = delete;
+    network_inventory& operator=(const network_inventory&) = delete;
+
+    std::vector<device> load() {
+        std::vector<device> devices;
+        try {
+            writes_.flush();
+            db_.for_each_readonly<int64_t, std::string_view, std::string_view, std::string_view, int64_t, int64_t, int64_t, int64_t>(
+                "SELECT address, mac, hostname, open_ports, seen_by, online, first_seen, last_seen FROM network_device ORDER BY address",
+                [&devices](int64_t address, std::string_view mac, std::string_view hostname, std::string_view ports,
+                           int64_t seen_by, int64_t online, int64_t first_seen, int64_t last_seen) {
+                    devices.push_back({static_cast<uint32_t>(address), std::string{mac}, std::string{hostname}, parse_ports(ports),
+                                       static_cast<uint8_t>(seen_by), online != 0, first_seen, last_seen});
+                });
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Network inventory: cannot load devices: {}", e.what());
+        }
+        return devices;
+    }
+
+    void put(const device& d) {
+        std::string ports;
+        for (auto port : d.open_ports) {
+            ports += std::format("{}{}", ports.empty() ? "" : " ", port);
+        }
+        writes_.put(std::format("device|{}", d.address), [d, ports = std::move(ports)](hosting::db::sqlite& db) {
+            db.exec("INSERT OR REPLACE INTO network_device (address, mac, hostname, open_ports, seen_by, online, first_seen, last_seen) "
+                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?)",
+                    nullptr, static_cast<int64_t>(d.address), d.mac, d.hostname, ports, static_cast<int64_t>(d.seen_by),
+                    static_cast<int64_t>(d.online), d.first_seen, d.last_seen);
+        });
+    }
+
+    void clear() {
+        writes_.flush();
+        try {
+            db_.exec("DELETE FROM network_device");
+        } catch (const std::exception& e) {
+            DB_ERROR_FMT("Network inventory: cannot clear devices: {}", e.what());
+        }
+    }
+
+private:
+    explicit network_inventory(const std::string& path) : db_{path} {
+        db_.ensure_table("network_device",
+                         "address INTEGER PRIMARY KEY, mac TEXT, hostname TEXT, open_ports TEXT, seen_by INTEGER, online INTEGER, first_seen INTEGER, last_seen INTEGER");
+    }
+
+    static std::vector<uint16_t> parse_ports(std::string_view text) {
+        std::vector<uint16_t> ports;
+        unsigned port = 0;
+        bool digits = false;
+        for (char c : text) {
+            if (c >= '0' && c <= '9') {
+                port = port * 10 + static_cast<unsigned>(c - '0');
+                digits = true;
+            } else if (digits) {
+                ports.push_back(static_cast<uint16_t>(port));
+                port = 0;
+                digits = false;
+            }
+        }
+        if (digits) {
+            ports.push_back(static_cast<uint16_t>(port));
+        }
+        return ports;
+    }
+
+    hosting::db::sqlite db_;
+    hosting::db::write_behind writes_ {db_};
+};
+
+} // namespace rouen::models
@@ -34,43 +34,58 @@ namespace rouen::models {
             stopCurrentStation();
         }
 
+        /**
+         * Read the "Name=URL" lines of presets.txt, in file order; none when it can't be opened
+         */
+        static std::vector<RadioStation> readPresets() {
+            std::vector<RadioStation> presets;
+            std::ifstream presets_file("presets.txt");
+            if (!presets_file.is_open()) {
+                RADIO_ERROR("Failed to open presets.txt");
+                return presets;
+            }
+
+            std::string line;
+            while (std::getline(presets_file, line)) {
+                // Skip empty lines or comments
+                if (line.empty() || line[0] == '#' || line[0] == '/') {
+                    continue;
+                }
+
+                // Parse "Name=URL" format
+                size_t delimiter_pos = line.find('=');
+                if (delimiter_pos != std::string::npos) {
+                    presets.push_back({line.substr(0, delimiter_pos), line.substr(delimiter_pos + 1), RadioStatus::Stopped});
+                }
+            }
+            return presets;
+        }
+
         /**
          * Load radio station presets from presets.txt file
          */
         void loadPresets() {
             stations.clear();
             station_names.clear();
+            station_keys.clear();
             
             try {
-                // Read presets file
-                std::ifstream presets_file("presets.txt");
-                if (!presets_file.is_open()) {
-                    RADIO_ERROR("Failed to open presets.txt");
-                    return;
-                }
-                
-                std::string line;
-                while (std::getline(presets_file, line)) {
-                    // Skip empty lines or comments
-                    if (line.empty() || line[0] == '#' || line[0] == '/') {
-                        continue;
-                    }
-                    
-                    // Parse "Name=URL" format
-                    size_t delimiter_pos = line.find('=');
-                    if (delimiter_pos != std::string::npos) {
-                        std::string name = line.substr(0, delimiter_pos);
-                        std::string url = line.substr(delimiter_pos + 1);
-                        
-                        // Add to stations map and names vector
-                        RadioStation station{name, url, RadioStatus::Stopped};
-                        stations[name] = station;
-                        station_names.push_back(name);
-                    }
+                for (auto& station : readPresets()) {
+                    // Add to stations map and names vector
+                    station_names.push_back(station.name);
+                    stations[station.name] = std::move(station);
                 }
                 
                 // Sort station names alphabetically for display
                 std::sort(station_names.begin(), station_names.end());
+
+                // Lowercased once here rather than on every filtered frame
+                station_keys.reserve(station_names.size());
+                for (const auto& name : station_names) {
+                    std::string key = name;
+                    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return std::tolower(c); });
+                    station_keys.push_back(std::move(key));
+                }
                 
             } catch (const std::exception& e) {
                 RADIO_ERROR_FMT("Error loading radio presets: {}", e.what());
@@ -86,6 +101,13 @@ namespace rouen::models {
             return station_names;
         }
 
+        /**
+         * Lowercased station names, in the order of getStationNames(), for filtering
+         */
+        const std::vector<std::string>& getStationKeys() const {
+            return station_keys;
+        }
+
         /**
          * Get station by name
          * 
@@ -107,24 +129,38 @@ namespace rouen::models {
          * @return true if successful, false if failed
          */
         bool playStation(const std::string& name) {
-            // Stop any currently playing station
-            stopCurrentStation();
-            
-            // Find the station
             auto it = stations.find(name);
             if (it == stations.end()) {
                 return false;
             }
-            
+            return playUrl(name, it->second.url);
+        }
+
+        /**
+         * Play any stream, e.g. a directory station, under the given name
+         *
+         * @param name Name to show while it plays
+         * @param url Stream URL
+         * @return true if successful, false if failed
+         */
+        bool playUrl(const std::string& name, const std::string& url) {
+            // Stop any currently playing station
+            stopCurrentStation();
+
             // Use media_player to play the station
-            media_item.url = it->second.url;
+            media_item.url = url;
+            auto it = stations.find(name);
             if (media_item.playMedia()) {
                 // Update station status
-                it->second.status = RadioStatus::Playing;
+                if (it != stations.end()) {
+                    it->second.status = RadioStatus::Playing;
+                }
                 current_station = name;
                 return true;
             } else {
-                it->second.status = RadioStatus::Error;
+                if (it != stations.end()) {
+                    it->second.status = RadioStatus::Error;
+                }
                 return false;
             }
         }
@@ -173,9 +209,17 @@ namespace rouen::models {
             return media_item.checkMediaStatus();
         }
 
+        /**
+         * What the stream says is on now (ICY metadata), if anything
+         */
+        std::string getStreamTitle() {
+            return media_item.streamTitle();
+        }
+
     private:
         std::map<std::string, RadioStation> stations;
         std::vector<std::string> station_names;
+        std::vector<std::string> station_keys;
         std::string current_station;
         media_player::item media_item; // Use the media_player helper
     };
@@ -0,0 +1,365 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <glaze/json.hpp>
+
+#include "../helpers/debug.hpp"
+#include "../helpers/fetch.hpp"
+#include "../helpers/sqlite.hpp"
+
+namespace rouen::models {
+
+// One station as the radio-browser API lists it (only the fields kept)
+struct radio_browser_station {
+    std::string stationuuid;
+    std::string name;
+    std::string url_resolved;
+    std::string homepage;
+    std::string tags;
+    std::string country;
+    std::string countrycode;
+    std::string language;
+    std::string codec;
+    int64_t bitrate {0};
+    int64_t votes {0};
+    int64_t clickcount {0};
+    int64_t lastcheckok {0};
+};
+
+/**
+ * The radio-browser.info station directory, mirrored into SQLite and searched through two
+ * FTS5 indexes over it: a word index (name, tags, country, language) for what was typed, the
+ * last word as a prefix, and a trigram index over names for typos, asked only when the words
+ * found too little. Hits are ranked by bm25 less the station's popularity (log of votes and
+ * clicks), so a well-known station beats an obscure one that matches the same way.
+ *
+ * sync() replaces the mirror page by page on the caller's thread (the card runs it on the
+ * scheduler); rows the directory no longer lists are dropped once every page has arrived.
+ */
+class radio_directory {
+public:
+    struct station {
+        int64_t id {0};
+        std::string name;
+        std::string url;
+        std::string tags;
+        std::string country;
+        std::string codec;
+        int64_t bitrate {0};
+        int64_t votes {0};
+    };
+
+    static constexpr auto refresh_after = std::chrono::hours{24 * 7};
+    static constexpr size_t page_size = 10000;
+
+    static radio_directory& instance() {
+        static radio_directory directory {"radio_directory.db"};
+        return directory;
+    }
+
+    radio_directory(const radio_directory&) = delete;
+    radio_directory& operator=(const radio_directory&) = delete;
+
+    [[nodiscard]] bool searchable() const { return searchable_; }
+    [[nodiscard]] bool syncing() const { return syncing_; }
+    [[nodiscard]] size_t synced_so_far() const { return synced_so_far_; }
+
+    [[nodiscard]] int64_t station_count() {
+        int64_t count = 0;
+        try {
+            db_.for_each_readonly<int64_t>("SELECT count(*) FROM station", [&count](int64_t n) { count = n; });
+        } catch (const std::exception& e) {
+            RADIO_ERROR_FMT("Radio directory: cannot count stations: {}", e.what());
+        }
+        return count;
+    }
+
+    // Seconds since the epoch of the last complete sync, 0 if there was none
+    [[nodiscard]] int64_t last_sync() {
+        int64_t when = 0;
+        try {
+            db_.for_each_readonly<int64_t>("SELECT value FROM directory_state WHERE key = 'last_sync'", [&when](int64_t value) { when = value; });
+        } catch (const std::exception& e) {
+            RADIO_ERROR_FMT("Radio directory: cannot read sync state: {}", e.what());
+        }
+        return when;
+    }
+
+    [[nodiscard]] bool stale() {
+        auto const now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        return now - last_sync() > std::chrono::duration_cast<std::chrono::seconds>(refresh_after).count();
+    }
+
+    // Downloads the whole directory; false if a page failed, leaving the previous mirror in place
+    bool sync(std::string_view server = "https://de1.api.radio-browser.info") {
+        if (syncing_.exchange(true)) {
+            return false;
+        }
+        synced_so_far_ = 0;
+        auto const generation = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        bool complete = false;
+        try {
+            for (size_t offset = 0;; offset += page_size) {
+                http::request req;
+                req.url = std::format("{}/json/stations?hidebroken=true&order=stationuuid&offset={}&limit={}", server, offset, page_size);
+                req.headers = {"User-Agent: rouen/1.0"};
+                req.timeout = 120;
+                auto const body = http::engine::instance().get(std::move(req)).get();
+
+                std::vector<radio_browser_station> page;
+                if (auto error = glz::read<glz::opts{.error_on_unknown_keys = false}>(page, body)) {
+                    RADIO_ERROR_FMT("Radio directory: cannot parse page at {}: {}", offset, glz::format_error(error, body));
+                    break;
+                }
+                store(page, generation);
+                synced_so_far_ += page.size();
+                if (page.size() < page_size) {
+                    complete = true;
+                    break;
+                }
+            }
+        } catch (const std::exception& e) {
+            RADIO_ERROR_FMT("Radio directory: sync failed: {}", e.what());
+        }
+        if (complete) {
+            try {
+                db_.exec("DELETE FROM station WHERE generation <> ?", nullptr, generation);
+                db_.exec("INSERT OR REPLACE INTO directory_state (key, value) VALUES ('last_sync', ?)", nullptr, generation);
+                db_.exec("INSERT INTO station_fts (station_fts) VALUES ('optimize')");
+                RADIO_INFO_FMT("Radio directory: {} stations synced", synced_so_far_.load());
+            } catch (const std::exception& e) {
+                RADIO_ERROR_FMT("Radio directory: cannot finish sync: {}", e.what());
+                complete = false;
+            }
+        }
+        syncing_ = false;
+        return complete;
+    }
+
+    // The best `limit` stations for `text`; the most popular ones when it is empty
+    std::vector<station> search(std::string_view text, size_t limit) {
+        std::vector<station> hits;
+        hits.reserve(std::min<size_t>(limit, 256));
+        auto collect = [&hits](int64_t id, std::string_view name, std::string_view url, std::string_view tags,
+                               std::string_view country, std::string_view codec, int64_t bitrate, int64_t votes) {
+            hits.push_back({id, std::string{name}, std::string{url}, std::string{tags}, std::string{country}, std::string{codec}, bitrate, votes});
+        };
+        constexpr std::string_view columns = "s.rowid, s.name, s.url, s.tags, s.country, s.codec, s.bitrate, s.votes";
+        try {
+            auto const expression = match_expression(text);
+            if (expression.empty()) {
+                db_.for_each_readonly<int64_t, std::string_view, std::string_view, std::string_view, std::string_view, std::string_view, int64_t, int64_t>(
+                    std::format("SELECT {} FROM station s ORDER BY s.popularity DESC LIMIT ?", columns), collect, static_cast<int64_t>(limit));
+                return hits;
+            }
+            if (!searchable_) {
+                return hits;
+            }
+            db_.for_each_readonly<int64_t, std::string_view, std::string_view, std::string_view, std::string_view, std::string_view, int64_t, int64_t>(
+                std::format("SELECT {} FROM station_fts JOIN station s ON s.rowid = station_fts.rowid "
+                            "WHERE station_fts MATCH ? "
+                            "ORDER BY bm25(station_fts, 8.0, 2.0, 1.0, 1.0) - s.popularity LIMIT ?", columns),
+                collect, expression, static_cast<int64_t>(limit));
+
+            // Too little for what was typed: names sharing the most trigrams with it, for typos
+            auto const trigrams = trigram_expression(text);
+            if (hits.size() < limit && fuzzy_ && !trigrams.empty()) {
+                std::unordered_set<int64_t> found;
+                for (auto const& hit : hits) {
+                    found.insert(hit.id);
+                }
+                auto const exact = hits.size();
+                db_.for_each_readonly<int64_t, std::string_view, std::string_view, std::string_view, std::string_view, std::string_view, int64_t, int64_t>(
+                    std::format("SELECT {} FROM station_trigram JOIN station s ON s.rowid = station_trigram.rowid "
+                                "WHERE station_trigram MATCH ? "
+                                "ORDER BY bm25(station_trigram) - s.popularity / 4 LIMIT ?", columns),
+                    [&](int64_t id, auto... rest) {
+                        if (!found.contains(id)) {
+                            collect(id, rest...);
+                        }
+                    },
+                    trigrams, static_cast<int64_t>(limit - exact));
+            }
+        } catch (const std::exception& e) {
+            RADIO_ERROR_FMT("Radio directory: search failed: {}", e.what());
+        }
+        return hits;
+    }
+
+private:
+    explicit radio_directory(const std::string& path) : db_{path} {
+        db_.ensure_table("station",
+                         "uuid TEXT UNIQUE, name TEXT, url TEXT, homepage TEXT, tags TEXT, country TEXT, "
+                         "language TEXT, codec TEXT, bitrate INTEGER, votes INTEGER, clicks INTEGER, "
+                         "popularity REAL, generation INTEGER");
+        db_.ensure_table("directory_state", "key TEXT PRIMARY KEY, value INTEGER");
+        db_.exec("CREATE INDEX IF NOT EXISTS station_popularity ON station (popularity DESC)");
+        ensure_search_index();
+    }
+
+    // Same scheme as the RSS item index: external-content FTS5 tables kept in step by triggers
+    void ensure_search_index() {
+        try {
+            db_.exec("CREATE VIRTUAL TABLE IF NOT EXISTS station_fts USING fts5("
+                     "name, tags, country, language, content='station', content_rowid='rowid', "
+                     "tokenize='unicode61 remove_diacritics 2', prefix='2 3')");
+            db_.exec("CREATE TRIGGER IF NOT EXISTS station_fts_insert AFTER INSERT ON station BEGIN "
+                     "INSERT INTO station_fts (rowid, name, tags, country, language) VALUES (new.rowid, new.name, new.tags, new.country, new.language); "
+                     "END");
+            db_.exec("CREATE TRIGGER IF NOT EXISTS station_fts_delete AFTER DELETE ON station BEGIN "
+                     "INSERT INTO station_fts (station_fts, rowid, name, tags, country, language) VALUES ('delete', old.rowid, old.name, old.tags, old.country, old.language); "
+                     "END");
+            db_.exec("CREATE TRIGGER IF NOT EXISTS station_fts_update AFTER UPDATE OF name, tags, country, language ON station BEGIN "
+                     "INSERT INTO station_fts (station_fts, rowid, name, tags, country, language) VALUES ('delete', old.rowid, old.name, old.tags, old.country, old.language); "
+                     "INSERT INTO station_fts (rowid, name, tags, country, language) VALUES (new.rowid, new.name, new.tags, new.country, new.language); "
+                     "END");
+            searchable_ = true;
+        } catch (const std::exception& e) {
+            // e.g. an SQLite built without FTS5: the directory lists by popularity only
+            RADIO_WARN_FMT("Radio directory search unavailable: {}", e.what());
+            return;
+        }
+        try {
+            // The trigram tokenizer needs SQLite 3.34
+            db_.exec("CREATE VIRTUAL TABLE IF NOT EXISTS station_trigram USING fts5("
+                     "name, content='station', content_rowid='rowid', tokenize='trigram')");
+            db_.exec("CREATE TRIGGER IF NOT EXISTS station_trigram_insert AFTER INSERT ON station BEGIN "
+                     "INSERT INTO station_trigram (rowid, name) VALUES (new.rowid, new.name); "
+                     "END");
+            db_.exec("CREATE TRIGGER IF NOT EXISTS station_trigram_delete AFTER DELETE ON station BEGIN "
+                     "INSERT INTO station_trigram (station_trigram, rowid, name) VALUES ('delete', old.rowid, old.name); "
+                     "END");
+            db_.exec("CREATE TRIGGER IF NOT EXISTS station_trigram_update AFTER UPDATE OF name ON station BEGIN "
+                     "INSERT INTO station_trigram (station_trigram, rowid, name) VALUES ('delete', old.rowid, old.name); "
+                     "INSERT INTO station_trigram (rowid, name) VALUES (new.rowid, new.name); "
+                     "END");
+            fuzzy_ = true;
+        } catch (const std::exception& e) {
+            RADIO_WARN_FMT("Radio directory typo matching unavailable: {}", e.what());
+        }
+    }
+
+    // One page in one transaction; a station already stored is rewritten only if it changed
+    void store(std::vector<radio_browser_station> const& page, int64_t generation) {
+        try {
+            db_.exec("BEGIN IMMEDIATE");
+            auto upsert = db_.prepare(
+                "INSERT INTO station (uuid, name, url, homepage, tags, country, language, codec, bitrate, votes, clicks, popularity, generation) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+                "ON CONFLICT (uuid) DO UPDATE SET name = excluded.name, url = excluded.url, homepage = excluded.homepage, "
+                "tags = excluded.tags, country = excluded.country, language = excluded.language, codec = excluded.codec, "
+                "bitrate = excluded.bitrate, votes = excluded.votes, clicks = excluded.clicks, "
+                "popularity = excluded.popularity, generation = excluded.generation");
+            for (auto const& s : page) {
+                if (s.url_resolved.empty() || s.name.empty()) {
+                    continue;
+                }
+                // A station failing its last check sinks below working ones
+                auto const popularity = std::log10(1.0 + static_cast<double>(s.votes) + static_cast<double>(s.clickcount) / 10.0)
+                                      - (s.lastcheckok ? 0.0 : 2.0);
+                upsert.run(nullptr, s.stationuuid, s.name, s.url_resolved, s.homepage, s.tags,
+                           s.country.empty() ? s.countrycode : s.country, s.language, s.codec,
+                           s.bitrate, s.votes, s.clickcount, popularity, generation);
+            }
+            db_.exec("COMMIT");
+        } catch (...) {
+            try {
+                db_.exec("ROLLBACK");
+            } catch (...) {
+                // Ignore rollback errors
+            }
+            throw;
+        }
+    }
+
+    // Every word must match, the last one as a prefix; quoted so FTS5 syntax in the input is literal
+    static std::string match_expression(std::string_view text) {
+        std::string expression;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            auto const start = text.find_first_not_of(" \t\r\n", pos);
+            if (start == std::string_view::npos) {
+                break;
+            }
+            auto end = text.find_first_of(" \t\r\n", start);
+            if (end == std::string_view::npos) {
+                end = text.size();
+            }
+            if (!expression.empty()) {
+                expression += ' ';
+            }
+            expression += '"';
+            for (char c : text.substr(start, end - start)) {
+                if (c == '"') {
+                    expression += '"';
+                }
+                expression += c;
+            }
+            expression += '"';
+            pos = end;
+        }
+        if (!expression.empty()) {
+            expression += '*';
+        }
+        return expression;
+    }
+
+    // Any of the query's three-letter runs, so a name with one letter wrong still shares most of them
+    static std::string trigram_expression(std::string_view text) {
+        std::string lowered;
+        for (char c : text) {
+            lowered += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        std::vector<std::string_view> trigrams;
+        for (size_t i = 0; i + 3 <= lowered.size(); ++i) {
+            auto const trigram = std::string_view{lowered}.substr(i, 3);
+            if (trigram.find_first_of(" \"") == std::string_view::npos &&
+                std::find(trigrams.begin(), trigrams.end(), trigram) == trigrams.end()) {
+                trigrams.push_back(trigram);
+            }
+        }
+        std::string expression;
+        for (auto trigram : trigrams) {
+            expression += std::format("{}\"{}\"", expression.empty() ? "" : " OR ", trigram);
+        }
+        return expression;
+    }
+
+    hosting::db::sqlite db_;
+    bool searchable_ {false};       // the word index exists
+    bool fuzzy_ {false};            // and so does the trigram one
+    std::atomic<bool> syncing_ {false};
+    std::atomic<size_t> synced_so_far_ {0};
+};
+
+} // namespace rouen::models
+
+template <>
+struct glz::meta<rouen::models::radio_browser_station> {
+    using T = rouen::models::radio_browser_station;
+    static constexpr auto value = glz::object(
+        "stationuuid", &T::stationuuid,
+        "name", &T::name,
+        "url_resolved", &T::url_resolved,
+        "homepage", &T::homepage,
+        "tags", &T::tags,
+        "country", &T::country,
+        "countrycode", &T::countrycode,
+        "language", &T::language,
+        "codec", &T::codec,
+        "bitrate", &T::bitrate,
+        "votes", &T::votes,
+        "clickcount", &T::clickcount,
+        "lastcheckok", &T::lastcheckok
+    );
+};
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../../helpers/debug.hpp"
+#include "../../helpers/fetch.hpp"
+#include "../../helpers/task_scheduler.hpp"
+#include "sqliterepo.hpp"
+
+namespace media::rss
+{
+    /**
+     * Podcast enclosures downloaded ahead of playback, so episodes start at once and play
+     * through flaky connections.
+     *
+     * One download runs at a time on the shared HTTP engine, at most `max_rate` bytes per
+     * second, into a ".part" file next to where the episode goes. An interrupted download
+     * resumes from what that file holds with a Range request, later in the session or in the
+     * next one. Past `max_bytes` on disk, finished episodes are deleted least recently used
+     * first. The repository records every file, so nothing is lost across restarts.
+     */
+    class episodes
+    {
+    public:
+        struct limits
+        {
+            uint64_t max_bytes {2ull << 30};    // disk taken by episodes, partial ones included
+            uint64_t max_rate {1ull << 20};     // bytes per second over all downloads, 0 for no limit
+        };
+
+        episodes(sqliterepo &repo, std::filesystem::path directory, limits limit)
+            : shared_{std::make_shared<shared>()}
+        {
+            shared_->repo = &repo;
+            shared_->directory = std::move(directory);
+            shared_->limit = limit;
+        }
+
+        // The running download is cancelled; its partial file is resumed next time
+        ~episodes()
+        {
+            http::engine::transfer running;
+            {
+                std::lock_guard<std::mutex> lock(shared_->mutex);
+                shared_->repo = nullptr;
+                shared_->queue.clear();
+                running = std::exchange(shared_->transfer, {});
+            }
+            running.cancel();
+        }
+
+        episodes(episodes const &) = delete;
+        episodes &operator=(episodes const &) = delete;
+
+        // Reads what is on disk from the repository and resumes the partial downloads.
+        // Does file and database I/O: call it off the UI thread, once.
+        void load()
+        {
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            auto &s = *shared_;
+            if (!s.repo) {
+                return;
+            }
+            std::error_code ec;
+            std::filesystem::create_directories(s.directory, ec);
+            std::vector<std::string> missing;
+            s.repo->scan_episodes([&s, &missing](const char *url, const char *path, long long bytes, bool complete, long long used) {
+                entry e {path, static_cast<uint64_t>(std::max(bytes, 0LL)), complete, used};
+                std::error_code ec;
+                if (complete && !std::filesystem::exists(e.path, ec)) {
+                    missing.emplace_back(url);
+                    return;
+                }
+                if (!complete) {
+                    auto const part = part_path(e.path);
+                    e.bytes = std::filesystem::exists(part, ec) ? std::filesystem::file_size(part, ec) : 0;
+                    s.queue.emplace_back(url);
+                }
+                s.entries.insert_or_assign(url, std::move(e));
+            });
+            for (auto const &url : missing) {
+                s.repo->delete_episode(url);
+            }
+            RSS_INFO_FMT("{} downloaded episodes, {} to resume", s.entries.size() - s.queue.size(), s.queue.size());
+            start(shared_);
+        }
+
+        // The downloaded copy of `url`, marked as just used; nullopt until it is complete
+        std::optional<std::filesystem::path> local_file(std::string const &url)
+        {
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            auto pos = shared_->entries.find(url);
+            if (pos == shared_->entries.end() || !pos->second.complete || !shared_->repo) {
+                return std::nullopt;
+            }
+            auto &e = pos->second;
+            e.used = now();
+            shared_->repo->save_episode(url, e.path.string(), static_cast<long long>(e.bytes), true, e.used);
+            return e.path;
+        }
+
+        // Downloads these enclosures, in order, after those already queued. Episodes on disk are
+        // skipped; partial downloads that stopped earlier in the session are retried after them.
+        void prefetch(std::vector<std::string> const &urls)
+        {
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            auto &s = *shared_;
+            for (auto const &url : urls) {
+                if (url.empty() || s.entries.contains(url)) {
+                    continue;
+                }
+                s.entries.emplace(url, entry{file_for(s.directory, url), 0, false, now()});
+                s.queue.push_back(url);
+            }
+            for (auto const &[url, e] : s.entries) {
+                if (!e.complete && url != s.running && s.failures[url] < max_failures &&
+                    std::find(s.queue.begin(), s.queue.end(), url) == s.queue.end()) {
+                    s.queue.push_back(url);
+                }
+            }
+            start(shared_);
+        }
+
+    private:
+        struct entry
+        {
+            std::filesystem::path path;     // where the finished episode is kept
+            uint64_t bytes {0};             // on disk, finished or not
+            bool complete {false};
+            long long used {0};             // seconds since the epoch it was played or fetched
+        };
+
+        // Appends a response body to the partial file, refusing to outgrow the disk budget
+        class part_file : public http::body_sink
+        {
+        public:
+            part_file(std::filesystem::path const &path, uint64_t offset, uint64_t max_bytes)
+                : out_{path, std::ios::binary | std::ios::app}, offset_{offset}, max_bytes_{max_bytes} {}
+
+            [[nodiscard]] bool is_open() const { return out_.is_open(); }
+
+            bool write(std::string_view chunk) override
+            {
+                if (max_bytes_ && offset_ + written_ + chunk.size() > max_bytes_) {
+                    too_large_ = true;
+                    return false;
+                }
+                out_.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                written_ += chunk.size();
+                return static_cast<bool>(out_);
+            }
+
+            void close() { out_.close(); }
+
+            [[nodiscard]] uint64_t offset() const { return offset_; }
+            [[nodiscard]] bool too_large() const { return too_large_; }
+
+        private:
+            std::ofstream out_;
+            uint64_t offset_;
+            uint64_t written_ {0};
+            uint64_t max_bytes_;
+            bool too_large_ {false};
+        };
+
+        struct shared
+        {
+            std::mutex mutex;
+            std::unordered_map<std::string, entry> entries;
+            std::deque<std::string> queue;
+            std::unordered_map<std::string, int> failures;  // this session's, by url
+            std::string running;                            // the url being downloaded, if any
+            http::engine::transfer transfer;
+            sqliterepo *repo {nullptr};                     // null once the manager is gone
+            std::filesystem::path directory;
+            limits limit;
+        };
+
+        static constexpr int max_failures = 3;
+        static constexpr long transfer_timeout = 3 * 60 * 60;  // seconds; a stalled transfer resumes later
+
+        static long long now()
+        {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        static std::filesystem::path part_path(std::filesystem::path path)
+        {
+            path += ".part";
+            return path;
+        }
+
+        // A name from the url's hash, keeping a plausible extension so players can tell the format
+        static std::filesystem::path file_for(std::filesystem::path const &directory, std::string const &url)
+        {
+            std::string_view path = url;
+            path = path.substr(0, path.find_first_of("?#"));
+            std::string extension;
+            if (auto const dot = path.rfind('.'); dot != std::string_view::npos && path.find('/', dot) == std::string_view::npos) {
+                auto const candidate = path.substr(dot + 1);
+                if (!candidate.empty() && candidate.size() <= 5 &&
+                    std::all_of(candidate.begin(), candidate.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)); })) {
+                    extension = "." + std::string{candidate};
+                }
+            }
+            return directory / std::format("{:016x}{}", std::hash<std::string>{}(url), extension);
+        }
+
+        // Starts the next queued download unless one is running. Caller holds the mutex.
+        static void start(std::shared_ptr<shared> const &s)
+        {
+            while (s->repo && s->running.empty() && !s->queue.empty()) {
+                auto url = std::move(s->queue.front());
+                s->queue.pop_front();
+                auto pos = s->entries.find(url);
+                if (pos == s->entries.end() || pos->second.complete) {
+                    continue;
+                }
+                auto &e = pos->second;
+                auto const part = part_path(e.path);
+                std::error_code ec;
+                uint64_t const have = std::filesystem::exists(part, ec) ? std::filesystem::file_size(part, ec) : 0;
+                auto sink = std::make_shared<part_file>(part, ec ? 0 : have, s->limit.max_bytes);
+                if (!sink->is_open()) {
+                    RSS_ERROR_FMT("Cannot write {}", part.string());
+                    ++s->failures[url];
+                    continue;
+                }
+                e.bytes = sink->offset();
+                s->repo->save_episode(url, e.path.string(), static_cast<long long>(e.bytes), false, e.used);
+
+                http::request request;
+                request.url = url;
+                request.timeout = transfer_timeout;
+                request.connect_timeout = 15;
+                request.coalesce = false;
+                request.range_from = sink->offset();
+                request.max_recv_speed = s->limit.max_rate;
+                request.sink = sink.get();
+                RSS_INFO_FMT("Downloading episode {} from byte {}", url, sink->offset());
+                s->running = url;
+                // The I/O thread only hands the outcome over: files and the repository are handled on the scheduler
+                s->transfer = http::engine::instance().submit(std::move(request), [s, url, sink](http::response response) {
+                    rouen::helpers::scheduler()->submit([s, url, sink, response = std::move(response)](std::stop_token) {
+                        finished(s, url, *sink, response);
+                    }, rouen::helpers::task_priority::background);
+                });
+            }
+        }
+
+        static void finished(std::shared_ptr<shared> const &s, std::string const &url, part_file &sink, http::response const &response)
+        {
+            sink.close();
+            std::lock_guard<std::mutex> lock(s->mutex);
+            s->running.clear();
+            s->transfer = {};
+            auto pos = s->entries.find(url);
+            if (!s->repo || pos == s->entries.end()) {
+                return;     // shutting down: the partial file is resumed next time
+            }
+            auto &e = pos->second;
+            auto const part = part_path(e.path);
+            std::error_code ec;
+            if (response.ok() && !sink.too_large()) {
+                std::filesystem::rename(part, e.path, ec);
+                if (!ec) {
+                    e.complete = true;
+                    e.bytes = std::filesystem::file_size(e.path, ec);
+                    e.used = now();
+                    s->repo->save_episode(url, e.path.string(), static_cast<long long>(e.bytes), true, e.used);
+                    RSS_INFO_FMT("Episode {} downloaded ({} bytes)", url, e.bytes);
+                    evict(*s, url);
+                }
+            } else if (sink.too_large()) {
+                RSS_WARN_FMT("Episode {} is larger than the episode cache, not keeping it", url);
+                std::filesystem::remove(part, ec);
+                s->repo->delete_episode(url);
+                s->failures[url] = max_failures;
+                s->entries.erase(pos);
+            } else if (sink.offset() > 0 && (response.status == 200 || response.status == 416)) {
+                // The server ignored or refused the range: start over from the first byte
+                RSS_WARN_FMT("Cannot resume {} (HTTP {}), downloading it again", url, response.status);
+                std::filesystem::remove(part, ec);
+                e.bytes = 0;
+                if (++s->failures[url] < max_failures) {
+                    s->queue.push_front(url);
+                }
+            } else {
+                if (response.status >= 400) {
+                    std::filesystem::resize_file(part, sink.offset(), ec);  // drop the error page
+                }
+                e.bytes = std::filesystem::exists(part, ec) ? std::filesystem::file_size(part, ec) : 0;
+                s->repo->save_episode(url, e.path.string(), static_cast<long long>(e.bytes), false, e.used);
+                ++s->failures[url];
+                RSS_WARN_FMT("Episode download {} stopped at {} bytes: {}", url, e.bytes, response.error);
+            }
+            start(s);
+        }
+
+        // Deletes finished episodes, least recently used first, until the budget is met.
+        // `keep` (the one just downloaded) stays. Caller holds the mutex.
+        static void evict(shared &s, std::string const &keep)
+        {
+            uint64_t total = 0;
+            for (auto const &[url, e] : s.entries) {
+                total += e.bytes;
+            }
+            while (total > s.limit.max_bytes) {
+                auto oldest = s.entries.end();
+                for (auto pos = s.entries.begin(); pos != s.entries.end(); ++pos) {
+                    if (pos->second.complete && pos->first != keep &&
+                        (oldest == s.entries.end() || pos->second.used < oldest->second.used)) {
+                        oldest = pos;
+                    }
+                }
+                if (oldest == s.entries.end()) {
+                    break;
+                }
+                RSS_INFO_FMT("Evicting episode {} ({} bytes)", oldest->first, oldest->second.bytes);
+                std::error_code ec;
+                std::filesystem::remove(oldest->second.path, ec);
+                s.repo->delete_episode(oldest->first);
+                total -= oldest->second.bytes;
+                s.entries.erase(oldest);
+            }
+        }
+
+        std::shared_ptr<shared> shared_;
+    };
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "tinyxml2.h" // Changed from <tinyxml2.h> to "tinyxml2.h" for macOS compatibility
+
+namespace media::rss
+{
+    // A feed to subscribe to, as an import lists it
+    struct subscription
+    {
+        std::string url;
+        std::string title;  // empty when the list does not name it
+    };
+
+    /**
+     * The feeds in an OPML document (every <outline xmlUrl=…>, at any depth) or in a plain
+     * list with one URL per line, where blank lines and lines starting with '#' are skipped.
+     * Whatever does not start with '<' is read as a plain list.
+     */
+    inline std::vector<subscription> parse_subscriptions(std::string_view document)
+    {
+        std::vector<subscription> result;
+        auto const first = document.find_first_not_of(" \t\r\n\xEF\xBB\xBF");
+        if (first != std::string_view::npos && document[first] == '<') {
+            tinyxml2::XMLDocument doc;
+            if (doc.Parse(document.data(), document.size()) != tinyxml2::XML_SUCCESS) {
+                return result;
+            }
+            auto const body = doc.RootElement() ? doc.RootElement()->FirstChildElement("body") : nullptr;
+            auto collect = [&result](auto &self, tinyxml2::XMLElement const *parent) -> void {
+                for (auto outline = parent->FirstChildElement("outline"); outline; outline = outline->NextSiblingElement("outline")) {
+                    if (auto url = outline->Attribute("xmlUrl"); url && *url) {
+                        auto title = outline->Attribute("title");
+                        if (!title || !*title) {
+                            title = outline->Attribute("text");
+                        }
+                        result.push_back({url, title ? title : ""});
+                    }
+                    self(self, outline);    // categories nest their feeds
+                }
+            };
+            if (body) {
+                collect(collect, body);
+            }
+            return result;
+        }
+
+        size_t pos = 0;
+        while (pos < document.size()) {
+            auto end = document.find('\n', pos);
+            if (end == std::string_view::npos) {
+                end = document.size();
+            }
+            auto line = document.substr(pos, end - pos);
+            pos = end + 1;
+            auto const start = line.find_first_not_of(" \t\r");
+            if (start == std::string_view::npos || line[start] == '#') {
+                continue;
+            }
+            line = line.substr(start, line.find_last_not_of(" \t\r") - start + 1);
+            result.push_back({std::string{line}, {}});
+        }
+        return result;
+    }
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace media::rss
+{
+    /**
+     * When each feed should be fetched next.
+     *
+     * A feed is checked about four times per observed publishing interval (the median gap
+     * between its newest items), never more often than its <ttl> / sy:updatePeriod asks,
+     * and less and less often the longer it goes without a new item. Due times carry ±10%
+     * jitter so feeds loaded together drift apart.
+     */
+    class schedule
+    {
+    public:
+        using clock = std::chrono::system_clock;
+
+        static constexpr auto min_interval = std::chrono::seconds{5 * 60};
+        static constexpr auto max_interval = std::chrono::seconds{24 * 60 * 60};
+        static constexpr auto default_interval = std::chrono::seconds{60 * 60};   // no history yet
+        static constexpr int checks_per_cadence = 4;
+        static constexpr int staleness_divisor = 8;     // quiet for N days: check every N/8 days
+
+        struct entry
+        {
+            clock::time_point due {};
+            clock::time_point checked {};       // last successful fetch
+            clock::time_point changed {};       // newest item seen
+            std::chrono::seconds interval {0};
+            int failures {0};
+            bool running {false};
+        };
+
+        // What a finished fetch tells about the feed
+        struct outcome
+        {
+            bool ok {false};
+            bool modified {false};                          // false for a 304
+            std::chrono::seconds declared {0};              // feed::declared_interval()
+            std::vector<clock::time_point> item_dates;      // publish dates of the items received
+        };
+
+        // Adds a feed with its persisted history; a feed already scheduled keeps its entry
+        void add(std::string const &url, clock::time_point checked, clock::time_point changed, std::chrono::seconds interval)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entry e;
+            e.checked = checked;
+            e.changed = changed;
+            e.interval = interval;
+            e.due = checked.time_since_epoch().count() ? checked + jittered(interval) : clock::now();
+            entries_.try_emplace(url, e);
+        }
+
+        // Fetch as soon as a slot frees up (a fetch already running counts)
+        void refresh_now(std::string const &url)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto &e = entries_[url];
+            if (!e.running) {
+                e.due = clock::now();
+            }
+        }
+
+        void forget(std::string const &url)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entries_.erase(url);
+        }
+
+        // Up to `limit` feeds that are due, earliest first; they stay out of later calls until completed()
+        std::vector<std::string> take_due(clock::time_point now, size_t limit)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<std::pair<clock::time_point, std::string const *>> due;
+            for (auto const &[url, e] : entries_) {
+                if (!e.running && e.due <= now) {
+                    due.emplace_back(e.due, &url);
+                }
+            }
+            std::sort(due.begin(), due.end());
+            std::vector<std::string> result;
+            for (size_t i = 0; i < due.size() && i < limit; ++i) {
+                auto &e = entries_[*due[i].second];
+                e.running = true;
+                result.push_back(*due[i].second);
+            }
+            return result;
+        }
+
+        // Plans the next fetch of `url` after one finished; returns the entry to persist
+        std::optional<entry> completed(std::string const &url, outcome const &result, clock::time_point started)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto pos = entries_.find(url);
+            if (pos == entries_.end()) {
+                return std::nullopt;    // deleted meanwhile
+            }
+            auto &e = pos->second;
+            auto const now = clock::now();
+            e.running = false;
+            if (!result.ok) {
+                // Back off exponentially from the usual interval
+                e.failures = std::min(e.failures + 1, 8);
+                auto const base = std::max<std::chrono::seconds>(e.interval, min_interval);
+                e.due = now + jittered(std::min<std::chrono::seconds>(max_interval, base * (1 << e.failures)));
+                return e;
+            }
+            e.failures = 0;
+            e.checked = now;
+
+            auto cadence = std::chrono::seconds{0};
+            if (result.modified) {
+                // Items without a date were stamped with the parse time: leave them out
+                std::vector<clock::time_point> dates;
+                std::copy_if(result.item_dates.begin(), result.item_dates.end(), std::back_inserter(dates),
+                             [started](auto date) { return date < started; });
+                if (!dates.empty()) {
+                    e.changed = std::max(e.changed, *std::max_element(dates.begin(), dates.end()));
+                }
+                cadence = median_gap(std::move(dates));
+            }
+            auto const quiet = e.changed.time_since_epoch().count() && now > e.changed
+                ? std::chrono::duration_cast<std::chrono::seconds>(now - e.changed)
+                : std::chrono::seconds{0};
+            e.interval = plan(cadence, result.declared, quiet, e.interval);
+            e.due = now + jittered(e.interval);
+            return e;
+        }
+
+        static std::chrono::seconds plan(std::chrono::seconds cadence, std::chrono::seconds declared,
+                                         std::chrono::seconds quiet, std::chrono::seconds previous)
+        {
+            auto interval = cadence.count() > 0 ? cadence / checks_per_cadence
+                : previous.count() > 0 ? previous : default_interval;
+            interval = std::max(interval, declared);
+            interval = std::max(interval, quiet / staleness_divisor);
+            return std::clamp<std::chrono::seconds>(interval, min_interval, max_interval);
+        }
+
+    private:
+        // Median gap between the newest (up to 20) distinct publish dates; 0 with fewer than two
+        static std::chrono::seconds median_gap(std::vector<clock::time_point> dates)
+        {
+            std::sort(dates.begin(), dates.end(), std::greater<>{});
+            dates.erase(std::unique(dates.begin(), dates.end()), dates.end());
+            dates.resize(std::min<size_t>(dates.size(), 20));
+            if (dates.size() < 2) {
+                return std::chrono::seconds{0};
+            }
+            std::vector<std::chrono::seconds> gaps;
+            for (size_t i = 1; i < dates.size(); ++i) {
+                gaps.push_back(std::chrono::duration_cast<std::chrono::seconds>(dates[i - 1] - dates[i]));
+            }
+            std::nth_element(gaps.begin(), gaps.begin() + static_cast<std::ptrdiff_t>(gaps.size() / 2), gaps.end());
+            return gaps[gaps.size() / 2];
+        }
+
+        clock::duration jittered(std::chrono::seconds interval)
+        {
+            std::uniform_real_distribution<double> spread(0.9, 1.1);
+            return std::chrono::duration_cast<clock::duration>(interval * spread(random_));
+        }
+
+        std::mutex mutex_;
+        std::unordered_map<std::string, entry> entries_;
+        std::mt19937 random_ {std::random_device{}()};
+    };
+}
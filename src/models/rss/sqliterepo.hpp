@@ -1,11 +1,17 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
+#include <cstdint>
+#include <initializer_list>
 #include <mutex>
 #include <iostream>
 #include <chrono>
+#include <optional>
+#include <tuple>
+#include <utility>
 
 #include "../../helpers/sqlite.hpp"
 #include "../../helpers/debug.hpp"
@@ -41,15 +47,46 @@ namespace media::rss
                     "FOREIGN KEY(feed_id) REFERENCES feed(id) ON DELETE CASCADE"
                 );
                 
+                // Rows written before content hashes existed get one on their next refresh
+                db_.ensure_column("item", "content_hash", "INTEGER");
+                
+                // When each feed was last fetched and how often it is checked (see schedule.hpp)
+                db_.ensure_table("feed_schedule",
+                    "url TEXT PRIMARY KEY, "
+                    "checked INTEGER, "
+                    "changed INTEGER, "
+                    "interval INTEGER"
+                );
+                
+                // Article summaries by item link (see summarizer.hpp)
+                db_.ensure_table("item_summary",
+                    "link TEXT PRIMARY KEY, "
+                    "summary TEXT, "
+                    "created INTEGER"
+                );
+                
+                // Downloaded enclosures, complete or partial, by how recently they were used (see episodes.hpp)
+                db_.ensure_table("episode",
+                    "url TEXT PRIMARY KEY, "
+                    "path TEXT, "
+                    "bytes INTEGER, "
+                    "complete INTEGER, "
+                    "used INTEGER"
+                );
+                
                 // Create indexes for faster lookups
                 RSS_DEBUG("Creating indexes...");
-                db_.exec("CREATE INDEX IF NOT EXISTS idx_item_feed_id ON item(feed_id)");
+                // Serves both lookups by feed and the keyset pages of scan_items_page()
+                db_.exec("CREATE INDEX IF NOT EXISTS idx_item_feed_date ON item(feed_id, pub_date, link)");
+                db_.exec("DROP INDEX IF EXISTS idx_item_feed_id");
                 db_.exec("CREATE INDEX IF NOT EXISTS idx_item_pub_date ON item(pub_date)");
                 RSS_DEBUG("SQLite repo setup complete");
             } catch (const std::exception& e) {
                 RSS_ERROR_FMT("Error setting up SQLite repo: {}", e.what());
                 // Indexes already exist or another error occurred - continue anyway
             }
+            
+            ensure_search_index();
         }
 
         long long upsert_feed(std::string_view url, std::string_view title, std::string_view image_url)
@@ -85,33 +122,112 @@ namespace media::rss
             return result;
         }
 
-        // New method to batch-insert items for better performance
-        void batch_upsert_items(long long feed_id, const std::vector<std::tuple<std::string, std::string, std::string, std::string, std::string, std::string>>& items)
+        // Adds the (url, title) feeds not stored yet, in one transaction. Returns the new row ids
+        // in the order of `feeds`, with 0 for urls that were already stored (those are left as they are).
+        std::vector<long long> insert_feeds(const std::vector<std::pair<std::string, std::string>>& feeds)
+        {
+            std::lock_guard<std::mutex> lock(mutex_); // Thread safety
+
+            std::vector<long long> ids;
+            if (feeds.empty()) return ids;
+            ids.reserve(feeds.size());
+
+            try {
+                db_.exec("BEGIN IMMEDIATE");
+
+                // Looked up first: a conflicting INSERT would still use up an AUTOINCREMENT id
+                auto lookup = db_.prepare("SELECT 1 FROM feed WHERE url = ?");
+                auto insert = db_.prepare("INSERT INTO feed (url, title, image_url, last_updated) "
+                                          "VALUES (?, ?, '', datetime('now')) RETURNING id");
+
+                for (const auto& [url, title] : feeds) {
+                    bool stored = false;
+                    lookup.run([&stored](sqlite3_stmt *) { stored = true; }, url);
+                    long long id {0};
+                    if (!stored) {
+                        insert.run([&id](sqlite3_stmt *stmt) { id = sqlite3_column_int64(stmt, 0); }, url, title);
+                    }
+                    ids.push_back(id);
+                }
+
+                db_.exec("COMMIT");
+                RSS_DEBUG_FMT("insert_feeds stored {} feeds", feeds.size());
+            } catch (const std::exception& e) {
+                try {
+                    db_.exec("ROLLBACK");
+                } catch (...) {
+                    // Ignore rollback errors
+                }
+                RSS_ERROR_FMT("Error in insert_feeds: {}", e.what());
+                throw std::runtime_error(std::string("Error in insert_feeds: ") + e.what());
+            }
+            return ids;
+        }
+
+        // What batch_upsert_items() did with the rows it was given
+        struct upsert_counts
+        {
+            size_t inserted {0};
+            size_t updated {0};
+            size_t unchanged {0};
+
+            [[nodiscard]] bool changed() const { return inserted || updated; }
+        };
+
+        // Writes only the items that are new or whose content changed, in one transaction.
+        // Each row keeps a hash of its content, so an unchanged item costs one primary-key lookup.
+        upsert_counts batch_upsert_items(long long feed_id, const std::vector<std::tuple<std::string, std::string, std::string, std::string, std::string, std::string>>& items)
         {
             std::lock_guard<std::mutex> lock(mutex_); // Thread safety
             
             RSS_DEBUG_FMT("batch_upsert_items starting for feed_id={}, item count={}", feed_id, items.size());
-            if (items.empty()) return;
+            upsert_counts counts;
+            if (items.empty()) return counts;
             
             try {
-                // Begin transaction for batch operations
-                db_.exec("BEGIN TRANSACTION");
+                // Take the write lock up front instead of upgrading midway
+                db_.exec("BEGIN IMMEDIATE");
+                
+                auto lookup = db_.prepare("SELECT content_hash FROM item WHERE link = ?");
+                auto insert = db_.prepare("INSERT INTO item (link, enclosure, feed_id, title, description, pub_date, image_url, content_hash) "
+                                          "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+                auto update = db_.prepare("UPDATE item SET enclosure = ?, feed_id = ?, title = ?, description = ?, pub_date = ?, "
+                                          "image_url = ?, content_hash = ? WHERE link = ?");
                 
                 for (const auto& [title, enclosure, link, description, pub_date, image_url] : items) {
                     // Truncate description if it's too large (SQLite text limit is ~1GB but we'll be conservative)
-                    std::string truncated_desc = description;
+                    std::string_view truncated_desc = description;
+                    std::string shortened;
                     if (truncated_desc.length() > 8192) { // Limit to 8KB
-                        truncated_desc = truncated_desc.substr(0, 8189) + "...";
+                        shortened = description.substr(0, 8189) + "...";
+                        truncated_desc = shortened;
                     }
                     
-                    std::string sql = "INSERT OR REPLACE INTO item (link, enclosure, feed_id, title, description, pub_date, image_url) "
-                                     "VALUES (?, ?, ?, ?, ?, ?, ?)";
-                    db_.exec(sql, {}, link, enclosure, feed_id, title, truncated_desc, pub_date, image_url);
+                    auto const hash = content_hash(feed_id, {title, enclosure, truncated_desc, pub_date, image_url});
+                    bool found = false;
+                    std::optional<long long> stored;
+                    lookup.run([&found, &stored](sqlite3_stmt *stmt) {
+                        found = true;
+                        if (sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+                            stored = sqlite3_column_int64(stmt, 0);
+                        }
+                    }, link);
+                    
+                    if (!found) {
+                        insert.run({}, link, enclosure, feed_id, title, truncated_desc, pub_date, image_url, hash);
+                        ++counts.inserted;
+                    } else if (stored != hash) {
+                        update.run({}, enclosure, feed_id, title, truncated_desc, pub_date, image_url, hash, link);
+                        ++counts.updated;
+                    } else {
+                        ++counts.unchanged;
+                    }
                 }
                 
                 // Commit the transaction
                 db_.exec("COMMIT");
-                RSS_DEBUG_FMT("batch_upsert_items complete for feed_id={}", feed_id);
+                RSS_DEBUG_FMT("batch_upsert_items complete for feed_id={}: {} inserted, {} updated, {} unchanged",
+                              feed_id, counts.inserted, counts.updated, counts.unchanged);
             } catch (const std::exception& e) {
                 // Rollback on error
                 try {
@@ -122,6 +238,7 @@ namespace media::rss
                 RSS_ERROR_FMT("Error in batch_upsert_items: {}", e.what());
                 throw std::runtime_error(std::string("Error in batch_upsert_items: ") + e.what());
             }
+            return counts;
         }
 
         void upsert_item(long long feed_id, std::string_view title, std::string_view enclosure, std::string_view link, std::string_view description, std::string_view pub_date, std::string_view image_url)
@@ -135,7 +252,11 @@ namespace media::rss
                     description = truncated_desc;
                 }
                 
-                std::string sql = "INSERT OR REPLACE INTO item (link, enclosure, feed_id, title, description, pub_date, image_url) VALUES (?, ?, ?, ?, ?, ?, ?)";
+                // An upsert rather than INSERT OR REPLACE: a replace deletes the row without firing the
+                // search index's delete trigger
+                std::string sql = "INSERT INTO item (link, enclosure, feed_id, title, description, pub_date, image_url) VALUES (?, ?, ?, ?, ?, ?, ?) "
+                                  "ON CONFLICT(link) DO UPDATE SET enclosure = excluded.enclosure, feed_id = excluded.feed_id, title = excluded.title, "
+                                  "description = excluded.description, pub_date = excluded.pub_date, image_url = excluded.image_url";
                 db_.exec(sql, {}, link, enclosure, feed_id, title, description, pub_date, image_url);
                 RSS_DEBUG_FMT("upsert_item complete for feed_id={}, link={}", feed_id, link);
             } catch (const std::exception& e) {
@@ -173,12 +294,16 @@ namespace media::rss
                 }, url);
 
                 if (feed_id != -1) {
+                    sql = "DELETE FROM item_summary WHERE link IN (SELECT link FROM item WHERE feed_id = ?)";
+                    db_.exec(sql, {}, feed_id);
+                    
                     sql = "DELETE FROM item WHERE feed_id = ?";
                     db_.exec(sql, {}, feed_id);
 
                     sql = "DELETE FROM feed WHERE url = ?";
                     db_.exec(sql, {}, url);
                 }
+                db_.exec("DELETE FROM feed_schedule WHERE url = ?", {}, url);
                 
                 // Commit transaction
                 db_.exec("COMMIT");
@@ -200,14 +325,11 @@ namespace media::rss
             RSS_DEBUG("scan_feeds starting...");
             try {
                 std::string sql = "SELECT id, url, title, image_url FROM feed";
-                db_.exec(sql, [&sink](sqlite3_stmt *stmt) {
-                    auto id = sqlite3_column_int64(stmt, 0);
-                    auto url = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
-                    auto title = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 2));
-                    auto image_url = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
-                    RSS_TRACE_FMT("scan_feeds found: id={}, url={}", id, (url ? url : "null"));
-                    sink(id, url, title, image_url);
-                });
+                db_.for_each_readonly<long long, const char *, const char *, const char *>(sql,
+                    [&sink](long long id, const char *url, const char *title, const char *image_url) {
+                        RSS_TRACE_FMT("scan_feeds found: id={}, url={}", id, (url ? url : "null"));
+                        sink(id, url, title, image_url);
+                    });
                 RSS_DEBUG("scan_feeds complete");
             } catch (const std::exception& e) {
                 RSS_ERROR_FMT("Error in scan_feeds: {}", e.what());
@@ -215,49 +337,122 @@ namespace media::rss
             }
         }
 
+        // Times are seconds since the epoch; interval in seconds
+        void save_schedule(std::string_view url, long long checked, long long changed, long long interval)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            try {
+                db_.exec("INSERT OR REPLACE INTO feed_schedule (url, checked, changed, interval) VALUES (?, ?, ?, ?)",
+                         {}, url, checked, changed, interval);
+            } catch (const std::exception& e) {
+                RSS_ERROR_FMT("Error in save_schedule: {}", e.what());
+            }
+        }
+
+        std::optional<std::string> get_summary(std::string_view link)
+        {
+            std::optional<std::string> summary;
+            try {
+                db_.for_each_readonly<std::string>("SELECT summary FROM item_summary WHERE link = ?", [&summary](std::string text) {
+                    summary = std::move(text);
+                }, link);
+            } catch (const std::exception& e) {
+                RSS_ERROR_FMT("Error in get_summary: {}", e.what());
+            }
+            return summary;
+        }
+
+        void save_summary(std::string_view link, std::string_view summary)
+        {
+            try {
+                db_.exec("INSERT OR REPLACE INTO item_summary (link, summary, created) VALUES (?, ?, strftime('%s', 'now'))",
+                         {}, link, summary);
+            } catch (const std::exception& e) {
+                RSS_ERROR_FMT("Error in save_summary: {}", e.what());
+            }
+        }
+
+        // sink(url, path, bytes, complete, used) for every downloaded or partly downloaded enclosure
+        void scan_episodes(auto sink)
+        {
+            try {
+                db_.for_each_readonly<const char *, const char *, long long, bool, long long>("SELECT url, path, bytes, complete, used FROM episode",
+                    [&sink](const char *url, const char *path, long long bytes, bool complete, long long used) {
+                        if (url && path) {
+                            sink(url, path, bytes, complete, used);
+                        }
+                    });
+            } catch (const std::exception& e) {
+                RSS_ERROR_FMT("Error in scan_episodes: {}", e.what());
+            }
+        }
+
+        void save_episode(std::string_view url, std::string_view path, long long bytes, bool complete, long long used)
+        {
+            try {
+                db_.exec("INSERT OR REPLACE INTO episode (url, path, bytes, complete, used) VALUES (?, ?, ?, ?, ?)",
+                         {}, url, path, bytes, complete ? 1 : 0, used);
+            } catch (const std::exception& e) {
+                RSS_ERROR_FMT("Error in save_episode: {}", e.what());
+            }
+        }
+
+        void delete_episode(std::string_view url)
+        {
+            try {
+                db_.exec("DELETE FROM episode WHERE url = ?", {}, url);
+            } catch (const std::exception& e) {
+                RSS_ERROR_FMT("Error in delete_episode: {}", e.what());
+            }
+        }
+
+        void scan_schedule(auto sink)
+        {
+            try {
+                db_.for_each_readonly<const char *, long long, long long, long long>("SELECT url, checked, changed, interval FROM feed_schedule",
+                    [&sink](const char *url, long long checked, long long changed, long long interval) {
+                        if (url) {
+                            sink(url, checked, changed, interval);
+                        }
+                    });
+            } catch (const std::exception& e) {
+                RSS_ERROR_FMT("Error in scan_schedule: {}", e.what());
+            }
+        }
+
         void scan_items(long long feed_id, auto sink)
         {
             RSS_DEBUG_FMT("scan_items starting for feed_id={}...", feed_id);
             try {
                 // Use a limit clause to avoid potential memory issues with large feeds
-                std::string sql = "SELECT link, enclosure, title, description, pub_date, image_url FROM item WHERE feed_id = ? ORDER BY pub_date DESC LIMIT 500";
+                std::string sql = "SELECT coalesce(link, ''), coalesce(enclosure, ''), coalesce(title, ''), coalesce(description, ''), "
+                                  "coalesce(pub_date, ''), coalesce(image_url, '') FROM item WHERE feed_id = ? ORDER BY pub_date DESC LIMIT 500";
                 int item_count = 0;
                 
                 // Set a timeout for this operation to prevent hanging
                 auto start_time = std::chrono::steady_clock::now();
                 auto timeout = std::chrono::seconds(10); // 10-second timeout
                 
-                db_.exec(sql, [&sink, &item_count, &start_time, timeout](sqlite3_stmt *stmt) {
+                // NULL columns come as "" (coalesced in the query)
+                db_.for_each_readonly<const char *, const char *, const char *, const char *, const char *, const char *>(sql,
+                    [&sink, &item_count, &start_time, timeout](const char *link, const char *enclosure, const char *title,
+                                                               const char *description, const char *pub_date, const char *image_url) {
                     // Check for timeout periodically
                     if (item_count % 10 == 0) {
                         auto now = std::chrono::steady_clock::now();
                         if (now - start_time > timeout) {
                             RSS_WARN_FMT("scan_items timeout reached, processed {} items", item_count);
-                            return 1; // Signal to stop processing
+                            return false; // Signal to stop processing
                         }
                     }
                     
                     item_count++;
                     try {
-                        // Handle potentially NULL columns safely
-                        const char* link = (sqlite3_column_type(stmt, 0) != SQLITE_NULL) ? 
-                            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)) : "";
-                        const char* enclosure = (sqlite3_column_type(stmt, 1) != SQLITE_NULL) ? 
-                            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)) : "";
-                        const char* title = (sqlite3_column_type(stmt, 2) != SQLITE_NULL) ? 
-                            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)) : "";
-                        const char* description = (sqlite3_column_type(stmt, 3) != SQLITE_NULL) ? 
-                            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)) : "";
-                        const char* pub_date = (sqlite3_column_type(stmt, 4) != SQLITE_NULL) ? 
-                            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)) : "";
-                        const char* image_url = (sqlite3_column_type(stmt, 5) != SQLITE_NULL) ? 
-                            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5)) : "";
-                            
                         sink(link, enclosure, title, description, pub_date, image_url);
                     } catch (const std::exception& e) {
                         RSS_ERROR_FMT("Error processing RSS item at index {}: {}", item_count, e.what());
                     }
-                    return 0;
+                    return true;
                 }, feed_id);
                 
                 RSS_DEBUG_FMT("scan_items complete for feed_id={}, found {} items", feed_id, item_count);
@@ -267,8 +462,154 @@ namespace media::rss
             }
         }
 
+        // Up to `limit` items of a feed, newest first, older than (after_date, after_link) unless
+        // after_link is empty. Descriptions are cut to `preview` characters.
+        // sink(link, enclosure, title, description, pub_date, image_url); pub_date is the stored key
+        void scan_items_page(long long feed_id, std::string_view after_date, std::string_view after_link,
+                             size_t limit, size_t preview, auto sink)
+        {
+            RSS_DEBUG_FMT("scan_items_page starting for feed_id={} after {}", feed_id, after_link);
+            try {
+                std::string const columns = "SELECT coalesce(link, ''), coalesce(enclosure, ''), coalesce(title, ''), "
+                                            "coalesce(substr(description, 1, ?), ''), coalesce(pub_date, ''), coalesce(image_url, '') FROM item ";
+                // Bound in place, so copied: a sink may advance the caller's cursor while rows step
+                std::string const date{after_date}, link{after_link};
+                auto const length = static_cast<long long>(preview);
+                auto const count = static_cast<long long>(limit);
+                if (after_link.empty()) {
+                    db_.for_each_readonly<const char *, const char *, const char *, const char *, const char *, const char *>(
+                        columns + "WHERE feed_id = ? ORDER BY pub_date DESC, link DESC LIMIT ?",
+                        sink, length, feed_id, count);
+                } else {
+                    db_.for_each_readonly<const char *, const char *, const char *, const char *, const char *, const char *>(
+                        columns + "WHERE feed_id = ? AND (pub_date, link) < (?, ?) ORDER BY pub_date DESC, link DESC LIMIT ?",
+                        sink, length, feed_id, date, link, count);
+                }
+            } catch (const std::exception& e) {
+                RSS_ERROR_FMT("Error in scan_items_page: {}", e.what());
+            }
+        }
+
+        // The one item of the feed with this link; same sink as scan_items()
+        void scan_item(long long feed_id, std::string_view link, auto sink)
+        {
+            try {
+                std::string sql = "SELECT coalesce(link, ''), coalesce(enclosure, ''), coalesce(title, ''), coalesce(description, ''), "
+                                  "coalesce(pub_date, ''), coalesce(image_url, '') FROM item WHERE link = ? AND feed_id = ?";
+                db_.for_each_readonly<const char *, const char *, const char *, const char *, const char *, const char *>(sql, sink, link, feed_id);
+            } catch (const std::exception& e) {
+                RSS_ERROR_FMT("Error in scan_item: {}", e.what());
+            }
+        }
+
+        // FTS5 query for what the user typed: every word must match, the last one as a prefix
+        // so results show up while typing. Quoting keeps FTS5 operators out of user input.
+        static std::string match_expression(std::string_view text)
+        {
+            std::vector<std::string_view> words;
+            size_t pos = 0;
+            while (pos < text.size()) {
+                auto const start = text.find_first_not_of(" \t\r\n", pos);
+                if (start == std::string_view::npos) break;
+                auto end = text.find_first_of(" \t\r\n", start);
+                if (end == std::string_view::npos) end = text.size();
+                words.push_back(text.substr(start, end - start));
+                pos = end;
+            }
+            std::string expression;
+            for (size_t i = 0; i < words.size(); ++i) {
+                if (!expression.empty()) expression += ' ';
+                expression += '"';
+                for (char c : words[i]) {
+                    if (c == '"') expression += '"';
+                    expression += c;
+                }
+                expression += '"';
+                if (i + 1 == words.size()) expression += '*';
+            }
+            return expression;
+        }
+
+        [[nodiscard]] bool searchable() const { return searchable_; }
+
+        // One page of items matching `text`, best first (title hits weigh most, then link, then description).
+        // sink(feed_id, link, enclosure, title, snippet, pub_date, image_url)
+        void search_items(std::string_view text, size_t limit, size_t offset, auto sink)
+        {
+            auto const expression = match_expression(text);
+            if (!searchable_ || expression.empty()) return;
+            
+            RSS_DEBUG_FMT("search_items starting for query={}, offset={}", expression, offset);
+            try {
+                std::string sql = "SELECT i.feed_id, coalesce(i.link, ''), coalesce(i.enclosure, ''), coalesce(i.title, ''), "
+                                  "coalesce(snippet(item_fts, 1, '', '', '...', 16), ''), coalesce(i.pub_date, ''), coalesce(i.image_url, '') "
+                                  "FROM item_fts JOIN item i ON i.rowid = item_fts.rowid "
+                                  "WHERE item_fts MATCH ? "
+                                  "ORDER BY bm25(item_fts, 10.0, 1.0, 2.0), i.pub_date DESC "
+                                  "LIMIT ? OFFSET ?";
+                db_.for_each_readonly<long long, const char *, const char *, const char *, const char *, const char *, const char *>(sql,
+                    sink, expression, static_cast<long long>(limit), static_cast<long long>(offset));
+            } catch (const std::exception& e) {
+                RSS_ERROR_FMT("Error in search_items: {}", e.what());
+            }
+        }
+
     private:
+        // Full-text index over item titles, descriptions and links. It is an external-content
+        // FTS5 table: it stores only the index, triggers keep it in step with `item`, and a
+        // database that predates it is indexed once when the table is created.
+        void ensure_search_index()
+        {
+            try {
+                bool exists = false;
+                db_.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'item_fts'",
+                         [&exists](sqlite3_stmt *) { exists = true; });
+                
+                db_.exec("CREATE VIRTUAL TABLE IF NOT EXISTS item_fts USING fts5("
+                         "title, description, link, content='item', content_rowid='rowid', "
+                         "tokenize='unicode61 remove_diacritics 2')");
+                db_.exec("CREATE TRIGGER IF NOT EXISTS item_fts_insert AFTER INSERT ON item BEGIN "
+                         "INSERT INTO item_fts (rowid, title, description, link) VALUES (new.rowid, new.title, new.description, new.link); "
+                         "END");
+                db_.exec("CREATE TRIGGER IF NOT EXISTS item_fts_delete AFTER DELETE ON item BEGIN "
+                         "INSERT INTO item_fts (item_fts, rowid, title, description, link) VALUES ('delete', old.rowid, old.title, old.description, old.link); "
+                         "END");
+                db_.exec("CREATE TRIGGER IF NOT EXISTS item_fts_update AFTER UPDATE ON item BEGIN "
+                         "INSERT INTO item_fts (item_fts, rowid, title, description, link) VALUES ('delete', old.rowid, old.title, old.description, old.link); "
+                         "INSERT INTO item_fts (rowid, title, description, link) VALUES (new.rowid, new.title, new.description, new.link); "
+                         "END");
+                
+                if (!exists) {
+                    RSS_INFO("Indexing stored RSS items for search...");
+                    db_.exec("INSERT INTO item_fts (item_fts) VALUES ('rebuild')");
+                    RSS_INFO("RSS item search index built");
+                }
+                searchable_ = true;
+            } catch (const std::exception& e) {
+                // e.g. an SQLite built without FTS5: everything but search keeps working
+                RSS_WARN_FMT("RSS item search unavailable: {}", e.what());
+            }
+        }
+
+        // FNV-1a over the stored fields: stable across runs and builds, unlike std::hash
+        static long long content_hash(long long feed_id, std::initializer_list<std::string_view> fields)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            auto mix = [&hash](std::string_view bytes) {
+                for (char c : bytes) {
+                    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+                }
+                hash = (hash ^ 0xffu) * 1099511628211ull;   // field separator
+            };
+            mix(std::to_string(feed_id));
+            for (auto field : fields) {
+                mix(field);
+            }
+            return static_cast<long long>(hash);
+        }
+
         hosting::db::sqlite db_;
         std::mutex mutex_;  // For thread-safe operations
+        bool searchable_ {false};   // the FTS5 index exists
     };
 }
\ No newline at end of file
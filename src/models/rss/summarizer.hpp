@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../../registrar.hpp"
+#include "../../helpers/api_keys.hpp"
+#include "../../helpers/completion_cache.hpp"
+#include "../../helpers/cppgpt.hpp"
+#include "../../helpers/debug.hpp"
+#include "../../helpers/fetch.hpp"
+#include "../../helpers/task_scheduler.hpp"
+#include "sqliterepo.hpp"
+
+namespace media::rss
+{
+    /**
+     * Article summaries, produced off the render thread and kept in rss.db.
+     *
+     * request() answers from memory or the repository right away, and otherwise queues the link
+     * and reports it pending; the summary arrives later and `on_ready` is called. A link
+     * is queued once however often it is asked for. Requests go ahead of prefetches, and
+     * the bounded queue evicts prefetches first. At most `max_running` summaries are fetched at a
+     * time on the shared task scheduler.
+     *
+     * The summarizing service is the std::function<std::string(std::string_view)> registered
+     * under "" (article text in, summary out); without one, Grok is used when GROK_API_KEY is set.
+     */
+    class summarizer
+    {
+    public:
+        enum class state { missing, pending, ready, failed };
+
+        struct status
+        {
+            state what {state::missing};
+            std::string text;   // the summary, or why there is none
+        };
+
+        summarizer(sqliterepo &repo, std::function<void()> on_ready = {}, size_t capacity = 64, size_t max_running = 2)
+            : shared_{std::make_shared<shared>()}
+        {
+            shared_->repo = &repo;
+            shared_->on_ready = std::move(on_ready);
+            shared_->capacity = std::max<size_t>(capacity, 1);
+            shared_->max_running = std::max<size_t>(max_running, 1);
+        }
+
+        // Summaries still being fetched finish on their own and are dropped
+        ~summarizer()
+        {
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            shared_->repo = nullptr;
+            shared_->queue.clear();
+            shared_->stop.request_stop();
+        }
+
+        summarizer(summarizer const &) = delete;
+        summarizer &operator=(summarizer const &) = delete;
+
+        // Whether there is a service to summarize with; cheap enough to ask every frame
+        [[nodiscard]] static bool available()
+        {
+            return registrar::cached<summarize_fn, "">() || rouen::helpers::ApiKeys::has_grok_api_key();
+        }
+
+        // The summary of `link` if known; otherwise it is queued ahead of any prefetch
+        status request(std::string const &link)
+        {
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            if (auto known = lookup(*shared_, link); known.what != state::missing) {
+                return known;
+            }
+            auto &queue = shared_->queue;
+            if (queue.size() >= shared_->capacity) {
+                if (queue.back().foreground) {
+                    return {state::missing, "Too many summaries queued"};
+                }
+                shared_->queued.erase(queue.back().link);
+                queue.pop_back();
+            }
+            queue.push_front({link, true});
+            shared_->queued.insert(link);
+            dispatch(shared_);
+            return {state::pending, {}};
+        }
+
+        // Forgets that `link` failed and asks for it again
+        status retry(std::string const &link)
+        {
+            {
+                std::lock_guard<std::mutex> lock(shared_->mutex);
+                if (auto pos = shared_->known.find(link); pos != shared_->known.end() && pos->second.what == state::failed) {
+                    shared_->known.erase(pos);
+                }
+            }
+            return request(link);
+        }
+
+        // Summarizes links nobody has asked for yet, with what the queue can spare (half its capacity)
+        void prefetch(std::vector<std::string> const &links)
+        {
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            for (auto const &link : links) {
+                if (shared_->queue.size() >= shared_->capacity / 2) {
+                    break;
+                }
+                if (lookup(*shared_, link).what == state::missing) {
+                    shared_->queue.push_back({link, false});
+                    shared_->queued.insert(link);
+                }
+            }
+            dispatch(shared_);
+        }
+
+    private:
+        using summarize_fn = std::function<std::string(std::string_view)>;
+
+        struct job
+        {
+            std::string link;
+            bool foreground;
+        };
+
+        struct shared
+        {
+            std::mutex mutex;
+            std::deque<job> queue;
+            std::unordered_set<std::string> queued;             // waiting or running
+            std::unordered_map<std::string, status> known;      // summaries and failures of this session
+            size_t running {0};
+            size_t capacity {0};
+            size_t max_running {0};
+            sqliterepo *repo {nullptr};                         // null once the summarizer is gone
+            std::function<void()> on_ready;
+            std::stop_source stop;
+        };
+
+        static constexpr size_t max_known = 512;
+        static constexpr size_t max_article = 12000;    // characters of article text sent along
+
+        // Caller holds the mutex
+        static status lookup(shared &s, std::string const &link)
+        {
+            if (auto pos = s.known.find(link); pos != s.known.end()) {
+                return pos->second;
+            }
+            if (s.queued.contains(link)) {
+                return {state::pending, {}};
+            }
+            if (s.repo) {
+                if (auto stored = s.repo->get_summary(link); stored) {
+                    remember(s, link, {state::ready, std::move(*stored)});
+                    return s.known[link];
+                }
+            }
+            return {};
+        }
+
+        static void remember(shared &s, std::string const &link, status result)
+        {
+            if (s.known.size() >= max_known) {
+                s.known.clear();    // they are in the repository; failures get another try
+            }
+            s.known[link] = std::move(result);
+        }
+
+        // Caller holds the mutex
+        static void dispatch(std::shared_ptr<shared> const &s)
+        {
+            while (s->repo && s->running < s->max_running && !s->queue.empty()) {
+                auto next = std::move(s->queue.front());
+                s->queue.pop_front();
+                ++s->running;
+                auto const priority = next.foreground ? rouen::helpers::task_priority::high : rouen::helpers::task_priority::background;
+                try {
+                    rouen::helpers::scheduler()->submit([s, link = next.link](std::stop_token stoken) {
+                        run(s, link, stoken);
+                    }, priority, s->stop);
+                } catch (std::exception const &e) {
+                    --s->running;
+                    s->queued.erase(next.link);
+                    RSS_ERROR_FMT("Cannot schedule a summary: {}", e.what());
+                    return;
+                }
+            }
+        }
+
+        static void run(std::shared_ptr<shared> const &s, std::string const &link, std::stop_token stoken)
+        {
+            status result;
+            if (stoken.stop_requested()) {
+                result = {state::failed, "Cancelled"};
+            } else {
+                try {
+                    result = {state::ready, summarize(link)};
+                } catch (std::exception const &e) {
+                    RSS_WARN_FMT("Summary of {} failed: {}", link, e.what());
+                    result = {state::failed, e.what()};
+                } catch (...) {
+                    result = {state::failed, "Failed to summarize"};
+                }
+            }
+            std::function<void()> notify;
+            {
+                std::lock_guard<std::mutex> lock(s->mutex);
+                --s->running;
+                s->queued.erase(link);
+                if (!s->repo) {
+                    return;
+                }
+                if (result.what == state::ready) {
+                    s->repo->save_summary(link, result.text);
+                }
+                remember(*s, link, std::move(result));
+                dispatch(s);
+                notify = s->on_ready;
+            }
+            if (notify) {
+                notify();
+            }
+        }
+
+        static std::string summarize(std::string const &link)
+        {
+            auto const article = plain_text(http::fetch{30}(link));
+            auto &handle = registrar::cached<summarize_fn, "">();
+            if (auto const service = handle ? handle.get() : nullptr; service) {
+                return (*service)(article);
+            }
+            return grok_summary(article);
+        }
+
+        static std::string grok_summary(std::string_view article)
+        {
+            auto const api_key = rouen::helpers::ApiKeys::get_grok_api_key();
+            if (api_key.empty()) {
+                throw std::runtime_error("No summarizer: GROK_API_KEY is not set");
+            }
+            ignacionr::cppgpt gpt(api_key, ignacionr::cppgpt::grok_base);
+            gpt.add_instructions("Summarize the article you are given in a few sentences of plain text. "
+                                 "Ignore navigation, advertising and comments.");
+            http::fetch fetcher{60};
+            return gpt.sendMessageCached(article, [&fetcher](std::string const &url, std::string const &data, auto header_client) {
+                return fetcher.post(url, data, header_client);
+            }, rouen::helpers::completion_cache::shared());
+        }
+
+        // Tags, scripts and styles stripped and whitespace collapsed, cut to max_article
+        static std::string plain_text(std::string_view html)
+        {
+            std::string text;
+            text.reserve(std::min(html.size(), max_article));
+            size_t pos = 0;
+            while (pos < html.size() && text.size() < max_article) {
+                if (html[pos] == '<') {
+                    auto skip_to = std::string_view::npos;
+                    for (std::string_view block : {std::string_view{"script"}, std::string_view{"style"}}) {
+                        if (html.substr(pos + 1, block.size()) == block) {
+                            auto const close = html.find(std::string{"</"} + std::string{block}, pos);
+                            skip_to = close == std::string_view::npos ? html.size() : close;
+                        }
+                    }
+                    if (skip_to != std::string_view::npos && skip_to > pos) {
+                        pos = skip_to;
+                        continue;
+                    }
+                    auto const end = html.find('>', pos);
+                    pos = end == std::string_view::npos ? html.size() : end + 1;
+                    if (!text.empty() && text.back() != ' ') {
+                        text += ' ';
+                    }
+                    continue;
+                }
+                auto const c = html[pos++];
+                auto const space = c == ' ' || c == '\t' || c == '\r' || c == '\n';
+                if (!space) {
+                    text += c;
+                } else if (!text.empty() && text.back() != ' ') {
+                    text += ' ';
+                }
+            }
+            while (!text.empty() && text.back() == ' ') {
+                text.pop_back();
+            }
+            return text;
+        }
+
+        std::shared_ptr<shared> shared_;
+    };
+}
@@ -9,6 +9,7 @@
 namespace media::travel {
     // Represents a single travel destination within a trip plan
     struct destination {
+        long long id{-1};       // row in travel_destination, -1 until written
         std::string name;
         std::string location;
         std::string notes;
@@ -1,11 +1,16 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <chrono>
+#include <format>
 #include <iomanip>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 #include "../../helpers/sqlite.hpp"
+#include "../../helpers/write_behind.hpp"
 #include "plan.hpp"
 
 namespace media::travel {
@@ -53,15 +58,18 @@ namespace media::travel {
             return std::chrono::system_clock::from_time_t(std::mktime(&tm));
         }
 
-        // Create or update a travel plan
+        // Create or update a travel plan. A new plan is written right away, for its id; edits
+        // of an existing one are queued, and a later edit of the same plan replaces them
         long long upsert_plan(plan& p) {
             if (p.id == -1) {
-                // New plan
+                // New plan; RETURNING hands back its id in the same statement
                 std::string sql = "INSERT INTO travel_plan "
                                 "(title, description, created, start_date, end_date, status, total_budget) "
-                                "VALUES (?, ?, ?, ?, ?, ?, ?)";
+                                "VALUES (?, ?, ?, ?, ?, ?, ?) RETURNING id";
                 
-                db_.exec(sql, {}, 
+                db_.exec(sql, [&p](sqlite3_stmt *stmt) {
+                            p.id = sqlite3_column_int64(stmt, 0);
+                        },
                         p.title, 
                         p.description, 
                         time_point_to_string(p.created.time_since_epoch().count() > 0 ? p.created : std::chrono::system_clock::now()),
@@ -70,19 +78,24 @@ namespace media::travel {
                         plan::status_to_string(p.current_status),
                         p.total_budget);
                 
-                // Get the last inserted ID
-                sql = "SELECT last_insert_rowid()";
-                db_.exec(sql, [&p](sqlite3_stmt *stmt) {
-                    p.id = sqlite3_column_int64(stmt, 0);
-                });
-            } else {
+                if (!p.destinations.empty()) {
+                    // In the write-behind transaction like any other destination write
+                    writes_.put(std::format("plan:{}", p.id), [this, p](hosting::db::sqlite &db) {
+                        write_destinations(db, p);
+                    });
+                    flush();
+                }
+                return p.id;
+            }
+
+            writes_.put(std::format("plan:{}", p.id), [this, p](hosting::db::sqlite &db) {
                 // Update existing plan
                 std::string sql = "UPDATE travel_plan SET "
                                 "title = ?, description = ?, start_date = ?, "
                                 "end_date = ?, status = ?, total_budget = ? "
                                 "WHERE id = ?";
                 
-                db_.exec(sql, {}, 
+                db.exec(sql, {}, 
                         p.title, 
                         p.description, 
                         time_point_to_string(p.start_date), 
@@ -90,46 +103,28 @@ namespace media::travel {
                         plan::status_to_string(p.current_status),
                         p.total_budget,
                         p.id);
-            }
-            
-            // Now handle destinations
-            // First delete all existing destinations for this plan
-            if (p.id != -1) {
-                std::string sql = "DELETE FROM travel_destination WHERE plan_id = ?";
-                db_.exec(sql, {}, p.id);
-            }
-            
-            // Insert all destinations
-            for (auto& dest : p.destinations) {
-                std::string sql = "INSERT INTO travel_destination "
-                                "(plan_id, name, location, notes, arrival, departure, "
-                                "accommodation, budget, completed) "
-                                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)";
-                
-                db_.exec(sql, {}, 
-                        p.id, 
-                        dest.name, 
-                        dest.location, 
-                        dest.notes,
-                        time_point_to_string(dest.arrival), 
-                        time_point_to_string(dest.departure),
-                        dest.accommodation,
-                        dest.budget,
-                        dest.completed ? 1 : 0);
-            }
-            
+                write_destinations(db, p);
+            });
             return p.id;
         }
 
-        // Delete a travel plan and all its destinations
+        // Delete a travel plan and all its destinations (queued, superseding pending edits)
         void delete_plan(long long id) {
-            // SQLite will cascade delete the destinations
-            std::string sql = "DELETE FROM travel_plan WHERE id = ?";
-            db_.exec(sql, {}, id);
+            writes_.put(std::format("plan:{}", id), [id](hosting::db::sqlite &db) {
+                // SQLite will cascade delete the destinations
+                std::string sql = "DELETE FROM travel_plan WHERE id = ?";
+                db.exec(sql, {}, id);
+            });
+        }
+
+        // Writes the queued edits; reads do it first so they see them
+        void flush() {
+            writes_.flush();
         }
 
         // Get a single travel plan by ID
         bool get_plan(long long id, plan& p) {
+            flush();
             bool found = false;
             
             // First get the plan details
@@ -137,19 +132,17 @@ namespace media::travel {
                             "start_date, end_date, status, total_budget "
                             "FROM travel_plan WHERE id = ?";
             
-            db_.exec(sql, [&p, &found, this](sqlite3_stmt *stmt) {
-                p.id = sqlite3_column_int64(stmt, 0);
-                p.title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-                p.description = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-                p.created = string_to_time_point(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
-                p.start_date = string_to_time_point(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)));
-                p.end_date = string_to_time_point(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5)));
-                
-                auto status_str = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-                auto status_opt = plan::string_to_status(status_str);
-                p.current_status = status_opt.value_or(plan::status::planning);
-                
-                p.total_budget = sqlite3_column_double(stmt, 7);
+            db_.for_each_readonly<long long, std::string, std::string, std::string, std::string, std::string, std::string, double>(sql,
+                [&p, &found, this](long long plan_id, std::string title, std::string description, std::string created,
+                                   std::string start_date, std::string end_date, std::string status, double total_budget) {
+                p.id = plan_id;
+                p.title = std::move(title);
+                p.description = std::move(description);
+                p.created = string_to_time_point(created);
+                p.start_date = string_to_time_point(start_date);
+                p.end_date = string_to_time_point(end_date);
+                p.current_status = plan::string_to_status(status).value_or(plan::status::planning);
+                p.total_budget = total_budget;
                 found = true;
             }, id);
             
@@ -158,40 +151,56 @@ namespace media::travel {
             }
             
             // Now get all destinations for this plan
-            sql = "SELECT name, location, notes, arrival, departure, "
-                "accommodation, budget, completed FROM travel_destination "
-                "WHERE plan_id = ? ORDER BY arrival";
+            sql = std::format("SELECT {} FROM travel_destination WHERE plan_id = ? ORDER BY arrival", destination_columns);
             
             p.destinations.clear();
-            db_.exec(sql, [&p, this](sqlite3_stmt *stmt) {
-                destination dest;
-                dest.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-                dest.location = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-                dest.notes = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-                dest.arrival = string_to_time_point(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
-                dest.departure = string_to_time_point(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)));
-                dest.accommodation = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-                dest.budget = sqlite3_column_double(stmt, 6);
-                dest.completed = sqlite3_column_int(stmt, 7) != 0;
-                p.destinations.push_back(dest);
+            read_destinations(sql, [&p](long long, destination dest) {
+                p.destinations.push_back(std::move(dest));
             }, id);
             
             return true;
         }
 
+        // Every plan with its destinations, newest start first: two queries however many plans
+        std::vector<plan> load_plans() {
+            flush();
+            std::vector<plan> plans;
+            std::unordered_map<long long, size_t> position;
+            db_.for_each_readonly<long long, std::string, std::string, std::string, std::string, std::string, std::string, double>(
+                "SELECT id, title, description, created, start_date, end_date, status, total_budget "
+                "FROM travel_plan ORDER BY start_date DESC",
+                [&plans, &position, this](long long plan_id, std::string title, std::string description, std::string created,
+                                          std::string start_date, std::string end_date, std::string status, double total_budget) {
+                    plan p;
+                    p.id = plan_id;
+                    p.title = std::move(title);
+                    p.description = std::move(description);
+                    p.created = string_to_time_point(created);
+                    p.start_date = string_to_time_point(start_date);
+                    p.end_date = string_to_time_point(end_date);
+                    p.current_status = plan::string_to_status(status).value_or(plan::status::planning);
+                    p.total_budget = total_budget;
+                    position.emplace(plan_id, plans.size());
+                    plans.push_back(std::move(p));
+                });
+            if (plans.empty()) {
+                return plans;
+            }
+            read_destinations(std::format("SELECT {} FROM travel_destination ORDER BY plan_id, arrival", destination_columns),
+                [&plans, &position](long long plan_id, destination dest) {
+                    if (auto const found = position.find(plan_id); found != position.end()) {
+                        plans[found->second].destinations.push_back(std::move(dest));
+                    }
+                });
+            return plans;
+        }
+
         // Scan all travel plans
         void scan_plans(auto sink) {
+            flush();
             std::string sql = "SELECT id, title, start_date, end_date, status FROM travel_plan ORDER BY start_date DESC";
             
-            db_.exec(sql, [sink](sqlite3_stmt *stmt) {
-                long long id = sqlite3_column_int64(stmt, 0);
-                const char* title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-                const char* start_date = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-                const char* end_date = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-                const char* status = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-                
-                sink(id, title, start_date, end_date, status);
-            });
+            db_.for_each_readonly<long long, const char*, const char*, const char*, const char*>(sql, sink);
         }
 
         // Test query to validate SQLite connection
@@ -205,6 +214,64 @@ namespace media::travel {
         }
 
     private:
+        static constexpr std::string_view destination_columns =
+            "id, plan_id, name, location, notes, arrival, departure, accommodation, budget, completed";
+
+        // Runs a SELECT of destination_columns, handing each row to `sink` with its plan id
+        template <typename Sink, typename... Args>
+        void read_destinations(std::string const& sql, Sink&& sink, Args const&... args) {
+            db_.for_each_readonly<long long, long long, std::string, std::string, std::string, std::string, std::string, std::string, double, bool>(sql,
+                [&sink, this](long long dest_id, long long plan_id, std::string name, std::string location, std::string notes,
+                              std::string arrival, std::string departure, std::string accommodation, double budget, bool completed) {
+                destination dest;
+                dest.id = dest_id;
+                dest.name = std::move(name);
+                dest.location = std::move(location);
+                dest.notes = std::move(notes);
+                dest.arrival = string_to_time_point(arrival);
+                dest.departure = string_to_time_point(departure);
+                dest.accommodation = std::move(accommodation);
+                dest.budget = budget;
+                dest.completed = completed;
+                sink(plan_id, std::move(dest));
+            }, args...);
+        }
+
+        // Brings the stored destinations in line with the plan's, touching only what differs:
+        // rows the plan no longer has are deleted in one statement, known rows are rewritten
+        // only if a field changed, and the new ones (id -1) are inserted. Runs inside the
+        // write-behind transaction.
+        void write_destinations(hosting::db::sqlite &db, plan const& p) {
+            std::string kept = "[";
+            for (auto const& dest : p.destinations) {
+                if (dest.id != -1) {
+                    kept += std::format("{}{}", kept.size() > 1 ? "," : "", dest.id);
+                }
+            }
+            kept += "]";
+            db.exec("DELETE FROM travel_destination WHERE plan_id = ? AND id NOT IN (SELECT value FROM json_each(?))", {}, p.id, kept);
+
+            for (auto const& dest : p.destinations) {
+                auto const arrival = time_point_to_string(dest.arrival);
+                auto const departure = time_point_to_string(dest.departure);
+                auto const completed = dest.completed ? 1 : 0;
+                if (dest.id != -1) {
+                    db.exec("UPDATE travel_destination SET name = ?, location = ?, notes = ?, arrival = ?, departure = ?, "
+                            "accommodation = ?, budget = ?, completed = ? "
+                            "WHERE id = ? AND plan_id = ? AND (name IS NOT ?1 OR location IS NOT ?2 OR notes IS NOT ?3 OR "
+                            "arrival IS NOT ?4 OR departure IS NOT ?5 OR accommodation IS NOT ?6 OR budget IS NOT ?7 OR completed IS NOT ?8)",
+                            {}, dest.name, dest.location, dest.notes, arrival, departure, dest.accommodation, dest.budget, completed,
+                            dest.id, p.id);
+                } else {
+                    db.exec("INSERT INTO travel_destination "
+                            "(plan_id, name, location, notes, arrival, departure, accommodation, budget, completed) "
+                            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                            {}, p.id, dest.name, dest.location, dest.notes, arrival, departure, dest.accommodation, dest.budget, completed);
+                }
+            }
+        }
+
         hosting::db::sqlite db_;
+        hosting::db::write_behind writes_ {db_};
     };
 }
\ No newline at end of file
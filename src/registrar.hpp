@@ -1,12 +1,17 @@
 #pragma once
 
 // 1. Standard includes in alphabetic order
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -16,6 +21,18 @@
 // 3. All other includes
 // None in this file
 
+// A string literal usable as a template argument, so each literal key gets its own instantiation
+template <size_t N>
+struct registrar_key {
+    constexpr registrar_key(char const (&str)[N]) {
+        std::copy_n(str, N, value);
+    }
+    [[nodiscard]] constexpr std::string_view view() const {
+        return {value, N - 1};
+    }
+    char value[N] {};
+};
+
 class registrar {
 public:
     // Adds or updates a service of a specific type and key
@@ -23,6 +40,7 @@ public:
     static void add(const std::string& key, std::shared_ptr<T> service) {
         std::lock_guard<std::mutex> lock(getMutex());
         getTypeMap<T>()[key] = service;
+        getGeneration().fetch_add(1, std::memory_order_release);
     }
 
     // Retrieves a service of a specific type and key
@@ -64,11 +82,72 @@ public:
     static void remove(std::string const &key) {
         std::lock_guard<std::mutex> lock(getMutex());
         getTypeMap<T>().erase(key);
+        getGeneration().fetch_add(1, std::memory_order_release);
+    }
+
+    // Bumped on every add/remove; cached handles re-resolve when it changes
+    static uint64_t generation() {
+        return getGeneration().load(std::memory_order_acquire);
+    }
+
+    // A once-resolved service lookup for hot paths. The service is only looked up again
+    // (under the registry lock) after the registry generation changes, so a replacement is
+    // seen on the next access; in between, access is an atomic load and a weak_ptr lock.
+    // The handle holds no reference of its own: a removed service goes away once its last
+    // user lets go, not when the thread caching it ends. A handle is not itself
+    // thread-safe: keep one per thread (e.g. a static thread_local).
+    template <typename T>
+    class handle {
+    public:
+        explicit handle(std::string key) : key_{std::move(key)} {}
+
+        // Throws like registrar::get when the service is not registered
+        [[nodiscard]] std::shared_ptr<T> get() const {
+            auto svc = lock();
+            if (!svc) {
+                throw std::runtime_error("Service not found for the given key");
+            }
+            return svc;
+        }
+
+        // The returned pointer keeps the service alive until the end of the expression
+        std::shared_ptr<T> operator->() const { return get(); }
+
+        [[nodiscard]] explicit operator bool() const {
+            return static_cast<bool>(lock());
+        }
+
+    private:
+        std::shared_ptr<T> lock() const {
+            auto const current = registrar::generation();
+            if (!resolved_ || current != generation_) {
+                std::lock_guard<std::mutex> guard(getMutex());
+                auto& typeMap = getTypeMap<T>();
+                auto it = typeMap.find(key_);
+                svc_ = it == typeMap.end() ? std::weak_ptr<T>{} : std::weak_ptr<T>{it->second};
+                generation_ = getGeneration().load(std::memory_order_relaxed);
+                resolved_ = true;
+            }
+            return svc_.lock();
+        }
+
+        std::string key_;
+        mutable std::weak_ptr<T> svc_;
+        mutable uint64_t generation_ {0};
+        mutable bool resolved_ {false};
+    };
+
+    // Per-thread cached handle for a literal key; one instance per (type, key) pair
+    template <typename T, registrar_key key>
+    static handle<T>& cached() {
+        thread_local handle<T> h{std::string{key.view()}};
+        return h;
     }
 
     class call_fn_str {
     public:
         call_fn_str(std::string const &name) : svc_{registrar::get<std::function<void(std::string const&)>>(name)} {}
+        call_fn_str(std::shared_ptr<std::function<void(std::string const &)>> svc) : svc_{std::move(svc)} {}
         void operator()(std::string const &p) const {
             (*svc_)(p);
         }
@@ -80,6 +159,7 @@ public:
     class call_fn_ret {
     public:
         call_fn_ret(std::string const &name) : svc_{registrar::get<std::function<result_t()>>(name)} {}
+        call_fn_ret(std::shared_ptr<std::function<result_t()>> svc) : svc_{std::move(svc)} {}
 
         [[nodiscard]] result_t operator()() const {
             return (*svc_)();
@@ -93,6 +173,8 @@ public:
     public:
         call_fn_str_ptr(std::string const &name) : 
             svc_{registrar::get<std::function<void(std::string const&, std::shared_ptr<std::function<void(std::string)>>)>>(name)} {}
+        call_fn_str_ptr(std::shared_ptr<std::function<void(std::string const&, std::shared_ptr<std::function<void(std::string)>>)>> svc) :
+            svc_{std::move(svc)} {}
         
         void operator()(std::string const &cmd, std::shared_ptr<std::function<void(std::string)>> callback) const {
             (*svc_)(cmd, callback);
@@ -118,20 +200,32 @@ private:
         static std::mutex mutex;
         return mutex;
     }
+
+    static std::atomic<uint64_t>& getGeneration() {
+        static std::atomic<uint64_t> generation {1};
+        return generation;
+    }
 };
 
-inline registrar::call_fn_str operator ""_sfn(const char* str, size_t) {
-    return registrar::call_fn_str{std::string{str}};
+// Literal keys resolve through a per-literal cached handle, so calling e.g. "create_card"_sfn
+// every frame costs an atomic load instead of a locked string-keyed lookup
+template <registrar_key key>
+inline registrar::call_fn_str operator""_sfn() {
+    return registrar::call_fn_str{registrar::cached<std::function<void(std::string const&)>, key>().get()};
 }
 
-inline registrar::call_fn_ret<bool> operator ""_fnb(const char* str, size_t) {
-    return registrar::call_fn_ret<bool>{std::string{str}};
+template <registrar_key key>
+inline registrar::call_fn_ret<bool> operator""_fnb() {
+    return registrar::call_fn_ret<bool>{registrar::cached<std::function<bool()>, key>().get()};
 }
 
-inline registrar::call_fn_ret<std::string> operator""_fns(const char* str, size_t) {
-    return registrar::call_fn_ret<std::string>{std::string{str}};
+template <registrar_key key>
+inline registrar::call_fn_ret<std::string> operator""_fns() {
+    return registrar::call_fn_ret<std::string>{registrar::cached<std::function<std::string()>, key>().get()};
 }
 
-inline registrar::call_fn_str_ptr operator ""_sfn2(const char* str, size_t) {
-    return registrar::call_fn_str_ptr{std::string{str}};
+template <registrar_key key>
+inline registrar::call_fn_str_ptr operator""_sfn2() {
+    return registrar::call_fn_str_ptr{registrar::cached<
+        std::function<void(std::string const&, std::shared_ptr<std::function<void(std::string)>>)>, key>().get()};
 }
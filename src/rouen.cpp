@@ -9,99 +9,72 @@
 
 // 3. All other includes
 #include "cards/interface/deck.hpp"
+#include "helpers/command_stream.hpp"
+#include "helpers/completion_cache.hpp"
 #include "helpers/debug.hpp"
 #include "helpers/deferred_operations.hpp" // For deferred operations
+#include "helpers/launcher_index.hpp"
+#include "helpers/mpv_process.hpp"
 #include "helpers/notify_service.hpp"
 #include "helpers/process_helper.hpp" // Added this include for ProcessHelper
+#include "helpers/rate_limiter.hpp"
+#include "helpers/redraw.hpp"
+#include "helpers/sqlite_profiler.hpp"
+#include "helpers/startup_timeline.hpp"
+#include "helpers/task_scheduler.hpp"
+#include "helpers/timer_wheel.hpp"
+#include "helpers/trace.hpp"
 #include "main_wnd.hpp"
+#include "models/git_scanner.hpp"
+#include "models/radio.hpp"
 #include "registrar.hpp"
 
 int main() {
+    // Startup phases are measured from here; see helpers/startup_timeline.hpp
+    rouen::helpers::startup_timeline::instance().mark("main");
+
     notify_service notify; // Initialize the notify service
+
+    // Shared worker pool for hosts and models; sized to the hardware
+    auto scheduler = std::make_shared<rouen::helpers::task_scheduler>();
+    registrar::add<rouen::helpers::task_scheduler>("task_scheduler", scheduler);
+
+    // Deadlines for cards and hosts, run by the main loop, which sleeps until the next one
+    registrar::add<rouen::helpers::timer_wheel>("timer_wheel", std::make_shared<rouen::helpers::timer_wheel>(rouen::helpers::request_redraw));
+
+    // Per-statement SQLite timings, read by the dbrepair card
+    registrar::add<hosting::db::query_profiler>("sqlite_profiler", hosting::db::query_profiler::shared());
+
+    // Outbound limits for the APIs that throttle us; requests over them queue instead of earning 429s
+    registrar::add<http::host_limit>("*", std::make_shared<http::host_limit>(http::host_limit{0, 1, 8}));
+    registrar::add<http::host_limit>("api.chess.com", std::make_shared<http::host_limit>(http::host_limit{5, 5, 2}));
+    registrar::add<http::host_limit>("api.github.com", std::make_shared<http::host_limit>(http::host_limit{10, 20, 6}));
+    registrar::add<http::host_limit>("atlassian.net", std::make_shared<http::host_limit>(http::host_limit{10, 10, 4}));
+    registrar::add<http::host_limit>("api.x.ai", std::make_shared<http::host_limit>(http::host_limit{2, 4, 2}));
     
-    // Register the run_command function - non-blocking with incremental output
-    registrar::add<std::function<void(std::string const&, std::shared_ptr<std::function<void(std::string)>>)>>(
-        "run_command", 
-        std::make_shared<std::function<void(std::string const&, std::shared_ptr<std::function<void(std::string)>>)>>(
-            [](std::string const& cmd, std::shared_ptr<std::function<void(std::string)>> callback) {
-                // Launch the command in a background thread to avoid freezing the UI
-                std::thread([cmd, callback]() {
-                    // Create a pipe to the command
-                    FILE* pipe = popen(cmd.c_str(), "r");
-                    if (!pipe) {
-                        if (callback) {
-                            (*callback)("Error: Failed to execute command");
-                        }
-                        return;
-                    }
-                    
-                    // Buffer for reading output
-                    std::array<char, 128> buffer;
-                    std::string current_output;
-                    bool has_output = false;
-                    
-                    // Read output incrementally
-                    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
-                        has_output = true;
-                        current_output += buffer.data();
-                        
-                        // Send the current output to the callback
-                        if (callback) {
-                            (*callback)(current_output);
-                        }
-                    }
-                    
-                    // Get the exit status of the command
-                    int status = pclose(pipe);
-                    
-                    // If there was no output but the command completed, provide a default message
-                    if (!has_output) {
-                        if (WIFEXITED(status)) {
-                            int exit_status = WEXITSTATUS(status);
-                            if (exit_status == 0) {
-                                current_output = "Command completed successfully with no output.";
-                            } else {
-                                current_output = std::format("Command failed with exit code: {}", exit_status);
-                            }
-                        } else {
-                            current_output = "Command terminated abnormally.";
-                        }
-                        
-                        // Send the final status message to the callback
-                        if (callback) {
-                            (*callback)(current_output);
-                        }
-                    } else {
-                        // For commands with output, append the exit status
-                        std::string status_message;
-                        if (WIFEXITED(status)) {
-                            int exit_status = WEXITSTATUS(status);
-                            status_message = std::format("\n\nProcess exited with code: {}", exit_status);
-                        } else if (WIFSIGNALED(status)) {
-                            int term_signal = WTERMSIG(status);
-                            status_message = std::format("\n\nProcess terminated by signal: {}", term_signal);
-                        } else {
-                            status_message = "\n\nProcess completed.";
-                        }
-                        
-                        current_output += status_message;
-                        
-                        // Send the final output with status to the callback
-                        if (callback) {
-                            (*callback)(current_output);
-                        }
-                    }
-                    
-                    // Add a small marker to indicate process completion
-                    if (callback) {
-                        // Send a specially marked message that the card can detect to know the process is definitely complete
-                        (*callback)(current_output + "\n<PROCESS_COMPLETED>");
-                    }
-                }).detach(); // Detach the thread so it runs independently
-            }
-        )
-    );
-    
+    // Shell commands streamed to a sink chunk by chunk, then an exit event; see helpers/command_stream.hpp
+    registrar::add<rouen::helpers::run_command_fn>("run_command", std::make_shared<rouen::helpers::run_command_fn>(
+        [](std::string const &cmd, rouen::helpers::command_sink sink) {
+            return std::make_unique<rouen::helpers::command_run>(cmd, std::move(sink));
+        }));
+
+    // What the menu can launch; sources kept in plain files are read here, the others publish as their hosts load
+    registrar::add<rouen::helpers::launcher_index>("launcher_index", std::make_shared<rouen::helpers::launcher_index>());
+    scheduler->submit([](std::stop_token) {
+        rouen::models::git_index::publish(rouen::models::git_index::load());
+        std::vector<rouen::helpers::launch_target> stations;
+        for (auto const& station : rouen::models::radio::readPresets()) {
+            stations.push_back({station.name, "radio:" + station.name});
+        }
+        rouen::helpers::launcher_index::shared()->publish("stations", std::move(stations));
+    }, rouen::helpers::task_priority::background);
+
+    // Replies to repeated analyses and summaries, so the same input never goes to the model twice
+    registrar::add<rouen::helpers::completion_cache>("completion_cache", std::make_shared<rouen::helpers::completion_cache>());
+
+    // An idle mpv waiting for the first station or episode, so playing starts without a process launch
+    scheduler->submit([](std::stop_token) { mpv_process::playback().start(); }, rouen::helpers::task_priority::background);
+
     // Create and initialize the main window
     main_wnd window;
     if (!window.initialize()) {
@@ -112,5 +85,19 @@ int main() {
     // Run the main loop
     window.run();
 
+    // Nothing runs timers once the loop is over
+    registrar::remove<rouen::helpers::timer_wheel>("timer_wheel");
+
+    // Stop the worker pool before static hosts are torn down
+    registrar::remove<rouen::helpers::task_scheduler>("task_scheduler");
+    scheduler.reset();
+
+    // Launch counts and cached replies still queued get written while the logger is up
+    registrar::remove<rouen::helpers::launcher_index>("launcher_index");
+    registrar::remove<rouen::helpers::completion_cache>("completion_cache");
+
+    // The trace ROUEN_TRACE asked for, once every worker has finished its spans
+    rouen::helpers::trace::write_requested();
+
     return 0;
 }